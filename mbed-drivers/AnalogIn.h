@@ -22,6 +22,24 @@
 
 #include "analogin_api.h"
 
+/* The ADC reference voltage assumed by read_mv(), in milli-volts */
+#ifndef ANALOGIN_VREF_MV
+#define ANALOGIN_VREF_MV 3300
+#endif
+
+#if DEVICE_ANALOGIN_ASYNCH
+#include "CThunk.h"
+#include "dma_api.h"
+#include "core-util/FunctionPointer.h"
+#include "Buffer.h"
+#endif
+
+#if DEVICE_ANALOGIN_WINDOW
+#include "CThunk.h"
+#include "CompletionQueue.h"
+#include "core-util/FunctionPointer.h"
+#endif
+
 namespace mbed {
 
 /** An analog input, used for reading the voltage on a pin
@@ -44,18 +62,50 @@ namespace mbed {
  * @endcode
  */
 class AnalogIn {
+    friend class TriggerLink;
 
 public:
+#if DEVICE_ANALOGIN_ASYNCH
+    /** Stream callback
+     *  @param Buffer The buffer of samples that completed
+     *  @param int The events that occurred
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, int> event_callback_t;
+#endif
+
+#if DEVICE_ANALOGIN_WINDOW
+    /** Window crossing callback
+     *  @param bool true if the input rose above the high threshold,
+     *    false if it fell below the low one
+     */
+    typedef mbed::util::FunctionPointer1<void, bool> window_callback_t;
+#endif
 
     /** Create an AnalogIn, connected to the specified pin
      *
      * @param pin AnalogIn pin to connect to
      * @param name (optional) A string to identify the object
      */
-    AnalogIn(PinName pin) {
+    AnalogIn(PinName pin)
+#if DEVICE_ANALOGIN_ASYNCH || DEVICE_ANALOGIN_WINDOW
+        : _irq(this)
+#endif
+#if DEVICE_ANALOGIN_ASYNCH
+        , _streaming(false), _stream_half(0), _usage(DMA_USAGE_NEVER)
+#endif
+#if DEVICE_ANALOGIN_WINDOW
+        , _window_callback((void (*)(bool))NULL), _window_active(false), _window_above(false)
+#endif
+    {
         analogin_init(&_adc, pin);
     }
 
+#if DEVICE_ANALOGIN_WINDOW
+    ~AnalogIn() {
+        detach_window();
+    }
+#endif
+
     /** Read the input voltage, represented as a float in the range [0.0, 1.0]
      *
      * @returns A floating-point value representing the current input voltage, measured as a percentage
@@ -73,6 +123,115 @@ public:
         return analogin_read_u16(&_adc);
     }
 
+    /** Read the input voltage in milli-volts, without using floating point
+     *
+     * @param vref_mv The ADC reference voltage, in milli-volts
+     *
+     * @returns
+     *   The input voltage, rounded to the nearest milli-volt
+     */
+    unsigned int read_mv(unsigned int vref_mv = ANALOGIN_VREF_MV) {
+        return ((uint32_t)analogin_read_u16(&_adc) * vref_mv + 0x7FFF) / 0xFFFF;
+    }
+
+#if DEVICE_ANALOGIN_ASYNCH
+    /** Sample continuously into two buffers, at a fixed rate
+     *
+     *  A hardware timer triggers the conversions, and the samples are moved
+     *  into the buffers as 16-bit values normalised as for read_u16().
+     *  When one buffer is full, the other is started from the interrupt
+     *  handler and the callback is scheduled with the full one; the
+     *  application has until the other buffer fills to consume it. If a
+     *  conversion completes with no buffer to store it, the stream stops and
+     *  ANALOGIN_EVENT_OVERRUN is reported.
+     *
+     *  @param sample_rate The conversions per second
+     *  @param buffer0 The first buffer, a multiple of two bytes long
+     *  @param buffer1 The second buffer
+     *  @param callback The event callback function
+     *  @param event The logical OR of ANALOGIN events to report
+     *  @return Zero if the stream has started, or -1 if the ADC is busy
+     */
+    int start_stream(uint32_t sample_rate, const Buffer &buffer0, const Buffer &buffer1,
+            const event_callback_t &callback, int event = ANALOGIN_EVENT_COMPLETE);
+
+    /** Stop a stream once the buffer in progress is full
+     */
+    void stop_stream();
+
+    /** Stop a stream immediately, without reporting the buffer in progress
+     */
+    void abort_stream();
+
+    /** Configure DMA usage suggestion for streams
+     *
+     *  @param usage The usage DMA hint for peripheral
+     *  @return Zero if the usage was set, -1 if a stream is on-going
+     */
+    int set_dma_usage(DMAUsage usage);
+#endif
+
+#if DEVICE_ANALOGIN_WINDOW
+    /** Watch the input in hardware, and call back when it crosses a threshold
+     *
+     *  The ADC converts continuously, and its analog watchdog, or a
+     *  comparator, interrupts only when a sample leaves the window it is
+     *  given; no conversion is read by the CPU otherwise. The window is
+     *  moved on each crossing, to below the low threshold once the input
+     *  has risen above the high one, and back, so a signal that wanders
+     *  between the two thresholds reports nothing: the gap between them is
+     *  the hysteresis. The callback is scheduled to run in main context.
+     *
+     *  The input starts out as above if it is already above the high
+     *  threshold, and as below otherwise. It cannot be streamed from, or
+     *  read, until the window is detached.
+     *
+     *  @param low The low threshold, normalised as for read_u16()
+     *  @param high The high threshold, at or above the low one
+     *  @param callback The function to call on each crossing
+     *  @returns 0 on success, or -1 if a stream is running
+     */
+    int attach_window(unsigned short low, unsigned short high, const window_callback_t &callback);
+
+    /** Stop watching the input
+     */
+    void detach_window();
+
+    /** Check which side of the window the input was last on
+     *
+     *  @returns true if it last rose above the high threshold
+     */
+    bool window_above() const {
+        return _window_above;
+    }
+#endif
+
+#if DEVICE_SUSPEND
+    /** Stop the ADC's clock, to save power between bursts
+     *
+     *  The HAL keeps the ADC's configuration, so resume() needs no pinmap
+     *  lookups and no reconfiguration. The input must not be read until it
+     *  is resumed.
+     *
+     *  @returns 0 on success, or -1 if a stream is running
+     */
+    int suspend() {
+#if DEVICE_ANALOGIN_ASYNCH
+        if (analogin_active(&_adc)) {
+            return -1;
+        }
+#endif
+        analogin_suspend(&_adc);
+        return 0;
+    }
+
+    /** Restart the ADC's clock after suspend()
+     */
+    void resume() {
+        analogin_resume(&_adc);
+    }
+#endif
+
 #ifdef MBED_OPERATORS
     /** An operator shorthand for read()
      *
@@ -93,7 +252,47 @@ public:
 #endif
 
 protected:
+#if DEVICE_ANALOGIN_ASYNCH
+    /** ADC IRQ handler
+     */
+    void irq_handler_asynch(void);
+
+    /** Start sampling into the current half of the stream
+     */
+    void start_half();
+#endif
+
+#if DEVICE_ANALOGIN_WINDOW
+    /** Analog watchdog IRQ handler
+     */
+    void window_irq_handler(void);
+
+    /** Arm the watchdog for a crossing from the current side
+     */
+    void arm_window();
+#endif
+
     analogin_t _adc;
+#if DEVICE_ANALOGIN_ASYNCH || DEVICE_ANALOGIN_WINDOW
+    CThunk<AnalogIn> _irq;  /**< Shared by streams and the window, which do not run together */
+#endif
+#if DEVICE_ANALOGIN_ASYNCH
+    uint32_t _sample_rate;
+    Buffer _stream_buffer[2];
+    event_callback_t _callback;
+    int _event;
+    volatile bool _streaming;
+    int _stream_half;
+    DMAUsage _usage;
+#endif
+#if DEVICE_ANALOGIN_WINDOW
+    window_callback_t _window_callback;
+    CompletionQueue::Slot _window_signal;
+    uint16_t _window_low;
+    uint16_t _window_high;
+    bool _window_active;
+    volatile bool _window_above;
+#endif
 };
 
 } // namespace mbed
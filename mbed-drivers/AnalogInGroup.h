@@ -0,0 +1,134 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_ANALOGINGROUP_H
+#define MBED_ANALOGINGROUP_H
+
+#include "platform.h"
+
+#if DEVICE_ANALOGIN_SCAN
+
+#include "analogin_api.h"
+
+#if DEVICE_ANALOGIN_ASYNCH
+#include "CThunk.h"
+#include "dma_api.h"
+#include "core-util/FunctionPointer.h"
+#include "Buffer.h"
+#endif
+
+namespace mbed {
+
+/** A group of analog inputs, converted together by one scan of the ADC
+ *
+ * The channel sequence is programmed into the ADC once, when the group is
+ * created. Each scan then converts every channel in order and stores the
+ * results interleaved, one 16-bit sample per channel, normalised as for
+ * AnalogIn::read_u16(). Oversampling averages that many conversions of each
+ * channel in the peripheral before storing the sample.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * const PinName pins[] = {A0, A1, A2, A3};
+ * AnalogInGroup sensors(pins, 4, 16);
+ *
+ * int main() {
+ *     uint16_t samples[4];
+ *     sensors.read_u16(samples);
+ *     printf("%u %u %u %u\r\n", samples[0], samples[1], samples[2], samples[3]);
+ * }
+ * @endcode
+ */
+class AnalogInGroup {
+
+public:
+#if DEVICE_ANALOGIN_ASYNCH
+    /** Scan callback
+     *  @param Buffer The buffer of samples
+     *  @param int The events that occurred
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, int> event_callback_t;
+#endif
+
+    /** Create an AnalogInGroup, connected to the specified pins
+     *
+     * @param pins The AnalogIn pins, in the order they are scanned
+     * @param count The number of pins, up to ANALOGIN_SCAN_MAX_CHANNELS
+     * @param oversample The conversions averaged for each sample, where
+     *   supported by the peripheral; 1 for no averaging
+     */
+    AnalogInGroup(const PinName *pins, size_t count, uint32_t oversample = 1);
+
+    /** Get the number of channels in the group
+     */
+    size_t channels() const {
+        return _count;
+    }
+
+    /** Scan every channel once
+     *
+     * @param samples Filled with one sample per channel, in pin order
+     */
+    void read_u16(uint16_t *samples);
+
+#if DEVICE_ANALOGIN_ASYNCH
+    /** Start repeated scans into a buffer, without blocking
+     *
+     * @param buffer The samples, interleaved; its length should be a
+     *   multiple of one scan (channels() samples of two bytes)
+     * @param sample_rate The scans per second, or 0 to scan back-to-back
+     * @param callback The event callback function
+     * @param event The logical OR of ANALOGIN events to report
+     * @return Zero if the scans have started, or -1 if the ADC is busy
+     */
+    int read(const Buffer &buffer, uint32_t sample_rate, const event_callback_t &callback,
+            int event = ANALOGIN_EVENT_COMPLETE);
+
+    /** Abort the scans in progress
+     */
+    void abort_read();
+
+    /** Configure DMA usage suggestion for non-blocking scans
+     *
+     *  @param usage The usage DMA hint for peripheral
+     *  @return Zero if the usage was set, -1 if a scan is on-going
+     */
+    int set_dma_usage(DMAUsage usage);
+#endif
+
+protected:
+#if DEVICE_ANALOGIN_ASYNCH
+    /** ADC IRQ handler
+     */
+    void irq_handler_asynch(void);
+#endif
+
+    analogin_scan_t _scan;
+    size_t _count;
+#if DEVICE_ANALOGIN_ASYNCH
+    CThunk<AnalogInGroup> _irq;
+    Buffer _buffer;
+    event_callback_t _callback;
+    DMAUsage _usage;
+#endif
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
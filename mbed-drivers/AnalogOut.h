@@ -22,6 +22,18 @@
 
 #include "analogout_api.h"
 
+#if DEVICE_ANALOGOUT_ASYNCH
+#include "CThunk.h"
+#include "dma_api.h"
+#include "core-util/FunctionPointer.h"
+#include "Buffer.h"
+#endif
+
+/* The DAC reference voltage assumed by write_mv() and read_mv(), in milli-volts */
+#ifndef ANALOGOUT_VREF_MV
+#define ANALOGOUT_VREF_MV 3300
+#endif
+
 namespace mbed {
 
 /** An analog output, used for setting the voltage on a pin
@@ -47,12 +59,23 @@ namespace mbed {
 class AnalogOut {
 
 public:
+#if DEVICE_ANALOGOUT_ASYNCH
+    /** Playback callback
+     *  @param Buffer The buffer of samples that has been played
+     *  @param int The events that occurred
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, int> event_callback_t;
+#endif
 
     /** Create an AnalogOut connected to the specified pin
      *
      *  @param AnalogOut pin to connect to (18)
      */
-    AnalogOut(PinName pin) {
+    AnalogOut(PinName pin)
+#if DEVICE_ANALOGOUT_ASYNCH
+        : _irq(this), _streaming(false), _stream_half(0), _usage(DMA_USAGE_NEVER)
+#endif
+    {
         analogout_init(&_dac, pin);
     }
 
@@ -76,6 +99,32 @@ public:
         analogout_write_u16(&_dac, value);
     }
 
+    /** Set the output voltage in milli-volts, without using floating point
+     *
+     *  @param mv The output voltage, saturated to vref_mv
+     *  @param vref_mv The DAC reference voltage, in milli-volts
+     */
+    void write_mv(unsigned int mv, unsigned int vref_mv = ANALOGOUT_VREF_MV) {
+        if (mv > vref_mv) {
+            mv = vref_mv;
+        }
+        analogout_write_u16(&_dac, (uint16_t)(((uint32_t)mv * 0xFFFF + vref_mv / 2) / vref_mv));
+    }
+
+    /** Return the current output voltage setting, represented as an unsigned short in the range [0x0, 0xFFFF]
+     */
+    unsigned short read_u16() {
+        return analogout_read_u16(&_dac);
+    }
+
+    /** Return the current output voltage setting in milli-volts, without using floating point
+     *
+     *  @param vref_mv The DAC reference voltage, in milli-volts
+     */
+    unsigned int read_mv(unsigned int vref_mv = ANALOGOUT_VREF_MV) {
+        return ((uint32_t)analogout_read_u16(&_dac) * vref_mv + 0x7FFF) / 0xFFFF;
+    }
+
     /** Return the current output voltage setting, measured as a percentage (float)
      *
      *  @returns
@@ -90,6 +139,56 @@ public:
         return analogout_read(&_dac);
     }
 
+#if DEVICE_ANALOGOUT_ASYNCH
+    /** Play a buffer of samples at a fixed rate
+     *
+     *  A hardware timer paces the conversions, and the samples, normalised
+     *  as for write_u16(), are moved to the DAC without the CPU. In circular
+     *  mode the buffer is replayed until abort_play(), with no interrupt per
+     *  pass unless ANALOGOUT_EVENT_COMPLETE is requested.
+     *
+     *  @param buffer The samples, a multiple of two bytes long
+     *  @param sample_rate The conversions per second
+     *  @param callback The event callback function
+     *  @param event The logical OR of ANALOGOUT events to report
+     *  @param circular Replay the buffer until stopped
+     *  @return Zero if playback has started, or -1 if the DAC is busy
+     */
+    int play(const Buffer &buffer, uint32_t sample_rate, const event_callback_t &callback,
+            int event = ANALOGOUT_EVENT_COMPLETE, bool circular = false);
+
+    /** Play two buffers in turn, at a fixed rate
+     *
+     *  When one buffer has been played, the other is started from the
+     *  interrupt handler and the callback is scheduled with the played one;
+     *  the application has until the other buffer finishes to refill it.
+     *
+     *  @param sample_rate The conversions per second
+     *  @param buffer0 The first buffer, a multiple of two bytes long
+     *  @param buffer1 The second buffer
+     *  @param callback The event callback function
+     *  @param event The logical OR of ANALOGOUT events to report
+     *  @return Zero if playback has started, or -1 if the DAC is busy
+     */
+    int start_stream(uint32_t sample_rate, const Buffer &buffer0, const Buffer &buffer1,
+            const event_callback_t &callback, int event = ANALOGOUT_EVENT_COMPLETE);
+
+    /** Stop a stream once the buffer being played is finished
+     */
+    void stop_stream();
+
+    /** Stop playback immediately, leaving the last sample on the output
+     */
+    void abort_play();
+
+    /** Configure DMA usage suggestion for playback
+     *
+     *  @param usage The usage DMA hint for peripheral
+     *  @return Zero if the usage was set, -1 if playback is on-going
+     */
+    int set_dma_usage(DMAUsage usage);
+#endif
+
 #ifdef MBED_OPERATORS
     /** An operator shorthand for write()
      */
@@ -111,7 +210,27 @@ public:
 #endif
 
 protected:
+#if DEVICE_ANALOGOUT_ASYNCH
+    /** DAC IRQ handler
+     */
+    void irq_handler_asynch(void);
+
+    /** Start playing a buffer
+     */
+    void start_buffer(const Buffer &buffer, bool circular);
+#endif
+
     dac_t _dac;
+#if DEVICE_ANALOGOUT_ASYNCH
+    CThunk<AnalogOut> _irq;
+    uint32_t _sample_rate;
+    Buffer _stream_buffer[2];
+    event_callback_t _callback;
+    int _event;
+    volatile bool _streaming;
+    int _stream_half;
+    DMAUsage _usage;
+#endif
 };
 
 } // namespace mbed
@@ -0,0 +1,110 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_AUTOBAUD_H
+#define MBED_AUTOBAUD_H
+
+#include "platform.h"
+
+#if DEVICE_PWMIN
+
+#include "pwmin_api.h"
+#include "us_ticker_api.h"
+
+namespace mbed {
+
+/** Measures the baud rate of the serial data arriving on a pin
+ *
+ * The pin's timer capture channel latches each edge in hardware, as for
+ * PwmIn, and the shortest pulse seen, high or low, is taken as one bit
+ * time. The rate is then rounded to the nearest standard rate. Any data
+ * with an isolated bit will do; a 'U' (0x55) is nothing but isolated bits.
+ *
+ * The edge times are in micro-seconds, so the rounding can tell the rates
+ * apart up to 460800 baud. To move to a faster link, agree on the new rate
+ * at the detected one, then switch with SerialBase::baud(rate, callback).
+ *
+ * The pin can only be routed to one peripheral at a time, so detect the
+ * rate before the serial port on the pin is created, and destroy the
+ * AutoBaud first.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * int detected;
+ *
+ * void app_start(int, char**) {
+ *     {
+ *         AutoBaud autobaud(D0);
+ *         detected = autobaud.detect(100000);
+ *     }
+ *     static Serial modem(D1, D0);
+ *     if (detected > 0) {
+ *         modem.baud(detected);
+ *     }
+ * }
+ * @endcode
+ */
+class AutoBaud {
+
+public:
+    /** Create an AutoBaud on a serial receive pin
+     *
+     *  @param rx The pin, which must also be a timer capture input
+     */
+    AutoBaud(PinName rx);
+
+    ~AutoBaud();
+
+    /** Watch the pin and measure the rate of the data on it
+     *
+     *  This waits for the whole window, as longer ones see more pulses.
+     *
+     *  @param window_us How long to watch the pin for
+     *
+     *  @returns
+     *    The nearest standard baud rate, or -1 if no whole pulse was seen
+     */
+    int detect(timestamp_t window_us);
+
+    /** Get the shortest pulse detect() saw
+     *
+     *  @returns
+     *    The pulse in micro-seconds, or 0 if none was seen
+     */
+    timestamp_t bit_us() const {
+        return _bit_us;
+    }
+
+    /** Round a measured rate to the nearest standard baud rate
+     *
+     *  The rates are compared by ratio, as a pulse measured a micro-second
+     *  short or long is a fraction of the bit time off, not an amount.
+     *
+     *  @param baudrate The measured rate
+     */
+    static int nearest_standard(uint32_t baudrate);
+
+protected:
+    pwmin_t _pwm;
+    timestamp_t _bit_us;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
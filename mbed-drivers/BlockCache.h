@@ -0,0 +1,189 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_BLOCKCACHE_H
+#define MBED_BLOCKCACHE_H
+
+#include "BlockDevice.h"
+#include <string.h>
+
+namespace mbed {
+
+/** A write-back cache of Blocks blocks in front of another BlockDevice
+ *
+ * Reads are served from the cache where possible, and writes only mark the
+ * cached block dirty. When a block has to be made room for, the least
+ * recently used one is replaced, and written back first if it is dirty.
+ * sync() writes back every dirty block and then syncs the device, so a file
+ * system calling it from fsync() keeps the usual guarantee.
+ *
+ * The cache is held in the object: Blocks * BlockSize bytes plus a few words
+ * per block. BlockSize must match the device's block_size().
+ *
+ * Example:
+ * @code
+ * MySDBlockDevice sd(p5, p6, p7, p8);  // some BlockDevice
+ * BlockCache<8> cache(sd);
+ * // mount the file system on cache rather than sd
+ * @endcode
+ */
+template<unsigned Blocks, unsigned BlockSize = 512>
+class BlockCache : public BlockDevice {
+    typedef char cache_needs_at_least_one_block[Blocks > 0 ? 1 : -1];
+
+public:
+    /** Create a cache in front of a device
+     *
+     *  @param device The device, which must outlive the cache
+     */
+    BlockCache(BlockDevice &device) : _device(device), _clock(0) {
+        for (unsigned i = 0; i < Blocks; i++) {
+            _entries[i].valid = false;
+            _entries[i].dirty = false;
+        }
+    }
+
+    virtual ~BlockCache() {
+        sync();
+    }
+
+    virtual int read(void *buffer, uint32_t block, uint32_t count) {
+        uint8_t *ptr = (uint8_t *)buffer;
+        for (uint32_t i = 0; i < count; i++) {
+            entry_t *e = find(block + i);
+            if (e == NULL) {
+                e = claim(block + i);
+                if (e == NULL || _device.read(e->data, block + i, 1) != 0) {
+                    return -1;
+                }
+                e->valid = true;
+            }
+            memcpy(ptr + i * BlockSize, e->data, BlockSize);
+        }
+        return 0;
+    }
+
+    virtual int write(const void *buffer, uint32_t block, uint32_t count) {
+        const uint8_t *ptr = (const uint8_t *)buffer;
+        for (uint32_t i = 0; i < count; i++) {
+            // a whole block is written, so there is no need to read it first
+            entry_t *e = find(block + i);
+            if (e == NULL) {
+                e = claim(block + i);
+                if (e == NULL) {
+                    return -1;
+                }
+                e->valid = true;
+            }
+            memcpy(e->data, ptr + i * BlockSize, BlockSize);
+            e->dirty = true;
+        }
+        return 0;
+    }
+
+    virtual int sync() {
+        int err = 0;
+        for (unsigned i = 0; i < Blocks; i++) {
+            if (write_back(&_entries[i]) != 0) {
+                err = -1;
+            }
+        }
+        if (_device.sync() != 0) {
+            err = -1;
+        }
+        return err;
+    }
+
+    virtual uint32_t block_size() const {
+        return BlockSize;
+    }
+
+    virtual uint32_t block_count() const {
+        return _device.block_count();
+    }
+
+    /** Drop every cached block without writing any back
+     */
+    void invalidate() {
+        for (unsigned i = 0; i < Blocks; i++) {
+            _entries[i].valid = false;
+            _entries[i].dirty = false;
+        }
+    }
+
+private:
+    struct entry_t {
+        uint32_t block;
+        uint32_t used;      // _clock when last used
+        bool valid;
+        bool dirty;
+        uint8_t data[BlockSize];
+    };
+
+    entry_t *find(uint32_t block) {
+        for (unsigned i = 0; i < Blocks; i++) {
+            if (_entries[i].valid && _entries[i].block == block) {
+                _entries[i].used = ++_clock;
+                return &_entries[i];
+            }
+        }
+        return NULL;
+    }
+
+    /* Make room for a block, returning its entry with valid left unset */
+    entry_t *claim(uint32_t block) {
+        entry_t *victim = &_entries[0];
+        for (unsigned i = 0; i < Blocks; i++) {
+            if (!_entries[i].valid) {
+                victim = &_entries[i];
+                break;
+            }
+            // the counts wrap, so compare ages rather than the counts themselves
+            if ((uint32_t)(_clock - _entries[i].used) > (uint32_t)(_clock - victim->used)) {
+                victim = &_entries[i];
+            }
+        }
+        if (write_back(victim) != 0) {
+            return NULL;
+        }
+        victim->valid = false;
+        victim->block = block;
+        victim->used = ++_clock;
+        return victim;
+    }
+
+    int write_back(entry_t *e) {
+        if (!e->valid || !e->dirty) {
+            return 0;
+        }
+        if (_device.write(e->data, e->block, 1) != 0) {
+            return -1;
+        }
+        e->dirty = false;
+        return 0;
+    }
+
+    BlockDevice &_device;
+    uint32_t _clock;
+    entry_t _entries[Blocks];
+
+    /* disallow copy constructor and assignment operators */
+    BlockCache(const BlockCache&);
+    BlockCache & operator = (const BlockCache&);
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,78 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_BLOCKDEVICE_H
+#define MBED_BLOCKDEVICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mbed {
+
+/** A device made of fixed-size blocks, such as an SD card or a flash chip
+ *
+ * FileSystemLike implementations can be written against this rather than a
+ * particular bus, and stacked on a BlockCache.
+ */
+class BlockDevice {
+public:
+    virtual ~BlockDevice() {
+    }
+
+    /** Read blocks from the device
+     *
+     *  @param buffer The buffer to read in to, count * block_size() bytes long
+     *  @param block The first block to read
+     *  @param count The number of blocks to read
+     *
+     *  @returns
+     *    0 on success, -1 on error
+     */
+    virtual int read(void *buffer, uint32_t block, uint32_t count) = 0;
+
+    /** Write blocks to the device
+     *
+     *  The data may be held back until sync().
+     *
+     *  @param buffer The buffer to write from, count * block_size() bytes long
+     *  @param block The first block to write
+     *  @param count The number of blocks to write
+     *
+     *  @returns
+     *    0 on success, -1 on error
+     */
+    virtual int write(const void *buffer, uint32_t block, uint32_t count) = 0;
+
+    /** Make sure every write has reached the medium
+     *
+     *  @returns
+     *    0 on success, -1 on error
+     */
+    virtual int sync() {
+        return 0;
+    }
+
+    /** Get the size of a block, in bytes
+     */
+    virtual uint32_t block_size() const = 0;
+
+    /** Get the number of blocks on the device
+     */
+    virtual uint32_t block_count() const = 0;
+};
+
+} // namespace mbed
+
+#endif
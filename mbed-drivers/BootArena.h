@@ -0,0 +1,83 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_BOOTARENA_H
+#define MBED_BOOTARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The size of the boot arena, in bytes. The arena is placed in the
+ * .bss.boot_arena section, which the standard linker scripts put in .bss
+ * and a target's script can place explicitly. When 0, there is no arena and
+ * its allocations come from the heap. */
+#ifndef MBED_BOOT_ARENA_SIZE
+#define MBED_BOOT_ARENA_SIZE 0
+#endif
+
+namespace mbed {
+
+/** A bump allocator for objects that live until reset
+ *
+ * Objects that are created once at startup and never destroyed can be
+ * allocated here instead of on the heap, which leaves the heap
+ * unfragmented for runtime allocations. Allocation is a pointer increment
+ * in a critical section; memory is never given back. When the arena is
+ * full, allocations fall back to the heap.
+ *
+ * Example:
+ * @code
+ * Driver *d = new (mbed::boot_arena) Driver(p5);
+ * @endcode
+ */
+class BootArena {
+public:
+    /** Allocate memory for the lifetime of the program
+     *
+     * @param size The number of bytes, rounded up to a multiple of 8
+     * @returns The memory, 8-byte aligned, or NULL if neither the arena
+     *          nor the heap has room
+     */
+    static void *alloc(size_t size);
+
+    /** Check if memory was allocated from the arena, rather than the heap
+     */
+    static bool owns(const void *p);
+
+    /** Get the number of bytes allocated from the arena
+     */
+    static size_t used();
+
+    /** Get the number of bytes left in the arena
+     */
+    static size_t remaining();
+};
+
+/** The tag for allocating with new from the boot arena */
+struct boot_arena_t {
+};
+extern const boot_arena_t boot_arena;
+
+} // namespace mbed
+
+inline void *operator new(size_t size, const mbed::boot_arena_t &) throw() {
+    return mbed::BootArena::alloc(size);
+}
+
+inline void *operator new[](size_t size, const mbed::boot_arena_t &) throw() {
+    return mbed::BootArena::alloc(size);
+}
+
+#endif
@@ -0,0 +1,198 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_BUFFERED_SERIAL_H
+#define MBED_BUFFERED_SERIAL_H
+
+#include "platform.h"
+
+#if DEVICE_SERIAL
+
+#include "SerialBase.h"
+#include "SPSCCircularBuffer.h"
+#include "serial_api.h"
+
+namespace mbed {
+
+/** An interrupt driven serial port with software RX and TX buffers
+ *
+ * Received characters are moved into the RX buffer from the RX interrupt,
+ * so they are not lost while the application is busy. Characters written
+ * are queued in the TX buffer and sent from the TX interrupt, so writing
+ * does not wait for the wire. Both buffers are lock-free rings, with the
+ * interrupt handler on one side and the application on the other; their
+ * sizes must be powers of two.
+ *
+ * Example:
+ * @code
+ * // Echo characters back to the PC
+ *
+ * #include "mbed.h"
+ * #include "mbed-drivers/BufferedSerial.h"
+ *
+ * BufferedSerial<256, 64> modem(p9, p10);
+ *
+ * void echo(void) {
+ *     char buf[16];
+ *     int n = modem.read(buf, sizeof(buf));
+ *     modem.write(buf, n);
+ * }
+ * @endcode
+ */
+template<uint32_t RxBufferSize = 256, uint32_t TxBufferSize = 256>
+class BufferedSerial : public SerialBase {
+
+public:
+    /** Create a BufferedSerial port, connected to the specified transmit and receive pins
+     *
+     *  @param tx Transmit pin
+     *  @param rx Receive pin
+     *
+     *  @note
+     *    Either tx or rx may be specified as NC if unused
+     */
+    BufferedSerial(PinName tx, PinName rx) : SerialBase(tx, rx), _rx_overflows(0) {
+        SerialBase::attach(this, &BufferedSerial::rx_irq, RxIrq);
+        SerialBase::attach(this, &BufferedSerial::tx_irq, TxIrq);
+        // the TX interrupt is only enabled while there is something to send
+        serial_irq_set(&_serial, (SerialIrq)TxIrq, 0);
+    }
+
+    virtual ~BufferedSerial() {
+        serial_irq_set(&_serial, (SerialIrq)RxIrq, 0);
+        serial_irq_set(&_serial, (SerialIrq)TxIrq, 0);
+    }
+
+    /** Write a char to the serial port
+     *
+     * Waits for room in the TX buffer if it is full, so it must not be
+     * called with interrupts disabled.
+     *
+     * @param c The char to write
+     *
+     * @returns The written char
+     */
+    int putc(int c) {
+        char ch = c;
+        while (!_tx_buffer.push(ch)) {
+        }
+        start_tx();
+        return c;
+    }
+
+    /** Read a char from the serial port
+     *
+     * Waits for a char to be received if the RX buffer is empty.
+     *
+     * @returns The char read from the serial port
+     */
+    int getc() {
+        char ch;
+        while (!_rx_buffer.pop(ch)) {
+        }
+        return (unsigned char)ch;
+    }
+
+    /** Write a string to the serial port
+     *
+     * @param str The string to write
+     *
+     * @returns 0 if the write succeeds, EOF for error
+     */
+    int puts(const char *str) {
+        while (*str)
+            putc(*str ++);
+        return 0;
+    }
+
+    /** Queue a block of data for sending, without waiting
+     *
+     * @param data The data to write
+     * @param length The number of bytes in data
+     *
+     * @returns The number of bytes queued, less than length if the TX
+     *  buffer filled up
+     */
+    int write(const void *data, int length) {
+        int n = _tx_buffer.push_n((const char *)data, length);
+        start_tx();
+        return n;
+    }
+
+    /** Read the bytes already received, without waiting
+     *
+     * @param data Filled with the received bytes
+     * @param length The room in data, in bytes
+     *
+     * @returns The number of bytes read
+     */
+    int read(void *data, int length) {
+        return _rx_buffer.pop_n((char *)data, length);
+    }
+
+    /** Get the number of received bytes waiting to be read
+     */
+    int readable() {
+        return _rx_buffer.size();
+    }
+
+    /** Get the room left in the TX buffer, in bytes
+     */
+    int writeable() {
+        return TxBufferSize - _tx_buffer.size();
+    }
+
+    /** Get the number of received bytes dropped because the RX buffer was full
+     */
+    uint32_t rx_overflows() const {
+        return _rx_overflows;
+    }
+
+protected:
+    void start_tx() {
+        if (!_tx_buffer.empty()) {
+            serial_irq_set(&_serial, (SerialIrq)TxIrq, 1);
+        }
+    }
+
+    void rx_irq(void) {
+        while (serial_readable(&_serial)) {
+            char ch = serial_getc(&_serial);
+            if (!_rx_buffer.push(ch)) {
+                _rx_overflows++;
+            }
+        }
+    }
+
+    void tx_irq(void) {
+        char ch;
+        while (serial_writable(&_serial) && _tx_buffer.pop(ch)) {
+            serial_putc(&_serial, ch);
+        }
+        if (_tx_buffer.empty()) {
+            serial_irq_set(&_serial, (SerialIrq)TxIrq, 0);
+        }
+    }
+
+    SPSCCircularBuffer<char, RxBufferSize> _rx_buffer;
+    SPSCCircularBuffer<char, TxBufferSize> _tx_buffer;
+    volatile uint32_t _rx_overflows;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
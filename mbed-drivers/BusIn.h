@@ -18,6 +18,7 @@
 
 #include "platform.h"
 #include "DigitalIn.h"
+#include "BusPort.h"
 
 namespace mbed {
 
@@ -65,7 +66,13 @@ public:
 #endif
 
 protected:
-    DigitalIn* _pin[16];
+    void init(const PinName pins[16]);
+
+    gpio_t _pin[16];    // initialised for the bits set in _connected only
+    int _connected;     // the bus bits with a pin
+#if DEVICE_PORTIN
+    BusPort _port;
+#endif
 
     /* disallow copy constructor and assignment operators */
 private:
@@ -17,6 +17,7 @@
 #define MBED_BUSINOUT_H
 
 #include "DigitalInOut.h"
+#include "BusPort.h"
 
 namespace mbed {
 
@@ -59,10 +60,30 @@ public:
      */
     int read();
 
+    /** Write the given bits of the bus, leaving the others unchanged
+     *
+     *  This is safe against interrupt handlers writing other pins of the
+     *  bus, or of its ports. When the bus is accessed through its ports,
+     *  it takes one atomic port access per group.
+     *
+     *  @param value The value to write
+     *  @param mask The bits of value to write
+     */
+    void write_masked(int value, int mask);
+
     /** Set as an output
+     *
+     *  When the bus is accessed through its ports, this takes one port
+     *  access per group.
      */
     void output();
 
+    /** Set the value to output, then set as an output
+     *
+     *  @param value An integer specifying a bit to write for every corresponding DigitalInOut pin
+     */
+    void output(int value);
+
     /** Set as an input
      */
     void input();
@@ -85,7 +106,13 @@ public:
 #endif
 
 protected:
-    DigitalInOut* _pin[16];
+    void init(const PinName pins[16]);
+
+    gpio_t _pin[16];    // initialised for the bits set in _connected only
+    int _connected;     // the bus bits with a pin
+#if DEVICE_PORTINOUT
+    BusPort _port;
+#endif
 
     /* disallow copy constructor and assignment operators */
 private:
@@ -17,6 +17,7 @@
 #define MBED_BUSOUT_H
 
 #include "DigitalOut.h"
+#include "BusPort.h"
 
 namespace mbed {
 
@@ -49,6 +50,21 @@ public:
      */
     void write(int value);
 
+    /** Write the value to the output bus, changing the pins on each port
+     *  together
+     *
+     *  Each port is written with one set and clear access, which is a
+     *  single store on ports with a BSRR-style register. The pins sharing
+     *  a port never pass through intermediate values, and other pins of
+     *  the port are never read back and rewritten, so an interrupt handler
+     *  writing them can't be undone. A bus spread over several ports
+     *  changes one port at a time; one that can't be accessed through its
+     *  ports is written pin by pin with interrupts masked.
+     *
+     *  @param value An integer specifying a bit to write for every corresponding DigitalOut pin
+     */
+    void write_atomic(int value);
+
     /** Read the value currently output on the bus
      *
      *  @returns
@@ -68,7 +84,13 @@ public:
 #endif
 
 protected:
-    DigitalOut* _pin[16];
+    void init(const PinName pins[16]);
+
+    gpio_t _pin[16];    // initialised for the bits set in _connected only
+    int _connected;     // the bus bits with a pin
+#if DEVICE_PORTOUT
+    BusPort _port;
+#endif
 
    /* disallow copy constructor and assignment operators */
 private:
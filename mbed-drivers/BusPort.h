@@ -0,0 +1,117 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_BUSPORT_H
+#define MBED_BUSPORT_H
+
+#include "platform.h"
+
+#if DEVICE_PORTIN || DEVICE_PORTOUT || DEVICE_PORTINOUT
+
+#include "port_api.h"
+#include "mbed_hal_inline.h"
+
+/* The number of port accesses a bus read or write may take */
+#ifndef BUS_PORT_GROUPS
+#define BUS_PORT_GROUPS 4
+#endif
+
+namespace mbed {
+
+/** The pins of a bus, grouped by port
+ *
+ * The pins of a bus whose bits are consecutive on one port, in order, make
+ * one group, accessed with a single port_write or port_read. Reading or
+ * writing the whole bus takes one port access per group, instead of one
+ * access per pin, and updates the pins of a group at the same time.
+ */
+class BusPort {
+
+public:
+    BusPort() : _groups(0) {
+    }
+
+    /** Group the pins of a bus
+     *
+     *  @param pins The pin of each bus bit, or NC
+     *  @param direction The direction to initialise the ports with
+     *
+     *  @returns
+     *    true if the pins could be grouped, false if the bus has to be
+     *    accessed pin by pin: the HAL could not find the port of a pin, or
+     *    the pins need more than BUS_PORT_GROUPS groups
+     */
+    bool init(const PinName pins[16], PinDirection direction);
+
+    /** Check if the bus is accessed through its ports
+     */
+    bool active() const {
+        return _groups > 0;
+    }
+
+    void write(int value) {
+        for (int g = 0; g < _groups; g++) {
+            int bits = value & _bus_mask[g];
+            mbed_port_write(&_port[g], to_port(g, bits));
+        }
+    }
+
+    /** Write the given bits of the bus with one set and clear access per
+     *  group
+     *
+     *  The pins of each group change together, and no other bits of the
+     *  ports are read or written.
+     */
+    void write_atomic(int value, int mask = 0xFFFF) {
+        for (int g = 0; g < _groups; g++) {
+            int bits = mask & _bus_mask[g];
+            if (bits) {
+                port_set_clear_bits(&_port[g], to_port(g, value & bits), to_port(g, ~value & bits));
+            }
+        }
+    }
+
+    /** Set the direction of every pin, with one port access per group */
+    void dir(PinDirection direction) {
+        for (int g = 0; g < _groups; g++) {
+            port_dir(&_port[g], direction);
+        }
+    }
+
+    int read() {
+        int value = 0;
+        for (int g = 0; g < _groups; g++) {
+            int bits = mbed_port_read(&_port[g]);
+            value |= (_shift[g] >= 0 ? bits >> _shift[g] : bits << -_shift[g]) & _bus_mask[g];
+        }
+        return value;
+    }
+
+protected:
+    int to_port(int g, int bits) const {
+        return _shift[g] >= 0 ? bits << _shift[g] : bits >> -_shift[g];
+    }
+
+    port_t _port[BUS_PORT_GROUPS];
+    int _bus_mask[BUS_PORT_GROUPS];   // the bus bits in each group
+    int _shift[BUS_PORT_GROUPS];      // port bit minus bus bit, in each group
+    int _groups;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -0,0 +1,291 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_CAN_H
+#define MBED_CAN_H
+
+#include "platform.h"
+
+#if DEVICE_CAN
+
+#include "can_api.h"
+#include "can_helper.h"
+#include "SPSCCircularBuffer.h"
+#include "CompletionQueue.h"
+#include "core-util/FunctionPointer.h"
+#include <string.h>
+
+/* Received messages are moved from the controller's FIFO into a software
+ * FIFO of this many messages (a power of two) by the RX interrupt */
+#ifndef CAN_RX_BUFFER_SIZE
+#define CAN_RX_BUFFER_SIZE 16
+#endif
+
+/* Messages written while every hardware mailbox is full wait in a software
+ * queue of this many messages (a power of two), and are sent from the TX
+ * interrupt as mailboxes free up */
+#ifndef CAN_TX_BUFFER_SIZE
+#define CAN_TX_BUFFER_SIZE 8
+#endif
+
+namespace mbed {
+
+/** CANMessage class
+ */
+class CANMessage : public CAN_Message {
+
+public:
+    /** Creates empty CAN message.
+     */
+    CANMessage() : CAN_Message() {
+        len    = 8;
+        type   = CANData;
+        format = CANStandard;
+        id     = 0;
+        memset(data, 0, 8);
+    }
+
+    /** Creates CAN message with specific content.
+     */
+    CANMessage(int _id, const char *_data, char _len = 8, CANType _type = CANData, CANFormat _format = CANStandard) {
+        len    = _len & 0xF;
+        type   = _type;
+        format = _format;
+        id     = _id;
+        memcpy(data, _data, _len);
+    }
+
+    /** Creates CAN remote message.
+     */
+    CANMessage(int _id, CANFormat _format = CANStandard) {
+        len    = 0;
+        type   = CANRemote;
+        format = _format;
+        id     = _id;
+        memset(data, 0, 8);
+    }
+};
+
+/** A can bus client, used for communicating with can devices
+ *
+ * Only the messages that pass the acceptance filters set with filter()
+ * reach the CPU. The RX interrupt moves them into a software FIFO, from
+ * which read() takes them, and the function attached with
+ * attach_received() is scheduled to run in main context when there are
+ * messages to read. write() fills every hardware mailbox, then queues in
+ * software; the queue drains from the TX interrupt in order.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * CAN can(p30, p29);
+ *
+ * void received(void) {
+ *     CANMessage msg;
+ *     while (can.read(msg)) {
+ *         printf("Message received: %d\n", msg.data[0]);
+ *     }
+ * }
+ *
+ * void app_start(int, char **) {
+ *     can.frequency(500000);
+ *     can.filter(0x100, 0x7F0, CANStandard);   // IDs 0x100 to 0x10F
+ *     can.attach_received(received);
+ * }
+ * @endcode
+ */
+class CAN {
+
+public:
+    /** Creates an CAN interface connected to specific pins.
+     *
+     *  @param rd read from transmitter
+     *  @param td transmit to transmitter
+     */
+    CAN(PinName rd, PinName td);
+    virtual ~CAN();
+
+    /** Set the frequency of the CAN interface
+     *
+     *  @param hz The bus frequency in hertz
+     *
+     *  @returns
+     *    1 if successful,
+     *    0 otherwise
+     */
+    int frequency(int hz);
+
+    /** Write a CANMessage to the bus.
+     *
+     *  @param msg The CANMessage to write.
+     *
+     *  @returns
+     *    0 if the message could not be queued,
+     *    1 if it was written to a mailbox or queued behind them
+     */
+    int write(const CANMessage &msg);
+
+    /** Read a CANMessage from the receive FIFO.
+     *
+     *  @param msg A CANMessage to read to.
+     *
+     *  @returns
+     *    0 if no message arrived,
+     *    1 if message arrived
+     */
+    int read(CANMessage &msg);
+
+    /** Reset CAN interface.
+     *
+     * To use after error overflow.
+     */
+    void reset();
+
+    /** Puts or removes the CAN interface into silent monitoring mode
+     *
+     *  @param silent boolean indicating whether to go into silent mode or not
+     */
+    void monitor(bool silent);
+
+    enum Mode {
+        Reset = 0,
+        Normal,
+        Silent,
+        LocalTest,
+        GlobalTest,
+        SilentTest
+    };
+
+    /** Change CAN operation to the specified mode
+     *
+     *  @param mode The new operation mode (CAN::Normal, CAN::Silent, CAN::LocalTest, CAN::GlobalTest, CAN::SilentTest)
+     *
+     *  @returns
+     *    0 if mode change failed or unsupported,
+     *    1 if mode change was successful
+     */
+    int mode(Mode mode);
+
+    /** Set an acceptance filter in one of the controller's filter banks
+     *
+     *  A message is received if its ID, masked with mask, equals id masked
+     *  with mask, for any of the filters set.
+     *
+     *  @param id The ID to accept
+     *  @param mask The bits of the ID that have to match
+     *  @param format The frame format the filter applies to (CANStandard, CANExtended or CANAny)
+     *  @param handle The filter bank to use, or 0 for the HAL to choose one
+     *
+     *  @returns
+     *    0 if the filter could not be set,
+     *    the filter bank's handle otherwise
+     */
+    int filter(unsigned int id, unsigned int mask, CANFormat format = CANAny, int handle = 0);
+
+    /** Returns number of read errors to detect read overflow errors.
+     */
+    unsigned char rderror();
+
+    /** Returns number of write errors to detect write overflow errors.
+     */
+    unsigned char tderror();
+
+    /** Get the number of messages dropped because the receive FIFO was full
+     */
+    uint32_t rx_dropped() const {
+        return _rx_dropped;
+    }
+
+    enum IrqType {
+        RxIrq = 0,
+        TxIrq,
+        EwIrq,
+        DoIrq,
+        WuIrq,
+        EpIrq,
+        AlIrq,
+        BeIrq,
+        IdIrq
+    };
+
+    /** Attach a function to call whenever a CAN frame received interrupt is
+     *  generated.
+     *
+     *  The function runs in the interrupt handler. For RxIrq and TxIrq, it
+     *  runs after the driver has moved messages to the receive FIFO, or
+     *  from the transmit queue.
+     *
+     *  @param fptr A pointer to a void function, or 0 to set as none
+     *  @param type Which CAN interrupt to attach the member function to (CAN::RxIrq for message received, CAN::TxIrq for transmitted or aborted, CAN::EwIrq for error warning, CAN::DoIrq for data overrun, CAN::WuIrq for wake-up, CAN::EpIrq for error passive, CAN::AlIrq for arbitration lost, CAN::BeIrq for bus error)
+     */
+    void attach(void (*fptr)(void), IrqType type = RxIrq);
+
+    /** Attach a member function to call whenever a CAN frame received interrupt
+     *  is generated.
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *  @param type Which CAN interrupt to attach the member function to
+     */
+    template<typename T>
+    void attach(T* tptr, void (T::*mptr)(void), IrqType type = RxIrq) {
+        if ((mptr != NULL) && (tptr != NULL)) {
+            _irq[type].attach(tptr, mptr);
+            enable_irq(type);
+        } else {
+            disable_irq(type);
+        }
+    }
+
+    /** Attach a function to schedule when messages are received
+     *
+     *  The function runs in main context, once for any number of messages
+     *  received before it runs, and should read() until the FIFO is empty.
+     *
+     *  @param callback The function to schedule
+     */
+    void attach_received(const mbed::util::FunctionPointer0<void> &callback);
+
+    static void _irq_handler(uint32_t id, CanIrqType type);
+
+protected:
+    void enable_irq(IrqType type);
+    void disable_irq(IrqType type);
+
+    /** Move received messages from the controller to the receive FIFO */
+    void drain_rx();
+
+    /** Move queued messages into free hardware mailboxes */
+    void fill_tx();
+
+    /** Call the function attached with attach_received(), in main context */
+    void deliver_received();
+
+    can_t _can;
+    mbed::util::FunctionPointer _irq[9];
+    mbed::util::FunctionPointer0<void> _received;
+    CompletionQueue::Slot _received_completion;
+    volatile bool _received_pending;        /**< Set while a delivery is posted */
+    volatile uint32_t _rx_dropped;
+    SPSCCircularBuffer<CANMessage, CAN_RX_BUFFER_SIZE> _rx_buffer;
+    SPSCCircularBuffer<CANMessage, CAN_TX_BUFFER_SIZE> _tx_buffer;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_CRC_H
+#define MBED_CRC_H
+
+#include "platform.h"
+#include "Buffer.h"
+#include "CompletionQueue.h"
+#include "core-util/FunctionPointer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#if DEVICE_CRC
+#include "crc_api.h"
+#endif
+#if DEVICE_CRC_ASYNCH
+#include "CThunk.h"
+#include "dma_api.h"
+#include "mbed_sleep.h"
+#include "DMAManager.h"
+#endif
+
+/* The software CRCs process four bytes per step with four lookup tables,
+ * of 4kB for CRC32 and 2kB for CRC16. Set this to 0 to use one table per
+ * CRC, a quarter of the size, processing a byte per step. */
+#ifndef CRC_SLICING_BY_4
+#define CRC_SLICING_BY_4 1
+#endif
+
+namespace mbed {
+
+/** A CRC calculator, using the CRC peripheral where there is one
+ *
+ * The CRC can be computed over data in pieces, as it arrives, with
+ * update(), so a frame can be checked as its bytes are received, and
+ * finished by the time the last one is. Where there is no CRC peripheral,
+ * or it is taken by another CRC, or it can't compute the type asked for,
+ * a table-driven software implementation is used.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * CRC crc(CRC::CRC32);
+ *
+ * bool frame_valid(const uint8_t *frame, size_t length) {
+ *     uint32_t expected;
+ *     memcpy(&expected, frame + length - 4, 4);
+ *     crc.reset();
+ *     crc.update(frame, length - 4);
+ *     return crc.result() == expected;
+ * }
+ * @endcode
+ */
+class CRC {
+
+public:
+    enum Type {
+        CRC16_CCITT,    /**< Polynomial 0x1021, initial value 0xFFFF, not reflected */
+        CRC32           /**< The IEEE 802.3 CRC: polynomial 0x04C11DB7, initial value and final XOR 0xFFFFFFFF, reflected */
+    };
+
+    /** Computation callback, called with the data and the CRC so far
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, uint32_t> event_callback_t;
+
+    /** Create a CRC calculator, reset to the initial value
+     *
+     *  @param type The CRC to compute
+     */
+    CRC(Type type);
+    ~CRC();
+
+    /** Start a new CRC
+     */
+    void reset();
+
+    /** Add data to the CRC
+     *
+     *  @param data The data
+     *  @param length The number of bytes
+     */
+    void update(const void *data, size_t length);
+
+    /** Add data to the CRC in the background
+     *
+     *  Where the CRC peripheral can be fed by DMA, set_dma_usage() allows,
+     *  the CPU is free while the data is read. Otherwise the CRC is
+     *  computed before this returns. Either way the callback is scheduled
+     *  to run in main context.
+     *
+     *  @param data The data, which must not change until the callback
+     *  @param callback The function to call with the data and the CRC so far
+     *  @returns 0 if the computation started, or -1 if one is in progress
+     */
+    int update(const Buffer &data, const event_callback_t &callback);
+
+    /** Get the CRC of the data added since the last reset
+     */
+    uint32_t result();
+
+    /** Check if a background computation is in progress
+     */
+    bool busy() const {
+        return _busy;
+    }
+
+    /** Check if the CRC is computed by the CRC peripheral
+     */
+    bool hardware() const {
+        return _hardware;
+    }
+
+#if DEVICE_CRC_ASYNCH
+    /** Configure DMA usage suggestion for background computations
+     *
+     *  @param usage The usage DMA hint for peripheral
+     *  @return Zero if the usage was set, -1 if a computation is in progress
+     */
+    int set_dma_usage(DMAUsage usage);
+#endif
+
+    /** Compute the CRC of a block of data in software
+     *
+     *  @param type The CRC to compute
+     *  @param data The data
+     *  @param length The number of bytes
+     *  @returns The CRC
+     */
+    static uint32_t compute(Type type, const void *data, size_t length);
+
+protected:
+    static uint32_t initial(Type type);
+    static uint32_t software_update(Type type, uint32_t crc, const uint8_t *data, size_t length);
+    static uint32_t software_result(Type type, uint32_t crc);
+
+    void finish();
+
+#if DEVICE_CRC
+    crc_t _crc_hw;
+#endif
+#if DEVICE_CRC_ASYNCH
+    void irq_handler_asynch(void);
+
+    DeepSleepLock _deep_sleep;  /**< Held while a DMA computation runs */
+    CThunk<CRC> _irq;
+    DMAChannel _dma;
+#endif
+    Type _type;
+    uint32_t _crc;              /**< The software CRC register */
+    bool _hardware;
+    volatile bool _busy;
+    Buffer _buffer;             /**< The data of the background computation */
+    event_callback_t _callback;
+    CompletionQueue::Slot _completion;
+
+    /* disallow copy constructor and assignment operators */
+private:
+    CRC(const CRC&);
+    CRC & operator = (const CRC&);
+};
+
+} // namespace mbed
+
+#endif
@@ -24,6 +24,19 @@
 
 #define CTHUNK_ADDRESS 1
 
+/* The number of thunks in a pool shared by every CThunk, or 0 for each
+ * CThunk to hold its thunk code itself. With a pool, the drivers' objects
+ * hold no code, so only the pool need be in executable RAM: the linker
+ * script places it in the section CTHUNK_POOL_SECTION, which can be the one
+ * region the MPU leaves executable. */
+#ifndef CTHUNK_POOL_SIZE
+#define CTHUNK_POOL_SIZE 0
+#endif
+
+#ifndef CTHUNK_POOL_SECTION
+#define CTHUNK_POOL_SECTION ".cthunk_pool"
+#endif
+
 #if defined(TARGET_LIKE_CORTEX_M3) || defined(TARGET_LIKE_CORTEX_M4)
 #define CTHUNK_VARIABLES volatile uint32_t code[1]
 /**
@@ -36,10 +49,16 @@
 * This is safe for both regular calling and interrupt calling, since it only touches scratch registers
 * which should be saved by the caller, and are automatically saved as part of the IRQ context switch.
 */
-#define CTHUNK_ASSIGMENT m_thunk.code[0] = 0x8007E89F
+#define CTHUNK_ASSIGMENT(thunk) (thunk).code[0] = 0x8007E89F
 
-#elif defined(TARGET_LIKE_CORTEX_M0PLUS) || defined(TARGET_LIKE_CORTEX_M0)
+#elif defined(TARGET_LIKE_CORTEX_M0PLUS) || defined(TARGET_LIKE_CORTEX_M0) || \
+      defined(TARGET_LIKE_CORTEX_M7) || defined(TARGET_LIKE_CORTEX_M33)
 /*
+* Cortex-M7 and M33 use the Cortex-M0 sequence too: an LDM based on the PC,
+* as used for M3/M4, is UNPREDICTABLE in ARMv7-M and ARMv8-M, and does
+* not work on every implementation, whereas this Thumb code runs on all of
+* them.
+*
 * CTHUNK disassembly for Cortex M0 (thumb):
 * * push {r0,r1,r2,r3,r4,lr} save touched registers and return address
 * * movs r4,#4 set up address to load arguments from (immediately following this code block) (1)
@@ -49,19 +68,82 @@
 * * pop {r0,r1,r2,r3,r4,pc} restore scratch registers and return from function
 */
 #define CTHUNK_VARIABLES volatile uint32_t code[3]
-#define CTHUNK_ASSIGMENT do {                              \
-                             m_thunk.code[0] = 0x2404B51F; \
-                             m_thunk.code[1] = 0xCC0F447C; \
-                             m_thunk.code[2] = 0xBD1F4798; \
-                         } while (0)
+#define CTHUNK_ASSIGMENT(thunk) do {                         \
+                                    (thunk).code[0] = 0x2404B51F; \
+                                    (thunk).code[1] = 0xCC0F447C; \
+                                    (thunk).code[2] = 0xBD1F4798; \
+                                } while (0)
 
 #else
 #error "Target is not currently suported."
 #endif
 
+/* Make the thunk code just written visible to instruction fetches. On
+ * Cortex-M7 the code may still be in the data cache, and stale code for
+ * that address in the instruction cache. */
+#if defined(TARGET_LIKE_CORTEX_M7)
+static inline void cthunk_sync(const volatile void *code, uint32_t size)
+{
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+    // the thunk needn't be aligned, so clean every line it touches
+    uint32_t start = (uint32_t)code & ~31u;
+    SCB_CleanDCache_by_Addr((uint32_t *)start, ((uint32_t)code + size) - start);
+#else
+    (void)code;
+    (void)size;
+#endif
+    __DSB();
+#if defined(__ICACHE_PRESENT) && (__ICACHE_PRESENT == 1U)
+    SCB_InvalidateICache();
+#endif
+    __ISB();
+}
+#else
+static inline void cthunk_sync(const volatile void *code, uint32_t size)
+{
+    (void)code;
+    (void)size;
+    __DSB();
+    __ISB();
+}
+#endif
+
 /* IRQ/Exception compatible thunk entry function */
 typedef void (*CThunkEntry)(void);
 
+// TODO: this needs proper fix, to refactor toolchain header file and all its use
+// PACKED there is not defined properly for IAR
+#if defined (__ICCARM__)
+typedef __packed struct
+{
+    CTHUNK_VARIABLES;
+    volatile uint32_t instance;
+    volatile uint32_t context;
+    volatile uint32_t callback;
+    volatile uint32_t trampoline;
+}  CThunkTrampoline;
+#else
+typedef struct
+{
+    CTHUNK_VARIABLES;
+    volatile uint32_t instance;
+    volatile uint32_t context;
+    volatile uint32_t callback;
+    volatile uint32_t trampoline;
+} __attribute__((__packed__)) CThunkTrampoline;
+#endif
+
+#if CTHUNK_POOL_SIZE
+/* Take a thunk from the pool, its code already in place. The first call
+ * writes the code of the whole pool and makes it visible to instruction
+ * fetches, so taking a thunk only writes data words. Calls error() if the
+ * pool is exhausted. */
+volatile CThunkTrampoline *cthunk_pool_alloc(void);
+
+/* Give a thunk back to the pool */
+void cthunk_pool_free(volatile CThunkTrampoline *thunk);
+#endif
+
 template<class T>
 class CThunk
 {
@@ -80,7 +162,9 @@ class CThunk
         }
 
         ~CThunk() {
-
+#if CTHUNK_POOL_SIZE
+            cthunk_pool_free(m_thunk);
+#endif
         }
 
         inline CThunk(T *instance, CCallbackSimple callback)
@@ -115,17 +199,17 @@ class CThunk
 
         inline void context(void* context)
         {
-            m_thunk.context = (uint32_t)context;
+            thunk().context = (uint32_t)context;
         }
 
         inline void context(uint32_t context)
         {
-            m_thunk.context = context;
+            thunk().context = context;
         }
 
         inline uint32_t entry(void)
         {
-            return (((uint32_t)&m_thunk)|CTHUNK_ADDRESS);
+            return (((uint32_t)&thunk())|CTHUNK_ADDRESS);
         }
 
         /* get thunk entry point for connecting rhunk to an IRQ table */
@@ -150,28 +234,6 @@ class CThunk
         T* m_instance;
         volatile CCallback m_callback;
 
-// TODO: this needs proper fix, to refactor toolchain header file and all its use
-// PACKED there is not defined properly for IAR
-#if defined (__ICCARM__)
-        typedef __packed struct
-        {
-            CTHUNK_VARIABLES;
-            volatile uint32_t instance;
-            volatile uint32_t context;
-            volatile uint32_t callback;
-            volatile uint32_t trampoline;
-        }  CThunkTrampoline;
-#else
-        typedef struct
-        {
-            CTHUNK_VARIABLES;
-            volatile uint32_t instance;
-            volatile uint32_t context;
-            volatile uint32_t callback;
-            volatile uint32_t trampoline;
-        } __attribute__((__packed__)) CThunkTrampoline;
-#endif
-
         static void trampoline(T* instance, void* context, CCallback* callback)
         {
             if(instance && *callback) {
@@ -179,8 +241,22 @@ class CThunk
             }
         }
 
+#if CTHUNK_POOL_SIZE
+        volatile CThunkTrampoline *m_thunk;
+
+        inline volatile CThunkTrampoline &thunk(void)
+        {
+            return *m_thunk;
+        }
+#else
         volatile CThunkTrampoline m_thunk;
 
+        inline volatile CThunkTrampoline &thunk(void)
+        {
+            return m_thunk;
+        }
+#endif
+
         inline void init(T *instance, CCallback callback, void* context)
         {
             /* remember callback - need to add this level of redirection
@@ -188,14 +264,21 @@ class CThunk
             m_callback = callback;
 
             /* populate thunking trampoline */
-            CTHUNK_ASSIGMENT;
-            m_thunk.context = (uint32_t)context;
-            m_thunk.instance = (uint32_t)instance;
-            m_thunk.callback = (uint32_t)&m_callback;
-            m_thunk.trampoline = (uint32_t)&trampoline;
-
-            __ISB();
-            __DSB();
+#if CTHUNK_POOL_SIZE
+            // the pool's code is in place, and only data is written here,
+            // which the thunk loads through the data side
+            m_thunk = cthunk_pool_alloc();
+#else
+            CTHUNK_ASSIGMENT(m_thunk);
+#endif
+            thunk().context = (uint32_t)context;
+            thunk().instance = (uint32_t)instance;
+            thunk().callback = (uint32_t)&m_callback;
+            thunk().trampoline = (uint32_t)&trampoline;
+
+#if !CTHUNK_POOL_SIZE
+            cthunk_sync(&m_thunk, sizeof(m_thunk));
+#endif
         }
 };
 
@@ -55,6 +55,17 @@ namespace mbed {
  *     chain.call();
  * }
  * @endcode
+ *
+ * The chain can be changed while call() runs in an interrupt, or from the
+ * functions that call() is calling, without masking interrupts. call()
+ * walks an array that is never changed behind it: adding at the end fills
+ * a free slot past the last function, and the other changes build a new
+ * array and switch to it with a single store. When call() is running, in
+ * this context or one it interrupted, the arrays and function objects
+ * that were replaced or removed are kept until a later change finds no
+ * call() running. This relies on a single core, where an interrupting
+ * call() always finishes before the code it interrupted resumes. Changes
+ * must still not race each other.
  */
 
 typedef mbed::util::FunctionPointer* pFunctionPointer_t;
@@ -148,9 +159,19 @@ public:
     bool remove(pFunctionPointer_t f);
 
     /** Call all the functions in the chain in sequence
+     *
+     * Functions added or removed by the functions being called take effect
+     * from the next call().
      */
     void call();
 
+    /** Check whether call() is running, in this context or one it
+     *  interrupted
+     */
+    bool in_call() const {
+        return _readers != 0;
+    }
+
 #ifdef MBED_OPERATORS
     void operator ()(void) {
         call();
@@ -161,13 +182,26 @@ public:
 #endif
 
 private:
-    void _check_size();
+    // an array or a function object that call() may still be using
+    struct retired_t {
+        retired_t *next;
+        pFunctionPointer_t *chain;
+        pFunctionPointer_t function;
+    };
+
+    pFunctionPointer_t* _new_chain(int size);
+    void _publish(pFunctionPointer_t *chain);
+    void _retire(pFunctionPointer_t *chain, pFunctionPointer_t function);
+    void _reclaim();
     pFunctionPointer_t common_add(pFunctionPointer_t pf);
     pFunctionPointer_t common_add_front(pFunctionPointer_t pf);
 
-    pFunctionPointer_t* _chain;
+    // _size functions and a NULL terminator; slots past the last function are NULL
+    pFunctionPointer_t* volatile _chain;
     int _size;
     int _elements;
+    volatile int _readers;
+    retired_t *_retired;
 
     /* disallow copy constructor and assignment operators */
 private:
@@ -16,13 +16,29 @@
 #ifndef MBED_CIRCULARBUFFER_H
 #define MBED_CIRCULARBUFFER_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 namespace mbed {
 
 /** Templated Circular buffer class
+ *
+ * As well as one element at a time, elements can be pushed and popped in
+ * bulk, or read and written where they are stored: linear_read_region()
+ * and linear_write_region() give the contents and the free space as up to
+ * two contiguous regions, which can be handed to DMA, and consume() and
+ * produce() account for what was read or written there.
  */
 template<typename T, uint32_t BufferSize, typename CounterType = uint32_t>
 class CircularBuffer {
 public:
+    /** A contiguous run of elements in the buffer
+     */
+    struct region_t {
+        T *data;                /**< The first element, or NULL if the run is empty */
+        CounterType length;     /**< The number of elements */
+    };
+
     CircularBuffer() : _head(0), _tail(0), _full(false) {
     }
 
@@ -46,6 +62,61 @@ public:
         }
     }
 
+    /** Push elements to the buffer. This overwrites the oldest elements if
+     *  there isn't room for them all
+     *
+     * @param data The elements to push
+     * @param n The number of elements in data
+     */
+    void push(const T *data, CounterType n) {
+        for (CounterType i = 0; i < n; i++) {
+            push(data[i]);
+        }
+    }
+
+    /** Claim the slot for the next element, to be filled in place
+     *
+     * Like push(), this overwrites the oldest element if the buffer is full.
+     * The slot holds whatever was last stored in it, so every member the
+     * caller relies on has to be set.
+     *
+     * @return The slot, which stays valid until the element is popped
+     */
+    T *emplace() {
+        if (full()) {
+            _tail++;
+            _tail %= BufferSize;
+        }
+        T *slot = &_pool[_head++];
+        _head %= BufferSize;
+        if (_head == _tail) {
+            _full = true;
+        }
+        return slot;
+    }
+
+    /** Get the oldest element in place
+     *
+     * @return The oldest element, valid until it is popped, or NULL if the buffer is empty
+     */
+    T *front() {
+        return empty() ? NULL : &_pool[_tail];
+    }
+
+    /** Drop the oldest element from the buffer
+     *
+     * @return True if an element was dropped, false if the buffer is empty
+     */
+    bool pop() {
+        if (!empty()) {
+            _tail++;
+            _tail %= BufferSize;
+            _full = false;
+            return true;
+        }
+        return false;
+    }
+
     /** Pop the transaction from the buffer
      *
      * @param data Data to be pushed to the buffer
@@ -61,11 +132,91 @@ public:
         return false;
     }
 
+    /** Pop up to n elements from the buffer
+     *
+     * @param data Filled with the popped elements, oldest first
+     * @param n The room in data, in elements
+     * @return The number of elements popped
+     */
+    CounterType pop(T *data, CounterType n) {
+        CounterType available = size();
+        if (n > available) {
+            n = available;
+        }
+        for (CounterType i = 0; i < n; i++) {
+            data[i] = _pool[_tail++];
+            _tail %= BufferSize;
+        }
+        if (n) {
+            _full = false;
+        }
+        return n;
+    }
+
+    /** Get the oldest element without removing it
+     *
+     * @param data Set to the oldest element
+     * @return True if there was an element, false if the buffer is empty
+     */
+    bool peek(T& data) const {
+        if (empty()) {
+            return false;
+        }
+        data = _pool[_tail];
+        return true;
+    }
+
+    /** Get the elements in the buffer where they are stored
+     *
+     * @param first Set to the oldest elements, up to the end of the storage
+     * @param second Set to the rest of the elements, from the start of the storage
+     */
+    void linear_read_region(region_t &first, region_t &second) {
+        CounterType used = size();
+        CounterType run = BufferSize - _tail;
+        set_regions(first, second, _tail, used < run ? used : run, used);
+    }
+
+    /** Get the free space in the buffer where it is stored
+     *
+     * Elements written there are only added by produce().
+     *
+     * @param first Set to the space after the newest element, up to the end of the storage
+     * @param second Set to the rest of the space, from the start of the storage
+     */
+    void linear_write_region(region_t &first, region_t &second) {
+        CounterType space = BufferSize - size();
+        CounterType run = BufferSize - _head;
+        set_regions(first, second, _head, space < run ? space : run, space);
+    }
+
+    /** Drop the n oldest elements, after reading them in place
+     *
+     * @param n The number of elements, at most size()
+     */
+    void consume(CounterType n) {
+        if (n) {
+            _tail = (_tail + n) % BufferSize;
+            _full = false;
+        }
+    }
+
+    /** Add n elements written in place to the free space
+     *
+     * @param n The number of elements, at most the free space
+     */
+    void produce(CounterType n) {
+        if (n) {
+            _head = (_head + n) % BufferSize;
+            _full = (_head == _tail);
+        }
+    }
+
     /** Check if the buffer is empty
      *
      * @return True if the buffer is empty, false if not
      */
-    bool empty() {
+    bool empty() const {
         return (_head == _tail) && !_full;
     }
 
@@ -73,10 +224,19 @@ public:
      *
      * @return True if the buffer is full, false if not
      */
-    bool full() {
+    bool full() const {
         return _full;
     }
 
+    /** Get the number of elements in the buffer
+     */
+    CounterType size() const {
+        if (_full) {
+            return BufferSize;
+        }
+        return (_head + BufferSize - _tail) % BufferSize;
+    }
+
     /** Reset the buffer
      *
      */
@@ -87,6 +247,13 @@ public:
     }
 
 private:
+    void set_regions(region_t &first, region_t &second, CounterType start, CounterType run, CounterType total) {
+        first.data = run ? &_pool[start] : NULL;
+        first.length = run;
+        second.data = (total > run) ? &_pool[0] : NULL;
+        second.length = total - run;
+    }
+
     T _pool[BufferSize];
     CounterType _head;
     CounterType _tail;
@@ -0,0 +1,199 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_COMPLETIONQUEUE_H
+#define MBED_COMPLETIONQUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core-util/FunctionPointer.h"
+
+/* The number of completions that can be waiting for the scheduler at once,
+ * shared by all the drivers */
+#ifndef COMPLETION_QUEUE_SIZE
+#define COMPLETION_QUEUE_SIZE 8
+#endif
+
+/* How many completions of each priority one scheduler pass runs, or 0 for
+ * no limit. Once every priority with completions waiting has used up its
+ * budget, the pass ends, and the rest run in a later one, after whatever
+ * minar has queued meanwhile. See CompletionQueue::set_budget(). */
+#ifndef COMPLETION_QUEUE_BUDGET_HIGH
+#define COMPLETION_QUEUE_BUDGET_HIGH 0
+#endif
+#ifndef COMPLETION_QUEUE_BUDGET_NORMAL
+#define COMPLETION_QUEUE_BUDGET_NORMAL 0
+#endif
+#ifndef COMPLETION_QUEUE_BUDGET_LOW
+#define COMPLETION_QUEUE_BUDGET_LOW 0
+#endif
+
+namespace mbed {
+
+/** Runs the drivers' bound completion callbacks from the scheduler
+ *
+ * Posting every completion to minar allocates a callback node for each
+ * one. Completions posted here are instead queued, and a single minar
+ * callback runs everything queued, so a burst of completions costs one
+ * scheduler allocation. A driver can hold a Slot for its completions, which
+ * is simply filled in and marked pending from the interrupt handler; other
+ * completions, and those posted while the driver's slot is still pending,
+ * are copied into a statically reserved ObjectPool slot. When the pool is
+ * exhausted, the completion is posted to minar directly, so none are lost.
+ *
+ * Each completion has a priority, taken from its slot or given to post().
+ * A pass runs the first completion of the highest priority that has any
+ * waiting and budget left, so completions of the same priority run in the
+ * order they were posted. A budget on a busy priority, such as that of a
+ * serial port's receive events, keeps it from holding up the others and the
+ * rest of the scheduler's callbacks.
+ */
+class CompletionQueue {
+public:
+    /** The order completions run in, highest first
+     */
+    enum Priority {
+        PRIORITY_HIGH,      /**< Run before any other, as for a stream that must be kept fed */
+        PRIORITY_NORMAL,    /**< The default */
+        PRIORITY_LOW,       /**< Run once nothing else is waiting */
+        PRIORITIES
+    };
+
+    /** A preallocated place for one pending completion
+     *
+     * A slot is free again once its callback has been taken out to run, so
+     * the callback may post to the same slot. Destroying a pending slot
+     * drops its completion.
+     */
+    class Slot {
+    public:
+        Slot() : _next(NULL), _pending(false), _priority(PRIORITY_NORMAL) {
+        }
+
+        /** Create a slot holding a callback, for post(slot)
+         *
+         *  The callback is bound once, so posting it from an interrupt
+         *  handler copies nothing.
+         *
+         *  @param callback The bound callback
+         */
+        Slot(const mbed::util::FunctionPointerBind<void> &callback) :
+                _callback(callback), _next(NULL), _pending(false), _priority(PRIORITY_NORMAL) {
+        }
+
+        ~Slot() {
+            if (_pending) {
+                CompletionQueue::remove(this);
+            }
+        }
+
+        /** Check if the slot holds a completion that has not run yet
+         */
+        bool pending() const {
+            return _pending;
+        }
+
+        /** Set the priority of the completions posted to this slot
+         *
+         *  Completions posted instead of it, while it is pending, take the
+         *  same priority. A pending completion keeps its old priority.
+         *
+         *  @param priority The priority
+         */
+        void set_priority(Priority priority) {
+            _priority = priority;
+        }
+
+        /** Get the priority of the completions posted to this slot
+         */
+        Priority priority() const {
+            return (Priority)_priority;
+        }
+
+    private:
+        friend class CompletionQueue;
+
+        mbed::util::FunctionPointerBind<void> _callback;
+        Slot *_next;
+        volatile bool _pending;
+        uint8_t _priority;
+        uint8_t _queued;        // the priority it is queued at, while pending
+
+        /* disallow copy constructor and assignment operators */
+        Slot(const Slot&);
+        Slot & operator = (const Slot&);
+    };
+
+    /** Queue a bound callback to run from the scheduler
+     *
+     * This can be called from interrupt handlers.
+     *
+     * @param callback The bound callback
+     * @param priority The priority to run it at
+     */
+    static void post(const mbed::util::FunctionPointerBind<void> &callback, Priority priority = PRIORITY_NORMAL);
+
+    /** Queue a bound callback to run from the scheduler, in a given slot
+     *
+     * If the slot is still pending, the callback is posted as by
+     * post(callback, slot.priority()) instead. This can be called from interrupt handlers.
+     *
+     * @param slot The slot to hold the callback
+     * @param callback The bound callback
+     */
+    static void post(Slot &slot, const mbed::util::FunctionPointerBind<void> &callback);
+
+    /** Queue the callback a slot was created with
+     *
+     * If the slot is still pending, nothing more is queued: the callback
+     * that is waiting runs once for both. This can be called from interrupt
+     * handlers.
+     *
+     * @param slot The slot, created with its callback
+     */
+    static void post(Slot &slot);
+
+    /** Drop the completion a slot holds, if it hasn't run yet
+     *
+     * This can be called from interrupt handlers.
+     *
+     * @param slot The slot
+     */
+    static void cancel(Slot &slot);
+
+    /** Get the number of completions posted to minar directly because the
+     *  pool was exhausted
+     */
+    static uint32_t overflows();
+
+    /** Set how many completions of a priority one scheduler pass runs
+     *
+     *  This starts out as the COMPLETION_QUEUE_BUDGET_ option of the
+     *  priority.
+     *
+     *  @param priority The priority
+     *  @param per_pass The most to run per pass, or 0 for no limit
+     */
+    static void set_budget(Priority priority, uint16_t per_pass);
+
+private:
+    static void enqueue(Slot *slot);
+    static void remove(Slot *slot);
+    static void drain();
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,247 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_COROUTINE_H
+#define MBED_COROUTINE_H
+
+#include "platform.h"
+#include "Buffer.h"
+#include "CompletionQueue.h"
+#include "Timeout.h"
+#include "core-util/FunctionPointer.h"
+
+#if DEVICE_SPI_ASYNCH
+#include "SPI.h"
+#endif
+#if DEVICE_I2C_ASYNCH
+#include "I2C.h"
+#endif
+#if DEVICE_SERIAL_ASYNCH
+#include "SerialBase.h"
+#endif
+
+/** Start the body of Coroutine::run()
+ */
+#define MBED_CO_BEGIN() switch (_co_state) { case 0:
+
+/** Start an operation and continue from here once it completes
+ *
+ * If the operation cannot be started, the body continues straight away
+ * and event() returns Coroutine::FAILED.
+ */
+#define MBED_CO_AWAIT(operation)            \
+    do {                                    \
+        _co_state = __LINE__;               \
+        if (suspend(operation)) {           \
+            return;                         \
+        }                                   \
+        case __LINE__:;                     \
+    } while (0)
+
+/** Let the scheduler run other callbacks, and continue from here
+ */
+#define MBED_CO_YIELD() MBED_CO_AWAIT(yield())
+
+/** End the body of Coroutine::run()
+ */
+#define MBED_CO_END() } _co_state = Coroutine::STATE_DONE
+
+namespace mbed {
+
+/** A stackless coroutine, run from the scheduler, that awaits driver operations
+ *
+ * A sequence of asynchronous operations, such as an SPI transfer, a delay
+ * and an I2C read, is otherwise written as a chain of callbacks, each
+ * starting the next. A Coroutine's run() is written as the sequence itself,
+ * between MBED_CO_BEGIN() and MBED_CO_END(), with MBED_CO_AWAIT() around
+ * each operation. Awaiting an operation starts it with a callback bound to
+ * the coroutine and returns from run(); when the driver's completion runs,
+ * run() is called again and jumps back to where it left off.
+ *
+ * The coroutine is stackless, so local variables of run() do not survive an
+ * await: keep them as members. An await may not be placed inside a switch
+ * statement of run(). The awaitable operations are the protected members
+ * below; each deliver their completion from the scheduler, as with the
+ * driver's own callbacks, and event() returns its events.
+ *
+ * A coroutine awaits one operation at a time. C++20 coroutines would need
+ * a newer compiler than the supported toolchains have.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ * #include "mbed-drivers/Coroutine.h"
+ *
+ * class ReadSensor : public Coroutine {
+ * public:
+ *     ReadSensor(SPI &spi, I2C &i2c) : _spi(spi), _i2c(i2c) {}
+ *
+ * protected:
+ *     virtual void run() {
+ *         MBED_CO_BEGIN();
+ *         _command[0] = 0x01;
+ *         MBED_CO_AWAIT(transfer(_spi, Buffer(_command, 1), Buffer()));
+ *         MBED_CO_AWAIT(delay_us(500));
+ *         MBED_CO_AWAIT(transfer(_i2c, 0x90, Buffer(_command, 1), Buffer(_data, 2)));
+ *         if (event() & I2C_EVENT_ERROR) {
+ *             printf("no reply\r\n");
+ *         }
+ *         MBED_CO_END();
+ *     }
+ *
+ *     SPI &_spi;
+ *     I2C &_i2c;
+ *     char _command[1];
+ *     char _data[2];
+ * };
+ *
+ * SPI spi(SPI_MOSI, SPI_MISO, SPI_SCK);
+ * I2C i2c(I2C_SDA, I2C_SCL);
+ * ReadSensor sensor(spi, i2c);
+ *
+ * void app_start(int, char**) {
+ *     sensor.start();
+ * }
+ * @endcode
+ */
+class Coroutine {
+public:
+    /** The event() of an operation that could not be started
+     */
+    static const int FAILED = -1;
+
+    /** The state of a coroutine that has finished
+     */
+    static const int STATE_DONE = -1;
+
+    Coroutine();
+
+    virtual ~Coroutine();
+
+    /** Run the coroutine from the start, from the scheduler
+     *
+     *  @param finished Called from the scheduler when run() reaches MBED_CO_END()
+     *
+     *  @returns
+     *    0 if the coroutine was started, -1 if it is already running
+     */
+    int start(const mbed::util::FunctionPointer0<void> &finished = mbed::util::FunctionPointer0<void>((void (*)(void))NULL));
+
+    /** Check if the coroutine has been started and has not finished
+     */
+    bool running() const {
+        return _running;
+    }
+
+    /** Get the events of the last operation awaited
+     *
+     *  This is 0 for a delay or a yield, and FAILED if the operation could
+     *  not be started.
+     */
+    int event() const {
+        return _event;
+    }
+
+protected:
+    /** The body of the coroutine
+     */
+    virtual void run() = 0;
+
+#if DEVICE_SPI_ASYNCH
+    /** Transfer over SPI
+     *
+     *  @param spi The SPI master
+     *  @param tx The transmit buffer, or an empty one
+     *  @param rx The receive buffer, or an empty one
+     *  @param event The logical OR of SPI events to complete on
+     */
+    int transfer(SPI &spi, const Buffer &tx, const Buffer &rx, int event = SPI_EVENT_COMPLETE);
+#endif
+
+#if DEVICE_I2C_ASYNCH
+    /** Transfer over I2C
+     *
+     *  @param i2c The I2C master
+     *  @param address 8/10 bit I2C slave address
+     *  @param tx The transmit buffer, or an empty one
+     *  @param rx The receive buffer, or an empty one
+     *  @param event The logical OR of I2C events to complete on
+     *  @param repeated Repeated start, true - do not send stop at end
+     */
+    int transfer(I2C &i2c, int address, const Buffer &tx, const Buffer &rx,
+                 int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false);
+#endif
+
+#if DEVICE_SERIAL_ASYNCH
+    /** Write to a serial port
+     *
+     *  @param serial The serial port
+     *  @param buffer The data to write
+     *  @param event The logical OR of TX events to complete on
+     */
+    int write(SerialBase &serial, const Buffer &buffer, int event = SERIAL_EVENT_TX_COMPLETE);
+
+    /** Read from a serial port
+     *
+     *  @param serial The serial port
+     *  @param buffer The buffer to read into
+     *  @param event The logical OR of RX events to complete on
+     */
+    int read(SerialBase &serial, const Buffer &buffer, int event = SERIAL_EVENT_RX_COMPLETE);
+#endif
+
+    /** Wait, with a Timeout
+     *
+     *  @param us The delay in micro-seconds
+     */
+    int delay_us(timestamp_t us);
+
+    /** Continue once the callbacks already scheduled have run
+     */
+    int yield();
+
+    /** Wait for an operation that has been started, if it was
+     *
+     *  @param rc What the operation's start returned, 0 if it started
+     *
+     *  @returns
+     *    true if run() must return to wait for the operation
+     */
+    bool suspend(int rc);
+
+    int _co_state;          /**< Where run() continues from, set by the MBED_CO_ macros */
+
+private:
+    void resume();
+    void complete(int event);
+    void transfer_done(Buffer tx, Buffer rx, int event);
+    void serial_done(Buffer buffer, int event);
+    void delay_done();
+
+    mbed::util::FunctionPointer0<void> _finished;
+    CompletionQueue::Slot _resume;  /**< Bound to resume() once */
+    Timeout _timeout;
+    int _event;
+    bool _running;
+    bool _waiting;
+
+    /* disallow copy constructor and assignment operators */
+    Coroutine(const Coroutine&);
+    Coroutine & operator = (const Coroutine&);
+};
+
+} // namespace mbed
+
+#endif
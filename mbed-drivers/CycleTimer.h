@@ -0,0 +1,261 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_CYCLETIMER_H
+#define MBED_CYCLETIMER_H
+
+#include <stdint.h>
+#include "cmsis.h"
+#include "us_ticker_api.h"
+#include "mbed_hal_inline.h"
+
+/* Whether the core has the DWT cycle counter (Cortex-M3 and above) */
+#ifndef CYCLETIMER_DWT
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3)
+#define CYCLETIMER_DWT 1
+#else
+#define CYCLETIMER_DWT 0
+#endif
+#endif
+
+namespace mbed {
+
+/** A timer that counts core cycles, for profiling short code paths
+ *
+ * On Cortex-M3 and above it reads the DWT cycle counter, which is a single
+ * load. Without a DWT (Cortex-M0), it falls back to the us ticker, so counts
+ * are in microseconds; use ticks_per_second() to convert. Counts wrap after
+ * 2^32 ticks, about 43 seconds at 100 MHz, so the timer only suits
+ * intervals shorter than that.
+ *
+ * Example:
+ * @code
+ * CycleTimer t;
+ * t.start();
+ * do_something();
+ * t.stop();
+ * printf("took %lu cycles\r\n", t.read());
+ * @endcode
+ */
+class CycleTimer {
+public:
+    CycleTimer() : _running(false), _start(0), _time(0) {
+        enable();
+    }
+
+    /** Start the timer
+     */
+    void start() {
+        if (!_running) {
+            _start = now();
+            _running = true;
+        }
+    }
+
+    /** Stop the timer
+     */
+    void stop() {
+        _time += slicetime();
+        _running = false;
+    }
+
+    /** Reset the timer to 0.
+     *
+     * If it was already counting, it will continue
+     */
+    void reset() {
+        _start = now();
+        _time = 0;
+    }
+
+    /** Get the time passed in ticks
+     */
+    uint32_t read() const {
+        return _time + slicetime();
+    }
+
+    /** Get the time passed in micro-seconds
+     */
+    uint32_t read_us() const {
+        return to_us(read());
+    }
+
+    /** Read the free-running counter
+     */
+    static uint32_t now() {
+#if CYCLETIMER_DWT
+        return DWT->CYCCNT;
+#else
+        return mbed_us_ticker_read();
+#endif
+    }
+
+    /** Start the cycle counter, if it is not running
+     *
+     * The counter is shared with debuggers, which may also enable it.
+     */
+    static void enable() {
+#if CYCLETIMER_DWT
+        if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+            CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+            DWT->CYCCNT = 0;
+            DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        }
+#endif
+    }
+
+    /** Get the number of ticks per second
+     */
+    static uint32_t ticks_per_second() {
+#if CYCLETIMER_DWT
+        return SystemCoreClock;
+#else
+        return 1000000;
+#endif
+    }
+
+    /** Convert ticks to micro-seconds
+     */
+    static uint32_t to_us(uint32_t ticks) {
+#if CYCLETIMER_DWT
+        return (uint32_t)(((uint64_t)ticks * 1000000) / SystemCoreClock);
+#else
+        return ticks;
+#endif
+    }
+
+private:
+    uint32_t slicetime() const {
+        return _running ? now() - _start : 0;
+    }
+
+    bool _running;
+    uint32_t _start;
+    uint32_t _time;
+};
+
+/** Accumulated minimum, maximum and average of repeated measurements
+ *
+ * Measurements are in CycleTimer ticks. Adding a measurement does not
+ * disable interrupts, so a ProfileStats must only be updated from one
+ * context.
+ */
+class ProfileStats {
+public:
+    ProfileStats() {
+        reset();
+    }
+
+    /** Add a measurement
+     */
+    void add(uint32_t ticks) {
+        if (ticks < _min) {
+            _min = ticks;
+        }
+        if (ticks > _max) {
+            _max = ticks;
+        }
+        _total += ticks;
+        _count++;
+    }
+
+    /** Forget all the measurements
+     */
+    void reset() {
+        _count = 0;
+        _total = 0;
+        _min = UINT32_MAX;
+        _max = 0;
+    }
+
+    /** Get the number of measurements
+     */
+    uint32_t count() const {
+        return _count;
+    }
+
+    /** Get the smallest measurement, or 0 if there are none
+     */
+    uint32_t min() const {
+        return _count ? _min : 0;
+    }
+
+    /** Get the largest measurement
+     */
+    uint32_t max() const {
+        return _max;
+    }
+
+    /** Get the average measurement, or 0 if there are none
+     */
+    uint32_t avg() const {
+        return _count ? (uint32_t)(_total / _count) : 0;
+    }
+
+    /** Get the sum of the measurements
+     */
+    uint64_t total() const {
+        return _total;
+    }
+
+    /** Report the count, min, max and avg with notify_performance_coefficient()
+     *
+     * The values are reported as "<name>_count", "<name>_min" and so on.
+     * Reporting uses printf, so must not be done from an interrupt handler.
+     *
+     * @param name The prefix for the names, up to 24 characters
+     */
+    void report(const char *name) const;
+
+private:
+    uint32_t _count;
+    uint64_t _total;
+    uint32_t _min;
+    uint32_t _max;
+};
+
+/** Measure the time to the end of a scope and add it to a ProfileStats
+ *
+ * Example:
+ * @code
+ * ProfileStats rx_stats;
+ *
+ * void rx_handler() {
+ *     ProfileScope scope(rx_stats);
+ *     // ...
+ * }
+ * @endcode
+ */
+class ProfileScope {
+public:
+    ProfileScope(ProfileStats &stats) : _stats(stats), _start(CycleTimer::now()) {
+    }
+
+    ~ProfileScope() {
+        _stats.add(CycleTimer::now() - _start);
+    }
+
+private:
+    ProfileStats &_stats;
+    uint32_t _start;
+
+    /* disallow copy constructor and assignment operators */
+    ProfileScope(const ProfileScope&);
+    ProfileScope & operator = (const ProfileScope&);
+};
+
+} // namespace mbed
+
+#endif
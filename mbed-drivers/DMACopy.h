@@ -0,0 +1,144 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DMACOPY_H
+#define MBED_DMACOPY_H
+
+#include "platform.h"
+#include "Buffer.h"
+#include "CompletionQueue.h"
+#include "core-util/FunctionPointer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#if DEVICE_DMA_COPY
+#include "dma_copy_api.h"
+#include "CThunk.h"
+#include "dma_api.h"
+#include "mbed_sleep.h"
+#include "DMAManager.h"
+#endif
+
+/* Copies shorter than this are done by the CPU, which is quicker than
+ * setting up a DMA transfer for them */
+#ifndef DMA_COPY_MIN
+#define DMA_COPY_MIN 64
+#endif
+
+namespace mbed {
+
+/** A memory to memory copy made by DMA in the background
+ *
+ * Where the target has a DMA controller that can copy memory, and a channel
+ * is free, the copy is made by DMA and the CPU is free while it runs.
+ * Otherwise, or for copies shorter than DMA_COPY_MIN, the data is copied
+ * with memcpy() before copy() returns. Either way the callback is scheduled
+ * to run in main context, like the asynchronous drivers' callbacks. Each
+ * DMACopy makes one copy at a time; dma_memcpy() uses a shared one.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * uint8_t frame[2][4096];
+ *
+ * void flipped(Buffer dst) {
+ *     // frame[1] now holds what frame[0] did
+ * }
+ *
+ * void app_start(int, char**) {
+ *     dma_memcpy(frame[1], frame[0], sizeof(frame[0]), DMACopy::event_callback_t(flipped));
+ * }
+ * @endcode
+ */
+class DMACopy {
+public:
+    /** Copy callback
+     *  @param Buffer the destination
+     */
+    typedef mbed::util::FunctionPointer1<void, Buffer> event_callback_t;
+
+    DMACopy();
+
+    ~DMACopy();
+
+    /** Copy memory
+     *
+     *  @param dst Where to copy to, which must not be used until the callback
+     *  @param src What to copy, which must not change until the callback
+     *  @param length The number of bytes
+     *  @param callback The function to call once the copy is made, or NULL
+     *  @returns 0 if the copy started, or -1 if one is in progress
+     */
+    int copy(void *dst, const void *src, size_t length, const event_callback_t &callback);
+
+    /** Check if a copy is in progress
+     */
+    bool busy() const {
+        return _busy;
+    }
+
+    /** Check if the copies are made by DMA where they can be
+     */
+    bool hardware() const {
+        return _hardware;
+    }
+
+#if DEVICE_DMA_COPY
+    /** Configure DMA usage suggestion for the copies
+     *
+     *  The default is DMA_USAGE_OPPORTUNISTIC, taking a channel per copy.
+     *
+     *  @param usage The usage DMA hint
+     *  @return Zero if the usage was set, -1 if a copy is in progress
+     */
+    int set_dma_usage(DMAUsage usage);
+#endif
+
+protected:
+    void finish();
+
+#if DEVICE_DMA_COPY
+    void irq_handler_asynch(void);
+
+    dma_copy_t _copy;
+    DeepSleepLock _deep_sleep;  /**< Held while a DMA copy runs */
+    CThunk<DMACopy> _irq;
+    DMAChannel _dma;
+#endif
+    bool _hardware;
+    volatile bool _busy;
+    Buffer _dst;
+    event_callback_t _callback;
+    CompletionQueue::Slot _completion;
+
+    /* disallow copy constructor and assignment operators */
+    DMACopy(const DMACopy&);
+    DMACopy & operator = (const DMACopy&);
+};
+
+/** Copy memory with the shared DMACopy
+ *
+ *  @param dst Where to copy to, which must not be used until the callback
+ *  @param src What to copy, which must not change until the callback
+ *  @param length The number of bytes
+ *  @param callback The function to call once the copy is made, or NULL
+ *  @returns 0 if the copy started, or -1 if a shared copy is in progress
+ */
+int dma_memcpy(void *dst, const void *src, size_t length, const DMACopy::event_callback_t &callback);
+
+} // namespace mbed
+
+#endif
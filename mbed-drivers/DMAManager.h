@@ -0,0 +1,148 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DMAMANAGER_H
+#define MBED_DMAMANAGER_H
+
+#include <stdint.h>
+#include "dma_api.h"
+
+/* The number of DMA channels the drivers share. With 0, the drivers do not
+ * arbitrate, and pass their DMAUsage hints straight to the HAL.
+ */
+#ifndef DMA_CHANNEL_COUNT
+#define DMA_CHANNEL_COUNT 0
+#endif
+
+/* How many of the channels only high priority users may take, so that
+ * opportunistic users cannot starve them */
+#ifndef DMA_CHANNELS_HIGH_PRIORITY
+#define DMA_CHANNELS_HIGH_PRIORITY 0
+#endif
+
+namespace mbed {
+
+/** DMA channel statistics
+ */
+typedef struct {
+    uint32_t in_use;    /**< The channels taken now */
+    uint32_t peak;      /**< The most channels taken at once */
+    uint32_t granted;   /**< The requests that got a channel */
+    uint32_t denied;    /**< The requests that did not, and ran without DMA or failed */
+} dma_stats_t;
+
+/** Shares the DMA channels between the drivers
+ *
+ * The HAL still picks the channel for each transfer; this only limits how
+ * many drivers use DMA at once, so that users that must have a channel get
+ * one. Users of DMA_USAGE_ALWAYS and DMA_USAGE_ALLOCATED hold a channel for
+ * as long as they keep that usage. Users of DMA_USAGE_OPPORTUNISTIC and
+ * DMA_USAGE_TEMPORARY_ALLOCATED take one for each transfer and give it back
+ * when the transfer ends, and run without DMA when none is free.
+ */
+class DMAManager {
+public:
+    enum Priority {
+        PRIORITY_NORMAL,    /**< May not take the DMA_CHANNELS_HIGH_PRIORITY channels */
+        PRIORITY_HIGH       /**< May take any channel */
+    };
+
+    /** Take a channel
+     *
+     *  This can be called from interrupt handlers.
+     *
+     *  @param priority The priority of the user
+     *  @returns true if a channel was taken
+     */
+    static bool take(Priority priority);
+
+    /** Give back a channel from take()
+     *
+     *  This can be called from interrupt handlers.
+     */
+    static void give();
+
+    /** Get the statistics
+     *
+     *  @param stats Set to the statistics
+     */
+    static void get_stats(dma_stats_t *stats);
+
+    /** Reset the peak and the request counts
+     */
+    static void reset_stats();
+};
+
+/** A driver's use of DMA in one direction, following its DMAUsage
+ */
+class DMAChannel {
+public:
+    DMAChannel() : _usage(DMA_USAGE_NEVER), _priority(DMAManager::PRIORITY_NORMAL), _held(false) {
+    }
+
+    ~DMAChannel() {
+        give();
+    }
+
+    /** Change the usage
+     *
+     *  @param usage The DMAUsage
+     *  @param priority The priority to take channels at
+     *  @returns 0 on success, or -1 if the usage needs a channel for good and
+     *    none was free, leaving the usage unchanged
+     */
+    int set_usage(DMAUsage usage, DMAManager::Priority priority = DMAManager::PRIORITY_NORMAL);
+
+    /** Get the usage
+     */
+    DMAUsage usage() const {
+        return _usage;
+    }
+
+    /** Get the usage hint for a transfer starting now
+     *
+     *  For per-transfer usages this takes a channel if it does not hold one
+     *  already. This can be called from interrupt handlers.
+     *
+     *  @returns The usage to pass to the HAL, DMA_USAGE_NEVER if no channel
+     *    could be had
+     */
+    DMAUsage begin();
+
+    /** Give back a per-transfer channel once the transfers are over
+     *
+     *  This can be called from interrupt handlers.
+     */
+    void end();
+
+private:
+    static bool persistent(DMAUsage usage) {
+        return usage == DMA_USAGE_ALWAYS || usage == DMA_USAGE_ALLOCATED;
+    }
+
+    void give();
+
+    DMAUsage _usage;
+    DMAManager::Priority _priority;
+    bool _held;
+
+    /* disallow copy constructor and assignment operators */
+    DMAChannel(const DMAChannel&);
+    DMAChannel & operator = (const DMAChannel&);
+};
+
+} // namespace mbed
+
+#endif
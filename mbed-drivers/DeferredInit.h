@@ -0,0 +1,169 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DEFERREDINIT_H
+#define MBED_DEFERREDINIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core-util/FunctionPointer.h"
+
+namespace mbed {
+
+/** Hardware bring-up deferred until the scheduler runs
+ *
+ * Objects constructed statically run their constructors before main(),
+ * one after another, so slow bring-up there, such as waiting for a PLL to
+ * lock or holding an external device in reset, delays everything. A driver
+ * or application can instead add a Job, which is started from the scheduler
+ * once app_start() has run. A job's start function begins the bring-up and
+ * returns; the job calls done() when it has finished, straight away or
+ * from a later callback or interrupt. All the jobs are started together,
+ * so slow ones overlap, except that a job can be made to wait for another
+ * one, such as a device reset for the clock it needs.
+ *
+ * Jobs are linked into the registry rather than allocated, so they can be
+ * added from static constructors. A job must exist until it is done, and
+ * until the jobs that wait for it have started.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ * #include "mbed-drivers/DeferredInit.h"
+ *
+ * DigitalOut radio_reset(D7, 0);
+ * Timeout reset_timeout;
+ * DeferredInit::Job *reset_job;
+ *
+ * void reset_released() {
+ *     radio_reset = 1;
+ *     reset_job->done();
+ * }
+ *
+ * void reset_radio(DeferredInit::Job *job) {
+ *     // hold the radio in reset for 10ms without blocking the other jobs
+ *     reset_job = job;
+ *     reset_timeout.attach_us(reset_released, 10000);
+ * }
+ *
+ * DeferredInit::Job radio_job(DeferredInit::start_t(reset_radio));
+ *
+ * void radio_ready() {
+ *     printf("radio up\r\n");
+ * }
+ *
+ * void app_start(int, char**) {
+ *     DeferredInit::add(radio_job);
+ *     DeferredInit::attach(radio_ready);
+ * }
+ * @endcode
+ */
+class DeferredInit {
+public:
+    class Job;
+
+    /** The function that starts a job, given the job to call done() on
+     */
+    typedef mbed::util::FunctionPointer1<void, Job *> start_t;
+
+    /** One step of bring-up
+     */
+    class Job {
+    public:
+        /** Create a job
+         *
+         *  @param start Starts the job, from the scheduler
+         *  @param after A job that must be done before this one starts, or NULL
+         */
+        Job(const start_t &start, Job *after = NULL) :
+                _start(start), _after(after), _next(NULL), _state(STATE_IDLE) {
+        }
+
+        /** Report that the job has finished
+         *
+         *  This can be called from the start function or later, from any
+         *  context, including interrupt handlers. It does nothing before
+         *  the job has started.
+         */
+        void done();
+
+        /** Check if the job has finished
+         */
+        bool finished() const {
+            return _state == STATE_DONE;
+        }
+
+    private:
+        friend class DeferredInit;
+
+        enum {
+            STATE_IDLE,
+            STATE_STARTED,
+            STATE_DONE
+        };
+
+        start_t _start;
+        Job *_after;
+        Job *_next;
+        volatile uint8_t _state;
+
+        /* disallow copy constructor and assignment operators */
+        Job(const Job&);
+        Job & operator = (const Job&);
+    };
+
+    /** Add a job to the registry
+     *
+     *  Jobs added before the scheduler runs are started after app_start();
+     *  jobs added later are started from the scheduler straight away.
+     *
+     *  @param job The job, which must not be added again before it is done
+     */
+    static void add(Job &job);
+
+    /** Set the function to call, from the scheduler, when no job is left
+     *
+     *  This is called once app_start() has run if there are no jobs, and
+     *  again each time the last job pending is done. Set it from
+     *  app_start() rather than a static constructor.
+     *
+     *  @param callback The function, or NULL
+     */
+    static void attach(void (*callback)(void));
+
+    /** Set the function to call, from the scheduler, when no job is left
+     *
+     *  @param callback The function, or an empty one
+     */
+    static void attach(const mbed::util::FunctionPointer0<void> &callback);
+
+    /** Get the number of jobs that are not done
+     */
+    static unsigned int pending();
+
+    /** Start the jobs that are ready
+     *
+     *  The startup code posts this to run after app_start(); it does not
+     *  need to be called otherwise.
+     */
+    static void run();
+
+private:
+    static void advance();
+};
+
+} // namespace mbed
+
+#endif
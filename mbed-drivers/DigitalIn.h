@@ -19,6 +19,7 @@
 #include "platform.h"
 
 #include "gpio_api.h"
+#include "mbed_hal_inline.h"
 
 namespace mbed {
 
@@ -69,7 +70,7 @@ public:
      *    0 for logical 0, 1 for logical 1
      */
     int read() {
-        return gpio_read(&gpio);
+        return mbed_gpio_read(&gpio);
     }
 
     /** Set the input pin mode
@@ -19,6 +19,7 @@
 #include "platform.h"
 
 #include "gpio_api.h"
+#include "mbed_hal_inline.h"
 
 namespace mbed {
 
@@ -52,7 +53,7 @@ public:
      *      0 for logical 0, 1 (or any other non-zero value) for logical 1
      */
     void write(int value) {
-        gpio_write(&gpio, value);
+        mbed_gpio_write(&gpio, value);
     }
 
     /** Return the output setting, represented as 0 or 1 (int)
@@ -62,7 +63,7 @@ public:
      *    or read the input if set as an input
      */
     int read() {
-        return gpio_read(&gpio);
+        return mbed_gpio_read(&gpio);
     }
 
     /** Set as an output
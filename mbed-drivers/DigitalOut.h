@@ -18,6 +18,7 @@
 
 #include "platform.h"
 #include "gpio_api.h"
+#include "mbed_hal_inline.h"
 
 namespace mbed {
 
@@ -64,7 +65,28 @@ public:
      *      0 for logical 0, 1 (or any other non-zero value) for logical 1
      */
     void write(int value) {
-        gpio_write(&gpio, value);
+        mbed_gpio_write(&gpio, value);
+    }
+
+    /** Set the output to logical 1
+     */
+    void set() {
+        mbed_gpio_write(&gpio, 1);
+    }
+
+    /** Set the output to logical 0
+     */
+    void clear() {
+        mbed_gpio_write(&gpio, 0);
+    }
+
+    /** Invert the output
+     *
+     * Uses the port's toggle register where it has one, and is atomic with
+     * respect to interrupts in any case.
+     */
+    void toggle() {
+        gpio_toggle(&gpio);
     }
 
     /** Return the output setting, represented as 0 or 1 (int)
@@ -74,7 +96,7 @@ public:
      *    0 for logical 0, 1 for logical 1
      */
     int read() {
-        return gpio_read(&gpio);
+        return mbed_gpio_read(&gpio);
     }
 
 #ifdef MBED_OPERATORS
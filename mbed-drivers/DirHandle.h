@@ -25,6 +25,7 @@ typedef int mode_t;
 #endif
 
 #include "FileHandle.h"
+#include <cstring>
 
 struct dirent {
     char d_name[NAME_MAX+1];
@@ -66,6 +67,31 @@ public:
      */
     virtual struct dirent *readdir()=0;
 
+    /** Fill a caller's dirent with the entry at the current position, and
+     *  advance the position to the next entry.
+     *
+     *  Unlike readdir(), no buffer is shared with other callers. The default
+     *  copies the entry from readdir(); implementations can override it to
+     *  fill entry directly.
+     *
+     *  @param entry The dirent to fill
+     *  @param result Set to entry, or to NULL on reaching end of directory
+     *
+     *  @returns
+     *    0 on success or end of directory,
+     *   -1 on error.
+     */
+    virtual int readdir_r(struct dirent *entry, struct dirent **result) {
+        struct dirent *cur = readdir();
+        if (cur == NULL) {
+            *result = NULL;
+            return 0;
+        }
+        std::memcpy(entry, cur, sizeof(*entry));
+        *result = entry;
+        return 0;
+    }
+
     /** Resets the position to the beginning of the directory.
      */
     virtual void rewinddir()=0;
@@ -94,6 +120,7 @@ typedef mbed::DirHandle DIR;
 extern "C" {
     DIR *opendir(const char*);
     struct dirent *readdir(DIR *);
+    int readdir_r(DIR *, struct dirent *, struct dirent **);
     int closedir(DIR*);
     void rewinddir(DIR*);
     long telldir(DIR*);
@@ -0,0 +1,130 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVERSTATS_H
+#define MBED_DRIVERSTATS_H
+
+#include "platform.h"
+#include <string.h>
+
+/* When DRIVER_STATS is set, SPI, I2C and SerialBase count the asynchronous
+ * transfers they run, in a driver_stats_t per bus (per direction for
+ * serial ports) that get_stats() reads.
+ */
+#ifndef DRIVER_STATS
+#define DRIVER_STATS 0
+#endif
+
+#if DRIVER_STATS
+#include "CycleTimer.h"
+#include "mbed_critical.h"
+#endif
+
+namespace mbed {
+
+/** Statistics for a bus, counted over its asynchronous transfers
+ */
+struct driver_stats_t {
+    uint32_t transactions;      /**< The number of transfers started */
+    uint32_t bytes;             /**< The bytes they moved, both ways */
+    uint32_t events[32];        /**< The number of times each event bit was reported, by bit number */
+    uint32_t queue_high_water;  /**< The most transfers waiting in the queue at once */
+    uint64_t busy_ticks;        /**< The time a transfer was in progress, in CycleTimer ticks */
+};
+
+#if DRIVER_STATS
+/** The counting behind driver_stats_t, for the drivers
+ *
+ * The counters are updated from the transfers' start and completion paths,
+ * in and out of interrupts, and get() takes a consistent copy.
+ */
+class DriverStats {
+public:
+    DriverStats() : _busy(false), _busy_since(0) {
+        CycleTimer::enable();
+        reset();
+    }
+
+    /** Count a transfer starting */
+    void started(uint32_t bytes) {
+        CriticalSection lock;
+        _stats.transactions++;
+        _stats.bytes += bytes;
+        if (!_busy) {
+            _busy = true;
+            _busy_since = CycleTimer::now();
+        }
+    }
+
+    /** Count bytes moved by a transfer that is still in progress */
+    void moved(uint32_t bytes) {
+        _stats.bytes += bytes;
+    }
+
+    /** Count the events reported by a transfer that is still in progress */
+    void reported(int event) {
+        for (int bit = 0; bit < 32; bit++) {
+            if ((uint32_t)event & (1UL << bit)) {
+                _stats.events[bit]++;
+            }
+        }
+    }
+
+    /** Count a transfer ending, with the events it ended with */
+    void finished(int event) {
+        CriticalSection lock;
+        reported(event);
+        if (_busy) {
+            _stats.busy_ticks += CycleTimer::now() - _busy_since;
+            _busy = false;
+        }
+    }
+
+    /** Note the depth of the queue, after a transfer joined it */
+    void queued(uint32_t depth) {
+        if (depth > _stats.queue_high_water) {
+            _stats.queue_high_water = depth;
+        }
+    }
+
+    /** Get a consistent copy of the statistics, including the time of the
+     *  transfer in progress so far */
+    void get(driver_stats_t *stats) const {
+        CriticalSection lock;
+        *stats = _stats;
+        if (_busy) {
+            stats->busy_ticks += CycleTimer::now() - _busy_since;
+        }
+    }
+
+    /** Reset the statistics */
+    void reset() {
+        CriticalSection lock;
+        memset(&_stats, 0, sizeof(_stats));
+        if (_busy) {
+            _busy_since = CycleTimer::now();
+        }
+    }
+
+private:
+    driver_stats_t _stats;
+    bool _busy;
+    uint32_t _busy_since;
+};
+#endif
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,90 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_FASTDIGITALIN_H
+#define MBED_FASTDIGITALIN_H
+
+#include "platform.h"
+#include "gpio_api.h"
+#include "mbed_hal_inline.h"
+
+#if DEVICE_GPIO_FAST
+#include "gpio_fast_api.h"
+#endif
+
+namespace mbed {
+
+/** A digital input for a pin fixed at compile time
+ *
+ * On targets with DEVICE_GPIO_FAST, the HAL maps a constant pin to its
+ * input register and mask inline, so with the pin a template parameter a
+ * read compiles down to a single load and mask. Elsewhere it behaves like
+ * DigitalIn.
+ */
+template<PinName Pin>
+class FastDigitalIn {
+
+public:
+    /** Create a FastDigitalIn connected to the pin
+     */
+    FastDigitalIn() : gpio() {
+        gpio_init_in(&gpio, Pin);
+    }
+
+    /** Create a FastDigitalIn connected to the pin
+     *
+     *  @param mode the initial mode of the pin
+     */
+    FastDigitalIn(PinMode mode) : gpio() {
+        gpio_init_in_ex(&gpio, Pin, mode);
+    }
+
+    /** Read the input, represented as 0 or 1 (int)
+     *
+     *  @returns
+     *    An integer representing the state of the input pin,
+     *    0 for logical 0, 1 for logical 1
+     */
+    int read() {
+#if DEVICE_GPIO_FAST
+        return gpio_fast_read(Pin);
+#else
+        return mbed_gpio_read(&gpio);
+#endif
+    }
+
+    /** Set the input pin mode
+     *
+     *  @param mode PullUp, PullDown, PullNone, OpenDrain
+     */
+    void mode(PinMode pull) {
+        gpio_mode(&gpio, pull);
+    }
+
+#ifdef MBED_OPERATORS
+    /** An operator shorthand for read()
+     */
+    operator int() {
+        return read();
+    }
+#endif
+
+protected:
+    gpio_t gpio;
+};
+
+} // namespace mbed
+
+#endif
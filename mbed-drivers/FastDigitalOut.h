@@ -0,0 +1,131 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_FASTDIGITALOUT_H
+#define MBED_FASTDIGITALOUT_H
+
+#include "platform.h"
+#include "gpio_api.h"
+#include "mbed_hal_inline.h"
+
+#if DEVICE_GPIO_FAST
+#include "gpio_fast_api.h"
+#endif
+
+namespace mbed {
+
+/** A digital output for a pin fixed at compile time
+ *
+ * On targets with DEVICE_GPIO_FAST, the HAL maps a constant pin to its
+ * registers and mask inline, so with the pin a template parameter a write
+ * or toggle compiles down to a single store. Elsewhere it behaves like
+ * DigitalOut.
+ *
+ * Example:
+ * @code
+ * // Bit-bang a square wave
+ * #include "mbed.h"
+ * #include "mbed-drivers/FastDigitalOut.h"
+ *
+ * FastDigitalOut<LED1> led;
+ *
+ * int main() {
+ *     while(1) {
+ *         led.toggle();
+ *     }
+ * }
+ * @endcode
+ */
+template<PinName Pin>
+class FastDigitalOut {
+
+public:
+    /** Create a FastDigitalOut connected to the pin
+     */
+    FastDigitalOut() : gpio() {
+        gpio_init_out(&gpio, Pin);
+    }
+
+    /** Create a FastDigitalOut connected to the pin
+     *
+     *  @param value the initial pin value
+     */
+    FastDigitalOut(int value) : gpio() {
+        gpio_init_out_ex(&gpio, Pin, value);
+    }
+
+    /** Set the output, specified as 0 or 1 (int)
+     *
+     *  @param value An integer specifying the pin output value,
+     *      0 for logical 0, 1 (or any other non-zero value) for logical 1
+     */
+    void write(int value) {
+#if DEVICE_GPIO_FAST
+        if (value) {
+            gpio_fast_set(Pin);
+        } else {
+            gpio_fast_clear(Pin);
+        }
+#else
+        mbed_gpio_write(&gpio, value);
+#endif
+    }
+
+    /** Invert the output
+     */
+    void toggle() {
+#if DEVICE_GPIO_FAST
+        gpio_fast_toggle(Pin);
+#else
+        gpio_toggle(&gpio);
+#endif
+    }
+
+    /** Return the output setting, represented as 0 or 1 (int)
+     *
+     *  @returns
+     *    an integer representing the output setting of the pin,
+     *    0 for logical 0, 1 for logical 1
+     */
+    int read() {
+#if DEVICE_GPIO_FAST
+        return gpio_fast_read(Pin);
+#else
+        return mbed_gpio_read(&gpio);
+#endif
+    }
+
+#ifdef MBED_OPERATORS
+    /** A shorthand for write()
+     */
+    FastDigitalOut& operator= (int value) {
+        write(value);
+        return *this;
+    }
+
+    /** A shorthand for read()
+     */
+    operator int() {
+        return read();
+    }
+#endif
+
+protected:
+    gpio_t gpio;
+};
+
+} // namespace mbed
+
+#endif
@@ -42,6 +42,29 @@ typedef long off_t;
 
 #include "platform.h"
 
+/* The number of slots in the hash index of FileBase names, a power of two.
+ * Objects that do not fit are still found, by walking the list. */
+#ifndef FILEBASE_INDEX_SIZE
+#define FILEBASE_INDEX_SIZE 16
+#endif
+
+/* When FILEBASE_STATIC_TABLE is set, named objects are not registered as
+ * they are constructed. Instead, the application lists them once, sorted by
+ * name, with FILEBASE_TABLE(), and lookup() is a binary search of that
+ * table:
+ *
+ *     LocalFileSystem local("local");
+ *     SDFileSystem sd(p5, p6, p7, p8, "sd");
+ *     FILEBASE_TABLE({"local", &local}, {"sd", &sd});
+ *
+ * The table is constant data, so it needs no construction, and with C++11
+ * its order is checked at compile time. Objects that are not in the table
+ * cannot be found by name.
+ */
+#ifndef FILEBASE_STATIC_TABLE
+#define FILEBASE_STATIC_TABLE 0
+#endif
+
 namespace mbed {
 
 typedef enum {
@@ -62,12 +85,30 @@ public:
 
     static FileBase *get(int n);
 
+    /* The object after this one in the order used by get() */
+    FileBase   *getNext(void);
+
+    /* Changes whenever an object is removed, so that a position from get()
+     * or getNext() can be checked before it is reused. Objects are added at
+     * the start, so adding one leaves the following objects as they were. */
+    static unsigned int generation(void);
+
 protected:
+    static int table_find(const char *name, unsigned int len);
+    static unsigned int hash(const char *name, unsigned int len);
+    static void index_insert(FileBase *fb);
+    static void index_remove(FileBase *fb);
+    static FileBase *index_find(const char *name, unsigned int len);
+
     static FileBase *_head;
+    static FileBase *_index[FILEBASE_INDEX_SIZE];
+    static unsigned int _unindexed;
+    static unsigned int _generation;
 
     FileBase   *_next;
     const char *_name;
     PathType    _path_type;
+    bool        _indexed;
 
     /* disallow copy constructor and assignment operators */
 private:
@@ -75,6 +116,42 @@ private:
     FileBase & operator = (const FileBase&);
 };
 
+/* An entry of the FILEBASE_STATIC_TABLE table */
+struct filebase_entry_t {
+    const char *name;
+    FileBase   *object;
+};
+
+#if FILEBASE_STATIC_TABLE
+extern const filebase_entry_t filebase_table[];
+extern const unsigned int filebase_table_size;
+#endif
+
+#if __cplusplus >= 201103L
+/* strcmp(), for names in constant expressions */
+constexpr int filebase_constexpr_compare(const char *a, const char *b) {
+    return (*a != *b || *a == '\0') ? (int)(unsigned char)*a - (int)(unsigned char)*b :
+           filebase_constexpr_compare(a + 1, b + 1);
+}
+
+/* Whether the first n entries of a table are in strictly increasing order of name */
+constexpr bool filebase_constexpr_sorted(const filebase_entry_t *table, unsigned int n) {
+    return n < 2 || (filebase_constexpr_compare(table[0].name, table[1].name) < 0 &&
+                     filebase_constexpr_sorted(table + 1, n - 1));
+}
+
+#define FILEBASE_TABLE(...) \
+    constexpr mbed::filebase_entry_t mbed::filebase_table[] = {__VA_ARGS__}; \
+    const unsigned int mbed::filebase_table_size = sizeof(mbed::filebase_table) / sizeof(mbed::filebase_table[0]); \
+    static_assert(mbed::filebase_constexpr_sorted(mbed::filebase_table, \
+                                                  sizeof(mbed::filebase_table) / sizeof(mbed::filebase_table[0])), \
+                  "FILEBASE_TABLE names must be sorted and unique")
+#else
+#define FILEBASE_TABLE(...) \
+    const mbed::filebase_entry_t mbed::filebase_table[] = {__VA_ARGS__}; \
+    const unsigned int mbed::filebase_table_size = sizeof(mbed::filebase_table) / sizeof(mbed::filebase_table[0])
+#endif
+
 } // namespace mbed
 
 #endif
@@ -26,10 +26,21 @@ typedef long off_t;
 
 #else
 #   include <sys/types.h>
+#   include <sys/stat.h>
+#   include <string.h>
 #endif
 
+#include "core-util/FunctionPointer.h"
+
 namespace mbed {
 
+/** One buffer of a scatter/gather transfer
+ */
+struct iovec {
+    void *iov_base;     /**< The start of the buffer */
+    size_t iov_len;     /**< The length of the buffer */
+};
+
 /** An OO equivalent of the internal FILEHANDLE variable
  *  and associated _sys_* functions.
  *
@@ -42,6 +53,14 @@ namespace mbed {
 class FileHandle {
 
 public:
+    /** Completion callback for the asynchronous operations
+     *  @param ssize_t The result, as the synchronous operation would return it
+     */
+    typedef mbed::util::FunctionPointer1<void, ssize_t> async_callback_t;
+
+    FileHandle() : _fh_slot(-1) {
+    }
+
     /** Write the contents of a buffer to the file
      *
      *  @param buffer the buffer to write from
@@ -100,6 +119,118 @@ public:
      */
     virtual int fsync() = 0;
 
+    /** Write the contents of several buffers to the file, in order
+     *
+     *  The default writes each buffer in turn; file systems on block devices
+     *  can override it to gather them into one transfer.
+     *
+     *  @param iov the buffers to write from
+     *  @param iovcnt the number of buffers
+     *
+     *  @returns
+     *  The number of characters written (possibly 0) on success, -1 on error.
+     */
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt) {
+        ssize_t total = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            ssize_t n = write(iov[i].iov_base, iov[i].iov_len);
+            if (n < 0) {
+                return total ? total : -1;
+            }
+            total += n;
+            if ((size_t)n < iov[i].iov_len) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    /** Read from the file into several buffers, in order
+     *
+     *  The default reads each buffer in turn; file systems on block devices
+     *  can override it to scatter one transfer into them.
+     *
+     *  @param iov the buffers to read in to
+     *  @param iovcnt the number of buffers
+     *
+     *  @returns
+     *  The number of characters read (zero at end of file) on success, -1 on error.
+     */
+    virtual ssize_t readv(const struct iovec *iov, int iovcnt) {
+        ssize_t total = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            ssize_t n = read(iov[i].iov_base, iov[i].iov_len);
+            if (n < 0) {
+                return total ? total : -1;
+            }
+            total += n;
+            if ((size_t)n < iov[i].iov_len) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    /** Start writing the contents of a buffer to the file
+     *
+     *  The callback is posted to the scheduler when the write completes, and
+     *  the buffer must stay valid until then. Handles on slow storage should
+     *  override this to return while the transfer is in progress; the default
+     *  calls write() and then posts the callback.
+     *
+     *  @param buffer the buffer to write from
+     *  @param length the number of characters to write
+     *  @param callback called with the result of the write
+     *
+     *  @returns
+     *    0 if the write has started, -1 if it could not be started
+     */
+    virtual int write_async(const void *buffer, size_t length, const async_callback_t &callback);
+
+    /** Start reading the contents of the file into a buffer
+     *
+     *  As for write_async(); the default calls read() and then posts the callback.
+     *
+     *  @param buffer the buffer to read in to
+     *  @param length the number of characters to read
+     *  @param callback called with the result of the read
+     *
+     *  @returns
+     *    0 if the read has started, -1 if it could not be started
+     */
+    virtual int read_async(void *buffer, size_t length, const async_callback_t &callback);
+
+    /** Start flushing any buffers associated with the FileHandle
+     *
+     *  As for write_async(); the default calls fsync() and then posts the callback.
+     *
+     *  @param callback called with the result of the flush
+     *
+     *  @returns
+     *    0 if the flush has started, -1 if it could not be started
+     */
+    virtual int fsync_async(const async_callback_t &callback);
+
+    /** Get a pointer straight to part of the file's contents
+     *
+     *  Files held in memory-addressable storage, such as tables in internal
+     *  flash, can override this so that readers skip the copy into a buffer.
+     *  The contents are read-only through the pointer, which stays valid
+     *  until the file is closed. The default is to return NULL, and callers
+     *  should fall back to read().
+     *
+     *  @param offset The offset of the part from the start of the file
+     *  @param length The length of the part
+     *
+     *  @returns
+     *    A pointer to the part, or NULL if it cannot be mapped
+     */
+    virtual const void *map(off_t offset, size_t length) {
+        (void)offset;
+        (void)length;
+        return NULL;
+    }
+
     virtual off_t flen() {
         /* remember our current position */
         off_t pos = lseek(0, SEEK_CUR);
@@ -111,9 +242,103 @@ public:
         return res;
     }
 
+#if !defined(__ARMCC_VERSION) && !defined(__ICCARM__)
+    /** Get the file's status, as for fstat()
+     *
+     *  newlib sizes the buffer of a stream from st_blksize, so file systems
+     *  should override this to report their block size, along with a size
+     *  that does not need the three seeks of flen(). The default reports a
+     *  character device for a terminal, and otherwise a regular file of
+     *  flen() bytes with no preferred block size.
+     *
+     *  @param st Filled with the status
+     *
+     *  @returns
+     *    0 on success, -1 on error
+     */
+    virtual int fstat(struct stat *st) {
+        memset(st, 0, sizeof(*st));
+        if (isatty()) {
+            st->st_mode = S_IFCHR;
+            return 0;
+        }
+        off_t size = flen();
+        st->st_mode = S_IFREG;
+        st->st_size = size < 0 ? 0 : size;
+        return 0;
+    }
+#endif
+
     virtual ~FileHandle();
+
+    /* The last retarget descriptor slot this is open in, or -1 */
+    int _fh_slot;
 };
 
+/** Open a stdio stream on a FileHandle
+ *
+ *  The FileHandle is bound to a descriptor directly, rather than being
+ *  looked up by name through fopen().
+ *
+ *  @param fh The FileHandle, which must outlive the stream
+ *  @param mode The mode, as for fopen()
+ *
+ *  @returns
+ *    The stream, or NULL if there is no descriptor free
+ */
+std::FILE *fdopen(FileHandle *fh, const char *mode);
+
+/** Send stdin, stdout and stderr to a FileHandle instead of the stdio UART
+ *
+ *  Reads and writes of the three descriptors are passed to the FileHandle
+ *  from then on, for example a USBSerial or a file opened on a
+ *  RAMLogFileSystem, and the UART is left alone for them. Flush stdout first,
+ *  to keep the order of the output.
+ *
+ *  @param fh The FileHandle, which must outlive its use, or NULL to go back
+ *    to the UART
+ */
+void set_stdio(FileHandle *fh);
+
+/** Send one of stdin, stdout and stderr to a FileHandle instead of the stdio
+ *  UART
+ *
+ *  For example, stdout and stderr can go to a trace channel or a RAM log,
+ *  while stdin still comes from the UART.
+ *
+ *  @param fd The descriptor: 0, 1 or 2, as fileno(stdin), fileno(stdout)
+ *    and fileno(stderr)
+ *  @param fh The FileHandle, which must outlive its use, or NULL to go back
+ *    to the UART
+ *
+ *  @returns 0 on success, -1 if fd is not 0, 1 or 2
+ */
+int set_stdio(int fd, FileHandle *fh);
+
+/** Write several buffers to a file descriptor with one FileHandle::writev() call
+ *
+ *  Flush any stdio stream on the descriptor first.
+ *
+ *  @param fd The descriptor, for example from fileno(); not stdin, stdout or stderr
+ *  @param iov the buffers to write from
+ *  @param iovcnt the number of buffers
+ *
+ *  @returns
+ *  The number of characters written on success, -1 on error.
+ */
+ssize_t writev(FILEHANDLE fd, const struct iovec *iov, int iovcnt);
+
+/** Read into several buffers from a file descriptor with one FileHandle::readv() call
+ *
+ *  @param fd The descriptor, for example from fileno(); not stdin, stdout or stderr
+ *  @param iov the buffers to read in to
+ *  @param iovcnt the number of buffers
+ *
+ *  @returns
+ *  The number of characters read (zero at end of file) on success, -1 on error.
+ */
+ssize_t readv(FILEHANDLE fd, const struct iovec *iov, int iovcnt);
+
 } // namespace mbed
 
 #endif
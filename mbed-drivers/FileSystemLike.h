@@ -22,6 +22,12 @@
 #include "FileHandle.h"
 #include "DirHandle.h"
 
+/* The number of asynchronous file system operations that can wait at once,
+ * across all file systems, for the default implementations */
+#ifndef FILESYSTEM_ASYNC_QUEUE_SIZE
+#define FILESYSTEM_ASYNC_QUEUE_SIZE 4
+#endif
+
 namespace mbed {
 
 /** A filesystem-like object is one that can be used to open files
@@ -96,6 +102,67 @@ public:
      */
     virtual int mkdir(const char *name, mode_t mode) { (void) name, (void) mode; return -1; }
 
+    typedef FileHandle::async_callback_t async_callback_t;
+    typedef mbed::util::FunctionPointer1<void, DirHandle *> opendir_callback_t;
+
+    /** Start removing a file from the filesystem
+     *
+     *  The callback is called from the scheduler with the result that
+     *  remove() would return. The default queues the operation for a
+     *  worker that runs one queued operation, of any file system, per
+     *  scheduler callback, in the order they were queued, so other work is
+     *  not held up behind a whole series of them. File systems that erase
+     *  flash should override this to erase without blocking. The names
+     *  passed to the asynchronous operations must stay valid until their
+     *  callbacks are called.
+     *
+     *  @param filename the name of the file to remove
+     *  @param callback called with the result
+     *
+     *  @returns
+     *    0 if the operation has started, -1 if it could not be started
+     */
+    virtual int remove_async(const char *filename, const async_callback_t &callback);
+
+    /** Start renaming a file in the filesystem
+     *
+     *  As for remove_async(), with the result that rename() would return.
+     *
+     *  @param oldname the name of the file to rename
+     *  @param newname the name to rename it to
+     *  @param callback called with the result
+     *
+     *  @returns
+     *    0 if the operation has started, -1 if it could not be started
+     */
+    virtual int rename_async(const char *oldname, const char *newname, const async_callback_t &callback);
+
+    /** Start creating a directory in the filesystem
+     *
+     *  As for remove_async(), with the result that mkdir() would return.
+     *
+     *  @param name The name of the directory to create
+     *  @param mode The permissions to create the directory with
+     *  @param callback called with the result
+     *
+     *  @returns
+     *    0 if the operation has started, -1 if it could not be started
+     */
+    virtual int mkdir_async(const char *name, mode_t mode, const async_callback_t &callback);
+
+    /** Start opening a directory in the filesystem
+     *
+     *  As for remove_async(), with the DirHandle that opendir() would
+     *  return, or NULL on failure.
+     *
+     *  @param name The name of the directory to open
+     *  @param callback called with the DirHandle
+     *
+     *  @returns
+     *    0 if the operation has started, -1 if it could not be started
+     */
+    virtual int opendir_async(const char *name, const opendir_callback_t &callback);
+
     // TODO other filesystem functions (mkdir, rm, rn, ls etc)
 };
 
@@ -0,0 +1,224 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_FLASHKVSTORE_H
+#define MBED_FLASHKVSTORE_H
+
+#include "platform.h"
+
+#if DEVICE_FLASH
+
+#include "FileSystemLike.h"
+#include "CRC.h"
+#include "flash_api.h"
+
+/* The number of keys the store can hold, a power of two. Each costs a
+ * word of RAM. */
+#ifndef FLASH_KV_INDEX_SIZE
+#define FLASH_KV_INDEX_SIZE 64
+#endif
+
+/* The longest key, in bytes */
+#ifndef FLASH_KV_KEY_MAX
+#define FLASH_KV_KEY_MAX 32
+#endif
+
+/* The longest value that can be written through a file, which is held in
+ * RAM until the file is closed */
+#ifndef FLASH_KV_FILE_MAX
+#define FLASH_KV_FILE_MAX 1024
+#endif
+
+namespace mbed {
+
+/** A key-value store in internal flash, which can also be mounted as a file system
+ *
+ * The store is a log of records over a ring of two or more flash sectors.
+ * Setting a key appends a record, and removing one appends a record that
+ * marks it removed, so no record is ever rewritten in place. A hash index
+ * in RAM maps each key to its newest record, so a lookup is one probe of
+ * the index and one comparison with the key in flash. The values are read
+ * straight from the memory-mapped flash.
+ *
+ * One sector is always kept erased. When the newest sector is full, the
+ * log moves on to the erased one, and the records still in use in the
+ * oldest sector are copied after it before the oldest sector is erased, to
+ * become the next spare. Every sector is written and erased in turn, which
+ * spreads the wear across the ring.
+ *
+ * Each record carries a CRC, and is found again at mount by scanning the
+ * ring from the oldest sector, so a record cut short by a reset is ignored
+ * and the previous value of its key stays. A copy cut short by a reset is
+ * finished at the next mount.
+ *
+ * As a file system, each key is a file: opening a file for reading reads
+ * the value, and a file opened for writing collects up to
+ * FLASH_KV_FILE_MAX bytes in RAM, which are set as the key's value when
+ * the file is closed. The store is not safe to use from interrupts.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ * #include "mbed-drivers/FlashKVStore.h"
+ *
+ * // the last four sectors of internal flash, which the linker must leave free
+ * FlashKVStore config("config", 0x0007C000, 4);
+ *
+ * void app_start(int, char**) {
+ *     uint32_t boots = 0;
+ *     config.get("boots", &boots, sizeof(boots));
+ *     boots++;
+ *     config.set("boots", &boots, sizeof(boots));
+ *
+ *     FILE *f = fopen("/config/name", "r");
+ *     // ...
+ * }
+ * @endcode
+ */
+class FlashKVStore : public FileSystemLike {
+
+public:
+    /** Create a store over flash sectors of equal size
+     *
+     *  The store is mounted on its first use, or by init().
+     *
+     *  @param name The name used as the root of the file system's paths
+     *  @param start The address of the first sector
+     *  @param sectors The number of sectors, two or more
+     */
+    FlashKVStore(const char *name, uint32_t start, uint32_t sectors);
+
+    virtual ~FlashKVStore();
+
+    /** Mount the store, recovering from an interrupted write and formatting
+     *  sectors that hold no store
+     *
+     *  @returns
+     *    0 on success, -1 on error
+     */
+    int init();
+
+    /** Get the value of a key
+     *
+     *  @param key The key
+     *  @param buffer The buffer to copy the value to
+     *  @param size The size of the buffer; longer values are cut short
+     *
+     *  @returns
+     *    The length of the value, or -1 if the key is not set
+     */
+    int get(const char *key, void *buffer, size_t size);
+
+    /** Get the value of a key, without copying it
+     *
+     *  The value stays at the pointer until the store is next written.
+     *
+     *  @param key The key
+     *  @param length Set to the length of the value
+     *
+     *  @returns
+     *    A pointer to the value in flash, or NULL if the key is not set
+     */
+    const void *get_pointer(const char *key, size_t *length);
+
+    /** Set the value of a key
+     *
+     *  @param key The key, of up to FLASH_KV_KEY_MAX bytes
+     *  @param value The value
+     *  @param length The length of the value
+     *
+     *  @returns
+     *    0 on success, -1 if the store is full or on error
+     */
+    int set(const char *key, const void *value, size_t length);
+
+    /** Remove a key
+     *
+     *  @param key The key
+     *
+     *  @returns
+     *    0 on success, -1 if the key is not set or on error
+     */
+    virtual int remove(const char *key);
+
+    virtual FileHandle *open(const char *filename, int flags);
+
+    /** Get the number of keys set
+     */
+    uint32_t keys() const {
+        return _keys;
+    }
+
+    /** Get the number of times the log has moved on to a new sector, as a
+     *  count of sector erases since the store was formatted
+     */
+    uint32_t sequence() const {
+        return _sequence;
+    }
+
+private:
+    struct record_t;
+
+    const uint8_t *flash(uint32_t offset) const {
+        return (const uint8_t *)(uintptr_t)(_start + offset);
+    }
+    uint32_t record_extent(uint32_t key_length, uint32_t value_length) const;
+    uint32_t record_extent(uint32_t offset) const;
+    const record_t *record_header(uint32_t offset, uint32_t sector_end) const;
+    bool record_valid(uint32_t offset);
+    bool sector_valid(uint32_t sector, uint32_t *sequence) const;
+    bool blank(uint32_t offset, uint32_t length) const;
+    int format();
+    int scan(uint32_t sector, bool head);
+    int apply(uint32_t offset);
+    int program(uint32_t offset, const void *data, uint32_t length);
+    int program_header(uint32_t offset, const void *header, uint32_t length);
+    int program_record(uint32_t offset, const char *key, uint32_t key_length,
+                       const void *value, uint32_t value_length, uint8_t flags);
+    int append(const char *key, uint32_t key_length, const void *value, uint32_t value_length,
+               uint8_t flags, uint32_t *offset);
+    int advance(uint32_t extent);
+    uint32_t pending(uint32_t sector);
+    int collect(uint32_t sector);
+    int erase(uint32_t sector);
+
+    static uint32_t hash(const char *key, uint32_t length);
+    uint32_t *index_find(const char *key, uint32_t length);
+    uint32_t *index_insert(const char *key, uint32_t length);
+    void index_remove(uint32_t *slot);
+
+    flash_t _flash;
+    CRC _crc;
+    uint32_t _start;
+    uint32_t _sectors;
+    uint32_t _sector_size;
+    uint32_t _align;        /**< The size records and headers are padded to */
+    uint32_t _header_size;  /**< The padded size of sector and record headers */
+    uint8_t *_chunk;        /**< Where records are gathered for programming */
+    uint32_t _chunk_size;
+    uint32_t _head;         /**< The sector being written */
+    uint32_t _head_pos;     /**< The offset in it of the next record */
+    uint32_t _sequence;     /**< The sequence number of the head sector */
+    uint32_t _live;         /**< The bytes of the records in use */
+    uint32_t _keys;
+    bool _mounted;
+    uint32_t _index[FLASH_KV_INDEX_SIZE];   /**< Offsets of the newest records, 0 if free */
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
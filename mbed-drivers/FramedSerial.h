@@ -0,0 +1,150 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_FRAMED_SERIAL_H
+#define MBED_FRAMED_SERIAL_H
+
+#include "platform.h"
+
+#if DEVICE_SERIAL && DEVICE_SERIAL_ASYNCH
+
+#include "SerialBase.h"
+#include "Framing.h"
+#include "mbed_critical.h"
+
+namespace mbed {
+
+/** A serial port carrying SLIP, HDLC-style or COBS frames
+ *
+ * Frames sent are encoded in one pass into one of TxFrames slots, and sent
+ * in order with asynchronous writes, so the peripheral's DMA moves whole
+ * encoded frames. Where the port can receive continuously into a circular
+ * buffer, reception starts at once, and the frame callback is called in
+ * main context for each frame decoded from the received slices; otherwise
+ * received data has to be passed to decoder().feed().
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * void received(const char *frame, size_t length);
+ *
+ * FramedSerial<128, 4> link(p9, p10, FRAME_COBS, received);
+ *
+ * void received(const char *frame, size_t length) {
+ *     link.send(frame, length);   // echo
+ * }
+ * @endcode
+ */
+template<size_t MaxFrame = 256, uint32_t TxFrames = 4, size_t RxBufferSize = 256>
+class FramedSerial : public SerialBase {
+
+public:
+    /** Create a framed serial port, connected to the specified pins
+     *
+     *  @param tx Transmit pin
+     *  @param rx Receive pin
+     *  @param format The framing
+     *  @param callback The function to call with each frame received
+     */
+    FramedSerial(PinName tx, PinName rx, FrameFormat format, const FrameDecoder::frame_callback_t &callback) :
+            SerialBase(tx, rx),
+            _format(format),
+            _decoder(format, _rx_frame, MaxFrame, callback),
+            _tx_head(0),
+            _tx_count(0) {
+#if DEVICE_SERIAL_ASYNCH_CIRCULAR
+        read_circular(Buffer(_rx_ring, RxBufferSize), _decoder.callback());
+#endif
+    }
+
+    /** Queue a frame for sending
+     *
+     *  @param frame The frame
+     *  @param length The length of the frame, at most MaxFrame
+     *  @returns 0 if the frame was queued, or -1 if it is too long or all
+     *    TxFrames slots are in use
+     */
+    int send(const void *frame, size_t length) {
+        if (length > MaxFrame) {
+            return -1;
+        }
+        uint32_t slot;
+        {
+            CriticalSection lock;
+            if (_tx_count == TxFrames) {
+                return -1;
+            }
+            slot = (_tx_head + _tx_count) % TxFrames;
+        }
+        _tx_length[slot] = frame_encode(_format, frame, length, _tx_frame[slot]);
+        bool start;
+        {
+            CriticalSection lock;
+            start = _tx_count++ == 0;
+        }
+        if (start) {
+            start_frame();
+        }
+        return 0;
+    }
+
+    /** Get the number of frames queued or being sent
+     */
+    uint32_t pending() const {
+        return _tx_count;
+    }
+
+    /** Get the receive side's decoder
+     */
+    FrameDecoder &decoder() {
+        return _decoder;
+    }
+
+protected:
+    void start_frame() {
+        SerialBase::write(Buffer(_tx_frame[_tx_head], _tx_length[_tx_head]),
+                event_callback_t(this, &FramedSerial::frame_sent), SERIAL_EVENT_TX_COMPLETE);
+    }
+
+    void frame_sent(Buffer buffer, int event) {
+        (void)buffer;
+        (void)event;
+        bool more;
+        {
+            CriticalSection lock;
+            _tx_head = (_tx_head + 1) % TxFrames;
+            more = --_tx_count > 0;
+        }
+        if (more) {
+            start_frame();
+        }
+    }
+
+    FrameFormat _format;
+    FrameDecoder _decoder;
+    char _rx_frame[MaxFrame];
+    char _rx_ring[RxBufferSize];
+    char _tx_frame[TxFrames][2 * MaxFrame + 2];     // the worst case of any framing
+    size_t _tx_length[TxFrames];
+    volatile uint32_t _tx_head;     // the slot being sent
+    volatile uint32_t _tx_count;    // the slots queued, including the one being sent
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_FRAMING_H
+#define MBED_FRAMING_H
+
+#include "platform.h"
+#include "Buffer.h"
+#include "core-util/FunctionPointer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mbed {
+
+/** The byte stream framings
+ */
+enum FrameFormat {
+    FRAME_SLIP,     /**< RFC 1055: frames end with 0xC0, escaped with 0xDB */
+    FRAME_HDLC,     /**< HDLC-style byte stuffing: frames end with 0x7E, escaped with 0x7D and XOR 0x20; no FCS */
+    FRAME_COBS      /**< Consistent overhead byte stuffing: frames contain no 0x00, and end with one */
+};
+
+/** Get the most bytes a frame can take once encoded
+ *
+ *  @param format The framing
+ *  @param length The length of the frame
+ *  @returns The worst case encoded length, with the delimiters
+ */
+size_t frame_encoded_size(FrameFormat format, size_t length);
+
+/** Encode a frame, with its delimiters
+ *
+ *  SLIP and HDLC frames start with a delimiter too, so that line noise
+ *  before the frame is dropped as a frame of its own.
+ *
+ *  @param format The framing
+ *  @param frame The frame
+ *  @param length The length of the frame
+ *  @param out The encoded frame, of frame_encoded_size(format, length) bytes
+ *  @returns The encoded length
+ */
+size_t frame_encode(FrameFormat format, const void *frame, size_t length, char *out);
+
+/** Decodes frames from a received byte stream, a chunk at a time
+ *
+ * Data is fed in whatever chunks it was received in, and each complete
+ * frame is passed to the callback, decoded, and valid only during the
+ * callback. Runs of bytes that need no decoding are copied with memcpy,
+ * so the cost is per frame and per escape, rather than per byte.
+ *
+ * Frames longer than the buffer, and frames with invalid escapes, are
+ * dropped and counted by errors(). Empty frames, such as the leading
+ * delimiters of SLIP and HDLC, are skipped.
+ */
+class FrameDecoder {
+public:
+    /** Frame callback, called with the decoded frame and its length
+     */
+    typedef mbed::util::FunctionPointer2<void, const char *, size_t> frame_callback_t;
+
+    /** Serial read callback, as SerialBase's
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, int> event_callback_t;
+
+    /** Create a frame decoder
+     *
+     *  @param format The framing
+     *  @param buffer Storage for the frame being decoded
+     *  @param size The size of buffer, which is also the longest frame
+     *  @param callback The function to call with each frame
+     */
+    FrameDecoder(FrameFormat format, char *buffer, size_t size, const frame_callback_t &callback);
+
+    /** Add received data
+     *
+     *  @param data The data
+     *  @param length The number of bytes
+     */
+    void feed(const char *data, size_t length);
+
+    /** Get a callback that feeds the data of each serial read event
+     */
+    event_callback_t callback() {
+        return event_callback_t(this, &FrameDecoder::on_read);
+    }
+
+    /** Drop the partial frame decoded so far
+     */
+    void reset();
+
+    /** Get the number of frames dropped as too long or malformed
+     */
+    uint32_t errors() const {
+        return _errors;
+    }
+
+protected:
+    void on_read(Buffer buffer, int event);
+    void feed_escaped(const char *data, size_t length);
+    void feed_cobs(const char *data, size_t length);
+    void append(const char *data, size_t length);
+    void end_frame(bool valid);
+
+    FrameFormat _format;
+    char *_buffer;
+    size_t _size;
+    size_t _length;
+    frame_callback_t _callback;
+    uint32_t _errors;
+    bool _discarding;       // the frame is dropped, up to its delimiter
+    bool _escape;           // SLIP and HDLC: the last byte was an escape
+    bool _zero_pending;     // COBS: a zero follows the block, unless the frame ends
+    uint8_t _remaining;     // COBS: the bytes left in the block
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,194 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_HARDWARETIMEOUT_H
+#define MBED_HARDWARETIMEOUT_H
+
+#include "platform.h"
+
+#if DEVICE_HW_TIMEOUT
+
+#include "hw_timeout_api.h"
+#include "core-util/FunctionPointer.h"
+
+namespace mbed {
+
+/** A one-shot timeout on a timer compare channel of its own
+ *
+ * Timeouts share the us ticker's event queue and interrupt, so when one is
+ * due its handler may wait while the queue is walked and other handlers run.
+ * A HardwareTimeout claims a compare channel for itself: its interrupt only
+ * ever calls its function, so the latency is the core's interrupt latency.
+ * The API is that of Timeout. The deadline can also be given in the timer's
+ * own ticks, for the timer's full resolution. There are few such channels,
+ * so check claimed() after construction.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * DigitalOut pulse(D2);
+ * HardwareTimeout end_of_pulse;
+ *
+ * void end() {
+ *     pulse = 0;
+ * }
+ *
+ * void app_start(int, char**) {
+ *     pulse = 1;
+ *     end_of_pulse.attach_us(end, 2);
+ * }
+ * @endcode
+ */
+class HardwareTimeout {
+
+public:
+    /** Claim a timer compare channel
+     */
+    HardwareTimeout() : _context_function(NULL), _context(NULL) {
+        _claimed = (hw_timeout_init(&_timeout, &HardwareTimeout::irq, (uint32_t)this) == 0);
+    }
+
+    ~HardwareTimeout() {
+        if (_claimed) {
+            hw_timeout_cancel(&_timeout);
+            hw_timeout_free(&_timeout);
+        }
+    }
+
+    /** Check that a compare channel was free to claim
+     *
+     *  @returns true if the timeout can be used
+     */
+    bool claimed() const {
+        return _claimed;
+    }
+
+    /** Attach a function to be called after a time, in seconds
+     *
+     *  @param fptr pointer to the function to be called
+     *  @param t the time to wait in seconds
+     */
+    void attach(void (*fptr)(void), float t) {
+        attach_us(fptr, t * 1000000.0f);
+    }
+
+    /** Attach a member function to be called after a time, in seconds
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *  @param t the time to wait in seconds
+     */
+    template<typename T>
+    void attach(T* tptr, void (T::*mptr)(void), float t) {
+        attach_us(tptr, mptr, t * 1000000.0f);
+    }
+
+    /** Attach a function to be called after a time, in micro-seconds
+     *
+     *  @param fptr pointer to the function to be called
+     *  @param t the time to wait in micro-seconds
+     */
+    void attach_us(void (*fptr)(void), uint32_t t) {
+        _function.attach(fptr);
+        _context_function = NULL;
+        start(us_to_ticks(t));
+    }
+
+    /** Attach a member function to be called after a time, in micro-seconds
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *  @param t the time to wait in micro-seconds
+     */
+    template<typename T>
+    void attach_us(T* tptr, void (T::*mptr)(void), uint32_t t) {
+        _function.attach(tptr, mptr);
+        _context_function = NULL;
+        start(us_to_ticks(t));
+    }
+
+    /** Attach a function taking a context to be called after a number of
+     *  timer ticks
+     *
+     *  This is the cheapest and most precise way to set the timeout: the
+     *  deadline needs no conversion and the function is called directly.
+     *
+     *  @param fptr pointer to the function to be called
+     *  @param context the argument to call the function with
+     *  @param ticks the time to wait, in ticks of frequency()
+     */
+    void attach_ticks(void (*fptr)(void *), void *context, uint32_t ticks) {
+        _function.attach(0);
+        _context_function = fptr;
+        _context = context;
+        start(ticks);
+    }
+
+    /** Cancel the timeout
+     */
+    void detach() {
+        if (_claimed) {
+            hw_timeout_cancel(&_timeout);
+        }
+        _function.attach(0);
+        _context_function = NULL;
+    }
+
+    /** Get the frequency of the timer
+     *
+     *  @returns The number of ticks per second
+     */
+    uint32_t frequency() {
+        return _claimed ? hw_timeout_frequency(&_timeout) : 0;
+    }
+
+protected:
+    static void irq(uint32_t id) {
+        HardwareTimeout *timeout = (HardwareTimeout *)id;
+        if (timeout->_context_function != NULL) {
+            timeout->_context_function(timeout->_context);
+        } else {
+            timeout->_function.call();
+        }
+    }
+
+    uint32_t us_to_ticks(uint32_t us) {
+        return (uint32_t)(((uint64_t)us * frequency()) / 1000000);
+    }
+
+    void start(uint32_t ticks) {
+        if (_claimed) {
+            hw_timeout_set(&_timeout, hw_timeout_read(&_timeout) + ticks);
+        }
+    }
+
+    hw_timeout_t _timeout;
+    bool _claimed;
+    mbed::util::FunctionPointer _function;
+    void (*_context_function)(void *);
+    void *_context;
+
+    /* disallow copy constructor and assignment operators */
+private:
+    HardwareTimeout(const HardwareTimeout&);
+    HardwareTimeout & operator = (const HardwareTimeout&);
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
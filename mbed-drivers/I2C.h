@@ -25,8 +25,44 @@
 #if DEVICE_I2C_ASYNCH
 #include "CThunk.h"
 #include "dma_api.h"
+#include "CircularBuffer.h"
 #include "core-util/FunctionPointer.h"
 #include "Transaction.h"
+#include "CompletionQueue.h"
+#include "mbed_sleep.h"
+#include "Timeout.h"
+#include "DriverStats.h"
+
+/** Reported, with I2C_EVENT_ERROR, when an asynchronous transfer times out */
+#define I2C_EVENT_TIMEOUT (1 << 24)
+#endif
+
+/* Each I2C object queues up to TRANSACTION_QUEUE_SIZE_I2C transfers of its
+ * own, started back to back from the transfer complete interrupt. With no
+ * queue, transfer() fails while the bus is busy.
+ */
+#ifndef TRANSACTION_QUEUE_SIZE_I2C
+#define TRANSACTION_QUEUE_SIZE_I2C 0
+#endif
+
+/* An asynchronous transfer still running after this many microseconds is
+ * aborted, and the bus recovered, with I2C_EVENT_TIMEOUT reported. 0 never
+ * times out. set_timeout() changes it for one I2C object.
+ */
+#ifndef I2C_TRANSFER_TIMEOUT_US
+#define I2C_TRANSFER_TIMEOUT_US 0
+#endif
+
+/* The number of bus transfers, each a start or repeated start, an address
+ * and the bytes written or read, that one I2CSequenceAdder job can hold */
+#ifndef I2C_SEQUENCE_SEGMENTS
+#define I2C_SEQUENCE_SEGMENTS 4
+#endif
+
+/* The number of physical I2C peripherals whose bus frequency is tracked, on
+ * ports with DEVICE_I2C_INSTANCE */
+#ifndef I2C_PERIPHERAL_COUNT
+#define I2C_PERIPHERAL_COUNT 4
 #endif
 
 namespace mbed {
@@ -71,11 +107,32 @@ public:
     I2C(PinName sda, PinName scl);
 
     /** Set the frequency of the I2C interface
+     *
+     *  On ports with DEVICE_I2C_INSTANCE, the peripheral is only
+     *  reprogrammed if it runs at a different frequency, which I2C objects
+     *  on other peripherals do not affect.
      *
      *  @param hz The bus frequency in hertz
      */
     void frequency(int hz);
 
+#if DEVICE_SUSPEND
+    /** Stop the peripheral's clock, to save power between bursts
+     *
+     *  The HAL keeps the peripheral's configuration, so resume() needs no
+     *  pinmap lookups and no reconfiguration. The I2C interface must not be used
+     *  until it is resumed.
+     *
+     *  @returns 0 on success, or -1 if an asynchronous transfer is in
+     *    progress
+     */
+    int suspend();
+
+    /** Restart the peripheral's clock after suspend()
+     */
+    void resume();
+#endif
+
     /** Read from an I2C slave
      *
      * Performs a complete read transaction. The bottom bit of
@@ -127,6 +184,60 @@ public:
      */
     int write(int data);
 
+    /** Read a register of an I2C slave
+     *
+     * Writes the register address, then reads the register back after a
+     * repeated start.
+     *
+     *  @param address 8-bit I2C slave address
+     *  @param reg The register address
+     *
+     *  @returns
+     *    the register value, or -1 on failure (nack)
+     */
+    int read_reg(int address, char reg);
+
+    /** Read consecutive registers of an I2C slave
+     *
+     *  @param address 8-bit I2C slave address
+     *  @param reg The address of the first register
+     *  @param data Pointer to the byte-array to read data in to
+     *  @param length Number of registers to read
+     *
+     *  @returns
+     *       0 on success (ack),
+     *   non-0 on failure (nack)
+     */
+    int read_regs(int address, char reg, char *data, int length);
+
+    /** Write a register of an I2C slave
+     *
+     *  @param address 8-bit I2C slave address
+     *  @param reg The register address
+     *  @param value The value to write
+     *
+     *  @returns
+     *       0 on success (ack),
+     *   non-0 on failure (nack)
+     */
+    int write_reg(int address, char reg, char value);
+
+    /** Write consecutive registers of an I2C slave
+     *
+     * The register address and the data are sent in one write transaction,
+     * without copying them to a single buffer first.
+     *
+     *  @param address 8-bit I2C slave address
+     *  @param reg The address of the first register
+     *  @param data Pointer to the byte-array data to send
+     *  @param length Number of registers to write
+     *
+     *  @returns
+     *       0 on success (ack),
+     *   non-0 on failure (nack)
+     */
+    int write_regs(int address, char reg, const char *data, int length);
+
     /** Creates a start condition on the I2C bus
      */
 
@@ -136,6 +247,20 @@ public:
      */
     void stop(void);
 
+    /** Free a bus that a slave is holding
+     *
+     *  A slave reset or interrupted part way through a read can hold SDA low
+     *  indefinitely. This takes the pins over as GPIO, clocks SCL up to nine
+     *  times until the slave lets go of SDA, sends a stop condition and
+     *  hands the pins back to the peripheral. It blocks for about 100us at
+     *  most, and must not be called while a transfer is in progress.
+     *
+     *  @returns
+     *       0 if the bus is free,
+     *      -1 if SDA is still held low
+     */
+    int recover_bus(void);
+
 #if DEVICE_I2C_ASYNCH
     /** I2C transfer callback
      *  @param Buffer the tx buffer
@@ -144,6 +269,11 @@ public:
      */
     typedef mbed::util::FunctionPointer3<void, Buffer, Buffer, int> event_callback_t;
 
+    /** I2C completion handler
+     *  @param int the logical OR of the events since the handler last ran
+     */
+    typedef mbed::util::FunctionPointer1<void, int> completion_handler_t;
+
     /** Start non-blocking I2C transfer.
      *
      * @param address   8/10 bit I2c slave address
@@ -154,9 +284,10 @@ public:
      * @param event     The logical OR of events to modify
      * @param callback  The event callback function
      * @param repeated Repeated start, true - do not send stop at end
-     * @return Zero if the transfer has started, or -1 if I2C peripheral is busy
+     * @param priority  If queued, start ahead of queued transfers of lower priority
+     * @return Zero if the transfer has started or was queued, or -1 if I2C peripheral is busy and the queue is full
      */
-    int transfer(int address, char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false);
+    int transfer(int address, char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false, uint8_t priority = 0);
 
      /** Start non-blocking I2C transfer.
      *
@@ -166,29 +297,359 @@ public:
      * @param event     The logical OR of events to modify
      * @param callback  The event callback function
      * @param repeated Repeated start, true - do not send stop at end
-     * @return Zero if the transfer has started, or -1 if I2C peripheral is busy
+     * @param priority  If queued, start ahead of queued transfers of lower priority
+     * @return Zero if the transfer has started or was queued, or -1 if I2C peripheral is busy and the queue is full
      */
-    int transfer(int address, const Buffer& tx_buffer, const Buffer& rx_buffer, const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false);
+    int transfer(int address, const Buffer& tx_buffer, const Buffer& rx_buffer, const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false, uint8_t priority = 0);
 
-    /** Abort the on-going I2C transfer
+    /** Set the handler for the transfers started with an empty callback
+     *
+     *  The handler is bound once, here, and each completion of such a
+     *  transfer adds its events to those waiting and posts the same
+     *  preallocated event to the scheduler, rather than binding a callback
+     *  to its buffers. Completions that arrive before the handler runs are
+     *  coalesced into one call.
+     *
+     *  @param handler The handler, or an empty one to report nothing
+     */
+    void set_completion_handler(const completion_handler_t &handler);
+
+    /** Set the priority of the transfers' completions in the scheduler
+     *
+     *  See CompletionQueue::Priority. A high priority keeps a stream of
+     *  transfers fed while other drivers' completions are waiting.
+     *
+     *  @param priority The priority, PRIORITY_NORMAL by default
+     */
+    void set_completion_priority(CompletionQueue::Priority priority) {
+        _completion.set_priority(priority);
+        _completion_signal.set_priority(priority);
+    }
+
+    /** One register block read of a burst
+     */
+    struct register_read_t {
+        int address;    /**< 8-bit I2C slave address */
+        char reg;       /**< The address of the first register */
+        Buffer rx;      /**< Receives the registers */
+    };
+
+    /** Start a non-blocking read of consecutive registers
+     *
+     * The register address is written and the data read back after a
+     * repeated start, in a single asynchronous transfer. The tx buffer passed
+     * to the callback holds the register address.
+     *
+     * @param address   8-bit I2C slave address
+     * @param reg       The address of the first register
+     * @param rx_buffer Receives the registers
+     * @param callback  The event callback function
+     * @param event     The logical OR of events to modify
+     * @return Zero if the transfer has started or was queued, or -1 if I2C peripheral is busy and the queue is full
+     */
+    int read_regs(int address, char reg, const Buffer& rx_buffer, const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE);
+
+    /** Start a non-blocking write of a register
+     *
+     * @param address   8-bit I2C slave address
+     * @param reg       The register address
+     * @param value     The value to write
+     * @param callback  The event callback function
+     * @param event     The logical OR of events to modify
+     * @return Zero if the transfer has started or was queued, or -1 if I2C peripheral is busy and the queue is full
+     */
+    int write_reg(int address, char reg, char value, const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE);
+
+    /** Start a burst of register block reads, possibly from several slaves
+     *
+     * The reads run back to back from the transfer complete interrupt, as
+     * a single queued job, and the callback is called once, when the last
+     * read has completed or when one of them fails. The callback is passed an
+     * empty tx buffer and the rx buffer of the read that completed the burst.
+     * The reads array must stay valid until then.
+     *
+     * @param reads     The register reads to perform, in order
+     * @param count     The number of elements in reads
+     * @param callback  The event callback function
+     * @param event     The logical OR of events to modify
+     * @return Zero if the transfer has started or was queued, or -1 if I2C peripheral is busy and the queue is full
+     */
+    int read_burst(register_read_t *reads, int count, const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE);
+
+protected:
+    /** One bus transfer of a sequence
+     */
+    struct segment_t {
+        int address;               /**< 8-bit slave address */
+        Buffer tx_buffer;          /**< Written first, if not empty */
+        Buffer rx_buffer;          /**< Then read after a repeated start, if not empty */
+        bool stop;                 /**< Whether a stop ends the transfer */
+    };
+
+public:
+    class I2CSequenceAdder {
+        friend class I2C;
+    private:
+        I2CSequenceAdder(I2C *owner);
+        const I2CSequenceAdder & operator =(const I2CSequenceAdder &a);
+        I2CSequenceAdder(const I2CSequenceAdder &a);
+    public:
+        /** Add a start, or a repeated start if no stop came before, then
+         *  an address in write mode and the bytes to write
+         *
+         *  NOTE: Up to I2C_SEQUENCE_SEGMENTS writes and reads can be added.
+         *
+         *  @param address 8-bit I2C slave address; the bottom bit is ignored
+         *  @param data The bytes to write, which must stay valid until the callback
+         *  @param length The number of bytes
+         *  @return a reference to the I2CSequenceAdder
+         */
+        I2CSequenceAdder & write(int address, const char *data, int length);
+        /** Add a start, or a repeated start if no stop came before, then
+         *  an address in read mode and the bytes to read
+         *
+         *  A read straight after a write to the same address is made in the
+         *  same bus transfer as the write, counting as one of the
+         *  I2C_SEQUENCE_SEGMENTS.
+         *
+         *  @param address 8-bit I2C slave address; the bottom bit is ignored
+         *  @param data Receives the bytes
+         *  @param length The number of bytes
+         *  @return a reference to the I2CSequenceAdder
+         */
+        I2CSequenceAdder & read(int address, char *data, int length);
+        /** Add a stop condition after the last write or read
+         *
+         *  The sequence always ends with a stop, so this is only needed
+         *  between writes and reads that must not be joined by a
+         *  repeated start.
+         *
+         *  @return a reference to the I2CSequenceAdder
+         */
+        I2CSequenceAdder & stop();
+        /** Set the callback, called once when the whole sequence completes or
+         *  when one of its transfers fails
+         *
+         *  The callback is passed the buffers of the transfer that completed
+         *  the sequence.
+         *
+         *  @param cb The event callback function
+         *  @param event The logical OR of events to modify
+         *  @return a reference to the I2CSequenceAdder
+         */
+        I2CSequenceAdder & callback(const event_callback_t &cb, int event = I2C_EVENT_TRANSFER_COMPLETE);
+        /** Set the sequence's priority, as for transfer()
+         *
+         *  @param level The priority, higher being more urgent
+         *  @return a reference to the I2CSequenceAdder
+         */
+        I2CSequenceAdder & priority(uint8_t level);
+        /** Start the sequence, or queue it if the bus is busy
+         *
+         *  @return Zero if the sequence has started or was queued, or -1 if
+         *    it is empty or too long, or the bus is busy and the queue is full
+         */
+        int apply();
+        ~I2CSequenceAdder();
+    private:
+        segment_t _segments[I2C_SEQUENCE_SEGMENTS];
+        int _count;
+        bool _overflow;
+        event_callback_t _callback;
+        int _event;
+        uint8_t _priority;
+        bool _applied;
+        int _rc;
+        I2C *_owner;
+    };
+
+    /** Start a sequence of byte level operations, run from the interrupt as one job
+     *
+     *  Where start(), write(int), read(int) and stop() each block on the
+     *  bus, the writes and reads of a sequence are made back to back by
+     *  asynchronous transfers, joined by repeated starts unless a stop is
+     *  added between them, and the callback is called once at the end.
+     *
+     *  Example:
+     *  @code
+     *  // write a command, then read the reply without releasing the bus
+     *  i2c.sequence()
+     *      .write(0x90, command, 2)
+     *      .read(0x90, reply, 4)
+     *      .callback(I2C::event_callback_t(done))
+     *      .apply();
+     *  @endcode
+     *
+     *  @return An I2CSequenceAdder. When either apply() is called or the
+     *      I2CSequenceAdder goes out of scope, the sequence is started or queued.
+     */
+    I2CSequenceAdder sequence();
+
+    /** Abort the on-going I2C transfer, and continue with transfers in the queue if any.
      */
     void abort_transfer();
+
+    /** Clear the transaction buffer
+     */
+    void clear_transfer_buffer();
+
+    /** Clear the transaction buffer and abort on-going transfer.
+     */
+    void abort_all_transfers();
+
+    /** Set the time an asynchronous transfer may take
+     *
+     *  A transfer still running after the timeout is aborted at once. The
+     *  bus is then recovered with recover_bus() from the scheduler, and the
+     *  callback is called with I2C_EVENT_ERROR | I2C_EVENT_TIMEOUT, whatever
+     *  events were asked for. Transfers started meanwhile are queued, and
+     *  the next queued transfer then starts.
+     *
+     *  @param us The timeout in microseconds, or 0 to never time out
+     */
+    void set_timeout(uint32_t us);
+
+#if DRIVER_STATS
+    /** Get the statistics of the asynchronous transfers
+     *
+     *  @param stats Set to a consistent copy of the statistics
+     */
+    void get_stats(driver_stats_t *stats) const {
+        _stats.get(stats);
+    }
+
+    /** Reset the statistics
+     */
+    void reset_stats() {
+        _stats.reset();
+    }
+#endif
 protected:
-    typedef TwoWayTransaction<event_callback_t> transaction_data_t;
+    /** Transactions on the I2C bus
+     */
+    struct transaction_data_t {
+        Buffer tx_buffer;          /**< Transmit buffer */
+        Buffer rx_buffer;          /**< Receive buffer */
+        uint32_t event;            /**< Event for a transaction */
+        event_callback_t callback; /**< User's callback */
+        int address;               /**< 8/10 bit slave address */
+        bool repeated;             /**< Repeated start, true - do not send stop at end */
+        char reg[2];               /**< Register address and value, sent instead of tx_buffer if reg_length is set */
+        uint8_t reg_length;        /**< The number of bytes of reg to send */
+        register_read_t *burst;    /**< The reads of a burst, or NULL */
+        int burst_count;           /**< The number of reads in burst */
+        segment_t segments[I2C_SEQUENCE_SEGMENTS];  /**< The transfers of a sequence */
+        int segment_count;         /**< The number of transfers in segments, 0 if not a sequence */
+        uint8_t priority;          /**< Queued transfers of higher priority start first */
+    };
     typedef Transaction<I2C, transaction_data_t> transaction_t;
 
     void irq_handler_asynch(void);
+#if DEVICE_I2C_ASYNCH_CONTEXT
+    static void irq_handler_context(uint32_t id);
+#endif
+
+    /** Add a transfer to the queue
+     * @param td Transaction data
+     * @return Zero if a transfer was added to the queue, or -1 if the queue is full
+     */
+    int queue_transfer(const transaction_data_t &td);
+
+#if TRANSACTION_QUEUE_SIZE_I2C
+    /** Add a transfer behind the ones in the queue, which must not be full
+     * @param td Transaction data
+     */
+    void enqueue_transaction(const transaction_data_t &td);
+#endif
+
+    /** Configure the bus and start a transfer
+     * @param td Transaction data
+     */
+    void start_transfer(const transaction_data_t &td);
+
+    /** Start the current read of a burst
+     */
+    void start_burst_read();
+
+    /** Start the current transfer of a sequence
+     */
+    void start_segment();
+
+    /** Start or queue a sequence of transfers
+     */
+    int transfer(const I2CSequenceAdder &sequence);
+
+    /** Start the next queued transfer, if any
+     */
+    void dequeue_transaction();
+
+    /** Abort the current transfer when it has run for too long
+     */
+    void timeout_handler();
+
+    /** Recover the bus after a timeout and report it, from the scheduler
+     */
+    void finish_timeout();
+
+    /** Check if a transfer runs, or the bus is being recovered from one
+     */
+    bool busy() {
+        return i2c_active(&_i2c) || _recovering;
+    }
+
+    /** Add events for the completion handler and post its event
+     */
+    void signal_completion(int event);
+    void deliver_completion();
+
+#if TRANSACTION_QUEUE_SIZE_I2C
+    CircularBuffer<transaction_t, TRANSACTION_QUEUE_SIZE_I2C> _transaction_buffer;
+#endif
     transaction_data_t _current_transaction;
+    CompletionQueue::Slot _completion;  /**< Where the current transfer's completion is posted */
+    DeepSleepLock _deep_sleep;          /**< Held while an asynchronous transfer runs */
+    int _burst_index;                   /**< The current read of a burst, or transfer of a sequence */
+    Timeout _timeout;                   /**< Set while an asynchronous transfer runs, if _timeout_us */
+    uint32_t _timeout_us;
+#if !DEVICE_I2C_ASYNCH_CONTEXT
     CThunk<I2C> _irq;
+#endif
     DMAUsage _usage;
+    completion_handler_t _completion_handler;
+    volatile int _completion_events;    /**< Events waiting for the completion handler */
+    CompletionQueue::Slot _completion_signal;   /**< Bound to deliver_completion() once */
+    CompletionQueue::Slot _recovery;    /**< Bound to finish_timeout() once */
+    volatile bool _recovering;          /**< Set from a timeout until the bus is recovered */
+#if DRIVER_STATS
+    DriverStats _stats;
+#endif
 #endif
 
 protected:
     void aquire();
 
+#if DEVICE_I2C_INSTANCE
+    /** The frequency a physical I2C peripheral is programmed with
+     */
+    struct peripheral_t {
+        uint32_t instance;  /**< The HAL instance of the peripheral */
+        int hz;             /**< The programmed frequency, or 0 if unused */
+    };
+#endif
+
     i2c_t _i2c;
-    static I2C  *_owner;
+#if DEVICE_I2C_INSTANCE
+    peripheral_t *_peripheral;
+#endif
     int         _hz;
+    PinName     _sda;
+    PinName     _scl;
+
+#if DEVICE_I2C_INSTANCE
+    static peripheral_t _peripherals[I2C_PERIPHERAL_COUNT];
+#else
+    static I2C  *_owner;
+#endif
 };
 
 } // namespace mbed
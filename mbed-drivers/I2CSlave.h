@@ -0,0 +1,277 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_I2C_SLAVE_H
+#define MBED_I2C_SLAVE_H
+
+#include "platform.h"
+
+#if DEVICE_I2CSLAVE
+
+#include "i2c_api.h"
+
+#if DEVICE_I2CSLAVE_ASYNCH
+#include "CThunk.h"
+#include "dma_api.h"
+#include "core-util/FunctionPointer.h"
+#include "Buffer.h"
+#include "CompletionQueue.h"
+#include "mbed_sleep.h"
+#endif
+
+namespace mbed {
+
+/** An I2C Slave, used for communicating with an I2C Master device
+ *
+ * Example:
+ * @code
+ * // Simple I2C responder
+ * #include "mbed.h"
+ *
+ * I2CSlave slave(p9, p10);
+ *
+ * int main() {
+ *     char buf[10];
+ *     char msg[] = "Slave!";
+ *
+ *     slave.address(0xA0);
+ *     while (1) {
+ *         int i = slave.receive();
+ *         switch (i) {
+ *             case I2CSlave::ReadAddressed:
+ *                 slave.write(msg, strlen(msg) + 1); // Includes null char
+ *                 break;
+ *             case I2CSlave::WriteGeneral:
+ *             case I2CSlave::WriteAddressed:
+ *                 slave.read(buf, 10);
+ *                 printf("Read: %s\n", buf);
+ *                 break;
+ *         }
+ *         for(int i = 0; i < 10; i++) buf[i] = 0;    // Clear buffer
+ *     }
+ * }
+ * @endcode
+ *
+ * With DEVICE_I2CSLAVE_ASYNCH, receive() and send() instead hand the
+ * peripheral a buffer to fill or drain from its interrupt, or by DMA, and
+ * report back through the minar scheduler. A transfer the master starts
+ * while no buffer is ready is held off by clock stretching until one is,
+ * so an address callback can arm the buffer as the master asks for it:
+ * @code
+ * I2CSlave slave(p9, p10);
+ * char command[8];
+ * char status[4];
+ *
+ * void received(Buffer rx, int event) {
+ *     // rx.length bytes of command arrived
+ *     slave.receive(Buffer(command, sizeof(command)), received);
+ * }
+ *
+ * void addressed(int event) {
+ *     if (event & I2C_SLAVE_EVENT_ADDRESS_READ) {
+ *         slave.send(Buffer(status, sizeof(status)), I2CSlave::event_callback_t());
+ *     }
+ * }
+ *
+ * void app_start(int, char **) {
+ *     slave.address(0xA0);
+ *     slave.attach_address(addressed);
+ *     slave.receive(Buffer(command, sizeof(command)), received);
+ * }
+ * @endcode
+ */
+class I2CSlave {
+
+public:
+    enum RxStatus {
+        NoData         = 0,
+        ReadAddressed  = 1,
+        WriteGeneral   = 2,
+        WriteAddressed = 3
+    };
+
+    /** Create an I2C Slave interface, connected to the specified pins.
+     *
+     *  @param sda I2C data line pin
+     *  @param scl I2C clock line pin
+     */
+    I2CSlave(PinName sda, PinName scl);
+
+    /** Set the frequency of the I2C interface
+     *
+     *  @param hz The bus frequency in hertz
+     */
+    void frequency(int hz);
+
+    /** Checks to see if this I2C Slave has been addressed.
+     *
+     *  @returns
+     *  A status indicating if the device has been addressed, and how
+     *  - NoData            - the slave has not been addressed
+     *  - ReadAddressed     - the master has requested a read from this slave
+     *  - WriteAddressed    - the master is writing to this slave
+     *  - WriteGeneral      - the master is writing to all slave
+     */
+    int receive(void);
+
+    /** Read from an I2C master.
+     *
+     *  @param data pointer to the byte array to read data in to
+     *  @param length maximum number of bytes to read
+     *
+     *  @returns
+     *       0 on success,
+     *   non-0 otherwise
+     */
+    int read(char *data, int length);
+
+    /** Read a single byte from an I2C master.
+     *
+     *  @returns
+     *    the byte read
+     */
+    int read(void);
+
+    /** Write to an I2C master.
+     *
+     *  @param data pointer to the byte array to be transmitted
+     *  @param length the number of bytes to transmite
+     *
+     *  @returns
+     *       0 on success,
+     *   non-0 otherwise
+     */
+    int write(const char *data, int length);
+
+    /** Write a single byte to an I2C master.
+     *
+     *  @param data the byte to write
+     *
+     *  @returns
+     *    '1' if an ACK was received,
+     *    '0' otherwise
+     */
+    int write(int data);
+
+    /** Sets the I2C slave address.
+     *
+     *  @param address The address to set for the slave (ignoring the least
+     *  signifcant bit). If set to 0, the slave will only respond to the
+     *  general call address.
+     */
+    void address(int address);
+
+    /** Reset the I2C slave back into the known ready receiving state.
+     */
+    void stop(void);
+
+#if DEVICE_I2CSLAVE_ASYNCH
+    /** Address match callback, called from the interrupt handler with
+     *  I2C_SLAVE_EVENT_ADDRESS_READ, I2C_SLAVE_EVENT_ADDRESS_WRITE or
+     *  I2C_SLAVE_EVENT_GENERAL_CALL
+     */
+    typedef mbed::util::FunctionPointer1<void, int> address_callback_t;
+
+    /** Transfer callback, called with the part of the buffer that was
+     *  transferred, and the events that ended the transfer
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, int> event_callback_t;
+
+    /** Attach a function to call when the master addresses this slave
+     *
+     *  The function runs in the interrupt handler, before the transfer
+     *  starts, so it can arm the buffer with receive() or send(). Until a
+     *  buffer is armed, the peripheral stretches the clock.
+     *
+     *  @param callback The function to call, or an empty function pointer
+     *    to detach it
+     */
+    void attach_address(const address_callback_t &callback);
+
+    /** Arm a buffer for the next data the master writes
+     *
+     *  The transfer ends when the buffer is full (I2C_SLAVE_EVENT_RX_COMPLETE),
+     *  when the master stops (I2C_SLAVE_EVENT_STOP), or on an error. If the
+     *  buffer fills before the master stops, the clock is stretched until the
+     *  next buffer is armed.
+     *
+     *  @param buffer The buffer to receive into
+     *  @param callback The function to call when the transfer ends
+     *  @param event The events that trigger calling of the callback
+     *  @returns 0 on success, or -1 if a receive buffer is already armed
+     */
+    int receive(const Buffer &buffer, const event_callback_t &callback, int event = I2C_SLAVE_EVENT_ALL);
+
+    /** Arm a buffer for the next data the master reads
+     *
+     *  The transfer ends when the buffer has been sent
+     *  (I2C_SLAVE_EVENT_TX_COMPLETE), when the master stops
+     *  (I2C_SLAVE_EVENT_STOP), or on an error.
+     *
+     *  @param buffer The buffer to send from
+     *  @param callback The function to call when the transfer ends
+     *  @param event The events that trigger calling of the callback
+     *  @returns 0 on success, or -1 if a send buffer is already armed
+     */
+    int send(const Buffer &buffer, const event_callback_t &callback, int event = I2C_SLAVE_EVENT_ALL);
+
+    /** Disarm both buffers, ending the transfer in progress if any
+     */
+    void abort();
+
+    /** Configure DMA usage suggestion for non-blocking transfers
+     *
+     *  @param usage The usage DMA hint for peripheral
+     *  @return Zero if the usage was set, -1 if a buffer is armed
+     */
+    int set_dma_usage(DMAUsage usage);
+
+protected:
+    /** A buffer armed in one direction
+     */
+    struct transfer_t {
+        Buffer buffer;              /**< The armed buffer, with no data if none is */
+        event_callback_t callback;  /**< User's callback */
+        int event;                  /**< Events that trigger the callback */
+    };
+
+    void irq_handler_asynch(void);
+
+    /** Report the end of the transfer in one direction, and disarm it
+     *  @param t The direction's transfer
+     *  @param event The events the HAL reported
+     */
+    void finish(transfer_t &t, int event);
+
+    transfer_t _rx;
+    transfer_t _tx;
+    transfer_t *_active;                /**< The direction the master addressed, or NULL */
+    address_callback_t _address_callback;
+    CompletionQueue::Slot _rx_completion;
+    CompletionQueue::Slot _tx_completion;
+    DeepSleepLock _deep_sleep;          /**< Held from an address match until the transfer ends */
+    CThunk<I2CSlave> _irq;
+    DMAUsage _usage;
+#endif
+
+protected:
+    i2c_t _i2c;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
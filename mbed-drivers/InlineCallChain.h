@@ -0,0 +1,248 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_INLINECALLCHAIN_H
+#define MBED_INLINECALLCHAIN_H
+
+#include <stddef.h>
+#include <string.h>
+
+namespace mbed {
+
+/** A chain of up to N functions, each taking a context pointer, stored by value
+ *
+ * Where CallChain and StaticCallChain hold pointers to FunctionPointer
+ * objects, InlineCallChain holds each function and its context side by side
+ * in one array, so call() walks contiguous memory and makes one direct call
+ * per function, with no FunctionPointer dispatch. It is meant for chains
+ * called from interrupts, where those cycles count.
+ *
+ * Functions are identified by their function and context pair, which
+ * find() and remove() take. Member functions are added through a thunk that
+ * add() instantiates for them. Adding to a full chain fails and returns
+ * false.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ * #include "mbed-drivers/InlineCallChain.h"
+ *
+ * InlineCallChain<2> chain;
+ *
+ * void count(void *context) {
+ *     (*(int *)context)++;
+ * }
+ *
+ * class Test {
+ * public:
+ *     void f(void) {
+ *         printf("Test::f (class member).\n");
+ *     }
+ * };
+ *
+ * int main() {
+ *     int counter = 0;
+ *     Test test;
+ *
+ *     chain.add(count, &counter);
+ *     chain.add<Test, &Test::f>(&test);
+ *     chain.call();
+ * }
+ * @endcode
+ */
+template<int N>
+class InlineCallChain {
+public:
+    /** The type of the functions in the chain */
+    typedef void (*function_t)(void *context);
+
+    /** Create an empty chain
+     */
+    InlineCallChain() : _elements(0) {
+    }
+
+    /** Add a function at the end of the chain
+     *
+     *  @param function The function to call
+     *  @param context The pointer to pass to it
+     *
+     *  @returns
+     *  true if the function was added, false if the chain is full
+     */
+    bool add(function_t function, void *context = NULL) {
+        if (_elements == N)
+            return false;
+        _chain[_elements].function = function;
+        _chain[_elements].context = context;
+        _elements ++;
+        return true;
+    }
+
+    /** Add a member function at the end of the chain
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *
+     *  @returns
+     *  true if the function was added, false if the chain is full
+     */
+    template<typename T, void (T::*M)(void)>
+    bool add(T *tptr) {
+        return add(&member_thunk<T, M>, tptr);
+    }
+
+    /** Add a function at the beginning of the chain
+     *
+     *  @param function The function to call
+     *  @param context The pointer to pass to it
+     *
+     *  @returns
+     *  true if the function was added, false if the chain is full
+     */
+    bool add_front(function_t function, void *context = NULL) {
+        if (_elements == N)
+            return false;
+        memmove(_chain + 1, _chain, _elements * sizeof(entry_t));
+        _chain[0].function = function;
+        _chain[0].context = context;
+        _elements ++;
+        return true;
+    }
+
+    /** Add a member function at the beginning of the chain
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *
+     *  @returns
+     *  true if the function was added, false if the chain is full
+     */
+    template<typename T, void (T::*M)(void)>
+    bool add_front(T *tptr) {
+        return add_front(&member_thunk<T, M>, tptr);
+    }
+
+    /** Get the number of functions in the chain
+     */
+    int size() const {
+        return _elements;
+    }
+
+    /** Get the maximum number of functions in the chain
+     */
+    int capacity() const {
+        return N;
+    }
+
+    /** Look for a function in the call chain
+     *
+     *  @param function The function to search
+     *  @param context The context it was added with
+     *
+     *  @returns
+     *  The index of the first match if found, -1 otherwise.
+     */
+    int find(function_t function, void *context = NULL) const {
+        for (int i = 0; i < _elements; i++)
+            if (_chain[i].function == function && _chain[i].context == context)
+                return i;
+        return -1;
+    }
+
+    /** Look for a member function in the call chain
+     *
+     *  @param tptr The object it was added with
+     *
+     *  @returns
+     *  The index of the first match if found, -1 otherwise.
+     */
+    template<typename T, void (T::*M)(void)>
+    int find(T *tptr) const {
+        return find(&member_thunk<T, M>, tptr);
+    }
+
+    /** Clear the call chain (remove all functions in the chain).
+     */
+    void clear() {
+        _elements = 0;
+    }
+
+    /** Remove a function from the chain
+     *
+     *  @param function The function to remove
+     *  @param context The context it was added with
+     *
+     *  @returns
+     *  true if the function was found and removed, false otherwise.
+     */
+    bool remove(function_t function, void *context = NULL) {
+        int i;
+
+        if ((i = find(function, context)) == -1)
+            return false;
+        if (i != _elements - 1)
+            memmove(_chain + i, _chain + i + 1, (_elements - i - 1) * sizeof(entry_t));
+        _elements --;
+        return true;
+    }
+
+    /** Remove a member function from the chain
+     *
+     *  @param tptr The object it was added with
+     *
+     *  @returns
+     *  true if the function was found and removed, false otherwise.
+     */
+    template<typename T, void (T::*M)(void)>
+    bool remove(T *tptr) {
+        return remove(&member_thunk<T, M>, tptr);
+    }
+
+    /** Call all the functions in the chain in sequence
+     */
+    void call() const {
+        const entry_t *entry = _chain;
+        const entry_t *end = _chain + _elements;
+        for (; entry != end; entry++)
+            entry->function(entry->context);
+    }
+
+#ifdef MBED_OPERATORS
+    void operator ()(void) const {
+        call();
+    }
+#endif
+
+private:
+    struct entry_t {
+        function_t function;
+        void *context;
+    };
+
+    template<typename T, void (T::*M)(void)>
+    static void member_thunk(void *context) {
+        (static_cast<T *>(context)->*M)();
+    }
+
+    entry_t _chain[N];
+    int _elements;
+
+    /* disallow copy constructor and assignment operators */
+private:
+    InlineCallChain(const InlineCallChain&);
+    InlineCallChain & operator = (const InlineCallChain&);
+};
+
+} // namespace mbed
+
+#endif
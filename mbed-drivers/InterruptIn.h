@@ -22,8 +22,24 @@
 
 #include "gpio_api.h"
 #include "gpio_irq_api.h"
+#include "us_ticker_api.h"
+#include "Timeout.h"
+#include "StaticCallChain.h"
 #include "core-util/FunctionPointer.h"
 
+/* The most handlers that can be attached to each edge of an InterruptIn,
+ * with add_rise() and add_fall(). They are stored in the object, so raising
+ * this grows every InterruptIn.
+ */
+#ifndef INTERRUPTIN_HANDLERS
+#define INTERRUPTIN_HANDLERS 2
+#endif
+
+/* The most ports that can be batched by InterruptIn::attach_port() at once */
+#ifndef INTERRUPTIN_BATCH_PORTS
+#define INTERRUPTIN_BATCH_PORTS 2
+#endif
+
 namespace mbed {
 
 /** A digital interrupt input, used to call a function on a rising or falling edge
@@ -51,6 +67,7 @@ namespace mbed {
  * @endcode
  */
 class InterruptIn {
+    friend class TriggerLink;
 
 public:
 
@@ -68,7 +85,7 @@ public:
 
 #endif
 
-    /** Attach a function to call when a rising edge occurs on the input
+    /** Attach a function to call when a rising edge occurs on the input, replacing any added handlers
      *
      *  @param fptr A pointer to a void function, or 0 to set as none
      */
@@ -81,11 +98,48 @@ public:
      */
     template<typename T>
     void rise(T* tptr, void (T::*mptr)(void)) {
-        _rise.attach(tptr, mptr);
-        gpio_irq_set(&gpio_irq, IRQ_RISE, 1);
+        _rise.clear();
+        add_rise(tptr, mptr);
+    }
+
+    /** Add a function to call when a rising edge occurs on the input
+     *
+     * The handlers are called in the order they were added.
+     *
+     *  @param fptr A pointer to a void function
+     *
+     *  @returns
+     *  The function object created for 'fptr', or NULL if INTERRUPTIN_HANDLERS are already attached
+     */
+    pFunctionPointer_t add_rise(void (*fptr)(void));
+
+    /** Add a member function to call when a rising edge occurs on the input
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *
+     *  @returns
+     *  The function object created for 'tptr' and 'mptr', or NULL if INTERRUPTIN_HANDLERS are already attached
+     */
+    template<typename T>
+    pFunctionPointer_t add_rise(T* tptr, void (T::*mptr)(void)) {
+        pFunctionPointer_t pf = _rise.add(tptr, mptr);
+        if (pf != NULL) {
+            enable_edge(EDGE_RISE);
+        }
+        return pf;
     }
 
-    /** Attach a function to call when a falling edge occurs on the input
+    /** Remove a function added with add_rise()
+     *
+     *  @param pf The function object returned by add_rise()
+     *
+     *  @returns
+     *  true if the function was found and removed, false otherwise
+     */
+    bool remove_rise(pFunctionPointer_t pf);
+
+    /** Attach a function to call when a falling edge occurs on the input, replacing any added handlers
      *
      *  @param fptr A pointer to a void function, or 0 to set as none
      */
@@ -98,10 +152,47 @@ public:
      */
     template<typename T>
     void fall(T* tptr, void (T::*mptr)(void)) {
-        _fall.attach(tptr, mptr);
-        gpio_irq_set(&gpio_irq, IRQ_FALL, 1);
+        _fall.clear();
+        add_fall(tptr, mptr);
+    }
+
+    /** Add a function to call when a falling edge occurs on the input
+     *
+     * The handlers are called in the order they were added.
+     *
+     *  @param fptr A pointer to a void function
+     *
+     *  @returns
+     *  The function object created for 'fptr', or NULL if INTERRUPTIN_HANDLERS are already attached
+     */
+    pFunctionPointer_t add_fall(void (*fptr)(void));
+
+    /** Add a member function to call when a falling edge occurs on the input
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *
+     *  @returns
+     *  The function object created for 'tptr' and 'mptr', or NULL if INTERRUPTIN_HANDLERS are already attached
+     */
+    template<typename T>
+    pFunctionPointer_t add_fall(T* tptr, void (T::*mptr)(void)) {
+        pFunctionPointer_t pf = _fall.add(tptr, mptr);
+        if (pf != NULL) {
+            enable_edge(EDGE_FALL);
+        }
+        return pf;
     }
 
+    /** Remove a function added with add_fall()
+     *
+     *  @param pf The function object returned by add_fall()
+     *
+     *  @returns
+     *  true if the function was found and removed, false otherwise
+     */
+    bool remove_fall(pFunctionPointer_t pf);
+
     /** Set the input pin mode
      *
      *  @param mode PullUp, PullDown, PullNone
@@ -118,14 +209,146 @@ public:
      */
     void disable_irq();
 
+    /** Ignore the edges that follow a reported edge for a while
+     *
+     * After a rise or fall handler is called, both edges are masked for
+     * the window, using the ticker queue rather than an interrupt per bounce.
+     * When the window closes the pin is read again, and if it has settled at
+     * the other level, that edge is reported then.
+     *
+     *  @param window_us The window in micro-seconds, or 0 to report every edge
+     */
+    void debounce(timestamp_t window_us);
+
+    /** Limit the number of rise and fall handler calls per second
+     *
+     * Once the limit is reached, both edges are masked until the end of the
+     * current second, so a noisy line cannot starve the rest of the system.
+     *
+     *  @param calls_per_second The limit, or 0 for none
+     */
+    void rate_limit(uint32_t calls_per_second);
+
+    /** Get the number of edges dropped by the debounce and rate limits
+     */
+    uint32_t suppressed() const {
+        return _suppressed;
+    }
+
+    /** An edge recorded in capture mode
+     */
+    struct edge_t {
+        timestamp_t timestamp;  /**< us_ticker_read() on entry to the interrupt */
+        gpio_irq_event edge;    /**< IRQ_RISE or IRQ_FALL */
+    };
+
+    /** Capture mode callback
+     *  @param const edge_t* The oldest of the edges captured
+     *  @param uint32_t The number of consecutive edges
+     */
+    typedef mbed::util::FunctionPointer2<void, const edge_t*, uint32_t> capture_callback_t;
+
+    /** Record edges in a ring instead of calling the rise and fall handlers
+     *
+     * The interrupt only timestamps each edge and stores it in the ring, with
+     * no locking. One callback is then scheduled for however many edges have
+     * been stored; it is passed the edges in batches, and the ring space is
+     * reused once it returns. Edges that arrive while the ring is full are
+     * counted and dropped.
+     *
+     *  @param buffer The ring, which must stay valid until stop_capture()
+     *  @param size The number of elements in buffer, a power of two
+     *  @param callback Called from the scheduler with the captured edges
+     *  @param edges The edges to capture: IRQ_RISE, IRQ_FALL, or IRQ_NONE for both
+     *
+     *  @returns
+     *    0 on success, -1 if size is not a power of two
+     */
+    int capture(edge_t *buffer, uint32_t size, const capture_callback_t& callback, gpio_irq_event edges = IRQ_NONE);
+
+    /** Stop capturing edges, and go back to the rise and fall handlers
+     */
+    void stop_capture();
+
+    /** Get the number of edges dropped because the capture ring was full
+     */
+    uint32_t capture_overflows() const {
+        return _capture_overflows;
+    }
+
+#if DEVICE_INTERRUPTIN_PORT_BATCH
+    /** Batched port callback
+     *  @param uint32_t The port's input register, read on entry to the interrupt
+     *  @param uint32_t The mask of the pins whose edges interrupted
+     */
+    typedef mbed::util::FunctionPointer2<void, uint32_t, uint32_t> port_callback_t;
+
+    /** Take the edges of the InterruptIns on a port in one callback
+     *
+     * Normally each pin that interrupts is dispatched on its own, and a
+     * handler that reads the other pins sees them as they are by the time
+     * it runs. Once a port is attached, the port's interrupt reads its
+     * whole input register once, on entry, clears every pending pin, and
+     * makes one call with that value and the mask of the pins that
+     * interrupted. The InterruptIns on the port still choose which edges
+     * interrupt, but their own handlers, filters and capture are not run.
+     *
+     *  @param port The port
+     *  @param callback Called in the interrupt handler
+     *
+     *  @returns
+     *    0 on success, -1 if INTERRUPTIN_BATCH_PORTS are attached or the
+     *    port's interrupt cannot be batched
+     */
+    static int attach_port(PortName port, const port_callback_t &callback);
+
+    /** Go back to dispatching each pin of a port on its own
+     *
+     *  @param port The port
+     */
+    static void detach_port(PortName port);
+
+    static void _port_irq_handler(uint32_t id, uint32_t value, uint32_t changed);
+#endif
+
     static void _irq_handler(uint32_t id, gpio_irq_event event);
 
 protected:
+    enum {
+        EDGE_RISE = 1,
+        EDGE_FALL = 2
+    };
+
+    void capture_drain();
+    void filter_edge(gpio_irq_event event);
+    void filter_release();
+    void set_edges(uint8_t edges);
+    void enable_edge(uint8_t edge);
+    void disable_edge(uint8_t edge);
+
     gpio_t gpio;
     gpio_irq_t gpio_irq;
 
-    mbed::util::FunctionPointer _rise;
-    mbed::util::FunctionPointer _fall;
+    StaticCallChain<INTERRUPTIN_HANDLERS> _rise;
+    StaticCallChain<INTERRUPTIN_HANDLERS> _fall;
+    uint8_t _edges;                         // EDGE_* flags of the attached handlers
+
+    timestamp_t _debounce_us;
+    uint32_t _rate_limit;
+    timestamp_t _rate_window_start;
+    uint32_t _rate_count;
+    volatile bool _filter_masked;           // both edges masked until _filter_timeout
+    int _filter_level;                      // the level after the last reported edge
+    volatile uint32_t _suppressed;
+    Timeout _filter_timeout;
+
+    edge_t *_capture_buffer;                // NULL unless capturing
+    uint32_t _capture_mask;
+    volatile uint32_t _capture_head;        // written by the interrupt only
+    volatile uint32_t _capture_tail;        // written by the scheduler only
+    volatile bool _capture_posted;
+    volatile uint32_t _capture_overflows;
+    capture_callback_t _capture_callback;
 };
 
 } // namespace mbed
@@ -18,8 +18,35 @@
 
 #include "cmsis.h"
 #include "CallChain.h"
+#include "StaticCallChain.h"
+#include "mbed_critical.h"
+#if INTERRUPT_MANAGER_STATS
+#include "CycleTimer.h"
+#endif
 #include <string.h>
 
+/* When INTERRUPT_MANAGER_STATIC_CHAINS is set, the interrupt manager never
+ * uses the heap: the manager itself is statically allocated, and chained
+ * interrupts take their chains from a pool of that many StaticCallChains,
+ * each holding up to INTERRUPT_MANAGER_CHAIN_SIZE handlers (including the
+ * vector that was installed before the first handler was added).
+ */
+#ifndef INTERRUPT_MANAGER_STATIC_CHAINS
+#define INTERRUPT_MANAGER_STATIC_CHAINS 0
+#endif
+
+#ifndef INTERRUPT_MANAGER_CHAIN_SIZE
+#define INTERRUPT_MANAGER_CHAIN_SIZE 4
+#endif
+
+/* When INTERRUPT_MANAGER_STATS is set, the interrupt manager times each
+ * handler it calls with CycleTimer, and keeps per-vector statistics that
+ * get_stats() reads.
+ */
+#ifndef INTERRUPT_MANAGER_STATS
+#define INTERRUPT_MANAGER_STATS 0
+#endif
+
 namespace mbed {
 
 /** Use this singleton if you need to chain interrupt handlers.
@@ -64,7 +91,8 @@ public:
      *  @param irq interrupt number
      *
      *  @returns
-     *  The function object created for 'function'
+     *  The function object created for 'function', or NULL if there was no
+     *  room for it
      */
     pFunctionPointer_t add_handler(void (*function)(void), IRQn_Type irq) {
         return add_common(function, irq);
@@ -76,7 +104,8 @@ public:
      *  @param irq interrupt number
      *
      *  @returns
-     *  The function object created for 'function'
+     *  The function object created for 'function', or NULL if there was no
+     *  room for it
      */
     pFunctionPointer_t add_handler_front(void (*function)(void), IRQn_Type irq) {
         return add_common(function, irq, true);
@@ -89,7 +118,8 @@ public:
      *  @param irq interrupt number
      *
      *  @returns
-     *  The function object created for 'tptr' and 'mptr'
+     *  The function object created for 'tptr' and 'mptr', or NULL if there
+     *  was no room for it
      */
     template<typename T>
     pFunctionPointer_t add_handler(T* tptr, void (T::*mptr)(void), IRQn_Type irq) {
@@ -103,13 +133,29 @@ public:
      *  @param irq interrupt number
      *
      *  @returns
-     *  The function object created for 'tptr' and 'mptr'
+     *  The function object created for 'tptr' and 'mptr', or NULL if there
+     *  was no room for it
      */
     template<typename T>
     pFunctionPointer_t add_handler_front(T* tptr, void (T::*mptr)(void), IRQn_Type irq) {
         return add_common(tptr, mptr, irq, true);
     }
 
+    /** Install a handler directly in the vector table, replacing the vector
+     *
+     * The handler is called with no chain in between, as a bare interrupt
+     * handler would be. Handlers added later with add_handler() are chained
+     * after it, as they would be after any other installed vector.
+     *
+     *  @param function the handler to install
+     *  @param irq interrupt number
+     *
+     *  @returns
+     *  true if the handler was installed, false if the interrupt already has
+     *  a chain of handlers
+     */
+    bool set_handler(void (*function)(void), IRQn_Type irq);
+
     /** Remove a handler from an interrupt
      *
      *  @param handler the function object for the handler to remove
@@ -120,7 +166,91 @@ public:
      */
     bool remove_handler(pFunctionPointer_t handler, IRQn_Type irq);
 
+    /** Get the number of priority levels the core implements
+     */
+    static uint32_t priority_levels() {
+        return 1UL << __NVIC_PRIO_BITS;
+    }
+
+    /** Set the priority of an interrupt
+     *
+     *  @param irq interrupt number
+     *  @param priority the priority, counting from 0 for the most urgent;
+     *    values past the last level the core implements are set to the
+     *    last level
+     */
+    static void set_priority(IRQn_Type irq, uint32_t priority) {
+        if (priority >= priority_levels())
+            priority = priority_levels() - 1;
+        NVIC_SetPriority(irq, priority);
+    }
+
+    /** Get the priority of an interrupt
+     *
+     *  @param irq interrupt number
+     *
+     *  @returns
+     *  The priority, counting from 0 for the most urgent
+     */
+    static uint32_t get_priority(IRQn_Type irq) {
+        return NVIC_GetPriority(irq);
+    }
+
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3)
+    /** Set how priorities split into preempting groups and subpriorities
+     *
+     * Interrupts only preempt each other across groups; within a group,
+     * the subpriority orders the pending interrupts. The priorities taken
+     * and returned by set_priority() and get_priority() cover both.
+     *
+     *  @param grouping the priority grouping, as the PRIGROUP field of
+     *    SCB->AIRCR, from 0 for no subpriority bits
+     */
+    static void set_priority_grouping(uint32_t grouping) {
+        NVIC_SetPriorityGrouping(grouping);
+    }
+
+    /** Get the priority grouping
+     */
+    static uint32_t get_priority_grouping() {
+        return NVIC_GetPriorityGrouping();
+    }
+#endif
+
+#if INTERRUPT_MANAGER_STATS
+    /** Statistics for an interrupt, in CycleTimer ticks
+     *
+     * Only interrupts whose handlers were added with the interrupt manager
+     * are measured. Time spent in higher priority interrupts that preempt
+     * the handlers is included.
+     */
+    struct irq_stats_t {
+        uint32_t count;         /**< The number of times the interrupt was handled */
+        uint64_t ticks;         /**< The total time in its handlers */
+        uint32_t worst;         /**< The longest time for one interrupt */
+        uint32_t worst_handler_ticks;   /**< The longest time for one handler */
+        int worst_handler;      /**< The position in the chain of that handler */
+    };
+
+    /** Get the statistics for an interrupt
+     *
+     *  @param irq interrupt number
+     *  @param stats Set to a consistent copy of the statistics
+     */
+    static void get_stats(IRQn_Type irq, irq_stats_t *stats);
+
+    /** Reset the statistics for every interrupt
+     */
+    static void reset_stats();
+#endif
+
 private:
+#if INTERRUPT_MANAGER_STATIC_CHAINS
+    typedef StaticCallChain<INTERRUPT_MANAGER_CHAIN_SIZE> chain_t;
+#else
+    typedef CallChain chain_t;
+#endif
+
     InterruptManager();
     ~InterruptManager();
 
@@ -135,6 +265,8 @@ private:
         int irq_pos = get_irq_index(irq);
         bool change = must_replace_vector(irq);
 
+        if (NULL == _chains[irq_pos])
+            return NULL;
         pFunctionPointer_t pf = front ? _chains[irq_pos]->add_front(tptr, mptr) : _chains[irq_pos]->add(tptr, mptr);
         if (change)
             NVIC_SetVector(irq, (uint32_t)&InterruptManager::static_irq_helper);
@@ -143,13 +275,24 @@ private:
 
     pFunctionPointer_t add_common(void (*function)(void), IRQn_Type irq, bool front=false);
     bool must_replace_vector(IRQn_Type irq);
+    chain_t* new_chain();
+    void delete_chain(chain_t *chain);
+    void delete_chains();
     int get_irq_index(IRQn_Type irq);
     void irq_helper();
     void add_helper(void (*function)(void), IRQn_Type irq, bool front=false);
     static void static_irq_helper();
+#if INTERRUPT_MANAGER_STATS
+    static void call_chain(chain_t *chain, uint32_t vector);
+    static irq_stats_t _stats[NVIC_NUM_VECTORS];
+#endif
 
-    CallChain* _chains[NVIC_NUM_VECTORS];
+    chain_t* _chains[NVIC_NUM_VECTORS];
     static InterruptManager* _instance;
+#if INTERRUPT_MANAGER_STATIC_CHAINS
+    static InterruptManager _static_instance;
+    static chain_t _pool[INTERRUPT_MANAGER_STATIC_CHAINS];
+#endif
 };
 
 } // namespace mbed
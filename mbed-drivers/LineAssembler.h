@@ -0,0 +1,122 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_LINEASSEMBLER_H
+#define MBED_LINEASSEMBLER_H
+
+#include "platform.h"
+#include "Buffer.h"
+#include "core-util/FunctionPointer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mbed {
+
+/** Splits received data into lines, a chunk at a time
+ *
+ * Data is fed in whatever chunks it was received in, from the slices that
+ * SerialBase::read_circular() reports, or from BufferedSerial::read(), and
+ * each complete line is passed to the callback. Lines end with CR, LF or
+ * CR LF. The terminators are searched for over the whole chunk in a plain
+ * loop, instead of through getc() and the stdio layers once per byte.
+ *
+ * A line that lies within one chunk is passed to the callback in place,
+ * without being copied. Only a line split between chunks is gathered in
+ * the assembler's buffer. Either way, the line is not NUL terminated, and
+ * is only valid during the callback.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * Serial pc(USBTX, USBRX);
+ * char rx[128];
+ * char line[80];
+ *
+ * void command(const char *text, size_t length) {
+ *     // ...
+ * }
+ *
+ * LineAssembler console(line, sizeof(line), command);
+ *
+ * void app_start(int, char **) {
+ *     pc.read_circular(Buffer(rx, sizeof(rx)), console.callback());
+ * }
+ * @endcode
+ */
+class LineAssembler {
+public:
+    /** Line callback, called with the line, without its terminator, and
+     *  its length
+     */
+    typedef mbed::util::FunctionPointer2<void, const char *, size_t> line_callback_t;
+
+    /** Serial read callback, as SerialBase's
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, int> event_callback_t;
+
+    /** Create a line assembler
+     *
+     *  @param buffer Storage for lines split between chunks
+     *  @param size The size of buffer, which is also the longest line
+     *  @param callback The function to call with each line
+     */
+    LineAssembler(char *buffer, size_t size, const line_callback_t &callback);
+
+    /** Add received data
+     *
+     *  The callback is called, before this returns, for each line the data
+     *  completes.
+     *
+     *  @param data The data
+     *  @param length The number of bytes
+     */
+    void feed(const char *data, size_t length);
+
+    /** Get a callback that feeds the data of each serial read event
+     */
+    event_callback_t callback() {
+        return event_callback_t(this, &LineAssembler::on_read);
+    }
+
+    /** Drop the partial line gathered so far
+     */
+    void reset();
+
+    /** Get the number of lines dropped because they were longer than the
+     *  buffer
+     */
+    uint32_t overflows() const {
+        return _overflows;
+    }
+
+protected:
+    void on_read(Buffer buffer, int event);
+
+    /** Add part of a line to the buffer */
+    void append(const char *data, size_t length);
+
+    char *_buffer;
+    size_t _size;
+    size_t _length;             // the bytes of the partial line in _buffer
+    line_callback_t _callback;
+    uint32_t _overflows;
+    bool _discarding;           // the partial line is too long, and is dropped
+    bool _skip_lf;              // the last chunk ended with a CR
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,48 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_LOWPOWERTIMEOUT_H
+#define MBED_LOWPOWERTIMEOUT_H
+
+#include "platform.h"
+#include "Timeout.h"
+
+#if DEVICE_LOWPOWERTIMER
+
+#include "lp_ticker_api.h"
+
+namespace mbed {
+
+/** A Timeout driven by the low power ticker
+ *
+ * The low power ticker keeps running in deep sleep, so long-period events
+ * can be serviced while the high speed timer is powered down. Its
+ * resolution depends on the target, typically around 30 microseconds.
+ */
+class LowPowerTimeout : public Timeout {
+
+public:
+    LowPowerTimeout() : Timeout(get_lp_ticker_data()) {
+    }
+
+    virtual ~LowPowerTimeout() {
+    }
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
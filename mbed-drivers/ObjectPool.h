@@ -0,0 +1,138 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_OBJECTPOOL_H
+#define MBED_OBJECTPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include "core-util/CriticalSectionLock.h"
+
+namespace mbed {
+
+/** A fixed-size pool of objects with constant time allocation and release
+ *
+ * The objects are stored inline, and free slots are kept on a list, so
+ * alloc() and free() never touch the heap and never search. Both take a
+ * short critical section, so they can be called from interrupt handlers.
+ *
+ * Example:
+ * @code
+ * ObjectPool<transfer_t, 4> pool;
+ *
+ * transfer_t *t = pool.alloc();
+ * if (t != NULL) {
+ *     // ...
+ *     pool.free(t);
+ * }
+ * @endcode
+ */
+template<typename T, uint32_t N>
+class ObjectPool {
+public:
+    ObjectPool() : _free(&_slots[0]), _available(N) {
+        for (uint32_t i = 0; i < N - 1; i++) {
+            _slots[i].next = &_slots[i + 1];
+        }
+        _slots[N - 1].next = NULL;
+    }
+
+    /** Allocate a default constructed object
+     *
+     * @returns The object, or NULL if the pool is empty
+     */
+    T *alloc() {
+        void *p = take();
+        return p ? new (p) T() : NULL;
+    }
+
+    /** Allocate a copy of an object
+     *
+     * @param value The object to copy
+     * @returns The object, or NULL if the pool is empty
+     */
+    T *alloc(const T &value) {
+        void *p = take();
+        return p ? new (p) T(value) : NULL;
+    }
+
+    /** Destroy an object and return it to the pool
+     *
+     * @param object An object allocated from this pool, or NULL
+     */
+    void free(T *object) {
+        if (object == NULL) {
+            return;
+        }
+        object->~T();
+        slot_t *slot = reinterpret_cast<slot_t *>(object);
+        mbed::util::CriticalSectionLock lock;
+        slot->next = _free;
+        _free = slot;
+        _available++;
+    }
+
+    /** Check if an object was allocated from this pool
+     */
+    bool owns(const T *object) const {
+        const slot_t *slot = reinterpret_cast<const slot_t *>(object);
+        return slot >= &_slots[0] && slot < &_slots[N];
+    }
+
+    /** Get the number of free slots
+     */
+    uint32_t available() const {
+        return _available;
+    }
+
+    /** Get the number of slots
+     */
+    uint32_t capacity() const {
+        return N;
+    }
+
+private:
+    union slot_t {
+        slot_t *next;
+        char storage[sizeof(T)];
+        // for the alignment of any T
+        uint64_t align_u64;
+        double align_double;
+        void *align_pointer;
+    };
+
+    void *take() {
+        mbed::util::CriticalSectionLock lock;
+        slot_t *slot = _free;
+        if (slot != NULL) {
+            _free = slot->next;
+            _available--;
+        }
+        return slot;
+    }
+
+    slot_t _slots[N];
+    slot_t *_free;
+    volatile uint32_t _available;
+
+    /* disallow copy constructor and assignment operators */
+    ObjectPool(const ObjectPool&);
+    ObjectPool & operator = (const ObjectPool&);
+};
+
+} // namespace mbed
+
+#endif
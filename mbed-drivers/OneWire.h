@@ -0,0 +1,138 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_ONEWIRE_H
+#define MBED_ONEWIRE_H
+
+#include "platform.h"
+#include "DigitalInOut.h"
+#include "Timeout.h"
+#include "Buffer.h"
+#include "CompletionQueue.h"
+#include "core-util/FunctionPointer.h"
+
+/** The transfer completed, and a device answered the reset pulse */
+#define ONEWIRE_EVENT_COMPLETE    (1 << 0)
+/** No device answered the reset pulse, so nothing was transferred */
+#define ONEWIRE_EVENT_NO_PRESENCE (1 << 1)
+
+namespace mbed {
+
+/** A 1-Wire master, bit-banged on a GPIO with timing from the us ticker
+ *
+ * A transfer is a reset pulse, then bytes written, then bytes read, least
+ * significant bit first. The long parts of the protocol (the reset pulse,
+ * the presence wait, the low time of a 0 and the rest of each slot) are
+ * waited for with a Timeout, so the CPU is free for most of each bit. Only
+ * the short low pulse that starts a 1 or a read, and the wait until the
+ * read is sampled, spin, with interrupts masked for about 15us at most.
+ *
+ * The pin needs the usual external pull-up, and is driven open drain.
+ *
+ * Example:
+ * @code
+ * // Start a DS18B20 temperature conversion, then read the scratchpad
+ * #include "mbed.h"
+ *
+ * OneWire bus(p21);
+ * char convert[] = {0xCC, 0x44};   // skip ROM, convert T
+ * char read[] = {0xCC, 0xBE};      // skip ROM, read scratchpad
+ * char scratchpad[9];
+ *
+ * void read_done(Buffer rx, int event) {
+ *     if (event & ONEWIRE_EVENT_COMPLETE) {
+ *         int16_t raw = scratchpad[0] | (scratchpad[1] << 8);
+ *         printf("%d.%04d C\r\n", raw >> 4, (raw & 0xF) * 625);
+ *     }
+ * }
+ *
+ * void converted(void) {
+ *     bus.transfer(Buffer(read, 2), Buffer(scratchpad, 9), read_done);
+ * }
+ *
+ * void convert_done(Buffer rx, int event) {
+ *     minar::Scheduler::postCallback(converted).delay(minar::milliseconds(750));
+ * }
+ *
+ * void app_start(int, char **) {
+ *     bus.transfer(Buffer(convert, 2), Buffer(), convert_done);
+ * }
+ * @endcode
+ */
+class OneWire {
+
+public:
+    /** Transfer callback, called with the receive buffer and
+     *  ONEWIRE_EVENT_COMPLETE or ONEWIRE_EVENT_NO_PRESENCE
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, int> event_callback_t;
+
+    /** Create a 1-Wire master on the specified pin
+     *
+     *  @param pin The data pin
+     */
+    OneWire(PinName pin);
+
+    /** Start a transfer
+     *
+     *  @param tx The bytes to write
+     *  @param rx The buffer to read into, after the bytes are written
+     *  @param callback The function to call, in main context, when the
+     *    transfer ends
+     *  @param reset Start with a reset pulse, and check for a presence pulse
+     *  @returns 0 if the transfer started, or -1 if one is in progress
+     */
+    int transfer(const Buffer &tx, const Buffer &rx, const event_callback_t &callback, bool reset = true);
+
+    /** Check if a transfer is in progress
+     */
+    bool busy() const {
+        return _state != STATE_IDLE;
+    }
+
+    /** Stop the transfer in progress, without calling its callback
+     */
+    void abort();
+
+protected:
+    enum State {
+        STATE_IDLE,
+        STATE_RESET,        /**< The line is held low for the reset pulse */
+        STATE_PRESENCE,     /**< Waiting to sample the presence pulse */
+        STATE_WRITE_ZERO,   /**< The line is held low to write a 0 */
+        STATE_SLOT          /**< Waiting for the next slot */
+    };
+
+    /** Move to the next state, from the Timeout */
+    void step();
+
+    /** Start the next bit slot, or finish the transfer */
+    void start_slot();
+
+    void finish(int event);
+
+    DigitalInOut _pin;
+    Timeout _timeout;
+    Buffer _tx;
+    Buffer _rx;
+    event_callback_t _callback;
+    CompletionQueue::Slot _completion;
+    uint32_t _bit;                  /**< The next bit to transfer, counting the written bits first */
+    volatile State _state;
+};
+
+} // namespace mbed
+
+#endif
@@ -21,6 +21,12 @@
 #if DEVICE_PORTIN
 
 #include "port_api.h"
+#include "mbed_hal_inline.h"
+
+#if DEVICE_PORTIN_IRQ
+#include "port_irq_api.h"
+#include "core-util/FunctionPointer.h"
+#endif
 
 namespace mbed {
 
@@ -46,9 +52,31 @@ namespace mbed {
  *     }
  * }
  * @endcode
+ *
+ * On targets with port interrupts, change() attaches one function to be
+ * called when any of a set of pins changes, with the port's old and new
+ * values, instead of one InterruptIn per pin:
+ * @code
+ * PortIn keys(Port1, 0x0F);
+ *
+ * void keys_changed(int old_value, int new_value) {
+ *     int pressed = old_value & ~new_value;   // active low
+ *     // ...
+ * }
+ *
+ * void app_start(int, char **) {
+ *     keys.mode(PullUp);
+ *     keys.change(keys_changed);
+ * }
+ * @endcode
  */
 class PortIn {
 public:
+#if DEVICE_PORTIN_IRQ
+    /** Change callback, called with the old and new values of the port
+     */
+    typedef mbed::util::FunctionPointer2<void, int, int> change_callback_t;
+#endif
 
     /** Create an PortIn, connected to the specified port
      *
@@ -57,15 +85,40 @@ public:
         */
     PortIn(PortName port, int mask = 0xFFFFFFFF) {
         port_init(&_port, port, mask, PIN_INPUT);
+#if DEVICE_PORTIN_IRQ
+        port_irq_init(&_port_irq, &_port, &PortIn::_irq_handler, (uint32_t)this);
+        _last = 0;
+        _irq_mask = 0;
+#endif
+    }
+
+#if DEVICE_PORTIN_IRQ
+    ~PortIn() {
+        port_irq_free(&_port_irq);
     }
 
+    /** Attach a function to call when any of the given pins changes
+     *
+     *  The function is called in the interrupt handler, with the value of
+     *  the port before and after the change. Changes faster than the
+     *  interrupt latency can be seen as one change, or as none at all if
+     *  the pins change back.
+     *
+     *  @param callback The function to call, or an empty callback to detach
+     *  @param mask The bits of the port whose changes interrupt
+     */
+    void change(const change_callback_t &callback, int mask = 0xFFFFFFFF);
+
+    static void _irq_handler(uint32_t id);
+#endif
+
     /** Read the value currently output on the port
      *
      *  @returns
      *    An integer with each bit corresponding to associated port pin setting
      */
     int read() {
-        return port_read(&_port);
+        return mbed_port_read(&_port);
     }
 
     /** Set the input pin mode
@@ -84,6 +137,12 @@ public:
 
 private:
     port_t _port;
+#if DEVICE_PORTIN_IRQ
+    port_irq_t _port_irq;
+    change_callback_t _change;
+    volatile int _last;         // the value passed as new to the last callback
+    int _irq_mask;              // the bits whose changes interrupt
+#endif
 };
 
 } // namespace mbed
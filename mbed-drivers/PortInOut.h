@@ -21,6 +21,7 @@
 #if DEVICE_PORTINOUT
 
 #include "port_api.h"
+#include "mbed_hal_inline.h"
 
 namespace mbed {
 
@@ -43,7 +44,44 @@ public:
      *  @param value An integer specifying a bit to write for every corresponding port pin
      */
     void write(int value) {
-        port_write(&_port, value);
+        mbed_port_write(&_port, value);
+    }
+
+    /** Set the given bits of the port to 1, leaving the others unchanged
+     *
+     *  @param bits The bits to set
+     */
+    void set_bits(int bits) {
+        port_set_bits(&_port, bits);
+    }
+
+    /** Set the given bits of the port to 0, leaving the others unchanged
+     *
+     *  @param bits The bits to clear
+     */
+    void clear_bits(int bits) {
+        port_clear_bits(&_port, bits);
+    }
+
+    /** Invert the given bits of the port, leaving the others unchanged
+     *
+     *  @param bits The bits to invert
+     */
+    void toggle_bits(int bits) {
+        port_toggle_bits(&_port, bits);
+    }
+
+    /** Write the given bits of the port, leaving the others unchanged
+     *
+     *  The bits are set and cleared with one atomic access, so this is
+     *  safe against interrupt handlers writing other bits of the port, and
+     *  the bits change together.
+     *
+     *  @param value The value to write
+     *  @param mask The bits of value to write
+     */
+    void write_masked(int value, int mask) {
+        port_set_clear_bits(&_port, value & mask, ~value & mask);
     }
 
     /** Read the value currently output on the port
@@ -52,7 +90,7 @@ public:
      *    An integer with each bit corresponding to associated port pin setting
      */
     int read() {
-        return port_read(&_port);
+        return mbed_port_read(&_port);
     }
 
     /** Set as an output
@@ -61,6 +99,18 @@ public:
         port_dir(&_port, PIN_OUTPUT);
     }
 
+    /** Set the value to output, then set as an output
+     *
+     *  The pins drive the new value as soon as they turn around, instead
+     *  of whatever was last written.
+     *
+     *  @param value An integer specifying a bit to write for every corresponding port pin
+     */
+    void output(int value) {
+        mbed_port_write(&_port, value);
+        port_dir(&_port, PIN_OUTPUT);
+    }
+
     /** Set as an input
      */
     void input() {
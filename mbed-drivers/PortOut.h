@@ -21,6 +21,7 @@
 #if DEVICE_PORTOUT
 
 #include "port_api.h"
+#include "mbed_hal_inline.h"
 
 namespace mbed {
 /** A multiple pin digital out
@@ -63,7 +64,31 @@ public:
      *  @param value An integer specifying a bit to write for every corresponding PortOut pin
      */
     void write(int value) {
-        port_write(&_port, value);
+        mbed_port_write(&_port, value);
+    }
+
+    /** Set the given bits of the port to 1, leaving the others unchanged
+     *
+     *  @param bits The bits to set
+     */
+    void set_bits(int bits) {
+        port_set_bits(&_port, bits);
+    }
+
+    /** Set the given bits of the port to 0, leaving the others unchanged
+     *
+     *  @param bits The bits to clear
+     */
+    void clear_bits(int bits) {
+        port_clear_bits(&_port, bits);
+    }
+
+    /** Invert the given bits of the port, leaving the others unchanged
+     *
+     *  @param bits The bits to invert
+     */
+    void toggle_bits(int bits) {
+        port_toggle_bits(&_port, bits);
     }
 
     /** Read the value currently output on the port
@@ -72,7 +97,7 @@ public:
      *    An integer with each bit corresponding to associated PortOut pin setting
      */
     int read() {
-        return port_read(&_port);
+        return mbed_port_read(&_port);
     }
 
     /** A shorthand for write()
@@ -0,0 +1,134 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_PWMIN_H
+#define MBED_PWMIN_H
+
+#include "platform.h"
+
+#if DEVICE_PWMIN
+
+#include "pwmin_api.h"
+#include "us_ticker_api.h"
+#include "mbed_hal_inline.h"
+
+namespace mbed {
+
+/** A pulse-width measuring input, using a timer's capture channels
+ *
+ * The timer latches the time of each edge in hardware, so the readings have
+ * no interrupt latency in them and cost no CPU time per edge. The edge times
+ * are kept in the microsecond ticker's time base, so they can be compared
+ * with us_ticker_read() and Timer readings.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * PwmIn servo(D2);
+ *
+ * int main() {
+ *     printf("%d us every %d us\r\n", servo.pulsewidth_us(), servo.period_us());
+ * }
+ * @endcode
+ */
+class PwmIn {
+
+public:
+
+    /** Create a PwmIn connected to the specified pin
+     *
+     *  @param pin PwmIn pin to connect to, which must be a timer capture input
+     */
+    PwmIn(PinName pin) {
+        pwmin_init(&_pwm, pin);
+    }
+
+    ~PwmIn() {
+        pwmin_free(&_pwm);
+    }
+
+    /** Get the period of the last complete cycle, in micro-seconds
+     *
+     *  @returns The time between the last two rising edges, or 0 before there have been two
+     */
+    int period_us() {
+        pwmin_cycle_t cycle;
+        return pwmin_read(&_pwm, &cycle) == 0 ? (int)cycle.period : 0;
+    }
+
+    /** Get the pulse width of the last complete cycle, in micro-seconds
+     *
+     *  @returns The time the input was high in the last complete cycle, or 0 before there has been one
+     */
+    int pulsewidth_us() {
+        pwmin_cycle_t cycle;
+        return pwmin_read(&_pwm, &cycle) == 0 ? (int)cycle.high : 0;
+    }
+
+    /** Get the duty cycle of the last complete cycle, represented as an unsigned short in the range [0x0, 0xFFFF]
+     *
+     *  The period and pulse width come from the same cycle.
+     */
+    unsigned short read_u16() {
+        pwmin_cycle_t cycle;
+        if (pwmin_read(&_pwm, &cycle) != 0 || cycle.period == 0) {
+            return 0;
+        }
+        return (unsigned short)(((uint64_t)cycle.high * 0xFFFF + cycle.period / 2) / cycle.period);
+    }
+
+    /** Get the duty cycle of the last complete cycle, measured as a percentage (float)
+     *
+     *  @returns A value between 0.0f (off) and 1.0f (on)
+     */
+    float read() {
+        return read_u16() / 65535.0f;
+    }
+
+    /** Check that the input is still toggling
+     *
+     *  The readings hold the last complete cycle after the input stops, so
+     *  use this to spot a signal that has gone away.
+     *
+     *  @param timeout_us How long after the start of the last complete cycle
+     *    it may be before the input is treated as stopped
+     *  @returns true if a cycle started within timeout_us before now
+     */
+    bool active(timestamp_t timeout_us) {
+        pwmin_cycle_t cycle;
+        if (pwmin_read(&_pwm, &cycle) != 0) {
+            return false;
+        }
+        return (timestamp_t)(mbed_us_ticker_read() - cycle.start) <= timeout_us;
+    }
+
+#ifdef MBED_OPERATORS
+    /** An operator shorthand for read()
+     */
+    operator float() {
+        return read();
+    }
+#endif
+
+protected:
+    pwmin_t _pwm;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
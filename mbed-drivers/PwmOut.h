@@ -21,6 +21,13 @@
 #if DEVICE_PWMOUT
 #include "pwmout_api.h"
 
+#if DEVICE_PWMOUT_ASYNCH
+#include "CThunk.h"
+#include "dma_api.h"
+#include "core-util/FunctionPointer.h"
+#include "Buffer.h"
+#endif
+
 namespace mbed {
 
 /** A pulse-width modulation digital output
@@ -53,12 +60,23 @@ namespace mbed {
 class PwmOut {
 
 public:
+#if DEVICE_PWMOUT_ASYNCH
+    /** Sequence callback
+     *  @param Buffer The sequence that has been output
+     *  @param int The events that occurred
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, int> event_callback_t;
+#endif
 
     /** Create a PwmOut connected to the specified pin
      *
      *  @param pin PwmOut pin to connect to
      */
-    PwmOut(PinName pin) {
+    PwmOut(PinName pin)
+#if DEVICE_PWMOUT_ASYNCH
+        : _irq(this), _usage(DMA_USAGE_NEVER)
+#endif
+    {
         pwmout_init(&_pwm, pin);
     }
 
@@ -73,6 +91,26 @@ public:
         pwmout_write(&_pwm, value);
     }
 
+    /** Set the output duty-cycle, represented as an unsigned short in the range [0x0, 0xFFFF]
+     *
+     *  Unlike write(), this does not use floating point on the way to the HAL.
+     *
+     *  @param value 16-bit unsigned short representing the output duty-cycle,
+     *    from 0x0000 (on 0%) to 0xFFFF (on 100%)
+     */
+    void write_u16(unsigned short value) {
+        pwmout_write_u16(&_pwm, value);
+    }
+
+    /** Return the current output duty-cycle setting, represented as an unsigned short in the range [0x0, 0xFFFF]
+     *
+     *  @note
+     *  This value may not match exactly the value set by a previous <write_u16>.
+     */
+    unsigned short read_u16() {
+        return pwmout_read_u16(&_pwm);
+    }
+
     /** Return the current output duty-cycle setting, measured as a percentage (float)
      *
      *  @returns
@@ -127,6 +165,74 @@ public:
         pwmout_pulsewidth_us(&_pwm, us);
     }
 
+#if DEVICE_PWMOUT_ASYNCH
+    /** Get the compare value for a duty cycle, for use in a sequence
+     *
+     *  The value depends on the current period, so sequences should be built
+     *  after the period is set.
+     *
+     *  @param value The duty cycle, from 0x0000 (on 0%) to 0xFFFF (on 100%)
+     *  @returns The timer compare value that outputs that duty cycle
+     */
+    uint16_t compare_u16(unsigned short value) {
+        return pwmout_compare_u16(&_pwm, value);
+    }
+
+    /** Output a sequence of duty cycles, one per period
+     *
+     *  The buffer holds one 16-bit compare value per period, from
+     *  compare_u16(), and DMA loads each into the timer at the period
+     *  boundary, so the sequence runs with no CPU involvement. In circular
+     *  mode it repeats until abort_sequence(). Afterwards the output keeps
+     *  the last duty cycle of the sequence.
+     *
+     *  @param buffer The compare values, a multiple of two bytes long
+     *  @param callback The event callback function
+     *  @param event The logical OR of PWMOUT events to report
+     *  @param circular Repeat the sequence until stopped
+     *  @return Zero if the sequence has started, or -1 if one is already running
+     */
+    int write_sequence(const Buffer &buffer, const event_callback_t &callback,
+            int event = PWMOUT_EVENT_COMPLETE, bool circular = false);
+
+    /** Stop a sequence immediately
+     */
+    void abort_sequence();
+
+    /** Configure DMA usage suggestion for sequences
+     *
+     *  @param usage The usage DMA hint for peripheral
+     *  @return Zero if the usage was set, -1 if a sequence is running
+     */
+    int set_dma_usage(DMAUsage usage);
+#endif
+
+#if DEVICE_SUSPEND
+    /** Stop the timer's clock, to save power while the output is not needed
+     *
+     *  The HAL keeps the period and duty cycle, so resume() needs no pinmap
+     *  lookups and no reconfiguration. The output holds its level while
+     *  suspended.
+     *
+     *  @returns 0 on success, or -1 if a sequence is running
+     */
+    int suspend() {
+#if DEVICE_PWMOUT_ASYNCH
+        if (pwmout_active(&_pwm)) {
+            return -1;
+        }
+#endif
+        pwmout_suspend(&_pwm);
+        return 0;
+    }
+
+    /** Restart the timer's clock after suspend()
+     */
+    void resume() {
+        pwmout_resume(&_pwm);
+    }
+#endif
+
 #ifdef MBED_OPERATORS
     /** A operator shorthand for write()
      */
@@ -148,7 +254,22 @@ public:
 #endif
 
 protected:
+    friend class PwmOutGroup;
+    friend class TriggerLink;
+
+#if DEVICE_PWMOUT_ASYNCH
+    /** PWM IRQ handler
+     */
+    void irq_handler_asynch(void);
+#endif
+
     pwmout_t _pwm;
+#if DEVICE_PWMOUT_ASYNCH
+    CThunk<PwmOut> _irq;
+    Buffer _buffer;
+    event_callback_t _callback;
+    DMAUsage _usage;
+#endif
 };
 
 } // namespace mbed
@@ -0,0 +1,176 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_PWMOUTGROUP_H
+#define MBED_PWMOUTGROUP_H
+
+#include "platform.h"
+
+#if DEVICE_PWMOUT_GROUP
+
+#include "PwmOut.h"
+#include "pwmout_api.h"
+
+/* The most channels in one PwmOutGroup */
+#ifndef PWMOUT_GROUP_MAX_CHANNELS
+#define PWMOUT_GROUP_MAX_CHANNELS 4
+#endif
+
+namespace mbed {
+
+/** PwmOut channels that share a timer, updated together
+ *
+ * New pulse widths are staged in the timer's shadow registers, and commit()
+ * releases them all at the next period boundary, so no period is output
+ * with some channels updated and others not. The channels must be driven by
+ * the same timer, and keep the period set through any of them.
+ *
+ * On targets with DEVICE_PWMOUT_PHASE, each channel's pulse can also be
+ * offset within the period, and the timer can count up and down so the
+ * pulses are centred rather than starting together. Interleaving the
+ * phases of a multiphase converter spreads the switching edges over the
+ * period, which reduces the input ripple. Phases and alignment are staged
+ * and committed in the same way as pulse widths; the timer keeps them
+ * without the CPU.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * PwmOut u(D3), v(D5), w(D6);
+ * PwmOut *const phases[] = {&u, &v, &w};
+ * PwmOutGroup bridge(phases, 3);
+ *
+ * void set_phases(int a, int b, int c) {
+ *     bridge.pulsewidth_us(0, a);
+ *     bridge.pulsewidth_us(1, b);
+ *     bridge.pulsewidth_us(2, c);
+ *     bridge.commit();
+ * }
+ * @endcode
+ *
+ * Example, for a three phase buck converter:
+ * @code
+ * #include "mbed.h"
+ *
+ * PwmOut a(D3), b(D5), c(D6);
+ * PwmOut *const legs[] = {&a, &b, &c};
+ * PwmOutGroup buck(legs, 3);
+ *
+ * void app_start(int, char**) {
+ *     a.period_us(4);
+ *     buck.alignment(PwmOutGroup::AlignCenter);
+ *     buck.interleave();
+ *     for (size_t i = 0; i < 3; i++) {
+ *         buck.write_u16(i, 0x4000);
+ *     }
+ *     buck.commit();
+ * }
+ * @endcode
+ */
+class PwmOutGroup {
+
+public:
+#if DEVICE_PWMOUT_PHASE
+    /** Where the pulses sit in the period
+     */
+    enum Alignment {
+        AlignEdge = PWMOUT_ALIGN_EDGE,      /**< Each pulse starts at its phase */
+        AlignCenter = PWMOUT_ALIGN_CENTER   /**< Each pulse is centred on its phase plus half a period */
+    };
+#endif
+
+    /** Create a group of PwmOuts
+     *
+     *  @param channels The PwmOuts, which must outlive the group
+     *  @param count The number of channels, up to PWMOUT_GROUP_MAX_CHANNELS
+     */
+    PwmOutGroup(PwmOut *const *channels, size_t count);
+
+    /** Stage a pulse width for one channel, in micro-seconds
+     *
+     *  @param index The channel, in the order given to the constructor
+     *  @param us The pulse width
+     */
+    void pulsewidth_us(size_t index, int us);
+
+    /** Stage a duty cycle for one channel, as for PwmOut::write_u16()
+     *
+     *  @param index The channel, in the order given to the constructor
+     *  @param value The duty cycle, from 0x0000 (on 0%) to 0xFFFF (on 100%)
+     */
+    void write_u16(size_t index, unsigned short value);
+
+#if DEVICE_PWMOUT_PHASE
+    /** Stage the alignment of every channel
+     *
+     *  The period stays as set: for centre alignment, the timer counts up
+     *  and down at twice the rate.
+     *
+     *  @param alignment The alignment
+     *
+     *  @returns
+     *    0 on success, -1 if the timer cannot count that way
+     */
+    int alignment(Alignment alignment);
+
+    /** Stage the phase of one channel, in micro-seconds
+     *
+     *  @param index The channel, in the order given to the constructor
+     *  @param us The delay of the channel's pulse from the start of the period
+     *
+     *  @returns
+     *    0 on success, -1 if the channel cannot be offset
+     */
+    int phase_us(size_t index, int us);
+
+    /** Stage the phase of one channel, as a fraction of the period
+     *
+     *  @param index The channel, in the order given to the constructor
+     *  @param value The delay, from 0x0000 (none) to 0xFFFF (just under a period)
+     *
+     *  @returns
+     *    0 on success, -1 if the channel cannot be offset
+     */
+    int phase_u16(size_t index, unsigned short value);
+
+    /** Stage phases spread evenly over the period, in channel order
+     *
+     *  Channel i is delayed by i / count of the period.
+     *
+     *  @returns
+     *    0 on success, -1 if a channel cannot be offset
+     */
+    int interleave();
+#endif
+
+    /** Release the staged values to every channel at the next period boundary
+     */
+    void commit();
+
+protected:
+    void stage();
+
+    pwmout_group_t _group;
+    pwmout_t *_channels[PWMOUT_GROUP_MAX_CHANNELS];
+    size_t _count;
+    bool _staging;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -0,0 +1,149 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_QEI_H
+#define MBED_QEI_H
+
+#include "platform.h"
+
+#if DEVICE_QEI || DEVICE_INTERRUPTIN
+
+#if DEVICE_QEI
+#include "qei_api.h"
+#endif
+#if DEVICE_INTERRUPTIN
+#include "gpio_api.h"
+#include "gpio_irq_api.h"
+#endif
+#include "us_ticker_api.h"
+
+namespace mbed {
+
+/** A quadrature encoder input, counting every edge of both channels
+ *
+ * Where the HAL can put the pins on a timer's quadrature decoder, the
+ * timer counts in hardware, at no CPU cost per edge. Otherwise both pins
+ * interrupt on every edge, and the HAL's GPIO interrupt handler calls a
+ * state table lookup directly, without the function pointer dispatch of
+ * InterruptIn, to keep the per-edge cost as low as it can be.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * QEI wheel(p29, p30, p28);
+ *
+ * void report(void) {
+ *     printf("%ld counts, %ld counts/s\r\n", wheel.count(), wheel.velocity());
+ * }
+ *
+ * void app_start(int, char **) {
+ *     minar::Scheduler::postCallback(report).period(minar::milliseconds(100));
+ * }
+ * @endcode
+ */
+class QEI {
+
+public:
+    /** Create a QEI connected to the specified pins
+     *
+     *  The count goes up when channel A leads channel B.
+     *
+     *  @param a Channel A
+     *  @param b Channel B
+     *  @param index The index channel, or NC
+     */
+    QEI(PinName a, PinName b, PinName index = NC);
+    virtual ~QEI();
+
+    /** Get the count, of four per encoder cycle
+     */
+    int32_t count();
+
+    /** Set the count
+     *
+     *  @param value The new count
+     */
+    void reset(int32_t value = 0);
+
+    /** Get the velocity over the time since the last call
+     *
+     *  @returns The change in count since the last call, in counts per
+     *    second, or 0 on the first call
+     */
+    int32_t velocity();
+
+    /** Get the number of index pulses
+     */
+    uint32_t index_count();
+
+    /** Get the count at the last index pulse
+     */
+    int32_t index_position();
+
+    /** Get the number of transitions where both channels changed at once
+     *
+     *  Each one is a count lost because edges came faster than the
+     *  interrupt handler. It is always 0 when counting in hardware.
+     */
+    uint32_t errors() const {
+        return _errors;
+    }
+
+    /** Check if the encoder is counted by a hardware quadrature decoder
+     */
+    bool hardware() const {
+        return _hardware;
+    }
+
+#if DEVICE_INTERRUPTIN
+    static void _irq_handler(uint32_t id, gpio_irq_event event);
+    static void _index_handler(uint32_t id, gpio_irq_event event);
+#endif
+
+protected:
+#if DEVICE_QEI
+    qei_t _qei;
+#endif
+#if DEVICE_INTERRUPTIN
+    gpio_t _a;
+    gpio_t _b;
+    gpio_t _index;
+    gpio_irq_t _a_irq;
+    gpio_irq_t _b_irq;
+    gpio_irq_t _index_irq;
+    volatile int32_t _count;
+    volatile int32_t _index_position;
+    volatile uint32_t _index_count;
+    uint8_t _state;             // channel A in bit 1, channel B in bit 0
+    bool _has_index;
+#endif
+    volatile uint32_t _errors;
+    bool _hardware;
+    int32_t _velocity_count;    // the count at the last velocity() call
+    timestamp_t _velocity_time; // the time of the last velocity() call
+    bool _velocity_valid;
+
+    /* disallow copy constructor and assignment operators */
+private:
+    QEI(const QEI&);
+    QEI & operator = (const QEI&);
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -0,0 +1,274 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_QSPI_H
+#define MBED_QSPI_H
+
+#include "platform.h"
+
+#if DEVICE_QSPI
+
+#include "qspi_api.h"
+
+#if DEVICE_QSPI_ASYNCH
+#include "CThunk.h"
+#include "dma_api.h"
+#include "core-util/FunctionPointer.h"
+#include "Buffer.h"
+#include "CompletionQueue.h"
+#include "mbed_sleep.h"
+#include "DMAManager.h"
+#endif
+
+namespace mbed {
+
+/** A quad (or dual) SPI master, used for external flash and RAM
+ *
+ * Each transfer is a command: an instruction, an address, some dummy
+ * cycles and a data phase, each of which can be left out, and each of
+ * which is sent on one, two or four lines. The commands themselves are
+ * those of the memory, as given in its datasheet.
+ *
+ * While the memory is mapped with map(), the peripheral issues a read
+ * command for each access, so data can be read, and code run, in place.
+ * Transfers fail until unmap() is called.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * QSPI flash(QSPI_IO0, QSPI_IO1, QSPI_IO2, QSPI_IO3, QSPI_SCK, QSPI_CS);
+ * char page[256];
+ *
+ * void read_done(Buffer tx, Buffer rx, int event) {
+ *     // ...
+ * }
+ *
+ * void app_start(int, char **) {
+ *     // Fast Read Quad I/O: 4 line address, 6 dummy cycles, 4 line data
+ *     flash.transfer()
+ *         .instruction(0xEB)
+ *         .address(0x1000, 3, QSPI_WIDTH_4)
+ *         .dummy(6)
+ *         .rx(page, sizeof(page), QSPI_WIDTH_4)
+ *         .callback(read_done, QSPI_EVENT_COMPLETE);
+ * }
+ * @endcode
+ */
+class QSPI {
+
+public:
+    /** Create a QSPI master connected to the specified pins
+     *
+     *  io2 and io3 can be specified as NC for a dual SPI memory
+     *
+     *  @param io0 Data line 0 (MOSI in single line commands)
+     *  @param io1 Data line 1 (MISO in single line commands)
+     *  @param io2 Data line 2
+     *  @param io3 Data line 3
+     *  @param sclk Clock pin
+     *  @param ssel Chip select pin
+     */
+    QSPI(PinName io0, PinName io1, PinName io2, PinName io3, PinName sclk, PinName ssel);
+
+    /** Set the clock mode
+     *
+     *  @param mode Clock polarity and phase mode, 0 or 3
+     */
+    void format(int mode);
+
+    /** Set the bus clock frequency
+     *
+     *  @param hz The clock frequency in hertz (default = 1MHz)
+     */
+    void frequency(int hz = 1000000);
+
+    /** Write a command and its data, blocking until it has been sent
+     *
+     *  @param command The command phases
+     *  @param data The data to send, or NULL
+     *  @param length The number of bytes of data
+     *  @returns 0 on success, or -1 if the memory is mapped or a transfer
+     *    is in progress
+     */
+    int write(const qspi_command_t &command, const char *data, int length);
+
+    /** Write a command and read its data, blocking until it has all arrived
+     *
+     *  @param command The command phases
+     *  @param data The buffer to read into
+     *  @param length The number of bytes to read
+     *  @returns 0 on success, or -1 if the memory is mapped or a transfer
+     *    is in progress
+     */
+    int read(const qspi_command_t &command, char *data, int length);
+
+    /** Map the memory into the address space
+     *
+     *  @param read_command The command the peripheral issues for each read,
+     *    whose address is filled in for each access
+     *  @returns The address the memory is mapped at, or NULL if the
+     *    peripheral can't map memory or a transfer is in progress
+     */
+    const void *map(const qspi_command_t &read_command);
+
+    /** Unmap the memory, so transfers can be made again
+     */
+    void unmap();
+
+    /** Check if the memory is mapped
+     */
+    bool mapped() const {
+        return _mapped != NULL;
+    }
+
+#if DEVICE_QSPI_ASYNCH
+    /** QSPI transfer callback
+     *  @param Buffer the tx buffer
+     *  @param Buffer the rx buffer
+     *  @param int the event that triggered the calback
+     */
+    typedef mbed::util::FunctionPointer3<void, Buffer, Buffer, int> event_callback_t;
+
+protected:
+    /** A transfer over the QSPI bus
+     */
+    struct transaction_data_t {
+        qspi_command_t command;     /**< The instruction, address, dummy and data phases */
+        Buffer tx_buffer;           /**< The data to send, if any */
+        Buffer rx_buffer;           /**< The buffer to receive into, if any */
+        uint32_t event;             /**< Event for a transaction */
+        event_callback_t callback;  /**< User's callback */
+    };
+
+public:
+    class QSPITransferAdder {
+        friend QSPI;
+    private:
+        QSPITransferAdder(QSPI *owner);
+        const QSPITransferAdder & operator =(const QSPITransferAdder &a);
+        QSPITransferAdder(const QSPITransferAdder &a);
+    public:
+        /** Set the instruction phase
+         *  Without this, the command has no instruction phase.
+         *
+         *  @param[in] value The instruction
+         *  @param[in] width The number of lines to send it on
+         *  @return a reference to the QSPITransferAdder
+         */
+        QSPITransferAdder & instruction(uint8_t value, qspi_width_t width = QSPI_WIDTH_1);
+        /** Set the address phase
+         *  Without this, the command has no address phase.
+         *
+         *  @param[in] value The address
+         *  @param[in] size The length of the address in bytes, 1 to 4
+         *  @param[in] width The number of lines to send it on
+         *  @return a reference to the QSPITransferAdder
+         */
+        QSPITransferAdder & address(uint32_t value, uint8_t size = 3, qspi_width_t width = QSPI_WIDTH_1);
+        /** Set the number of dummy cycles between the address and the data
+         *
+         *  @param[in] cycles The number of clock cycles
+         *  @return a reference to the QSPITransferAdder
+         */
+        QSPITransferAdder & dummy(uint8_t cycles);
+        /** Set the data to send
+         *  A command either sends or receives data, not both.
+         *
+         *  @param[in] txBuf a pointer to the transmit buffer
+         *  @param[in] txSize the size of the transmit buffer
+         *  @param[in] width The number of lines to send it on
+         *  @return a reference to the QSPITransferAdder
+         */
+        QSPITransferAdder & tx(const void *txBuf, size_t txSize, qspi_width_t width = QSPI_WIDTH_1);
+        /** Set the buffer to receive data into
+         *  A command either sends or receives data, not both.
+         *
+         *  @param[in] rxBuf a pointer to the receive buffer
+         *  @param[in] rxSize the size of the receive buffer
+         *  @param[in] width The number of lines to receive it on
+         *  @return a reference to the QSPITransferAdder
+         */
+        QSPITransferAdder & rx(void *rxBuf, size_t rxSize, qspi_width_t width = QSPI_WIDTH_1);
+        /** Set the QSPI Event callback
+         *  Sets the callback to invoke when an event occurs and the mask of
+         *  which events should trigger it. The callback will be scheduled to
+         *  execute in main context, not invoked in interrupt context.
+         *
+         *  @param[in] cb The event callback function
+         *  @param[in] event The logical OR of QSPI events to report
+         *  @return a reference to the QSPITransferAdder
+         */
+        QSPITransferAdder & callback(const event_callback_t &cb, int event);
+        /** Initiate the transfer
+         *  apply() allows the user to explicitly activate the transfer and obtain
+         *  the return code from the validation of the transfer parameters.
+         * @return Zero if the transfer has started, or -1 if the QSPI
+         *   peripheral is busy or the memory is mapped
+         */
+        int apply();
+        ~QSPITransferAdder();
+    private:
+        transaction_data_t _td;
+        bool _applied;
+        int _rc;
+        QSPI * _owner;
+    };
+
+    /** Start a QSPI transfer
+     *  The transfer() method returns a QSPITransferAdder, which sets each
+     *  phase of the command with a dedicated method, as SPI::transfer()
+     *  does. The transfer starts when the adder goes out of scope, or when
+     *  apply() is called. The data is moved by DMA if set_dma_usage() allows.
+     *
+     * @return A QSPITransferAdder for this transfer
+     */
+    QSPITransferAdder transfer();
+
+    /** Abort the transfer in progress
+     */
+    void abort_transfer();
+
+    /** Configure DMA usage suggestion for non-blocking transfers
+     *
+     *  @param usage The usage DMA hint for peripheral
+     *  @return Zero if the usage was set, -1 if a transfer is in progress
+     */
+    int set_dma_usage(DMAUsage usage);
+
+protected:
+    int transfer(const QSPITransferAdder &td);
+
+    void irq_handler_asynch(void);
+
+    transaction_data_t _current_transaction;
+    CompletionQueue::Slot _completion;  /**< Where the current transfer's completion is posted */
+    DeepSleepLock _deep_sleep;          /**< Held while an asynchronous transfer runs */
+    CThunk<QSPI> _irq;
+    DMAChannel _dma;
+#endif
+
+protected:
+    bool busy();
+
+    qspi_t _qspi;
+    const void *_mapped;    /**< Where the memory is mapped, or NULL if it isn't */
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
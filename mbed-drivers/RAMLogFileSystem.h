@@ -0,0 +1,116 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_RAMLOGFILESYSTEM_H
+#define MBED_RAMLOGFILESYSTEM_H
+
+#include "FileSystemLike.h"
+
+namespace mbed {
+
+/** A file system that keeps a log in a ring of RAM
+ *
+ * Every file opened in the file system appends to the same ring, so writes
+ * never touch flash and cost a copy into RAM. When the ring is full, the
+ * oldest bytes are overwritten. Reading from a file, or calling drain(),
+ * takes the oldest bytes out of the ring, for example to upload them or
+ * copy them to persistent storage. remove() of any name empties the ring.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ * #include "mbed-drivers/RAMLogFileSystem.h"
+ *
+ * static char log_ring[4096];
+ * RAMLogFileSystem log("log", log_ring, sizeof(log_ring));
+ *
+ * void app_start(int, char**) {
+ *     FILE *f = fopen("/log/app", "w");
+ *     fprintf(f, "started\r\n");
+ *     fflush(f);
+ * }
+ * @endcode
+ */
+class RAMLogFileSystem : public FileSystemLike {
+
+public:
+    /** Create a log file system
+     *
+     *  @param name The name used as the root of the file system's paths
+     *  @param buffer The ring, which must outlive the file system
+     *  @param size The size of the ring, in bytes
+     */
+    RAMLogFileSystem(const char *name, void *buffer, size_t size);
+
+    virtual FileHandle *open(const char *filename, int flags);
+    virtual int remove(const char *filename);
+
+    /** Append to the log, overwriting the oldest bytes if it is full
+     *
+     *  @param data The bytes to append
+     *  @param length The number of bytes
+     */
+    void append(const void *data, size_t length);
+
+    /** Take the oldest bytes out of the log
+     *
+     *  @param data The buffer to copy them to
+     *  @param length The size of the buffer
+     *
+     *  @returns The number of bytes taken
+     */
+    size_t drain(void *data, size_t length);
+
+    /** Get the oldest bytes of the log, without copying them
+     *
+     *  The bytes stay in the log until release() is called, but may be
+     *  overwritten by later appends, so drain from the same context as the
+     *  writes or hold the writers off until release().
+     *
+     *  @param length Set to the number of contiguous bytes available
+     *
+     *  @returns A pointer to the oldest byte, or NULL if the log is empty
+     */
+    const void *peek(size_t *length);
+
+    /** Drop the oldest bytes of the log, for example after peek()
+     *
+     *  @param length The number of bytes to drop
+     */
+    void release(size_t length);
+
+    /** Get the number of bytes in the log
+     */
+    size_t size() const {
+        return _used;
+    }
+
+    /** Get the number of bytes overwritten before they were drained
+     */
+    uint32_t overwritten() const {
+        return _overwritten;
+    }
+
+protected:
+    char *_buffer;
+    size_t _size;
+    size_t _tail;           // the oldest byte
+    size_t _used;
+    uint32_t _overwritten;
+};
+
+} // namespace mbed
+
+#endif
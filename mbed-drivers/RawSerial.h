@@ -22,6 +22,7 @@
 
 #include "SerialBase.h"
 #include "serial_api.h"
+#include <cstdarg>
 
 namespace mbed {
 
@@ -80,7 +81,27 @@ public:
      */
     int puts(const char *str);
 
+    /** Write formatted output to the serial port
+     *
+     * The output is formatted in a single pass, one conversion at a time,
+     * straight to the serial port: no buffer is needed for the whole
+     * string and the heap is never used. A single conversion producing
+     * more than 120 characters, other than a string, is truncated.
+     *
+     * @param format The printf style format string
+     *
+     * @returns The number of characters written
+     */
     int printf(const char *format, ...);
+
+    /** Write formatted output to the serial port, taking a va_list
+     *
+     * @param format The printf style format string
+     * @param arg The arguments for format
+     *
+     * @returns The number of characters written
+     */
+    int vprintf(const char *format, std::va_list arg);
 };
 
 } // namespace mbed
@@ -0,0 +1,103 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_RTCALARM_H
+#define MBED_RTCALARM_H
+
+#include "platform.h"
+
+#if DEVICE_RTC
+
+#include <time.h>
+#include "TimerEvent.h"
+#include "core-util/FunctionPointer.h"
+
+namespace mbed {
+
+/** A function called at a time of day, which may be hours or days away
+ *
+ * The alarm is a timer event on the low power ticker, where the target has
+ * one, queued at a 64-bit time, so it can be any distance away. With
+ * DEVICE_RTC_ALARM, the timer events that far away wait on the RTC alarm
+ * until they are a few seconds off, so neither ticker wakes the core on the
+ * way and the system can deep sleep for the whole wait. Without it, the
+ * ticker is stepped towards them. Timer events on the us ticker that are
+ * far away wait on the RTC alarm too.
+ *
+ * The time is the RTC's, as time() and set_time(); an alarm waiting on the
+ * RTC alarm may be up to a second late. Setting the time does not move an
+ * alarm that is set. The function is called from the ticker interrupt.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * RtcAlarm alarm;
+ *
+ * void wake_up() {
+ *     // ...
+ * }
+ *
+ * void app_start(int, char**) {
+ *     alarm.attach(&wake_up, time(NULL) + 6 * 60 * 60);
+ * }
+ * @endcode
+ */
+class RtcAlarm : public TimerEvent {
+
+public:
+    RtcAlarm();
+
+    virtual ~RtcAlarm();
+
+    /** Attach a function to be called at a time
+     *
+     *  @param fptr pointer to the function to be called
+     *  @param when the time, in seconds since January 1, 1970; a time that
+     *    has passed calls the function at once
+     */
+    void attach(void (*fptr)(void), time_t when) {
+        _function.attach(fptr);
+        schedule(when);
+    }
+
+    /** Attach a member function to be called at a time
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *  @param when the time, in seconds since January 1, 1970
+     */
+    template<typename T>
+    void attach(T* tptr, void (T::*mptr)(void), time_t when) {
+        _function.attach(tptr, mptr);
+        schedule(when);
+    }
+
+    /** Detach the function
+     */
+    void detach();
+
+protected:
+    void schedule(time_t when);
+    virtual void handler();
+
+    mbed::util::FunctionPointer _function;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
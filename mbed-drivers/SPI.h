@@ -25,13 +25,61 @@
 #if DEVICE_SPI_ASYNCH
 #include "CThunk.h"
 #include "dma_api.h"
-#include "CircularBuffer.h"
 #include "core-util/FunctionPointer.h"
 #include "Transaction.h"
+#include "CompletionQueue.h"
+#include "mbed_sleep.h"
+#include "DMAManager.h"
+#include "DriverStats.h"
+#endif
+
+/* Each SPI object queues up to TRANSACTION_QUEUE_SIZE_SPI transfers of its
+ * own, in storage inside the object. An SPI object can be given a queue of
+ * another size, in storage of the application's, with
+ * set_transaction_queue(), or be made a QueuedSPI<N>; with the default of 0,
+ * only those objects queue. Setting TRANSACTION_POOL_SIZE_SPI instead takes
+ * the queued transfers of all SPI objects from one shared pool of that many
+ * entries.
+ */
+#ifndef TRANSACTION_QUEUE_SIZE_SPI
+#define TRANSACTION_QUEUE_SIZE_SPI 0
+#endif
+
+#ifndef TRANSACTION_POOL_SIZE_SPI
+#define TRANSACTION_POOL_SIZE_SPI 0
+#endif
+
+/* Add to the events passed to SPITransferAdder::callback() to have the
+ * callback invoked directly from the interrupt handler, rather than scheduled
+ * to run in main context. */
+#define SPI_EVENT_FLAG_IRQ_CONTEXT (1 << 24)
+
+/* Reported to the callback of a transfer that was aborted or cancelled
+ * before it completed, whatever events it asked for. */
+#define SPI_EVENT_CANCELLED (1 << 25)
+
+/* The number of buffer segments a transfer can have in each direction */
+#ifndef SPI_TRANSFER_SEGMENTS
+#define SPI_TRANSFER_SEGMENTS 2
+#endif
+
+/* On HALs without DEVICE_SPI_ASYNCH_FILL, the bytes in each SPI object that
+ * SPITransferAdder::tx_fill() frames are sent from, in transfers of up to
+ * this size */
+#ifndef SPI_FILL_CHUNK
+#define SPI_FILL_CHUNK 16
+#endif
+
+/* The number of physical SPI peripherals whose configuration is tracked, on
+ * ports with DEVICE_SPI_INSTANCE */
+#ifndef SPI_PERIPHERAL_COUNT
+#define SPI_PERIPHERAL_COUNT 4
 #endif
 
 namespace mbed {
 
+class SPIDevice;
+
 /** A SPI Master, used for communicating with SPI slave devices
  *
  * The default format is set to 8-bits, mode 0, and a clock frequency of 1MHz
@@ -41,6 +89,8 @@ namespace mbed {
  * can be controlled using <DigitalOut> pins
  */
 class SPI {
+    friend class SPIDevice;
+    friend class TriggerLink;
 
 #if DEVICE_SPI_ASYNCH
 public:
@@ -50,9 +100,35 @@ public:
      *  @param int the event that triggered the calback
      */
     typedef mbed::util::FunctionPointer3<void, Buffer, Buffer, int> event_callback_t;
+
+    /** SPI completion handler
+     *  @param int the logical OR of the events since the handler last ran
+     */
+    typedef mbed::util::FunctionPointer1<void, int> completion_handler_t;
 private:
-    typedef TwoWayTransaction<event_callback_t> transaction_data_t;
+    /** A transfer of one or more buffer segments in each direction
+     *
+     *  The segments in each direction form one continuous stream of frames.
+     *  A transmit segment with no buffer sends fill frames, and a receive
+     *  segment with no buffer discards what it receives.
+     */
+    struct transaction_data_t {
+        Buffer tx_buffer[SPI_TRANSFER_SEGMENTS];   /**< Transmit segments */
+        Buffer rx_buffer[SPI_TRANSFER_SEGMENTS];   /**< Receive segments */
+        uint8_t tx_count;                          /**< Number of transmit segments */
+        uint8_t rx_count;                          /**< Number of receive segments */
+        uint32_t event;                            /**< Events for the transaction */
+        event_callback_t callback;                 /**< User's callback */
+        SPIDevice *device;                         /**< The device to select for the transfer, if any */
+        uint8_t priority;                          /**< Queued transfers of higher priority start first */
+        uint32_t fill;                             /**< The frame sent by transmit segments with no buffer */
+        uint8_t width;                             /**< The element width in bits, or 0 for the frame width */
+    };
     typedef Transaction<SPI, transaction_data_t> transaction_t;
+public:
+    /** The storage of one queued transfer, for set_transaction_queue()
+     */
+    typedef transaction_data_t queue_slot_t;
 #endif
 public:
     /** Create a SPI master connected to the specified pins
@@ -91,6 +167,26 @@ public:
      */
     void frequency(int hz = 1000000);
 
+#if DEVICE_SUSPEND
+    /** Stop the peripheral's clock, to save power between bursts
+     *
+     *  The peripheral is shared by every SPI object on it, so suspend it
+     *  only when none of them is using it.
+     *
+     *  The HAL keeps the peripheral's configuration, so resume() needs no
+     *  pinmap lookups and no reconfiguration. The SPI must not be used
+     *  until it is resumed.
+     *
+     *  @returns 0 on success, or -1 if an asynchronous transfer is in
+     *    progress
+     */
+    int suspend();
+
+    /** Restart the peripheral's clock after suspend()
+     */
+    void resume();
+#endif
+
     /** Write to the SPI Slave and return the response
      *
      *  @param value Data to be sent to the SPI slave
@@ -100,46 +196,118 @@ public:
     */
     virtual int write(int value);
 
+    /** Write a block to the SPI Slave, and read the response
+     *
+     *  Frames are exchanged back to back. When tx_length and rx_length
+     *  differ, fill frames are sent past the end of tx_buffer, and responses
+     *  past the end of rx_buffer are dropped.
+     *
+     *  @param tx_buffer Data to be sent to the SPI slave
+     *  @param tx_length Number of frames to send
+     *  @param rx_buffer Buffer for the response from the SPI slave
+     *  @param rx_length Number of frames to receive
+     *
+     *  @returns
+     *    The number of frames exchanged: the larger of tx_length and rx_length
+    */
+    virtual int write(const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length);
+
 #if DEVICE_SPI_ASYNCH
     class SPITransferAdder {
         friend SPI;
+        friend SPIDevice;
     private:
-        SPITransferAdder(SPI *owner);
+        SPITransferAdder(SPI *owner, SPIDevice *device = NULL);
         const SPITransferAdder & operator =(const SPITransferAdder &a);
         SPITransferAdder(const SPITransferAdder &a);
     public:
-        /** Set the transmit buffer
-         *  Sets the transmit buffer pointer and transmit size.
+        /** Add a transmit buffer
+         *  Appends a segment to the transmit buffer. The segments are sent
+         *  back to back in a single transfer, so a command header and its
+         *  payload can be sent without copying them together.
          *
-         *  NOTE: Repeated calls to tx() override buffer parameters.
+         *  NOTE: Up to SPI_TRANSFER_SEGMENTS segments can be added.
          *
          *  @param[in] txBuf a pointer to the transmit buffer
          *  @param[in] txSize the size of the transmit buffer
          *  @return a reference to the SPITransferAdder
      */
         SPITransferAdder & tx(void *txBuf, size_t txSize);
-        /** Set the receive buffer
-         *  Sets the receive buffer pointer and receive size
+        /** Add a receive buffer
+         *  Appends a segment to the receive buffer. Received frames fill the
+         *  segments in order.
      *
-         *  NOTE: Repeated calls to rx() override buffer parameters.
+         *  NOTE: Up to SPI_TRANSFER_SEGMENTS segments can be added.
          *
          *  @param[in] rxBuf a pointer to the receive buffer
          *  @param[in] rxSize the size of the receive buffer
          *  @return a reference to the SPITransferAdder
      */
         SPITransferAdder & rx(void *rxBuf, size_t rxSize);
+        /** Add a transmit segment of frames that all hold one value
+         *  Reading from a device then needs no buffer of dummy bytes. The
+         *  transfer has one fill value, which the last call sets.
+         *
+         *  NOTE: This takes one of the SPI_TRANSFER_SEGMENTS transmit segments.
+         *
+         *  @param[in] txSize the size of the segment, in bytes
+         *  @param[in] value the frame to send
+         *  @return a reference to the SPITransferAdder
+         */
+        SPITransferAdder & tx_fill(size_t txSize, uint32_t value = 0xFF);
+        /** Add a receive segment whose frames are discarded
+         *  Writing to a device then needs no buffer to receive into.
+         *
+         *  NOTE: This takes one of the SPI_TRANSFER_SEGMENTS receive segments.
+         *
+         *  @param[in] rxSize the size of the segment, in bytes
+         *  @return a reference to the SPITransferAdder
+         */
+        SPITransferAdder & rx_discard(size_t rxSize);
+        /** Set the width of the elements the buffers are moved in
+         *  Buffer sizes are always in bytes. By default the elements are
+         *  the frames: a byte for frames of up to 8 bits, and a 16-bit
+         *  element, in the processor's byte order, for wider frames. A
+         *  32-bit width has the DMA move whole words, each holding two
+         *  16-bit or four 8-bit frames, lowest address first, which halves
+         *  or quarters the DMA beats of a long transfer.
+         *
+         *  On HALs without DEVICE_SPI_ASYNCH_WIDTH, the transfer is made
+         *  in frame-width elements, which puts the same frames on the bus.
+         *
+         *  @param[in] bits 8, 16 or 32; every segment must be a whole
+         *      number of elements, and the buffers aligned to them
+         *  @return a reference to the SPITransferAdder
+         */
+        SPITransferAdder & width(uint8_t bits);
         /** Set the SPI Event callback
          *  Sets the callback to invoke when an event occurs and the mask of
          *  which events should trigger it. The callback will be scheduled to
-         *  execute in main context, not invoked in interrupt context.
+         *  execute in main context, not invoked in interrupt context, unless
+         *  SPI_EVENT_FLAG_IRQ_CONTEXT is included in event. Then it's called
+         *  from the interrupt handler, where it can queue the next transfer
+         *  without waiting for the scheduler. It is passed the first transmit
+         *  and receive segments.
      *
          *  NOTE: Repeated calls to callback() override callback parameters.
+         *  A transfer with no callback reports SPI_EVENT_COMPLETE to the
+         *  handler set by set_completion_handler(), if any.
          *
          *  @param[in] cb The event callback function
          *  @param[in] event     The logical OR of SPI events to modify. Look at spi hal header file for SPI events.
          *  @return a reference to the SPITransferAdder
          */
         SPITransferAdder & callback(const event_callback_t &cb, int event);
+        /** Set the transfer's priority
+         *  When the bus is busy, the transfer is queued ahead of every queued
+         *  transfer of lower priority, and behind those of the same or
+         *  higher priority. The transfer in progress is never preempted.
+         *  Transfers have priority 0 unless this is called.
+         *
+         *  @param[in] level The priority, higher being more urgent
+         *  @return a reference to the SPITransferAdder
+         */
+        SPITransferAdder & priority(uint8_t level);
         /** Initiate the transfer
          *  apply() allows the user to explicitly activate the transfer and obtain
          *  the return code from the validation of the transfer parameters.
@@ -165,17 +333,118 @@ public:
     SPITransferAdder transfer();
 
     /** Abort the on-going SPI transfer, and continue with transfer's in the queue if any.
+     *
+     *  The aborted transfer's callback is scheduled with SPI_EVENT_CANCELLED.
+     *  The next queued transfer is started from the scheduler rather than
+     *  from the caller, so aborting takes the same short time whatever is
+     *  queued; transfers started meanwhile are queued behind it.
      */
     void abort_transfer();
 
+    /** Abort the on-going SPI transfer if it is with a device
+     *
+     *  As abort_transfer(), but only if the transfer was started for the
+     *  device, so one device's error recovery never aborts another's.
+     *
+     *  @param device The device, or NULL for transfers started without one
+     *  @return true if a transfer was aborted
+     */
+    bool abort_transfer(SPIDevice *device);
+
+    /** Cancel the queued transfers with a device
+     *
+     *  Each one's callback is scheduled with SPI_EVENT_CANCELLED, in queue
+     *  order. Other devices' transfers stay queued in their order.
+     *
+     *  @param device The device, or NULL for transfers started without one
+     *  @return The number of transfers cancelled
+     */
+    int cancel_transfers(SPIDevice *device);
+
+    /** Abort the on-going transfer and cancel the queued ones, for a device only
+     *
+     *  @param device The device, or NULL for transfers started without one
+     *  @return The number of transfers aborted or cancelled
+     */
+    int flush(SPIDevice *device);
+
     /** Clear the transaction buffer
      */
     void clear_transfer_buffer();
 
+#if !TRANSACTION_POOL_SIZE_SPI
+    /** Queue this SPI's transfers in the given storage
+     *
+     *  Queue depth is set per bus, to match how deep each one's pipeline
+     *  of transfers is, rather than by TRANSACTION_QUEUE_SIZE_SPI for all.
+     *
+     *  @param storage The slots, which must outlive the SPI object or the
+     *    next call, or NULL for no queue
+     *  @param size The number of slots
+     *  @return 0 on success, or -1 if transfers are queued
+     */
+    int set_transaction_queue(queue_slot_t *storage, uint16_t size);
+#endif
+
     /** Clear the transaction buffer and abort on-going transfer.
      */
     void abort_all_transfers();
 
+    /** Start a continuous, double-buffered transfer
+     *
+     *  The two halves are transferred alternately, the next half being
+     *  started from the interrupt handler as soon as the previous one
+     *  completes, until stop_stream() is called. The callback is invoked with
+     *  the buffers of each half as it completes; the application has until
+     *  the other half completes to refill or consume it. Set
+     *  SPI_EVENT_FLAG_IRQ_CONTEXT in event to be called from the interrupt
+     *  handler rather than from main context. Other transfers are queued
+     *  until the stream stops.
+     *
+     *  @param tx0 The first half's transmit buffer (zero length to send fill frames)
+     *  @param rx0 The first half's receive buffer (zero length to drop received frames)
+     *  @param tx1 The second half's transmit buffer
+     *  @param rx1 The second half's receive buffer
+     *  @param callback The event callback function
+     *  @param event The logical OR of SPI events to report
+     *  @return Zero if the stream has started, or -1 if the SPI peripheral is busy
+     */
+    int start_stream(const Buffer &tx0, const Buffer &rx0, const Buffer &tx1, const Buffer &rx1,
+            const event_callback_t &callback, int event = SPI_EVENT_COMPLETE);
+
+    /** Stop a stream once the half in progress completes
+     *
+     *  That half is reported as a normal transfer, and queued transfers
+     *  then continue.
+     */
+    void stop_stream();
+
+    /** Set the handler for the transfers started without a callback
+     *
+     *  Where a transfer's callback is bound to its buffers and event each
+     *  time it completes, the handler is bound once, here, and each
+     *  completion merely adds its events to those waiting and posts the
+     *  same preallocated event to the scheduler. Completions that arrive
+     *  before the handler runs are coalesced into one call, so the handler
+     *  is suited to drivers that track their own transfers. It always runs
+     *  from the scheduler.
+     *
+     *  @param handler The handler, or an empty one to report nothing
+     */
+    void set_completion_handler(const completion_handler_t &handler);
+
+    /** Set the priority of the transfers' completions in the scheduler
+     *
+     *  See CompletionQueue::Priority. A high priority keeps a stream of
+     *  transfers fed while other drivers' completions are waiting.
+     *
+     *  @param priority The priority, PRIORITY_NORMAL by default
+     */
+    void set_completion_priority(CompletionQueue::Priority priority) {
+        _completion.set_priority(priority);
+        _completion_signal.set_priority(priority);
+    }
+
     /** Configure DMA usage suggestion for non-blocking transfers
      *
      *  @param usage The usage DMA hint for peripheral
@@ -183,11 +452,45 @@ public:
     */
     int set_dma_usage(DMAUsage usage);
 
+#if DRIVER_STATS
+    /** Get the statistics of the asynchronous transfers
+     *
+     *  @param stats Set to a consistent copy of the statistics
+     */
+    void get_stats(driver_stats_t *stats) const {
+        _stats.get(stats);
+    }
+
+    /** Reset the statistics
+     */
+    void reset_stats() {
+        _stats.reset();
+    }
+#endif
+
 protected:
     /** SPI IRQ handler
      *
     */
     void irq_handler_asynch(void);
+#if DEVICE_SPI_ASYNCH_CONTEXT
+    static void irq_handler_context(uint32_t id);
+#endif
+
+    /** Report an event to the current transaction's callback
+     *
+     *  @param tx_buffer the transmit buffer to report
+     *  @param rx_buffer the receive buffer to report
+     *  @param event the events that occurred
+    */
+    void report_event(const Buffer &tx_buffer, const Buffer &rx_buffer, int event);
+
+    /** Add events for the completion handler and post its event
+     *
+     *  @param event the events that occurred
+    */
+    void signal_completion(int event);
+    void deliver_completion();
 
     /** Add a transfer to the queue
      * @param data Transaction data
@@ -195,12 +498,31 @@ protected:
     */
     int queue_transfer(const transaction_data_t &td);
 
+    /** Check if any transfer is waiting in the queue
+     */
+    bool transfers_queued() const {
+#if TRANSACTION_POOL_SIZE_SPI
+        return _queue_head != NULL;
+#else
+        return _queue_count != 0;
+#endif
+    }
+
     /** Configures a callback, spi peripheral and initiate a new transfer
      *
      * @param data Transaction data
     */
     void start_transfer(const transaction_data_t &td);
 
+    /** Start the next part of the current transfer
+     *
+     *  Each part runs up to the end of the current transmit or receive
+     *  segment, whichever comes first.
+     *
+     *  @return true if a part was started, false if the transfer is done
+    */
+    bool start_segment();
+
     /** Start a new transaction
      *
      *  @param data Transaction data
@@ -212,37 +534,159 @@ protected:
     */
     void dequeue_transaction();
 
+    /** Start the next queued transfer from the scheduler after an abort
+     */
+    void resume_queue();
+
+    /** Schedule a transfer's callback, or signal the completion handler, with SPI_EVENT_CANCELLED
+     */
+    void report_cancelled(const transaction_data_t &td);
+
+    /** Abort the on-going transfer, and report it cancelled
+     */
+    void abort_current();
+
     /** Initiate a transfer
      * @param xfer the SPITransferAdder object used to create the SPI transfer
      * @return the result of validating the transfer parameters
      */
     int transfer(const SPITransferAdder &xfer);
+
+    /** Start a transfer with a device on this bus
+     * @param device the device to select for the duration of the transfer
+     * @return A SPITransferAdder object
+     */
+    SPITransferAdder transfer(SPIDevice *device);
 #endif
 
+    /** Apply a configuration, if it isn't the one already applied
+     *
+     *  @param bits  Number of bits per SPI frame (4 - 16)
+     *  @param mode  Clock polarity and phase mode (0 - 3)
+     *  @param order Bit order. SPI_MSB (standard) or SPI_LSB.
+     *  @param hz    SCLK frequency in hz
+     */
+    void configure(int bits, int mode, spi_bitorder_t order, int hz);
+
 public:
-    virtual ~SPI() {
-    }
+    /** Drop the queued transfers and abort the one in progress
+     */
+    virtual ~SPI();
 
 protected:
     spi_t _spi;
 
 #if DEVICE_SPI_ASYNCH
+#if TRANSACTION_POOL_SIZE_SPI
+    struct transaction_node_t {
+        transaction_t transaction;  /**< The queued transaction, with no object if the node is free */
+        transaction_node_t *next;   /**< The next transaction in the same queue */
+    };
+    static transaction_node_t _transaction_pool[TRANSACTION_POOL_SIZE_SPI];
+    transaction_node_t *_queue_head;
+    transaction_node_t *_queue_tail;
+#else
+    /* The queue is a ring of _queue_size slots, from the oldest at _queue_first */
+    transaction_data_t &queue_slot(uint16_t index) {
+        return _queue_storage[(_queue_first + index) % _queue_size];
+    }
+
+    transaction_data_t *_queue_storage;
+    uint16_t _queue_size;
+    uint16_t _queue_first;
+    uint16_t _queue_count;
 #if TRANSACTION_QUEUE_SIZE_SPI
-    static CircularBuffer<transaction_t, TRANSACTION_QUEUE_SIZE_SPI> _transaction_buffer;
+    transaction_data_t _queue_default[TRANSACTION_QUEUE_SIZE_SPI];
+#endif
 #endif
+#if !DEVICE_SPI_ASYNCH_CONTEXT
     CThunk<SPI> _irq;
+#endif
     transaction_data_t _current_transaction;
-    DMAUsage _usage;
+    CompletionQueue::Slot _completion;  /**< Where the current transfer's completion is posted */
+    DeepSleepLock _deep_sleep;          /**< Held while an asynchronous transfer runs */
+    uint8_t _tx_segment;    /**< The transmit segment in progress */
+    uint8_t _rx_segment;    /**< The receive segment in progress */
+    int _tx_offset;         /**< How much of the transmit segment has been started */
+    int _rx_offset;         /**< How much of the receive segment has been started */
+    bool _streaming;        /**< Whether a stream is running */
+    bool _resume_pending;   /**< Whether the queue restarts from the scheduler */
+    uint8_t _stream_half;   /**< The half of the stream in progress */
+    Buffer _stream_tx[2];   /**< The stream's transmit halves */
+    Buffer _stream_rx[2];   /**< The stream's receive halves */
+    DMAChannel _dma;
+    completion_handler_t _completion_handler;
+    volatile int _completion_events;    /**< Events waiting for the completion handler */
+    CompletionQueue::Slot _completion_signal;   /**< Bound to deliver_completion() once */
+    CompletionQueue::Slot _resume_signal;       /**< Bound to resume_queue() once */
+#if !DEVICE_SPI_ASYNCH_FILL
+    char _fill[SPI_FILL_CHUNK]; /**< Fill frames, sent with the HAL's ordinary transfers */
+#endif
+#if DRIVER_STATS
+    DriverStats _stats;
+#endif
 #endif
 
     void aquire(void);
+
+#if DEVICE_SPI_INSTANCE
+    /** The configuration a physical SPI peripheral is programmed with
+     */
+    struct peripheral_t {
+        uint32_t instance;      /**< The HAL instance of the peripheral */
+        int bits;               /**< The programmed frame size, or 0 if unused */
+        int mode;
+        spi_bitorder_t order;
+        int hz;
+    };
+
+    peripheral_t *_peripheral;
+    static peripheral_t _peripherals[SPI_PERIPHERAL_COUNT];
+#else
     static SPI *_owner;
+#endif
     int _bits;
     int _mode;
     spi_bitorder_t _order;
     int _hz;
 };
 
+#if DEVICE_SPI_ASYNCH && !TRANSACTION_POOL_SIZE_SPI
+/** An SPI master with a queue of N transfers of its own
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * // the radio pipelines eight transfers; the sensor bus never queues
+ * QueuedSPI<8> radio_spi(D11, D12, D13);
+ * SPI sensor_spi(PTD2, PTD3, PTD1);
+ * @endcode
+ */
+template<uint16_t N>
+class QueuedSPI : public SPI {
+public:
+    /** Create a SPI master with a queue, as for SPI
+     *
+     *  @param mosi SPI Master Out, Slave In pin
+     *  @param miso SPI Master In, Slave Out pin
+     *  @param sclk SPI Clock pin
+     */
+    QueuedSPI(PinName mosi, PinName miso, PinName sclk) : SPI(mosi, miso, sclk) {
+        set_transaction_queue(_queue, N);
+    }
+
+    virtual ~QueuedSPI() {
+        // the slots go before the SPI does
+        clear_transfer_buffer();
+        set_transaction_queue(NULL, 0);
+    }
+
+private:
+    queue_slot_t _queue[N];
+};
+#endif
+
 } // namespace mbed
 
 #endif
@@ -0,0 +1,150 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SPIDEVICE_H
+#define MBED_SPIDEVICE_H
+
+#include "platform.h"
+
+#if DEVICE_SPI
+
+#include "SPI.h"
+#include "DigitalOut.h"
+
+namespace mbed {
+
+/** A device on a shared SPI bus, with its own chip select and format
+ *
+ * Any number of SPIDevices can share one SPI bus object. Each keeps its own
+ * format and frequency; the bus is only reprogrammed when the next access
+ * needs a different configuration from the one last applied, so alternating
+ * between devices with the same settings costs nothing. The chip select,
+ * which is active low, is asserted around every access: each write(), and
+ * each queued transfer from when it starts until it completes.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ * #include "mbed-drivers/SPIDevice.h"
+ *
+ * SPI bus(p5, p6, p7);
+ * SPIDevice flash(bus, p8, 8, 0, 20000000);
+ * SPIDevice radio(bus, p9, 8, 1, 4000000);
+ *
+ * void app_start(int, char*[]) {
+ *     int id = flash.write(0x9F);
+ *     radio.write(0x01);
+ * }
+ * @endcode
+ */
+class SPIDevice {
+public:
+    /** Create a device on a SPI bus
+     *
+     *  @param bus   The SPI bus the device is connected to
+     *  @param cs    The device's chip select pin
+     *  @param bits  Number of bits per SPI frame (4 - 16)
+     *  @param mode  Clock polarity and phase mode (0 - 3)
+     *  @param hz    SCLK frequency in hz
+     *  @param order Bit order. SPI_MSB (standard) or SPI_LSB.
+     */
+    SPIDevice(SPI &bus, PinName cs, int bits = 8, int mode = 0, int hz = 1000000, spi_bitorder_t order = SPI_MSB);
+
+    /** Configure the data transmission format used for this device
+     *
+     *  @param bits  Number of bits per SPI frame (4 - 16)
+     *  @param mode  Clock polarity and phase mode (0 - 3)
+     *  @param order Bit order. SPI_MSB (standard) or SPI_LSB.
+     */
+    void format(int bits, int mode = 0, spi_bitorder_t order = SPI_MSB);
+
+    /** Set the bus clock frequency used for this device
+     *
+     *  @param hz SCLK frequency in hz (default = 1MHz)
+     */
+    void frequency(int hz = 1000000);
+
+    /** Write a single frame to the device and return the response
+     *
+     *  @param value Data to be sent to the device
+     *
+     *  @returns
+     *    Response from the device
+     */
+    int write(int value);
+
+    /** Write a block to the device, and read the response
+     *
+     *  @param tx_buffer Data to be sent to the device
+     *  @param tx_length Number of frames to send
+     *  @param rx_buffer Buffer for the response from the device
+     *  @param rx_length Number of frames to receive
+     *
+     *  @returns
+     *    The number of frames exchanged, as for SPI::write()
+     */
+    int write(const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length);
+
+    /** Assert the chip select and configure the bus for this device
+     *
+     *  Use select() and deselect() around a sequence of bus accesses that
+     *  the device needs in one chip select window.
+     */
+    void select();
+
+    /** Release the chip select
+     */
+    void deselect();
+
+#if DEVICE_SPI_ASYNCH
+    /** Start a transfer with this device
+     *
+     *  This works like SPI::transfer(). The transfer is queued on the bus,
+     *  and the chip select is held from when it starts until it completes.
+     *
+     *  @return A SPITransferAdder object. When either apply() is called or
+     *      the SPITransferAdder goes out of scope, the transfer is queued.
+     */
+    SPI::SPITransferAdder transfer();
+
+    /** Abort this device's on-going transfer and cancel its queued ones
+     *
+     *  Transfers with other devices on the bus are not affected. The
+     *  callbacks are scheduled with SPI_EVENT_CANCELLED.
+     *
+     *  @return The number of transfers aborted or cancelled
+     */
+    int abort() {
+        return _bus.flush(this);
+    }
+#endif
+
+    virtual ~SPIDevice() {
+    }
+
+protected:
+    SPI &_bus;
+    DigitalOut _cs;
+    int _bits;
+    int _mode;
+    spi_bitorder_t _order;
+    int _hz;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
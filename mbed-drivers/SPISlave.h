@@ -0,0 +1,211 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SPISLAVE_H
+#define MBED_SPISLAVE_H
+
+#include "platform.h"
+
+#if DEVICE_SPISLAVE
+
+#include "spi_api.h"
+
+#if DEVICE_SPISLAVE_ASYNCH
+#include "CThunk.h"
+#include "dma_api.h"
+#include "core-util/FunctionPointer.h"
+#include "Buffer.h"
+#include "CompletionQueue.h"
+#include "mbed_sleep.h"
+#include "DMAManager.h"
+#endif
+
+namespace mbed {
+
+/** A SPI slave, used for communicating with a SPI Master device
+ *
+ * The default format is set to 8-bits, mode 0, and a clock frequency of 1MHz
+ *
+ * Example:
+ * @code
+ * // Reply to a SPI master as slave
+ *
+ * #include "mbed.h"
+ *
+ * SPISlave device(p5, p6, p7, p8); // mosi, miso, sclk, ssel
+ *
+ * int main() {
+ *     device.reply(0x00);              // Prime SPI with first reply
+ *     while(1) {
+ *         if(device.receive()) {
+ *             int v = device.read();   // Read byte from master
+ *             v = (v + 1) % 0x100;     // Add one to it, modulo 256
+ *             device.reply(v);         // Make this the next reply
+ *         }
+ *     }
+ * }
+ * @endcode
+ *
+ * With DEVICE_SPISLAVE_ASYNCH, transfer() and start_stream() use the same
+ * asynchronous HAL as SPI, and report back through the minar scheduler. A
+ * stream keeps one half armed while the other is reported, so back to back
+ * transactions from the master find a buffer ready.
+ */
+class SPISlave {
+
+public:
+    /** Create a SPI slave connected to the specified pins
+     *
+     *  mosi or miso can be specfied as NC if not used
+     *
+     *  @param mosi SPI Master Out, Slave In pin
+     *  @param miso SPI Master In, Slave Out pin
+     *  @param sclk SPI Clock pin
+     *  @param ssel SPI chip select pin
+     */
+    SPISlave(PinName mosi, PinName miso, PinName sclk, PinName ssel);
+
+    /** Configure the data transmission format
+     *
+     *  @param bits Number of bits per SPI frame (4 - 16)
+     *  @param mode Clock polarity and phase mode (0 - 3)
+     *  @param order Bit order (SPI_MSB or SPI_LSB)
+     *
+     * @code
+     * mode | POL PHA
+     * -----+--------
+     *   0  |  0   0
+     *   1  |  0   1
+     *   2  |  1   0
+     *   3  |  1   1
+     * @endcode
+     */
+    void format(int bits, int mode = 0, spi_bitorder_t order = SPI_MSB);
+
+    /** Set the spi bus clock frequency
+     *
+     *  @param hz SCLK frequency in hz (default = 1MHz)
+     */
+    void frequency(int hz = 1000000);
+
+    /** Polls the SPI to see if data has been received
+     *
+     *  @returns
+     *    0 if no data,
+     *    1 otherwise
+     */
+    int receive(void);
+
+    /** Retrieve  data from receive buffer as slave
+     *
+     *  @returns
+     *    the data in the receive buffer
+     */
+    int read(void);
+
+    /** Fill the transmission buffer with the value to be written out
+     *  as slave on the next received message from the master.
+     *
+     *  @param value the data to be transmitted next
+     */
+    void reply(int value);
+
+#if DEVICE_SPISLAVE_ASYNCH
+    /** SPI transfer callback
+     *  @param Buffer the tx buffer
+     *  @param Buffer the rx buffer
+     *  @param int the event that triggered the calback
+     */
+    typedef mbed::util::FunctionPointer3<void, Buffer, Buffer, int> event_callback_t;
+
+    /** Arm a single transfer for the master to clock
+     *
+     *  @param tx The transmit buffer (zero length to send fill frames)
+     *  @param rx The receive buffer (zero length to drop received frames)
+     *  @param callback The event callback function
+     *  @param event The logical OR of SPI events to report
+     *  @return Zero if the transfer was armed, or -1 if a transfer is armed already
+     */
+    int transfer(const Buffer &tx, const Buffer &rx, const event_callback_t &callback, int event = SPI_EVENT_COMPLETE);
+
+    /** Arm a continuous, double-buffered transfer
+     *
+     *  The two halves are armed alternately, the next half being armed from
+     *  the interrupt handler as soon as the master finishes clocking the
+     *  previous one, and before that one is reported. The callback is
+     *  invoked with the buffers of each half as it completes; the
+     *  application has until the master finishes the other half to refill
+     *  or consume it.
+     *
+     *  @param tx0 The first half's transmit buffer
+     *  @param rx0 The first half's receive buffer
+     *  @param tx1 The second half's transmit buffer
+     *  @param rx1 The second half's receive buffer
+     *  @param callback The event callback function
+     *  @param event The logical OR of SPI events to report
+     *  @return Zero if the stream was armed, or -1 if a transfer is armed already
+     */
+    int start_stream(const Buffer &tx0, const Buffer &rx0, const Buffer &tx1, const Buffer &rx1,
+            const event_callback_t &callback, int event = SPI_EVENT_COMPLETE);
+
+    /** Stop a stream once the half the master is clocking completes
+     */
+    void stop_stream();
+
+    /** Disarm the transfer or stream, dropping what the master has clocked
+     */
+    void abort_transfer();
+
+    /** Configure DMA usage suggestion for non-blocking transfers
+     *
+     *  @param usage The usage DMA hint for peripheral
+     *  @return Zero if the usage was set, -1 if a transfer is armed
+     */
+    int set_dma_usage(DMAUsage usage);
+
+protected:
+    void irq_handler_asynch(void);
+
+    /** Arm one half for the master to clock
+     *  @param half The half, 0 or 1
+     */
+    void start_half(int half);
+
+    Buffer _tx[2];
+    Buffer _rx[2];
+    event_callback_t _callback;
+    int _event;
+    int _half;                              /**< The half the master is clocking */
+    volatile bool _streaming;
+    CompletionQueue::Slot _completion[2];   /**< Where each half's completion is posted */
+    DeepSleepLock _deep_sleep;              /**< Held while a transfer is armed */
+    CThunk<SPISlave> _irq;
+    DMAChannel _dma;
+#endif
+
+protected:
+    spi_t _spi;
+
+    int _bits;
+    int _mode;
+    spi_bitorder_t _order;
+    int _hz;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
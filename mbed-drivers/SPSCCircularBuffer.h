@@ -0,0 +1,175 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SPSCCIRCULARBUFFER_H
+#define MBED_SPSCCIRCULARBUFFER_H
+
+#include <stdint.h>
+#include "cmsis.h"
+
+namespace mbed {
+
+/** Single-producer, single-consumer circular buffer
+ *
+ * One context (for example an interrupt handler) may push while another
+ * (for example the minar loop) pops, without disabling interrupts. Only the
+ * producer writes the head counter and only the consumer writes the tail
+ * counter; each publishes its update after a memory barrier, so the other
+ * side never sees a slot before its data has been written or read. With
+ * more than one producer or consumer, the caller has to serialise them.
+ *
+ * Unlike CircularBuffer, pushing to a full buffer fails instead of
+ * overwriting the oldest element. BufferSize must be a power of two, so
+ * indexing is a mask rather than a division.
+ */
+template<typename T, uint32_t BufferSize>
+class SPSCCircularBuffer {
+    typedef char buffer_size_must_be_a_power_of_two[((BufferSize & (BufferSize - 1)) == 0 && BufferSize > 0) ? 1 : -1];
+
+public:
+    SPSCCircularBuffer() : _head(0), _tail(0) {
+    }
+
+    ~SPSCCircularBuffer() {
+    }
+
+    /** Push an element to the buffer (producer only)
+     *
+     * @param data Data to be pushed to the buffer
+     * @return True if the element was pushed, false if the buffer is full
+     */
+    bool push(const T& data) {
+        uint32_t head = _head;
+        if (head - _tail == BufferSize) {
+            return false;
+        }
+        _pool[head & mask] = data;
+        __DMB();
+        _head = head + 1;
+        return true;
+    }
+
+    /** Push up to n elements to the buffer (producer only)
+     *
+     * @param data The elements to push
+     * @param n The number of elements in data
+     * @return The number of elements pushed
+     */
+    uint32_t push_n(const T *data, uint32_t n) {
+        uint32_t head = _head;
+        uint32_t space = BufferSize - (head - _tail);
+        if (n > space) {
+            n = space;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            _pool[(head + i) & mask] = data[i];
+        }
+        __DMB();
+        _head = head + n;
+        return n;
+    }
+
+    /** Pop an element from the buffer (consumer only)
+     *
+     * @param data Set to the popped element
+     * @return True if an element was popped, false if the buffer is empty
+     */
+    bool pop(T& data) {
+        uint32_t tail = _tail;
+        if (_head == tail) {
+            return false;
+        }
+        __DMB();
+        data = _pool[tail & mask];
+        __DMB();
+        _tail = tail + 1;
+        return true;
+    }
+
+    /** Pop up to n elements from the buffer (consumer only)
+     *
+     * @param data Filled with the popped elements
+     * @param n The room in data, in elements
+     * @return The number of elements popped
+     */
+    uint32_t pop_n(T *data, uint32_t n) {
+        uint32_t tail = _tail;
+        uint32_t available = _head - tail;
+        if (n > available) {
+            n = available;
+        }
+        __DMB();
+        for (uint32_t i = 0; i < n; i++) {
+            data[i] = _pool[(tail + i) & mask];
+        }
+        __DMB();
+        _tail = tail + n;
+        return n;
+    }
+
+    /** Get the oldest element without removing it (consumer only)
+     *
+     * @param data Set to the oldest element
+     * @return True if there was an element, false if the buffer is empty
+     */
+    bool peek(T& data) const {
+        uint32_t tail = _tail;
+        if (_head == tail) {
+            return false;
+        }
+        __DMB();
+        data = _pool[tail & mask];
+        return true;
+    }
+
+    /** Get the number of elements in the buffer
+     */
+    uint32_t size() const {
+        return _head - _tail;
+    }
+
+    /** Check if the buffer is empty
+     *
+     * @return True if the buffer is empty, false if not
+     */
+    bool empty() const {
+        return _head == _tail;
+    }
+
+    /** Check if the buffer is full
+     *
+     * @return True if the buffer is full, false if not
+     */
+    bool full() const {
+        return (_head - _tail) == BufferSize;
+    }
+
+    /** Drop all the elements in the buffer (consumer only)
+     */
+    void reset() {
+        _tail = _head;
+    }
+
+private:
+    static const uint32_t mask = BufferSize - 1;
+
+    T _pool[BufferSize];
+    volatile uint32_t _head;   // written by the producer only
+    volatile uint32_t _tail;   // written by the consumer only
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,197 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SAMPLEFILTER_H
+#define MBED_SAMPLEFILTER_H
+
+#include "platform.h"
+#include "Buffer.h"
+#include "core-util/FunctionPointer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mbed {
+
+/** A processing stage for blocks of Q15 samples
+ *
+ * Each stage works in place, so a chain of them runs over a stream buffer
+ * without copying it. Samples are signed Q15: AnalogIn stream samples are
+ * converted by SampleChain, by flipping their top bit.
+ *
+ * On cores with the DSP extension (Cortex-M4, M7 and M33 with DSP), the
+ * filters use the dual 16-bit multiply-accumulate instructions, SMLAD and
+ * SMLALD; elsewhere they use the same arithmetic in plain C, with the same
+ * results.
+ */
+class SampleFilter {
+public:
+    virtual ~SampleFilter() {}
+
+    /** Process a block of samples in place
+     *
+     *  @param samples The samples
+     *  @param count The number of samples
+     *  @returns The number of samples left in the block
+     */
+    virtual size_t process(int16_t *samples, size_t count) = 0;
+};
+
+/** An FIR filter, optionally decimating
+ *
+ * The coefficients are Q15, and as in CMSIS-DSP they are stored in time
+ * reversed order, so coefficients[taps - 1] multiplies the newest sample.
+ * The caller provides the delay line, of 2 * taps samples; it is twice the
+ * length of the filter so that the last taps samples are always contiguous.
+ * The products are summed in 32 bits, so the magnitudes of the
+ * coefficients must sum to less than 2.
+ */
+class FIRFilter : public SampleFilter {
+public:
+    /** Create an FIR filter
+     *
+     *  @param coefficients The taps, in time reversed order
+     *  @param taps The number of taps
+     *  @param state The delay line, of 2 * taps samples
+     *  @param decimation Output one sample for this many input samples
+     */
+    FIRFilter(const int16_t *coefficients, uint16_t taps, int16_t *state, uint16_t decimation = 1);
+
+    /** Clear the delay line
+     */
+    void reset();
+
+    virtual size_t process(int16_t *samples, size_t count);
+
+protected:
+    const int16_t *_coefficients;
+    int16_t *_state;
+    uint16_t _taps;
+    uint16_t _decimation;
+    uint16_t _pos;      // where the next sample is written, and at _pos + _taps
+    uint16_t _phase;    // input samples since the last output
+};
+
+/** A cascade of biquad IIR sections, in direct form I
+ *
+ * Each section has five Q14 coefficients, b0, b1, b2, a1 and a2, so they
+ * range from -2 to 2. As in CMSIS-DSP, a1 and a2 are added, so they are
+ * the negated denominator coefficients:
+ *
+ *     y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+ *
+ * The caller provides the state, of four samples per section.
+ */
+class BiquadFilter : public SampleFilter {
+public:
+    /** Create a biquad cascade
+     *
+     *  @param coefficients Five coefficients per section
+     *  @param sections The number of sections
+     *  @param state Four samples per section
+     */
+    BiquadFilter(const int16_t *coefficients, uint8_t sections, int16_t *state);
+
+    /** Clear the state
+     */
+    void reset();
+
+    virtual size_t process(int16_t *samples, size_t count);
+
+protected:
+    const int16_t *_coefficients;
+    int16_t *_state;
+    uint8_t _sections;
+};
+
+/** Measures the RMS of each block, without changing it
+ */
+class RMSMeter : public SampleFilter {
+public:
+    RMSMeter() : _rms(0) {
+    }
+
+    /** Get the RMS of the last block, in Q15
+     */
+    uint16_t rms() const {
+        return _rms;
+    }
+
+    virtual size_t process(int16_t *samples, size_t count);
+
+    /** Compute the RMS of a block of samples
+     *
+     *  @param samples The samples
+     *  @param count The number of samples
+     *  @returns The RMS, in Q15
+     */
+    static uint16_t compute(const int16_t *samples, size_t count);
+
+protected:
+    volatile uint16_t _rms;
+};
+
+/** Runs filter stages over each buffer of an AnalogIn stream
+ *
+ * Pass callback() to AnalogIn::start_stream(). Each buffer is converted to
+ * Q15 and run through the stages in place, in main context, then passed to
+ * the chain's own callback, with its length cut to the samples left after
+ * decimation.
+ *
+ * Example:
+ * @code
+ * // A 4x decimating low pass, then the RMS of each block
+ * static const int16_t taps[16] = { ... };
+ * int16_t fir_state[32];
+ * FIRFilter lowpass(taps, 16, fir_state, 4);
+ * RMSMeter meter;
+ * SampleFilter *stages[] = {&lowpass, &meter};
+ * SampleChain chain(stages, 2, filtered);
+ *
+ * adc.start_stream(40000, Buffer(buf0, sizeof(buf0)), Buffer(buf1, sizeof(buf1)), chain.callback());
+ * @endcode
+ */
+class SampleChain {
+public:
+    /** Stream callback, with the same arguments as AnalogIn's
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, int> event_callback_t;
+
+    /** Create a chain of stages
+     *
+     *  @param stages The stages, in order
+     *  @param count The number of stages
+     *  @param callback The function to call with each processed buffer
+     */
+    SampleChain(SampleFilter **stages, size_t count, const event_callback_t &callback) :
+            _stages(stages), _count(count), _callback(callback) {
+    }
+
+    /** Get the callback to give the stream
+     */
+    event_callback_t callback() {
+        return event_callback_t(this, &SampleChain::on_buffer);
+    }
+
+protected:
+    void on_buffer(Buffer buffer, int event);
+
+    SampleFilter **_stages;
+    size_t _count;
+    event_callback_t _callback;
+};
+
+} // namespace mbed
+
+#endif
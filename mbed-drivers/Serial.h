@@ -65,6 +65,16 @@ public:
 protected:
     virtual int _getc();
     virtual int _putc(int c);
+
+#if DEVICE_SERIAL_ASYNCH
+    /** Write a block of data with one asynchronous transfer
+     *
+     * Used once a DMA usage other than DMA_USAGE_NEVER is set with
+     * set_dma_usage_tx(). It returns when the transfer has completed, as
+     * the caller may reuse the buffer.
+     */
+    virtual ssize_t _write(const void* buffer, size_t length);
+#endif
 };
 
 } // namespace mbed
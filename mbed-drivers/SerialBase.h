@@ -24,10 +24,31 @@
 #include "core-util/FunctionPointer.h"
 #include "serial_api.h"
 #include "Transaction.h"
+#include "Timeout.h"
 
 #if DEVICE_SERIAL_ASYNCH
 #include "CThunk.h"
 #include "dma_api.h"
+#include "CircularBuffer.h"
+#include "CompletionQueue.h"
+#include "mbed_sleep.h"
+#include "DMAManager.h"
+#include "DriverStats.h"
+#endif
+
+/* Each serial port queues up to TRANSACTION_QUEUE_SIZE_SERIAL asynchronous
+ * writes of its own, sent back to back from the TX complete interrupt. With
+ * no queue, write() fails while a write is in progress.
+ */
+#ifndef TRANSACTION_QUEUE_SIZE_SERIAL
+#define TRANSACTION_QUEUE_SIZE_SERIAL 0
+#endif
+
+#if DEVICE_SERIAL_ASYNCH
+/* Include in a read()'s events to coalesce its callbacks: events that
+ * arrive while a callback is still waiting for the scheduler are ORed into
+ * that callback instead of posting another one */
+#define SERIAL_EVENT_FLAG_COALESCE (1 << 24)
 #endif
 
 namespace mbed {
@@ -44,6 +65,30 @@ public:
      */
     void baud(int baudrate);
 
+    /** Change the baud rate once what has been written has gone out
+     *
+     *  The asynchronous write in progress completes at the current rate,
+     *  and writes started after this are held back until the switch. Once
+     *  the transmitter has been given two more frame times to empty, the
+     *  new rate is applied with interrupts disabled, the callback is
+     *  scheduled, and the held writes start at the new rate. A byte being
+     *  received at the moment of the switch is lost.
+     *
+     *  @param baudrate The new baud rate
+     *  @param callback Called once the new rate is in use, or NULL
+     *
+     *  @returns
+     *    0 if the switch was started, -1 if a switch or a break is already
+     *    in progress
+     */
+    int baud(int baudrate, mbed::util::FunctionPointer callback);
+
+    /** Check if a baud rate switch is waiting for the transmitter
+     */
+    bool baud_pending() const {
+        return _baud_pending != 0;
+    }
+
     enum Parity {
         None = 0,
         Odd,
@@ -72,6 +117,25 @@ public:
      */
     void format(int bits=8, Parity parity=SerialBase::None, int stop_bits=1);
 
+#if DEVICE_SUSPEND
+    /** Stop the peripheral's clock, to save power between bursts
+     *
+     *  Nothing is received while the port is suspended.
+     *
+     *  The HAL keeps the peripheral's configuration, so resume() needs no
+     *  pinmap lookups and no reconfiguration. The serial port must not be used
+     *  until it is resumed.
+     *
+     *  @returns 0 on success, or -1 if an asynchronous transfer is in
+     *    progress
+     */
+    int suspend();
+
+    /** Restart the peripheral's clock after suspend()
+     */
+    void resume();
+#endif
+
     /** Determine if there is a character available to read
      *
          typedef FunctionPointer3<void, Buffer, int, void*> event_callback_t;
@@ -113,10 +177,79 @@ public:
         }
     }
 
+    /** Receive into a ring from the RX interrupt, then call a function once
+     *
+     *  On each RX interrupt, everything in the receive FIFO is moved into
+     *  the ring in one pass, before fptr is called once, from the interrupt,
+     *  if anything arrived. Where the HAL has DEVICE_SERIAL_RX_DRAIN, the
+     *  FIFO is copied by serial_rx_drain() rather than a byte at a time. A
+     *  byte that arrives with the ring full is dropped and counted. The
+     *  ring is read with read_rx_ring(). attach() of an RX function, or of
+     *  none, stops receiving into the ring.
+     *
+     *  @param buffer The ring's memory
+     *  @param size The size of buffer, a power of two
+     *  @param fptr Called after each drain that received something, or NULL
+     *
+     *  @returns
+     *    0 on success, -1 if size is not a power of two
+     */
+    int attach_rx_ring(void *buffer, uint32_t size, void (*fptr)(void) = NULL);
+
+    /** Receive into a ring from the RX interrupt, then call a member function once
+     *
+     *  @param buffer The ring's memory
+     *  @param size The size of buffer, a power of two
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *
+     *  @returns
+     *    0 on success, -1 if size is not a power of two
+     */
+    template<typename T>
+    int attach_rx_ring(void *buffer, uint32_t size, T* tptr, void (T::*mptr)(void)) {
+        _rx_ring_notify.attach(tptr, mptr);
+        return start_rx_ring(buffer, size);
+    }
+
+    /** Take received bytes out of the ring
+     *
+     *  @param data Filled with the received bytes
+     *  @param length The room in data, in bytes
+     *
+     *  @returns
+     *    The number of bytes read
+     */
+    int read_rx_ring(void *data, int length);
+
+    /** Get the number of received bytes waiting in the ring
+     */
+    int rx_ring_readable() const {
+        return _rx_ring_head - _rx_ring_tail;
+    }
+
+    /** Get the number of received bytes dropped because the ring was full
+     */
+    uint32_t rx_ring_overflows() const {
+        return _rx_ring_overflows;
+    }
+
     /** Generate a break condition on the serial line
      */
     void send_break();
 
+    /** Generate a break condition on the serial line without waiting
+     *
+     * The break is asserted straight away and released by a Timeout after
+     * the same 1.5 frames as send_break(), then the callback is scheduled.
+     *
+     *  @param callback Called once the break has been released, or NULL
+     *
+     *  @returns
+     *    0 if the break was started, -1 if a break is already in progress
+     */
+    int send_break(mbed::util::FunctionPointer callback);
+
 #if DEVICE_SERIAL_FC
     /** Set the flow control type on the serial port
      *
@@ -142,6 +275,7 @@ public:
      *  @param length   The buffer length
      *  @param callback The event callback function
      *  @param event    The logical OR of TX events
+     *  @return Zero if the write has started or was queued, or -1 if a write or a baud rate switch is on-going and the queue is full
      */
     int write(void *buffer, int length, const event_callback_t& callback, int event = SERIAL_EVENT_TX_COMPLETE);
 
@@ -150,19 +284,31 @@ public:
      *  @param buffer   The buffer where received data will be stored
      *  @param callback The event callback function
      *  @param event    The logical OR of TX events
+     *  @return Zero if the write has started or was queued, or -1 if a write or a baud rate switch is on-going and the queue is full
      */
     int write(const Buffer& buf, const event_callback_t& callback, int event = SERIAL_EVENT_TX_COMPLETE);
 
-    /** Abort the on-going write transfer
+    /** Abort the on-going write transfer, and continue with the queued writes if any
      */
     void abort_write();
 
+    /** Clear the queue of writes
+     */
+    void clear_write_buffer();
+
+    /** Clear the queue of writes and abort the on-going write
+     */
+    void abort_all_writes();
+
     /** Begin asynchronous reading using 8bit buffer. The completition invokes registred RX event callback.
      *
      *  @param buffer     The buffer where received data will be stored
      *  @param length     The buffer length
      *  @param callback   The event callback function
-     *  @param event      The logical OR of RX events
+     *  @param event      The logical OR of RX events, plus
+     *                    SERIAL_EVENT_FLAG_COALESCE to coalesce the callbacks;
+     *                    a coalesced callback is passed the logical OR of the
+     *                    events since the previous one
      *  @param char_match The matching character
      */
     int read(void *buffer, int length, const event_callback_t& callback, int event = SERIAL_EVENT_RX_COMPLETE, unsigned char char_match = SERIAL_RESERVED_CHAR_MATCH);
@@ -171,7 +317,8 @@ public:
      *
      *  @param buffer     The buffer where received data will be stored
      *  @param callback   The event callback function
-     *  @param event      The logical OR of RX events
+     *  @param event      The logical OR of RX events, plus
+     *                    SERIAL_EVENT_FLAG_COALESCE to coalesce the callbacks
      *  @param char_match The matching character
      */
     int read(const Buffer& buffer, const event_callback_t& callback, int event = SERIAL_EVENT_RX_COMPLETE, unsigned char char_match = SERIAL_RESERVED_CHAR_MATCH);
@@ -180,6 +327,28 @@ public:
      */
     void abort_read();
 
+#if DEVICE_SERIAL_ASYNCH_CIRCULAR
+    /** Begin continuous reception into a circular buffer
+     *
+     * The peripheral keeps receiving into the buffer, wrapping around at its
+     * end, until abort_read() is called; it is never re-armed. On each of the
+     * selected events the callback is passed the bytes received since the
+     * previous callback, as a slice of the buffer; a slice that would wrap is
+     * reported as two. The data must be consumed before the reception wraps
+     * around onto it.
+     *
+     *  @param buffer   The circular buffer
+     *  @param callback The event callback function
+     *  @param event    The logical OR of RX events: SERIAL_EVENT_RX_IDLE on an
+     *                  idle line, SERIAL_EVENT_RX_HALF_COMPLETE and
+     *                  SERIAL_EVENT_RX_COMPLETE when the half and the end of
+     *                  the buffer are reached, plus the error events
+     *  @return Zero if the reception has started, or -1 if a read is on-going
+     */
+    int read_circular(const Buffer& buffer, const event_callback_t& callback,
+                      int event = SERIAL_EVENT_RX_IDLE | SERIAL_EVENT_RX_HALF_COMPLETE | SERIAL_EVENT_RX_COMPLETE);
+#endif
+
     /** Configure DMA usage suggestion for non-blocking TX transfers
      *
      *  @param usage The usage DMA hint for peripheral
@@ -194,10 +363,60 @@ public:
      */
     int set_dma_usage_rx(DMAUsage usage);
 
+    /** Set the priority of the TX completions in the scheduler
+     *
+     *  @param priority The priority, PRIORITY_NORMAL by default
+     */
+    void set_completion_priority_tx(CompletionQueue::Priority priority) {
+        _tx_completion.set_priority(priority);
+    }
+
+    /** Set the priority of the RX completions in the scheduler
+     *
+     *  See CompletionQueue::Priority. A fast stream of receive events can
+     *  be given PRIORITY_LOW, with a budget, so that it can't hold up other
+     *  drivers' completions.
+     *
+     *  @param priority The priority, PRIORITY_NORMAL by default
+     */
+    void set_completion_priority_rx(CompletionQueue::Priority priority) {
+        _rx_completion.set_priority(priority);
+    }
+
+#if DRIVER_STATS
+    /** Get the statistics of the asynchronous transfers in one direction
+     *
+     *  Continuous reads are counted as one transfer, busy for as long as
+     *  they run, with the bytes of each slice reported.
+     *
+     *  @param stats Set to a consistent copy of the statistics
+     *  @param type TxIrq for writes, RxIrq for reads
+     */
+    void get_stats(driver_stats_t *stats, IrqType type = TxIrq) const {
+        (type == TxIrq ? _tx_stats : _rx_stats).get(stats);
+    }
+
+    /** Reset the statistics of both directions
+     */
+    void reset_stats() {
+        _tx_stats.reset();
+        _rx_stats.reset();
+    }
+#endif
+
 protected:
-    void start_read(const Buffer& buffer, char buffer_width, const event_callback_t& callback, int event, unsigned char char_match);
+    void start_read(const Buffer& buffer, char buffer_width, const event_callback_t& callback, int event, unsigned char char_match, bool circular = false);
     void start_write(const Buffer& buffer, char buffer_width, const event_callback_t& callback, int event);
+    void dequeue_write();
     void interrupt_handler_asynch(void);
+#if DEVICE_SERIAL_ASYNCH_CONTEXT
+    static void interrupt_handler_context(uint32_t id);
+#endif
+#if DEVICE_SERIAL_ASYNCH_CIRCULAR
+    void report_circular(int rx_event);
+#endif
+    void post_rx_coalesced(int rx_event);
+    void deliver_rx_coalesced();
 #endif
 
 protected:
@@ -212,16 +431,54 @@ protected:
     typedef OneWayTransaction<event_callback_t> transaction_data_t;
     typedef Transaction<SerialBase, transaction_data_t> transaction_t;
 
-    CThunk<SerialBase> _thunk_irq;
+#if TRANSACTION_QUEUE_SIZE_SERIAL
+    CircularBuffer<transaction_t, TRANSACTION_QUEUE_SIZE_SERIAL> _tx_transaction_buffer;
+#endif
+#if !DEVICE_SERIAL_ASYNCH_CONTEXT
+    // TX and RX have a thunk each, so starting one never rewrites the
+    // thunk the other direction's interrupt may be running through
+    CThunk<SerialBase> _tx_thunk_irq;
+    CThunk<SerialBase> _rx_thunk_irq;
+#endif
     transaction_data_t _current_tx_transaction;
     transaction_data_t _current_rx_transaction;
-    DMAUsage _tx_usage;
-    DMAUsage _rx_usage;
+    CompletionQueue::Slot _tx_completion;   // where TX completions are posted
+    CompletionQueue::Slot _rx_completion;   // where RX completions are posted
+    volatile int _rx_coalesced_events;      // RX events waiting in _rx_completion
+    DeepSleepLock _tx_deep_sleep;           // held while an asynchronous write runs
+    DeepSleepLock _rx_deep_sleep;           // held while an asynchronous read runs
+#if DRIVER_STATS
+    DriverStats _tx_stats;
+    DriverStats _rx_stats;
+#endif
+#if DEVICE_SERIAL_ASYNCH_CIRCULAR
+    bool _rx_circular;
+    size_t _rx_position;    // the offset in the circular buffer reported up to
 #endif
+    DMAChannel _tx_dma;
+    DMAChannel _rx_dma;
+#endif
+
+    void break_release();
+    void start_baud_switch();
+    void baud_switch();
+    int start_rx_ring(void *buffer, uint32_t size);
+    void rx_ring_irq();
 
     serial_t                    _serial;
     mbed::util::FunctionPointer _irq[2];
     int                         _baud;
+    Timeout                     _break_timeout;
+    mbed::util::FunctionPointer _break_callback;
+    volatile bool               _break_active;
+    volatile int                _baud_pending;      // the rate to switch to, 0 if none
+    mbed::util::FunctionPointer _baud_callback;
+    char                        *_rx_ring;          // NULL unless receiving into the ring
+    uint32_t                    _rx_ring_mask;
+    volatile uint32_t           _rx_ring_head;      // advanced by the RX interrupt
+    volatile uint32_t           _rx_ring_tail;      // advanced by read_rx_ring()
+    volatile uint32_t           _rx_ring_overflows;
+    mbed::util::FunctionPointer _rx_ring_notify;
 
 };
 
@@ -0,0 +1,198 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SHAREDBUFFER_H
+#define MBED_SHAREDBUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Buffer.h"
+#include "core-util/CriticalSectionLock.h"
+
+namespace mbed {
+
+/** A reference counted window onto a block of memory, with room to grow
+ *  at both ends
+ *
+ * The data sits somewhere inside the block, so a protocol layer can
+ * prepend its header into the headroom in front of it, or append a
+ * trailer, without copying what is already there. The buffer converts to
+ * a Buffer of just the data, so it can be handed straight to the SPI, I2C
+ * and serial asynchronous transfers, and from there to DMA.
+ *
+ * The block is released through the free function when the last reference
+ * is. Whoever starts an asynchronous transfer of the buffer should hold a
+ * reference until its callback has run.
+ *
+ * Example:
+ * @code
+ * static uint8_t block[64];
+ * SharedBuffer frame(block, sizeof(block), 8);  // 8 bytes of headroom
+ * memcpy(frame.append(3), "abc", 3);
+ * uint8_t *header = (uint8_t *)frame.prepend(2);
+ * header[0] = 0x7E;
+ * header[1] = frame.length() - 2;
+ * serial.write(frame, callback);                 // sends the 5 bytes in place
+ * @endcode
+ */
+class SharedBuffer {
+public:
+    /** Called with the block when the last reference is released
+     */
+    typedef void (*free_function_t)(void *block, void *context);
+
+    /** Wrap a block of memory, with no data yet
+     *
+     *  @param block The memory
+     *  @param capacity The size of the block, in bytes
+     *  @param headroom Where in the block the data starts, leaving room for
+     *    headers in front of it
+     *  @param free_function Called to release the block, or NULL if it
+     *    needs no releasing
+     *  @param context Passed to free_function
+     */
+    SharedBuffer(void *block, size_t capacity, size_t headroom = 0,
+                 free_function_t free_function = NULL, void *context = NULL) :
+        _block((uint8_t *)block), _capacity(capacity), _offset(headroom > capacity ? capacity : headroom),
+        _length(0), _refs(1), _free(free_function), _context(context) {
+    }
+
+    /** Get the start of the data
+     */
+    void *data() const {
+        return _block + _offset;
+    }
+
+    /** Get the length of the data, in bytes
+     */
+    size_t length() const {
+        return _length;
+    }
+
+    /** Get the room in front of the data, in bytes
+     */
+    size_t headroom() const {
+        return _offset;
+    }
+
+    /** Get the room after the data, in bytes
+     */
+    size_t tailroom() const {
+        return _capacity - _offset - _length;
+    }
+
+    /** Grow the data at the front, into the headroom
+     *
+     *  @param n The number of bytes to add
+     *  @returns The new start of the data, for the caller to fill in, or
+     *    NULL if there is not enough headroom
+     */
+    void *prepend(size_t n) {
+        if (n > _offset) {
+            return NULL;
+        }
+        _offset -= n;
+        _length += n;
+        return data();
+    }
+
+    /** Grow the data at the end, into the tailroom
+     *
+     *  @param n The number of bytes to add
+     *  @returns The start of the added bytes, for the caller to fill in, or
+     *    NULL if there is not enough tailroom
+     */
+    void *append(size_t n) {
+        if (n > tailroom()) {
+            return NULL;
+        }
+        uint8_t *end = _block + _offset + _length;
+        _length += n;
+        return end;
+    }
+
+    /** Drop bytes from the front of the data, such as a parsed header
+     *
+     *  @param n The number of bytes to drop, at most length()
+     */
+    void consume(size_t n) {
+        if (n > _length) {
+            n = _length;
+        }
+        _offset += n;
+        _length -= n;
+    }
+
+    /** Drop bytes from the end of the data
+     *
+     *  @param n The number of bytes to drop, at most length()
+     */
+    void trim(size_t n) {
+        _length -= (n > _length) ? _length : n;
+    }
+
+    /** Take another reference
+     *
+     *  This can be called from interrupt handlers.
+     */
+    void retain() {
+        mbed::util::CriticalSectionLock lock;
+        _refs++;
+    }
+
+    /** Release a reference, releasing the block with the last one
+     *
+     *  This can be called from interrupt handlers, if the free function can.
+     */
+    void release() {
+        bool last;
+        {
+            mbed::util::CriticalSectionLock lock;
+            last = (--_refs == 0);
+        }
+        if (last && _free != NULL) {
+            _free(_block, _context);
+        }
+    }
+
+    /** Get the number of references
+     */
+    uint32_t refs() const {
+        return _refs;
+    }
+
+    /** Get a Buffer of the data, for the drivers' transfer functions
+     */
+    operator Buffer() const {
+        return Buffer(data(), _length);
+    }
+
+private:
+    uint8_t *_block;
+    size_t _capacity;
+    size_t _offset;
+    size_t _length;
+    volatile uint32_t _refs;
+    free_function_t _free;
+    void *_context;
+
+    /* disallow copy constructor and assignment operators */
+    SharedBuffer(const SharedBuffer&);
+    SharedBuffer & operator = (const SharedBuffer&);
+};
+
+} // namespace mbed
+
+#endif
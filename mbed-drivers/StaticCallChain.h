@@ -0,0 +1,336 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_STATICCALLCHAIN_H
+#define MBED_STATICCALLCHAIN_H
+
+#include "CallChain.h"
+#include "core-util/CriticalSectionLock.h"
+
+namespace mbed {
+
+/** A CallChain that holds up to N functions without using the heap
+ *
+ * The function objects are stored inline, so adding and removing functions
+ * never allocates. The function objects returned by add() and add_front()
+ * stay valid until they are removed, and can be passed to find() and
+ * remove() as with CallChain. Adding to a full chain fails and returns NULL.
+ *
+ * As with CallChain, the chain can be changed while call() runs, from a
+ * function it calls or an interrupt: the running call() never sees
+ * functions move. Functions added at either end go in free room beside the
+ * running ones, and removed ones are replaced with a marker that call()
+ * skips. A removed function's slot is only reused, and the markers only
+ * cleared, once no call() is running, so until then removed functions
+ * still count against N.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ * #include "mbed-drivers/StaticCallChain.h"
+ *
+ * StaticCallChain<2> chain;
+ *
+ * void first(void) {
+ *     printf("'first' function.\n");
+ * }
+ *
+ * void second(void) {
+ *     printf("'second' function.\n");
+ * }
+ *
+ * int main() {
+ *     chain.add(second);
+ *     chain.add_front(first);
+ *     chain.call();
+ * }
+ * @endcode
+ */
+template<int N>
+class StaticCallChain {
+public:
+    /** Create an empty chain
+     */
+    StaticCallChain() : _chain(), _used(), _retired(), _head(N), _end(N), _elements(0), _readers(0) {
+    }
+
+    /** Add a function at the end of the chain
+     *
+     *  @param function A pointer to a void function
+     *
+     *  @returns
+     *  The function object created for 'function', or NULL if the chain is full
+     */
+    pFunctionPointer_t add(void (*function)(void)) {
+        mbed::util::CriticalSectionLock lock;
+        pFunctionPointer_t pf = alloc();
+        if (pf != NULL) {
+            pf->attach(function);
+            common_add(pf);
+        }
+        return pf;
+    }
+
+    /** Add a function at the end of the chain
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *
+     *  @returns
+     *  The function object created for 'tptr' and 'mptr', or NULL if the chain is full
+     */
+    template<typename T>
+    pFunctionPointer_t add(T *tptr, void (T::*mptr)(void)) {
+        mbed::util::CriticalSectionLock lock;
+        pFunctionPointer_t pf = alloc();
+        if (pf != NULL) {
+            pf->attach(tptr, mptr);
+            common_add(pf);
+        }
+        return pf;
+    }
+
+    /** Add a function at the beginning of the chain
+     *
+     *  @param function A pointer to a void function
+     *
+     *  @returns
+     *  The function object created for 'function', or NULL if the chain is full
+     */
+    pFunctionPointer_t add_front(void (*function)(void)) {
+        mbed::util::CriticalSectionLock lock;
+        pFunctionPointer_t pf = alloc();
+        if (pf != NULL) {
+            pf->attach(function);
+            common_add_front(pf);
+        }
+        return pf;
+    }
+
+    /** Add a function at the beginning of the chain
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *
+     *  @returns
+     *  The function object created for 'tptr' and 'mptr', or NULL if the chain is full
+     */
+    template<typename T>
+    pFunctionPointer_t add_front(T *tptr, void (T::*mptr)(void)) {
+        mbed::util::CriticalSectionLock lock;
+        pFunctionPointer_t pf = alloc();
+        if (pf != NULL) {
+            pf->attach(tptr, mptr);
+            common_add_front(pf);
+        }
+        return pf;
+    }
+
+    /** Get the number of functions in the chain
+     */
+    int size() const {
+        return _elements;
+    }
+
+    /** Get the maximum number of functions in the chain
+     */
+    int capacity() const {
+        return N;
+    }
+
+    /** Get a function object from the chain
+     *
+     *  @param i function object index
+     *
+     *  @returns
+     *  The function object at position 'i' in the chain
+     */
+    pFunctionPointer_t get(int i) const {
+        if (i < 0 || i >= _elements)
+            return NULL;
+        for (int p = _head; p < _end; p++) {
+            if (_chain[p] != removed() && i-- == 0)
+                return _chain[p];
+        }
+        return NULL;
+    }
+
+    /** Look for a function object in the call chain
+     *
+     *  @param f the function object to search
+     *
+     *  @returns
+     *  The index of the function object if found, -1 otherwise.
+     */
+    int find(pFunctionPointer_t f) const {
+        int i = 0;
+        for (int p = _head; p < _end; p++) {
+            if (_chain[p] == removed())
+                continue;
+            if (f == _chain[p])
+                return i;
+            i++;
+        }
+        return -1;
+    }
+
+    /** Clear the call chain (remove all functions in the chain).
+     */
+    void clear() {
+        mbed::util::CriticalSectionLock lock;
+        for (int p = _head; p < _end; p++) {
+            if (_chain[p] != removed())
+                retire(p);
+        }
+        _elements = 0;
+        reclaim();
+    }
+
+    /** Remove a function object from the chain
+     *
+     *  @arg f the function object to remove
+     *
+     *  @returns
+     *  true if the function object was found and removed, false otherwise.
+     */
+    bool remove(pFunctionPointer_t f) {
+        mbed::util::CriticalSectionLock lock;
+        if (f == NULL || f == removed())
+            return false;
+        for (int p = _head; p < _end; p++) {
+            if (_chain[p] == f) {
+                retire(p);
+                _elements --;
+                reclaim();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Call all the functions in the chain in sequence
+     */
+    void call() {
+        // count this call before taking the head, so that a change that
+        // finds no calls running knows that it may move the functions
+        _readers++;
+        for (pFunctionPointer_t *pf = _chain + _head; *pf != NULL; pf++) {
+            if (*pf != removed())
+                (*pf)->call();
+        }
+        _readers--;
+    }
+
+    /** Check whether call() is running, in this context or one it
+     *  interrupted
+     */
+    bool in_call() const {
+        return _readers != 0;
+    }
+
+#ifdef MBED_OPERATORS
+    void operator ()(void) {
+        call();
+    }
+    pFunctionPointer_t operator [](int i) const {
+        return get(i);
+    }
+#endif
+
+private:
+    /* The marker left in place of a removed function, which is never a
+     * function object of the chain */
+    pFunctionPointer_t removed() const {
+        return const_cast<pFunctionPointer_t>(_functions + N);
+    }
+
+    pFunctionPointer_t alloc() {
+        reclaim();
+        for (int i = 0; i < N; i++) {
+            if (!_used[i]) {
+                _used[i] = true;
+                return &_functions[i];
+            }
+        }
+        return NULL;
+    }
+
+    /* Changes are made with interrupts off, so a running call() is always
+     * one that was interrupted: it goes on with the functions it held */
+    void common_add(pFunctionPointer_t pf) {
+        // the slot after the end is always NULL, so an interrupted call()
+        // ends there or at the new function
+        _chain[_end] = pf;
+        _end ++;
+        _elements ++;
+    }
+
+    void common_add_front(pFunctionPointer_t pf) {
+        // an interrupted call() has passed the head already
+        _chain[_head - 1] = pf;
+        _head --;
+        _elements ++;
+    }
+
+    void retire(int p) {
+        _retired[_chain[p] - _functions] = true;
+        _chain[p] = removed();
+    }
+
+    /* With no call() running, drop the markers, free the retired slots, and
+     * move the functions back to start at N. Each function added since took
+     * a slot, so there is then room for N more at either end. */
+    void reclaim() {
+        if (_readers != 0 || (_head == N && _elements == _end - _head))
+            return;
+        pFunctionPointer_t live[N];
+        int elements = 0;
+        for (int p = _head; p < _end; p++) {
+            if (_chain[p] != removed())
+                live[elements++] = _chain[p];
+            _chain[p] = NULL;
+        }
+        for (int i = 0; i < elements; i++)
+            _chain[N + i] = live[i];
+        for (int i = 0; i < N; i++) {
+            if (_retired[i]) {
+                _retired[i] = false;
+                _used[i] = false;
+            }
+        }
+        _head = N;
+        _end = N + elements;
+    }
+
+    mbed::util::FunctionPointer _functions[N];
+    /* Room for N functions added at either end of those at N, with a NULL
+     * after the last one */
+    pFunctionPointer_t _chain[2 * N + 1];
+    bool _used[N];
+    bool _retired[N];
+    int _head;
+    int _end;
+    int _elements;
+    volatile int _readers;
+
+    /* disallow copy constructor and assignment operators */
+private:
+    StaticCallChain(const StaticCallChain&);
+    StaticCallChain & operator = (const StaticCallChain&);
+};
+
+} // namespace mbed
+
+#endif
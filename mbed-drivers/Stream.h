@@ -18,23 +18,50 @@
 
 #include "platform.h"
 #include "FileLike.h"
+#include "mbed_printf.h"
 
 namespace mbed {
 
 class Stream : public FileLike {
 
 public:
+    enum BufferMode {
+        Unbuffered = _IONBF,
+        LineBuffered = _IOLBF,
+        FullyBuffered = _IOFBF
+    };
+
     Stream(const char *name=NULL);
     virtual ~Stream();
 
+    /** Set the buffering of the stream's output
+     *
+     * Streams are unbuffered by default, so every character goes straight
+     * to the device. With line buffering, output is held until a newline is
+     * written or the buffer is full; with full buffering, until the buffer
+     * is full or fflush() is called on the stream. Buffered output reaches
+     * the device as whole blocks through _write().
+     *
+     *  @param mode The buffering mode
+     *  @param buf The buffer to use, which must stay valid for the life of
+     *    the stream, or NULL to have one allocated
+     *  @param size The size of the buffer, in bytes
+     *
+     *  @returns
+     *    0 on success, non-0 on failure, as always with MBED_MINIMAL_STDIO
+     */
+    int set_buffer(BufferMode mode, char *buf = NULL, size_t size = 0);
+
     int putc(int c);
     int puts(const char *s);
     int getc();
     char *gets(char *s, int size);
     int printf(const char* format, ...);
+#if !MBED_MINIMAL_STDIO
     int scanf(const char* format, ...);
 
     operator std::FILE*() {return _file;}
+#endif
 
 protected:
     virtual int close();
@@ -48,7 +75,39 @@ protected:
     virtual int _putc(int c) = 0;
     virtual int _getc() = 0;
 
+    /** Write a block of data to the device
+     *
+     * The default implementation writes the data one character at a time
+     * with _putc(); devices that can move whole blocks should override it.
+     *
+     *  @param buffer The data to write
+     *  @param length The number of bytes in buffer
+     *
+     *  @returns
+     *    the number of bytes written
+     */
+    virtual ssize_t _write(const void* buffer, size_t length);
+
+    /** Read a block of data from the device
+     *
+     * The default implementation reads the data one character at a time
+     * with _getc(); devices that can move whole blocks should override it.
+     *
+     *  @param buffer The buffer to read into
+     *  @param length The number of bytes to read
+     *
+     *  @returns
+     *    the number of bytes read
+     */
+    virtual ssize_t _read(void* buffer, size_t length);
+
+    /* An update stream needs a flush between writes and reads; writes only
+     * flush after a read, so buffered output is not flushed on every call */
+    void begin_write();
+    void begin_read();
+
     std::FILE *_file;
+    bool _writing;
 
     /* disallow copy constructor and assignment operators */
 private:
@@ -17,6 +17,7 @@
 #define MBED_TICKER_H
 
 #include "TimerEvent.h"
+#include "CompletionQueue.h"
 #include "core-util/FunctionPointer.h"
 
 namespace mbed {
@@ -57,10 +58,71 @@ namespace mbed {
 class Ticker : public TimerEvent {
 
 public:
-    Ticker() : TimerEvent() {
+    /** Where the Ticker's function is called from
+     */
+    enum Dispatch {
+        DISPATCH_IRQ,               /**< The ticker interrupt (the default) */
+        DISPATCH_SCHEDULER,         /**< The scheduler, once however many periods passed before it ran */
+        DISPATCH_SCHEDULER_CATCH_UP /**< The scheduler, once for each period that passed before it ran */
+    };
+
+    /** What to do when a call is made so late that later periods have
+     *  already passed
+     */
+    enum Overrun {
+        OVERRUN_CATCH_UP, /**< Call once for each passed period, back to back (the default) */
+        OVERRUN_SKIP,     /**< Drop the passed periods, and call at the next period */
+        OVERRUN_COMPRESS  /**< Call once at once for all the passed periods, then at the next period */
+    };
+
+    Ticker() : TimerEvent(), _context_function(NULL), _context(NULL), _overruns(0), _pending(0), _dispatch(DISPATCH_IRQ), _overrun(OVERRUN_CATCH_UP) {
+    }
+
+    Ticker(const ticker_data_t *const data) : TimerEvent(data), _context_function(NULL), _context(NULL), _overruns(0), _pending(0), _dispatch(DISPATCH_IRQ), _overrun(OVERRUN_CATCH_UP) {
+    }
+
+    /** Choose what to do when the calls fall behind by more than a period
+     *
+     *  Calls are scheduled from the requested times, so a late call does not
+     *  delay the ones after it. If a call is so late that the next period
+     *  has already passed, catching up makes a storm of back to back
+     *  interrupts; skipping or compressing the passed periods keeps a loaded
+     *  system from spending all its time in the ticker interrupt. Either way
+     *  the calls stay in phase with the original period.
+     *
+     *  @param policy what to do with the passed periods
+     */
+    void overrun_policy(Overrun policy) {
+        _overrun = policy;
+    }
+
+    /** Get the number of periods that had already passed when their call
+     *  was scheduled, since the Ticker was attached or reset_overruns()
+     */
+    uint32_t overruns() const {
+        return _overruns;
+    }
+
+    /** Reset the overrun count
+     */
+    void reset_overruns() {
+        _overruns = 0;
     }
 
-    Ticker(const ticker_data_t *const data) : TimerEvent(data) {
+    /** Choose where the function is called from
+     *
+     *  By default the function is called from the ticker interrupt, so it
+     *  delays every other timer event while it runs. With a scheduler
+     *  dispatch, the interrupt only counts the period and posts a callback,
+     *  and the function runs from the scheduler. Periods that pass before
+     *  that callback runs are either merged into one call or each get a call.
+     *  The next period is still scheduled from the interrupt, so the calls
+     *  stay in phase.
+     *
+     *  @param mode where to call the function from
+     */
+    void dispatch(Dispatch mode) {
+        _dispatch = mode;
     }
 
     /** Attach a function to be called by the Ticker, specifiying the interval in seconds
@@ -84,13 +146,18 @@ public:
     }
 
     /** Attach a function to be called by the Ticker, specifiying the interval in micro-seconds
+     *
+     *  A non-zero slack allows each call to be made up to slack micro-seconds
+     *  late, so that it can share an interrupt with another timer event.
      *
      *  @param fptr pointer to the function to be called
      *  @param t the time between calls in micro-seconds
+     *  @param slack how late each call may be, in micro-seconds
      */
-    void attach_us(void (*fptr)(void), timestamp_t t) {
+    void attach_us(void (*fptr)(void), timestamp_t t, timestamp_t slack = 0) {
         _function.attach(fptr);
-        setup(t);
+        _context_function = NULL;
+        setup(t, slack);
     }
 
     /** Attach a member function to be called by the Ticker, specifiying the interval in micro-seconds
@@ -98,11 +165,44 @@ public:
      *  @param tptr pointer to the object to call the member function on
      *  @param mptr pointer to the member function to be called
      *  @param t the time between calls in micro-seconds
+     *  @param slack how late each call may be, in micro-seconds
      */
     template<typename T>
-    void attach_us(T* tptr, void (T::*mptr)(void), timestamp_t t) {
+    void attach_us(T* tptr, void (T::*mptr)(void), timestamp_t t, timestamp_t slack = 0) {
         _function.attach(tptr, mptr);
-        setup(t);
+        _context_function = NULL;
+        setup(t, slack);
+    }
+
+    /** Attach a function taking a context to be called by the Ticker,
+     *  specifiying the interval in seconds
+     *
+     *  @param fptr pointer to the function to be called
+     *  @param context the argument to call the function with
+     *  @param t the time between calls in seconds
+     */
+    void attach(void (*fptr)(void *), void *context, float t) {
+        attach_us(fptr, context, t * 1000000.0f);
+    }
+
+    /** Attach a function taking a context to be called by the Ticker,
+     *  specifiying the interval in micro-seconds
+     *
+     *  The function is called directly, rather than through a FunctionPointer,
+     *  which makes this the cheapest way to run a fast Ticker. A member
+     *  function can be called through a static wrapper given the object as
+     *  the context.
+     *
+     *  @param fptr pointer to the function to be called
+     *  @param context the argument to call the function with
+     *  @param t the time between calls in micro-seconds
+     *  @param slack how late each call may be, in micro-seconds
+     */
+    void attach_us(void (*fptr)(void *), void *context, timestamp_t t, timestamp_t slack = 0) {
+        _function.attach(0);
+        _context_function = fptr;
+        _context = context;
+        setup(t, slack);
     }
 
     virtual ~Ticker() {
@@ -114,12 +214,37 @@ public:
     void detach();
 
 protected:
-    void setup(timestamp_t t);
+    void setup(timestamp_t t, timestamp_t slack = 0);
     virtual void handler();
 
+    /* Call the function now, or post it to the scheduler, as set by dispatch() */
+    void run_or_defer();
+    void run_deferred();
+
+    bool attached() const {
+        return _context_function != NULL || _function;
+    }
+
+    void call() {
+        if (_context_function != NULL) {
+            _context_function(_context);
+        } else {
+            _function.call();
+        }
+    }
+
 protected:
     timestamp_t                _delay;     /**< Time delay (in microseconds) for re-setting the multi-shot callback. */
+    timestamp_t                _slack;     /**< How late (in microseconds) each callback may be made. */
+    timestamp_t                _deadline;  /**< When the pending callback is due, before any coalescing. */
     mbed::util::FunctionPointer _function;  /**< Callback. */
+    void (*_context_function)(void *);     /**< Callback taking a context, called instead of _function if set. */
+    void                       *_context;  /**< The context of _context_function. */
+    CompletionQueue::Slot      _slot;      /**< Where the scheduler dispatch is posted. */
+    volatile uint32_t          _overruns;  /**< Periods that had passed when scheduled. */
+    volatile uint32_t          _pending;   /**< Periods waiting for the scheduler dispatch. */
+    uint8_t                    _dispatch;  /**< A Dispatch. */
+    uint8_t                    _overrun;   /**< An Overrun. */
 };
 
 } // namespace mbed
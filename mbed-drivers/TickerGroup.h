@@ -0,0 +1,159 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_TICKERGROUP_H
+#define MBED_TICKERGROUP_H
+
+#include "TimerEvent.h"
+
+/* The most functions in one TickerGroup */
+#ifndef TICKER_GROUP_MAX_FUNCTIONS
+#define TICKER_GROUP_MAX_FUNCTIONS 8
+#endif
+
+namespace mbed {
+
+/** Functions called at periods that are multiples of one base period,
+ *  from a single timer event
+ *
+ * Where each Ticker takes its own place in the ticker queue and its own
+ * interrupt, a TickerGroup takes one of each at the base period, and calls
+ * each of its functions every divisor base periods. Each function also has
+ * a phase, the base period within its divisor that it is called on; by
+ * default one is chosen that shares base periods with as few of the
+ * other functions as it can, so that their work is spread out rather than
+ * piled on the same interrupts.
+ *
+ * The functions are called from the ticker interrupt, in the order they
+ * were attached, and may attach and detach functions themselves.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * TickerGroup group;
+ *
+ * void control(void *) {}      // every 1 ms
+ * void sensors(void *) {}      // every 10 ms
+ * void display(void *) {}      // every 50 ms, not alongside sensors
+ *
+ * void app_start(int, char**) {
+ *     group.attach(control, NULL, 1);
+ *     group.attach(sensors, NULL, 10);
+ *     group.attach(display, NULL, 50);
+ *     group.start(1000);
+ * }
+ * @endcode
+ */
+class TickerGroup : public TimerEvent {
+
+public:
+    /** The phase chosen to spread the functions out
+     */
+    static const uint32_t PHASE_AUTO = 0xFFFFFFFF;
+
+    TickerGroup();
+
+    TickerGroup(const ticker_data_t *const data);
+
+    virtual ~TickerGroup();
+
+    /** Start calling the functions
+     *
+     *  The first base period ends base_us after this is called.
+     *
+     *  @param base_us the base period in micro-seconds
+     */
+    void start(timestamp_t base_us);
+
+    /** Stop calling the functions, which stay attached
+     */
+    void stop();
+
+    /** Attach a function taking a context, to be called every divisor
+     *  base periods
+     *
+     *  @param fptr pointer to the function to be called
+     *  @param context the argument to call the function with
+     *  @param divisor the number of base periods between calls
+     *  @param phase the base period, counted from start() modulo divisor,
+     *    to call the function on, or PHASE_AUTO
+     *
+     *  @returns
+     *    An id for detach(), or -1 if the group is full or divisor is 0
+     */
+    int attach(void (*fptr)(void *), void *context, uint32_t divisor, uint32_t phase = PHASE_AUTO);
+
+    /** Attach a member function to be called every divisor base periods
+     *
+     *  @param tptr pointer to the object to call the member function on
+     *  @param divisor the number of base periods between calls
+     *  @param phase the base period to call the function on, or PHASE_AUTO
+     *
+     *  @returns
+     *    An id for detach(), or -1 if the group is full or divisor is 0
+     */
+    template<typename T, void (T::*M)(void)>
+    int attach(T *tptr, uint32_t divisor, uint32_t phase = PHASE_AUTO) {
+        return attach(&member_thunk<T, M>, tptr, divisor, phase);
+    }
+
+    /** Detach a function
+     *
+     *  @param id the id attach() returned
+     */
+    void detach(int id);
+
+    /** Get the phase a function is called on
+     *
+     *  @param id the id attach() returned
+     */
+    uint32_t phase(int id) const {
+        return _functions[id].phase;
+    }
+
+    /** Get the number of base periods that have ended since start()
+     */
+    uint32_t ticks() const {
+        return _tick;
+    }
+
+protected:
+    virtual void handler();
+
+    uint32_t choose_phase(uint32_t divisor) const;
+
+    template<typename T, void (T::*M)(void)>
+    static void member_thunk(void *context) {
+        (static_cast<T *>(context)->*M)();
+    }
+
+    struct function_t {
+        void (*function)(void *);   /**< NULL if the entry is free */
+        void *context;
+        uint32_t divisor;
+        uint32_t phase;
+        uint32_t next;              /**< The base period of the next call */
+    };
+
+    function_t _functions[TICKER_GROUP_MAX_FUNCTIONS];
+    timestamp_t _base;              /**< The base period in micro-seconds */
+    timestamp_t _deadline;          /**< When the current base period ends */
+    volatile uint32_t _tick;        /**< The next base period to end */
+};
+
+} // namespace mbed
+
+#endif
@@ -24,6 +24,9 @@ namespace mbed {
  *
  * You can use as many seperate Timeout objects as you require.
  *
+ * Like a Ticker's, the function is called from the ticker interrupt unless
+ * dispatch() moves it to the scheduler.
+ *
  * Example:
  * @code
  * // Blink until timeout.
@@ -50,6 +53,13 @@ namespace mbed {
  */
 class Timeout : public Ticker {
 
+public:
+    Timeout() : Ticker() {
+    }
+
+    Timeout(const ticker_data_t *const data) : Ticker(data) {
+    }
+
 protected:
     virtual void handler();
 };
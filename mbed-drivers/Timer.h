@@ -18,6 +18,9 @@
 
 #include "platform.h"
 #include "ticker_api.h"
+#include "ticker_api_ext.h"
+#include "us_ticker_api.h"
+#include "mbed_hal_inline.h"
 
 namespace mbed {
 
@@ -58,7 +61,8 @@ public:
 
     /** Reset the timer to 0.
      *
-     * If it was already counting, it will continue
+     * If it was already counting, it will continue. A stopped timer is
+     * reset without reading the ticker.
      */
     void reset();
 
@@ -74,16 +78,55 @@ public:
      */
     int read_us();
 
+    /** Get the time passed in micro-seconds, without wrapping
+     *
+     *  The ticker's own wrap event reads its counter every quarter period,
+     *  so the count stays correct however long the timer runs.
+     */
+    us_timestamp_t read_high_resolution_us();
+
+    /** Get the time passed in ticks of the timer's ticker
+     *
+     *  This uses integer arithmetic only, and reads the counter only while
+     *  the timer runs, straight from the us ticker when that is the timer's
+     *  ticker. The time since the timer was last started must be less than
+     *  one period of the counter (about 71 minutes for the us ticker); use
+     *  read_high_resolution_us() for longer.
+     */
+    uint64_t elapsed_ticks() {
+        if (_running) {
+            return _time + (timestamp_t)(ticks() - (timestamp_t)_start);
+        }
+        return _time;
+    }
+
+    /** Get the time passed in micro-seconds, as for elapsed_ticks()
+     *
+     *  The tickers count micro-seconds, so this is the same count.
+     */
+    uint64_t elapsed_us() {
+        return elapsed_ticks();
+    }
+
 #ifdef MBED_OPERATORS
     operator float();
 #endif
 
 protected:
-    int slicetime();
+    /* Read the counter of a ticker already initialized by start() */
+    timestamp_t ticks() const {
+        if (_us_ticker) {
+            return mbed_us_ticker_read();
+        }
+        return _ticker_data->interface->read();
+    }
+
+    us_timestamp_t slicetime();
     int _running;          // whether the timer is running
-    unsigned int _start;   // the start time of the latest slice
-    int _time;             // any accumulated time from previous slices
+    us_timestamp_t _start; // the start time of the latest slice
+    us_timestamp_t _time;  // any accumulated time from previous slices
     const ticker_data_t *const _ticker_data;
+    const bool _us_ticker;  // whether _ticker_data is the us ticker's
 };
 
 } // namespace mbed
@@ -16,7 +16,11 @@
 #ifndef MBED_TIMEREVENT_H
 #define MBED_TIMEREVENT_H
 
+#include "platform.h"
 #include "ticker_api.h"
+#include "ticker_api_ext.h"
+#include "mbed_sleep.h"
+#include "CompletionQueue.h"
 
 namespace mbed {
 
@@ -27,10 +31,25 @@ public:
     TimerEvent();
     TimerEvent(const ticker_data_t *data);
 
-    /** The handler registered with the underlying timer interrupt
+    /** The handler of every TimerEvent's ticker event, or of its ticker's
+     *  queue without DEVICE_TICKER_EVENT_EXTENDED
      */
     static void irq(uint32_t id);
 
+    /** Make the event soft, or hard again
+     *
+     *  Events are hard by default, and their handler runs in the ticker
+     *  interrupt. Once a soft event expires, its handler is posted to the
+     *  scheduler through the CompletionQueue instead, so a heavy handler
+     *  can't hold off the hard events that become due while it runs. It
+     *  runs as late as the scheduler takes to get to it.
+     *
+     *  @param soft true for a soft event, false for a hard one
+     */
+    void set_soft(bool soft) {
+        _soft = soft;
+    }
+
     /** Destruction removes it...
      */
     virtual ~TimerEvent();
@@ -42,12 +61,49 @@ protected:
     // insert in to linked list
     void insert(timestamp_t timestamp);
 
+    // insert in to linked list, allowing the event to fire up to slack
+    // microseconds late so it can share an interrupt with another event
+    void insert(timestamp_t timestamp, timestamp_t slack);
+
+    // insert in to linked list, at a 64-bit time that may be any distance
+    // away. Far events are reached in steps of TIMER_EVENT_MAX_STEP_US, or
+    // with DEVICE_RTC_ALARM, wait on the RTC alarm until they are near.
+    void insert_us(us_timestamp_t timestamp);
+
     // remove from linked list, if in it
     void remove();
 
+    // take the deep sleep lock if queued on the us ticker
+    void lock_deep_sleep();
+
     ticker_event_t event;
 
+    us_timestamp_t _target;  // when an event inserted by insert_us is due
+    bool _stepping;          // whether event is an intermediate step towards _target
+    bool _soft;              // whether the handler runs from the scheduler
+    CompletionQueue::Slot _soft_slot;   // bound to handler(), for a soft event
+    DeepSleepLock _deep_sleep;  // held while queued on the us ticker, which deep sleep stops
+
     const ticker_data_t *const _ticker_data;
+
+#if DEVICE_RTC_ALARM
+    // wait on the RTC alarm for an event remaining microseconds away
+    void park(us_timestamp_t remaining);
+
+    // stop waiting on the RTC alarm, if waiting
+    void unpark();
+
+    // set the RTC alarm for the first event waiting on it
+    static void arm_rtc();
+
+    // move the events that are near from the RTC alarm to their tickers
+    static void rtc_alarm_irq();
+
+    static TimerEvent *_parked;     // the events waiting on the RTC alarm, soonest first
+    TimerEvent *_next_parked;
+    uint64_t _rtc_due_us;           // when a parked event is due, on the RTC
+    bool _is_parked;
+#endif
 };
 
 } // namespace mbed
@@ -0,0 +1,169 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_TRACEOUTPUT_H
+#define MBED_TRACEOUTPUT_H
+
+#include "platform.h"
+#include "FileHandle.h"
+#include "cmsis.h"
+
+/* Whether the core has the ITM (Cortex-M3 and above) */
+#ifndef TRACE_ITM
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3)
+#define TRACE_ITM 1
+#else
+#define TRACE_ITM 0
+#endif
+#endif
+
+/* The size of the RTT ring the probe reads output from, in bytes */
+#ifndef RTT_UP_BUFFER_SIZE
+#define RTT_UP_BUFFER_SIZE 1024
+#endif
+
+/* The size of the RTT ring the probe writes input to, in bytes */
+#ifndef RTT_DOWN_BUFFER_SIZE
+#define RTT_DOWN_BUFFER_SIZE 16
+#endif
+
+/* With RTT_BLOCK_IF_FULL set, output waits for the probe to make room in
+ * the ring, rather than what does not fit being dropped. Without a probe
+ * attached, output then stops at the first full ring */
+#ifndef RTT_BLOCK_IF_FULL
+#define RTT_BLOCK_IF_FULL 0
+#endif
+
+namespace mbed {
+
+#if TRACE_ITM
+/** Output through an ITM stimulus port, to the probe's SWO pin
+ *
+ * Each write is a few stores to the stimulus port, a word at a time, with
+ * no semihosting trap and no waiting on a UART. Nothing is written, and
+ * writes return at once, while the debugger has not enabled the ITM and
+ * the port. The SWO pin and its baud rate are set up by the debugger, or
+ * by the target's startup code.
+ *
+ * Example:
+ * @code
+ * ITMFileHandle itm;
+ * mbed::set_stdio(1, &itm);     // stdout only
+ * @endcode
+ */
+class ITMFileHandle : public FileHandle {
+public:
+    /** Create an ITM output
+     *
+     *  @param port The stimulus port, 0 to 31; 0 is the one viewers show by
+     *    default
+     */
+    ITMFileHandle(unsigned port = 0) : _port(port) {
+    }
+
+    virtual ssize_t write(const void *buffer, size_t length);
+
+    /** ITM is output only, so there is never anything to read */
+    virtual ssize_t read(void *buffer, size_t length) {
+        (void)buffer;
+        (void)length;
+        return 0;
+    }
+
+    virtual int close() {
+        return 0;
+    }
+
+    virtual int isatty() {
+        return 1;
+    }
+
+    virtual off_t lseek(off_t offset, int whence) {
+        (void)offset;
+        (void)whence;
+        return -1;
+    }
+
+    virtual int fsync() {
+        return 0;
+    }
+
+    /** Check whether the debugger has enabled the ITM and this port
+     */
+    bool enabled() const {
+        return (ITM->TCR & ITM_TCR_ITMENA_Msk) && (ITM->TER & (1UL << _port));
+    }
+
+protected:
+    unsigned _port;
+};
+#endif
+
+/** Output to, and input from, a SEGGER RTT compatible control block in RAM
+ *
+ * Writes are a copy into a ring in RAM, which the debug probe reads in the
+ * background through the debug port, so output costs little more than a
+ * memcpy and does not stop the core. The control block is found by the
+ * probe by scanning RAM for its ID, or by the _SEGGER_RTT symbol. There is
+ * one control block, with one ring each way, shared by every
+ * RTTFileHandle.
+ *
+ * Unless RTT_BLOCK_IF_FULL is set, output that does not fit in the ring is
+ * dropped, and counted by dropped().
+ *
+ * Example:
+ * @code
+ * RTTFileHandle rtt;
+ * mbed::set_stdio(&rtt);
+ * @endcode
+ */
+class RTTFileHandle : public FileHandle {
+public:
+    /** Create an RTT channel, setting up the control block if it is the first
+     */
+    RTTFileHandle();
+
+    virtual ssize_t write(const void *buffer, size_t length);
+
+    /** Read what the probe has sent, waiting for at least one byte
+     */
+    virtual ssize_t read(void *buffer, size_t length);
+
+    virtual int close() {
+        return 0;
+    }
+
+    virtual int isatty() {
+        return 1;
+    }
+
+    virtual off_t lseek(off_t offset, int whence) {
+        (void)offset;
+        (void)whence;
+        return -1;
+    }
+
+    virtual int fsync() {
+        return 0;
+    }
+
+    /** Get the number of bytes of output dropped because the ring was full
+     */
+    static uint32_t dropped();
+};
+
+} // namespace mbed
+
+#endif
@@ -63,6 +63,14 @@ public:
         return _obj;
     }
 
+    /** Set the object's instance for the transaction
+     *
+     * With get_transaction(), this fills in a transaction in place.
+     */
+    void set_object(Class *tpointer) {
+        _obj = tpointer;
+    }
+
     /** Get the transaction
      *
      * @return The transaction which was stored
@@ -0,0 +1,243 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_TRIGGERLINK_H
+#define MBED_TRIGGERLINK_H
+
+#include "platform.h"
+#include "Buffer.h"
+#include "CompletionQueue.h"
+#include "Ticker.h"
+#include "core-util/FunctionPointer.h"
+
+#if DEVICE_INTERRUPTIN
+#include "InterruptIn.h"
+#endif
+#if DEVICE_SPI
+#include "SPI.h"
+#endif
+#if DEVICE_ANALOGIN
+#include "AnalogIn.h"
+#endif
+#if DEVICE_PWMOUT
+#include "PwmOut.h"
+#endif
+#if DEVICE_TRIGGER_LINK
+#include "trigger_link_api.h"
+#endif
+
+namespace mbed {
+
+/** Starts a peripheral action on a pin edge or a timer period
+ *
+ * A TriggerLink connects one source, an InterruptIn edge or a Ticker
+ * period, to one action: an SPI transfer, an AnalogIn conversion or a
+ * PwmOut duty cycle. On targets with DEVICE_TRIGGER_LINK, enable() first
+ * asks the event routing hardware (a PPI or event system channel) to
+ * connect the two, so that the action starts with no CPU involvement at
+ * all. Where the hardware can't make the connection, the source's
+ * interrupt starts the action itself, from the fastest path the source
+ * has: a Ticker calls the link directly, with no FunctionPointer, and an
+ * InterruptIn adds it as an edge handler.
+ *
+ * Routed in hardware, the link owns the action's peripheral: don't start
+ * other transfers or conversions on it until disable(). A Ticker source is
+ * then replaced by a timer of the hardware's own, and the Ticker is left
+ * alone. In software, an SPI transfer is queued like any other, and an
+ * AnalogIn conversion is made by read_u16() in the interrupt.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ * #include "mbed-drivers/TriggerLink.h"
+ *
+ * InterruptIn data_ready(D2);
+ * SPI spi(SPI_MOSI, SPI_MISO, SPI_SCK);
+ * TriggerLink link;
+ * uint8_t sample[6];
+ *
+ * void got_sample() {
+ *     printf("%02x%02x\r\n", sample[0], sample[1]);
+ * }
+ *
+ * void app_start(int, char**) {
+ *     link.from(data_ready, IRQ_RISE);
+ *     link.to(spi, Buffer(), Buffer(sample, sizeof(sample)));
+ *     link.enable(got_sample);
+ * }
+ * @endcode
+ */
+class TriggerLink {
+
+public:
+    /** The function called from the scheduler after each action
+     */
+    typedef mbed::util::FunctionPointer0<void> done_callback_t;
+
+    TriggerLink();
+
+    virtual ~TriggerLink();
+
+#if DEVICE_INTERRUPTIN
+    /** Trigger the action on an edge of an input
+     *
+     *  @param in The input
+     *  @param edge IRQ_RISE or IRQ_FALL
+     *
+     *  @returns
+     *    0 on success, -1 if the link is enabled
+     */
+    int from(InterruptIn &in, gpio_irq_event edge = IRQ_RISE);
+#endif
+
+    /** Trigger the action periodically
+     *
+     *  @param ticker The Ticker to call the link from, in software
+     *  @param period_us The time between triggers in micro-seconds
+     *
+     *  @returns
+     *    0 on success, -1 if the link is enabled
+     */
+    int from(Ticker &ticker, timestamp_t period_us);
+
+#if DEVICE_SPI_ASYNCH
+    /** Make an SPI transfer on each trigger
+     *
+     *  @param spi The SPI master
+     *  @param tx The transmit buffer, or an empty one
+     *  @param rx The receive buffer, or an empty one
+     *
+     *  @returns
+     *    0 on success, -1 if the link is enabled
+     */
+    int to(SPI &spi, const Buffer &tx, const Buffer &rx);
+#endif
+
+#if DEVICE_ANALOGIN
+    /** Convert an analog input on each trigger
+     *
+     *  @param in The analog input
+     *  @param sample Where to store each sample, as read_u16() returns it
+     *
+     *  @returns
+     *    0 on success, -1 if the link is enabled
+     */
+    int to(AnalogIn &in, uint16_t *sample);
+#endif
+
+#if DEVICE_PWMOUT
+    /** Set a PWM output's duty cycle on each trigger
+     *
+     *  @param out The PWM output
+     *  @param value The duty cycle, as for PwmOut::write()
+     *
+     *  @returns
+     *    0 on success, -1 if the link is enabled
+     */
+    int to(PwmOut &out, float value);
+#endif
+
+    /** Connect the source to the action
+     *
+     *  @param done Called from the scheduler after each action, if set
+     *
+     *  @returns
+     *    0 on success, -1 if the link is enabled or lacks a source or action
+     */
+    int enable(const done_callback_t &done = done_callback_t((void (*)(void))NULL));
+
+    /** Disconnect the source from the action
+     *
+     *  An action already started completes.
+     */
+    void disable();
+
+    /** Check if the link is routed in hardware
+     *
+     *  @returns
+     *    true if enabled with no software in the path
+     */
+    bool hardware() const {
+        return _hardware;
+    }
+
+protected:
+    enum {
+        SOURCE_NONE,
+        SOURCE_PIN,
+        SOURCE_TICKER
+    };
+
+    enum {
+        ACTION_NONE,
+        ACTION_SPI,
+        ACTION_ADC,
+        ACTION_PWM
+    };
+
+    static void fire_context(void *context);
+    void fire();
+    void signal();
+    void deliver();
+#if DEVICE_SPI_ASYNCH
+    void spi_done(Buffer tx, Buffer rx, int event);
+#endif
+#if DEVICE_TRIGGER_LINK
+    int route();
+    static void hw_done(uint32_t id);
+#endif
+
+    uint8_t _source;
+    uint8_t _action;
+    bool _enabled;
+    bool _hardware;
+
+#if DEVICE_INTERRUPTIN
+    InterruptIn *_in;
+    gpio_irq_event _edge;
+    pFunctionPointer_t _handler;    // the edge handler, in software
+#endif
+    Ticker *_ticker;
+    timestamp_t _period_us;
+
+#if DEVICE_SPI_ASYNCH
+    SPI *_spi;
+    Buffer _tx;
+    Buffer _rx;
+#endif
+#if DEVICE_ANALOGIN
+    AnalogIn *_adc;
+    uint16_t *_sample;
+#endif
+#if DEVICE_PWMOUT
+    PwmOut *_pwm;
+    float _value;
+#endif
+
+    done_callback_t _done;
+    CompletionQueue::Slot _done_signal;     // bound to deliver() once
+#if DEVICE_TRIGGER_LINK
+    trigger_link_t _link;
+#endif
+
+private:
+    /* disallow copy constructor and assignment operators */
+    TriggerLink(const TriggerLink&);
+    TriggerLink & operator = (const TriggerLink&);
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,116 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_USBSERIAL_H
+#define MBED_USBSERIAL_H
+
+#include "platform.h"
+
+#if DEVICE_USB_CDC
+
+#include "Stream.h"
+#include "SPSCCircularBuffer.h"
+#include "usb_cdc_api.h"
+
+/* Data written is queued in a ring of this many bytes (a power of two), and
+ * sent a packet at a time from the USB interrupt */
+#ifndef USBSERIAL_TX_BUFFER_SIZE
+#define USBSERIAL_TX_BUFFER_SIZE 512
+#endif
+
+/* Received packets are moved into a ring of this many bytes (a power of
+ * two), at least USB_CDC_MAX_PACKET. While it has no room for a whole
+ * packet, the host is held off rather than data being dropped */
+#ifndef USBSERIAL_RX_BUFFER_SIZE
+#define USBSERIAL_RX_BUFFER_SIZE 256
+#endif
+
+namespace mbed {
+
+/** A virtual serial port over USB, enumerating as a CDC-ACM device
+ *
+ * Writes are queued in the TX ring and sent as full packets where there is
+ * enough data queued, so a write of a block costs a copy rather than a
+ * wait per character as on a UART. Received packets are moved into the RX
+ * ring by the USB interrupt. The port is a Stream, so it can be used with
+ * printf() and scanf() directly, or made the stdio console with
+ * mbed::set_stdio().
+ *
+ * Output written while no terminal has the port open (the host has not set
+ * DTR) is dropped, so that a console with nothing listening does not hold
+ * up the application.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * USBSerial usb;
+ *
+ * void app_start(int, char **) {
+ *     mbed::set_stdio(&usb);
+ *     printf("Hello over USB\r\n");
+ * }
+ * @endcode
+ */
+class USBSerial : public Stream {
+
+public:
+    /** Create the virtual serial port, and connect to the host
+     *
+     *  @param name The name of the port in the filesystem, or NULL
+     */
+    USBSerial(const char *name = NULL);
+
+    virtual ~USBSerial();
+
+    /** Check whether a terminal on the host has the port open
+     */
+    bool connected();
+
+    /** Get the number of received bytes waiting to be read
+     */
+    int readable();
+
+    /** Get the room left in the TX ring, in bytes
+     */
+    int writeable();
+
+protected:
+    virtual int _putc(int c);
+    virtual int _getc();
+    virtual ssize_t _write(const void *buffer, size_t length);
+    virtual ssize_t _read(void *buffer, size_t length);
+
+    /** Start sending the next packet, unless one is already in flight */
+    void tx_start();
+
+    /** Move received packets into the RX ring while it has room for them */
+    void rx_poll();
+
+    static void _irq_handler(uint32_t id, usb_cdc_event_t event);
+
+    usb_cdc_t _usb;
+    volatile bool _tx_busy;
+    char _tx_packet[USB_CDC_MAX_PACKET];
+    char _rx_packet[USB_CDC_MAX_PACKET];
+    SPSCCircularBuffer<char, USBSERIAL_TX_BUFFER_SIZE> _tx_buffer;
+    SPSCCircularBuffer<char, USBSERIAL_RX_BUFFER_SIZE> _rx_buffer;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_WATCHDOG_H
+#define MBED_WATCHDOG_H
+
+#include "platform.h"
+
+#if DEVICE_WATCHDOG
+
+#include <stdint.h>
+
+namespace mbed {
+
+/** The hardware watchdog, kicked only while every subsystem is alive
+ *
+ * Each subsystem that must not stall takes a liveness flag with add(), and
+ * sets it with alive() as it makes progress. The watchdog is serviced
+ * before the idle loop sleeps and from one timer event: it is kicked only
+ * if every flag has been set since the last kick, and the flags are then
+ * cleared. A subsystem that stops calling alive() therefore stops the kicks,
+ * and the watchdog resets the system.
+ *
+ * The timer event is queued every half timeout with a quarter timeout of
+ * slack, so it shares its interrupt with other timer events where it can
+ * and costs no wakeup of its own; where the target has one it is on the low
+ * power ticker, which runs in deep sleep. Each subsystem must call alive()
+ * at least every quarter of the timeout.
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * int radio;
+ *
+ * void radio_poll() {
+ *     // ...
+ *     Watchdog::alive(radio);
+ * }
+ *
+ * void app_start(int, char**) {
+ *     radio = Watchdog::add();
+ *     Watchdog::start(2000);
+ *     minar::Scheduler::postCallback(radio_poll).period(minar::milliseconds(100));
+ * }
+ * @endcode
+ */
+class Watchdog {
+public:
+    /** The most liveness flags
+     */
+    static const int MAX_FLAGS = 32;
+
+    /** Start the hardware watchdog
+     *
+     *  Once started it cannot be stopped.
+     *
+     *  @param timeout_ms How long without a kick before it resets the system
+     *
+     *  @returns
+     *    0 on success, -1 if the hardware cannot take the timeout
+     */
+    static int start(uint32_t timeout_ms);
+
+    /** Take a liveness flag
+     *
+     *  The flag counts as set until the next kick, so adding one does not
+     *  hold off the kick that is due.
+     *
+     *  @returns
+     *    The flag for alive() and remove(), or -1 if all are taken
+     */
+    static int add();
+
+    /** Give up a liveness flag
+     *
+     *  @param flag The flag add() returned
+     */
+    static void remove(int flag);
+
+    /** Set a liveness flag
+     *
+     *  This can be called from interrupt handlers.
+     *
+     *  @param flag The flag add() returned
+     */
+    static void alive(int flag);
+
+    /** Kick the watchdog if every flag has been set since the last kick
+     *
+     *  This is called before the idle loop sleeps and from the timer event,
+     *  but may be called from anywhere else too.
+     *
+     *  @returns
+     *    true if the watchdog was kicked
+     */
+    static bool service();
+
+    /** Get the number of times the timer event found a flag not set, and
+     *  did not kick the watchdog
+     */
+    static uint32_t misses();
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DMA_CACHE_H
+#define MBED_DMA_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cmsis.h"
+#include "compiler-polyfill/attributes.h"
+
+/** DMA buffers and the data cache
+ *
+ * On cores with a data cache (Cortex-M7), DMA reads and writes memory
+ * behind the cache's back. Before a transfer out of a buffer, its dirty
+ * lines have to be written back (cleaned); after a transfer into a buffer,
+ * its stale lines have to be dropped (invalidated). The asynchronous SPI,
+ * I2C and serial transfers do this themselves. On cores without a data
+ * cache, these functions compile to nothing.
+ *
+ * Invalidating works on whole cache lines, so a receive buffer should not
+ * share a line with other data: declare it with DMA_CACHE_BUFFER, or align
+ * it with DMA_CACHE_ALIGN and size it with DMA_CACHE_SIZE.
+ *
+ * Example:
+ * @code
+ * DMA_CACHE_BUFFER(rx, 20);
+ *
+ * spi.transfer().rx(rx, 20).callback(done).apply();
+ * @endcode
+ */
+
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+#define DMA_CACHE_MAINTENANCE 1
+#define DMA_CACHE_LINE_SIZE 32
+#else
+#define DMA_CACHE_MAINTENANCE 0
+#define DMA_CACHE_LINE_SIZE 4
+#endif
+
+/** Round a size in bytes up to a whole number of cache lines */
+#define DMA_CACHE_SIZE(size) ((((size) + DMA_CACHE_LINE_SIZE - 1) / DMA_CACHE_LINE_SIZE) * DMA_CACHE_LINE_SIZE)
+
+/** Align a declaration to a cache line */
+#define DMA_CACHE_ALIGN __align(DMA_CACHE_LINE_SIZE)
+
+/** Declare a byte buffer that has whole cache lines to itself */
+#define DMA_CACHE_BUFFER(name, size) DMA_CACHE_ALIGN uint8_t name[DMA_CACHE_SIZE(size)]
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if DMA_CACHE_MAINTENANCE
+static inline void dma_cache_range(const volatile void *buffer, size_t length, uint32_t *start, int32_t *size)
+{
+    // an unaligned buffer still covers every line it touches
+    *start = (uint32_t)buffer & ~(uint32_t)(DMA_CACHE_LINE_SIZE - 1);
+    *size = (int32_t)(((uint32_t)buffer + length) - *start);
+}
+#endif
+
+/** Write back a buffer before DMA reads it
+ *
+ * @param buffer The buffer, or NULL
+ * @param length The length of the buffer in bytes
+ */
+static inline void dma_cache_clean(const volatile void *buffer, size_t length)
+{
+#if DMA_CACHE_MAINTENANCE
+    if (buffer != NULL && length) {
+        uint32_t start;
+        int32_t size;
+        dma_cache_range(buffer, length, &start, &size);
+        SCB_CleanDCache_by_Addr((uint32_t *)start, size);
+    }
+#else
+    (void)buffer;
+    (void)length;
+#endif
+}
+
+/** Write back and drop a buffer before DMA writes it
+ *
+ * This stops a dirty line being evicted over the data the DMA writes.
+ *
+ * @param buffer The buffer, or NULL
+ * @param length The length of the buffer in bytes
+ */
+static inline void dma_cache_clean_invalidate(volatile void *buffer, size_t length)
+{
+#if DMA_CACHE_MAINTENANCE
+    if (buffer != NULL && length) {
+        uint32_t start;
+        int32_t size;
+        dma_cache_range(buffer, length, &start, &size);
+        SCB_CleanInvalidateDCache_by_Addr((uint32_t *)start, size);
+    }
+#else
+    (void)buffer;
+    (void)length;
+#endif
+}
+
+/** Drop a buffer after DMA has written it
+ *
+ * This discards lines the core may have fetched speculatively during the
+ * transfer, so the next read sees what the DMA wrote.
+ *
+ * @param buffer The buffer, or NULL
+ * @param length The length of the buffer in bytes
+ */
+static inline void dma_cache_invalidate(volatile void *buffer, size_t length)
+{
+#if DMA_CACHE_MAINTENANCE
+    if (buffer != NULL && length) {
+        uint32_t start;
+        int32_t size;
+        dma_cache_range(buffer, length, &start, &size);
+        SCB_InvalidateDCache_by_Addr((uint32_t *)start, size);
+    }
+#else
+    (void)buffer;
+    (void)length;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
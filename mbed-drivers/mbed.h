@@ -33,11 +33,14 @@
 #include "mbed_error.h"
 #include "mbed_interface.h"
 #include "mbed_assert.h"
+#include "mbed_sleep.h"
 
 // mbed Peripheral components
 #include "DigitalIn.h"
 #include "DigitalOut.h"
 #include "DigitalInOut.h"
+#include "FastDigitalOut.h"
+#include "FastDigitalIn.h"
 #include "BusIn.h"
 #include "BusOut.h"
 #include "BusInOut.h"
@@ -45,18 +48,48 @@
 #include "PortInOut.h"
 #include "PortOut.h"
 #include "AnalogIn.h"
+#include "AnalogInGroup.h"
+#include "SampleFilter.h"
 #include "AnalogOut.h"
 #include "PwmOut.h"
+#include "PwmOutGroup.h"
+#include "PwmIn.h"
+#include "AutoBaud.h"
+#include "QEI.h"
 #include "Serial.h"
 #include "SPI.h"
+#include "SPIDevice.h"
+#include "SPISlave.h"
+#include "QSPI.h"
 #include "I2C.h"
+#include "I2CSlave.h"
+#include "CAN.h"
 #include "RawSerial.h"
+#include "BufferedSerial.h"
+#include "LineAssembler.h"
+#include "Framing.h"
+#include "FramedSerial.h"
+#include "USBSerial.h"
+#include "CRC.h"
+#include "DMACopy.h"
+#include "TraceOutput.h"
 
 // mbed Internal components
 #include "Timer.h"
+#include "CycleTimer.h"
 #include "Ticker.h"
 #include "Timeout.h"
+#include "TickerGroup.h"
+#include "LowPowerTicker.h"
+#include "LowPowerTimeout.h"
+#include "RtcAlarm.h"
+#include "Watchdog.h"
+#include "DeferredInit.h"
+#include "HardwareTimeout.h"
+#include "LowPowerTimer.h"
 #include "InterruptIn.h"
+#include "TriggerLink.h"
+#include "OneWire.h"
 #include "wait_api.h"
 #include "sleep_api.h"
 #include "rtc_time.h"
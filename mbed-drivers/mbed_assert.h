@@ -35,9 +35,19 @@ void mbed_assert_internal(const char *expr, const char *file, int line);
 }
 #endif
 
+#include "mbed_fault.h"
+
 #ifdef NDEBUG
 #define MBED_ASSERT(expr) ((void)0)
 
+#elif MBED_COMPACT_ERRORS
+#define MBED_ASSERT(expr)                                \
+do {                                                     \
+    if (!(expr)) {                                       \
+        MBED_ERROR_COMPACT(MBED_FAULT_CODE_ASSERT);      \
+    }                                                    \
+} while (0)
+
 #else
 #define MBED_ASSERT(expr)                                \
 do {                                                     \
@@ -0,0 +1,154 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_CRITICAL_H
+#define MBED_CRITICAL_H
+
+#include <stdint.h>
+#include "cmsis.h"
+
+/** Nestable critical sections
+ *
+ * By default a critical section masks every interrupt with PRIMASK. On
+ * Cortex-M3 and up, setting CRITICAL_SECTION_BASEPRI to a priority masks
+ * only the interrupts at that priority or below (that is, with a priority
+ * value at least as large) with BASEPRI, so more urgent interrupts keep
+ * their latency. Those interrupts must then never use the ticker or the
+ * drivers, and the drivers' own interrupts (the us ticker, SPI, I2C and
+ * serial) must be set to a priority the critical sections mask.
+ *
+ * Either way, critical sections nest: leaving one restores the mask that
+ * was in place when it was entered.
+ *
+ * Example:
+ * @code
+ * uint32_t state = mbed_critical_enter();
+ * // ...
+ * mbed_critical_exit(state);
+ * @endcode
+ */
+
+/* The priority, counting from 0 for the most urgent, at and below which
+ * critical sections mask interrupts. 0 masks every interrupt. */
+#ifndef CRITICAL_SECTION_BASEPRI
+#define CRITICAL_SECTION_BASEPRI 0
+#endif
+
+#if CRITICAL_SECTION_BASEPRI && defined(__CORTEX_M) && (__CORTEX_M >= 3)
+#define CRITICAL_SECTION_USE_BASEPRI 1
+#else
+#define CRITICAL_SECTION_USE_BASEPRI 0
+#endif
+
+/* When INTERRUPT_PRIORITY_CLASSES is set, the drivers set the priority of
+ * their interrupts to these classes, counting from 0 for the most urgent:
+ * the us ticker above serial ports, serial ports above I2C, and I2C above
+ * SPI. They start from CRITICAL_SECTION_BASEPRI, so that critical sections
+ * still mask every driver interrupt, and leave the levels above free for
+ * the application. This needs the HAL to give the interrupt of each
+ * peripheral, through us_ticker_irq_number(), serial_irq_number(),
+ * i2c_irq_number() and spi_irq_number(). The us ticker's is set once, when
+ * the ticker is first used, and the others as each driver is created.
+ */
+#ifndef INTERRUPT_PRIORITY_CLASSES
+#define INTERRUPT_PRIORITY_CLASSES 0
+#endif
+
+#ifndef IRQ_PRIORITY_TICKER
+#define IRQ_PRIORITY_TICKER (CRITICAL_SECTION_BASEPRI + 0)
+#endif
+
+#ifndef IRQ_PRIORITY_SERIAL
+#define IRQ_PRIORITY_SERIAL (CRITICAL_SECTION_BASEPRI + 1)
+#endif
+
+#ifndef IRQ_PRIORITY_I2C
+#define IRQ_PRIORITY_I2C (CRITICAL_SECTION_BASEPRI + 2)
+#endif
+
+#ifndef IRQ_PRIORITY_SPI
+#define IRQ_PRIORITY_SPI (CRITICAL_SECTION_BASEPRI + 3)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Enter a critical section
+ *
+ * @returns The state to pass to mbed_critical_exit()
+ */
+static inline uint32_t mbed_critical_enter(void)
+{
+#if CRITICAL_SECTION_USE_BASEPRI
+    uint32_t state = __get_BASEPRI();
+    // only ever raises the mask, so a nested section can't lower it
+    __set_BASEPRI_MAX(CRITICAL_SECTION_BASEPRI << (8 - __NVIC_PRIO_BITS));
+    __ISB();
+    return state;
+#else
+    uint32_t state = __get_PRIMASK();
+    __disable_irq();
+    return state;
+#endif
+}
+
+/** Leave a critical section
+ *
+ * @param state The state returned by the matching mbed_critical_enter()
+ */
+static inline void mbed_critical_exit(uint32_t state)
+{
+#if CRITICAL_SECTION_USE_BASEPRI
+    __set_BASEPRI(state);
+#else
+    if (!state) {
+        __enable_irq();
+    }
+#endif
+}
+
+#ifdef __cplusplus
+}
+
+namespace mbed {
+
+/** A critical section for the lifetime of the object
+ *
+ * This masks interrupts as mbed_critical_enter() does, so with
+ * CRITICAL_SECTION_BASEPRI set it leaves the more urgent interrupts alone,
+ * unlike mbed::util::CriticalSectionLock.
+ */
+class CriticalSection {
+public:
+    CriticalSection() : _state(mbed_critical_enter()) {
+    }
+
+    ~CriticalSection() {
+        mbed_critical_exit(_state);
+    }
+
+private:
+    uint32_t _state;
+
+    /* disallow copy constructor and assignment operators */
+    CriticalSection(const CriticalSection&);
+    CriticalSection & operator = (const CriticalSection&);
+};
+
+} // namespace mbed
+#endif
+
+#endif
@@ -16,6 +16,40 @@
 #ifndef MBED_DEBUG_H
 #define MBED_DEBUG_H
 #include "device.h"
+#include "mbed_printf.h"
+#include <stdint.h>
+
+/* Deferred log levels. Messages above MBED_LOG_LEVEL are compiled out. */
+#define MBED_LOG_LEVEL_NONE     0
+#define MBED_LOG_LEVEL_ERROR    1
+#define MBED_LOG_LEVEL_WARN     2
+#define MBED_LOG_LEVEL_INFO     3
+#define MBED_LOG_LEVEL_DEBUG    4
+
+#ifndef MBED_LOG_LEVEL
+#define MBED_LOG_LEVEL MBED_LOG_LEVEL_DEBUG
+#endif
+
+/* The number of messages that can wait to be printed, a power of two */
+#ifndef MBED_LOG_QUEUE_SIZE
+#define MBED_LOG_QUEUE_SIZE 16
+#endif
+
+/* The most arguments a deferred message can have */
+#ifndef MBED_LOG_MAX_ARGS
+#define MBED_LOG_MAX_ARGS 6
+#endif
+
+/* When set, debug(), error() and the deferred log send each message as a
+ * binary frame holding the format string's address and the argument words,
+ * rather than as text. scripts/mbed_trace_decode.py expands the frames using
+ * the ELF file of the image. Arguments are limited as for mbed_log_deferred.
+ */
+#ifndef MBED_TRACE_TOKENIZED
+#define MBED_TRACE_TOKENIZED 0
+#endif
+
+#define MBED_TRACE_FRAME_START 0xA5
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,6 +59,28 @@ extern "C" {
 #include <stdio.h>
 #include <stdarg.h>
 
+/** Count the argument words a printf-style format string takes
+ *
+ * @param format printf-style format string
+ * @returns The number of conversions, plus one for each '*' width or precision
+ */
+int mbed_format_arg_words(const char *format);
+
+/** Send a tokenized trace frame to stderr
+ *
+ * @param format printf-style format string, which is not read
+ * @param args The argument words
+ * @param count The number of argument words, up to MBED_LOG_MAX_ARGS
+ */
+void mbed_trace_frame(const char *format, const uint32_t *args, int count);
+
+/** Send a message to stderr as a tokenized trace frame
+ *
+ * @param format printf-style format string
+ * @param args The arguments, each of one word
+ */
+void mbed_trace_vtokenized(const char *format, va_list args);
+
 /** Output a debug message
  *
  * @param format printf-style format string, followed by variables
@@ -32,7 +88,13 @@ extern "C" {
 static inline void debug(const char *format, ...) {
     va_list args;
     va_start(args, format);
+#if MBED_TRACE_TOKENIZED
+    mbed_trace_vtokenized(format, args);
+#elif MBED_MINIMAL_STDIO
+    mbed_vdprintf(2, format, args);
+#else
     vfprintf(stderr, format, args);
+#endif
     va_end(args);
 }
 
@@ -48,17 +110,88 @@ static inline void debug_if(int condition, const char *format, ...) {
     if (condition == 1) {
         va_list args;
         va_start(args, format);
+#if MBED_TRACE_TOKENIZED
+        mbed_trace_vtokenized(format, args);
+#elif MBED_MINIMAL_STDIO
+        mbed_vdprintf(2, format, args);
+#else
         vfprintf(stderr, format, args);
+#endif
         va_end(args);
     }
 }
 
+/** Queue a debug message to be printed later, from the scheduler
+ *
+ * Only the format pointer and the argument words are stored, so this is
+ * cheap enough to call from any context, including interrupt handlers, and
+ * does not change the caller's timing the way debug() does. Every argument
+ * must be one word: integers of up to 32 bits, characters and pointers.
+ * Strings passed for %s must still exist when the message is printed, so
+ * should be literals. If the queue is full, the message is dropped.
+ *
+ * Use the MBED_LOG_* macros, so that disabled levels compile to nothing.
+ *
+ * @param level The MBED_LOG_LEVEL_* of the message
+ * @param format printf-style format string, followed by variables
+ */
+void mbed_log_deferred(int level, const char *format, ...);
+
+/** Print every queued message now, for example before a reset
+ */
+void mbed_log_flush(void);
+
+/** Get the number of messages dropped because the queue was full
+ */
+uint32_t mbed_log_dropped(void);
+
+/** Copy the queued messages without printing them, for example into a crash dump
+ *
+ * Each message is copied as its format pointer followed by
+ * MBED_LOG_MAX_ARGS argument words, oldest first, so that the messages
+ * can be printed later using the image's symbols. Messages still being
+ * written are skipped.
+ *
+ * @param buffer Receives the words
+ * @param words The room in buffer, in words
+ * @returns The number of words copied
+ */
+uint32_t mbed_log_snapshot(uint32_t *buffer, uint32_t words);
+
 #else
 static inline void debug(const char *format, ...) {}
 static inline void debug_if(int condition, const char *format, ...) {}
+static inline void mbed_log_deferred(int level, const char *format, ...) {}
+static inline void mbed_log_flush(void) {}
+static inline uint32_t mbed_log_dropped(void) { return 0; }
+static inline uint32_t mbed_log_snapshot(uint32_t *buffer, uint32_t words) { return 0; }
 
 #endif
 
+#if MBED_LOG_LEVEL >= MBED_LOG_LEVEL_ERROR
+#define MBED_LOG_ERROR(...) mbed_log_deferred(MBED_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define MBED_LOG_ERROR(...) ((void)0)
+#endif
+
+#if MBED_LOG_LEVEL >= MBED_LOG_LEVEL_WARN
+#define MBED_LOG_WARN(...) mbed_log_deferred(MBED_LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define MBED_LOG_WARN(...) ((void)0)
+#endif
+
+#if MBED_LOG_LEVEL >= MBED_LOG_LEVEL_INFO
+#define MBED_LOG_INFO(...) mbed_log_deferred(MBED_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define MBED_LOG_INFO(...) ((void)0)
+#endif
+
+#if MBED_LOG_LEVEL >= MBED_LOG_LEVEL_DEBUG
+#define MBED_LOG_DEBUG(...) mbed_log_deferred(MBED_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define MBED_LOG_DEBUG(...) ((void)0)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
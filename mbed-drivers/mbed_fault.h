@@ -0,0 +1,178 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_FAULT_H
+#define MBED_FAULT_H
+
+#include <stdint.h>
+
+/* Place a variable in RAM that the C library does not clear on reset, so
+ * that it survives a reset. The target's linker script has to provide the
+ * section. */
+#if defined(__ICCARM__)
+#define MBED_NOINIT(declaration) __no_init declaration
+#elif defined(__ARMCC_VERSION)
+#define MBED_NOINIT(declaration) declaration __attribute__((section(".bss.noinit"), zero_init))
+#else
+#define MBED_NOINIT(declaration) declaration __attribute__((section(".noinit")))
+#endif
+
+/* When set, MBED_ASSERT and error() report through
+ * mbed_error_compact_internal() instead of stdio, so neither the expression,
+ * the file name nor the message is formatted, and stdio is not needed for
+ * error reporting. */
+#ifndef MBED_COMPACT_ERRORS
+#define MBED_COMPACT_ERRORS 0
+#endif
+
+/* The identifier of a source file in compact error records, which the build
+ * can define per file, as the file name is not stored */
+#ifndef MBED_FILE_ID
+#define MBED_FILE_ID 0
+#endif
+
+/* When set, HardFault_Handler, exit() with a non-zero code and _exit() save
+ * a crash dump in retained RAM and reset the device, instead of stopping it.
+ * Only GCC builds get the HardFault_Handler; with other toolchains, call
+ * mbed_crash_dump_fault() from the target's handler. */
+#ifndef MBED_CRASH_DUMP
+#define MBED_CRASH_DUMP 0
+#endif
+
+/* The number of stack words saved in a crash dump */
+#ifndef MBED_CRASH_DUMP_STACK_WORDS
+#define MBED_CRASH_DUMP_STACK_WORDS 16
+#endif
+
+/* The number of deferred log words saved in a crash dump */
+#ifndef MBED_CRASH_DUMP_TRACE_WORDS
+#define MBED_CRASH_DUMP_TRACE_WORDS 56
+#endif
+
+#define MBED_FAULT_RECORD_MAGIC 0x4D424552 /* "MBER" */
+#define MBED_CRASH_DUMP_MAGIC   0x4D424344 /* "MBCD" */
+
+/* Error codes for compact error records */
+#define MBED_FAULT_CODE_ASSERT  1
+#define MBED_FAULT_CODE_ERROR   2
+#define MBED_FAULT_CODE_PINMAP  3
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A failure recorded in retained RAM
+ */
+typedef struct {
+    uint32_t magic;     /**< MBED_FAULT_RECORD_MAGIC when the record is valid */
+    uint32_t code;      /**< The application's code, or MBED_FAULT_CODE_* */
+    uint32_t pc;        /**< Where the failure was reported */
+    uint32_t lr;        /**< The link register there */
+    uint32_t file_id;   /**< MBED_FILE_ID of the file that reported it */
+    uint32_t line;      /**< The line that reported it */
+} mbed_fault_record_t;
+
+/* Reasons for a crash dump */
+#define MBED_CRASH_REASON_FAULT 1   /**< A fault exception; status is the IPSR */
+#define MBED_CRASH_REASON_EXIT  2   /**< exit() or _exit(); status is the exit code */
+
+/** A crash dump kept in retained RAM across a reset
+ */
+typedef struct {
+    uint32_t magic;         /**< MBED_CRASH_DUMP_MAGIC when the dump is valid */
+    uint32_t reason;        /**< MBED_CRASH_REASON_* */
+    uint32_t status;        /**< Depends on reason */
+    uint32_t r0, r1, r2, r3, r12;
+    uint32_t lr, pc, xpsr;  /**< For exits, pc and xpsr are 0 and lr is the caller of exit */
+    uint32_t sp;            /**< The stack pointer before the fault */
+    uint32_t stack_words;   /**< The number of words in stack */
+    uint32_t stack[MBED_CRASH_DUMP_STACK_WORDS];
+    uint32_t trace_words;   /**< The number of words in trace */
+    uint32_t trace[MBED_CRASH_DUMP_TRACE_WORDS];  /**< See mbed_log_snapshot() */
+} mbed_crash_dump_t;
+
+/** Record a failure in retained RAM, send it through the raw UART, and die
+ *
+ * Nothing is formatted and stdio is not used, so this is cheap to link in
+ * and to call. The UART output is "\r\n!E" followed by code, pc, lr,
+ * file_id and line as eight hex digits each, separated by ':'.
+ * Use MBED_ERROR_COMPACT(), which fills in pc, lr, file_id and line.
+ */
+void mbed_error_compact_internal(uint32_t code, uint32_t pc, uint32_t lr, uint32_t file_id, uint32_t line);
+
+/** Get the failure recorded before the last reset
+ *
+ * @returns The record, or NULL if there is none
+ */
+const mbed_fault_record_t *mbed_fault_record(void);
+
+/** Forget the recorded failure
+ */
+void mbed_fault_record_clear(void);
+
+/** Save a crash dump for a fault and reset the device
+ *
+ * Call this from a fault handler with the stacked exception frame, as the
+ * HardFault_Handler does when MBED_CRASH_DUMP is set.
+ *
+ * @param frame The exception frame: r0-r3, r12, lr, pc and xpsr
+ */
+void mbed_crash_dump_fault(const uint32_t *frame);
+
+/** Save a crash dump for an exit and reset the device
+ *
+ * @param status The exit code
+ * @param lr The caller's return address
+ */
+void mbed_crash_dump_exit(int status, uint32_t lr);
+
+/** Get the crash dump saved before the last reset
+ *
+ * The dump stays valid until mbed_crash_dump_clear() is called, so it can
+ * be read at any time after boot, including after further resets that
+ * were not crashes.
+ *
+ * @returns The dump, or NULL if there is none
+ */
+const mbed_crash_dump_t *mbed_crash_dump(void);
+
+/** Forget the saved crash dump
+ */
+void mbed_crash_dump_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+#define MBED_FAULT_CURRENT_LR() ({ uint32_t lr_; __asm volatile ("mov %0, lr" : "=r" (lr_)); lr_; })
+#define MBED_FAULT_CURRENT_PC() ({ uint32_t pc_; __asm volatile ("mov %0, pc" : "=r" (pc_)); pc_; })
+#elif defined(__ARMCC_VERSION)
+#define MBED_FAULT_CURRENT_LR() ((uint32_t)__return_address())
+#define MBED_FAULT_CURRENT_PC() ((uint32_t)__current_pc())
+#else
+#define MBED_FAULT_CURRENT_LR() 0
+#define MBED_FAULT_CURRENT_PC() 0
+#endif
+
+/** Report a failure with an error code, without formatting anything
+ *
+ * The LR is read where the macro is used, so it is the function's return
+ * address unless it has made calls before the failure.
+ */
+#define MBED_ERROR_COMPACT(code) \
+    mbed_error_compact_internal((code), MBED_FAULT_CURRENT_PC(), MBED_FAULT_CURRENT_LR(), MBED_FILE_ID, __LINE__)
+
+#endif
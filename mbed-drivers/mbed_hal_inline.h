@@ -0,0 +1,102 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_HAL_INLINE_H
+#define MBED_HAL_INLINE_H
+
+#include "device.h"
+#include "gpio_api.h"
+#include "us_ticker_api.h"
+#if DEVICE_PORTIN || DEVICE_PORTOUT || DEVICE_PORTINOUT
+#include "port_api.h"
+#endif
+
+/** Inlined HAL reads and writes
+ *
+ * The drivers' hot paths, such as DigitalOut::write() and Timer::read_us(),
+ * read and write pins, ports and the us ticker through the functions below.
+ * By default these call the HAL's gpio_write(), port_read(),
+ * us_ticker_read() and so on, which are in another module and are seldom
+ * inlined, even with LTO.
+ *
+ * With MBED_HAL_INLINE set to 1, they call the target's static inline
+ * versions instead, from its hal_inline_api.h, so a pin access compiles to
+ * a store to the pin's register. The target must provide gpio_write_inline(),
+ * gpio_read_inline() and us_ticker_read_inline(), and port_write_inline()
+ * and port_read_inline() if it has ports; each takes the same arguments as
+ * the function it replaces.
+ *
+ * The mbed/ compatibility headers include the mbed-drivers/ ones, so code
+ * written against either gets the inlined versions.
+ */
+#ifndef MBED_HAL_INLINE
+#define MBED_HAL_INLINE 0
+#endif
+
+#if MBED_HAL_INLINE
+#include "hal_inline_api.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline void mbed_gpio_write(gpio_t *obj, int value) {
+#if MBED_HAL_INLINE
+    gpio_write_inline(obj, value);
+#else
+    gpio_write(obj, value);
+#endif
+}
+
+static inline int mbed_gpio_read(gpio_t *obj) {
+#if MBED_HAL_INLINE
+    return gpio_read_inline(obj);
+#else
+    return gpio_read(obj);
+#endif
+}
+
+#if DEVICE_PORTIN || DEVICE_PORTOUT || DEVICE_PORTINOUT
+static inline void mbed_port_write(port_t *obj, int value) {
+#if MBED_HAL_INLINE
+    port_write_inline(obj, value);
+#else
+    port_write(obj, value);
+#endif
+}
+
+static inline int mbed_port_read(port_t *obj) {
+#if MBED_HAL_INLINE
+    return port_read_inline(obj);
+#else
+    return port_read(obj);
+#endif
+}
+#endif
+
+static inline uint32_t mbed_us_ticker_read(void) {
+#if MBED_HAL_INLINE
+    return us_ticker_read_inline();
+#else
+    return us_ticker_read();
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
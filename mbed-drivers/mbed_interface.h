@@ -16,6 +16,7 @@
 #ifndef MBED_INTERFACE_H
 #define MBED_INTERFACE_H
 
+#include <stdint.h>
 #include "device.h"
 
 /* Mbed interface mac address
@@ -31,10 +32,54 @@
 #define MBED_MAC_ADDR_5  MBED_MAC_ADDR_INTERFACE
 #define MBED_MAC_ADDRESS_SUM (MBED_MAC_ADDR_0 | MBED_MAC_ADDR_1 | MBED_MAC_ADDR_2 | MBED_MAC_ADDR_3 | MBED_MAC_ADDR_4 | MBED_MAC_ADDR_5)
 
+/* When MBED_STACK_STATS is set, the main stack is painted with
+ * MBED_STACK_PAINT before main() is called, so that mbed_stack_stats() can
+ * find its high-water mark. The stack bounds come from the linker script:
+ * __StackLimit and __StackTop for GCC, ARM_LIB_STACK for ARMCC and CSTACK
+ * for IAR. */
+#ifndef MBED_STACK_STATS
+#define MBED_STACK_STATS 0
+#endif
+
+#define MBED_STACK_PAINT 0xCCCCCCCCu
+
+/* When MBED_BOOT_TIMING is set, the startup code timestamps the boot
+ * phases with CycleTimer, for mbed_boot_time_us() */
+#ifndef MBED_BOOT_TIMING
+#define MBED_BOOT_TIMING 0
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Main stack usage
+ */
+typedef struct {
+    uint32_t size;      /**< The size of the stack, in bytes */
+    uint32_t max_used;  /**< The most of it ever used, in bytes */
+} mbed_stack_stats_t;
+
+/** Heap usage
+ */
+typedef struct {
+    uint32_t used;          /**< Bytes in allocated blocks */
+    uint32_t free;          /**< Bytes in free blocks */
+    uint32_t peak;          /**< The most memory the heap has taken from the system */
+    uint32_t free_blocks;   /**< The number of free blocks, a measure of fragmentation */
+} mbed_heap_stats_t;
+
+/** Boot phases, in the order they happen
+ */
+typedef enum {
+    MBED_BOOT_PHASE_RESET,      /**< Reset, if the target's startup code marks it */
+    MBED_BOOT_PHASE_MAIN,       /**< main() is entered, before mbed_hal_init() */
+    MBED_BOOT_PHASE_HAL_INIT,   /**< mbed_hal_init() has returned */
+    MBED_BOOT_PHASE_SCHEDULER,  /**< The scheduler is about to start */
+    MBED_BOOT_PHASE_APP_START,  /**< app_start() is called */
+    MBED_BOOT_PHASES
+} mbed_boot_phase_t;
+
 /** This returns a unique 6-byte MAC address, based on the interface UID
  * If the interface is not present, it returns a default fixed MAC address (00:02:F7:F0:00:00)
  *
@@ -49,6 +94,52 @@ void mbed_mac_address(char *mac);
  */
 void mbed_die(void);
 
+/** Paint the unused part of the main stack
+ *
+ * This is called before main() when MBED_STACK_STATS is set. Call it again
+ * to measure from a later point.
+ */
+void mbed_stack_paint(void);
+
+/** Get the main stack usage
+ *
+ * The high-water mark is where the lowest word that has changed from
+ * MBED_STACK_PAINT is, so it is found by reading through the untouched
+ * part of the stack.
+ *
+ *  @param stats Set to the stack usage
+ *  @returns 0 on success, -1 if MBED_STACK_STATS is not set
+ */
+int mbed_stack_stats(mbed_stack_stats_t *stats);
+
+/** Get the heap usage
+ *
+ * This is the C library's heap, which ualloc also allocates from. It is
+ * only available with newlib.
+ *
+ *  @param stats Set to the heap usage
+ *  @returns 0 on success, -1 if the C library can't report it
+ */
+int mbed_heap_stats(mbed_heap_stats_t *stats);
+
+/** Record the time of a boot phase
+ *
+ * The startup code marks every phase but MBED_BOOT_PHASE_RESET, which a
+ * target's SystemInit() can mark to measure the C library's startup too.
+ * Only the first mark of each phase is kept.
+ *
+ *  @param phase The phase that has been reached
+ */
+void mbed_boot_mark(mbed_boot_phase_t phase);
+
+/** Get the time of a boot phase
+ *
+ *  @param phase The phase
+ *  @returns Micro-seconds from the first marked phase to this one, or -1 if
+ *           it was not marked or MBED_BOOT_TIMING is not set
+ */
+int mbed_boot_time_us(mbed_boot_phase_t phase);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,111 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_PRINTF_H
+#define MBED_PRINTF_H
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/** Minimal stdio
+ *
+ * mbed_vxprintf() is a small printf formatter for integers, characters,
+ * strings and pointers. It has the flags, width, precision and length
+ * modifiers of printf, but no floating point: %f, %e, %g and %a take their
+ * argument and write '?'. Output goes to a function, a chunk at a time, so
+ * it needs no buffer of the whole output and allocates nothing.
+ *
+ * With MBED_MINIMAL_STDIO set to 1, the drivers format with it instead of
+ * the C library, and never open a FILE:
+ * - Stream's putc(), puts(), getc(), gets() and printf() call the device's
+ *   _putc(), _write() and _getc() directly. Streams are unbuffered, and
+ *   have no scanf() or FILE * conversion.
+ * - RawSerial::printf() formats with it rather than snprintf().
+ * - error(), MBED_ASSERT and the log and trace outputs write to stderr's
+ *   descriptor with mbed_dprintf() and mbed_fd_write().
+ * - With newlib, printf(), vprintf(), puts() and putchar() are replaced by
+ *   versions that write to stdout's descriptor, which is the console UART
+ *   or the FileHandle given to set_stdio().
+ * So unless the application uses the FILE functions itself, newlib's FILE
+ * layer, vfprintf and the retarget table of open files are not linked.
+ */
+#ifndef MBED_MINIMAL_STDIO
+#define MBED_MINIMAL_STDIO 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Receive a chunk of formatted output
+ *
+ *  @param context The context given to mbed_vxprintf()
+ *  @param data The characters
+ *  @param length The number of characters
+ */
+typedef void (*mbed_printf_out_t)(void *context, const char *data, size_t length);
+
+/** Format with the minimal formatter
+ *
+ *  @param out The function to send the output to
+ *  @param context Passed to out
+ *  @param format The printf style format string
+ *  @param arg The arguments of the format string
+ *
+ *  @returns
+ *    The number of characters written
+ */
+int mbed_vxprintf(mbed_printf_out_t out, void *context, const char *format, va_list arg);
+
+/** Format to a file descriptor with the minimal formatter
+ *
+ *  @param fd The descriptor, such as 1 for stdout or 2 for stderr
+ *  @param format The printf style format string
+ *  @param arg The arguments of the format string
+ *
+ *  @returns
+ *    The number of characters written
+ */
+int mbed_vdprintf(int fd, const char *format, va_list arg);
+
+/** Format to a file descriptor with the minimal formatter
+ *
+ *  @param fd The descriptor, such as 1 for stdout or 2 for stderr
+ *  @param format The printf style format string
+ *
+ *  @returns
+ *    The number of characters written
+ */
+int mbed_dprintf(int fd, const char *format, ...);
+
+/** Write to a file descriptor through the retarget layer, without a FILE
+ *
+ *  Descriptors 0 to 2 go to the FileHandle given to set_stdio(), or the
+ *  console UART.
+ *
+ *  @param fd The descriptor
+ *  @param buffer The data to write
+ *  @param length The number of bytes
+ *
+ *  @returns
+ *    The number of bytes written, or -1 if the descriptor is not open
+ */
+int mbed_fd_write(int fd, const void *buffer, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
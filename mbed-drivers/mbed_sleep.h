@@ -0,0 +1,125 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SLEEP_H
+#define MBED_SLEEP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Sleep arbitration
+ *
+ * Deep sleep stops the high-speed clocks, and with them the us ticker and
+ * most peripherals. Drivers hold a deep sleep lock while they need those
+ * clocks: the asynchronous SPI, I2C and serial transfers while they run,
+ * and Ticker and Timeout on the us ticker while they are queued. The idle
+ * loop calls sleep_manager_sleep_auto(), which picks the deepest sleep
+ * nothing has locked out.
+ */
+
+/** Take a deep sleep lock
+ *
+ * Can be called from interrupt handlers. Each lock must be released by
+ * exactly one call to sleep_manager_unlock_deep_sleep().
+ */
+void sleep_manager_lock_deep_sleep(void);
+
+/** Release a deep sleep lock
+ *
+ * Can be called from interrupt handlers.
+ */
+void sleep_manager_unlock_deep_sleep(void);
+
+/** Check if deep sleep is allowed
+ *
+ * @returns 1 if no deep sleep lock is held, 0 otherwise
+ */
+int sleep_manager_can_deep_sleep(void);
+
+/** Sleep as deeply as the locks held allow
+ *
+ * Call this with interrupts masked, after checking there is nothing to do:
+ * a pending interrupt still ends the sleep, and is serviced once interrupts
+ * are unmasked again.
+ */
+void sleep_manager_sleep_auto(void);
+
+/** Set a function for sleep_manager_sleep_auto() to call before sleeping
+ *
+ * The hook is called with interrupts masked, each time the idle loop is
+ * about to sleep, so it must be short. There is one hook: the Watchdog
+ * uses it to service the watchdog without a wakeup of its own.
+ *
+ * @param hook The function, or NULL for none
+ */
+void sleep_manager_set_idle_hook(void (*hook)(void));
+
+#ifdef __cplusplus
+}
+
+#include "core-util/CriticalSectionLock.h"
+
+namespace mbed {
+
+/** A deep sleep lock a driver takes and releases as its activity starts
+ *  and stops
+ *
+ * Taking it when it is held, or releasing it when it is not, does nothing,
+ * so the driver need not track whether it holds it.
+ */
+class DeepSleepLock {
+public:
+    DeepSleepLock() : _locked(false) {
+    }
+
+    ~DeepSleepLock() {
+        unlock();
+    }
+
+    /** Take the lock, if not held
+     */
+    void lock() {
+        mbed::util::CriticalSectionLock critical;
+        if (!_locked) {
+            _locked = true;
+            sleep_manager_lock_deep_sleep();
+        }
+    }
+
+    /** Release the lock, if held
+     */
+    void unlock() {
+        mbed::util::CriticalSectionLock critical;
+        if (_locked) {
+            _locked = false;
+            sleep_manager_unlock_deep_sleep();
+        }
+    }
+
+private:
+    bool _locked;
+
+    /* disallow copy constructor and assignment operators */
+    DeepSleepLock(const DeepSleepLock&);
+    DeepSleepLock & operator = (const DeepSleepLock&);
+};
+
+} // namespace mbed
+#endif
+
+#endif
@@ -0,0 +1,128 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_TIMELINE_H
+#define MBED_TIMELINE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** Event timeline recorder
+ *
+ * With MBED_TIMELINE set, the drivers record what they do into a ring of
+ * MBED_TIMELINE_SIZE records (a power of two) of a timestamp, an event and
+ * an argument: interrupts taken through the InterruptManager, ticker
+ * interrupts and the events they run, the start and the end of SPI, I2C
+ * and serial transfers, and the callbacks the CompletionQueue runs in main
+ * context. Recording is a timestamp read and three stores, with interrupts
+ * masked. Once the ring is full, the oldest records are overwritten.
+ *
+ * Timestamps are DWT cycles on Cortex-M3 and above, and us ticker
+ * microseconds otherwise. mbed_timeline_dump() writes the ring out as text,
+ * which scripts/mbed_timeline.py turns into a Chrome trace JSON file, for
+ * chrome://tracing or Perfetto.
+ *
+ * Without MBED_TIMELINE, MBED_TIMELINE_EVENT() compiles to nothing.
+ *
+ * Example:
+ * @code
+ * mbed_timeline_start();
+ * // ... run the code to look at ...
+ * mbed_timeline_stop();
+ * mbed_timeline_dump(stdout);
+ * @endcode
+ */
+#ifndef MBED_TIMELINE
+#define MBED_TIMELINE 0
+#endif
+
+#ifndef MBED_TIMELINE_SIZE
+#define MBED_TIMELINE_SIZE 256
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The events recorded by the drivers. Events from user code start at
+ *  MBED_TIMELINE_USER. */
+enum {
+    MBED_TIMELINE_IRQ_ENTER = 1,    /**< arg: the vector */
+    MBED_TIMELINE_IRQ_EXIT,         /**< arg: the vector */
+    MBED_TIMELINE_TICKER_IRQ,       /**< arg: the ticker data */
+    MBED_TIMELINE_TICKER_EVENT,     /**< arg: the event's id */
+    MBED_TIMELINE_SPI_START,        /**< arg: the SPI */
+    MBED_TIMELINE_SPI_DONE,         /**< arg: the SPI */
+    MBED_TIMELINE_I2C_START,        /**< arg: the I2C */
+    MBED_TIMELINE_I2C_DONE,         /**< arg: the I2C */
+    MBED_TIMELINE_SERIAL_TX_START,  /**< arg: the SerialBase */
+    MBED_TIMELINE_SERIAL_TX_DONE,   /**< arg: the SerialBase */
+    MBED_TIMELINE_SERIAL_RX_START,  /**< arg: the SerialBase */
+    MBED_TIMELINE_SERIAL_RX_DONE,   /**< arg: the SerialBase */
+    MBED_TIMELINE_CALLBACK_BEGIN,   /**< arg: the CompletionQueue slot */
+    MBED_TIMELINE_CALLBACK_END,     /**< arg: the CompletionQueue slot */
+    MBED_TIMELINE_USER = 0x100
+};
+
+/** A recorded event */
+typedef struct {
+    uint32_t time;
+    uint32_t event;
+    uint32_t arg;
+} mbed_timeline_record_t;
+
+#if MBED_TIMELINE
+
+#define MBED_TIMELINE_EVENT(event, arg) mbed_timeline_record((event), (uint32_t)(arg))
+
+/** Start recording, from an empty ring
+ */
+void mbed_timeline_start(void);
+
+/** Stop recording, keeping what is in the ring
+ */
+void mbed_timeline_stop(void);
+
+/** Record an event, if recording
+ *
+ * Safe to call from interrupts.
+ *
+ * @param event The event, one of the MBED_TIMELINE_ values, or from
+ *   MBED_TIMELINE_USER up
+ * @param arg The event's argument
+ */
+void mbed_timeline_record(uint32_t event, uint32_t arg);
+
+/** Write the ring out, oldest record first
+ *
+ * The first line is "timeline <ticks per second> <records lost>", and each
+ * record follows on a line of its own as "<time> <event> <arg>", in hex.
+ * Recording is paused while the ring is written.
+ *
+ * @param out The stream to write to
+ */
+void mbed_timeline_dump(FILE *out);
+
+#else
+
+#define MBED_TIMELINE_EVENT(event, arg) ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
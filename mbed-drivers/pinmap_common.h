@@ -38,6 +38,36 @@ uint32_t pinmap_find_function(PinName pin, const PinMap* map);
 
 #ifdef __cplusplus
 }
+
+#if __cplusplus >= 201103L
+namespace mbed {
+
+/* Compile-time versions of the lookups, for maps declared constexpr where
+ * the code using them can see them. A pin that is not in the map gives NC,
+ * and pins on different peripherals merge to NC, so the result can be
+ * checked with static_assert:
+ *
+ *     constexpr PinMap spi_sclk[] = {{p7, SPI_0, 2}, {NC, 0, 0}};
+ *     static_assert(pinmap_constexpr_peripheral(p7, spi_sclk) != NC, "p7 is not an SPI clock");
+ */
+constexpr int pinmap_constexpr_peripheral(PinName pin, const PinMap *map) {
+    return (map->pin == NC) ? (int)NC :
+           (map->pin == pin) ? map->peripheral : pinmap_constexpr_peripheral(pin, map + 1);
+}
+
+constexpr int pinmap_constexpr_function(PinName pin, const PinMap *map) {
+    return (map->pin == NC) ? (int)NC :
+           (map->pin == pin) ? map->function : pinmap_constexpr_function(pin, map + 1);
+}
+
+/* Unlike pinmap_merge(), a mismatch gives NC rather than an error, and
+ * merging with NC gives NC, so a missing pin or peripheral propagates */
+constexpr int pinmap_constexpr_merge(int a, int b) {
+    return (a == b) ? a : (int)NC;
+}
+
+} // namespace mbed
+#endif
 #endif
 
 #endif
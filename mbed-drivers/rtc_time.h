@@ -15,6 +15,15 @@
  */
 
 #include <time.h>
+#include <stdint.h>
+
+/* time_us() reads the RTC once, then interpolates from the us ticker. It
+ * reads the RTC again after this many seconds, to correct the drift between
+ * the two clocks.
+ */
+#ifndef RTC_TIME_RESYNC_S
+#define RTC_TIME_RESYNC_S 60
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -69,6 +78,55 @@ extern "C" {
  */
 void set_time(time_t t);
 
+/** Get the current time in microseconds
+ *
+ * Unlike time(), this does not read the RTC on every call: the RTC is read
+ * once and the time since then is measured with the us ticker, which gives
+ * microsecond resolution at the cost of a ticker read. The RTC is read again
+ * every RTC_TIME_RESYNC_S seconds, and the time may step by up to a second
+ * when it is, as the RTC only counts whole seconds. Without an RTC, this is
+ * the time since the first call or since set_time().
+ *
+ * @returns
+ *   The number of microseconds since January 1, 1970
+ */
+uint64_t time_us(void);
+
+/** Get the time since boot in microseconds
+ *
+ * This is the 64-bit us ticker, which never wraps in practice, cannot be set
+ * and never steps, so it is the clock to measure intervals with.
+ *
+ * @returns
+ *   The number of microseconds since the us ticker started
+ */
+uint64_t monotonic_us(void);
+
+/** Clocks for mbed_clock_gettime()
+ */
+typedef enum {
+    MBED_CLOCK_MONOTONIC,   /**< The time since boot, as monotonic_us() */
+    MBED_CLOCK_REALTIME     /**< The time since January 1, 1970, as time_us() */
+} mbed_clockid_t;
+
+/** A time in seconds and nanoseconds
+ */
+typedef struct {
+    int64_t tv_sec;         /**< Whole seconds */
+    int32_t tv_nsec;        /**< Nanoseconds, from 0 to 999999999 */
+} mbed_timespec_t;
+
+/** Get the time of a clock, as POSIX clock_gettime()
+ *
+ * The clocks count microseconds, so tv_nsec is always a multiple of 1000.
+ *
+ * @param clock_id The clock to read
+ * @param tp Set to the time of the clock
+ * @returns
+ *   0 on success, -1 if clock_id is not a clock
+ */
+int mbed_clock_gettime(mbed_clockid_t clock_id, mbed_timespec_t *tp);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,71 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SIM_TICKER_H
+#define MBED_SIM_TICKER_H
+
+#include "ticker_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A ticker driven by a simulated clock
+ *
+ * The clock only moves when sim_ticker_advance() is called, and the events
+ * that fall due are run from there, at their own times, as the ticker
+ * interrupt would run them. Timer, Timeout and Ticker objects created with
+ * get_sim_ticker_data() then behave exactly as on the us ticker, with no
+ * hardware timer, no waiting and no jitter. It has no dependency on the
+ * target, so the same tests and benchmarks of the ticker queue run on the
+ * device and in host builds, under a profiler or sanitizers.
+ *
+ * Example:
+ * @code
+ * Timeout timeout(get_sim_ticker_data());
+ * timeout.attach_us(handler, 1000);
+ * sim_ticker_advance(999);     // handler not called
+ * sim_ticker_advance(1);       // handler called, with the clock at 1000
+ * @endcode
+ */
+
+/** Get the ticker data of the simulated ticker
+ */
+const ticker_data_t *get_sim_ticker_data(void);
+
+/** Read the simulated clock, in microseconds
+ */
+uint32_t sim_ticker_read(void);
+
+/** Move the simulated clock forward
+ *
+ * Each event that falls due is run with the clock at its timestamp, in
+ * order, including events the handlers insert that fall due before the end
+ * of the step. An interrupt set for a time already passed is taken at once,
+ * as the hardware would.
+ *
+ * @param us The time to move forward by, in microseconds
+ */
+void sim_ticker_advance(uint32_t us);
+
+/** Get the number of ticker interrupts taken so far
+ */
+uint32_t sim_ticker_interrupts(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,6 +29,8 @@ extern const char* TEST_ENV_SUCCESS;
 extern const char* TEST_ENV_FAILURE;
 extern const char* TEST_ENV_MEASURE;
 extern const char* TEST_ENV_END;
+extern const char* TEST_ENV_BENCH;
+extern const char* TEST_ENV_HISTOGRAM;
 
 // Test result related notification functions
 void notify_start();
@@ -38,6 +40,12 @@ void notify_performance_coefficient(const char* measurement_name, const int valu
 void notify_performance_coefficient(const char* measurement_name, const unsigned int value);
 void notify_performance_coefficient(const char* measurement_name, const double value);
 
+// Report the time spent booting and the heap in use, as performance
+// coefficients, for scripts/mbed_footprint.py to set beside the binary's
+// flash and RAM. The static initialisation time needs MBED_BOOT_TIMING and a
+// target that marks MBED_BOOT_PHASE_RESET.
+void notify_footprint();
+
 // Host test auto-detection API
 void notify_host_test_name(const char *host_test);
 void notify_timeout(int timeout);
@@ -74,6 +82,89 @@ void notify_test_description(const char *description);
     }
 */
 
+/** Collects benchmark samples in RAM and reports their distribution later
+ *
+ * add() only stores the sample, so it can be called from timing-sensitive
+ * code, including interrupt handlers, without disturbing the measurement.
+ * report() then sorts the samples and prints a single line:
+ *
+ *     {{bench;<name>;<unit>;<count>;<min>;<median>;<p99>;<max>;<dropped>}}
+ *
+ * Samples added once the buffer is full are counted as dropped.
+ *
+ * Example:
+ * @code
+ * uint32_t samples[100];
+ * BenchmarkReporter latency("rx_latency", "cycles", samples, 100);
+ * // ... latency.add(CycleTimer::now() - start); ...
+ * latency.report();
+ * @endcode
+ */
+class BenchmarkReporter {
+public:
+    /** Create a reporter that stores samples in a caller's buffer
+     *
+     *  @param name The name of the measurement
+     *  @param unit The unit of the samples, for example "us" or "cycles"
+     *  @param buffer Storage for the samples
+     *  @param capacity The number of samples buffer holds
+     */
+    BenchmarkReporter(const char *name, const char *unit, uint32_t *buffer, uint32_t capacity) :
+        _name(name), _unit(unit), _samples(buffer), _capacity(capacity), _count(0), _dropped(0) {
+    }
+
+    /** Store a sample
+     */
+    void add(uint32_t sample) {
+        if (_count < _capacity) {
+            _samples[_count++] = sample;
+        } else {
+            _dropped++;
+        }
+    }
+
+    /** Get the number of samples stored
+     */
+    uint32_t count() const {
+        return _count;
+    }
+
+    /** Sort the samples and print their distribution
+     *
+     *  The samples are sorted in place, and are kept until reset().
+     */
+    void report();
+
+    /** Print how many samples fall in each of a set of bins, as one line:
+     *
+     *      {{histogram;<name>;<unit>;<edge>:<count>;...;+:<count>}}
+     *
+     *  Each bin counts the samples up to and including its edge and above
+     *  the previous edge, and the last counts those above the last edge.
+     *  The samples are not changed.
+     *
+     *  @param edges The upper edges of the bins, in ascending order
+     *  @param edge_count The number of edges
+     */
+    void report_histogram(const uint32_t *edges, uint32_t edge_count) const;
+
+    /** Forget all the samples
+     */
+    void reset() {
+        _count = 0;
+        _dropped = 0;
+    }
+
+private:
+    uint32_t percentile(uint32_t percent) const;
+
+    const char *_name;
+    const char *_unit;
+    uint32_t *_samples;
+    uint32_t _capacity;
+    volatile uint32_t _count;
+    volatile uint32_t _dropped;
+};
 
 // Test functionality useful during testing
 unsigned int testenv_randseed();
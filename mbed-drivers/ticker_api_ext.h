@@ -0,0 +1,70 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_TICKER_API_EXT_H
+#define MBED_TICKER_API_EXT_H
+
+#include <stdint.h>
+#include "ticker_api.h"
+
+/* Ticker functions the drivers implement in source/ticker_api.c on top of
+ * the mbed-hal ticker_api.h ones.
+ */
+
+/** A time in ticker counts, extended to 64 bits so that it doesn't wrap */
+typedef uint64_t us_timestamp_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Insert an event that may expire up to slack ticks after timestamp
+ *
+ * If another event is already due within [timestamp, timestamp + slack],
+ * the new event takes that event's timestamp, so the two share one
+ * interrupt. A slack of 0 is the same as ticker_insert_event().
+ *
+ * @param data      The ticker's data
+ * @param obj       The event to insert
+ * @param timestamp The earliest time the event may expire
+ * @param slack     How much later than timestamp the event may expire
+ * @param id        The id passed to the event handler
+ */
+void ticker_insert_event_slack(const ticker_data_t *const data, ticker_event_t *obj, timestamp_t timestamp, timestamp_t slack, uint32_t id);
+
+/** Get the timestamp of the next pending event
+ *
+ * @param data     The ticker's data
+ * @param deadline Set to the timestamp of the first event to expire, if any
+ * @return 1 if an event is pending, 0 if the queue is empty
+ */
+int ticker_next_deadline(const ticker_data_t *const data, timestamp_t *deadline);
+
+/** Read the ticker's counter, extended to 64 bits
+ *
+ * The drivers keep a 64-bit time for each ticker that is brought up to the
+ * counter on every read, and at least once per counter period by an event
+ * of their own, so it never wraps.
+ *
+ * @param data The ticker's data
+ * @return The ticker's time, in ticks since it was first used
+ */
+us_timestamp_t ticker_read_us(const ticker_data_t *const data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -16,6 +16,8 @@
 #ifndef MBED_WAIT_API_H
 #define MBED_WAIT_API_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -54,13 +56,74 @@ void wait(float s);
 void wait_ms(int ms);
 
 /** Waits a number of microseconds.
+ *
+ *  When built with WAIT_SLEEP_THRESHOLD_US set, waits of at least that
+ *  many microseconds made outside interrupt context sleep until the time
+ *  is up rather than spinning.
  *
  *  @param us the whole number of microseconds to wait
  */
 void wait_us(int us);
 
+/** Waits a number of core clock cycles.
+ *
+ *  On Cortex-M3 and above this spins on the DWT cycle counter, and is
+ *  accurate to a few cycles plus the time of the call. On Cortex-M0 it
+ *  runs a delay loop whose cost per iteration is measured against the us
+ *  ticker on the first call, so that call takes about a millisecond longer,
+ *  and waits are accurate to a loop iteration (a few cycles). Interrupts
+ *  taken during the wait lengthen it.
+ *
+ *  @param cycles the number of core clock cycles to wait
+ */
+void wait_cycles(uint32_t cycles);
+
+/** Waits a number of nanoseconds.
+ *
+ *  This is wait_cycles() for the cycles of SystemCoreClock in ns
+ *  nanoseconds, rounded up, for delays shorter than a us ticker tick.
+ *
+ *  @param ns the number of nanoseconds to wait
+ */
+void wait_ns(uint32_t ns);
+
 #ifdef __cplusplus
 }
+
+#include "core-util/FunctionPointer.h"
+
+namespace mbed {
+
+/** Calls a function after a number of milliseconds, without waiting.
+ *
+ *  wait_ms() spins, so nothing else the scheduler has to run gets to run
+ *  until it returns. This posts the callback to the scheduler with the delay
+ *  instead and returns at once; the callback runs from the scheduler, no
+ *  earlier than ms milliseconds from now. Keep wait_us() for delays of a few
+ *  microseconds, which are shorter than a trip through the scheduler.
+ *
+ *  Example:
+ *  @code
+ *  #include "mbed.h"
+ *
+ *  DigitalOut led(LED1);
+ *
+ *  void blink() {
+ *      led = !led;
+ *      mbed::delay_async(500, mbed::util::FunctionPointer0<void>(blink).bind());
+ *  }
+ *
+ *  void app_start(int, char**) {
+ *      blink();
+ *  }
+ *  @endcode
+ *
+ *  @param ms the whole number of milliseconds to wait
+ *  @param callback the bound callback to run when the time is up
+ */
+void delay_async(uint32_t ms, const mbed::util::FunctionPointerBind<void> &callback);
+
+} // namespace mbed
 #endif
 
 #endif
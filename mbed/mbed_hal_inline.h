@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2015, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __MBED_MBED_HAL_INLINE_H__
+#define __MBED_MBED_HAL_INLINE_H__
+#warning mbed/mbed_hal_inline.h is deprecated.  Please use mbed-drivers/mbed_hal_inline.h instead.
+#include "../mbed-drivers/mbed_hal_inline.h"
+#endif // __MBED_MBED_HAL_INLINE_H__
@@ -0,0 +1,168 @@
+#!/usr/bin/env python
+# mbed Microcontroller Library
+# Copyright (c) 2015 ARM Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Report the flash and RAM of the size_* and bench_* test binaries.
+
+Build the tests with "yotta build" first. Each binary's flash (text and
+data) and RAM (data and bss) are read with the toolchain's size tool, along
+with the number of static constructors in .init_array. The size_* apps link
+one driver each, so they are also shown less the size_baseline app, which
+leaves what the driver costs.
+
+Console captures of the tests, as given by mbedgt -V, add the measurements
+each test reported, so the footprint of a benchmark sits beside its results.
+size_* apps report their boot time and heap use with notify_footprint().
+
+With --json the results are saved, and with --compare they are checked
+against results saved earlier: any binary whose flash or RAM grew by more
+than --tolerance bytes is listed, and the exit status is 1.
+
+Usage: mbed_footprint.py [options] build/<target> [capture.txt...]
+"""
+import json
+import optparse
+import os
+import re
+import subprocess
+import sys
+
+PREFIX = 'mbed-drivers-test-'
+BASELINE = 'size_baseline'
+
+MEASURE = re.compile(r'\{\{measure;([^;]+);([^}]+)\}\}')
+BENCH = re.compile(r'\{\{bench;([^;]+);([^;]+);(\d+);(\d+);(\d+);(\d+);(\d+);(\d+)\}\}')
+TEST_ID = re.compile(r'\{\{test_id;([^}]+)\}\}')
+
+
+def is_elf(path):
+    with open(path, 'rb') as f:
+        return f.read(4) == b'\x7fELF'
+
+
+def find_binaries(build_dir, everything):
+    binaries = {}
+    for root, dirs, files in os.walk(build_dir):
+        for name in files:
+            if not name.startswith(PREFIX) or '.' in name:
+                continue
+            test = name[len(PREFIX):]
+            if not everything and not test.startswith(('size_', 'bench_')):
+                continue
+            path = os.path.join(root, name)
+            if is_elf(path):
+                binaries[test] = path
+    return binaries
+
+
+def run_size(tool, args):
+    out = subprocess.check_output([tool] + args)
+    return out.decode('ascii', 'replace').splitlines()
+
+
+def measure(tool, path):
+    # Berkeley format: text data bss dec hex filename
+    text, data, bss = [int(x) for x in run_size(tool, ['-B', path])[1].split()[:3]]
+    ctors = 0
+    for line in run_size(tool, ['-A', path]):
+        fields = line.split()
+        if len(fields) >= 2 and fields[0] in ('.init_array', '.ctors'):
+            ctors += int(fields[1]) // 4
+    return {'flash': text + data, 'ram': data + bss, 'ctors': ctors}
+
+
+def parse_captures(paths):
+    """Map each test to the measurements in its console output"""
+    results = {}
+    for path in paths:
+        current = None
+        with open(path) as f:
+            for line in f:
+                m = TEST_ID.search(line)
+                if m:
+                    current = m.group(1).lower()
+                    if current.startswith('mbed_'):
+                        current = current[len('mbed_'):]
+                    results.setdefault(current, {})
+                    continue
+                if current is None:
+                    continue
+                m = MEASURE.search(line)
+                if m:
+                    results[current][m.group(1)] = m.group(2)
+                    continue
+                m = BENCH.search(line)
+                if m:
+                    # the median and p99, in the bench's own unit
+                    name, unit = m.group(1), m.group(2)
+                    results[current][name] = '%s%s(p99:%s)' % (m.group(5), unit, m.group(6))
+    return results
+
+
+def main():
+    parser = optparse.OptionParser(usage='%prog [options] build/<target> [capture.txt...]')
+    parser.add_option('--size', default='arm-none-eabi-size',
+                      help='the size tool of the toolchain [%default]')
+    parser.add_option('--all', action='store_true',
+                      help='report every test binary, not only size_* and bench_*')
+    parser.add_option('--json', metavar='FILE', help='save the results')
+    parser.add_option('--compare', metavar='FILE', help='check against results saved with --json')
+    parser.add_option('--tolerance', type='int', default=0,
+                      help='bytes of growth allowed by --compare [%default]')
+    options, args = parser.parse_args()
+    if not args:
+        parser.error('no build directory')
+
+    binaries = find_binaries(args[0], options.all)
+    if not binaries:
+        sys.stderr.write('no test binaries found in %s\n' % args[0])
+        return 1
+    sizes = dict((test, measure(options.size, path)) for test, path in binaries.items())
+    runtime = parse_captures(args[1:])
+    base = sizes.get(BASELINE)
+
+    print('%-24s %8s %8s %8s %8s %6s  %s' % ('test', 'flash', 'ram', '+flash', '+ram', 'ctors', 'results'))
+    for test in sorted(sizes):
+        s = sizes[test]
+        if base is not None and test.startswith('size_') and test != BASELINE:
+            extra = ('%+d' % (s['flash'] - base['flash']), '%+d' % (s['ram'] - base['ram']))
+        else:
+            extra = ('', '')
+        results = ' '.join('%s=%s' % kv for kv in sorted(runtime.get(test, {}).items()))
+        print('%-24s %8d %8d %8s %8s %6d  %s' % ((test, s['flash'], s['ram']) + extra + (s['ctors'], results)))
+
+    if options.json:
+        with open(options.json, 'w') as f:
+            json.dump({'sizes': sizes, 'results': runtime}, f, indent=2, sort_keys=True)
+
+    if options.compare:
+        with open(options.compare) as f:
+            old = json.load(f)['sizes']
+        regressions = []
+        for test in sorted(sizes):
+            if test not in old:
+                continue
+            for key in ('flash', 'ram'):
+                grown = sizes[test][key] - old[test][key]
+                if grown > options.tolerance:
+                    regressions.append('%s %s grew by %d bytes, to %d' % (test, key, grown, sizes[test][key]))
+        if regressions:
+            print('')
+            print('\n'.join(regressions))
+            return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,119 @@
+#!/usr/bin/env python
+# mbed Microcontroller Library
+# Copyright (c) 2015 ARM Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Turn the output of mbed_timeline_dump() into a Chrome trace JSON file.
+
+Interrupts and CompletionQueue callbacks become slices on the "irq" and
+"main" tracks, transfers become async slices from their start to their end,
+one track per driver object, and the other events become instant events.
+Open the result in chrome://tracing or https://ui.perfetto.dev.
+Lines before the "timeline" header line are skipped, so a whole console
+capture can be passed in.
+
+Usage: mbed_timeline.py < capture.txt > trace.json
+       mbed_timeline.py capture.txt trace.json
+"""
+import json
+import sys
+
+# the event numbers of mbed-drivers/mbed_timeline.h
+IRQ_ENTER, IRQ_EXIT, TICKER_IRQ, TICKER_EVENT = 1, 2, 3, 4
+CALLBACK_BEGIN, CALLBACK_END = 13, 14
+USER = 0x100
+
+# start event: (end event, category)
+TRANSFERS = {
+    5: (6, 'spi'),
+    7: (8, 'i2c'),
+    9: (10, 'serial_tx'),
+    11: (12, 'serial_rx'),
+}
+ENDS = dict((end, (start, category)) for start, (end, category) in TRANSFERS.items())
+
+NAMES = {
+    TICKER_IRQ: 'ticker_irq',
+    TICKER_EVENT: 'ticker_event',
+}
+
+
+def parse(lines):
+    ticks_per_second = None
+    records = []
+    for line in lines:
+        fields = line.split()
+        if ticks_per_second is None:
+            if len(fields) == 3 and fields[0] == 'timeline':
+                ticks_per_second = int(fields[1])
+            continue
+        if len(fields) != 3:
+            break
+        try:
+            records.append(tuple(int(f, 16) for f in fields))
+        except ValueError:
+            break
+    if ticks_per_second is None:
+        raise ValueError('no timeline header found')
+    return ticks_per_second, records
+
+
+def convert(ticks_per_second, records):
+    events = []
+    base = None
+    last = 0
+    offset = 0
+    for time, event, arg in records:
+        # the counter wraps at 32 bits; records are in time order
+        if base is not None and time < last:
+            offset += 1 << 32
+        last = time
+        ticks = time + offset
+        if base is None:
+            base = ticks
+        ts = (ticks - base) * 1e6 / ticks_per_second
+        record = {'ts': ts, 'pid': 0}
+        if event in (IRQ_ENTER, IRQ_EXIT):
+            record.update(name='irq %d' % arg, ph='B' if event == IRQ_ENTER else 'E', tid='irq')
+        elif event in (CALLBACK_BEGIN, CALLBACK_END):
+            record.update(name='callback', ph='B' if event == CALLBACK_BEGIN else 'E', tid='main',
+                          args={'slot': '0x%08x' % arg})
+        elif event in TRANSFERS:
+            category = TRANSFERS[event][1]
+            record.update(name=category, cat=category, ph='b', id='0x%08x' % arg, tid=category)
+        elif event in ENDS:
+            category = ENDS[event][1]
+            record.update(name=category, cat=category, ph='e', id='0x%08x' % arg, tid=category)
+        else:
+            name = NAMES.get(event, 'user %d' % (event - USER) if event >= USER else 'event %d' % event)
+            record.update(name=name, ph='i', s='t', tid='main' if event >= USER else 'irq',
+                          args={'arg': '0x%08x' % arg})
+        events.append(record)
+    return {'traceEvents': events, 'displayTimeUnit': 'ns'}
+
+
+def main(argv):
+    source = open(argv[1]) if len(argv) > 1 else sys.stdin
+    out = open(argv[2], 'w') if len(argv) > 2 else sys.stdout
+    try:
+        ticks_per_second, records = parse(source)
+    except ValueError as e:
+        sys.stderr.write('%s\n\n%s' % (e, __doc__))
+        return 1
+    json.dump(convert(ticks_per_second, records), out, indent=1)
+    out.write('\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
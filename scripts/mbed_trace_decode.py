@@ -0,0 +1,133 @@
+#!/usr/bin/env python
+# mbed Microcontroller Library
+# Copyright (c) 2015 ARM Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Expand the tokenized trace frames of an image built with MBED_TRACE_TOKENIZED.
+
+Each frame holds the address of a format string and its argument words (see
+source/mbed_trace.c). The strings are looked up in the image's ELF file, so
+only format strings and %s arguments that are in the image can be shown.
+Bytes outside frames are passed through, so text output still appears.
+
+Usage: mbed_trace_decode.py image.elf < capture.bin
+       mbed_trace_decode.py image.elf /dev/ttyACM0
+"""
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+FRAME_START = 0xA5
+MAX_ARGS = 6
+
+CONVERSION = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXcspn%])')
+
+
+class Image(object):
+    def __init__(self, path):
+        self.segments = []
+        with open(path, 'rb') as f:
+            elf = ELFFile(f)
+            for section in elf.iter_sections():
+                if section['sh_addr'] and section['sh_type'] == 'SHT_PROGBITS':
+                    self.segments.append((section['sh_addr'], section.data()))
+
+    def string(self, address):
+        for base, data in self.segments:
+            if base <= address < base + len(data):
+                end = data.find(b'\0', address - base)
+                return data[address - base:end].decode('latin-1')
+        return None
+
+
+def expand(image, format, words):
+    words = list(words)
+
+    def next_word():
+        return words.pop(0) if words else 0
+
+    def convert(m):
+        flags, width, precision, _, conv = m.groups()
+        if conv == '%':
+            return '%'
+        if width == '*':
+            width = str(struct.unpack('<i', struct.pack('<I', next_word()))[0])
+        if precision == '*':
+            precision = str(next_word())
+        spec = '%' + flags + (width or '') + ('.' + precision if precision else '')
+        word = next_word()
+        if conv in 'di':
+            return (spec + 'd') % struct.unpack('<i', struct.pack('<I', word))[0]
+        if conv == 'c':
+            return (spec + 'c') % chr(word & 0xFF)
+        if conv == 's':
+            text = image.string(word)
+            return (spec + 's') % (text if text is not None else '<0x%08x>' % word)
+        if conv == 'p':
+            return '0x%08x' % word
+        if conv == 'n':
+            return ''
+        return (spec + conv) % word
+
+    return CONVERSION.sub(convert, format)
+
+
+def decode(image, stream, out):
+    pending = bytearray()
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        pending += chunk
+        while pending:
+            if pending[0] != FRAME_START:
+                out.write(chr(pending.pop(0)))
+                continue
+            if len(pending) < 2:
+                break
+            count = pending[1]
+            length = 2 + 4 * (count + 1) + 1
+            if count > MAX_ARGS:
+                out.write(chr(pending.pop(0)))
+                continue
+            if len(pending) < length:
+                break
+            frame = bytes(pending[:length])
+            if sum(bytearray(frame[1:-1])) & 0xFF != bytearray(frame)[-1]:
+                # not a frame after all
+                out.write(chr(pending.pop(0)))
+                continue
+            del pending[:length]
+            words = struct.unpack('<%dI' % (count + 1), frame[2:-1])
+            format = image.string(words[0])
+            if format is None:
+                out.write('<unknown format 0x%08x>\n' % words[0])
+            else:
+                out.write(expand(image, format, words[1:]))
+        out.flush()
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 1
+    image = Image(argv[1])
+    stream = open(argv[2], 'rb') if len(argv) > 2 else getattr(sys.stdin, 'buffer', sys.stdin)
+    decode(image, stream, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
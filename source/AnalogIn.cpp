@@ -0,0 +1,156 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/AnalogIn.h"
+#include "minar/minar.h"
+#include "core-util/CriticalSectionLock.h"
+
+#if DEVICE_ANALOGIN && DEVICE_ANALOGIN_ASYNCH
+
+namespace mbed {
+
+int AnalogIn::start_stream(uint32_t sample_rate, const Buffer &buffer0, const Buffer &buffer1,
+        const event_callback_t &callback, int event)
+{
+    mbed::util::CriticalSectionLock lock;
+    if (analogin_active(&_adc)) {
+        return -1;
+    }
+#if DEVICE_ANALOGIN_WINDOW
+    if (_window_active) {
+        return -1;
+    }
+#endif
+    _sample_rate = sample_rate;
+    _stream_buffer[0] = buffer0;
+    _stream_buffer[1] = buffer1;
+    _callback = callback;
+    _event = event;
+    _stream_half = 0;
+    _streaming = true;
+    _irq.callback(&AnalogIn::irq_handler_asynch);
+    start_half();
+    return 0;
+}
+
+void AnalogIn::stop_stream()
+{
+    _streaming = false;
+}
+
+void AnalogIn::abort_stream()
+{
+    mbed::util::CriticalSectionLock lock;
+    _streaming = false;
+    analogin_abort_asynch(&_adc);
+}
+
+int AnalogIn::set_dma_usage(DMAUsage usage)
+{
+    if (analogin_active(&_adc)) {
+        return -1;
+    }
+    _usage = usage;
+    return 0;
+}
+
+void AnalogIn::start_half()
+{
+    const Buffer &buffer = _stream_buffer[_stream_half];
+    analogin_read_asynch(&_adc, (uint16_t *)buffer.buf, buffer.length / sizeof(uint16_t), _sample_rate,
+            _irq.entry(), _event, _usage);
+}
+
+void AnalogIn::irq_handler_asynch(void)
+{
+    int event = analogin_irq_handler_asynch(&_adc);
+    Buffer buffer = _stream_buffer[_stream_half];
+    if ((event & ANALOGIN_EVENT_COMPLETE) && !(event & ANALOGIN_EVENT_OVERRUN) && _streaming) {
+        // start the other buffer first, then report this one
+        _stream_half ^= 1;
+        start_half();
+    } else {
+        _streaming = false;
+    }
+    if (_callback && (event & _event & ANALOGIN_EVENT_ALL)) {
+        minar::Scheduler::postCallback(_callback.bind(buffer, event & ANALOGIN_EVENT_ALL));
+    }
+}
+
+} // namespace mbed
+
+#endif
+
+#if DEVICE_ANALOGIN && DEVICE_ANALOGIN_WINDOW
+
+namespace mbed {
+
+int AnalogIn::attach_window(unsigned short low, unsigned short high, const window_callback_t &callback)
+{
+#if DEVICE_ANALOGIN_ASYNCH
+    if (analogin_active(&_adc)) {
+        return -1;
+    }
+#endif
+    detach_window();
+    _window_low = low;
+    _window_high = high;
+    _window_callback = callback;
+    _window_above = analogin_read_u16(&_adc) > high;
+    _window_active = true;
+    _irq.callback(&AnalogIn::window_irq_handler);
+    arm_window();
+    return 0;
+}
+
+void AnalogIn::detach_window()
+{
+    if (_window_active) {
+        analogin_window_stop(&_adc);
+        _window_active = false;
+    }
+}
+
+void AnalogIn::arm_window()
+{
+    // only a sample beyond the far threshold leaves the window
+    if (_window_above) {
+        analogin_window_start(&_adc, _window_low, 0xFFFF, _irq.entry());
+    } else {
+        analogin_window_start(&_adc, 0, _window_high, _irq.entry());
+    }
+}
+
+void AnalogIn::window_irq_handler(void)
+{
+    uint16_t sample = analogin_window_irq_handler(&_adc);
+    bool above = _window_above;
+    if (!above && sample > _window_high) {
+        above = true;
+    } else if (above && sample < _window_low) {
+        above = false;
+    } else {
+        return;
+    }
+    _window_above = above;
+    arm_window();
+    if (_window_callback) {
+        CompletionQueue::post(_window_signal, _window_callback.bind(above));
+    }
+}
+
+} // namespace mbed
+
+#endif
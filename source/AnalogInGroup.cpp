@@ -0,0 +1,86 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/AnalogInGroup.h"
+#include "mbed-drivers/mbed_assert.h"
+#include "minar/minar.h"
+#include "core-util/CriticalSectionLock.h"
+
+#if DEVICE_ANALOGIN_SCAN
+
+namespace mbed {
+
+AnalogInGroup::AnalogInGroup(const PinName *pins, size_t count, uint32_t oversample) :
+        _scan(),
+        _count(count)
+#if DEVICE_ANALOGIN_ASYNCH
+        , _irq(this),
+        _buffer(),
+        _callback(),
+        _usage(DMA_USAGE_NEVER)
+#endif
+{
+    MBED_ASSERT(count > 0 && count <= ANALOGIN_SCAN_MAX_CHANNELS);
+    analogin_scan_init(&_scan, pins, count, oversample);
+}
+
+void AnalogInGroup::read_u16(uint16_t *samples)
+{
+    analogin_scan_read(&_scan, samples);
+}
+
+#if DEVICE_ANALOGIN_ASYNCH
+
+int AnalogInGroup::read(const Buffer &buffer, uint32_t sample_rate, const event_callback_t &callback, int event)
+{
+    mbed::util::CriticalSectionLock lock;
+    if (analogin_scan_active(&_scan)) {
+        return -1;
+    }
+    _buffer = buffer;
+    _callback = callback;
+    _irq.callback(&AnalogInGroup::irq_handler_asynch);
+    analogin_scan_read_asynch(&_scan, (uint16_t *)buffer.buf, buffer.length / sizeof(uint16_t), sample_rate,
+            _irq.entry(), event, _usage);
+    return 0;
+}
+
+void AnalogInGroup::abort_read()
+{
+    analogin_scan_abort_asynch(&_scan);
+}
+
+int AnalogInGroup::set_dma_usage(DMAUsage usage)
+{
+    if (analogin_scan_active(&_scan)) {
+        return -1;
+    }
+    _usage = usage;
+    return 0;
+}
+
+void AnalogInGroup::irq_handler_asynch(void)
+{
+    int event = analogin_scan_irq_handler_asynch(&_scan);
+    if (_callback && (event & ANALOGIN_EVENT_ALL)) {
+        minar::Scheduler::postCallback(_callback.bind(_buffer, event & ANALOGIN_EVENT_ALL));
+    }
+}
+
+#endif
+
+} // namespace mbed
+
+#endif
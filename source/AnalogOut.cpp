@@ -0,0 +1,107 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/AnalogOut.h"
+#include "minar/minar.h"
+#include "core-util/CriticalSectionLock.h"
+
+#if DEVICE_ANALOGOUT && DEVICE_ANALOGOUT_ASYNCH
+
+namespace mbed {
+
+int AnalogOut::play(const Buffer &buffer, uint32_t sample_rate, const event_callback_t &callback,
+        int event, bool circular)
+{
+    mbed::util::CriticalSectionLock lock;
+    if (analogout_active(&_dac)) {
+        return -1;
+    }
+    _sample_rate = sample_rate;
+    _stream_buffer[0] = buffer;
+    _callback = callback;
+    _event = event;
+    _stream_half = 0;
+    _streaming = false;
+    start_buffer(buffer, circular);
+    return 0;
+}
+
+int AnalogOut::start_stream(uint32_t sample_rate, const Buffer &buffer0, const Buffer &buffer1,
+        const event_callback_t &callback, int event)
+{
+    mbed::util::CriticalSectionLock lock;
+    if (analogout_active(&_dac)) {
+        return -1;
+    }
+    _sample_rate = sample_rate;
+    _stream_buffer[0] = buffer0;
+    _stream_buffer[1] = buffer1;
+    _callback = callback;
+    _event = event;
+    _stream_half = 0;
+    _streaming = true;
+    start_buffer(buffer0, false);
+    return 0;
+}
+
+void AnalogOut::stop_stream()
+{
+    _streaming = false;
+}
+
+void AnalogOut::abort_play()
+{
+    mbed::util::CriticalSectionLock lock;
+    _streaming = false;
+    analogout_abort_asynch(&_dac);
+}
+
+int AnalogOut::set_dma_usage(DMAUsage usage)
+{
+    if (analogout_active(&_dac)) {
+        return -1;
+    }
+    _usage = usage;
+    return 0;
+}
+
+void AnalogOut::start_buffer(const Buffer &buffer, bool circular)
+{
+    _irq.callback(&AnalogOut::irq_handler_asynch);
+    analogout_write_asynch(&_dac, (const uint16_t *)buffer.buf, buffer.length / sizeof(uint16_t), _sample_rate,
+            circular, _irq.entry(), _event, _usage);
+}
+
+void AnalogOut::irq_handler_asynch(void)
+{
+    int event = analogout_irq_handler_asynch(&_dac);
+    Buffer buffer = _stream_buffer[_stream_half];
+    if (_streaming) {
+        if ((event & ANALOGOUT_EVENT_COMPLETE) && !(event & ANALOGOUT_EVENT_UNDERRUN)) {
+            // start the other buffer first, then report this one
+            _stream_half ^= 1;
+            start_buffer(_stream_buffer[_stream_half], false);
+        } else {
+            _streaming = false;
+        }
+    }
+    if (_callback && (event & _event & ANALOGOUT_EVENT_ALL)) {
+        minar::Scheduler::postCallback(_callback.bind(buffer, event & ANALOGOUT_EVENT_ALL));
+    }
+}
+
+} // namespace mbed
+
+#endif
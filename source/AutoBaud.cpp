@@ -0,0 +1,90 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/AutoBaud.h"
+
+#if DEVICE_PWMIN
+
+namespace mbed {
+
+namespace {
+
+const uint32_t standard_rates[] = {
+    1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600
+};
+
+} // namespace
+
+AutoBaud::AutoBaud(PinName rx) : _bit_us(0) {
+    pwmin_init(&_pwm, rx);
+}
+
+AutoBaud::~AutoBaud() {
+    pwmin_free(&_pwm);
+}
+
+int AutoBaud::detect(timestamp_t window_us) {
+    _bit_us = 0;
+    timestamp_t begin = us_ticker_read();
+    timestamp_t last_start = 0;
+    bool seen = false;
+    while ((timestamp_t)(us_ticker_read() - begin) < window_us) {
+        pwmin_cycle_t cycle;
+        if (pwmin_read(&_pwm, &cycle) != 0) {
+            continue;
+        }
+        // the same cycle as last time, or one from before the window
+        if ((seen && cycle.start == last_start) || (timestamp_t)(cycle.start - begin) > window_us) {
+            continue;
+        }
+        seen = true;
+        last_start = cycle.start;
+        timestamp_t pulses[2] = {cycle.high, cycle.period - cycle.high};
+        for (int i = 0; i < 2; i++) {
+            // a pulse shorter than the ticker's resolution tells nothing
+            if (pulses[i] != 0 && (_bit_us == 0 || pulses[i] < _bit_us)) {
+                _bit_us = pulses[i];
+            }
+        }
+    }
+    if (_bit_us == 0) {
+        return -1;
+    }
+    return nearest_standard((1000000 + _bit_us / 2) / _bit_us);
+}
+
+int AutoBaud::nearest_standard(uint32_t baudrate) {
+    if (baudrate == 0) {
+        return standard_rates[0];
+    }
+    // the ratio high / low of each pair, compared by cross-multiplying
+    uint32_t best = standard_rates[0];
+    uint64_t best_high = 0, best_low = 1;
+    for (size_t i = 0; i < sizeof(standard_rates) / sizeof(standard_rates[0]); i++) {
+        uint32_t rate = standard_rates[i];
+        uint64_t high = rate > baudrate ? rate : baudrate;
+        uint64_t low = rate > baudrate ? baudrate : rate;
+        if (best_high == 0 || high * best_low < best_high * low) {
+            best = rate;
+            best_high = high;
+            best_low = low;
+        }
+    }
+    return best;
+}
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,85 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/BootArena.h"
+#include "core-util/CriticalSectionLock.h"
+#include <stdlib.h>
+
+namespace mbed {
+
+const boot_arena_t boot_arena = boot_arena_t();
+
+#if MBED_BOOT_ARENA_SIZE
+
+#define BOOT_ARENA_WORDS ((MBED_BOOT_ARENA_SIZE + 7) / 8)
+
+#if defined(__ICCARM__)
+#pragma location = ".bss.boot_arena"
+static uint64_t arena[BOOT_ARENA_WORDS];
+#elif defined(__ARMCC_VERSION)
+static uint64_t arena[BOOT_ARENA_WORDS] __attribute__((section(".bss.boot_arena"), zero_init));
+#else
+static uint64_t arena[BOOT_ARENA_WORDS] __attribute__((section(".bss.boot_arena")));
+#endif
+
+static size_t arena_used = 0;
+
+void *BootArena::alloc(size_t size) {
+    size_t words = (size + 7) / 8;
+    {
+        mbed::util::CriticalSectionLock lock;
+        if (words <= BOOT_ARENA_WORDS - arena_used) {
+            void *p = &arena[arena_used];
+            arena_used += words;
+            return p;
+        }
+    }
+    return malloc(size);
+}
+
+bool BootArena::owns(const void *p) {
+    return p >= (const void *)&arena[0] && p < (const void *)&arena[BOOT_ARENA_WORDS];
+}
+
+size_t BootArena::used() {
+    return arena_used * 8;
+}
+
+size_t BootArena::remaining() {
+    return (BOOT_ARENA_WORDS - arena_used) * 8;
+}
+
+#else
+
+void *BootArena::alloc(size_t size) {
+    return malloc(size);
+}
+
+bool BootArena::owns(const void *p) {
+    (void)p;
+    return false;
+}
+
+size_t BootArena::used() {
+    return 0;
+}
+
+size_t BootArena::remaining() {
+    return 0;
+}
+
+#endif
+
+} // namespace mbed
@@ -20,30 +20,39 @@ namespace mbed {
 BusIn::BusIn(PinName p0, PinName p1, PinName p2, PinName p3, PinName p4, PinName p5, PinName p6, PinName p7, PinName p8, PinName p9, PinName p10, PinName p11, PinName p12, PinName p13, PinName p14, PinName p15) {
     PinName pins[16] = {p0, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15};
 
-    for (int i=0; i<16; i++) {
-        _pin[i] = (pins[i] != NC) ? new DigitalIn(pins[i]) : 0;
-    }
+    init(pins);
 }
 
 BusIn::BusIn(PinName pins[16]) {
-    for (int i=0; i<16; i++) {
-        _pin[i] = (pins[i] != NC) ? new DigitalIn(pins[i]) : 0;
-    }
+    init(pins);
 }
 
 BusIn::~BusIn() {
+}
+
+void BusIn::init(const PinName pins[16]) {
+    _connected = 0;
     for (int i=0; i<16; i++) {
-        if (_pin[i] != 0) {
-            delete _pin[i];
+        if (pins[i] != NC) {
+            gpio_init_in(&_pin[i], pins[i]);
+            _connected |= 1 << i;
         }
     }
+#if DEVICE_PORTIN
+    _port.init(pins, PIN_INPUT);
+#endif
 }
 
 int BusIn::read() {
+#if DEVICE_PORTIN
+    if (_port.active()) {
+        return _port.read();
+    }
+#endif
     int v = 0;
     for (int i=0; i<16; i++) {
-        if (_pin[i] != 0) {
-            v |= _pin[i]->read() << i;
+        if (_connected & (1 << i)) {
+            v |= gpio_read(&_pin[i]) << i;
         }
     }
     return v;
@@ -51,8 +60,8 @@ int BusIn::read() {
 
 void BusIn::mode(PinMode pull) {
     for (int i=0; i<16; i++) {
-        if (_pin[i] != 0) {
-            _pin[i]->mode(pull);
+        if (_connected & (1 << i)) {
+            gpio_mode(&_pin[i], pull);
         }
     }
 }
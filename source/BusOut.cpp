@@ -14,44 +14,71 @@
  * limitations under the License.
  */
 #include "mbed-drivers/BusOut.h"
+#include "mbed-drivers/mbed_critical.h"
 
 namespace mbed {
 
 BusOut::BusOut(PinName p0, PinName p1, PinName p2, PinName p3, PinName p4, PinName p5, PinName p6, PinName p7, PinName p8, PinName p9, PinName p10, PinName p11, PinName p12, PinName p13, PinName p14, PinName p15) {
     PinName pins[16] = {p0, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15};
 
-    for (int i=0; i<16; i++) {
-        _pin[i] = (pins[i] != NC) ? new DigitalOut(pins[i]) : 0;
-    }
+    init(pins);
 }
 
 BusOut::BusOut(PinName pins[16]) {
-    for (int i=0; i<16; i++) {
-        _pin[i] = (pins[i] != NC) ? new DigitalOut(pins[i]) : 0;
-    }
+    init(pins);
 }
 
 BusOut::~BusOut() {
+}
+
+void BusOut::init(const PinName pins[16]) {
+    _connected = 0;
     for (int i=0; i<16; i++) {
-        if (_pin[i] != 0) {
-            delete _pin[i];
+        if (pins[i] != NC) {
+            gpio_init_out(&_pin[i], pins[i]);
+            _connected |= 1 << i;
         }
     }
+#if DEVICE_PORTOUT
+    _port.init(pins, PIN_OUTPUT);
+#endif
 }
 
 void BusOut::write(int value) {
+#if DEVICE_PORTOUT
+    if (_port.active()) {
+        _port.write(value);
+        return;
+    }
+#endif
     for (int i=0; i<16; i++) {
-        if (_pin[i] != 0) {
-            _pin[i]->write((value >> i) & 1);
+        if (_connected & (1 << i)) {
+            gpio_write(&_pin[i], (value >> i) & 1);
         }
     }
 }
 
+void BusOut::write_atomic(int value) {
+#if DEVICE_PORTOUT
+    if (_port.active()) {
+        _port.write_atomic(value);
+        return;
+    }
+#endif
+    CriticalSection lock;
+    write(value);
+}
+
 int BusOut::read() {
+#if DEVICE_PORTOUT
+    if (_port.active()) {
+        return _port.read();
+    }
+#endif
     int v = 0;
     for (int i=0; i<16; i++) {
-        if (_pin[i] != 0) {
-            v |= _pin[i]->read() << i;
+        if (_connected & (1 << i)) {
+            v |= gpio_read(&_pin[i]) << i;
         }
     }
     return v;
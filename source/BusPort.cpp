@@ -0,0 +1,63 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/BusPort.h"
+
+#if DEVICE_PORTIN || DEVICE_PORTOUT || DEVICE_PORTINOUT
+
+namespace mbed {
+
+bool BusPort::init(const PinName pins[16], PinDirection direction) {
+    PortName names[BUS_PORT_GROUPS];
+    int groups = 0;
+
+    for (int i = 0; i < 16; i++) {
+        if (pins[i] == NC) {
+            continue;
+        }
+        PortName name;
+        int bit;
+        if (port_pin_lookup(pins[i], &name, &bit) != 0) {
+            return false;
+        }
+        int g;
+        for (g = 0; g < groups; g++) {
+            if (names[g] == name && _shift[g] == bit - i) {
+                break;
+            }
+        }
+        if (g == groups) {
+            if (groups == BUS_PORT_GROUPS) {
+                return false;
+            }
+            names[g] = name;
+            _shift[g] = bit - i;
+            _bus_mask[g] = 0;
+            groups++;
+        }
+        _bus_mask[g] |= 1 << i;
+    }
+
+    for (int g = 0; g < groups; g++) {
+        int mask = _shift[g] >= 0 ? _bus_mask[g] << _shift[g] : _bus_mask[g] >> -_shift[g];
+        port_init(&_port[g], names[g], mask, direction);
+    }
+    _groups = groups;
+    return groups > 0;
+}
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,147 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/CAN.h"
+
+#if DEVICE_CAN
+
+#include "mbed-drivers/mbed_critical.h"
+
+namespace mbed {
+
+CAN::CAN(PinName rd, PinName td) :
+        _can(),
+        _received_pending(false),
+        _rx_dropped(0) {
+    can_init(&_can, rd, td);
+    can_irq_init(&_can, (&CAN::_irq_handler), (uint32_t)this);
+    // the driver owns these two, whatever is attached
+    can_irq_set(&_can, IRQ_RX, 1);
+    can_irq_set(&_can, IRQ_TX, 1);
+}
+
+CAN::~CAN() {
+    can_irq_free(&_can);
+    can_free(&_can);
+}
+
+int CAN::frequency(int f) {
+    return can_frequency(&_can, f);
+}
+
+int CAN::write(const CANMessage &msg) {
+    CriticalSection lock;
+    // queued messages go first, to keep the bus order that of the writes
+    if (_tx_buffer.empty() && can_write(&_can, msg, 0)) {
+        return 1;
+    }
+    return _tx_buffer.push(msg) ? 1 : 0;
+}
+
+int CAN::read(CANMessage &msg) {
+    return _rx_buffer.pop(msg) ? 1 : 0;
+}
+
+void CAN::reset() {
+    can_reset(&_can);
+}
+
+unsigned char CAN::rderror() {
+    return can_rderror(&_can);
+}
+
+unsigned char CAN::tderror() {
+    return can_tderror(&_can);
+}
+
+void CAN::monitor(bool silent) {
+    can_monitor(&_can, (silent) ? 1 : 0);
+}
+
+int CAN::mode(Mode mode) {
+    return can_mode(&_can, (CanMode)mode);
+}
+
+int CAN::filter(unsigned int id, unsigned int mask, CANFormat format, int handle) {
+    return can_filter(&_can, id, mask, format, handle);
+}
+
+void CAN::attach(void (*fptr)(void), IrqType type) {
+    if (fptr) {
+        _irq[(CanIrqType)type].attach(fptr);
+        enable_irq(type);
+    } else {
+        disable_irq(type);
+    }
+}
+
+void CAN::attach_received(const mbed::util::FunctionPointer0<void> &callback) {
+    CriticalSection lock;
+    _received = callback;
+}
+
+void CAN::enable_irq(IrqType type) {
+    can_irq_set(&_can, (CanIrqType)type, 1);
+}
+
+void CAN::disable_irq(IrqType type) {
+    _irq[type] = mbed::util::FunctionPointer();
+    if (type != RxIrq && type != TxIrq) {
+        can_irq_set(&_can, (CanIrqType)type, 0);
+    }
+}
+
+void CAN::drain_rx() {
+    CANMessage msg;
+    while (can_read(&_can, &msg, 0)) {
+        if (!_rx_buffer.push(msg)) {
+            _rx_dropped++;
+        }
+    }
+    if (_received && !_rx_buffer.empty() && !_received_pending) {
+        _received_pending = true;
+        CompletionQueue::post(_received_completion,
+                mbed::util::FunctionPointer0<void>(this, &CAN::deliver_received).bind());
+    }
+}
+
+void CAN::fill_tx() {
+    CANMessage msg;
+    while (_tx_buffer.peek(msg) && can_write(&_can, msg, 0)) {
+        _tx_buffer.pop(msg);
+    }
+}
+
+void CAN::deliver_received() {
+    // cleared first, so a message arriving during the callback posts again
+    _received_pending = false;
+    if (_received) {
+        _received.call();
+    }
+}
+
+void CAN::_irq_handler(uint32_t id, CanIrqType type) {
+    CAN *handler = (CAN*)id;
+    if (type == IRQ_RX) {
+        handler->drain_rx();
+    } else if (type == IRQ_TX) {
+        handler->fill_tx();
+    }
+    handler->_irq[type].call();
+}
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,71 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/platform.h"
+#include "cmsis.h"
+#include "mbed-drivers/CThunk.h"
+
+#if CTHUNK_POOL_SIZE
+
+#include "mbed-drivers/mbed_critical.h"
+#include "mbed-drivers/mbed_error.h"
+
+namespace {
+
+// only the thunks are in the executable section; which are in use is not
+volatile CThunkTrampoline pool[CTHUNK_POOL_SIZE] __attribute__((section(CTHUNK_POOL_SECTION)));
+bool used[CTHUNK_POOL_SIZE];
+bool written = false;
+
+} // namespace
+
+volatile CThunkTrampoline *cthunk_pool_alloc(void)
+{
+    volatile CThunkTrampoline *thunk = NULL;
+    uint32_t state = mbed_critical_enter();
+    if (!written) {
+        for (int i = 0; i < CTHUNK_POOL_SIZE; i++) {
+            CTHUNK_ASSIGMENT(pool[i]);
+        }
+        cthunk_sync(pool, sizeof(pool));
+        written = true;
+    }
+    for (int i = 0; i < CTHUNK_POOL_SIZE; i++) {
+        if (!used[i]) {
+            used[i] = true;
+            thunk = &pool[i];
+            break;
+        }
+    }
+    mbed_critical_exit(state);
+    if (thunk == NULL) {
+        error("CThunk pool of %d exhausted\r\n", CTHUNK_POOL_SIZE);
+    }
+    return thunk;
+}
+
+void cthunk_pool_free(volatile CThunkTrampoline *thunk)
+{
+    if (thunk == NULL) {
+        return;
+    }
+    uint32_t state = mbed_critical_enter();
+    // stop the thunk reaching the old object, should its interrupt fire
+    thunk->instance = 0;
+    used[thunk - pool] = false;
+    mbed_critical_exit(state);
+}
+
+#endif
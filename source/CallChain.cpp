@@ -18,13 +18,15 @@
 
 namespace mbed {
 
-CallChain::CallChain(int size) : _chain(), _size(size), _elements(0) {
-    _chain = new pFunctionPointer_t[size]();
+CallChain::CallChain(int size) : _chain(), _size(size), _elements(0), _readers(0), _retired(NULL) {
+    _chain = _new_chain(size);
 }
 
 CallChain::~CallChain() {
+    // nothing can be calling a chain that is being destroyed
     clear();
-    delete _chain;
+    _reclaim();
+    delete[] _chain;
 }
 
 pFunctionPointer_t CallChain::add(void (*function)(void)) {
@@ -53,11 +55,15 @@ int CallChain::find(pFunctionPointer_t f) const {
 }
 
 void CallChain::clear() {
-    for(int i = 0; i < _elements; i ++) {
-        delete _chain[i];
-        _chain[i] = NULL;
-    }
+    if (_elements == 0)
+        return;
+    pFunctionPointer_t *old = _chain;
+    int elements = _elements;
+    _publish(_new_chain(_size));
     _elements = 0;
+    for (int i = 0; i < elements; i++)
+        _retire(NULL, old[i]);
+    _retire(old, NULL);
 }
 
 bool CallChain::remove(pFunctionPointer_t f) {
@@ -65,39 +71,95 @@ bool CallChain::remove(pFunctionPointer_t f) {
 
     if ((i = find(f)) == -1)
         return false;
-    if (i != _elements - 1)
-        memmove(_chain + i, _chain + i + 1, (_elements - i - 1) * sizeof(pFunctionPointer_t));
-    delete f;
     _elements --;
+    if (i == _elements) {
+        // the last function goes with a single store
+        _chain[i] = NULL;
+        _retire(NULL, f);
+    } else {
+        pFunctionPointer_t *old = _chain;
+        pFunctionPointer_t *new_chain = _new_chain(_size);
+        memcpy(new_chain, old, i * sizeof(pFunctionPointer_t));
+        memcpy(new_chain + i, old + i + 1, (_elements - i) * sizeof(pFunctionPointer_t));
+        _publish(new_chain);
+        _retire(old, f);
+    }
     return true;
 }
 
 void CallChain::call() {
-    for(int i = 0; i < _elements; i++)
-        _chain[i]->call();
+    // count this call before taking the array, so that a change that finds
+    // no calls running knows that nothing is using the array it replaced
+    _readers++;
+    for (pFunctionPointer_t *pf = _chain; *pf != NULL; pf++)
+        (*pf)->call();
+    _readers--;
+}
+
+pFunctionPointer_t* CallChain::_new_chain(int size) {
+    return new pFunctionPointer_t[size + 1]();
 }
 
-void CallChain::_check_size() {
-    if (_elements < _size)
+void CallChain::_publish(pFunctionPointer_t *chain) {
+    // the new array must be complete before call() can see it
+    __DMB();
+    _chain = chain;
+}
+
+void CallChain::_retire(pFunctionPointer_t *chain, pFunctionPointer_t function) {
+    _reclaim();
+    if (_readers == 0) {
+        delete[] chain;
+        delete function;
         return;
-    _size = (_size < 4) ? 4 : _size + 4;
-    pFunctionPointer_t* new_chain = new pFunctionPointer_t[_size]();
-    memcpy(new_chain, _chain, _elements * sizeof(pFunctionPointer_t));
-    delete _chain;
-    _chain = new_chain;
+    }
+    retired_t *r = new retired_t;
+    r->next = _retired;
+    r->chain = chain;
+    r->function = function;
+    _retired = r;
+}
+
+void CallChain::_reclaim() {
+    if (_readers != 0)
+        return;
+    while (_retired != NULL) {
+        retired_t *r = _retired;
+        _retired = r->next;
+        delete[] r->chain;
+        delete r->function;
+        delete r;
+    }
 }
 
 pFunctionPointer_t CallChain::common_add(pFunctionPointer_t pf) {
-    _check_size();
-    _chain[_elements] = pf;
+    if (_elements < _size) {
+        // the slot and the terminator after it are already NULL, so call()
+        // sees either the old end or the new function
+        __DMB();
+        _chain[_elements] = pf;
+    } else {
+        pFunctionPointer_t *old = _chain;
+        _size = (_size < 4) ? 4 : _size + 4;
+        pFunctionPointer_t *new_chain = _new_chain(_size);
+        memcpy(new_chain, old, _elements * sizeof(pFunctionPointer_t));
+        new_chain[_elements] = pf;
+        _publish(new_chain);
+        _retire(old, NULL);
+    }
     _elements ++;
     return pf;
 }
 
 pFunctionPointer_t CallChain::common_add_front(pFunctionPointer_t pf) {
-    _check_size();
-    memmove(_chain + 1, _chain, _elements * sizeof(pFunctionPointer_t));
-    _chain[0] = pf;
+    pFunctionPointer_t *old = _chain;
+    if (_elements == _size)
+        _size = (_size < 4) ? 4 : _size + 4;
+    pFunctionPointer_t *new_chain = _new_chain(_size);
+    new_chain[0] = pf;
+    memcpy(new_chain + 1, old, _elements * sizeof(pFunctionPointer_t));
+    _publish(new_chain);
+    _retire(old, NULL);
     _elements ++;
     return pf;
 }
@@ -0,0 +1,189 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/CompletionQueue.h"
+#include "mbed-drivers/ObjectPool.h"
+#include "mbed-drivers/mbed_timeline.h"
+#include "minar/minar.h"
+#include "core-util/CriticalSectionLock.h"
+
+namespace mbed {
+
+namespace {
+
+ObjectPool<CompletionQueue::Slot, COMPLETION_QUEUE_SIZE> pool;
+// one list per priority
+CompletionQueue::Slot *head[CompletionQueue::PRIORITIES];
+CompletionQueue::Slot *tail[CompletionQueue::PRIORITIES];
+uint16_t budget[CompletionQueue::PRIORITIES] = {
+    COMPLETION_QUEUE_BUDGET_HIGH,
+    COMPLETION_QUEUE_BUDGET_NORMAL,
+    COMPLETION_QUEUE_BUDGET_LOW
+};
+bool posted = false;
+volatile uint32_t overflow_count = 0;
+
+} // namespace
+
+void CompletionQueue::post(const mbed::util::FunctionPointerBind<void> &callback, Priority priority) {
+    Slot *slot = pool.alloc();
+    if (slot == NULL) {
+        overflow_count++;
+        minar::Scheduler::postCallback(callback);
+        return;
+    }
+    slot->_callback = callback;
+    slot->_priority = priority;
+    enqueue(slot);
+}
+
+void CompletionQueue::post(Slot &slot, const mbed::util::FunctionPointerBind<void> &callback) {
+    bool claimed;
+    {
+        mbed::util::CriticalSectionLock lock;
+        claimed = !slot._pending;
+        if (claimed) {
+            slot._pending = true;
+            slot._callback = callback;
+        }
+    }
+    if (claimed) {
+        enqueue(&slot);
+    } else {
+        // the previous completion has not been taken out yet
+        post(callback, slot.priority());
+    }
+}
+
+void CompletionQueue::post(Slot &slot) {
+    {
+        mbed::util::CriticalSectionLock lock;
+        if (slot._pending) {
+            return;
+        }
+        slot._pending = true;
+    }
+    enqueue(&slot);
+}
+
+void CompletionQueue::cancel(Slot &slot) {
+    mbed::util::CriticalSectionLock lock;
+    if (slot._pending) {
+        remove(&slot);
+    }
+}
+
+uint32_t CompletionQueue::overflows() {
+    return overflow_count;
+}
+
+void CompletionQueue::set_budget(Priority priority, uint16_t per_pass) {
+    if (priority < PRIORITIES) {
+        budget[priority] = per_pass;
+    }
+}
+
+void CompletionQueue::enqueue(Slot *slot) {
+    slot->_next = NULL;
+    slot->_pending = true;
+
+    bool post_drain;
+    {
+        mbed::util::CriticalSectionLock lock;
+        uint8_t q = (slot->_priority < PRIORITIES) ? slot->_priority : (uint8_t)PRIORITY_NORMAL;
+        slot->_queued = q;
+        if (tail[q] != NULL) {
+            tail[q]->_next = slot;
+        } else {
+            head[q] = slot;
+        }
+        tail[q] = slot;
+        post_drain = !posted;
+        posted = true;
+    }
+    if (post_drain) {
+        minar::Scheduler::postCallback(&CompletionQueue::drain);
+    }
+}
+
+void CompletionQueue::remove(Slot *slot) {
+    mbed::util::CriticalSectionLock lock;
+    uint8_t q = slot->_queued;
+    Slot *previous = NULL;
+    for (Slot *s = head[q]; s != NULL; previous = s, s = s->_next) {
+        if (s == slot) {
+            if (previous == NULL) {
+                head[q] = s->_next;
+            } else {
+                previous->_next = s->_next;
+            }
+            if (tail[q] == s) {
+                tail[q] = previous;
+            }
+            break;
+        }
+    }
+    slot->_pending = false;
+}
+
+void CompletionQueue::drain() {
+    uint16_t ran[PRIORITIES] = {0};
+    bool repost = false;
+    while (true) {
+        mbed::util::FunctionPointerBind<void> callback;
+        Slot *slot = NULL;
+        {
+            mbed::util::CriticalSectionLock lock;
+            bool waiting = false;
+            int q;
+            for (q = 0; q < PRIORITIES; q++) {
+                if (head[q] == NULL) {
+                    continue;
+                }
+                waiting = true;
+                if (budget[q] == 0 || ran[q] < budget[q]) {
+                    slot = head[q];
+                    break;
+                }
+            }
+            if (slot == NULL) {
+                // every priority with completions waiting has used its
+                // budget, so let the scheduler run something else first
+                repost = waiting;
+                posted = waiting;
+                break;
+            }
+            ran[q]++;
+            head[q] = slot->_next;
+            if (head[q] == NULL) {
+                tail[q] = NULL;
+            }
+            // take the callback out, freeing the slot for the next completion
+            callback = slot->_callback;
+            slot->_pending = false;
+        }
+        if (pool.owns(slot)) {
+            pool.free(slot);
+        }
+        MBED_TIMELINE_EVENT(MBED_TIMELINE_CALLBACK_BEGIN, slot);
+        callback.call();
+        MBED_TIMELINE_EVENT(MBED_TIMELINE_CALLBACK_END, slot);
+    }
+    if (repost) {
+        minar::Scheduler::postCallback(&CompletionQueue::drain);
+    }
+}
+
+} // namespace mbed
@@ -0,0 +1,140 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/Coroutine.h"
+
+namespace mbed {
+
+Coroutine::Coroutine() :
+        _co_state(STATE_DONE),
+        _finished((void (*)(void))NULL),
+        _resume(mbed::util::FunctionPointer0<void>(this, &Coroutine::resume).bind()),
+        _event(0),
+        _running(false),
+        _waiting(false) {
+}
+
+Coroutine::~Coroutine() {
+    _timeout.detach();
+}
+
+int Coroutine::start(const mbed::util::FunctionPointer0<void> &finished) {
+    if (_running) {
+        return -1;
+    }
+    _finished = finished;
+    _co_state = 0;
+    _event = 0;
+    _running = true;
+    _waiting = true;
+    CompletionQueue::post(_resume);
+    return 0;
+}
+
+#if DEVICE_SPI_ASYNCH
+namespace {
+
+// an empty buffer adds no segment, rather than one of no frames
+SPI::SPITransferAdder &segments(SPI::SPITransferAdder &adder, const Buffer &tx, const Buffer &rx) {
+    if (tx.length) {
+        adder.tx(tx.buf, tx.length);
+    }
+    if (rx.length) {
+        adder.rx(rx.buf, rx.length);
+    }
+    return adder;
+}
+
+} // namespace
+
+int Coroutine::transfer(SPI &spi, const Buffer &tx, const Buffer &rx, int event) {
+    return segments(spi.transfer().callback(SPI::event_callback_t(this, &Coroutine::transfer_done), event),
+                    tx, rx).apply();
+}
+#endif
+
+#if DEVICE_I2C_ASYNCH
+int Coroutine::transfer(I2C &i2c, int address, const Buffer &tx, const Buffer &rx, int event, bool repeated) {
+    return i2c.transfer(address, tx, rx, I2C::event_callback_t(this, &Coroutine::transfer_done), event, repeated);
+}
+#endif
+
+#if DEVICE_SERIAL_ASYNCH
+int Coroutine::write(SerialBase &serial, const Buffer &buffer, int event) {
+    return serial.write(buffer, SerialBase::event_callback_t(this, &Coroutine::serial_done), event);
+}
+
+int Coroutine::read(SerialBase &serial, const Buffer &buffer, int event) {
+    return serial.read(buffer, SerialBase::event_callback_t(this, &Coroutine::serial_done), event);
+}
+#endif
+
+int Coroutine::delay_us(timestamp_t us) {
+    _timeout.attach_us(this, &Coroutine::delay_done, us);
+    return 0;
+}
+
+int Coroutine::yield() {
+    _event = 0;
+    CompletionQueue::post(_resume);
+    return 0;
+}
+
+bool Coroutine::suspend(int rc) {
+    if (rc != 0) {
+        _event = FAILED;
+        return false;
+    }
+    _waiting = true;
+    return true;
+}
+
+void Coroutine::resume() {
+    if (!_waiting) {
+        return;
+    }
+    _waiting = false;
+    run();
+    if (_co_state == STATE_DONE) {
+        _running = false;
+        if (_finished) {
+            _finished.call();
+        }
+    }
+}
+
+void Coroutine::complete(int event) {
+    _event = event;
+    resume();
+}
+
+void Coroutine::transfer_done(Buffer tx, Buffer rx, int event) {
+    (void)tx;
+    (void)rx;
+    complete(event);
+}
+
+void Coroutine::serial_done(Buffer buffer, int event) {
+    (void)buffer;
+    complete(event);
+}
+
+void Coroutine::delay_done() {
+    // called from the ticker interrupt, so continue from the scheduler
+    _event = 0;
+    CompletionQueue::post(_resume);
+}
+
+} // namespace mbed
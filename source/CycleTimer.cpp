@@ -0,0 +1,40 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/CycleTimer.h"
+#include "mbed-drivers/test_env.h"
+#include <string.h>
+
+namespace mbed {
+
+static void report_value(const char *name, const char *suffix, uint32_t value) {
+    char full[32];
+    size_t n = strlen(name);
+    if (n > sizeof(full) - 7) {
+        n = sizeof(full) - 7;
+    }
+    memcpy(full, name, n);
+    strcpy(full + n, suffix);
+    notify_performance_coefficient(full, (unsigned int)value);
+}
+
+void ProfileStats::report(const char *name) const {
+    report_value(name, "_count", count());
+    report_value(name, "_min", min());
+    report_value(name, "_max", max());
+    report_value(name, "_avg", avg());
+}
+
+} // namespace mbed
@@ -0,0 +1,108 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/DMACopy.h"
+#include "mbed-drivers/mbed_critical.h"
+#if DEVICE_DMA_COPY
+#include "mbed-drivers/dma_cache.h"
+#endif
+
+#include <string.h>
+
+namespace mbed {
+
+DMACopy::DMACopy() :
+#if DEVICE_DMA_COPY
+        _irq(this),
+#endif
+        _hardware(false),
+        _busy(false),
+        _callback((void (*)(Buffer))NULL) {
+#if DEVICE_DMA_COPY
+    _hardware = dma_copy_init(&_copy) == 0;
+    _irq.callback(&DMACopy::irq_handler_asynch);
+    _dma.set_usage(DMA_USAGE_OPPORTUNISTIC);
+#endif
+}
+
+DMACopy::~DMACopy() {
+#if DEVICE_DMA_COPY
+    if (_hardware) {
+        dma_copy_free(&_copy);
+    }
+#endif
+}
+
+int DMACopy::copy(void *dst, const void *src, size_t length, const event_callback_t &callback) {
+    {
+        CriticalSection lock;
+        if (_busy) {
+            return -1;
+        }
+        _busy = true;
+    }
+    _dst = Buffer(dst, length);
+    _callback = callback;
+#if DEVICE_DMA_COPY
+    if (_hardware && length >= DMA_COPY_MIN) {
+        DMAUsage hint = _dma.begin();
+        if (hint != DMA_USAGE_NEVER) {
+            _deep_sleep.lock();
+            dma_cache_clean(src, length);
+            // no dirty line of the destination may be written back over the copy
+            dma_cache_clean_invalidate(dst, length);
+            dma_copy_asynch(&_copy, dst, src, length, _irq.entry(), hint);
+            return 0;
+        }
+        _dma.end();
+    }
+#endif
+    memcpy(dst, src, length);
+    finish();
+    return 0;
+}
+
+void DMACopy::finish() {
+    _busy = false;
+    if (_callback) {
+        CompletionQueue::post(_completion, _callback.bind(_dst));
+    }
+}
+
+#if DEVICE_DMA_COPY
+int DMACopy::set_dma_usage(DMAUsage usage) {
+    if (_busy) {
+        return -1;
+    }
+    return _dma.set_usage(usage);
+}
+
+void DMACopy::irq_handler_asynch(void) {
+    if (!dma_copy_irq_handler_asynch(&_copy)) {
+        return;
+    }
+    dma_cache_invalidate(_dst.buf, _dst.length);
+    _deep_sleep.unlock();
+    _dma.end();
+    finish();
+}
+#endif
+
+int dma_memcpy(void *dst, const void *src, size_t length, const DMACopy::event_callback_t &callback) {
+    static DMACopy shared;
+    return shared.copy(dst, src, length, callback);
+}
+
+} // namespace mbed
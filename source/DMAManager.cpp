@@ -0,0 +1,112 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/DMAManager.h"
+#include "core-util/CriticalSectionLock.h"
+
+namespace mbed {
+
+namespace {
+
+dma_stats_t stats;
+
+} // namespace
+
+bool DMAManager::take(Priority priority) {
+    mbed::util::CriticalSectionLock lock;
+#if DMA_CHANNEL_COUNT
+    uint32_t limit = DMA_CHANNEL_COUNT;
+    if (priority != PRIORITY_HIGH) {
+        limit -= DMA_CHANNELS_HIGH_PRIORITY;
+    }
+    if (stats.in_use >= limit) {
+        stats.denied++;
+        return false;
+    }
+#else
+    (void)priority;
+#endif
+    stats.in_use++;
+    stats.granted++;
+    if (stats.in_use > stats.peak) {
+        stats.peak = stats.in_use;
+    }
+    return true;
+}
+
+void DMAManager::give() {
+    mbed::util::CriticalSectionLock lock;
+    if (stats.in_use > 0) {
+        stats.in_use--;
+    }
+}
+
+void DMAManager::get_stats(dma_stats_t *s) {
+    mbed::util::CriticalSectionLock lock;
+    *s = stats;
+}
+
+void DMAManager::reset_stats() {
+    mbed::util::CriticalSectionLock lock;
+    stats.peak = stats.in_use;
+    stats.granted = 0;
+    stats.denied = 0;
+}
+
+int DMAChannel::set_usage(DMAUsage usage, DMAManager::Priority priority) {
+    give();
+    if (persistent(usage)) {
+        if (!DMAManager::take(priority)) {
+            // keep the old usage, taking its channel back if it had one
+            if (persistent(_usage)) {
+                _held = DMAManager::take(_priority);
+            }
+            return -1;
+        }
+        _held = true;
+    }
+    _usage = usage;
+    _priority = priority;
+    return 0;
+}
+
+DMAUsage DMAChannel::begin() {
+    if (_usage == DMA_USAGE_NEVER) {
+        return DMA_USAGE_NEVER;
+    }
+    mbed::util::CriticalSectionLock lock;
+    if (!_held) {
+        _held = DMAManager::take(_priority);
+    }
+    // without a channel, a usage that needs one is still passed on, for the
+    // HAL to decide; the others run without DMA
+    return (_held || persistent(_usage)) ? _usage : DMA_USAGE_NEVER;
+}
+
+void DMAChannel::end() {
+    if (!persistent(_usage)) {
+        give();
+    }
+}
+
+void DMAChannel::give() {
+    mbed::util::CriticalSectionLock lock;
+    if (_held) {
+        _held = false;
+        DMAManager::give();
+    }
+}
+
+} // namespace mbed
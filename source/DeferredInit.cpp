@@ -0,0 +1,130 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/DeferredInit.h"
+#include "mbed-drivers/CompletionQueue.h"
+#include "core-util/CriticalSectionLock.h"
+
+namespace mbed {
+
+namespace {
+
+// zero initialised, so jobs can be added before any constructor has run
+DeferredInit::Job *head;
+DeferredInit::Job *tail;
+unsigned int pending_count;
+bool started;
+bool announced;    // whether all_done has been called since the last add
+mbed::util::FunctionPointer0<void> all_done;
+CompletionQueue::Slot advance_slot;
+
+} // namespace
+
+void DeferredInit::Job::done() {
+    {
+        mbed::util::CriticalSectionLock lock;
+        if (_state != STATE_STARTED) {
+            return;
+        }
+        _state = STATE_DONE;
+        pending_count--;
+    }
+    // start the jobs waiting for this one, and tell of the end, from the scheduler
+    CompletionQueue::post(advance_slot, mbed::util::FunctionPointer0<void>(&DeferredInit::advance).bind());
+}
+
+void DeferredInit::add(Job &job) {
+    bool post;
+    {
+        mbed::util::CriticalSectionLock lock;
+        job._state = Job::STATE_IDLE;
+        job._next = NULL;
+        if (tail != NULL) {
+            tail->_next = &job;
+        } else {
+            head = &job;
+        }
+        tail = &job;
+        pending_count++;
+        announced = false;
+        post = started;
+    }
+    if (post) {
+        CompletionQueue::post(advance_slot, mbed::util::FunctionPointer0<void>(&DeferredInit::advance).bind());
+    }
+}
+
+void DeferredInit::attach(void (*callback)(void)) {
+    all_done.attach(callback);
+}
+
+void DeferredInit::attach(const mbed::util::FunctionPointer0<void> &callback) {
+    all_done = callback;
+}
+
+unsigned int DeferredInit::pending() {
+    return pending_count;
+}
+
+void DeferredInit::run() {
+    if (started) {
+        return;
+    }
+    started = true;
+    advance();
+}
+
+void DeferredInit::advance() {
+    // a job's start function may add jobs, so the list is walked again
+    // until nothing more starts
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        Job *previous = NULL;
+        Job *job = head;
+        while (job != NULL) {
+            Job *next = job->_next;
+            if (job->_state == Job::STATE_DONE) {
+                // unlink it, so it can be destroyed or added again
+                mbed::util::CriticalSectionLock lock;
+                if (previous != NULL) {
+                    previous->_next = next;
+                } else {
+                    head = next;
+                }
+                if (tail == job) {
+                    tail = previous;
+                }
+                job->_next = NULL;
+            } else {
+                if (job->_state == Job::STATE_IDLE && (job->_after == NULL || job->_after->finished())) {
+                    job->_state = Job::STATE_STARTED;
+                    job->_start.call(job);
+                    progress = true;
+                }
+                previous = job;
+            }
+            job = next;
+        }
+    }
+    if (pending_count == 0 && !announced) {
+        announced = true;
+        if (all_done) {
+            all_done.call();
+        }
+    }
+}
+
+} // namespace mbed
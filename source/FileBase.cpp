@@ -17,15 +17,79 @@
 
 namespace mbed {
 
+typedef char filebase_index_size_must_be_a_power_of_two[
+        ((FILEBASE_INDEX_SIZE & (FILEBASE_INDEX_SIZE - 1)) == 0 && FILEBASE_INDEX_SIZE > 0) ? 1 : -1];
+
 FileBase *FileBase::_head = NULL;
+FileBase *FileBase::_index[FILEBASE_INDEX_SIZE];
+unsigned int FileBase::_unindexed = 0;
+unsigned int FileBase::_generation = 0;
+
+#if FILEBASE_STATIC_TABLE
+
+FileBase::FileBase(const char *name, PathType t) : _next(NULL),
+                                                   _name(name),
+                                                   _path_type(t),
+                                                   _indexed(false) {
+}
+
+FileBase::~FileBase() {
+}
+
+int FileBase::table_find(const char *name, unsigned int len) {
+    int low = 0;
+    int high = (int)filebase_table_size - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        const char *entry = filebase_table[mid].name;
+        int cmp = std::strncmp(entry, name, len);
+        if (cmp == 0) {
+            // the first len characters match; a longer entry sorts after
+            if (entry[len] == '\0') {
+                return mid;
+            }
+            cmp = 1;
+        }
+        if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+FileBase *FileBase::lookup(const char *name, unsigned int len) {
+    int i = table_find(name, len);
+    return (i < 0) ? NULL : filebase_table[i].object;
+}
+
+FileBase *FileBase::get(int n) {
+    if (n < 0 || (unsigned int)n >= filebase_table_size) {
+        return NULL;
+    }
+    return filebase_table[n].object;
+}
+
+FileBase *FileBase::getNext(void) {
+    int i = (_name == NULL) ? -1 : table_find(_name, std::strlen(_name));
+    if (i < 0) {
+        return NULL;
+    }
+    return get(i + 1);
+}
+
+#else
 
 FileBase::FileBase(const char *name, PathType t) : _next(NULL),
                                                    _name(name),
-                                                   _path_type(t) {
+                                                   _path_type(t),
+                                                   _indexed(false) {
     if (name != NULL) {
         // put this object at head of the list
         _next = _head;
         _head = this;
+        index_insert(this);
     } else {
         _next = NULL;
     }
@@ -43,11 +107,92 @@ FileBase::~FileBase() {
             }
             p->_next = _next;
         }
+        _generation++;
+        if (_indexed) {
+            index_remove(this);
+        } else {
+            _unindexed--;
+        }
+    }
+}
+
+/* FNV-1a */
+unsigned int FileBase::hash(const char *name, unsigned int len) {
+    uint32_t h = 2166136261u;
+    for (unsigned int i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return h & (FILEBASE_INDEX_SIZE - 1);
+}
+
+FileBase *FileBase::index_find(const char *name, unsigned int len) {
+    unsigned int i = hash(name, len);
+    for (unsigned int probes = 0; probes < FILEBASE_INDEX_SIZE; probes++) {
+        FileBase *p = _index[i];
+        if (p == NULL) {
+            break;
+        }
+        if (std::strncmp(p->_name, name, len) == 0 && p->_name[len] == '\0') {
+            return p;
+        }
+        i = (i + 1) & (FILEBASE_INDEX_SIZE - 1);
+    }
+    return NULL;
+}
+
+void FileBase::index_insert(FileBase *fb) {
+    unsigned int len = std::strlen(fb->_name);
+    unsigned int i = hash(fb->_name, len);
+    for (unsigned int probes = 0; probes < FILEBASE_INDEX_SIZE; probes++) {
+        FileBase *p = _index[i];
+        if (p == NULL || (std::strncmp(p->_name, fb->_name, len) == 0 && p->_name[len] == '\0')) {
+            // the newest object of a name hides the older ones, as in the list
+            if (p != NULL) {
+                p->_indexed = false;
+                _unindexed++;
+            }
+            _index[i] = fb;
+            fb->_indexed = true;
+            return;
+        }
+        i = (i + 1) & (FILEBASE_INDEX_SIZE - 1);
+    }
+    _unindexed++;
+}
+
+void FileBase::index_remove(FileBase *fb) {
+    unsigned int i = hash(fb->_name, std::strlen(fb->_name));
+    while (_index[i] != fb) {
+        i = (i + 1) & (FILEBASE_INDEX_SIZE - 1);
+    }
+    _index[i] = NULL;
+    fb->_indexed = false;
+    // move the entries that follow back, so none is left past a gap in its probe sequence
+    unsigned int j = i;
+    while (true) {
+        j = (j + 1) & (FILEBASE_INDEX_SIZE - 1);
+        FileBase *p = _index[j];
+        if (p == NULL) {
+            break;
+        }
+        unsigned int home = hash(p->_name, std::strlen(p->_name));
+        // leave p if its home slot is cyclically in (i, j]
+        if (((j - home) & (FILEBASE_INDEX_SIZE - 1)) < ((j - i) & (FILEBASE_INDEX_SIZE - 1))) {
+            continue;
+        }
+        _index[i] = p;
+        _index[j] = NULL;
+        i = j;
     }
 }
 
 FileBase *FileBase::lookup(const char *name, unsigned int len) {
-    FileBase *p = _head;
+    FileBase *p = index_find(name, len);
+    if (p != NULL || _unindexed == 0) {
+        return p;
+    }
+    // some objects did not fit in the index, or are hidden by newer ones of the same name
+    p = _head;
     while (p != NULL) {
         /* Check that p->_name matches name and is the correct length */
         if (p->_name != NULL && std::strncmp(p->_name, name, len) == 0 && std::strlen(p->_name) == len) {
@@ -70,6 +215,16 @@ FileBase *FileBase::get(int n) {
     return NULL;
 }
 
+FileBase *FileBase::getNext(void) {
+    return _next;
+}
+
+#endif
+
+unsigned int FileBase::generation(void) {
+    return _generation;
+}
+
 const char* FileBase::getName(void) {
     return _name;
 }
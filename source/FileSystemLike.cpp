@@ -14,9 +14,99 @@
  * limitations under the License.
  */
 #include "mbed-drivers/FileSystemLike.h"
+#include "mbed-drivers/ObjectPool.h"
+#include "minar/minar.h"
+#include "core-util/CriticalSectionLock.h"
 
 namespace mbed {
 
+namespace {
+
+enum async_kind_t {
+    ASYNC_REMOVE,
+    ASYNC_RENAME,
+    ASYNC_MKDIR,
+    ASYNC_OPENDIR
+};
+
+/* An operation queued by the default asynchronous operations */
+struct async_op_t {
+    async_op_t *next;
+    FileSystemLike *fs;
+    async_kind_t kind;
+    const char *name;
+    const char *newname;
+    mode_t mode;
+    FileSystemLike::async_callback_t callback;
+    FileSystemLike::opendir_callback_t opendir_callback;
+};
+
+ObjectPool<async_op_t, FILESYSTEM_ASYNC_QUEUE_SIZE> async_pool;
+async_op_t *async_head;
+async_op_t *async_tail;
+
+/* Run the oldest queued operation; each queued operation posts one call */
+void async_run() {
+    async_op_t *op;
+    {
+        mbed::util::CriticalSectionLock lock;
+        op = async_head;
+        if (op == NULL) {
+            return;
+        }
+        async_head = op->next;
+        if (async_head == NULL) {
+            async_tail = NULL;
+        }
+    }
+    // the callbacks may queue more, so the slot is freed first
+    async_op_t done = *op;
+    async_pool.free(op);
+    if (done.kind == ASYNC_OPENDIR) {
+        DirHandle *dir = done.fs->opendir(done.name);
+        if (done.opendir_callback) {
+            done.opendir_callback.call(dir);
+        }
+        return;
+    }
+    int res;
+    switch (done.kind) {
+        case ASYNC_REMOVE:
+            res = done.fs->remove(done.name);
+            break;
+        case ASYNC_RENAME:
+            res = done.fs->rename(done.name, done.newname);
+            break;
+        default:
+            res = done.fs->mkdir(done.name, done.mode);
+            break;
+    }
+    if (done.callback) {
+        done.callback.call(res);
+    }
+}
+
+int async_queue(const async_op_t &request) {
+    async_op_t *op = async_pool.alloc(request);
+    if (op == NULL) {
+        return -1;
+    }
+    op->next = NULL;
+    {
+        mbed::util::CriticalSectionLock lock;
+        if (async_tail == NULL) {
+            async_head = op;
+        } else {
+            async_tail->next = op;
+        }
+        async_tail = op;
+    }
+    minar::Scheduler::postCallback(&async_run);
+    return 0;
+}
+
+} // namespace
+
 class BaseDirHandle : public DirHandle {
 public:
     /*
@@ -25,11 +115,18 @@ public:
       object were to be destroyed between readdirs.
       Using this method does mean though that destroying/creating objects can
       give unusual results from readdir.
+      The object found last is kept too, so that a listing can step to the
+      next one instead of counting from the start each time, as long as no
+      object has been removed since. Objects are added at the start of the
+      list, so adding them does not disturb a listing.
     */
     off_t n;
     struct dirent cur_entry;
+    FileBase *last;
+    off_t last_n;
+    unsigned int last_generation;
 
-    BaseDirHandle() : n(0), cur_entry() {
+    BaseDirHandle() : n(0), cur_entry(), last(NULL), last_n(0), last_generation(0) {
     }
 
     virtual int closedir() {
@@ -38,15 +135,49 @@ public:
     }
 
     virtual struct dirent *readdir() {
-        FileBase *ptr = FileBase::get(n);
+        FileBase *ptr = next();
+        if (ptr == NULL) return NULL;
+
+        /* Setup cur entry and return a pointer to it */
+        copy_name(&cur_entry, ptr);
+        return &cur_entry;
+    }
+
+    virtual int readdir_r(struct dirent *entry, struct dirent **result) {
+        FileBase *ptr = next();
+        if (ptr != NULL) {
+            copy_name(entry, ptr);
+        }
+        *result = ptr != NULL ? entry : NULL;
+        return 0;
+    }
+
+    FileBase *next() {
+        FileBase *ptr;
+        if (last != NULL && last_n + 1 == n && last_generation == FileBase::generation()) {
+            ptr = last->getNext();
+        } else {
+            ptr = FileBase::get(n);
+        }
         if (ptr == NULL) return NULL;
+        last = ptr;
+        last_n = n;
+        last_generation = FileBase::generation();
 
         /* Increment n, so next readdir gets the next item */
         n++;
+        return ptr;
+    }
 
-        /* Setup cur entry and return a pointer to it */
-        std::strncpy(cur_entry.d_name, ptr->getName(), NAME_MAX);
-        return &cur_entry;
+    static void copy_name(struct dirent *entry, FileBase *ptr) {
+        /* copy only the name, rather than padding all of d_name as strncpy does */
+        const char *name = ptr->getName();
+        size_t len = std::strlen(name);
+        if (len > NAME_MAX) {
+            len = NAME_MAX;
+        }
+        std::memcpy(entry->d_name, name, len);
+        entry->d_name[len] = '\0';
     }
 
     virtual off_t telldir() {
@@ -74,4 +205,42 @@ DirHandle *FileSystemLike::opendir() {
     return new BaseDirHandle();
 }
 
+int FileSystemLike::remove_async(const char *filename, const async_callback_t &callback) {
+    async_op_t op = async_op_t();
+    op.fs = this;
+    op.kind = ASYNC_REMOVE;
+    op.name = filename;
+    op.callback = callback;
+    return async_queue(op);
+}
+
+int FileSystemLike::rename_async(const char *oldname, const char *newname, const async_callback_t &callback) {
+    async_op_t op = async_op_t();
+    op.fs = this;
+    op.kind = ASYNC_RENAME;
+    op.name = oldname;
+    op.newname = newname;
+    op.callback = callback;
+    return async_queue(op);
+}
+
+int FileSystemLike::mkdir_async(const char *name, mode_t mode, const async_callback_t &callback) {
+    async_op_t op = async_op_t();
+    op.fs = this;
+    op.kind = ASYNC_MKDIR;
+    op.name = name;
+    op.mode = mode;
+    op.callback = callback;
+    return async_queue(op);
+}
+
+int FileSystemLike::opendir_async(const char *name, const opendir_callback_t &callback) {
+    async_op_t op = async_op_t();
+    op.fs = this;
+    op.kind = ASYNC_OPENDIR;
+    op.name = name;
+    op.opendir_callback = callback;
+    return async_queue(op);
+}
+
 } // namespace mbed
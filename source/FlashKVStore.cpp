@@ -0,0 +1,727 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/FlashKVStore.h"
+
+#if DEVICE_FLASH
+
+#include <cstring>
+#include <cstdlib>
+
+/* The size records are gathered in for programming, rounded up to a
+ * whole program unit */
+#define FLASH_KV_CHUNK_SIZE 64
+
+namespace mbed {
+
+typedef char flash_kv_index_size_must_be_a_power_of_two[
+        ((FLASH_KV_INDEX_SIZE & (FLASH_KV_INDEX_SIZE - 1)) == 0 && FLASH_KV_INDEX_SIZE > 1) ? 1 : -1];
+typedef char flash_kv_key_max_must_fit_a_byte[(FLASH_KV_KEY_MAX > 0 && FLASH_KV_KEY_MAX < 256) ? 1 : -1];
+
+namespace {
+
+const uint32_t SECTOR_MAGIC = 0x53564b46;   // "FKVS"
+const uint8_t RECORD_SET = 0x5a;
+const uint8_t RECORD_REMOVED = 0xa5;
+
+/* At the start of each sector in use. The sequence number counts up as
+ * the log moves on from sector to sector, so the newest sector has the
+ * highest. */
+struct sector_header_t {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t check;         // ~sequence
+};
+
+uint32_t round_up(uint32_t n, uint32_t align) {
+    return (n + align - 1) / align * align;
+}
+
+} // namespace
+
+/* At the start of each record, followed by the key and the value. The
+ * header is programmed before them, so a record cut short by a reset still
+ * gives its length, and the records after it can be found. */
+struct FlashKVStore::record_t {
+    uint32_t crc;           // of the key and the value
+    uint16_t value_length;
+    uint8_t key_length;
+    uint8_t flags;          // RECORD_SET or RECORD_REMOVED
+    uint32_t check;         // ~(value_length | key_length << 16 | flags << 24)
+};
+
+class FlashKVFileHandle : public FileHandle {
+public:
+    FlashKVFileHandle(FlashKVStore *store, const char *key, bool writing, bool append) :
+            _store(store), _data(NULL), _length(0), _pos(0), _writing(writing), _append(append), _dirty(false) {
+        std::strcpy(_key, key);
+    }
+
+    virtual ~FlashKVFileHandle() {
+        std::free(_data);
+    }
+
+    int load(const void *value, size_t length) {
+        if (length > FLASH_KV_FILE_MAX) {
+            return -1;
+        }
+        _data = (uint8_t *)std::malloc(FLASH_KV_FILE_MAX);
+        if (_data == NULL) {
+            return -1;
+        }
+        if (length > 0) {
+            std::memcpy(_data, value, length);
+        }
+        _length = length;
+        return 0;
+    }
+
+    virtual ssize_t write(const void *buffer, size_t length) {
+        if (!_writing) {
+            return -1;
+        }
+        if (_data == NULL && load(NULL, 0) < 0) {
+            return -1;
+        }
+        if (_append) {
+            _pos = _length;
+        }
+        if (_pos >= FLASH_KV_FILE_MAX) {
+            return (length == 0) ? 0 : -1;
+        }
+        if (length > FLASH_KV_FILE_MAX - _pos) {
+            length = FLASH_KV_FILE_MAX - _pos;
+        }
+        if (_pos > _length) {
+            // a seek past the end leaves a gap, which reads back as zeros
+            std::memset(_data + _length, 0, _pos - _length);
+        }
+        std::memcpy(_data + _pos, buffer, length);
+        _pos += length;
+        if (_pos > _length) {
+            _length = _pos;
+        }
+        _dirty = true;
+        return length;
+    }
+
+    virtual ssize_t read(void *buffer, size_t length) {
+        const uint8_t *value;
+        size_t value_length;
+        if (_writing) {
+            value = _data;
+            value_length = _length;
+        } else {
+            // records move when the store is written, so look the key up each time
+            value = (const uint8_t *)_store->get_pointer(_key, &value_length);
+            if (value == NULL) {
+                return -1;
+            }
+        }
+        if (_pos >= value_length) {
+            return 0;
+        }
+        if (length > value_length - _pos) {
+            length = value_length - _pos;
+        }
+        std::memcpy(buffer, value + _pos, length);
+        _pos += length;
+        return length;
+    }
+
+    virtual int close() {
+        int res = fsync();
+        delete this;
+        return res;
+    }
+
+    virtual int isatty() {
+        return 0;
+    }
+
+    virtual off_t lseek(off_t offset, int whence) {
+        off_t pos;
+        switch (whence) {
+            case SEEK_SET:
+                pos = offset;
+                break;
+            case SEEK_CUR:
+                pos = _pos + offset;
+                break;
+            case SEEK_END:
+                pos = flen() + offset;
+                break;
+            default:
+                return -1;
+        }
+        if (pos < 0 || (_writing && pos > FLASH_KV_FILE_MAX)) {
+            return -1;
+        }
+        _pos = pos;
+        return pos;
+    }
+
+    virtual int fsync() {
+        if (!_dirty) {
+            return 0;
+        }
+        _dirty = false;
+        return _store->set(_key, _data, _length);
+    }
+
+    virtual off_t flen() {
+        if (_writing) {
+            return _length;
+        }
+        size_t length = 0;
+        _store->get_pointer(_key, &length);
+        return length;
+    }
+
+private:
+    FlashKVStore *_store;
+    char _key[FLASH_KV_KEY_MAX + 1];
+    uint8_t *_data;         // the value being written, FLASH_KV_FILE_MAX bytes
+    size_t _length;
+    size_t _pos;
+    bool _writing;
+    bool _append;
+    bool _dirty;
+};
+
+FlashKVStore::FlashKVStore(const char *name, uint32_t start, uint32_t sectors) :
+        FileSystemLike(name),
+        _flash(),
+        _crc(CRC::CRC32),
+        _start(start),
+        _sectors(sectors),
+        _sector_size(0),
+        _align(4),
+        _header_size(0),
+        _chunk(NULL),
+        _chunk_size(0),
+        _head(0),
+        _head_pos(0),
+        _sequence(0),
+        _live(0),
+        _keys(0),
+        _mounted(false),
+        _index() {
+    flash_init(&_flash);
+    _sector_size = flash_get_sector_size(&_flash, start);
+    _align = round_up(flash_get_page_size(&_flash), 4);
+    _header_size = round_up(sizeof(record_t), _align);
+}
+
+FlashKVStore::~FlashKVStore() {
+    delete[] _chunk;
+    flash_free(&_flash);
+}
+
+int FlashKVStore::init() {
+    if (_mounted) {
+        return 0;
+    }
+    if (_sectors < 2 || _sector_size < 2 * _header_size) {
+        return -1;
+    }
+    if (_chunk == NULL) {
+        _chunk_size = round_up(FLASH_KV_CHUNK_SIZE, _align);
+        _chunk = new uint8_t[_chunk_size];
+    }
+    std::memset(_index, 0, sizeof(_index));
+    _keys = 0;
+    _live = 0;
+
+    // the head is the sector with the highest sequence number
+    bool found = false;
+    for (uint32_t s = 0; s < _sectors; s++) {
+        uint32_t sequence;
+        if (sector_valid(s, &sequence) && (!found || (int32_t)(sequence - _sequence) > 0)) {
+            found = true;
+            _head = s;
+            _sequence = sequence;
+        }
+    }
+    if (!found) {
+        return format();
+    }
+
+    // scan from the oldest sector, so that newer records replace older ones
+    for (uint32_t i = 1; i <= _sectors; i++) {
+        uint32_t s = (_head + i) % _sectors;
+        if (sector_valid(s, NULL) && scan(s, s == _head) < 0) {
+            return -1;
+        }
+    }
+
+    // the sector after the head is the spare, and must be erased
+    uint32_t spare = (_head + 1) % _sectors;
+    if (sector_valid(spare, NULL)) {
+        // moving its records to the head was cut short
+        if (pending(spare) > _sector_size - _head_pos) {
+            // a record cut short in the head has left no room for the rest,
+            // but the spare is whole until its erase, so start the move again
+            if (erase(_head) < 0) {
+                return -1;
+            }
+            return init();
+        }
+        if (collect(spare) < 0) {
+            return -1;
+        }
+    } else if (!blank(spare * _sector_size, _sector_size)) {
+        // its erase was cut short
+        if (erase(spare) < 0) {
+            return -1;
+        }
+    }
+    _mounted = true;
+    return 0;
+}
+
+int FlashKVStore::format() {
+    for (uint32_t s = 0; s < _sectors; s++) {
+        if (!blank(s * _sector_size, _sector_size) && erase(s) < 0) {
+            return -1;
+        }
+    }
+    sector_header_t header = {SECTOR_MAGIC, 1, ~(uint32_t)1};
+    if (program_header(0, &header, sizeof(header)) < 0) {
+        return -1;
+    }
+    _head = 0;
+    _head_pos = _header_size;
+    _sequence = 1;
+    _mounted = true;
+    return 0;
+}
+
+bool FlashKVStore::sector_valid(uint32_t sector, uint32_t *sequence) const {
+    const sector_header_t *header = (const sector_header_t *)flash(sector * _sector_size);
+    if (header->magic != SECTOR_MAGIC || header->check != ~header->sequence) {
+        return false;
+    }
+    if (sequence != NULL) {
+        *sequence = header->sequence;
+    }
+    return true;
+}
+
+bool FlashKVStore::blank(uint32_t offset, uint32_t length) const {
+    const uint32_t *p = (const uint32_t *)flash(offset);
+    for (uint32_t i = 0; i < length / 4; i++) {
+        if (p[i] != 0xFFFFFFFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t FlashKVStore::record_extent(uint32_t key_length, uint32_t value_length) const {
+    return _header_size + round_up(key_length + value_length, _align);
+}
+
+uint32_t FlashKVStore::record_extent(uint32_t offset) const {
+    const record_t *record = (const record_t *)flash(offset);
+    return record_extent(record->key_length, record->value_length);
+}
+
+/* Get the header of the record at offset, or NULL if there is no record
+ * there that can be trusted to give its length */
+const FlashKVStore::record_t *FlashKVStore::record_header(uint32_t offset, uint32_t sector_end) const {
+    const record_t *record = (const record_t *)flash(offset);
+    uint32_t fields = record->value_length | (uint32_t)record->key_length << 16 | (uint32_t)record->flags << 24;
+    if (record->check != ~fields || record->key_length == 0 || record->key_length > FLASH_KV_KEY_MAX ||
+            (record->flags != RECORD_SET && record->flags != RECORD_REMOVED) ||
+            offset + record_extent(record->key_length, record->value_length) > sector_end) {
+        return NULL;
+    }
+    return record;
+}
+
+bool FlashKVStore::record_valid(uint32_t offset) {
+    const record_t *record = (const record_t *)flash(offset);
+    _crc.reset();
+    _crc.update(flash(offset + _header_size), record->key_length + record->value_length);
+    return _crc.result() == record->crc;
+}
+
+int FlashKVStore::scan(uint32_t sector, bool head) {
+    uint32_t end = (sector + 1) * _sector_size;
+    uint32_t offset = sector * _sector_size + _header_size;
+    while (offset + _header_size <= end) {
+        if (blank(offset, sizeof(record_t))) {
+            break;
+        }
+        if (record_header(offset, end) == NULL) {
+            // nothing after a damaged header can be found, so the sector is done
+            offset = end;
+            break;
+        }
+        // a record cut short leaves the previous value
+        if (record_valid(offset) && apply(offset) < 0) {
+            return -1;
+        }
+        offset += record_extent(offset);
+    }
+    if (head) {
+        _head_pos = offset - sector * _sector_size;
+    }
+    return 0;
+}
+
+int FlashKVStore::apply(uint32_t offset) {
+    const record_t *record = (const record_t *)flash(offset);
+    const char *key = (const char *)flash(offset + _header_size);
+    uint32_t *slot = index_find(key, record->key_length);
+    if (slot != NULL) {
+        _live -= record_extent(*slot);
+        if (record->flags == RECORD_REMOVED) {
+            index_remove(slot);
+            _keys--;
+            return 0;
+        }
+    } else {
+        if (record->flags == RECORD_REMOVED) {
+            return 0;
+        }
+        if (_keys >= FLASH_KV_INDEX_SIZE - 1) {
+            return -1;
+        }
+        slot = index_insert(key, record->key_length);
+        _keys++;
+    }
+    *slot = offset;
+    _live += record_extent(offset);
+    return 0;
+}
+
+int FlashKVStore::program(uint32_t offset, const void *data, uint32_t length) {
+    return flash_program_page(&_flash, _start + offset, (const uint8_t *)data, length) == 0 ? 0 : -1;
+}
+
+int FlashKVStore::program_header(uint32_t offset, const void *header, uint32_t length) {
+    std::memset(_chunk, 0xFF, _header_size);
+    std::memcpy(_chunk, header, length);
+    return program(offset, _chunk, _header_size);
+}
+
+int FlashKVStore::program_record(uint32_t offset, const char *key, uint32_t key_length,
+                                 const void *value, uint32_t value_length, uint8_t flags) {
+    record_t header;
+    _crc.reset();
+    _crc.update(key, key_length);
+    _crc.update(value, value_length);
+    header.crc = _crc.result();
+    header.value_length = value_length;
+    header.key_length = key_length;
+    header.flags = flags;
+    header.check = ~(value_length | key_length << 16 | (uint32_t)flags << 24);
+    // the header goes first, so that a record cut short still gives its length
+    if (program_header(offset, &header, sizeof(header)) < 0) {
+        return -1;
+    }
+    // then the key and the value, gathered through the chunk
+    offset += _header_size;
+    const uint8_t *parts[2] = {(const uint8_t *)key, (const uint8_t *)value};
+    uint32_t lengths[2] = {key_length, value_length};
+    uint32_t fill = 0;
+    for (int part = 0; part < 2; part++) {
+        const uint8_t *p = parts[part];
+        uint32_t left = lengths[part];
+        while (left > 0) {
+            uint32_t n = _chunk_size - fill;
+            if (n > left) {
+                n = left;
+            }
+            std::memcpy(_chunk + fill, p, n);
+            fill += n;
+            p += n;
+            left -= n;
+            if (fill == _chunk_size) {
+                if (program(offset, _chunk, fill) < 0) {
+                    return -1;
+                }
+                offset += fill;
+                fill = 0;
+            }
+        }
+    }
+    if (fill > 0) {
+        uint32_t padded = round_up(fill, _align);
+        std::memset(_chunk + fill, 0xFF, padded - fill);
+        if (program(offset, _chunk, padded) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int FlashKVStore::append(const char *key, uint32_t key_length, const void *value, uint32_t value_length,
+                         uint8_t flags, uint32_t *offset) {
+    uint32_t extent = record_extent(key_length, value_length);
+    if (_head_pos + extent > _sector_size && advance(extent) < 0) {
+        return -1;
+    }
+    *offset = _head * _sector_size + _head_pos;
+    // the space is spent even if programming fails
+    _head_pos += extent;
+    return program_record(*offset, key, key_length, value, value_length, flags);
+}
+
+/* Move the log on to the spare sector, and collect the oldest sector into
+ * it to make the next spare, until there is room for a record */
+int FlashKVStore::advance(uint32_t extent) {
+    for (uint32_t i = 0; i + 1 < _sectors; i++) {
+        uint32_t next = (_head + 1) % _sectors;
+        uint32_t sequence = _sequence + 1;
+        sector_header_t header = {SECTOR_MAGIC, sequence, ~sequence};
+        if (program_header(next * _sector_size, &header, sizeof(header)) < 0) {
+            return -1;
+        }
+        _head = next;
+        _head_pos = _header_size;
+        _sequence = sequence;
+        if (collect((next + 1) % _sectors) < 0) {
+            return -1;
+        }
+        if (_head_pos + extent <= _sector_size) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Get the space the records in use in a sector take */
+uint32_t FlashKVStore::pending(uint32_t sector) {
+    uint32_t end = (sector + 1) * _sector_size;
+    uint32_t offset = sector * _sector_size + _header_size;
+    uint32_t total = 0;
+    while (offset + _header_size <= end && !blank(offset, sizeof(record_t))) {
+        const record_t *record = record_header(offset, end);
+        if (record == NULL) {
+            break;
+        }
+        uint32_t *slot = index_find((const char *)flash(offset + _header_size), record->key_length);
+        if (slot != NULL && *slot == offset) {
+            total += record_extent(offset);
+        }
+        offset += record_extent(offset);
+    }
+    return total;
+}
+
+/* Copy the records in use in a sector to the head, and erase the sector */
+int FlashKVStore::collect(uint32_t sector) {
+    uint32_t end = (sector + 1) * _sector_size;
+    uint32_t offset = sector * _sector_size + _header_size;
+    while (offset + _header_size <= end && !blank(offset, sizeof(record_t))) {
+        const record_t *record = record_header(offset, end);
+        if (record == NULL) {
+            break;
+        }
+        uint32_t extent = record_extent(offset);
+        const char *key = (const char *)flash(offset + _header_size);
+        uint32_t *slot = index_find(key, record->key_length);
+        // removal records can go, as no older record of their key is left
+        if (slot != NULL && *slot == offset) {
+            if (_head_pos + extent > _sector_size) {
+                return -1;
+            }
+            uint32_t to = _head * _sector_size + _head_pos;
+            _head_pos += extent;
+            if (program_record(to, key, record->key_length, key + record->key_length,
+                               record->value_length, RECORD_SET) < 0) {
+                return -1;
+            }
+            *slot = to;
+        }
+        offset += extent;
+    }
+    return erase(sector);
+}
+
+int FlashKVStore::erase(uint32_t sector) {
+    return flash_erase_sector(&_flash, _start + sector * _sector_size) == 0 ? 0 : -1;
+}
+
+/* FNV-1a */
+uint32_t FlashKVStore::hash(const char *key, uint32_t length) {
+    uint32_t h = 2166136261u;
+    for (uint32_t i = 0; i < length; i++) {
+        h = (h ^ (unsigned char)key[i]) * 16777619u;
+    }
+    return h & (FLASH_KV_INDEX_SIZE - 1);
+}
+
+uint32_t *FlashKVStore::index_find(const char *key, uint32_t length) {
+    uint32_t i = hash(key, length);
+    for (uint32_t probes = 0; probes < FLASH_KV_INDEX_SIZE; probes++) {
+        uint32_t offset = _index[i];
+        if (offset == 0) {
+            break;
+        }
+        const record_t *record = (const record_t *)flash(offset);
+        if (record->key_length == length && std::memcmp(flash(offset + _header_size), key, length) == 0) {
+            return &_index[i];
+        }
+        i = (i + 1) & (FLASH_KV_INDEX_SIZE - 1);
+    }
+    return NULL;
+}
+
+uint32_t *FlashKVStore::index_insert(const char *key, uint32_t length) {
+    // there is always a free slot, as one is kept free
+    uint32_t i = hash(key, length);
+    while (_index[i] != 0) {
+        i = (i + 1) & (FLASH_KV_INDEX_SIZE - 1);
+    }
+    return &_index[i];
+}
+
+void FlashKVStore::index_remove(uint32_t *slot) {
+    uint32_t i = slot - _index;
+    _index[i] = 0;
+    // move the entries that follow back, so none is left past a gap in its probe sequence
+    uint32_t j = i;
+    while (true) {
+        j = (j + 1) & (FLASH_KV_INDEX_SIZE - 1);
+        uint32_t offset = _index[j];
+        if (offset == 0) {
+            break;
+        }
+        const record_t *record = (const record_t *)flash(offset);
+        uint32_t home = hash((const char *)flash(offset + _header_size), record->key_length);
+        // leave the entry if its home slot is cyclically in (i, j]
+        if (((j - home) & (FLASH_KV_INDEX_SIZE - 1)) < ((j - i) & (FLASH_KV_INDEX_SIZE - 1))) {
+            continue;
+        }
+        _index[i] = offset;
+        _index[j] = 0;
+        i = j;
+    }
+}
+
+const void *FlashKVStore::get_pointer(const char *key, size_t *length) {
+    if (init() < 0) {
+        return NULL;
+    }
+    uint32_t *slot = index_find(key, std::strlen(key));
+    if (slot == NULL) {
+        return NULL;
+    }
+    const record_t *record = (const record_t *)flash(*slot);
+    *length = record->value_length;
+    return flash(*slot + _header_size + record->key_length);
+}
+
+int FlashKVStore::get(const char *key, void *buffer, size_t size) {
+    size_t length;
+    const void *value = get_pointer(key, &length);
+    if (value == NULL) {
+        return -1;
+    }
+    std::memcpy(buffer, value, length < size ? length : size);
+    return length;
+}
+
+int FlashKVStore::set(const char *key, const void *value, size_t length) {
+    if (init() < 0) {
+        return -1;
+    }
+    uint32_t key_length = std::strlen(key);
+    if (key_length == 0 || key_length > FLASH_KV_KEY_MAX || length > 0xFFFF) {
+        return -1;
+    }
+    uint32_t extent = record_extent(key_length, length);
+    if (extent > _sector_size - _header_size) {
+        return -1;
+    }
+    uint32_t *slot = index_find(key, key_length);
+    if (slot == NULL && _keys >= FLASH_KV_INDEX_SIZE - 1) {
+        return -1;
+    }
+    // the records in use must fit in every sector but the spare
+    uint32_t replaced = slot ? record_extent(*slot) : 0;
+    if (_live - replaced + extent > (_sectors - 1) * (_sector_size - _header_size)) {
+        return -1;
+    }
+    uint32_t offset;
+    if (append(key, key_length, value, length, RECORD_SET, &offset) < 0) {
+        return -1;
+    }
+    // the old record may have moved to make room
+    slot = index_find(key, key_length);
+    if (slot != NULL) {
+        _live -= record_extent(*slot);
+    } else {
+        slot = index_insert(key, key_length);
+        _keys++;
+    }
+    *slot = offset;
+    _live += extent;
+    return 0;
+}
+
+int FlashKVStore::remove(const char *key) {
+    if (init() < 0) {
+        return -1;
+    }
+    uint32_t key_length = std::strlen(key);
+    if (index_find(key, key_length) == NULL) {
+        return -1;
+    }
+    uint32_t offset;
+    if (append(key, key_length, NULL, 0, RECORD_REMOVED, &offset) < 0) {
+        return -1;
+    }
+    uint32_t *slot = index_find(key, key_length);
+    _live -= record_extent(*slot);
+    index_remove(slot);
+    _keys--;
+    return 0;
+}
+
+FileHandle *FlashKVStore::open(const char *filename, int flags) {
+    if (init() < 0) {
+        return NULL;
+    }
+    if (std::strlen(filename) == 0 || std::strlen(filename) > FLASH_KV_KEY_MAX) {
+        return NULL;
+    }
+    size_t length;
+    const void *value = get_pointer(filename, &length);
+    if ((flags & (O_WRONLY | O_RDWR)) == 0) {
+        return value ? new FlashKVFileHandle(this, filename, false, false) : NULL;
+    }
+    if (value == NULL && !(flags & O_CREAT)) {
+        return NULL;
+    }
+    FlashKVFileHandle *fh = new FlashKVFileHandle(this, filename, true, (flags & O_APPEND) != 0);
+    if (value != NULL && !(flags & O_TRUNC) && fh->load(value, length) < 0) {
+        delete fh;
+        return NULL;
+    }
+    if (value != NULL && (flags & O_TRUNC)) {
+        // the value is emptied even if nothing is written
+        fh->write("", 0);
+    }
+    return fh;
+}
+
+} // namespace mbed
+
+#endif
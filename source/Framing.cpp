@@ -0,0 +1,228 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/Framing.h"
+#include <string.h>
+
+#define SLIP_END        0xC0
+#define SLIP_ESC        0xDB
+#define SLIP_ESC_END    0xDC
+#define SLIP_ESC_ESC    0xDD
+
+#define HDLC_FLAG       0x7E
+#define HDLC_ESC        0x7D
+#define HDLC_XOR        0x20
+
+namespace mbed {
+
+size_t frame_encoded_size(FrameFormat format, size_t length) {
+    if (format == FRAME_COBS) {
+        // a code byte per 254 data bytes, the first code byte and the delimiter
+        return length + length / 254 + 2;
+    }
+    return 2 * length + 2;
+}
+
+static size_t cobs_encode(const uint8_t *frame, size_t length, uint8_t *out) {
+    size_t code_pos = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < length; i++) {
+        if (frame[i] == 0) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+            continue;
+        }
+        out[o++] = frame[i];
+        if (++code == 0xFF) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    out[o++] = 0;
+    return o;
+}
+
+size_t frame_encode(FrameFormat format, const void *frame, size_t length, char *out) {
+    const uint8_t *in = (const uint8_t *)frame;
+    uint8_t *o = (uint8_t *)out;
+    if (format == FRAME_COBS) {
+        return cobs_encode(in, length, o);
+    }
+    uint8_t end = format == FRAME_SLIP ? SLIP_END : HDLC_FLAG;
+    uint8_t esc = format == FRAME_SLIP ? SLIP_ESC : HDLC_ESC;
+    size_t n = 0;
+    o[n++] = end;
+    size_t i = 0;
+    while (i < length) {
+        // copy the run of bytes that need no escape in one go
+        size_t run = i;
+        while (run < length && in[run] != end && in[run] != esc) {
+            run++;
+        }
+        memcpy(o + n, in + i, run - i);
+        n += run - i;
+        i = run;
+        if (i < length) {
+            o[n++] = esc;
+            if (format == FRAME_SLIP) {
+                o[n++] = in[i] == SLIP_END ? SLIP_ESC_END : SLIP_ESC_ESC;
+            } else {
+                o[n++] = in[i] ^ HDLC_XOR;
+            }
+            i++;
+        }
+    }
+    o[n++] = end;
+    return n;
+}
+
+FrameDecoder::FrameDecoder(FrameFormat format, char *buffer, size_t size, const frame_callback_t &callback) :
+        _format(format),
+        _buffer(buffer),
+        _size(size),
+        _callback(callback),
+        _errors(0) {
+    reset();
+}
+
+void FrameDecoder::reset() {
+    _length = 0;
+    _discarding = false;
+    _escape = false;
+    _zero_pending = false;
+    _remaining = 0;
+}
+
+void FrameDecoder::feed(const char *data, size_t length) {
+    if (_format == FRAME_COBS) {
+        feed_cobs(data, length);
+    } else {
+        feed_escaped(data, length);
+    }
+}
+
+void FrameDecoder::feed_escaped(const char *data, size_t length) {
+    const uint8_t *in = (const uint8_t *)data;
+    uint8_t end = _format == FRAME_SLIP ? SLIP_END : HDLC_FLAG;
+    uint8_t esc = _format == FRAME_SLIP ? SLIP_ESC : HDLC_ESC;
+    size_t i = 0;
+    while (i < length) {
+        if (_escape) {
+            _escape = false;
+            uint8_t c = in[i];
+            if (c == end) {
+                // an escape then a delimiter: the frame was cut short
+                end_frame(false);
+                i++;
+                continue;
+            }
+            if (_format == FRAME_SLIP) {
+                if (c != SLIP_ESC_END && c != SLIP_ESC_ESC) {
+                    _discarding = true;
+                    i++;
+                    continue;
+                }
+                c = c == SLIP_ESC_END ? SLIP_END : SLIP_ESC;
+            } else {
+                c ^= HDLC_XOR;
+            }
+            append((const char *)&c, 1);
+            i++;
+            continue;
+        }
+        size_t run = i;
+        while (run < length && in[run] != end && in[run] != esc) {
+            run++;
+        }
+        append((const char *)in + i, run - i);
+        i = run;
+        if (i < length) {
+            if (in[i] == end) {
+                end_frame(true);
+            } else {
+                _escape = true;
+            }
+            i++;
+        }
+    }
+}
+
+void FrameDecoder::feed_cobs(const char *data, size_t length) {
+    const uint8_t *in = (const uint8_t *)data;
+    size_t i = 0;
+    while (i < length) {
+        if (in[i] == 0) {
+            // a block cut short by the delimiter is malformed
+            end_frame(_remaining == 0);
+            i++;
+            continue;
+        }
+        if (_remaining == 0) {
+            if (_zero_pending) {
+                const char zero = 0;
+                append(&zero, 1);
+            }
+            _remaining = in[i] - 1;
+            _zero_pending = in[i] != 0xFF;
+            i++;
+            continue;
+        }
+        // the rest of the block, up to a delimiter, in one go
+        size_t run = i;
+        size_t limit = length - i < _remaining ? length : i + _remaining;
+        while (run < limit && in[run] != 0) {
+            run++;
+        }
+        append((const char *)in + i, run - i);
+        _remaining -= run - i;
+        i = run;
+    }
+}
+
+void FrameDecoder::append(const char *data, size_t length) {
+    if (_discarding || length == 0) {
+        return;
+    }
+    if (_length + length > _size) {
+        _discarding = true;
+        return;
+    }
+    memcpy(_buffer + _length, data, length);
+    _length += length;
+}
+
+void FrameDecoder::end_frame(bool valid) {
+    if (_discarding || !valid) {
+        _errors++;
+    } else if (_length > 0 && _callback) {
+        _callback.call(_buffer, _length);
+    }
+    _length = 0;
+    _discarding = false;
+    _escape = false;
+    _zero_pending = false;
+    _remaining = 0;
+}
+
+void FrameDecoder::on_read(Buffer buffer, int event) {
+    (void)event;
+    feed((const char *)buffer.buf, buffer.length);
+}
+
+} // namespace mbed
@@ -14,41 +14,133 @@
  * limitations under the License.
  */
 #include "mbed-drivers/I2C.h"
-#include "minar/minar.h"
+#include "mbed-drivers/CompletionQueue.h"
+#include "mbed-drivers/dma_cache.h"
+#include "mbed-drivers/mbed_timeline.h"
+#include "mbed-drivers/mbed_critical.h"
+#include "mbed-drivers/DigitalInOut.h"
+#include "mbed-drivers/wait_api.h"
+#if INTERRUPT_PRIORITY_CLASSES
+#include "mbed-drivers/InterruptManager.h"
+#endif
 
 #if DEVICE_I2C
 
+/* With a HAL that passes a context to its asynch handler, the interrupt
+ * comes straight to a static handler, and no thunk is needed */
+#if DEVICE_I2C_ASYNCH_CONTEXT
+#define I2C_IRQ_ENTRY 0
+#else
+#define I2C_IRQ_ENTRY _irq.entry()
+#endif
+
+/* Half a period of the 100kHz clock that recover_bus() sends */
+#define I2C_RECOVERY_HALF_PERIOD_US 5
+
 namespace mbed {
 
+#if DEVICE_I2C_INSTANCE
+I2C::peripheral_t I2C::_peripherals[I2C_PERIPHERAL_COUNT];
+#else
 I2C *I2C::_owner = NULL;
+#endif
 
 I2C::I2C(PinName sda, PinName scl) :
 #if DEVICE_I2C_ASYNCH
-                                     _irq(this), _usage(DMA_USAGE_NEVER),
+                                     _burst_index(0),
+                                     _timeout_us(I2C_TRANSFER_TIMEOUT_US),
+#if !DEVICE_I2C_ASYNCH_CONTEXT
+                                     _irq(this),
+#endif
+                                     _usage(DMA_USAGE_NEVER),
+                                     _completion_events(0),
+                                     _completion_signal(mbed::util::FunctionPointer0<void>(this, &I2C::deliver_completion).bind()),
+                                     _recovery(mbed::util::FunctionPointer0<void>(this, &I2C::finish_timeout).bind()),
+                                     _recovering(false),
+#endif
+                                      _i2c(),
+#if DEVICE_I2C_INSTANCE
+                                      _peripheral(NULL),
 #endif
-                                      _i2c(), _hz(100000) {
+                                      _hz(100000), _sda(sda), _scl(scl) {
     // The init function also set the frequency to 100000
     i2c_init(&_i2c, sda, scl);
+#if INTERRUPT_PRIORITY_CLASSES
+    InterruptManager::set_priority(i2c_irq_number(&_i2c), IRQ_PRIORITY_I2C);
+#endif
 
     // Used to avoid unnecessary frequency updates
+#if DEVICE_I2C_INSTANCE
+    uint32_t instance = i2c_instance(&_i2c);
+    peripheral_t *unused = NULL;
+    for (int i = 0; i < I2C_PERIPHERAL_COUNT; i++) {
+        if (_peripherals[i].hz == 0) {
+            if (unused == NULL) {
+                unused = &_peripherals[i];
+            }
+        } else if (_peripherals[i].instance == instance) {
+            _peripheral = &_peripherals[i];
+            break;
+        }
+    }
+    if (_peripheral == NULL) {
+        // with no room left, the frequency is set on every aquire()
+        _peripheral = unused;
+    }
+    if (_peripheral != NULL) {
+        _peripheral->instance = instance;
+        _peripheral->hz = _hz;
+    }
+#else
     _owner = this;
+#endif
 }
 
 void I2C::frequency(int hz) {
     _hz = hz;
-
+#if DEVICE_I2C_INSTANCE
+    aquire();
+#else
     // We want to update the frequency even if we are already the bus owners
     i2c_frequency(&_i2c, _hz);
 
     // Updating the frequency of the bus we become the owners of it
     _owner = this;
+#endif
+}
+
+#if DEVICE_SUSPEND
+int I2C::suspend() {
+#if DEVICE_I2C_ASYNCH
+    if (busy()) {
+        return -1;
+    }
+#endif
+    i2c_suspend(&_i2c);
+    return 0;
 }
 
+void I2C::resume() {
+    i2c_resume(&_i2c);
+}
+#endif
+
 void I2C::aquire() {
+#if DEVICE_I2C_INSTANCE
+    if (_peripheral == NULL) {
+        i2c_frequency(&_i2c, _hz);
+    } else if (_peripheral->hz != _hz) {
+        i2c_frequency(&_i2c, _hz);
+        _peripheral->hz = _hz;
+    }
+#else
+    // without an instance to tell the peripherals apart, another object's
+    // peripheral may be this one, so reprogram whenever it was used last
     if (_owner != this) {
         i2c_frequency(&_i2c, _hz);
         _owner = this;
     }
+#endif
 }
 
 // write - Master Transmitter Mode
@@ -83,6 +175,43 @@ int I2C::read(int ack) {
     }
 }
 
+int I2C::read_reg(int address, char reg) {
+    char value;
+    if (read_regs(address, reg, &value, 1)) {
+        return -1;
+    }
+    return (unsigned char)value;
+}
+
+int I2C::read_regs(int address, char reg, char *data, int length) {
+    aquire();
+
+    // write the register address, then read after a repeated start
+    if (i2c_write(&_i2c, address, &reg, 1, 0) != 1) {
+        return 1;
+    }
+    int read = i2c_read(&_i2c, address, data, length, 1);
+
+    return length != read;
+}
+
+int I2C::write_reg(int address, char reg, char value) {
+    return write_regs(address, reg, &value, 1);
+}
+
+int I2C::write_regs(int address, char reg, const char *data, int length) {
+    aquire();
+
+    i2c_start(&_i2c);
+    int nack = i2c_byte_write(&_i2c, address & ~1) != 1 || i2c_byte_write(&_i2c, reg) != 1;
+    for (int i = 0; i < length && !nack; i++) {
+        nack = i2c_byte_write(&_i2c, data[i]) != 1;
+    }
+    i2c_stop(&_i2c);
+
+    return nack;
+}
+
 void I2C::start(void) {
     i2c_start(&_i2c);
 }
@@ -91,39 +220,583 @@ void I2C::stop(void) {
     i2c_stop(&_i2c);
 }
 
+int I2C::recover_bus(void) {
+    int released;
+    {
+        // the bus has pull-ups, so both lines are only ever driven low
+        DigitalInOut sda(_sda, PIN_INPUT, PullNone, 1);
+        DigitalInOut scl(_scl, PIN_OUTPUT, OpenDrain, 1);
+        wait_us(I2C_RECOVERY_HALF_PERIOD_US);
+        // a slave part way through sending a byte lets go before nine clocks
+        for (int i = 0; i < 9 && !sda.read(); i++) {
+            scl.write(0);
+            wait_us(I2C_RECOVERY_HALF_PERIOD_US);
+            scl.write(1);
+            wait_us(I2C_RECOVERY_HALF_PERIOD_US);
+        }
+        released = sda.read();
+        // stop condition: SDA rises while SCL is high
+        sda.mode(OpenDrain);
+        sda.output();
+        sda.write(0);
+        wait_us(I2C_RECOVERY_HALF_PERIOD_US);
+        sda.write(1);
+        wait_us(I2C_RECOVERY_HALF_PERIOD_US);
+    }
+    // hand the pins back to the peripheral
+    i2c_init(&_i2c, _sda, _scl);
+    i2c_frequency(&_i2c, _hz);
+#if DEVICE_I2C_INSTANCE
+    if (_peripheral != NULL) {
+        _peripheral->hz = _hz;
+    }
+#else
+    _owner = this;
+#endif
+    return released ? 0 : -1;
+}
+
 #if DEVICE_I2C_ASYNCH
 
-int I2C::transfer(int address, char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, const event_callback_t& callback, int event, bool repeated) {
-    return transfer(address, Buffer(tx_buffer, tx_length), Buffer(rx_buffer, rx_length), callback, event, repeated);
+int I2C::transfer(int address, char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, const event_callback_t& callback, int event, bool repeated, uint8_t priority) {
+    return transfer(address, Buffer(tx_buffer, tx_length), Buffer(rx_buffer, rx_length), callback, event, repeated, priority);
 }
 
-int I2C::transfer(int address, const Buffer& tx_buffer, const Buffer& rx_buffer, const event_callback_t& callback, int event, bool repeated) {
-    if (i2c_active(&_i2c)) {
-        return -1; // transaction ongoing
+int I2C::transfer(int address, const Buffer& tx_buffer, const Buffer& rx_buffer, const event_callback_t& callback, int event, bool repeated, uint8_t priority) {
+    transaction_data_t td;
+    td.tx_buffer = tx_buffer;
+    td.rx_buffer = rx_buffer;
+    td.event = event;
+    td.callback = callback;
+    td.address = address;
+    td.repeated = repeated;
+    td.reg_length = 0;
+    td.burst = NULL;
+    td.burst_count = 0;
+    td.segment_count = 0;
+    td.priority = priority;
+
+    // the IRQ handler may finish the current transfer and start the next
+    CriticalSection lock;
+    if (busy()) {
+        return queue_transfer(td);
     }
-    aquire();
+    start_transfer(td);
+    return 0;
+}
 
-    _current_transaction.tx_buffer = tx_buffer;
-    _current_transaction.rx_buffer = rx_buffer;
-    _current_transaction.callback = callback;
-    int stop = (repeated) ? 0 : 1;
-    _irq.callback(&I2C::irq_handler_asynch);
-    i2c_transfer_asynch(&_i2c, tx_buffer.buf, tx_buffer.length, rx_buffer.buf, rx_buffer.length, address, stop, _irq.entry(), event, _usage);
+int I2C::read_regs(int address, char reg, const Buffer& rx_buffer, const event_callback_t& callback, int event) {
+    transaction_data_t td;
+    td.rx_buffer = rx_buffer;
+    td.event = event;
+    td.callback = callback;
+    td.address = address;
+    td.repeated = false;
+    td.reg[0] = reg;
+    td.reg_length = 1;
+    td.burst = NULL;
+    td.burst_count = 0;
+    td.segment_count = 0;
+    td.priority = 0;
+
+    CriticalSection lock;
+    if (busy()) {
+        return queue_transfer(td);
+    }
+    start_transfer(td);
+    return 0;
+}
+
+int I2C::write_reg(int address, char reg, char value, const event_callback_t& callback, int event) {
+    transaction_data_t td;
+    td.event = event;
+    td.callback = callback;
+    td.address = address;
+    td.repeated = false;
+    td.reg[0] = reg;
+    td.reg[1] = value;
+    td.reg_length = 2;
+    td.burst = NULL;
+    td.burst_count = 0;
+    td.segment_count = 0;
+    td.priority = 0;
+
+    CriticalSection lock;
+    if (busy()) {
+        return queue_transfer(td);
+    }
+    start_transfer(td);
+    return 0;
+}
+
+int I2C::read_burst(register_read_t *reads, int count, const event_callback_t& callback, int event) {
+    if (reads == NULL || count <= 0) {
+        return -1;
+    }
+    transaction_data_t td;
+    td.event = event;
+    td.callback = callback;
+    td.address = reads[0].address;
+    td.repeated = false;
+    td.reg_length = 0;
+    td.burst = reads;
+    td.burst_count = count;
+    td.segment_count = 0;
+    td.priority = 0;
+
+    CriticalSection lock;
+    if (busy()) {
+        return queue_transfer(td);
+    }
+    start_transfer(td);
     return 0;
 }
 
 void I2C::abort_transfer(void)
 {
+    _timeout.detach();
     i2c_abort_asynch(&_i2c);
+#if DRIVER_STATS
+    _stats.finished(0);
+#endif
+    dequeue_transaction();
+    if (!i2c_active(&_i2c)) {
+        _deep_sleep.unlock();
+    }
+}
+
+int I2C::transfer(const I2CSequenceAdder &sequence)
+{
+    if (sequence._count == 0 || sequence._overflow) {
+        return -1;
+    }
+    transaction_data_t td;
+    td.event = sequence._event;
+    td.callback = sequence._callback;
+    td.address = sequence._segments[0].address;
+    td.repeated = false;
+    td.reg_length = 0;
+    td.burst = NULL;
+    td.burst_count = 0;
+    for (int i = 0; i < sequence._count; i++) {
+        td.segments[i] = sequence._segments[i];
+    }
+    // the bus is always released at the end
+    td.segments[sequence._count - 1].stop = true;
+    td.segment_count = sequence._count;
+    td.priority = sequence._priority;
+
+    CriticalSection lock;
+    if (busy()) {
+        return queue_transfer(td);
+    }
+    start_transfer(td);
+    return 0;
+}
+
+I2C::I2CSequenceAdder::I2CSequenceAdder(I2C *owner) :
+        _count(0), _overflow(false), _callback((void (*)(Buffer, Buffer, int))NULL), _event(I2C_EVENT_TRANSFER_COMPLETE),
+        _priority(0), _applied(false), _rc(0), _owner(owner)
+{
+}
+
+const I2C::I2CSequenceAdder & I2C::I2CSequenceAdder::operator =(const I2C::I2CSequenceAdder &a)
+{
+    for (int i = 0; i < a._count; i++) {
+        _segments[i] = a._segments[i];
+    }
+    _count = a._count;
+    _overflow = a._overflow;
+    _callback = a._callback;
+    _event = a._event;
+    _priority = a._priority;
+    _owner = a._owner;
+    _applied = false;
+    _rc = 0;
+    return *this;
+}
+
+I2C::I2CSequenceAdder::I2CSequenceAdder(const I2CSequenceAdder &a)
+{
+    *this = a;
+}
+
+I2C::I2CSequenceAdder & I2C::I2CSequenceAdder::write(int address, const char *data, int length)
+{
+    if (_count == I2C_SEQUENCE_SEGMENTS) {
+        _overflow = true;
+        return *this;
+    }
+    segment_t &segment = _segments[_count++];
+    segment.address = address & ~1;
+    segment.tx_buffer = Buffer((void *)data, length);
+    segment.rx_buffer = Buffer();
+    segment.stop = false;
+    return *this;
+}
+
+I2C::I2CSequenceAdder & I2C::I2CSequenceAdder::read(int address, char *data, int length)
+{
+    if (_count > 0) {
+        // the HAL reads after a repeated start in the same transfer as a write
+        segment_t &last = _segments[_count - 1];
+        if (!last.stop && last.rx_buffer.length == 0 && last.address == (address & ~1)) {
+            last.rx_buffer = Buffer(data, length);
+            return *this;
+        }
+    }
+    if (_count == I2C_SEQUENCE_SEGMENTS) {
+        _overflow = true;
+        return *this;
+    }
+    segment_t &segment = _segments[_count++];
+    segment.address = address & ~1;
+    segment.tx_buffer = Buffer();
+    segment.rx_buffer = Buffer(data, length);
+    segment.stop = false;
+    return *this;
+}
+
+I2C::I2CSequenceAdder & I2C::I2CSequenceAdder::stop()
+{
+    if (_count > 0) {
+        _segments[_count - 1].stop = true;
+    }
+    return *this;
+}
+
+I2C::I2CSequenceAdder & I2C::I2CSequenceAdder::callback(const event_callback_t &cb, int event)
+{
+    _callback = cb;
+    _event = event;
+    return *this;
+}
+
+I2C::I2CSequenceAdder & I2C::I2CSequenceAdder::priority(uint8_t level)
+{
+    _priority = level;
+    return *this;
+}
+
+int I2C::I2CSequenceAdder::apply()
+{
+    if (!_applied) {
+        _applied = true;
+        _rc = _owner->transfer(*this);
+    }
+    return _rc;
+}
+
+I2C::I2CSequenceAdder::~I2CSequenceAdder()
+{
+    apply();
+}
+
+I2C::I2CSequenceAdder I2C::sequence()
+{
+    I2CSequenceAdder a(this);
+    return a;
+}
+
+void I2C::set_timeout(uint32_t us)
+{
+    _timeout_us = us;
+}
+
+void I2C::timeout_handler()
+{
+    if (!i2c_active(&_i2c)) {
+        return; // the transfer finished as the timeout fired
+    }
+    // recovering the bus busy-waits for tens of micro-seconds, too long for
+    // the ticker interrupt, so it is left to the scheduler. Until then the
+    // peripheral's interrupt is kept out, and new transfers are queued.
+    _recovering = true;
+#if INTERRUPT_PRIORITY_CLASSES
+    NVIC_DisableIRQ(i2c_irq_number(&_i2c));
+#endif
+    i2c_abort_asynch(&_i2c);
+    CompletionQueue::post(_recovery);
+}
+
+void I2C::finish_timeout()
+{
+    recover_bus();
+#if DRIVER_STATS
+    _stats.finished(I2C_EVENT_ERROR | I2C_EVENT_TIMEOUT);
+#endif
+    event_callback_t callback = _current_transaction.callback;
+    Buffer tx_buffer = _current_transaction.tx_buffer;
+    Buffer rx_buffer = _current_transaction.rx_buffer;
+    if (_current_transaction.burst != NULL) {
+        tx_buffer = Buffer();
+        rx_buffer = _current_transaction.burst[_burst_index].rx;
+    } else if (_current_transaction.segment_count) {
+        tx_buffer = _current_transaction.segments[_burst_index].tx_buffer;
+        rx_buffer = _current_transaction.segments[_burst_index].rx_buffer;
+    }
+    if (callback) {
+        CompletionQueue::post(_completion, callback.bind(tx_buffer, rx_buffer, I2C_EVENT_ERROR | I2C_EVENT_TIMEOUT));
+    } else {
+        signal_completion(I2C_EVENT_ERROR | I2C_EVENT_TIMEOUT);
+    }
+    CriticalSection lock;
+    _recovering = false;
+#if INTERRUPT_PRIORITY_CLASSES
+    NVIC_EnableIRQ(i2c_irq_number(&_i2c));
+#endif
+    dequeue_transaction();
+    if (!i2c_active(&_i2c)) {
+        _deep_sleep.unlock();
+    }
+}
+
+void I2C::clear_transfer_buffer()
+{
+#if TRANSACTION_QUEUE_SIZE_I2C
+    CriticalSection lock;
+    _transaction_buffer.reset();
+#endif
+}
+
+void I2C::abort_all_transfers()
+{
+    clear_transfer_buffer();
+    abort_transfer();
+}
+
+#if TRANSACTION_QUEUE_SIZE_I2C
+void I2C::enqueue_transaction(const transaction_data_t &td)
+{
+    // fill the slot in place, rather than pushing a copy of a temporary
+    transaction_t *t = _transaction_buffer.emplace();
+    t->set_object(this);
+    *t->get_transaction() = td;
+}
+#endif
+
+int I2C::queue_transfer(const transaction_data_t &td)
+{
+#if TRANSACTION_QUEUE_SIZE_I2C
+    CriticalSection lock;
+    if (_transaction_buffer.full()) {
+        return -1; // the buffer is full
+    }
+    if (td.priority == 0) {
+        enqueue_transaction(td);
+#if DRIVER_STATS
+        _stats.queued(_transaction_buffer.size());
+#endif
+        return 0;
+    }
+    // rotate the queue once, inserting td behind the last transfer of the
+    // same or higher priority
+    int queued = _transaction_buffer.size();
+    bool inserted = false;
+    for (int i = 0; i < queued; i++) {
+        transaction_t t;
+        _transaction_buffer.pop(t);
+        if (!inserted && t.get_transaction()->priority < td.priority) {
+            enqueue_transaction(td);
+            inserted = true;
+        }
+        _transaction_buffer.push(t);
+    }
+    if (!inserted) {
+        enqueue_transaction(td);
+    }
+#if DRIVER_STATS
+    _stats.queued(_transaction_buffer.size());
+#endif
+    return 0;
+#else
+    (void)td;
+    return -1; // transaction ongoing
+#endif
+}
+
+void I2C::start_transfer(const transaction_data_t &td)
+{
+    _deep_sleep.lock();
+    aquire();
+
+    MBED_TIMELINE_EVENT(MBED_TIMELINE_I2C_START, this);
+#if DRIVER_STATS
+    uint32_t bytes = 0;
+    if (td.burst != NULL) {
+        for (int i = 0; i < td.burst_count; i++) {
+            bytes += 1 + td.burst[i].rx.length;
+        }
+    } else if (td.segment_count) {
+        for (int i = 0; i < td.segment_count; i++) {
+            bytes += td.segments[i].tx_buffer.length + td.segments[i].rx_buffer.length;
+        }
+    } else {
+        bytes = (td.reg_length ? td.reg_length : td.tx_buffer.length) + td.rx_buffer.length;
+    }
+    _stats.started(bytes);
+#endif
+    _current_transaction = td;
+    if (_timeout_us) {
+        // a whole burst shares the one timeout
+        _timeout.attach_us(this, &I2C::timeout_handler, _timeout_us);
+    }
+#if DEVICE_I2C_ASYNCH_CONTEXT
+    i2c_asynch_handler(&_i2c, &I2C::irq_handler_context, (uint32_t)this);
+#else
+    _irq.callback(&I2C::irq_handler_asynch);
+#endif
+    if (td.burst != NULL) {
+        _burst_index = 0;
+        start_burst_read();
+        return;
+    }
+    if (td.segment_count) {
+        _burst_index = 0;
+        start_segment();
+        return;
+    }
+    if (td.reg_length) {
+        // the register bytes are sent from the copy held for the transfer
+        _current_transaction.tx_buffer = Buffer(_current_transaction.reg, td.reg_length);
+    }
+    int stop = (td.repeated) ? 0 : 1;
+    dma_cache_clean(_current_transaction.tx_buffer.buf, _current_transaction.tx_buffer.length);
+    dma_cache_clean_invalidate(td.rx_buffer.buf, td.rx_buffer.length);
+    i2c_transfer_asynch(&_i2c, _current_transaction.tx_buffer.buf, _current_transaction.tx_buffer.length,
+            td.rx_buffer.buf, td.rx_buffer.length, td.address, stop, I2C_IRQ_ENTRY, td.event, _usage);
+}
+
+void I2C::start_burst_read()
+{
+    register_read_t &read = _current_transaction.burst[_burst_index];
+    // reads before the last one must always report back, to chain the next
+    bool last = (_burst_index == _current_transaction.burst_count - 1);
+    int event = last ? _current_transaction.event : I2C_EVENT_ALL;
+    dma_cache_clean(&read.reg, 1);
+    dma_cache_clean_invalidate(read.rx.buf, read.rx.length);
+    i2c_transfer_asynch(&_i2c, &read.reg, 1, read.rx.buf, read.rx.length, read.address, 1, I2C_IRQ_ENTRY, event, _usage);
+}
+
+void I2C::start_segment()
+{
+    segment_t &segment = _current_transaction.segments[_burst_index];
+    // as for a burst, the transfers before the last must report back
+    bool last = (_burst_index == _current_transaction.segment_count - 1);
+    int event = last ? _current_transaction.event : I2C_EVENT_ALL;
+    dma_cache_clean(segment.tx_buffer.buf, segment.tx_buffer.length);
+    dma_cache_clean_invalidate(segment.rx_buffer.buf, segment.rx_buffer.length);
+    i2c_transfer_asynch(&_i2c, segment.tx_buffer.buf, segment.tx_buffer.length, segment.rx_buffer.buf,
+            segment.rx_buffer.length, segment.address, segment.stop, I2C_IRQ_ENTRY, event, _usage);
+}
+
+void I2C::dequeue_transaction()
+{
+#if TRANSACTION_QUEUE_SIZE_I2C
+    // start the transfer from its slot, and only then give the slot up
+    CriticalSection lock;
+    transaction_t *t = _transaction_buffer.front();
+    if (t != NULL) {
+        start_transfer(*t->get_transaction());
+        _transaction_buffer.pop();
+    }
+#endif
+}
+
+#if DEVICE_I2C_ASYNCH_CONTEXT
+void I2C::irq_handler_context(uint32_t id)
+{
+    ((I2C *)id)->irq_handler_asynch();
+}
+#endif
+
+void I2C::set_completion_handler(const completion_handler_t &handler)
+{
+    CriticalSection lock;
+    _completion_handler = handler;
+}
+
+void I2C::signal_completion(int event)
+{
+    if (!_completion_handler) {
+        return;
+    }
+    {
+        CriticalSection lock;
+        _completion_events |= event;
+    }
+    // already pending if an earlier completion has not been handled yet
+    CompletionQueue::post(_completion_signal);
+}
+
+void I2C::deliver_completion()
+{
+    int event;
+    completion_handler_t handler;
+    {
+        CriticalSection lock;
+        event = _completion_events;
+        _completion_events = 0;
+        handler = _completion_handler;
+    }
+    if (event && handler) {
+        handler.call(event);
+    }
 }
 
 void I2C::irq_handler_asynch(void)
 {
+    if (_recovering) {
+        return; // the transfer was aborted, and the bus is not ours yet
+    }
     int event = i2c_irq_handler_asynch(&_i2c);
+    if (!event) {
+        return;
+    }
+    int steps = _current_transaction.burst != NULL ? _current_transaction.burst_count : _current_transaction.segment_count;
+    if (!(event & I2C_EVENT_TRANSFER_COMPLETE) || _burst_index + 1 >= steps) {
+        _timeout.detach();
+    }
+    Buffer tx_buffer = _current_transaction.tx_buffer;
+    Buffer rx_buffer = _current_transaction.rx_buffer;
+    if (_current_transaction.burst != NULL) {
+        dma_cache_invalidate(_current_transaction.burst[_burst_index].rx.buf, _current_transaction.burst[_burst_index].rx.length);
+        if ((event & I2C_EVENT_TRANSFER_COMPLETE) && _burst_index + 1 < _current_transaction.burst_count) {
+            _burst_index++;
+            start_burst_read();
+            return;
+        }
+        event &= _current_transaction.event;
+        tx_buffer = Buffer();
+        rx_buffer = _current_transaction.burst[_burst_index].rx;
+    } else if (_current_transaction.segment_count) {
+        segment_t &segment = _current_transaction.segments[_burst_index];
+        dma_cache_invalidate(segment.rx_buffer.buf, segment.rx_buffer.length);
+        if ((event & I2C_EVENT_TRANSFER_COMPLETE) && _burst_index + 1 < _current_transaction.segment_count) {
+            _burst_index++;
+            start_segment();
+            return;
+        }
+        event &= _current_transaction.event;
+        tx_buffer = segment.tx_buffer;
+        rx_buffer = segment.rx_buffer;
+    } else {
+        dma_cache_invalidate(rx_buffer.buf, rx_buffer.length);
+    }
+    MBED_TIMELINE_EVENT(MBED_TIMELINE_I2C_DONE, this);
+#if DRIVER_STATS
+    _stats.finished(event);
+#endif
     if (_current_transaction.callback && event) {
-        minar::Scheduler::postCallback(_current_transaction.callback.bind(_current_transaction.tx_buffer, _current_transaction.rx_buffer, event));
+        CompletionQueue::post(_completion, _current_transaction.callback.bind(tx_buffer, rx_buffer, event));
+    } else if (event) {
+        signal_completion(event);
+    }
+    // the bus is free, start the next transfer back to back
+    dequeue_transaction();
+    if (!i2c_active(&_i2c)) {
+        _deep_sleep.unlock();
     }
-
 }
 
 
@@ -0,0 +1,180 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/I2CSlave.h"
+
+#if DEVICE_I2CSLAVE
+
+#if DEVICE_I2CSLAVE_ASYNCH
+#include "mbed-drivers/dma_cache.h"
+#include "mbed-drivers/mbed_critical.h"
+
+#define I2C_SLAVE_EVENT_ADDRESS_MASK (I2C_SLAVE_EVENT_ADDRESS_READ | I2C_SLAVE_EVENT_ADDRESS_WRITE | I2C_SLAVE_EVENT_GENERAL_CALL)
+#endif
+
+namespace mbed {
+
+I2CSlave::I2CSlave(PinName sda, PinName scl) :
+#if DEVICE_I2CSLAVE_ASYNCH
+                                               _active(NULL),
+                                               _irq(this),
+                                               _usage(DMA_USAGE_NEVER),
+#endif
+                                               _i2c() {
+    i2c_init(&_i2c, sda, scl);
+    i2c_frequency(&_i2c, 100000);
+    i2c_slave_mode(&_i2c, 1);
+#if DEVICE_I2CSLAVE_ASYNCH
+    _irq.callback(&I2CSlave::irq_handler_asynch);
+#endif
+}
+
+void I2CSlave::frequency(int hz) {
+    i2c_frequency(&_i2c, hz);
+}
+
+void I2CSlave::address(int address) {
+    int addr = (address & 0xFF) | 1;
+    i2c_slave_address(&_i2c, 0, addr, 0);
+}
+
+int I2CSlave::receive(void) {
+    return i2c_slave_receive(&_i2c);
+}
+
+int I2CSlave::read(char *data, int length) {
+    return i2c_slave_read(&_i2c, data, length) != length;
+}
+
+int I2CSlave::read(void) {
+    return i2c_byte_read(&_i2c, 0);
+}
+
+int I2CSlave::write(const char *data, int length) {
+    return i2c_slave_write(&_i2c, data, length) != length;
+}
+
+int I2CSlave::write(int data) {
+    return i2c_byte_write(&_i2c, data);
+}
+
+void I2CSlave::stop(void) {
+    i2c_stop(&_i2c);
+}
+
+#if DEVICE_I2CSLAVE_ASYNCH
+
+void I2CSlave::attach_address(const address_callback_t &callback)
+{
+    CriticalSection lock;
+    _address_callback = callback;
+    // address matches interrupt from here on, rather than being polled
+    i2c_slave_enable_asynch(&_i2c, _irq.entry());
+}
+
+int I2CSlave::receive(const Buffer &buffer, const event_callback_t &callback, int event)
+{
+    CriticalSection lock;
+    if (_rx.buffer.buf != NULL) {
+        return -1;
+    }
+    _rx.buffer = buffer;
+    _rx.callback = callback;
+    _rx.event = event;
+    dma_cache_clean_invalidate(buffer.buf, buffer.length);
+    i2c_slave_enable_asynch(&_i2c, _irq.entry());
+    // if the master is already waiting on this buffer, this ends the stretch
+    i2c_slave_receive_asynch(&_i2c, buffer.buf, buffer.length, _usage);
+    return 0;
+}
+
+int I2CSlave::send(const Buffer &buffer, const event_callback_t &callback, int event)
+{
+    CriticalSection lock;
+    if (_tx.buffer.buf != NULL) {
+        return -1;
+    }
+    _tx.buffer = buffer;
+    _tx.callback = callback;
+    _tx.event = event;
+    dma_cache_clean(buffer.buf, buffer.length);
+    i2c_slave_enable_asynch(&_i2c, _irq.entry());
+    i2c_slave_send_asynch(&_i2c, buffer.buf, buffer.length, _usage);
+    return 0;
+}
+
+void I2CSlave::abort()
+{
+    CriticalSection lock;
+    i2c_slave_abort_asynch(&_i2c);
+    _rx.buffer = Buffer();
+    _tx.buffer = Buffer();
+    _active = NULL;
+    _deep_sleep.unlock();
+}
+
+int I2CSlave::set_dma_usage(DMAUsage usage)
+{
+    CriticalSection lock;
+    if (_rx.buffer.buf != NULL || _tx.buffer.buf != NULL) {
+        return -1;
+    }
+    _usage = usage;
+    return 0;
+}
+
+void I2CSlave::finish(transfer_t &t, int event)
+{
+    if (t.buffer.buf == NULL) {
+        return; // nothing was armed, the clock was stretched instead
+    }
+    Buffer done(t.buffer.buf, i2c_slave_asynch_count(&_i2c));
+    if (&t == &_rx) {
+        dma_cache_invalidate(done.buf, done.length);
+    }
+    t.buffer = Buffer();
+    if (t.callback && (event & t.event)) {
+        CompletionQueue::post((&t == &_rx) ? _rx_completion : _tx_completion, t.callback.bind(done, event & t.event));
+    }
+}
+
+void I2CSlave::irq_handler_asynch(void)
+{
+    int event = i2c_slave_irq_handler_asynch(&_i2c);
+    if (event & I2C_SLAVE_EVENT_ADDRESS_MASK) {
+        if (_active != NULL) {
+            // a repeated start ends the transfer in the other direction
+            finish(*_active, I2C_SLAVE_EVENT_STOP);
+        }
+        _deep_sleep.lock();
+        _active = (event & I2C_SLAVE_EVENT_ADDRESS_READ) ? &_tx : &_rx;
+        if (_address_callback) {
+            _address_callback.call(event & I2C_SLAVE_EVENT_ADDRESS_MASK);
+        }
+    }
+    if (_active != NULL && (event & I2C_SLAVE_EVENT_ALL)) {
+        finish(*_active, event & I2C_SLAVE_EVENT_ALL);
+    }
+    if (event & (I2C_SLAVE_EVENT_STOP | I2C_SLAVE_EVENT_ERROR)) {
+        _active = NULL;
+        _deep_sleep.unlock();
+    }
+}
+
+#endif
+
+} // namespace mbed
+
+#endif
@@ -14,15 +14,50 @@
  * limitations under the License.
  */
 #include "mbed-drivers/InterruptIn.h"
+#include "mbed-drivers/mbed_hal_inline.h"
+#include "minar/minar.h"
+#include "cmsis.h"
+#if DEVICE_INTERRUPTIN_PORT_BATCH
+#include "mbed-drivers/mbed_critical.h"
+#endif
 
 #if DEVICE_INTERRUPTIN
 
 namespace mbed {
 
+#if DEVICE_INTERRUPTIN_PORT_BATCH
+namespace {
+
+struct port_batch_t {
+    PortName port;
+    bool used;
+    InterruptIn::port_callback_t callback;
+};
+
+port_batch_t port_batches[INTERRUPTIN_BATCH_PORTS];
+
+} // namespace
+#endif
+
 InterruptIn::InterruptIn(PinName pin) : gpio(),
                                         gpio_irq(),
                                         _rise(),
-                                        _fall() {
+                                        _fall(),
+                                        _edges(0),
+                                        _debounce_us(0),
+                                        _rate_limit(0),
+                                        _rate_window_start(0),
+                                        _rate_count(0),
+                                        _filter_masked(false),
+                                        _filter_level(0),
+                                        _suppressed(0),
+                                        _filter_timeout(),
+                                        _capture_buffer(NULL),
+                                        _capture_mask(0),
+                                        _capture_head(0),
+                                        _capture_tail(0),
+                                        _capture_posted(false),
+                                        _capture_overflows(0) {
     gpio_irq_init(&gpio_irq, pin, (&InterruptIn::_irq_handler), (uint32_t)this);
     gpio_init_in(&gpio, pin);
 }
@@ -40,25 +75,214 @@ void InterruptIn::mode(PinMode pull) {
 }
 
 void InterruptIn::rise(void (*fptr)(void)) {
+    _rise.clear();
     if (fptr) {
-        _rise.attach(fptr);
-        gpio_irq_set(&gpio_irq, IRQ_RISE, 1);
+        add_rise(fptr);
     } else {
-        gpio_irq_set(&gpio_irq, IRQ_RISE, 0);
+        disable_edge(EDGE_RISE);
+    }
+}
+
+pFunctionPointer_t InterruptIn::add_rise(void (*fptr)(void)) {
+    pFunctionPointer_t pf = _rise.add(fptr);
+    if (pf != NULL) {
+        enable_edge(EDGE_RISE);
     }
+    return pf;
+}
+
+bool InterruptIn::remove_rise(pFunctionPointer_t pf) {
+    if (!_rise.remove(pf)) {
+        return false;
+    }
+    if (_rise.size() == 0) {
+        disable_edge(EDGE_RISE);
+    }
+    return true;
 }
 
 void InterruptIn::fall(void (*fptr)(void)) {
+    _fall.clear();
     if (fptr) {
-        _fall.attach(fptr);
-        gpio_irq_set(&gpio_irq, IRQ_FALL, 1);
+        add_fall(fptr);
     } else {
-        gpio_irq_set(&gpio_irq, IRQ_FALL, 0);
+        disable_edge(EDGE_FALL);
+    }
+}
+
+pFunctionPointer_t InterruptIn::add_fall(void (*fptr)(void)) {
+    pFunctionPointer_t pf = _fall.add(fptr);
+    if (pf != NULL) {
+        enable_edge(EDGE_FALL);
+    }
+    return pf;
+}
+
+bool InterruptIn::remove_fall(pFunctionPointer_t pf) {
+    if (!_fall.remove(pf)) {
+        return false;
+    }
+    if (_fall.size() == 0) {
+        disable_edge(EDGE_FALL);
+    }
+    return true;
+}
+
+int InterruptIn::capture(edge_t *buffer, uint32_t size, const capture_callback_t& callback, gpio_irq_event edges) {
+    if (size == 0 || (size & (size - 1)) != 0) {
+        return -1;
+    }
+    set_edges(0);
+    _capture_callback = callback;
+    _capture_mask = size - 1;
+    _capture_head = _capture_tail = 0;
+    _capture_overflows = 0;
+    _capture_buffer = buffer;
+    set_edges((edges != IRQ_FALL ? EDGE_RISE : 0) | (edges != IRQ_RISE ? EDGE_FALL : 0));
+    return 0;
+}
+
+void InterruptIn::stop_capture() {
+    set_edges(0);
+    _capture_buffer = NULL;
+    // restore the edges the handlers were attached for
+    if (!_filter_masked) {
+        set_edges(_edges);
+    }
+}
+
+void InterruptIn::set_edges(uint8_t edges) {
+    gpio_irq_set(&gpio_irq, IRQ_RISE, (edges & EDGE_RISE) ? 1 : 0);
+    gpio_irq_set(&gpio_irq, IRQ_FALL, (edges & EDGE_FALL) ? 1 : 0);
+}
+
+void InterruptIn::enable_edge(uint8_t edge) {
+    _edges |= edge;
+    // the edge is unmasked when the capture or filter window ends
+    if (_capture_buffer == NULL && !_filter_masked) {
+        set_edges(_edges);
+    }
+}
+
+void InterruptIn::disable_edge(uint8_t edge) {
+    _edges &= ~edge;
+    if (_capture_buffer == NULL && !_filter_masked) {
+        set_edges(_edges);
+    }
+}
+
+void InterruptIn::debounce(timestamp_t window_us) {
+    _debounce_us = window_us;
+    _filter_level = gpio_read(&gpio);
+}
+
+void InterruptIn::rate_limit(uint32_t calls_per_second) {
+    _rate_limit = calls_per_second;
+    _rate_window_start = mbed_us_ticker_read();
+    _rate_count = 0;
+}
+
+void InterruptIn::filter_edge(gpio_irq_event event) {
+    if (event == IRQ_NONE) {
+        return;
+    }
+    if (_filter_masked) {
+        // latched before the edges were masked
+        _suppressed++;
+        return;
+    }
+    timestamp_t now = mbed_us_ticker_read();
+    timestamp_t hold = _debounce_us;
+    if (_rate_limit) {
+        if ((timestamp_t)(now - _rate_window_start) >= 1000000) {
+            _rate_window_start = now;
+            _rate_count = 0;
+        }
+        if (++_rate_count >= _rate_limit) {
+            timestamp_t rest = 1000000 - (now - _rate_window_start);
+            if (rest > hold) {
+                hold = rest;
+            }
+        }
+    }
+    _filter_level = (event == IRQ_RISE);
+    if (hold) {
+        _filter_masked = true;
+        set_edges(0);
+        _filter_timeout.attach_us(this, &InterruptIn::filter_release, hold);
+    }
+    if (event == IRQ_RISE && (_edges & EDGE_RISE)) {
+        _rise.call();
+    } else if (event == IRQ_FALL && (_edges & EDGE_FALL)) {
+        _fall.call();
+    }
+}
+
+void InterruptIn::filter_release() {
+    _filter_masked = false;
+    if (_capture_buffer == NULL) {
+        set_edges(_edges);
+    }
+    // report the edge that the window hid, if the pin settled at the other level
+    int level = gpio_read(&gpio);
+    if (_debounce_us && level != _filter_level) {
+        if (_edges & (level ? EDGE_RISE : EDGE_FALL)) {
+            filter_edge(level ? IRQ_RISE : IRQ_FALL);
+        } else {
+            _filter_level = level;
+        }
+    }
+}
+
+void InterruptIn::capture_drain() {
+    // clear the flag first, so an edge stored from here on schedules again
+    _capture_posted = false;
+    __DMB();
+    while (_capture_buffer != NULL) {
+        uint32_t tail = _capture_tail;
+        uint32_t count = _capture_head - tail;
+        if (count == 0) {
+            break;
+        }
+        // hand the edges over up to the end of the ring, the rest next time
+        uint32_t offset = tail & _capture_mask;
+        if (count > _capture_mask + 1 - offset) {
+            count = _capture_mask + 1 - offset;
+        }
+        __DMB();
+        _capture_callback.call(_capture_buffer + offset, count);
+        __DMB();
+        _capture_tail = tail + count;
     }
 }
 
 void InterruptIn::_irq_handler(uint32_t id, gpio_irq_event event) {
     InterruptIn *handler = (InterruptIn*)id;
+    if (handler->_capture_buffer != NULL) {
+        timestamp_t now = mbed_us_ticker_read();
+        if (event == IRQ_NONE) {
+            return;
+        }
+        uint32_t head = handler->_capture_head;
+        if (head - handler->_capture_tail > handler->_capture_mask) {
+            handler->_capture_overflows++;
+            return;
+        }
+        edge_t &slot = handler->_capture_buffer[head & handler->_capture_mask];
+        slot.timestamp = now;
+        slot.edge = event;
+        __DMB();
+        handler->_capture_head = head + 1;
+        if (!handler->_capture_posted) {
+            handler->_capture_posted = true;
+            minar::Scheduler::postCallback(mbed::util::FunctionPointer0<void>(handler, &InterruptIn::capture_drain).bind());
+        }
+        return;
+    }
+    if (handler->_debounce_us || handler->_rate_limit) {
+        handler->filter_edge(event);
+        return;
+    }
     switch (event) {
         case IRQ_RISE: handler->_rise.call(); break;
         case IRQ_FALL: handler->_fall.call(); break;
@@ -66,6 +290,55 @@ void InterruptIn::_irq_handler(uint32_t id, gpio_irq_event event) {
     }
 }
 
+#if DEVICE_INTERRUPTIN_PORT_BATCH
+int InterruptIn::attach_port(PortName port, const port_callback_t &callback) {
+    port_batch_t *batch = NULL;
+    bool claimed;
+    {
+        CriticalSection lock;
+        for (int i = 0; i < INTERRUPTIN_BATCH_PORTS; i++) {
+            if (port_batches[i].used && port_batches[i].port == port) {
+                batch = &port_batches[i];
+                break;
+            }
+            if (!port_batches[i].used && batch == NULL) {
+                batch = &port_batches[i];
+            }
+        }
+        if (batch == NULL) {
+            return -1;
+        }
+        claimed = !batch->used;
+        batch->port = port;
+        batch->used = true;
+        batch->callback = callback;
+    }
+    if (gpio_irq_port_batch(port, &InterruptIn::_port_irq_handler, (uint32_t)batch) != 0) {
+        if (claimed) {
+            batch->used = false;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+void InterruptIn::detach_port(PortName port) {
+    for (int i = 0; i < INTERRUPTIN_BATCH_PORTS; i++) {
+        if (port_batches[i].used && port_batches[i].port == port) {
+            gpio_irq_port_batch(port, NULL, 0);
+            port_batches[i].used = false;
+        }
+    }
+}
+
+void InterruptIn::_port_irq_handler(uint32_t id, uint32_t value, uint32_t changed) {
+    port_batch_t *batch = (port_batch_t *)id;
+    if (changed) {
+        batch->callback.call(value, changed);
+    }
+}
+#endif
+
 void InterruptIn::enable_irq() {
     gpio_irq_enable(&gpio_irq);
 }
@@ -17,7 +17,13 @@
 #if defined(NVIC_NUM_VECTORS)
 
 #include "mbed-drivers/InterruptManager.h"
+#include "mbed-drivers/BootArena.h"
+#include "mbed-drivers/mbed_timeline.h"
 #include <string.h>
+#include <stdlib.h>
+#if INTERRUPT_MANAGER_STATS
+#include "core-util/CriticalSectionLock.h"
+#endif
 
 #define CHAIN_INITIAL_SIZE    4
 
@@ -25,39 +31,91 @@ namespace mbed {
 
 typedef void (*pvoidf)(void);
 
+#if INTERRUPT_MANAGER_STATIC_CHAINS
+InterruptManager InterruptManager::_static_instance;
+InterruptManager::chain_t InterruptManager::_pool[INTERRUPT_MANAGER_STATIC_CHAINS];
+InterruptManager* InterruptManager::_instance = &InterruptManager::_static_instance;
+#else
 InterruptManager* InterruptManager::_instance = (InterruptManager*)NULL;
+#endif
+
+#if INTERRUPT_MANAGER_STATS
+InterruptManager::irq_stats_t InterruptManager::_stats[NVIC_NUM_VECTORS];
+#endif
 
 InterruptManager* InterruptManager::get() {
+#if !INTERRUPT_MANAGER_STATIC_CHAINS
+    // the manager normally lives until reset, so it comes from the boot arena
     if (NULL == _instance)
-        _instance = new InterruptManager();
+        _instance = new (boot_arena) InterruptManager();
+#endif
     return _instance;
 }
 
 InterruptManager::InterruptManager() {
-    memset(_chains, 0, NVIC_NUM_VECTORS * sizeof(CallChain*));
+#if !INTERRUPT_MANAGER_STATIC_CHAINS
+    // the static instance is zero-initialised, and may already be in use
+    // by other static constructors by the time it's constructed
+    memset(_chains, 0, NVIC_NUM_VECTORS * sizeof(chain_t*));
+#endif
 }
 
 void InterruptManager::destroy() {
     // Not a good idea to call this unless NO interrupt at all
     // is under the control of the handler; otherwise, a system crash
     // is very likely to occur
+#if INTERRUPT_MANAGER_STATIC_CHAINS
+    _static_instance.delete_chains();
+#else
     if (NULL != _instance) {
-        delete _instance;
+        _instance->~InterruptManager();
+        if (!BootArena::owns(_instance))
+            free(_instance);
         _instance = (InterruptManager*)NULL;
     }
+#endif
 }
 
 InterruptManager::~InterruptManager() {
-    for(int i = 0; i < NVIC_NUM_VECTORS; i++)
-        if (NULL != _chains[i])
-            delete _chains[i];
+    delete_chains();
+}
+
+void InterruptManager::delete_chains() {
+    for(int i = 0; i < NVIC_NUM_VECTORS; i++) {
+        if (NULL != _chains[i]) {
+            delete_chain(_chains[i]);
+            _chains[i] = (chain_t*) NULL;
+        }
+    }
+}
+
+InterruptManager::chain_t* InterruptManager::new_chain() {
+#if INTERRUPT_MANAGER_STATIC_CHAINS
+    // chains in use always hold at least the original vector
+    for (int i = 0; i < INTERRUPT_MANAGER_STATIC_CHAINS; i++)
+        if (0 == _pool[i].size())
+            return &_pool[i];
+    return (chain_t*) NULL;
+#else
+    return new CallChain(CHAIN_INITIAL_SIZE);
+#endif
+}
+
+void InterruptManager::delete_chain(chain_t *chain) {
+#if INTERRUPT_MANAGER_STATIC_CHAINS
+    chain->clear();
+#else
+    delete chain;
+#endif
 }
 
 bool InterruptManager::must_replace_vector(IRQn_Type irq) {
     int irq_pos = get_irq_index(irq);
 
     if (NULL == _chains[irq_pos]) {
-        _chains[irq_pos] = new CallChain(CHAIN_INITIAL_SIZE);
+        _chains[irq_pos] = new_chain();
+        if (NULL == _chains[irq_pos])
+            return false;
         _chains[irq_pos]->add((pvoidf)NVIC_GetVector(irq));
         return true;
     }
@@ -68,12 +126,21 @@ pFunctionPointer_t InterruptManager::add_common(void (*function)(void), IRQn_Typ
     int irq_pos = get_irq_index(irq);
     bool change = must_replace_vector(irq);
 
+    if (NULL == _chains[irq_pos])
+        return NULL;
     pFunctionPointer_t pf = front ? _chains[irq_pos]->add_front(function) : _chains[irq_pos]->add(function);
     if (change)
         NVIC_SetVector(irq, (uint32_t)&InterruptManager::static_irq_helper);
     return pf;
 }
 
+bool InterruptManager::set_handler(void (*function)(void), IRQn_Type irq) {
+    if (NULL != _chains[get_irq_index(irq)])
+        return false;
+    NVIC_SetVector(irq, (uint32_t)function);
+    return true;
+}
+
 bool InterruptManager::remove_handler(pFunctionPointer_t handler, IRQn_Type irq) {
     int irq_pos = get_irq_index(irq);
 
@@ -83,16 +150,25 @@ bool InterruptManager::remove_handler(pFunctionPointer_t handler, IRQn_Type irq)
         return false;
     // If there's a single function left in the chain, swith the interrupt vector
     // to call that function directly. This way we save both time and space.
-    if (_chains[irq_pos]->size() == 1 && NULL != _chains[irq_pos]->get(0)->get_function()) {
+    // A chain that is being called, by a handler removing itself, is kept.
+    if (_chains[irq_pos]->size() == 1 && !_chains[irq_pos]->in_call()
+            && NULL != _chains[irq_pos]->get(0)->get_function()) {
         NVIC_SetVector(irq, (uint32_t)_chains[irq_pos]->get(0)->get_function());
-        delete _chains[irq_pos];
-        _chains[irq_pos] = (CallChain*) NULL;
+        delete_chain(_chains[irq_pos]);
+        _chains[irq_pos] = (chain_t*) NULL;
     }
     return true;
 }
 
 void InterruptManager::irq_helper() {
-    _chains[__get_IPSR()]->call();
+    uint32_t vector = __get_IPSR();
+    MBED_TIMELINE_EVENT(MBED_TIMELINE_IRQ_ENTER, vector);
+#if INTERRUPT_MANAGER_STATS
+    call_chain(_chains[vector], vector);
+#else
+    _chains[vector]->call();
+#endif
+    MBED_TIMELINE_EVENT(MBED_TIMELINE_IRQ_EXIT, vector);
 }
 
 int InterruptManager::get_irq_index(IRQn_Type irq) {
@@ -100,8 +176,51 @@ int InterruptManager::get_irq_index(IRQn_Type irq) {
 }
 
 void InterruptManager::static_irq_helper() {
+#if INTERRUPT_MANAGER_STATIC_CHAINS
+    // the manager is static, so this is a single table lookup
+#if INTERRUPT_MANAGER_STATS
+    uint32_t vector = __get_IPSR();
+    call_chain(_static_instance._chains[vector], vector);
+#else
+    _static_instance._chains[__get_IPSR()]->call();
+#endif
+#else
     InterruptManager::get()->irq_helper();
+#endif
+}
+
+#if INTERRUPT_MANAGER_STATS
+void InterruptManager::call_chain(chain_t *chain, uint32_t vector) {
+    // the same vector never preempts itself, so its entry needs no locking
+    irq_stats_t &stats = _stats[vector];
+    uint32_t total = 0;
+    for (int i = 0; i < chain->size(); i++) {
+        uint32_t start = CycleTimer::now();
+        chain->get(i)->call();
+        uint32_t ticks = CycleTimer::now() - start;
+        if (ticks > stats.worst_handler_ticks) {
+            stats.worst_handler_ticks = ticks;
+            stats.worst_handler = i;
+        }
+        total += ticks;
+    }
+    stats.count++;
+    stats.ticks += total;
+    if (total > stats.worst) {
+        stats.worst = total;
+    }
+}
+
+void InterruptManager::get_stats(IRQn_Type irq, irq_stats_t *stats) {
+    mbed::util::CriticalSectionLock lock;
+    *stats = _stats[(int)irq + NVIC_USER_IRQ_OFFSET];
+}
+
+void InterruptManager::reset_stats() {
+    mbed::util::CriticalSectionLock lock;
+    memset(_stats, 0, sizeof(_stats));
 }
+#endif
 
 } // namespace mbed
 
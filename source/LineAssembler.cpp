@@ -0,0 +1,103 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/LineAssembler.h"
+#include <string.h>
+
+namespace mbed {
+
+LineAssembler::LineAssembler(char *buffer, size_t size, const line_callback_t &callback) :
+        _buffer(buffer),
+        _size(size),
+        _length(0),
+        _callback(callback),
+        _overflows(0),
+        _discarding(false),
+        _skip_lf(false) {
+}
+
+void LineAssembler::reset() {
+    _length = 0;
+    _discarding = false;
+    _skip_lf = false;
+}
+
+void LineAssembler::feed(const char *data, size_t length) {
+    const char *end = data + length;
+    while (data < end) {
+        if (_skip_lf) {
+            // the LF of a CR LF split between chunks
+            _skip_lf = false;
+            if (*data == '\n') {
+                data++;
+                continue;
+            }
+        }
+        const char *p = data;
+        while (p < end && *p != '\n' && *p != '\r') {
+            p++;
+        }
+        if (p == end) {
+            append(data, p - data);
+            return;
+        }
+        size_t line_length = p - data;
+        if (*p == '\r') {
+            if (p + 1 == end) {
+                _skip_lf = true;
+            } else if (p[1] == '\n') {
+                p++;
+            }
+        }
+        if (_length == 0 && !_discarding) {
+            // the whole line is in this chunk
+            if (line_length <= _size) {
+                if (_callback) {
+                    _callback.call(data, line_length);
+                }
+            } else {
+                _overflows++;
+            }
+        } else {
+            append(data, line_length);
+            if (!_discarding && _callback) {
+                _callback.call(_buffer, _length);
+            }
+            _length = 0;
+            _discarding = false;
+        }
+        data = p + 1;
+    }
+}
+
+void LineAssembler::append(const char *data, size_t length) {
+    if (_discarding) {
+        return;
+    }
+    if (_length + length > _size) {
+        _overflows++;
+        _discarding = true;
+        return;
+    }
+    memcpy(_buffer + _length, data, length);
+    _length += length;
+}
+
+void LineAssembler::on_read(Buffer buffer, int event) {
+    (void)event;
+    feed((const char *)buffer.buf, buffer.length);
+}
+
+} // namespace mbed
@@ -0,0 +1,158 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/OneWire.h"
+#include "mbed-drivers/wait_api.h"
+#include "mbed-drivers/mbed_critical.h"
+#include <string.h>
+
+/* Standard speed timing, in microseconds */
+#define ONEWIRE_RESET_LOW_US        480     // reset pulse
+#define ONEWIRE_PRESENCE_US         70      // release to presence sample
+#define ONEWIRE_RESET_TAIL_US       410     // presence sample to first slot
+#define ONEWIRE_LOW_US              6       // low pulse starting a 1 or a read
+#define ONEWIRE_SAMPLE_US           9       // end of that pulse to read sample
+#define ONEWIRE_WRITE_ZERO_LOW_US   60      // low time of a 0
+#define ONEWIRE_WRITE_ZERO_REST_US  10      // recovery after a 0
+#define ONEWIRE_WRITE_ONE_REST_US   64      // rest of the slot after a 1
+#define ONEWIRE_READ_REST_US        55      // rest of the slot after a read
+
+namespace mbed {
+
+OneWire::OneWire(PinName pin) :
+        _pin(pin, PIN_OUTPUT, OpenDrain, 1),
+        _bit(0),
+        _state(STATE_IDLE) {
+}
+
+int OneWire::transfer(const Buffer &tx, const Buffer &rx, const event_callback_t &callback, bool reset)
+{
+    {
+        CriticalSection lock;
+        if (_state != STATE_IDLE) {
+            return -1;
+        }
+        _state = STATE_SLOT;
+    }
+    _tx = tx;
+    _rx = rx;
+    _callback = callback;
+    _bit = 0;
+    if (_rx.buf != NULL) {
+        // read bits are only ever set
+        memset(_rx.buf, 0, _rx.length);
+    }
+    if (reset) {
+        _state = STATE_RESET;
+        _pin.write(0);
+        _timeout.attach_us(this, &OneWire::step, ONEWIRE_RESET_LOW_US);
+    } else {
+        start_slot();
+    }
+    return 0;
+}
+
+void OneWire::abort()
+{
+    CriticalSection lock;
+    _timeout.detach();
+    _pin.write(1);
+    _state = STATE_IDLE;
+}
+
+void OneWire::step()
+{
+    switch (_state) {
+        case STATE_RESET:
+            _pin.write(1);
+            _state = STATE_PRESENCE;
+            _timeout.attach_us(this, &OneWire::step, ONEWIRE_PRESENCE_US);
+            break;
+        case STATE_PRESENCE:
+            // a device answers by holding the line low
+            if (_pin.read()) {
+                finish(ONEWIRE_EVENT_NO_PRESENCE);
+                break;
+            }
+            _state = STATE_SLOT;
+            _timeout.attach_us(this, &OneWire::step, ONEWIRE_RESET_TAIL_US);
+            break;
+        case STATE_WRITE_ZERO:
+            _pin.write(1);
+            _state = STATE_SLOT;
+            _timeout.attach_us(this, &OneWire::step, ONEWIRE_WRITE_ZERO_REST_US);
+            break;
+        case STATE_SLOT:
+            start_slot();
+            break;
+        default:
+            break;
+    }
+}
+
+void OneWire::start_slot()
+{
+    uint32_t tx_bits = _tx.length * 8;
+    if (_bit >= tx_bits + _rx.length * 8) {
+        finish(ONEWIRE_EVENT_COMPLETE);
+        return;
+    }
+    bool writing = _bit < tx_bits;
+    if (writing) {
+        int bit = (((const char *)_tx.buf)[_bit / 8] >> (_bit % 8)) & 1;
+        _bit++;
+        if (!bit) {
+            // long enough to leave to the ticker
+            _pin.write(0);
+            _state = STATE_WRITE_ZERO;
+            _timeout.attach_us(this, &OneWire::step, ONEWIRE_WRITE_ZERO_LOW_US);
+            return;
+        }
+        {
+            CriticalSection lock;
+            _pin.write(0);
+            wait_us(ONEWIRE_LOW_US);
+            _pin.write(1);
+        }
+        _timeout.attach_us(this, &OneWire::step, ONEWIRE_WRITE_ONE_REST_US);
+        return;
+    }
+    uint32_t n = _bit - tx_bits;
+    int level;
+    {
+        // the device's answer is only valid for 15us from the falling edge
+        CriticalSection lock;
+        _pin.write(0);
+        wait_us(ONEWIRE_LOW_US);
+        _pin.write(1);
+        wait_us(ONEWIRE_SAMPLE_US);
+        level = _pin.read();
+    }
+    if (level) {
+        ((char *)_rx.buf)[n / 8] |= (char)(1 << (n % 8));
+    }
+    _bit++;
+    _timeout.attach_us(this, &OneWire::step, ONEWIRE_READ_REST_US);
+}
+
+void OneWire::finish(int event)
+{
+    _state = STATE_IDLE;
+    if (_callback) {
+        CompletionQueue::post(_completion, _callback.bind(_rx, event));
+    }
+}
+
+} // namespace mbed
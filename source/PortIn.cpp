@@ -0,0 +1,50 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/PortIn.h"
+
+#if DEVICE_PORTIN && DEVICE_PORTIN_IRQ
+
+#include "mbed-drivers/mbed_critical.h"
+
+namespace mbed {
+
+void PortIn::change(const change_callback_t &callback, int mask) {
+    CriticalSection lock;
+    if (_change) {
+        port_irq_set(&_port_irq, _irq_mask, 0);
+    }
+    _change = callback;
+    _irq_mask = mask;
+    if (_change) {
+        _last = read();
+        port_irq_set(&_port_irq, mask, 1);
+    }
+}
+
+void PortIn::_irq_handler(uint32_t id) {
+    PortIn *handler = (PortIn*)id;
+    int value = handler->read();
+    int old_value = handler->_last;
+    handler->_last = value;
+    // the other pins can change too, but only the interrupting ones count
+    if (((value ^ old_value) & handler->_irq_mask) && handler->_change) {
+        handler->_change.call(old_value, value);
+    }
+}
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,62 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/PwmOut.h"
+#include "minar/minar.h"
+#include "core-util/CriticalSectionLock.h"
+
+#if DEVICE_PWMOUT && DEVICE_PWMOUT_ASYNCH
+
+namespace mbed {
+
+int PwmOut::write_sequence(const Buffer &buffer, const event_callback_t &callback, int event, bool circular)
+{
+    mbed::util::CriticalSectionLock lock;
+    if (pwmout_active(&_pwm)) {
+        return -1;
+    }
+    _buffer = buffer;
+    _callback = callback;
+    _irq.callback(&PwmOut::irq_handler_asynch);
+    pwmout_write_asynch(&_pwm, (const uint16_t *)buffer.buf, buffer.length / sizeof(uint16_t), circular,
+            _irq.entry(), event, _usage);
+    return 0;
+}
+
+void PwmOut::abort_sequence()
+{
+    pwmout_abort_asynch(&_pwm);
+}
+
+int PwmOut::set_dma_usage(DMAUsage usage)
+{
+    if (pwmout_active(&_pwm)) {
+        return -1;
+    }
+    _usage = usage;
+    return 0;
+}
+
+void PwmOut::irq_handler_asynch(void)
+{
+    int event = pwmout_irq_handler_asynch(&_pwm);
+    if (_callback && (event & PWMOUT_EVENT_ALL)) {
+        minar::Scheduler::postCallback(_callback.bind(_buffer, event & PWMOUT_EVENT_ALL));
+    }
+}
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,91 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/PwmOutGroup.h"
+#include "mbed-drivers/mbed_assert.h"
+
+#if DEVICE_PWMOUT_GROUP
+
+namespace mbed {
+
+PwmOutGroup::PwmOutGroup(PwmOut *const *channels, size_t count) : _group(), _count(count), _staging(false) {
+    MBED_ASSERT(count > 0 && count <= PWMOUT_GROUP_MAX_CHANNELS);
+    for (size_t i = 0; i < count; i++) {
+        _channels[i] = &channels[i]->_pwm;
+    }
+    int shared = pwmout_group_init(&_group, _channels, count);
+    MBED_ASSERT(shared == 0);
+    (void)shared;
+}
+
+void PwmOutGroup::stage() {
+    if (!_staging) {
+        // hold the shadow registers until commit()
+        pwmout_group_begin(&_group);
+        _staging = true;
+    }
+}
+
+void PwmOutGroup::pulsewidth_us(size_t index, int us) {
+    MBED_ASSERT(index < _count);
+    stage();
+    pwmout_pulsewidth_us(_channels[index], us);
+}
+
+void PwmOutGroup::write_u16(size_t index, unsigned short value) {
+    MBED_ASSERT(index < _count);
+    stage();
+    pwmout_write_u16(_channels[index], value);
+}
+
+#if DEVICE_PWMOUT_PHASE
+int PwmOutGroup::alignment(Alignment alignment) {
+    stage();
+    return pwmout_group_alignment(&_group, (pwmout_align_t)alignment);
+}
+
+int PwmOutGroup::phase_us(size_t index, int us) {
+    MBED_ASSERT(index < _count);
+    stage();
+    return pwmout_group_phase_us(&_group, index, us);
+}
+
+int PwmOutGroup::phase_u16(size_t index, unsigned short value) {
+    MBED_ASSERT(index < _count);
+    stage();
+    return pwmout_group_phase_u16(&_group, index, value);
+}
+
+int PwmOutGroup::interleave() {
+    int result = 0;
+    for (size_t i = 0; i < _count; i++) {
+        if (phase_u16(i, (unsigned short)((i * 0x10000u) / _count)) != 0) {
+            result = -1;
+        }
+    }
+    return result;
+}
+#endif
+
+void PwmOutGroup::commit() {
+    if (_staging) {
+        pwmout_group_commit(&_group);
+        _staging = false;
+    }
+}
+
+} // namespace mbed
+
+#endif
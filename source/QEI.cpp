@@ -0,0 +1,185 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/QEI.h"
+
+#if DEVICE_QEI || DEVICE_INTERRUPTIN
+
+#include "mbed-drivers/mbed_assert.h"
+#include "mbed-drivers/mbed_critical.h"
+
+#if DEVICE_INTERRUPTIN
+/* The count change for each transition, indexed by the old state in bits 3
+ * and 2 and the new state in bits 1 and 0. Both channels changing at once
+ * is marked with 2. */
+static const int8_t qei_transition[16] = {
+     0,  1, -1,  2,
+    -1,  0,  2,  1,
+     1,  2,  0, -1,
+     2, -1,  1,  0
+};
+#endif
+
+namespace mbed {
+
+QEI::QEI(PinName a, PinName b, PinName index) :
+        _errors(0),
+        _hardware(false),
+        _velocity_count(0),
+        _velocity_time(0),
+        _velocity_valid(false) {
+#if DEVICE_QEI
+    if (qei_init(&_qei, a, b, index) == 0) {
+        _hardware = true;
+        return;
+    }
+#endif
+#if DEVICE_INTERRUPTIN
+    _count = 0;
+    _index_position = 0;
+    _index_count = 0;
+    _has_index = index != NC;
+    gpio_irq_init(&_a_irq, a, (&QEI::_irq_handler), (uint32_t)this);
+    gpio_irq_init(&_b_irq, b, (&QEI::_irq_handler), (uint32_t)this);
+    gpio_init_in(&_a, a);
+    gpio_init_in(&_b, b);
+    _state = (gpio_read(&_a) << 1) | gpio_read(&_b);
+    gpio_irq_set(&_a_irq, IRQ_RISE, 1);
+    gpio_irq_set(&_a_irq, IRQ_FALL, 1);
+    gpio_irq_set(&_b_irq, IRQ_RISE, 1);
+    gpio_irq_set(&_b_irq, IRQ_FALL, 1);
+    if (_has_index) {
+        gpio_irq_init(&_index_irq, index, (&QEI::_index_handler), (uint32_t)this);
+        gpio_init_in(&_index, index);
+        gpio_irq_set(&_index_irq, IRQ_RISE, 1);
+    }
+#else
+    MBED_ASSERT(_hardware);
+#endif
+}
+
+QEI::~QEI() {
+#if DEVICE_QEI
+    if (_hardware) {
+        qei_free(&_qei);
+        return;
+    }
+#endif
+#if DEVICE_INTERRUPTIN
+    gpio_irq_free(&_a_irq);
+    gpio_irq_free(&_b_irq);
+    if (_has_index) {
+        gpio_irq_free(&_index_irq);
+    }
+#endif
+}
+
+int32_t QEI::count() {
+#if DEVICE_QEI
+    if (_hardware) {
+        return qei_read(&_qei);
+    }
+#endif
+#if DEVICE_INTERRUPTIN
+    return _count;
+#else
+    return 0;
+#endif
+}
+
+void QEI::reset(int32_t value) {
+#if DEVICE_QEI
+    if (_hardware) {
+        qei_write(&_qei, value);
+    }
+#endif
+#if DEVICE_INTERRUPTIN
+    if (!_hardware) {
+        CriticalSection lock;
+        _count = value;
+    }
+#endif
+    _velocity_valid = false;
+}
+
+int32_t QEI::velocity() {
+    timestamp_t now = us_ticker_read();
+    int32_t value = count();
+    int32_t result = 0;
+    timestamp_t elapsed = now - _velocity_time;
+    if (_velocity_valid && elapsed > 0) {
+        result = (int32_t)(((int64_t)(value - _velocity_count) * 1000000) / elapsed);
+    }
+    _velocity_count = value;
+    _velocity_time = now;
+    _velocity_valid = true;
+    return result;
+}
+
+uint32_t QEI::index_count() {
+#if DEVICE_QEI
+    if (_hardware) {
+        int32_t position;
+        return qei_index_read(&_qei, &position);
+    }
+#endif
+#if DEVICE_INTERRUPTIN
+    return _index_count;
+#else
+    return 0;
+#endif
+}
+
+int32_t QEI::index_position() {
+#if DEVICE_QEI
+    if (_hardware) {
+        int32_t position = 0;
+        qei_index_read(&_qei, &position);
+        return position;
+    }
+#endif
+#if DEVICE_INTERRUPTIN
+    return _index_position;
+#else
+    return 0;
+#endif
+}
+
+#if DEVICE_INTERRUPTIN
+void QEI::_irq_handler(uint32_t id, gpio_irq_event event) {
+    (void)event;
+    QEI *handler = (QEI*)id;
+    // both channels are read, whichever edge interrupted
+    uint8_t state = (gpio_read(&handler->_a) << 1) | gpio_read(&handler->_b);
+    int8_t step = qei_transition[(handler->_state << 2) | state];
+    handler->_state = state;
+    if (step == 2) {
+        handler->_errors++;
+    } else {
+        handler->_count += step;
+    }
+}
+
+void QEI::_index_handler(uint32_t id, gpio_irq_event event) {
+    (void)event;
+    QEI *handler = (QEI*)id;
+    handler->_index_position = handler->_count;
+    handler->_index_count++;
+}
+#endif
+
+} // namespace mbed
+
+#endif
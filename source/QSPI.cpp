@@ -0,0 +1,227 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/QSPI.h"
+
+#if DEVICE_QSPI
+
+#include "mbed-drivers/mbed_assert.h"
+#include "mbed-drivers/mbed_critical.h"
+#if DEVICE_QSPI_ASYNCH
+#include "mbed-drivers/dma_cache.h"
+#endif
+
+namespace mbed {
+
+QSPI::QSPI(PinName io0, PinName io1, PinName io2, PinName io3, PinName sclk, PinName ssel) :
+#if DEVICE_QSPI_ASYNCH
+        _irq(this),
+#endif
+        _qspi(),
+        _mapped(NULL) {
+    qspi_init(&_qspi, io0, io1, io2, io3, sclk, ssel);
+    qspi_format(&_qspi, 0);
+    qspi_frequency(&_qspi, 1000000);
+#if DEVICE_QSPI_ASYNCH
+    _irq.callback(&QSPI::irq_handler_asynch);
+#endif
+}
+
+void QSPI::format(int mode) {
+    qspi_format(&_qspi, mode);
+}
+
+void QSPI::frequency(int hz) {
+    qspi_frequency(&_qspi, hz);
+}
+
+bool QSPI::busy() {
+#if DEVICE_QSPI_ASYNCH
+    return _mapped != NULL || qspi_active(&_qspi);
+#else
+    return _mapped != NULL;
+#endif
+}
+
+int QSPI::write(const qspi_command_t &command, const char *data, int length) {
+    if (busy()) {
+        return -1;
+    }
+    return qspi_write(&_qspi, &command, data, length);
+}
+
+int QSPI::read(const qspi_command_t &command, char *data, int length) {
+    if (busy()) {
+        return -1;
+    }
+    return qspi_read(&_qspi, &command, data, length);
+}
+
+const void *QSPI::map(const qspi_command_t &read_command) {
+    CriticalSection lock;
+    if (busy()) {
+        return NULL;
+    }
+    _mapped = qspi_memory_map(&_qspi, &read_command);
+    return _mapped;
+}
+
+void QSPI::unmap() {
+    CriticalSection lock;
+    if (_mapped != NULL) {
+        qspi_memory_unmap(&_qspi);
+        _mapped = NULL;
+    }
+}
+
+#if DEVICE_QSPI_ASYNCH
+
+int QSPI::transfer(const QSPITransferAdder &td)
+{
+    const transaction_data_t &data = td._td;
+    CriticalSection lock;
+    if (busy()) {
+        return -1;
+    }
+    _deep_sleep.lock();
+    _current_transaction = data;
+    dma_cache_clean(data.tx_buffer.buf, data.tx_buffer.length);
+    dma_cache_clean_invalidate(data.rx_buffer.buf, data.rx_buffer.length);
+    qspi_transfer_asynch(&_qspi, &_current_transaction.command, data.tx_buffer.buf, data.tx_buffer.length,
+            data.rx_buffer.buf, data.rx_buffer.length, _irq.entry(), data.event, _dma.begin());
+    return 0;
+}
+
+void QSPI::abort_transfer()
+{
+    qspi_abort_asynch(&_qspi);
+    _deep_sleep.unlock();
+    _dma.end();
+}
+
+int QSPI::set_dma_usage(DMAUsage usage)
+{
+    if (qspi_active(&_qspi)) {
+        return -1;
+    }
+    return _dma.set_usage(usage);
+}
+
+void QSPI::irq_handler_asynch(void)
+{
+    int event = qspi_irq_handler_asynch(&_qspi);
+    if (!event) {
+        return;
+    }
+    dma_cache_invalidate(_current_transaction.rx_buffer.buf, _current_transaction.rx_buffer.length);
+    if (!qspi_active(&_qspi)) {
+        _deep_sleep.unlock();
+        _dma.end();
+    }
+    if (_current_transaction.callback && (event & QSPI_EVENT_ALL)) {
+        CompletionQueue::post(_completion,
+                _current_transaction.callback.bind(_current_transaction.tx_buffer, _current_transaction.rx_buffer,
+                        event & QSPI_EVENT_ALL));
+    }
+}
+
+QSPI::QSPITransferAdder::QSPITransferAdder(QSPI *owner) :
+        _applied(false), _rc(0), _owner(owner)
+{
+    _td.command.instruction = 0;
+    _td.command.instruction_width = QSPI_WIDTH_NONE;
+    _td.command.address = 0;
+    _td.command.address_size = 0;
+    _td.command.address_width = QSPI_WIDTH_NONE;
+    _td.command.dummy_cycles = 0;
+    _td.command.data_width = QSPI_WIDTH_NONE;
+    _td.event = 0;
+    _td.callback = event_callback_t((void (*)(Buffer, Buffer, int))NULL);
+}
+const QSPI::QSPITransferAdder & QSPI::QSPITransferAdder::operator =(const QSPI::QSPITransferAdder &a)
+{
+    _td = a._td;
+    _owner = a._owner;
+    _applied = 0;
+    return *this;
+}
+QSPI::QSPITransferAdder::QSPITransferAdder(const QSPITransferAdder &a)
+{
+    *this = a;
+}
+QSPI::QSPITransferAdder & QSPI::QSPITransferAdder::instruction(uint8_t value, qspi_width_t width)
+{
+    _td.command.instruction = value;
+    _td.command.instruction_width = width;
+    return *this;
+}
+QSPI::QSPITransferAdder & QSPI::QSPITransferAdder::address(uint32_t value, uint8_t size, qspi_width_t width)
+{
+    MBED_ASSERT(size >= 1 && size <= 4);
+    _td.command.address = value;
+    _td.command.address_size = size;
+    _td.command.address_width = width;
+    return *this;
+}
+QSPI::QSPITransferAdder & QSPI::QSPITransferAdder::dummy(uint8_t cycles)
+{
+    _td.command.dummy_cycles = cycles;
+    return *this;
+}
+QSPI::QSPITransferAdder & QSPI::QSPITransferAdder::tx(const void *txBuf, size_t txSize, qspi_width_t width)
+{
+    MBED_ASSERT(_td.rx_buffer.length == 0);
+    _td.tx_buffer = Buffer(const_cast<void *>(txBuf), txSize);
+    _td.command.data_width = width;
+    return *this;
+}
+QSPI::QSPITransferAdder & QSPI::QSPITransferAdder::rx(void *rxBuf, size_t rxSize, qspi_width_t width)
+{
+    MBED_ASSERT(_td.tx_buffer.length == 0);
+    _td.rx_buffer = Buffer(rxBuf, rxSize);
+    _td.command.data_width = width;
+    return *this;
+}
+QSPI::QSPITransferAdder & QSPI::QSPITransferAdder::callback(const event_callback_t &cb, int event)
+{
+    MBED_ASSERT(!_td.callback);
+    _td.callback = cb;
+    _td.event = event;
+    return *this;
+}
+int QSPI::QSPITransferAdder::apply()
+{
+    if (!_applied) {
+        _applied = true;
+        _rc = _owner->transfer(*this);
+    }
+    return _rc;
+}
+QSPI::QSPITransferAdder::~QSPITransferAdder()
+{
+    apply();
+}
+
+QSPI::QSPITransferAdder QSPI::transfer()
+{
+    QSPITransferAdder a(this);
+    return a;
+}
+
+#endif
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,144 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/RAMLogFileSystem.h"
+#include "core-util/CriticalSectionLock.h"
+#include <cstring>
+
+namespace mbed {
+
+class RAMLogFileHandle : public FileHandle {
+public:
+    RAMLogFileHandle(RAMLogFileSystem *fs) : _fs(fs) {
+    }
+
+    virtual ssize_t write(const void *buffer, size_t length) {
+        _fs->append(buffer, length);
+        return length;
+    }
+
+    virtual ssize_t read(void *buffer, size_t length) {
+        return _fs->drain(buffer, length);
+    }
+
+    virtual int close() {
+        delete this;
+        return 0;
+    }
+
+    virtual int isatty() {
+        return 0;
+    }
+
+    virtual off_t lseek(off_t offset, int whence) {
+        (void)offset;
+        (void)whence;
+        return -1;
+    }
+
+    virtual int fsync() {
+        return 0;
+    }
+
+    virtual off_t flen() {
+        return _fs->size();
+    }
+
+private:
+    RAMLogFileSystem *_fs;
+};
+
+RAMLogFileSystem::RAMLogFileSystem(const char *name, void *buffer, size_t size) :
+        FileSystemLike(name),
+        _buffer((char *)buffer),
+        _size(size),
+        _tail(0),
+        _used(0),
+        _overwritten(0) {
+}
+
+FileHandle *RAMLogFileSystem::open(const char *filename, int flags) {
+    (void)filename;
+    (void)flags;
+    return new RAMLogFileHandle(this);
+}
+
+int RAMLogFileSystem::remove(const char *filename) {
+    (void)filename;
+    mbed::util::CriticalSectionLock lock;
+    _tail = 0;
+    _used = 0;
+    return 0;
+}
+
+void RAMLogFileSystem::append(const void *data, size_t length) {
+    const char *ptr = (const char *)data;
+    if (length > _size) {
+        // only the newest bytes fit
+        _overwritten += length - _size;
+        ptr += length - _size;
+        length = _size;
+    }
+    mbed::util::CriticalSectionLock lock;
+    if (_used + length > _size) {
+        size_t drop = _used + length - _size;
+        _overwritten += drop;
+        _tail = (_tail + drop) % _size;
+        _used -= drop;
+    }
+    size_t head = (_tail + _used) % _size;
+    size_t first = _size - head;
+    if (first > length) {
+        first = length;
+    }
+    std::memcpy(_buffer + head, ptr, first);
+    std::memcpy(_buffer, ptr + first, length - first);
+    _used += length;
+}
+
+size_t RAMLogFileSystem::drain(void *data, size_t length) {
+    char *ptr = (char *)data;
+    mbed::util::CriticalSectionLock lock;
+    if (length > _used) {
+        length = _used;
+    }
+    size_t first = _size - _tail;
+    if (first > length) {
+        first = length;
+    }
+    std::memcpy(ptr, _buffer + _tail, first);
+    std::memcpy(ptr + first, _buffer, length - first);
+    _tail = (_tail + length) % _size;
+    _used -= length;
+    return length;
+}
+
+const void *RAMLogFileSystem::peek(size_t *length) {
+    mbed::util::CriticalSectionLock lock;
+    size_t first = _size - _tail;
+    *length = first < _used ? first : _used;
+    return _used ? _buffer + _tail : NULL;
+}
+
+void RAMLogFileSystem::release(size_t length) {
+    mbed::util::CriticalSectionLock lock;
+    if (length > _used) {
+        length = _used;
+    }
+    _tail = (_tail + length) % _size;
+    _used -= length;
+}
+
+} // namespace mbed
@@ -15,11 +15,16 @@
  */
 #include "mbed-drivers/RawSerial.h"
 #include "mbed-drivers/wait_api.h"
+#include "mbed-drivers/mbed_printf.h"
 #include <cstdarg>
+#include <cstdio>
+#include <stddef.h>
+#include <stdint.h>
 
 #if DEVICE_SERIAL
 
 #define STRING_STACK_LIMIT    120
+#define STRING_SPEC_LIMIT     32
 
 namespace mbed {
 
@@ -40,28 +45,256 @@ int RawSerial::puts(const char *str) {
     return 0;
 }
 
-// Experimental support for printf in RawSerial. No Stream inheritance
-// means we can't call printf() directly, so we use sprintf() instead.
-// We only call malloc() for the sprintf() buffer if the buffer
-// length is above a certain threshold, otherwise we use just the stack.
 int RawSerial::printf(const char *format, ...) {
     std::va_list arg;
     va_start(arg, format);
-    int len = vsnprintf(NULL, 0, format, arg);
-    if (len < STRING_STACK_LIMIT) {
-        char temp[STRING_STACK_LIMIT];
-        vsprintf(temp, format, arg);
-        puts(temp);
-    } else {
-        char *temp = new char[len + 1];
-        vsprintf(temp, format, arg);
-        puts(temp);
-        delete[] temp;
-    }
+    int len = vprintf(format, arg);
     va_end(arg);
     return len;
 }
 
+#if MBED_MINIMAL_STDIO
+namespace {
+
+void raw_serial_out(void *context, const char *data, size_t length) {
+    RawSerial *serial = static_cast<RawSerial *>(context);
+    for (size_t i = 0; i < length; i++) {
+        serial->putc(data[i]);
+    }
+}
+
+} // namespace
+
+int RawSerial::vprintf(const char *format, std::va_list arg) {
+    return mbed_vxprintf(raw_serial_out, this, format, arg);
+}
+
+#else
+namespace {
+
+enum length_modifier {
+    LengthNone,
+    LengthChar,
+    LengthShort,
+    LengthLong,
+    LengthLongLong,
+    LengthIntMax,
+    LengthSize,
+    LengthPtrDiff,
+    LengthLongDouble
+};
+
+// Append to a conversion specification, dropping what does not fit
+void spec_add(char *spec, int &n, char c) {
+    if (n < STRING_SPEC_LIMIT - 1) {
+        spec[n++] = c;
+    }
+}
+
+void spec_add_int(char *spec, int &n, int value) {
+    char digits[12];
+    std::snprintf(digits, sizeof(digits), "%d", value);
+    for (char *d = digits; *d; d++) {
+        spec_add(spec, n, *d);
+    }
+}
+
+} // namespace
+
+// Each conversion is formatted on its own, by snprintf into a small stack
+// buffer (strings are copied directly), and sent before the format string is
+// parsed any further. The arguments are only walked once, so no va_copy is
+// needed, and nothing is allocated however long the output is.
+int RawSerial::vprintf(const char *format, std::va_list arg) {
+    int count = 0;
+    while (*format) {
+        if (*format != '%') {
+            putc(*format++);
+            count++;
+            continue;
+        }
+        const char *start = format++;
+        char spec[STRING_SPEC_LIMIT];
+        int n = 0;
+        spec_add(spec, n, '%');
+
+        bool left = false;
+        while (*format == '-' || *format == '+' || *format == ' ' || *format == '#' || *format == '0') {
+            if (*format == '-') {
+                left = true;
+            }
+            spec_add(spec, n, *format++);
+        }
+
+        int width = 0;
+        if (*format == '*') {
+            format++;
+            width = va_arg(arg, int);
+            if (width < 0) {
+                left = true;
+                width = -width;
+                spec_add(spec, n, '-');
+            }
+            spec_add_int(spec, n, width);
+        } else {
+            while (*format >= '0' && *format <= '9') {
+                width = width * 10 + (*format - '0');
+                spec_add(spec, n, *format++);
+            }
+        }
+
+        int precision = -1;
+        if (*format == '.') {
+            format++;
+            precision = 0;
+            if (*format == '*') {
+                format++;
+                precision = va_arg(arg, int);
+            } else {
+                while (*format >= '0' && *format <= '9') {
+                    precision = precision * 10 + (*format - '0');
+                    format++;
+                }
+            }
+            if (precision >= 0) {
+                spec_add(spec, n, '.');
+                spec_add_int(spec, n, precision);
+            }
+        }
+
+        length_modifier length = LengthNone;
+        const char *length_start = format;
+        switch (*format) {
+            case 'h':
+                format++;
+                length = LengthShort;
+                if (*format == 'h') {
+                    format++;
+                    length = LengthChar;
+                }
+                break;
+            case 'l':
+                format++;
+                length = LengthLong;
+                if (*format == 'l') {
+                    format++;
+                    length = LengthLongLong;
+                }
+                break;
+            case 'j': format++; length = LengthIntMax; break;
+            case 'z': format++; length = LengthSize; break;
+            case 't': format++; length = LengthPtrDiff; break;
+            case 'L': format++; length = LengthLongDouble; break;
+            default: break;
+        }
+        while (length_start < format) {
+            spec_add(spec, n, *length_start++);
+        }
+
+        char conversion = *format;
+        if (conversion == '\0') {
+            break;
+        }
+        format++;
+        spec_add(spec, n, conversion);
+        spec[n] = '\0';
+
+        char buf[STRING_STACK_LIMIT];
+        int len = -1;
+        switch (conversion) {
+            case 'd':
+            case 'i':
+                switch (length) {
+                    case LengthLong: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, long)); break;
+                    case LengthLongLong: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, long long)); break;
+                    case LengthIntMax: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, intmax_t)); break;
+                    case LengthSize: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, size_t)); break;
+                    case LengthPtrDiff: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, ptrdiff_t)); break;
+                    default: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, int)); break;
+                }
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                switch (length) {
+                    case LengthLong: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, unsigned long)); break;
+                    case LengthLongLong: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, unsigned long long)); break;
+                    case LengthIntMax: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, uintmax_t)); break;
+                    case LengthSize: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, size_t)); break;
+                    case LengthPtrDiff: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, ptrdiff_t)); break;
+                    default: len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, unsigned int)); break;
+                }
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (length == LengthLongDouble) {
+                    len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, long double));
+                } else {
+                    len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, double));
+                }
+                break;
+            case 'c':
+                len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, int));
+                break;
+            case 'p':
+                len = std::snprintf(buf, sizeof(buf), spec, va_arg(arg, void *));
+                break;
+            case 's': {
+                // strings can be any length, so they are copied directly
+                const char *str = va_arg(arg, const char *);
+                if (str == NULL) {
+                    str = "(null)";
+                }
+                int str_len = 0;
+                while (str[str_len] && (precision < 0 || str_len < precision)) {
+                    str_len++;
+                }
+                for (int i = str_len; !left && i < width; i++, count++) {
+                    putc(' ');
+                }
+                for (int i = 0; i < str_len; i++, count++) {
+                    putc(str[i]);
+                }
+                for (int i = str_len; left && i < width; i++, count++) {
+                    putc(' ');
+                }
+                break;
+            }
+            case 'n':
+                *va_arg(arg, int *) = count;
+                break;
+            case '%':
+                putc('%');
+                count++;
+                break;
+            default:
+                // not a conversion we know, write it out as it is
+                for (const char *c = start; c < format; c++, count++) {
+                    putc(*c);
+                }
+                break;
+        }
+        if (len > 0) {
+            if (len > (int)sizeof(buf) - 1) {
+                len = sizeof(buf) - 1;
+            }
+            for (int i = 0; i < len; i++) {
+                putc(buf[i]);
+            }
+            count += len;
+        }
+    }
+    return count;
+}
+#endif
+
 } // namespace mbed
 
 #endif
@@ -0,0 +1,54 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/RtcAlarm.h"
+
+#if DEVICE_RTC
+
+#if DEVICE_LOWPOWERTIMER
+#include "lp_ticker_api.h"
+#define RTC_ALARM_TICKER get_lp_ticker_data()
+#else
+#include "us_ticker_api.h"
+#define RTC_ALARM_TICKER get_us_ticker_data()
+#endif
+
+namespace mbed {
+
+RtcAlarm::RtcAlarm() : TimerEvent(RTC_ALARM_TICKER) {
+}
+
+RtcAlarm::~RtcAlarm() {
+    detach();
+}
+
+void RtcAlarm::detach() {
+    remove();
+    _function.attach(0);
+}
+
+void RtcAlarm::schedule(time_t when) {
+    time_t now = time(NULL);
+    us_timestamp_t remaining = when > now ? (us_timestamp_t)(when - now) * 1000000 : 0;
+    insert_us(ticker_read_us(_ticker_data) + remaining);
+}
+
+void RtcAlarm::handler() {
+    _function.call();
+}
+
+} // namespace mbed
+
+#endif
@@ -14,48 +14,191 @@
  * limitations under the License.
  */
 #include "mbed-drivers/SPI.h"
-#include "minar/minar.h"
+#include "mbed-drivers/SPIDevice.h"
+#include "mbed-drivers/CompletionQueue.h"
+#include "mbed-drivers/dma_cache.h"
+#include "mbed-drivers/mbed_timeline.h"
 #include "mbed-drivers/mbed_assert.h"
+#include "mbed-drivers/mbed_critical.h"
+#if INTERRUPT_PRIORITY_CLASSES
+#include "mbed-drivers/InterruptManager.h"
+#endif
 
 #if DEVICE_SPI
 
 namespace mbed {
 
-#if DEVICE_SPI_ASYNCH && TRANSACTION_QUEUE_SIZE_SPI
-CircularBuffer<SPI::transaction_t, TRANSACTION_QUEUE_SIZE_SPI> SPI::_transaction_buffer;
+/* With a HAL that passes a context to its asynch handler, the interrupt
+ * comes straight to a static handler, and no thunk is needed */
+#if DEVICE_SPI_ASYNCH_CONTEXT
+#define SPI_IRQ_ENTRY 0
+#else
+#define SPI_IRQ_ENTRY _irq.entry()
+#endif
+
+#if DEVICE_SPI_ASYNCH && TRANSACTION_POOL_SIZE_SPI
+SPI::transaction_node_t SPI::_transaction_pool[TRANSACTION_POOL_SIZE_SPI];
 #endif
 
 SPI::SPI(PinName mosi, PinName miso, PinName sclk) :
         _spi(),
 #if DEVICE_SPI_ASYNCH
+#if TRANSACTION_POOL_SIZE_SPI
+        _queue_head(NULL),
+        _queue_tail(NULL),
+#else
+        _queue_storage(NULL),
+        _queue_size(0),
+        _queue_first(0),
+        _queue_count(0),
+#endif
+#if !DEVICE_SPI_ASYNCH_CONTEXT
         _irq(this),
-        _usage(DMA_USAGE_NEVER),
+#endif
+        _tx_segment(0),
+        _rx_segment(0),
+        _tx_offset(0),
+        _rx_offset(0),
+        _streaming(false),
+        _resume_pending(false),
+        _stream_half(0),
+        _completion_events(0),
+        _completion_signal(mbed::util::FunctionPointer0<void>(this, &SPI::deliver_completion).bind()),
+        _resume_signal(mbed::util::FunctionPointer0<void>(this, &SPI::resume_queue).bind()),
+#endif
+#if DEVICE_SPI_INSTANCE
+        _peripheral(NULL),
 #endif
         _bits(8),
         _mode(0),
         _order(SPI_MSB),
         _hz(1000000) {
+#if DEVICE_SPI_ASYNCH && !TRANSACTION_POOL_SIZE_SPI && TRANSACTION_QUEUE_SIZE_SPI
+    set_transaction_queue(_queue_default, TRANSACTION_QUEUE_SIZE_SPI);
+#endif
     spi_init(&_spi, mosi, miso, sclk);
     spi_format(&_spi, _bits, _mode, _order);
     spi_frequency(&_spi, _hz);
+
+    // Used to avoid unnecessary configuration updates
+#if DEVICE_SPI_INSTANCE
+    uint32_t instance = spi_instance(&_spi);
+    peripheral_t *unused = NULL;
+    for (int i = 0; i < SPI_PERIPHERAL_COUNT; i++) {
+        if (_peripherals[i].bits == 0) {
+            if (unused == NULL) {
+                unused = &_peripherals[i];
+            }
+        } else if (_peripherals[i].instance == instance) {
+            _peripheral = &_peripherals[i];
+            break;
+        }
+    }
+    if (_peripheral == NULL) {
+        // with no room left, the configuration is set on every aquire()
+        _peripheral = unused;
+    }
+    if (_peripheral != NULL) {
+        _peripheral->instance = instance;
+        _peripheral->bits = _bits;
+        _peripheral->mode = _mode;
+        _peripheral->order = _order;
+        _peripheral->hz = _hz;
+    }
+#else
+    _owner = this;
+#endif
+#if INTERRUPT_PRIORITY_CLASSES
+    InterruptManager::set_priority(spi_irq_number(&_spi), IRQ_PRIORITY_SPI);
+#endif
 }
 
 void SPI::format(int bits, int mode, spi_bitorder_t order) {
     _bits = bits;
     _mode = mode;
     _order = order;
+#if !DEVICE_SPI_INSTANCE
     SPI::_owner = NULL; // Not that elegant, but works. rmeyer
+#endif
     aquire();
 }
 
 void SPI::frequency(int hz) {
     _hz = hz;
+#if !DEVICE_SPI_INSTANCE
     SPI::_owner = NULL; // Not that elegant, but works. rmeyer
+#endif
     aquire();
 }
 
+SPI::~SPI() {
+#if DEVICE_SPI_ASYNCH
+    // nothing may call back into this object once it's gone: the queued
+    // transfers are dropped and the one in progress is aborted, and the
+    // slots drop whatever they still have pending as they're destroyed
+    CriticalSection lock;
+    clear_transfer_buffer();
+    if (spi_active(&_spi)) {
+        abort_current();
+    }
+#endif
+#if !DEVICE_SPI_INSTANCE
+    if (_owner == this) {
+        _owner = NULL;
+    }
+#endif
+}
+
+#if DEVICE_SPI_INSTANCE
+SPI::peripheral_t SPI::_peripherals[SPI_PERIPHERAL_COUNT];
+#else
 SPI* SPI::_owner = NULL;
+#endif
+
+#if DEVICE_SUSPEND
+int SPI::suspend() {
+#if DEVICE_SPI_ASYNCH
+    if (spi_active(&_spi)) {
+        return -1;
+    }
+#endif
+    spi_suspend(&_spi);
+    return 0;
+}
+
+void SPI::resume() {
+    spi_resume(&_spi);
+}
+#endif
 
+#if DEVICE_SPI_INSTANCE
+// each physical spi remembers its configuration, so only what differs is set
+void SPI::aquire() {
+    if (_peripheral == NULL) {
+        spi_format(&_spi, _bits, _mode, _order);
+        spi_frequency(&_spi, _hz);
+        return;
+    }
+    if (_peripheral->bits != _bits || _peripheral->mode != _mode || _peripheral->order != _order) {
+        spi_format(&_spi, _bits, _mode, _order);
+        _peripheral->bits = _bits;
+        _peripheral->mode = _mode;
+        _peripheral->order = _order;
+    }
+    if (_peripheral->hz != _hz) {
+        spi_frequency(&_spi, _hz);
+        _peripheral->hz = _hz;
+    }
+}
+
+void SPI::configure(int bits, int mode, spi_bitorder_t order, int hz) {
+    _bits = bits;
+    _mode = mode;
+    _order = order;
+    _hz = hz;
+    aquire();
+}
+#else
 // ignore the fact there are multiple physical spis, and always update if it wasnt us last
 void SPI::aquire() {
      if (_owner != this) {
@@ -65,117 +208,607 @@ void SPI::aquire() {
     }
 }
 
+void SPI::configure(int bits, int mode, spi_bitorder_t order, int hz) {
+    if (_owner != this) {
+        // someone else programmed the peripheral since we last did
+        _bits = bits;
+        _mode = mode;
+        _order = order;
+        _hz = hz;
+        spi_format(&_spi, _bits, _mode, _order);
+        spi_frequency(&_spi, _hz);
+        _owner = this;
+        return;
+    }
+    if (bits != _bits || mode != _mode || order != _order) {
+        _bits = bits;
+        _mode = mode;
+        _order = order;
+        spi_format(&_spi, _bits, _mode, _order);
+    }
+    if (hz != _hz) {
+        _hz = hz;
+        spi_frequency(&_spi, _hz);
+    }
+}
+#endif
+
 int SPI::write(int value) {
     aquire();
     return spi_master_write(&_spi, value);
 }
 
+int SPI::write(const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length) {
+    aquire();
+    return spi_master_block_write(&_spi, tx_buffer, tx_length, rx_buffer, rx_length);
+}
+
 #if DEVICE_SPI_ASYNCH
 
 int SPI::transfer(const SPI::SPITransferAdder &td)
 {
-    if (spi_active(&_spi)) {
+    if (td._td.width) {
+        // an element holds whole frames, and every segment whole elements
+        if (td._td.width < (_bits > 8 ? 16 : 8)) {
+            return -1;
+        }
+        size_t mask = td._td.width / 8 - 1;
+        for (int i = 0; i < td._td.tx_count; i++) {
+            if (td._td.tx_buffer[i].length & mask) {
+                return -1;
+            }
+        }
+        for (int i = 0; i < td._td.rx_count; i++) {
+            if (td._td.rx_buffer[i].length & mask) {
+                return -1;
+            }
+        }
+    }
+
+    // don't let the transfer in progress complete between the check and
+    // queueing, or nothing would start the queued transfer. While a restart
+    // is pending, the queued transfers go first.
+    CriticalSection lock;
+    if (spi_active(&_spi) || (_resume_pending && transfers_queued())) {
         return queue_transfer(td._td);
     }
     start_transfer(td._td);
     return 0;
 }
 
-void SPI::abort_transfer()
+void SPI::report_cancelled(const transaction_data_t &td)
 {
+    if (td.callback) {
+        event_callback_t callback = td.callback;
+        CompletionQueue::post(callback.bind(td.tx_buffer[0], td.rx_buffer[0], SPI_EVENT_CANCELLED), _completion.priority());
+    } else {
+        signal_completion(SPI_EVENT_CANCELLED);
+    }
+}
+
+void SPI::abort_current()
+{
+    bool active = spi_active(&_spi);
     spi_abort_asynch(&_spi);
-#if TRANSACTION_QUEUE_SIZE_SPI
-    dequeue_transaction();
+    _streaming = false;
+    _deep_sleep.unlock();
+    _dma.end();
+    if (active) {
+        if (_current_transaction.device != NULL) {
+            _current_transaction.device->deselect();
+        }
+#if DRIVER_STATS
+        _stats.finished(SPI_EVENT_CANCELLED);
 #endif
+        report_cancelled(_current_transaction);
+    }
+    // the queue restarts from the scheduler rather than from within the
+    // abort; with nothing queued, the next transfer() starts straight away
+    if (!_resume_pending && transfers_queued()) {
+        _resume_pending = true;
+        CompletionQueue::post(_resume_signal);
+    }
+}
+
+void SPI::abort_transfer()
+{
+    CriticalSection lock;
+    abort_current();
+}
+
+bool SPI::abort_transfer(SPIDevice *device)
+{
+    CriticalSection lock;
+    if (!spi_active(&_spi) || _current_transaction.device != device) {
+        return false;
+    }
+    abort_current();
+    return true;
+}
+
+int SPI::cancel_transfers(SPIDevice *device)
+{
+    int cancelled = 0;
+#if TRANSACTION_POOL_SIZE_SPI
+    CriticalSection lock;
+    transaction_node_t *previous = NULL;
+    transaction_node_t *node = _queue_head;
+    while (node != NULL) {
+        transaction_node_t *next = node->next;
+        if (node->transaction.get_transaction()->device == device) {
+            report_cancelled(*node->transaction.get_transaction());
+            if (previous == NULL) {
+                _queue_head = next;
+            } else {
+                previous->next = next;
+            }
+            if (_queue_tail == node) {
+                _queue_tail = previous;
+            }
+            node->transaction = transaction_t();
+            cancelled++;
+        } else {
+            previous = node;
+        }
+        node = next;
+    }
+#else
+    // close the gaps, keeping the order of the transfers that stay
+    CriticalSection lock;
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < _queue_count; i++) {
+        transaction_data_t &td = queue_slot(i);
+        if (td.device == device) {
+            report_cancelled(td);
+            cancelled++;
+        } else {
+            if (kept != i) {
+                queue_slot(kept) = td;
+            }
+            kept++;
+        }
+    }
+    _queue_count = kept;
+#endif
+    return cancelled;
+}
+
+int SPI::flush(SPIDevice *device)
+{
+    CriticalSection lock;
+    int cancelled = cancel_transfers(device);
+    if (abort_transfer(device)) {
+        cancelled++;
+    }
+    return cancelled;
 }
 
 
 void SPI::clear_transfer_buffer()
 {
-#if TRANSACTION_QUEUE_SIZE_SPI
-    _transaction_buffer.reset();
+#if TRANSACTION_POOL_SIZE_SPI
+    CriticalSection lock;
+    while (_queue_head != NULL) {
+        transaction_node_t *node = _queue_head;
+        _queue_head = node->next;
+        node->transaction = transaction_t();
+    }
+    _queue_tail = NULL;
+#else
+    CriticalSection lock;
+    _queue_first = 0;
+    _queue_count = 0;
 #endif
 }
 
+#if !TRANSACTION_POOL_SIZE_SPI
+int SPI::set_transaction_queue(queue_slot_t *storage, uint16_t size)
+{
+    CriticalSection lock;
+    if (_queue_count != 0) {
+        return -1;
+    }
+    _queue_storage = storage;
+    _queue_size = storage ? size : 0;
+    _queue_first = 0;
+    return 0;
+}
+#endif
+
 void SPI::abort_all_transfers()
 {
     clear_transfer_buffer();
     abort_transfer();
 }
 
+int SPI::start_stream(const Buffer &tx0, const Buffer &rx0, const Buffer &tx1, const Buffer &rx1,
+        const event_callback_t &callback, int event)
+{
+    CriticalSection lock;
+    if (spi_active(&_spi)) {
+        return -1;
+    }
+    _stream_tx[0] = tx0;
+    _stream_rx[0] = rx0;
+    _stream_tx[1] = tx1;
+    _stream_rx[1] = rx1;
+    _stream_half = 0;
+    _streaming = true;
+
+    transaction_data_t td;
+    td.tx_buffer[0] = tx0;
+    td.rx_buffer[0] = rx0;
+    td.tx_count = td.rx_count = 1;
+    td.event = event;
+    td.callback = callback;
+    td.device = NULL;
+    td.priority = 0;
+    td.fill = 0xFF;
+    td.width = 0;
+    start_transfer(td);
+    return 0;
+}
+
+void SPI::stop_stream()
+{
+    _streaming = false;
+}
+
 int SPI::set_dma_usage(DMAUsage usage)
 {
     if (spi_active(&_spi)) {
         return -1;
     }
-    _usage = usage;
-    return  0;
+    return _dma.set_usage(usage);
 }
 
 int SPI::queue_transfer(const transaction_data_t &td)
 {
-#if TRANSACTION_QUEUE_SIZE_SPI
-    transaction_t transaction(this, td);
-    if (_transaction_buffer.full()) {
-        return -1; // the buffer is full
-    } else {
-        _transaction_buffer.push(transaction);
-        return 0;
+#if TRANSACTION_POOL_SIZE_SPI
+    CriticalSection lock;
+    for (int i = 0; i < TRANSACTION_POOL_SIZE_SPI; i++) {
+        transaction_node_t *node = &_transaction_pool[i];
+        if (node->transaction.get_object() == NULL) {
+            node->transaction = transaction_t(this, td);
+            // behind every transfer of the same or higher priority
+            transaction_node_t *previous = NULL;
+            if (_queue_tail != NULL && _queue_tail->transaction.get_transaction()->priority >= td.priority) {
+                previous = _queue_tail;
+            } else {
+                for (transaction_node_t *p = _queue_head; p != NULL; p = p->next) {
+                    if (p->transaction.get_transaction()->priority < td.priority) {
+                        break;
+                    }
+                    previous = p;
+                }
+            }
+            node->next = previous ? previous->next : _queue_head;
+            if (previous == NULL) {
+                _queue_head = node;
+            } else {
+                previous->next = node;
+            }
+            if (node->next == NULL) {
+                _queue_tail = node;
+            }
+#if DRIVER_STATS
+            uint32_t depth = 0;
+            for (transaction_node_t *p = _queue_head; p != NULL; p = p->next) {
+                depth++;
+            }
+            _stats.queued(depth);
+#endif
+            return 0;
+        }
     }
+    return -1; // the pool is exhausted
 #else
-    return -1;
+    // the IRQ handler may pop between the check and the push
+    CriticalSection lock;
+    if (_queue_count == _queue_size) {
+        return -1; // the queue is full, or there is none
+    }
+    // behind every transfer of the same or higher priority
+    uint16_t i = _queue_count;
+    while (i > 0 && queue_slot(i - 1).priority < td.priority) {
+        queue_slot(i) = queue_slot(i - 1);
+        i--;
+    }
+    queue_slot(i) = td;
+    _queue_count++;
+#if DRIVER_STATS
+    _stats.queued(_queue_count);
+#endif
+    return 0;
 #endif
 }
 
 void SPI::start_transfer(const transaction_data_t &td)
 {
-    aquire();
+    _deep_sleep.lock();
+    if (td.device != NULL) {
+        td.device->select();
+    } else {
+        aquire();
+    }
+    MBED_TIMELINE_EVENT(MBED_TIMELINE_SPI_START, this);
+#if DRIVER_STATS
+    uint32_t bytes = 0;
+    for (int i = 0; i < td.tx_count; i++) {
+        bytes += td.tx_buffer[i].length;
+    }
+    for (int i = 0; i < td.rx_count; i++) {
+        bytes += td.rx_buffer[i].length;
+    }
+    _stats.started(bytes);
+#endif
     _current_transaction = td;
+    _tx_segment = _rx_segment = 0;
+    _tx_offset = _rx_offset = 0;
+#if DEVICE_SPI_ASYNCH_WIDTH
+    spi_set_transfer_width(&_spi, td.width ? td.width : (_bits > 8 ? 16 : 8));
+#endif
+#if DEVICE_SPI_ASYNCH_FILL
+    spi_set_fill(&_spi, td.fill);
+#else
+    // fill frames are sent from a chunk of them, in the frame width
+    for (int i = 0; i < SPI_FILL_CHUNK; i++) {
+        _fill[i] = (_bits > 8 && (i & 1)) ? td.fill >> 8 : td.fill;
+    }
+#endif
+#if DEVICE_SPI_ASYNCH_CONTEXT
+    spi_asynch_handler(&_spi, &SPI::irq_handler_context, (uint32_t)this);
+#else
     _irq.callback(&SPI::irq_handler_asynch);
-    spi_master_transfer(&_spi, td.tx_buffer.buf, td.tx_buffer.length, td.rx_buffer.buf, td.rx_buffer.length,
-            _irq.entry(), td.event, _usage);
+#endif
+    if (!start_segment()) {
+        spi_master_transfer(&_spi, NULL, 0, NULL, 0, SPI_IRQ_ENTRY, td.event & ~SPI_EVENT_FLAG_IRQ_CONTEXT, _dma.begin());
+    }
 }
 
-#if TRANSACTION_QUEUE_SIZE_SPI
+bool SPI::start_segment()
+{
+    const transaction_data_t &td = _current_transaction;
+    // skip over the segments that are done with
+    while (_tx_segment < td.tx_count && _tx_offset >= td.tx_buffer[_tx_segment].length) {
+        _tx_segment++;
+        _tx_offset = 0;
+    }
+    while (_rx_segment < td.rx_count && _rx_offset >= td.rx_buffer[_rx_segment].length) {
+        _rx_segment++;
+        _rx_offset = 0;
+    }
+    int tx_left = (_tx_segment < td.tx_count) ? td.tx_buffer[_tx_segment].length - _tx_offset : 0;
+    int rx_left = (_rx_segment < td.rx_count) ? td.rx_buffer[_rx_segment].length - _rx_offset : 0;
+    if (!tx_left && !rx_left) {
+        return false;
+    }
+    // run to the end of whichever segment ends first
+    int length = tx_left;
+    if (!tx_left || (rx_left && rx_left < tx_left)) {
+        length = rx_left;
+    }
+    // segments with no buffer are fill or discard
+    bool fill = tx_left && td.tx_buffer[_tx_segment].buf == NULL;
+    bool discard = rx_left && td.rx_buffer[_rx_segment].buf == NULL;
+    void *tx = (tx_left && !fill) ? (char *)td.tx_buffer[_tx_segment].buf + _tx_offset : NULL;
+    void *rx = (rx_left && !discard) ? (char *)td.rx_buffer[_rx_segment].buf + _rx_offset : NULL;
+    int tx_length = tx_left ? length : 0;
+    int rx_length = rx_left ? length : 0;
+#if !DEVICE_SPI_ASYNCH_FILL
+    // the HAL takes a NULL buffer as no buffer at all, so fill frames come
+    // from the chunk, and a discard is a transfer with nothing received
+    if (fill || (discard && !tx_left)) {
+        if (length > SPI_FILL_CHUNK) {
+            length = SPI_FILL_CHUNK;
+        }
+        tx = _fill;
+        tx_length = length;
+        rx_length = rx_left ? length : 0;
+    }
+    _tx_offset += tx_left ? tx_length : 0;
+    _rx_offset += rx_length;
+    if (discard) {
+        rx_length = 0;
+    }
+#else
+    _tx_offset += tx_length;
+    _rx_offset += rx_length;
+#endif
+    dma_cache_clean(tx, tx_length);
+    dma_cache_clean_invalidate(rx, rx_length);
+    spi_master_transfer(&_spi, tx, tx_length, rx, rx_length, SPI_IRQ_ENTRY, td.event & ~SPI_EVENT_FLAG_IRQ_CONTEXT, _dma.begin());
+    return true;
+}
 
 void SPI::start_transaction(transaction_data_t *data)
 {
     start_transfer(*data);
 }
 
+void SPI::resume_queue()
+{
+    CriticalSection lock;
+    _resume_pending = false;
+    if (!spi_active(&_spi)) {
+        dequeue_transaction();
+    }
+}
+
 void SPI::dequeue_transaction()
 {
-    transaction_t t;
-    if (_transaction_buffer.pop(t)) {
-        SPI* obj = t.get_object();
-        transaction_data_t* data = t.get_transaction();
-        obj->start_transaction(data);
+    // start the transfer from where it is queued, rather than from a copy,
+    // and only then give up its slot
+    CriticalSection lock;
+#if TRANSACTION_POOL_SIZE_SPI
+    transaction_node_t *node = _queue_head;
+    if (node == NULL) {
+        return;
     }
+    _queue_head = node->next;
+    if (_queue_head == NULL) {
+        _queue_tail = NULL;
+    }
+    // only ever start this peripheral's own transfers
+    start_transaction(node->transaction.get_transaction());
+    node->transaction = transaction_t();
+#else
+    if (_queue_count == 0) {
+        return;
+    }
+    start_transaction(&queue_slot(0));
+    _queue_first = (_queue_first + 1) % _queue_size;
+    _queue_count--;
+#endif
+}
+
+void SPI::report_event(const Buffer &tx_buffer, const Buffer &rx_buffer, int event)
+{
+    if (!(event & SPI_EVENT_ALL)) {
+        return;
+    }
+    if (!_current_transaction.callback) {
+        signal_completion(event & SPI_EVENT_ALL);
+        return;
+    }
+    if (_current_transaction.event & SPI_EVENT_FLAG_IRQ_CONTEXT) {
+        _current_transaction.callback.call(tx_buffer, rx_buffer, event & SPI_EVENT_ALL);
+    } else {
+        CompletionQueue::post(_completion, _current_transaction.callback.bind(tx_buffer, rx_buffer, event & SPI_EVENT_ALL));
+    }
+}
+
+void SPI::set_completion_handler(const completion_handler_t &handler)
+{
+    CriticalSection lock;
+    _completion_handler = handler;
 }
 
+void SPI::signal_completion(int event)
+{
+    if (!_completion_handler) {
+        return;
+    }
+    {
+        CriticalSection lock;
+        _completion_events |= event;
+    }
+    // already pending if an earlier completion has not been handled yet
+    CompletionQueue::post(_completion_signal);
+}
+
+void SPI::deliver_completion()
+{
+    int event;
+    completion_handler_t handler;
+    {
+        CriticalSection lock;
+        event = _completion_events;
+        _completion_events = 0;
+        handler = _completion_handler;
+    }
+    if (event && handler) {
+        handler.call(event);
+    }
+}
+
+#if DEVICE_SPI_ASYNCH_CONTEXT
+void SPI::irq_handler_context(uint32_t id)
+{
+    ((SPI *)id)->irq_handler_asynch();
+}
 #endif
 
 void SPI::irq_handler_asynch(void)
 {
     int event = spi_irq_handler_asynch(&_spi);
-    if (_current_transaction.callback && (event & SPI_EVENT_ALL)) {
-        minar::Scheduler::postCallback(
-                _current_transaction.callback.bind(_current_transaction.tx_buffer, _current_transaction.rx_buffer,
-                        event & SPI_EVENT_ALL));
+    if (_rx_segment < _current_transaction.rx_count) {
+        // the segment just received into ends at the current offset
+        dma_cache_invalidate(_current_transaction.rx_buffer[_rx_segment].buf, _rx_offset);
+    }
+    bool completed = (event & SPI_EVENT_INTERNAL_TRANSFER_COMPLETE) && !(event & (SPI_EVENT_ERROR | SPI_EVENT_RX_OVERFLOW));
+    if (completed && _streaming) {
+        // start the other half first, then report this one
+        Buffer tx_buffer = _current_transaction.tx_buffer[0];
+        Buffer rx_buffer = _current_transaction.rx_buffer[0];
+        _stream_half ^= 1;
+        _current_transaction.tx_buffer[0] = _stream_tx[_stream_half];
+        _current_transaction.rx_buffer[0] = _stream_rx[_stream_half];
+        _tx_segment = _rx_segment = 0;
+        _tx_offset = _rx_offset = 0;
+        start_segment();
+        MBED_TIMELINE_EVENT(MBED_TIMELINE_SPI_DONE, this);
+#if DRIVER_STATS
+        _stats.finished(event);
+        _stats.started(_stream_tx[_stream_half].length + _stream_rx[_stream_half].length);
+#endif
+        report_event(tx_buffer, rx_buffer, event);
+        return;
+    }
+    _streaming = false;
+    if (completed) {
+        // a segment boundary rather than the end of the transfer
+        if (start_segment()) {
+            return;
+        }
+    }
+    MBED_TIMELINE_EVENT(MBED_TIMELINE_SPI_DONE, this);
+#if DRIVER_STATS
+    _stats.finished(event);
+#endif
+    if (_current_transaction.device != NULL && (event & (SPI_EVENT_ALL | SPI_EVENT_INTERNAL_TRANSFER_COMPLETE))) {
+        _current_transaction.device->deselect();
+    }
+    if (_current_transaction.event & SPI_EVENT_FLAG_IRQ_CONTEXT) {
+        // Starting the next queued transfer replaces _current_transaction,
+        // so keep what the callback needs. The callback runs after that, so
+        // a transfer it starts goes behind the ones already queued.
+        event_callback_t callback = _current_transaction.callback;
+        Buffer tx_buffer = _current_transaction.tx_buffer[0];
+        Buffer rx_buffer = _current_transaction.rx_buffer[0];
+        if (event & (SPI_EVENT_ALL | SPI_EVENT_INTERNAL_TRANSFER_COMPLETE)) {
+            dequeue_transaction();
+        }
+        if (!spi_active(&_spi)) {
+            _deep_sleep.unlock();
+            _dma.end();
+        }
+        if (callback && (event & SPI_EVENT_ALL)) {
+            callback.call(tx_buffer, rx_buffer, event & SPI_EVENT_ALL);
+        } else if (event & SPI_EVENT_ALL) {
+            signal_completion(event & SPI_EVENT_ALL);
+        }
+        return;
+    }
+    if (event & SPI_EVENT_ALL) {
+        if (_current_transaction.callback) {
+            CompletionQueue::post(_completion,
+                    _current_transaction.callback.bind(_current_transaction.tx_buffer[0], _current_transaction.rx_buffer[0],
+                            event & SPI_EVENT_ALL));
+        } else {
+            signal_completion(event & SPI_EVENT_ALL);
+        }
     }
-#if TRANSACTION_QUEUE_SIZE_SPI
     if (event & (SPI_EVENT_ALL | SPI_EVENT_INTERNAL_TRANSFER_COMPLETE)) {
         // SPI peripheral is free (event happend), dequeue transaction
         dequeue_transaction();
     }
-#endif
+    if (!spi_active(&_spi)) {
+        _deep_sleep.unlock();
+        _dma.end();
+    }
 }
 
-SPI::SPITransferAdder::SPITransferAdder(SPI *owner) :
+SPI::SPITransferAdder::SPITransferAdder(SPI *owner, SPIDevice *device) :
         _applied(false), _rc(0), _owner(owner)
 {
-    _td.tx_buffer.length = 0;
-    _td.rx_buffer.length = 0;
+    _td.device = device;
+    _td.tx_count = 0;
+    _td.rx_count = 0;
+    _td.priority = 0;
+    _td.fill = 0xFF;
+    _td.width = 0;
+    _td.event = SPI_EVENT_COMPLETE;
     _td.callback = event_callback_t((void (*)(Buffer, Buffer, int))NULL);
 }
 const SPI::SPITransferAdder & SPI::SPITransferAdder::operator =(const SPI::SPITransferAdder &a)
@@ -191,16 +824,33 @@ SPI::SPITransferAdder::SPITransferAdder(const SPITransferAdder &a)
 }
 SPI::SPITransferAdder & SPI::SPITransferAdder::tx(void *txBuf, size_t txSize)
 {
-    MBED_ASSERT(!_td.tx_buffer.length);
-    _td.tx_buffer.buf = txBuf;
-    _td.tx_buffer.length = txSize;
+    MBED_ASSERT(_td.tx_count < SPI_TRANSFER_SEGMENTS);
+    _td.tx_buffer[_td.tx_count++] = Buffer(txBuf, txSize);
     return *this;
 }
 SPI::SPITransferAdder & SPI::SPITransferAdder::rx(void *rxBuf, size_t rxSize)
 {
-    MBED_ASSERT(!_td.rx_buffer.length);
-    _td.rx_buffer.buf = rxBuf;
-    _td.rx_buffer.length = rxSize;
+    MBED_ASSERT(_td.rx_count < SPI_TRANSFER_SEGMENTS);
+    _td.rx_buffer[_td.rx_count++] = Buffer(rxBuf, rxSize);
+    return *this;
+}
+SPI::SPITransferAdder & SPI::SPITransferAdder::tx_fill(size_t txSize, uint32_t value)
+{
+    MBED_ASSERT(_td.tx_count < SPI_TRANSFER_SEGMENTS);
+    _td.tx_buffer[_td.tx_count++] = Buffer(NULL, txSize);
+    _td.fill = value;
+    return *this;
+}
+SPI::SPITransferAdder & SPI::SPITransferAdder::rx_discard(size_t rxSize)
+{
+    MBED_ASSERT(_td.rx_count < SPI_TRANSFER_SEGMENTS);
+    _td.rx_buffer[_td.rx_count++] = Buffer(NULL, rxSize);
+    return *this;
+}
+SPI::SPITransferAdder & SPI::SPITransferAdder::width(uint8_t bits)
+{
+    MBED_ASSERT(bits == 8 || bits == 16 || bits == 32);
+    _td.width = bits;
     return *this;
 }
 SPI::SPITransferAdder & SPI::SPITransferAdder::callback(const event_callback_t &cb, int event)
@@ -210,6 +860,11 @@ SPI::SPITransferAdder & SPI::SPITransferAdder::callback(const event_callback_t &
     _td.event = event;
     return *this;
 }
+SPI::SPITransferAdder & SPI::SPITransferAdder::priority(uint8_t level)
+{
+    _td.priority = level;
+    return *this;
+}
 int SPI::SPITransferAdder::apply()
 {
     if (!_applied) {
@@ -228,6 +883,12 @@ SPI::SPITransferAdder SPI::transfer()
     SPITransferAdder a(this);
     return a;
 }
+
+SPI::SPITransferAdder SPI::transfer(SPIDevice *device)
+{
+    SPITransferAdder a(this, device);
+    return a;
+}
 #endif
 
 } // namespace mbed
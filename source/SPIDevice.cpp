@@ -0,0 +1,72 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/SPIDevice.h"
+
+#if DEVICE_SPI
+
+namespace mbed {
+
+SPIDevice::SPIDevice(SPI &bus, PinName cs, int bits, int mode, int hz, spi_bitorder_t order) :
+        _bus(bus),
+        _cs(cs, 1),
+        _bits(bits),
+        _mode(mode),
+        _order(order),
+        _hz(hz) {
+}
+
+void SPIDevice::format(int bits, int mode, spi_bitorder_t order) {
+    _bits = bits;
+    _mode = mode;
+    _order = order;
+}
+
+void SPIDevice::frequency(int hz) {
+    _hz = hz;
+}
+
+void SPIDevice::select() {
+    _bus.configure(_bits, _mode, _order, _hz);
+    _cs = 0;
+}
+
+void SPIDevice::deselect() {
+    _cs = 1;
+}
+
+int SPIDevice::write(int value) {
+    select();
+    int response = _bus.write(value);
+    deselect();
+    return response;
+}
+
+int SPIDevice::write(const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length) {
+    select();
+    int frames = _bus.write(tx_buffer, tx_length, rx_buffer, rx_length);
+    deselect();
+    return frames;
+}
+
+#if DEVICE_SPI_ASYNCH
+SPI::SPITransferAdder SPIDevice::transfer() {
+    return _bus.transfer(this);
+}
+#endif
+
+} // namespace mbed
+
+#endif
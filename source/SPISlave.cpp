@@ -0,0 +1,163 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/SPISlave.h"
+
+#if DEVICE_SPISLAVE
+
+#if DEVICE_SPISLAVE_ASYNCH
+#include "mbed-drivers/dma_cache.h"
+#include "mbed-drivers/mbed_critical.h"
+#endif
+
+namespace mbed {
+
+SPISlave::SPISlave(PinName mosi, PinName miso, PinName sclk, PinName ssel) :
+#if DEVICE_SPISLAVE_ASYNCH
+        _event(0),
+        _half(0),
+        _streaming(false),
+        _irq(this),
+#endif
+        _spi(),
+        _bits(8),
+        _mode(0),
+        _order(SPI_MSB),
+        _hz(1000000) {
+    spi_slave_init(&_spi, mosi, miso, sclk, ssel);
+    spi_format(&_spi, _bits, _mode, _order);
+    spi_frequency(&_spi, _hz);
+#if DEVICE_SPISLAVE_ASYNCH
+    _irq.callback(&SPISlave::irq_handler_asynch);
+#endif
+}
+
+void SPISlave::format(int bits, int mode, spi_bitorder_t order) {
+    _bits = bits;
+    _mode = mode;
+    _order = order;
+    spi_format(&_spi, _bits, _mode, _order);
+}
+
+void SPISlave::frequency(int hz) {
+    _hz = hz;
+    spi_frequency(&_spi, _hz);
+}
+
+int SPISlave::receive(void) {
+    return spi_slave_receive(&_spi);
+}
+
+int SPISlave::read(void) {
+    return spi_slave_read(&_spi);
+}
+
+void SPISlave::reply(int value) {
+    spi_slave_write(&_spi, value);
+}
+
+#if DEVICE_SPISLAVE_ASYNCH
+
+int SPISlave::transfer(const Buffer &tx, const Buffer &rx, const event_callback_t &callback, int event)
+{
+    CriticalSection lock;
+    if (spi_active(&_spi)) {
+        return -1;
+    }
+    _tx[0] = tx;
+    _rx[0] = rx;
+    _callback = callback;
+    _event = event;
+    _streaming = false;
+    _deep_sleep.lock();
+    start_half(0);
+    return 0;
+}
+
+int SPISlave::start_stream(const Buffer &tx0, const Buffer &rx0, const Buffer &tx1, const Buffer &rx1,
+        const event_callback_t &callback, int event)
+{
+    CriticalSection lock;
+    if (spi_active(&_spi)) {
+        return -1;
+    }
+    _tx[0] = tx0;
+    _rx[0] = rx0;
+    _tx[1] = tx1;
+    _rx[1] = rx1;
+    _callback = callback;
+    _event = event;
+    _streaming = true;
+    _deep_sleep.lock();
+    start_half(0);
+    return 0;
+}
+
+void SPISlave::stop_stream()
+{
+    _streaming = false;
+}
+
+void SPISlave::abort_transfer()
+{
+    CriticalSection lock;
+    _streaming = false;
+    spi_abort_asynch(&_spi);
+    _deep_sleep.unlock();
+    _dma.end();
+}
+
+int SPISlave::set_dma_usage(DMAUsage usage)
+{
+    if (spi_active(&_spi)) {
+        return -1;
+    }
+    return _dma.set_usage(usage);
+}
+
+void SPISlave::start_half(int half)
+{
+    _half = half;
+    dma_cache_clean(_tx[half].buf, _tx[half].length);
+    dma_cache_clean_invalidate(_rx[half].buf, _rx[half].length);
+    spi_slave_transfer(&_spi, _tx[half].buf, _tx[half].length, _rx[half].buf, _rx[half].length,
+            _irq.entry(), _event, _dma.begin());
+}
+
+void SPISlave::irq_handler_asynch(void)
+{
+    int event = spi_irq_handler_asynch(&_spi);
+    bool completed = (event & SPI_EVENT_INTERNAL_TRANSFER_COMPLETE) && !(event & (SPI_EVENT_ERROR | SPI_EVENT_RX_OVERFLOW));
+    int done = _half;
+    dma_cache_invalidate(_rx[done].buf, _rx[done].length);
+    if (completed && _streaming) {
+        // arm the other half before anything else, the master may be
+        // clocking it already
+        start_half(done ^ 1);
+    } else if (!spi_active(&_spi)) {
+        _streaming = false;
+        _deep_sleep.unlock();
+        _dma.end();
+    }
+    if (_callback && (event & SPI_EVENT_ALL)) {
+        CompletionQueue::post(_completion[done], _callback.bind(_tx[done], _rx[done], event & SPI_EVENT_ALL));
+    }
+}
+
+#endif
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,187 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/SampleFilter.h"
+#include "cmsis.h"
+#include <string.h>
+
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#define SAMPLE_FILTER_SIMD 1
+
+/* Two samples, read from any halfword address */
+typedef struct __attribute__((packed, __may_alias__)) {
+    uint32_t v;
+} sample_pair_t;
+
+static inline uint32_t read_pair(const int16_t *p) {
+    return ((const sample_pair_t *)p)->v;
+}
+#else
+#define SAMPLE_FILTER_SIMD 0
+#endif
+
+static inline int16_t saturate_q15(int32_t value) {
+#if SAMPLE_FILTER_SIMD
+    return (int16_t)__SSAT(value, 16);
+#else
+    if (value > 32767) {
+        return 32767;
+    }
+    if (value < -32768) {
+        return -32768;
+    }
+    return (int16_t)value;
+#endif
+}
+
+namespace mbed {
+
+FIRFilter::FIRFilter(const int16_t *coefficients, uint16_t taps, int16_t *state, uint16_t decimation) :
+        _coefficients(coefficients),
+        _state(state),
+        _taps(taps),
+        _decimation(decimation ? decimation : 1) {
+    reset();
+}
+
+void FIRFilter::reset() {
+    memset(_state, 0, 2 * _taps * sizeof(int16_t));
+    _pos = 0;
+    _phase = 0;
+}
+
+size_t FIRFilter::process(int16_t *samples, size_t count) {
+    size_t out = 0;
+    for (size_t n = 0; n < count; n++) {
+        _state[_pos] = _state[_pos + _taps] = samples[n];
+        _pos = _pos + 1 == _taps ? 0 : _pos + 1;
+        if (++_phase < _decimation) {
+            continue;
+        }
+        _phase = 0;
+        // the last _taps samples, oldest first
+        const int16_t *x = &_state[_pos];
+        int32_t acc = 0;
+        uint16_t i = 0;
+#if SAMPLE_FILTER_SIMD
+        for (; i + 2 <= _taps; i += 2) {
+            acc = (int32_t)__SMLAD(read_pair(&x[i]), read_pair(&_coefficients[i]), (uint32_t)acc);
+        }
+#endif
+        for (; i < _taps; i++) {
+            acc += (int32_t)x[i] * _coefficients[i];
+        }
+        // written behind the read position, so in place is safe
+        samples[out++] = saturate_q15(acc >> 15);
+    }
+    return out;
+}
+
+BiquadFilter::BiquadFilter(const int16_t *coefficients, uint8_t sections, int16_t *state) :
+        _coefficients(coefficients),
+        _state(state),
+        _sections(sections) {
+    reset();
+}
+
+void BiquadFilter::reset() {
+    memset(_state, 0, 4 * _sections * sizeof(int16_t));
+}
+
+size_t BiquadFilter::process(int16_t *samples, size_t count) {
+    for (uint8_t s = 0; s < _sections; s++) {
+        const int16_t *c = &_coefficients[5 * s];
+        int16_t *st = &_state[4 * s];
+        int16_t x1 = st[0], x2 = st[1], y1 = st[2], y2 = st[3];
+#if SAMPLE_FILTER_SIMD
+        uint32_t b0b1 = __PKHBT(c[0], c[1], 16);
+        uint32_t b2a1 = __PKHBT(c[2], c[3], 16);
+#endif
+        for (size_t n = 0; n < count; n++) {
+            int16_t x0 = samples[n];
+#if SAMPLE_FILTER_SIMD
+            int32_t acc = (int32_t)__SMLAD(__PKHBT(x0, x1, 16), b0b1, 0);
+            acc = (int32_t)__SMLAD(__PKHBT(x2, y1, 16), b2a1, (uint32_t)acc);
+            acc += (int32_t)c[4] * y2;
+#else
+            int32_t acc = (int32_t)c[0] * x0 + (int32_t)c[1] * x1 + (int32_t)c[2] * x2 +
+                          (int32_t)c[3] * y1 + (int32_t)c[4] * y2;
+#endif
+            int16_t y0 = saturate_q15(acc >> 14);
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            samples[n] = y0;
+        }
+        st[0] = x1;
+        st[1] = x2;
+        st[2] = y1;
+        st[3] = y2;
+    }
+    return count;
+}
+
+size_t RMSMeter::process(int16_t *samples, size_t count) {
+    _rms = compute(samples, count);
+    return count;
+}
+
+uint16_t RMSMeter::compute(const int16_t *samples, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t sum = 0;
+    size_t n = 0;
+#if SAMPLE_FILTER_SIMD
+    for (; n + 2 <= count; n += 2) {
+        uint32_t pair = read_pair(&samples[n]);
+        sum = __SMLALD(pair, pair, sum);
+    }
+#endif
+    for (; n < count; n++) {
+        sum += (int32_t)samples[n] * samples[n];
+    }
+    // the mean square is Q30, so its integer square root is Q15
+    uint32_t mean = (uint32_t)(sum / count);
+    uint32_t root = 0;
+    for (uint32_t bit = 1UL << 30; bit; bit >>= 2) {
+        if (mean >= root + bit) {
+            mean -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+    }
+    return (uint16_t)root;
+}
+
+void SampleChain::on_buffer(Buffer buffer, int event) {
+    int16_t *samples = (int16_t *)buffer.buf;
+    size_t count = buffer.length / sizeof(int16_t);
+    // unsigned, centred on 0x8000, to signed Q15
+    for (size_t n = 0; n < count; n++) {
+        samples[n] = (int16_t)((uint16_t)samples[n] ^ 0x8000);
+    }
+    for (size_t s = 0; s < _count; s++) {
+        count = _stages[s]->process(samples, count);
+    }
+    buffer.length = count * sizeof(int16_t);
+    if (_callback) {
+        _callback.call(buffer, event);
+    }
+}
+
+} // namespace mbed
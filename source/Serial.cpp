@@ -15,6 +15,7 @@
  */
 #include "mbed-drivers/Serial.h"
 #include "mbed-drivers/wait_api.h"
+#include "core-util/CriticalSectionLock.h"
 
 #if DEVICE_SERIAL
 
@@ -31,6 +32,25 @@ int Serial::_putc(int c) {
     return _base_putc(c);
 }
 
+#if DEVICE_SERIAL_ASYNCH
+ssize_t Serial::_write(const void* buffer, size_t length) {
+    if (_tx_dma.usage() == DMA_USAGE_NEVER || length < 2) {
+        return Stream::_write(buffer, length);
+    }
+    // let the writes started or queued with SerialBase::write() go first
+    while (true) {
+        mbed::util::CriticalSectionLock lock;
+        if (!serial_tx_active(&_serial)) {
+            start_write(Buffer((void*)buffer, length), 0, event_callback_t(), SERIAL_EVENT_TX_COMPLETE);
+            break;
+        }
+    }
+    while (serial_tx_active(&_serial)) {
+    }
+    return length;
+}
+#endif
+
 } // namespace mbed
 
 #endif
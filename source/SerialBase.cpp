@@ -15,20 +15,47 @@
  */
 #include "mbed-drivers/SerialBase.h"
 #include "mbed-drivers/wait_api.h"
-#include "minar/minar.h"
+#include "mbed-drivers/CompletionQueue.h"
+#include "mbed-drivers/dma_cache.h"
+#include "mbed-drivers/mbed_timeline.h"
+#include "mbed-drivers/mbed_critical.h"
+#if INTERRUPT_PRIORITY_CLASSES
+#include "mbed-drivers/InterruptManager.h"
+#endif
 
 #if DEVICE_SERIAL
 
+/* With a HAL that passes a context to its asynch handler, the interrupt
+ * comes straight to a static handler, and no thunk is needed */
+#if DEVICE_SERIAL_ASYNCH_CONTEXT
+#define SERIAL_TX_IRQ_ENTRY 0
+#define SERIAL_RX_IRQ_ENTRY 0
+#else
+#define SERIAL_TX_IRQ_ENTRY _tx_thunk_irq.entry()
+#define SERIAL_RX_IRQ_ENTRY _rx_thunk_irq.entry()
+#endif
+
 namespace mbed {
 
 SerialBase::SerialBase(PinName tx, PinName rx) :
 #if DEVICE_SERIAL_ASYNCH
-                                                 _thunk_irq(this), _tx_usage(DMA_USAGE_NEVER),
-                                                 _rx_usage(DMA_USAGE_NEVER),
+#if !DEVICE_SERIAL_ASYNCH_CONTEXT
+                                                 _tx_thunk_irq(this, &SerialBase::interrupt_handler_asynch),
+                                                 _rx_thunk_irq(this, &SerialBase::interrupt_handler_asynch),
+#endif
+                                                 _rx_coalesced_events(0),
+#if DEVICE_SERIAL_ASYNCH_CIRCULAR
+                                                 _rx_circular(false), _rx_position(0),
 #endif
-                                                _serial(), _baud(9600) {
+#endif
+                                                _serial(), _baud(9600), _break_active(false), _baud_pending(0),
+                                                _rx_ring(NULL), _rx_ring_mask(0), _rx_ring_head(0), _rx_ring_tail(0),
+                                                _rx_ring_overflows(0) {
     serial_init(&_serial, tx, rx);
     serial_irq_handler(&_serial, SerialBase::_irq_handler, (uint32_t)this);
+#if INTERRUPT_PRIORITY_CLASSES
+    InterruptManager::set_priority(serial_irq_number(&_serial), IRQ_PRIORITY_SERIAL);
+#endif
 }
 
 void SerialBase::baud(int baudrate) {
@@ -36,6 +63,65 @@ void SerialBase::baud(int baudrate) {
     _baud = baudrate;
 }
 
+int SerialBase::baud(int baudrate, mbed::util::FunctionPointer callback) {
+    bool start;
+    {
+        CriticalSection lock;
+        if (_break_active || _baud_pending || baudrate <= 0) {
+            return -1;
+        }
+        _baud_pending = baudrate;
+        _baud_callback = callback;
+#if DEVICE_SERIAL_ASYNCH
+        // otherwise the write's completion starts the switch
+        start = !serial_tx_active(&_serial);
+#else
+        start = true;
+#endif
+    }
+    if (start) {
+        start_baud_switch();
+    }
+    return 0;
+}
+
+void SerialBase::start_baud_switch() {
+    // the holding and shift registers may each still hold a frame of
+    // 12 bits, as reckoned for send_break()
+    _break_timeout.attach_us(this, &SerialBase::baud_switch, 24000000/_baud);
+}
+
+void SerialBase::baud_switch() {
+    {
+        CriticalSection lock;
+        serial_baud(&_serial, _baud_pending);
+        _baud = _baud_pending;
+        _baud_pending = 0;
+    }
+    if (_baud_callback) {
+        CompletionQueue::post(_baud_callback.bind());
+    }
+#if DEVICE_SERIAL_ASYNCH
+    dequeue_write();
+#endif
+}
+
+#if DEVICE_SUSPEND
+int SerialBase::suspend() {
+#if DEVICE_SERIAL_ASYNCH
+    if (serial_tx_active(&_serial) || serial_rx_active(&_serial)) {
+        return -1;
+    }
+#endif
+    serial_suspend(&_serial);
+    return 0;
+}
+
+void SerialBase::resume() {
+    serial_resume(&_serial);
+}
+#endif
+
 void SerialBase::format(int bits, Parity parity, int stop_bits) {
     serial_format(&_serial, bits, (SerialParity)parity, stop_bits);
 }
@@ -50,6 +136,9 @@ int SerialBase::writeable() {
 }
 
 void SerialBase::attach(void (*fptr)(void), IrqType type) {
+    if (type == RxIrq) {
+        _rx_ring = NULL;
+    }
     if (fptr) {
         _irq[type].attach(fptr);
         serial_irq_set(&_serial, (SerialIrq)type, 1);
@@ -60,9 +149,81 @@ void SerialBase::attach(void (*fptr)(void), IrqType type) {
 
 void SerialBase::_irq_handler(uint32_t id, SerialIrq irq_type) {
     SerialBase *handler = (SerialBase*)id;
+    if ((IrqType)irq_type == RxIrq && handler->_rx_ring != NULL) {
+        handler->rx_ring_irq();
+        return;
+    }
     handler->_irq[irq_type].call();
 }
 
+int SerialBase::attach_rx_ring(void *buffer, uint32_t size, void (*fptr)(void)) {
+    _rx_ring_notify.attach(fptr);
+    return start_rx_ring(buffer, size);
+}
+
+int SerialBase::start_rx_ring(void *buffer, uint32_t size) {
+    if (size == 0 || (size & (size - 1))) {
+        return -1;
+    }
+    {
+        CriticalSection lock;
+        _rx_ring = (char *)buffer;
+        _rx_ring_mask = size - 1;
+        _rx_ring_head = 0;
+        _rx_ring_tail = 0;
+        _rx_ring_overflows = 0;
+    }
+    serial_irq_set(&_serial, (SerialIrq)RxIrq, 1);
+    return 0;
+}
+
+void SerialBase::rx_ring_irq() {
+    uint32_t head = _rx_ring_head;
+    uint32_t start = head;
+    uint32_t size = _rx_ring_mask + 1;
+#if DEVICE_SERIAL_RX_DRAIN
+    // copy into the contiguous room, wrapping at most once
+    while (true) {
+        uint32_t room = size - (head - _rx_ring_tail);
+        uint32_t offset = head & _rx_ring_mask;
+        uint32_t contiguous = room < size - offset ? room : size - offset;
+        if (contiguous == 0) {
+            break;
+        }
+        size_t n = serial_rx_drain(&_serial, (uint8_t *)_rx_ring + offset, contiguous);
+        head += n;
+        if (n < contiguous) {
+            break;
+        }
+    }
+#endif
+    while (serial_readable(&_serial)) {
+        char c = serial_getc(&_serial);
+        if (head - _rx_ring_tail < size) {
+            _rx_ring[head & _rx_ring_mask] = c;
+            head++;
+        } else {
+            // the FIFO must still be emptied, or the interrupt stays pending
+            _rx_ring_overflows++;
+        }
+    }
+    _rx_ring_head = head;
+    if (head != start && _rx_ring_notify) {
+        _rx_ring_notify.call();
+    }
+}
+
+int SerialBase::read_rx_ring(void *data, int length) {
+    uint32_t tail = _rx_ring_tail;
+    uint32_t available = _rx_ring_head - tail;
+    uint32_t n = (uint32_t)length < available ? (uint32_t)length : available;
+    for (uint32_t i = 0; i < n; i++) {
+        ((char *)data)[i] = _rx_ring[(tail + i) & _rx_ring_mask];
+    }
+    _rx_ring_tail = tail + n;
+    return n;
+}
+
 int SerialBase::_base_getc() {
     return serial_getc(&_serial);
 }
@@ -86,6 +247,27 @@ void SerialBase::send_break() {
   serial_break_clear(&_serial);
 }
 
+int SerialBase::send_break(mbed::util::FunctionPointer callback) {
+    // a baud rate switch waits on the same timeout
+    if (_break_active || _baud_pending) {
+        return -1;
+    }
+    _break_active = true;
+    _break_callback = callback;
+    // 1.5 frames, as in send_break() above
+    serial_break_set(&_serial);
+    _break_timeout.attach_us(this, &SerialBase::break_release, 18000000/_baud);
+    return 0;
+}
+
+void SerialBase::break_release() {
+    serial_break_clear(&_serial);
+    _break_active = false;
+    if (_break_callback) {
+        CompletionQueue::post(_break_callback.bind());
+    }
+}
+
 #if DEVICE_SERIAL_FC
 void SerialBase::set_flow_control(Flow type, PinName flow1, PinName flow2) {
     FlowControl flow_type = (FlowControl)type;
@@ -116,30 +298,98 @@ int SerialBase::write(void *buffer, int length, const event_callback_t& callback
 }
 
 int SerialBase::write(const Buffer& buffer, const event_callback_t& callback, int event) {
-    if (serial_tx_active(&_serial)) {
+    // the IRQ handler may finish the current write and start the next
+    CriticalSection lock;
+    if (serial_tx_active(&_serial) || _baud_pending) {
+#if TRANSACTION_QUEUE_SIZE_SERIAL
+        if (_tx_transaction_buffer.full()) {
+            return -1; // the buffer is full
+        }
+        transaction_t *t = _tx_transaction_buffer.emplace();
+        t->set_object(this);
+        transaction_data_t *td = t->get_transaction();
+        td->buffer = buffer;
+        td->event = event;
+        td->callback = callback;
+#if DRIVER_STATS
+        _tx_stats.queued(_tx_transaction_buffer.size());
+#endif
+        return 0;
+#else
         return -1; // transaction ongoing
+#endif
     }
     start_write(buffer, 0, callback, event);
     return 0;
 }
 
+void SerialBase::dequeue_write()
+{
+#if TRANSACTION_QUEUE_SIZE_SERIAL
+    // start the write from its slot, and only then give the slot up
+    CriticalSection lock;
+    transaction_t *t = _tx_transaction_buffer.front();
+    if (t != NULL) {
+        transaction_data_t *td = t->get_transaction();
+        start_write(td->buffer, 0, td->callback, td->event);
+        _tx_transaction_buffer.pop();
+    }
+#endif
+}
+
 void SerialBase::start_write(const Buffer& buffer, char buffer_width, const event_callback_t& callback, int event)
 {
     (void)buffer_width; // deprecated
+    _tx_deep_sleep.lock();
+    MBED_TIMELINE_EVENT(MBED_TIMELINE_SERIAL_TX_START, this);
+#if DRIVER_STATS
+    _tx_stats.started(buffer.length);
+#endif
     _current_tx_transaction.callback = callback;
     _current_tx_transaction.buffer = buffer;
-    _thunk_irq.callback(&SerialBase::interrupt_handler_asynch);
-    serial_tx_asynch(&_serial, buffer.buf, buffer.length, 0, _thunk_irq.entry(), event, _tx_usage);
+    _current_tx_transaction.event = event;
+#if DEVICE_SERIAL_ASYNCH_CONTEXT
+    serial_asynch_handler(&_serial, &SerialBase::interrupt_handler_context, (uint32_t)this);
+#endif
+    dma_cache_clean(buffer.buf, buffer.length);
+    serial_tx_asynch(&_serial, buffer.buf, buffer.length, 0, SERIAL_TX_IRQ_ENTRY, event, _tx_dma.begin());
 }
 
 void SerialBase::abort_write(void)
 {
     serial_tx_abort_asynch(&_serial);
+#if DRIVER_STATS
+    _tx_stats.finished(0);
+#endif
+    dequeue_write();
+    if (!serial_tx_active(&_serial)) {
+        _tx_deep_sleep.unlock();
+        _tx_dma.end();
+    }
+}
+
+void SerialBase::clear_write_buffer(void)
+{
+#if TRANSACTION_QUEUE_SIZE_SERIAL
+    CriticalSection lock;
+    _tx_transaction_buffer.reset();
+#endif
+}
+
+void SerialBase::abort_all_writes(void)
+{
+    clear_write_buffer();
+    abort_write();
 }
 
 void SerialBase::abort_read(void)
 {
     serial_rx_abort_asynch(&_serial);
+#if DRIVER_STATS
+    _rx_stats.finished(0);
+#endif
+    _rx_deep_sleep.unlock();
+    _rx_dma.end();
 }
 
 int SerialBase::set_dma_usage_tx(DMAUsage usage)
@@ -147,17 +397,15 @@ int SerialBase::set_dma_usage_tx(DMAUsage usage)
     if (serial_tx_active(&_serial)) {
         return -1;
     }
-    _tx_usage = usage;
-    return 0;
+    return _tx_dma.set_usage(usage);
 }
 
 int SerialBase::set_dma_usage_rx(DMAUsage usage)
 {
-    if (serial_tx_active(&_serial)) {
+    if (serial_rx_active(&_serial)) {
         return -1;
     }
-    _rx_usage = usage;
-    return 0;
+    return _rx_dma.set_usage(usage);
 }
 
 int SerialBase::read(void *buffer, int length, const event_callback_t& callback, int event, unsigned char char_match) {
@@ -174,26 +422,161 @@ int SerialBase::read(const Buffer& buffer, const event_callback_t& callback, int
 }
 
 
-void SerialBase::start_read(const Buffer& buffer, char buffer_width, const event_callback_t& callback, int event, unsigned char char_match)
+#if DEVICE_SERIAL_ASYNCH_CIRCULAR
+int SerialBase::read_circular(const Buffer& buffer, const event_callback_t& callback, int event)
+{
+    if (serial_rx_active(&_serial)) {
+        return -1; // transaction ongoing
+    }
+    start_read(buffer, 0, callback, event, SERIAL_RESERVED_CHAR_MATCH, true);
+    return 0;
+}
+#endif
+
+void SerialBase::start_read(const Buffer& buffer, char buffer_width, const event_callback_t& callback, int event, unsigned char char_match, bool circular)
 {
     (void)buffer_width; // deprecated
+    _rx_deep_sleep.lock();
+    MBED_TIMELINE_EVENT(MBED_TIMELINE_SERIAL_RX_START, this);
+#if DRIVER_STATS
+    // a continuous read's bytes are counted as it reports them
+    _rx_stats.started(circular ? 0 : buffer.length);
+#endif
     _current_rx_transaction.callback = callback;
-    _current_tx_transaction.buffer = buffer;
-    _thunk_irq.callback(&SerialBase::interrupt_handler_asynch);
-    serial_rx_asynch(&_serial, buffer.buf, buffer.length, 0, _thunk_irq.entry(), event, char_match, _rx_usage);
+    _current_rx_transaction.buffer = buffer;
+    _current_rx_transaction.event = event;
+#if DEVICE_SERIAL_ASYNCH_CONTEXT
+    serial_asynch_handler(&_serial, &SerialBase::interrupt_handler_context, (uint32_t)this);
+#endif
+    dma_cache_clean_invalidate(buffer.buf, buffer.length);
+#if DEVICE_SERIAL_ASYNCH_CIRCULAR
+    _rx_circular = circular;
+    _rx_position = 0;
+    if (circular) {
+        serial_rx_asynch_circular(&_serial, buffer.buf, buffer.length, 0, SERIAL_RX_IRQ_ENTRY, event & ~SERIAL_EVENT_FLAG_COALESCE, _rx_dma.begin());
+        return;
+    }
+#else
+    (void)circular;
+#endif
+    serial_rx_asynch(&_serial, buffer.buf, buffer.length, 0, SERIAL_RX_IRQ_ENTRY, event & ~SERIAL_EVENT_FLAG_COALESCE, char_match, _rx_dma.begin());
+}
+
+#if DEVICE_SERIAL_ASYNCH_CIRCULAR
+void SerialBase::report_circular(int rx_event)
+{
+    Buffer &buffer = _current_rx_transaction.buffer;
+    size_t position = serial_rx_asynch_position(&_serial);
+#if DRIVER_STATS
+    _rx_stats.moved(position >= _rx_position ? position - _rx_position : buffer.length - _rx_position + position);
+#endif
+    if (position < _rx_position) {
+        // the reception wrapped around since the last report
+        if (_current_rx_transaction.callback) {
+            CompletionQueue::post(_rx_completion, _current_rx_transaction.callback.bind(
+                    Buffer((char *)buffer.buf + _rx_position, buffer.length - _rx_position), rx_event));
+        }
+        _rx_position = 0;
+    }
+    if (position > _rx_position && _current_rx_transaction.callback) {
+        CompletionQueue::post(_rx_completion, _current_rx_transaction.callback.bind(
+                Buffer((char *)buffer.buf + _rx_position, position - _rx_position), rx_event));
+    }
+    _rx_position = (position == (size_t)buffer.length) ? 0 : position;
+}
+#endif
+
+void SerialBase::post_rx_coalesced(int rx_event)
+{
+    bool post;
+    {
+        CriticalSection lock;
+        post = (_rx_coalesced_events == 0);
+        _rx_coalesced_events |= rx_event;
+    }
+    if (post) {
+        CompletionQueue::post(_rx_completion,
+                mbed::util::FunctionPointer0<void>(this, &SerialBase::deliver_rx_coalesced).bind());
+    }
 }
 
+void SerialBase::deliver_rx_coalesced()
+{
+    int rx_event;
+    {
+        CriticalSection lock;
+        rx_event = _rx_coalesced_events;
+        _rx_coalesced_events = 0;
+    }
+    if (rx_event && _current_rx_transaction.callback) {
+        _current_rx_transaction.callback.call(_current_rx_transaction.buffer, rx_event);
+    }
+}
+
+#if DEVICE_SERIAL_ASYNCH_CONTEXT
+void SerialBase::interrupt_handler_context(uint32_t id)
+{
+    ((SerialBase *)id)->interrupt_handler_asynch();
+}
+#endif
+
 void SerialBase::interrupt_handler_asynch(void)
 {
     int event = serial_irq_handler_asynch(&_serial);
     int rx_event = event & SERIAL_EVENT_RX_MASK;
+    if (rx_event) {
+        MBED_TIMELINE_EVENT(MBED_TIMELINE_SERIAL_RX_DONE, this);
+        dma_cache_invalidate(_current_rx_transaction.buffer.buf, _current_rx_transaction.buffer.length);
+    }
+#if DRIVER_STATS
+    if (rx_event) {
+        // a continuous read carries on after reporting
+        if (serial_rx_active(&_serial)) {
+            _rx_stats.reported(rx_event);
+        } else {
+            _rx_stats.finished(rx_event);
+        }
+    }
+#endif
+    if (rx_event && !serial_rx_active(&_serial)) {
+        _rx_deep_sleep.unlock();
+        _rx_dma.end();
+    }
+#if DEVICE_SERIAL_ASYNCH_CIRCULAR
+    if (_rx_circular && rx_event) {
+        report_circular(rx_event);
+        rx_event = 0;
+    }
+#endif
     if (_current_rx_transaction.callback && rx_event) {
-        minar::Scheduler::postCallback(_current_rx_transaction.callback.bind(_current_rx_transaction.buffer, rx_event));
+        if (_current_rx_transaction.event & SERIAL_EVENT_FLAG_COALESCE) {
+            post_rx_coalesced(rx_event);
+        } else {
+            CompletionQueue::post(_rx_completion, _current_rx_transaction.callback.bind(_current_rx_transaction.buffer, rx_event));
+        }
     }
 
     int tx_event = event & SERIAL_EVENT_TX_MASK;
-    if (_current_tx_transaction.callback && tx_event) {
-        minar::Scheduler::postCallback(_current_tx_transaction.callback.bind(_current_tx_transaction.buffer, tx_event));
+    if (tx_event) {
+        MBED_TIMELINE_EVENT(MBED_TIMELINE_SERIAL_TX_DONE, this);
+#if DRIVER_STATS
+        _tx_stats.finished(tx_event);
+#endif
+        transaction_data_t done = _current_tx_transaction;
+        if (_baud_pending) {
+            // the held writes start once the new rate is in use
+            start_baud_switch();
+        } else {
+            // start the next write before anything else, so the line never idles
+            dequeue_write();
+        }
+        if (!serial_tx_active(&_serial)) {
+            _tx_deep_sleep.unlock();
+            _tx_dma.end();
+        }
+        if (done.callback) {
+            CompletionQueue::post(_tx_completion, done.callback.bind(done.buffer, tx_event));
+        }
     }
 }
 
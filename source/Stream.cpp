@@ -16,43 +16,126 @@
 #include "mbed-drivers/Stream.h"
 
 #include <cstdarg>
+#include <cstring>
 
 namespace mbed {
 
-Stream::Stream(const char *name) : FileLike(name), _file(NULL) {
+Stream::Stream(const char *name) : FileLike(name), _file(NULL), _writing(false) {
+#if !MBED_MINIMAL_STDIO
     /* open ourselves */
-    char buf[12]; /* :0x12345678 + null byte */
-    std::sprintf(buf, ":%p", this);
-    _file = std::fopen(buf, "w+");
+    _file = fdopen(this, "w+");
     setbuf(_file, NULL);
+#endif
 }
 
 Stream::~Stream() {
+#if !MBED_MINIMAL_STDIO
     fclose(_file);
+#endif
+}
+
+#if MBED_MINIMAL_STDIO
+/* Without a FILE, nothing is buffered, so the stream goes straight to the
+ * device */
+namespace {
+
+// Stream's write() is protected, but FileHandle's is public
+void stream_out(void *context, const char *data, size_t length) {
+    static_cast<FileHandle *>(context)->write(data, length);
+}
+
+} // namespace
+
+int Stream::set_buffer(BufferMode mode, char *buf, size_t size) {
+    (void)mode, (void)buf, (void)size;
+    return -1;
+}
+
+void Stream::begin_write() {
+}
+
+void Stream::begin_read() {
 }
 
 int Stream::putc(int c) {
+    return _putc(c);
+}
+
+int Stream::puts(const char *s) {
+    size_t length = std::strlen(s);
+    return (_write(s, length) == (ssize_t)length) ? 0 : EOF;
+}
+
+int Stream::getc() {
+    return _getc();
+}
+
+char* Stream::gets(char *s, int size) {
+    int n = 0;
+    while (n < size - 1) {
+        int c = _getc();
+        if (c == EOF) {
+            break;
+        }
+        s[n++] = c;
+        if (c == '\n') {
+            break;
+        }
+    }
+    if (n == 0 || size <= 0) {
+        return NULL;
+    }
+    s[n] = '\0';
+    return s;
+}
+
+#else
+
+int Stream::set_buffer(BufferMode mode, char *buf, size_t size) {
+    fflush(_file);
+    return setvbuf(_file, buf, mode, size);
+}
+
+void Stream::begin_write() {
+    if (!_writing) {
+        fflush(_file);
+        _writing = true;
+    }
+}
+
+void Stream::begin_read() {
+    // the output may have been written through the FILE directly
     fflush(_file);
+    _writing = false;
+}
+
+int Stream::putc(int c) {
+    begin_write();
     return std::fputc(c, _file);
 }
 int Stream::puts(const char *s) {
-    fflush(_file);
+    begin_write();
     return std::fputs(s, _file);
 }
 int Stream::getc() {
-    fflush(_file);
+    begin_read();
     return std::fgetc(_file);
 }
 char* Stream::gets(char *s, int size) {
-    fflush(_file);
+    begin_read();
     return std::fgets(s,size,_file);
 }
+#endif
 
 int Stream::close() {
     return 0;
 }
 
 ssize_t Stream::write(const void* buffer, size_t length) {
+    return _write(buffer, length);
+}
+
+ssize_t Stream::_write(const void* buffer, size_t length) {
     const char* ptr = (const char*)buffer;
     const char* end = ptr + length;
     while (ptr != end) {
@@ -64,6 +147,10 @@ ssize_t Stream::write(const void* buffer, size_t length) {
 }
 
 ssize_t Stream::read(void* buffer, size_t length) {
+    return _read(buffer, length);
+}
+
+ssize_t Stream::_read(void* buffer, size_t length) {
     char* ptr = (char*)buffer;
     char* end = ptr + length;
     while (ptr != end) {
@@ -94,19 +181,25 @@ off_t Stream::flen() {
 int Stream::printf(const char* format, ...) {
     std::va_list arg;
     va_start(arg, format);
-    fflush(_file);
+#if MBED_MINIMAL_STDIO
+    int r = mbed_vxprintf(stream_out, static_cast<FileHandle *>(this), format, arg);
+#else
+    begin_write();
     int r = vfprintf(_file, format, arg);
+#endif
     va_end(arg);
     return r;
 }
 
+#if !MBED_MINIMAL_STDIO
 int Stream::scanf(const char* format, ...) {
     std::va_list arg;
     va_start(arg, format);
-    fflush(_file);
+    begin_read();
     int r = vfscanf(_file, format, arg);
     va_end(arg);
     return r;
 }
+#endif
 
 } // namespace mbed
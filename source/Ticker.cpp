@@ -18,23 +18,78 @@
 #include "mbed-drivers/TimerEvent.h"
 #include "core-util/FunctionPointer.h"
 #include "ticker_api.h"
+#include "core-util/CriticalSectionLock.h"
 
 namespace mbed {
 
 void Ticker::detach() {
     remove();
     _function.attach(0);
+    _context_function = NULL;
+    _pending = 0;
 }
 
-void Ticker::setup(timestamp_t t) {
+void Ticker::setup(timestamp_t t, timestamp_t slack) {
     remove();
     _delay = t;
-    insert(_delay + ticker_read(_ticker_data));
+    _slack = slack;
+    _deadline = _delay + ticker_read(_ticker_data);
+    _overruns = 0;
+    insert(_deadline, _slack);
 }
 
 void Ticker::handler() {
-    insert(event.timestamp + _delay);
-    _function.call();
+    // step from the requested time, so that coalescing doesn't add drift
+    _deadline += _delay;
+    int32_t late = (int32_t)(ticker_read(_ticker_data) - _deadline);
+    if (late >= 0 && _delay > 0) {
+        // the next period has passed already
+        uint32_t passed = (uint32_t)late / _delay + 1;
+        if (_overrun == OVERRUN_SKIP) {
+            _overruns += passed;
+            _deadline += passed * _delay;
+        } else if (_overrun == OVERRUN_COMPRESS) {
+            _overruns += passed;
+            _deadline += (passed - 1) * _delay;
+        } else {
+            // each passed period is counted as its own call is scheduled
+            _overruns++;
+        }
+    }
+    insert(_deadline, _slack);
+    run_or_defer();
+}
+
+void Ticker::run_or_defer() {
+    if (_dispatch == DISPATCH_IRQ) {
+        call();
+        return;
+    }
+    bool post;
+    {
+        mbed::util::CriticalSectionLock lock;
+        post = (_pending == 0);
+        _pending++;
+    }
+    if (post) {
+        CompletionQueue::post(_slot, mbed::util::FunctionPointer0<void>(this, &Ticker::run_deferred).bind());
+    }
+}
+
+void Ticker::run_deferred() {
+    uint32_t periods;
+    {
+        mbed::util::CriticalSectionLock lock;
+        periods = _pending;
+        _pending = 0;
+    }
+    if (_dispatch != DISPATCH_SCHEDULER_CATCH_UP && periods > 1) {
+        periods = 1;
+    }
+    // detach() may have run since the periods were counted
+    for (; periods > 0 && attached(); periods--) {
+        call();
+    }
 }
 
 } // namespace mbed
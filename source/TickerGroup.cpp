@@ -0,0 +1,137 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/TickerGroup.h"
+
+#include <stddef.h>
+
+#include "ticker_api.h"
+#include "core-util/CriticalSectionLock.h"
+
+namespace mbed {
+
+namespace {
+
+uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+} // namespace
+
+TickerGroup::TickerGroup() : TimerEvent(), _functions(), _base(0), _deadline(0), _tick(0) {
+}
+
+TickerGroup::TickerGroup(const ticker_data_t *const data) :
+        TimerEvent(data), _functions(), _base(0), _deadline(0), _tick(0) {
+}
+
+TickerGroup::~TickerGroup() {
+    stop();
+}
+
+void TickerGroup::start(timestamp_t base_us) {
+    remove();
+    {
+        mbed::util::CriticalSectionLock lock;
+        _tick = 0;
+        for (int i = 0; i < TICKER_GROUP_MAX_FUNCTIONS; i++) {
+            _functions[i].next = _functions[i].phase;
+        }
+    }
+    _base = base_us;
+    _deadline = _base + ticker_read(_ticker_data);
+    insert(_deadline);
+}
+
+void TickerGroup::stop() {
+    remove();
+}
+
+/* Two functions share a base period whenever their phases are equal modulo
+ * the gcd of their divisors, so take the phase that meets that for the
+ * fewest of the functions already attached */
+uint32_t TickerGroup::choose_phase(uint32_t divisor) const {
+    uint32_t best = 0;
+    int best_shared = TICKER_GROUP_MAX_FUNCTIONS + 1;
+    for (uint32_t p = 0; p < divisor && best_shared > 0; p++) {
+        int shared = 0;
+        for (int i = 0; i < TICKER_GROUP_MAX_FUNCTIONS; i++) {
+            const function_t &f = _functions[i];
+            if (f.function != NULL) {
+                uint32_t g = gcd(divisor, f.divisor);
+                if (p % g == f.phase % g) {
+                    shared++;
+                }
+            }
+        }
+        if (shared < best_shared) {
+            best = p;
+            best_shared = shared;
+        }
+    }
+    return best;
+}
+
+int TickerGroup::attach(void (*fptr)(void *), void *context, uint32_t divisor, uint32_t phase) {
+    if (fptr == NULL || divisor == 0) {
+        return -1;
+    }
+    phase = (phase == PHASE_AUTO) ? choose_phase(divisor) : phase % divisor;
+
+    mbed::util::CriticalSectionLock lock;
+    for (int i = 0; i < TICKER_GROUP_MAX_FUNCTIONS; i++) {
+        function_t &f = _functions[i];
+        if (f.function == NULL) {
+            f.context = context;
+            f.divisor = divisor;
+            f.phase = phase;
+            // the first base period from the next to end that is in phase
+            f.next = _tick + (phase + divisor - _tick % divisor) % divisor;
+            f.function = fptr;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void TickerGroup::detach(int id) {
+    if (id >= 0 && id < TICKER_GROUP_MAX_FUNCTIONS) {
+        _functions[id].function = NULL;
+    }
+}
+
+void TickerGroup::handler() {
+    // step from the requested time, as Ticker does, so there is no drift
+    _deadline += _base;
+    insert(_deadline);
+
+    // functions attached from here on start from the next base period
+    uint32_t tick = _tick;
+    _tick = tick + 1;
+    for (int i = 0; i < TICKER_GROUP_MAX_FUNCTIONS; i++) {
+        function_t &f = _functions[i];
+        if (f.function != NULL && f.next == tick) {
+            f.next = tick + f.divisor;
+            f.function(f.context);
+        }
+    }
+}
+
+} // namespace mbed
@@ -18,7 +18,7 @@
 namespace mbed {
 
 void Timeout::handler() {
-    _function.call();
+    run_or_defer();
 }
 
 } // namespace mbed
@@ -19,17 +19,18 @@
 
 namespace mbed {
 
-Timer::Timer() : _running(), _start(), _time(), _ticker_data(get_us_ticker_data()) {
+Timer::Timer() : _running(), _start(), _time(), _ticker_data(get_us_ticker_data()), _us_ticker(true) {
     reset();
 }
 
-Timer::Timer(const ticker_data_t *const data) : _running(), _start(), _time(), _ticker_data(data) {
+Timer::Timer(const ticker_data_t *const data) :
+        _running(), _start(), _time(), _ticker_data(data), _us_ticker(data == get_us_ticker_data()) {
     reset();
 }
 
 void Timer::start() {
     if (!_running) {
-        _start = ticker_read(_ticker_data);
+        _start = ticker_read_us(_ticker_data);
         _running = 1;
     }
 }
@@ -40,27 +41,34 @@ void Timer::stop() {
 }
 
 int Timer::read_us() {
+    // the low 32 bits of elapsed_ticks() are right however long it runs
+    return elapsed_ticks();
+}
+
+us_timestamp_t Timer::read_high_resolution_us() {
     return _time + slicetime();
 }
 
 float Timer::read() {
-    return (float)read_us() / 1000000.0f;
+    return (float)read_high_resolution_us() / 1000000.0f;
 }
 
 int Timer::read_ms() {
-    return read_us() / 1000;
+    return read_high_resolution_us() / 1000;
 }
 
-int Timer::slicetime() {
+us_timestamp_t Timer::slicetime() {
     if (_running) {
-        return ticker_read(_ticker_data) - _start;
+        return ticker_read_us(_ticker_data) - _start;
     } else {
         return 0;
     }
 }
 
 void Timer::reset() {
-    _start = ticker_read(_ticker_data);
+    if (_running) {
+        _start = ticker_read_us(_ticker_data);
+    }
     _time = 0;
 }
 
@@ -18,20 +18,80 @@
 
 #include <stddef.h>
 #include "ticker_api.h"
+#include "mbed-drivers/ticker_api_ext.h"
 #include "us_ticker_api.h"
+#if DEVICE_RTC_ALARM
+#include "rtc_api.h"
+#include "mbed-drivers/mbed_critical.h"
+#endif
+
+/* The furthest ahead an event is queued. Comparing 32-bit timestamps in the
+ * queue is only valid within half the counter period. */
+#ifndef TIMER_EVENT_MAX_STEP_US
+#define TIMER_EVENT_MAX_STEP_US (1UL << 30)
+#endif
+
+#if DEVICE_RTC_ALARM
+/* Events at least this far away wait on the RTC alarm rather than on their
+ * ticker, so the ticker neither steps towards them nor, for the us ticker,
+ * holds off deep sleep. */
+#ifndef TIMER_EVENT_RTC_PARK_US
+#define TIMER_EVENT_RTC_PARK_US TIMER_EVENT_MAX_STEP_US
+#endif
+
+/* How many seconds before a parked event is due the RTC alarm moves it back
+ * to its ticker, which covers the RTC counting whole seconds */
+#ifndef TIMER_EVENT_RTC_LEAD_S
+#define TIMER_EVENT_RTC_LEAD_S 2
+#endif
+#endif
 
 namespace mbed {
 
-TimerEvent::TimerEvent() : event(), _ticker_data(get_us_ticker_data()) {
-    ticker_set_handler(_ticker_data, (&TimerEvent::irq));
+#if DEVICE_RTC_ALARM
+TimerEvent *TimerEvent::_parked = NULL;
+#define TIMER_EVENT_PARK_INIT , _next_parked(NULL), _rtc_due_us(0), _is_parked(false)
+#else
+#define TIMER_EVENT_PARK_INIT
+#endif
+
+TimerEvent::TimerEvent() : event(), _target(), _stepping(false), _soft(false),
+        _soft_slot(mbed::util::FunctionPointer0<void>(this, &TimerEvent::handler).bind()),
+        _ticker_data(get_us_ticker_data()) TIMER_EVENT_PARK_INIT {
+#if DEVICE_TICKER_EVENT_EXTENDED
+    event.handler = &TimerEvent::irq;
+#else
+    ticker_set_handler(_ticker_data, &TimerEvent::irq);
+#endif
 }
 
-TimerEvent::TimerEvent(const ticker_data_t *data) : event(), _ticker_data(data) {
-    ticker_set_handler(_ticker_data, (&TimerEvent::irq));
+TimerEvent::TimerEvent(const ticker_data_t *data) : event(), _target(), _stepping(false), _soft(false),
+        _soft_slot(mbed::util::FunctionPointer0<void>(this, &TimerEvent::handler).bind()),
+        _ticker_data(data) TIMER_EVENT_PARK_INIT {
+#if DEVICE_TICKER_EVENT_EXTENDED
+    event.handler = &TimerEvent::irq;
+#else
+    ticker_set_handler(_ticker_data, &TimerEvent::irq);
+#endif
 }
 
 void TimerEvent::irq(uint32_t id) {
     TimerEvent *timer_event = (TimerEvent*)id;
+    // events with no TimerEvent, such as the one a sleeping wait uses,
+    // are only there to wake the core up
+    if (timer_event == NULL) {
+        return;
+    }
+    if (timer_event->_stepping) {
+        timer_event->insert_us(timer_event->_target);
+        return;
+    }
+    // the handler takes the lock again if it queues the event again
+    timer_event->_deep_sleep.unlock();
+    if (timer_event->_soft) {
+        CompletionQueue::post(timer_event->_soft_slot);
+        return;
+    }
     timer_event->handler();
 }
 
@@ -41,11 +101,126 @@ TimerEvent::~TimerEvent() {
 
 // insert in to linked list
 void TimerEvent::insert(timestamp_t timestamp) {
+#if DEVICE_RTC_ALARM
+    unpark();
+#endif
+    _stepping = false;
+    lock_deep_sleep();
     ticker_insert_event(_ticker_data, &event, timestamp, (uint32_t)this);
 }
 
+void TimerEvent::insert(timestamp_t timestamp, timestamp_t slack) {
+#if DEVICE_RTC_ALARM
+    unpark();
+#endif
+    _stepping = false;
+    lock_deep_sleep();
+    ticker_insert_event_slack(_ticker_data, &event, timestamp, slack, (uint32_t)this);
+}
+
+void TimerEvent::insert_us(us_timestamp_t timestamp) {
+    us_timestamp_t now = ticker_read_us(_ticker_data);
+    _target = timestamp;
+#if DEVICE_RTC_ALARM
+    unpark();
+    if ((int64_t)(timestamp - now) >= (int64_t)TIMER_EVENT_RTC_PARK_US && rtc_isenabled()) {
+        // the ticker may stop in deep sleep while the RTC runs on
+        ticker_remove_event(_ticker_data, &event);
+        _deep_sleep.unlock();
+        _stepping = false;
+        park(timestamp - now);
+        return;
+    }
+#endif
+    lock_deep_sleep();
+    if ((int64_t)(timestamp - now) < (int64_t)TIMER_EVENT_MAX_STEP_US) {
+        _stepping = false;
+        ticker_insert_event(_ticker_data, &event, (timestamp_t)timestamp, (uint32_t)this);
+    } else {
+        _stepping = true;
+        ticker_insert_event(_ticker_data, &event, (timestamp_t)(now + TIMER_EVENT_MAX_STEP_US), (uint32_t)this);
+    }
+}
+
 void TimerEvent::remove() {
+#if DEVICE_RTC_ALARM
+    unpark();
+#endif
     ticker_remove_event(_ticker_data, &event);
+    // a soft event that expired is only done once its handler has run
+    CompletionQueue::cancel(_soft_slot);
+    _deep_sleep.unlock();
+}
+
+void TimerEvent::lock_deep_sleep() {
+    // other tickers, such as the low power ticker, run in deep sleep
+    if (_ticker_data == get_us_ticker_data()) {
+        _deep_sleep.lock();
+    }
+}
+
+#if DEVICE_RTC_ALARM
+void TimerEvent::park(us_timestamp_t remaining) {
+    uint32_t state = mbed_critical_enter();
+    // the RTC only tells the second, so this may be up to a second late
+    _rtc_due_us = (uint64_t)rtc_read() * 1000000 + remaining;
+    TimerEvent **p = &_parked;
+    while (*p != NULL && (*p)->_rtc_due_us <= _rtc_due_us) {
+        p = &(*p)->_next_parked;
+    }
+    _next_parked = *p;
+    *p = this;
+    _is_parked = true;
+    if (_parked == this) {
+        arm_rtc();
+    }
+    mbed_critical_exit(state);
+}
+
+void TimerEvent::unpark() {
+    if (!_is_parked) {
+        return;
+    }
+    uint32_t state = mbed_critical_enter();
+    bool first = (_parked == this);
+    for (TimerEvent **p = &_parked; *p != NULL; p = &(*p)->_next_parked) {
+        if (*p == this) {
+            *p = _next_parked;
+            break;
+        }
+    }
+    _is_parked = false;
+    if (first) {
+        arm_rtc();
+    }
+    mbed_critical_exit(state);
+}
+
+void TimerEvent::arm_rtc() {
+    if (_parked != NULL) {
+        rtc_set_alarm((time_t)(_parked->_rtc_due_us / 1000000 - TIMER_EVENT_RTC_LEAD_S), &TimerEvent::rtc_alarm_irq);
+    } else {
+        rtc_clear_alarm();
+    }
+}
+
+void TimerEvent::rtc_alarm_irq() {
+    uint64_t now = (uint64_t)rtc_read() * 1000000;
+    while (true) {
+        uint32_t state = mbed_critical_enter();
+        TimerEvent *e = _parked;
+        if (e == NULL || e->_rtc_due_us / 1000000 > now / 1000000 + TIMER_EVENT_RTC_LEAD_S) {
+            arm_rtc();
+            mbed_critical_exit(state);
+            return;
+        }
+        _parked = e->_next_parked;
+        e->_is_parked = false;
+        mbed_critical_exit(state);
+        us_timestamp_t remaining = e->_rtc_due_us > now ? e->_rtc_due_us - now : 0;
+        e->insert_us(ticker_read_us(e->_ticker_data) + remaining);
+    }
 }
+#endif
 
 } // namespace mbed
@@ -0,0 +1,161 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/TraceOutput.h"
+#include "mbed-drivers/mbed_critical.h"
+#include <string.h>
+
+/* The layout the probe expects, as SEGGER_RTT.h's */
+struct rtt_ring_t {
+    const char *name;
+    char *buffer;
+    uint32_t size;
+    volatile uint32_t write_offset;
+    volatile uint32_t read_offset;
+    uint32_t flags;
+};
+
+struct rtt_control_block_t {
+    char id[16];
+    int32_t max_up;
+    int32_t max_down;
+    rtt_ring_t up;
+    rtt_ring_t down;
+};
+
+#define RTT_MODE_NO_BLOCK_SKIP      0
+#define RTT_MODE_BLOCK_IF_FIFO_FULL 2
+
+extern "C" {
+rtt_control_block_t _SEGGER_RTT;
+}
+
+static char rtt_up_buffer[RTT_UP_BUFFER_SIZE];
+static char rtt_down_buffer[RTT_DOWN_BUFFER_SIZE];
+static volatile uint32_t rtt_dropped;
+
+namespace mbed {
+
+#if TRACE_ITM
+ssize_t ITMFileHandle::write(const void *buffer, size_t length) {
+    if (!enabled()) {
+        return length;
+    }
+    const uint8_t *data = (const uint8_t *)buffer;
+    size_t i = 0;
+    // a word per store; the port reads as non-zero when it has room
+    for (; i + 4 <= length; i += 4) {
+        uint32_t word;
+        memcpy(&word, data + i, 4);
+        while (ITM->PORT[_port].u32 == 0) {
+        }
+        ITM->PORT[_port].u32 = word;
+    }
+    for (; i < length; i++) {
+        while (ITM->PORT[_port].u32 == 0) {
+        }
+        ITM->PORT[_port].u8 = data[i];
+    }
+    return length;
+}
+#endif
+
+RTTFileHandle::RTTFileHandle() {
+    CriticalSection lock;
+    rtt_control_block_t *cb = &_SEGGER_RTT;
+    if (cb->max_up != 0) {
+        return;
+    }
+    cb->max_up = 1;
+    cb->max_down = 1;
+    cb->up.name = "Terminal";
+    cb->up.buffer = rtt_up_buffer;
+    cb->up.size = RTT_UP_BUFFER_SIZE;
+    cb->up.flags = RTT_BLOCK_IF_FULL ? RTT_MODE_BLOCK_IF_FIFO_FULL : RTT_MODE_NO_BLOCK_SKIP;
+    cb->down.name = "Terminal";
+    cb->down.buffer = rtt_down_buffer;
+    cb->down.size = RTT_DOWN_BUFFER_SIZE;
+    cb->down.flags = RTT_MODE_NO_BLOCK_SKIP;
+    // the ID goes in last, built at run time, so that the probe can't find
+    // a control block that is half set up, or a copy of the ID elsewhere
+    __DMB();
+    strcpy(cb->id, "SEGGER");
+    cb->id[6] = ' ';
+    strcpy(cb->id + 7, "RTT");
+    __DMB();
+}
+
+ssize_t RTTFileHandle::write(const void *buffer, size_t length) {
+    const char *data = (const char *)buffer;
+    rtt_ring_t *ring = &_SEGGER_RTT.up;
+    size_t n = 0;
+    while (true) {
+        {
+            CriticalSection lock;
+            uint32_t w = ring->write_offset;
+            uint32_t r = ring->read_offset;
+            uint32_t room = (r > w ? r - w : ring->size - w + r) - 1;
+            uint32_t count = length - n < room ? length - n : room;
+            // in at most two copies, up to the end of the ring and from the start
+            uint32_t first = ring->size - w < count ? ring->size - w : count;
+            memcpy(ring->buffer + w, data + n, first);
+            memcpy(ring->buffer, data + n + first, count - first);
+            w += count;
+            if (w >= ring->size) {
+                w -= ring->size;
+            }
+            __DMB();
+            ring->write_offset = w;
+            n += count;
+        }
+        if (n == length) {
+            return length;
+        }
+        // the ring is full: wait for the probe to make room, unless waiting
+        // is not wanted, or we are in an interrupt
+        if (!RTT_BLOCK_IF_FULL || __get_IPSR() != 0 || __get_PRIMASK() != 0) {
+            rtt_dropped += length - n;
+            return length;
+        }
+    }
+}
+
+ssize_t RTTFileHandle::read(void *buffer, size_t length) {
+    if (length == 0) {
+        return 0;
+    }
+    char *data = (char *)buffer;
+    rtt_ring_t *ring = &_SEGGER_RTT.down;
+    while (ring->write_offset == ring->read_offset) {
+    }
+    CriticalSection lock;
+    uint32_t w = ring->write_offset;
+    uint32_t r = ring->read_offset;
+    size_t n = 0;
+    while (r != w && n < length) {
+        data[n++] = ring->buffer[r];
+        if (++r == ring->size) {
+            r = 0;
+        }
+    }
+    ring->read_offset = r;
+    return n;
+}
+
+uint32_t RTTFileHandle::dropped() {
+    return rtt_dropped;
+}
+
+} // namespace mbed
@@ -0,0 +1,300 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/TriggerLink.h"
+
+namespace mbed {
+
+#if DEVICE_SPI_ASYNCH
+namespace {
+
+// an empty buffer adds no segment, rather than one of no frames
+SPI::SPITransferAdder &segments(SPI::SPITransferAdder &adder, const Buffer &tx, const Buffer &rx) {
+    if (tx.length) {
+        adder.tx(tx.buf, tx.length);
+    }
+    if (rx.length) {
+        adder.rx(rx.buf, rx.length);
+    }
+    return adder;
+}
+
+} // namespace
+#endif
+
+TriggerLink::TriggerLink() :
+        _source(SOURCE_NONE),
+        _action(ACTION_NONE),
+        _enabled(false),
+        _hardware(false),
+#if DEVICE_INTERRUPTIN
+        _in(NULL),
+        _edge(IRQ_RISE),
+        _handler(NULL),
+#endif
+        _ticker(NULL),
+        _period_us(0),
+#if DEVICE_SPI_ASYNCH
+        _spi(NULL),
+#endif
+#if DEVICE_ANALOGIN
+        _adc(NULL),
+        _sample(NULL),
+#endif
+#if DEVICE_PWMOUT
+        _pwm(NULL),
+        _value(0.0f),
+#endif
+        _done((void (*)(void))NULL),
+        _done_signal(mbed::util::FunctionPointer0<void>(this, &TriggerLink::deliver).bind()) {
+}
+
+TriggerLink::~TriggerLink() {
+    disable();
+}
+
+#if DEVICE_INTERRUPTIN
+int TriggerLink::from(InterruptIn &in, gpio_irq_event edge) {
+    if (_enabled) {
+        return -1;
+    }
+    _source = SOURCE_PIN;
+    _in = &in;
+    _edge = edge;
+    return 0;
+}
+#endif
+
+int TriggerLink::from(Ticker &ticker, timestamp_t period_us) {
+    if (_enabled) {
+        return -1;
+    }
+    _source = SOURCE_TICKER;
+    _ticker = &ticker;
+    _period_us = period_us;
+    return 0;
+}
+
+#if DEVICE_SPI_ASYNCH
+int TriggerLink::to(SPI &spi, const Buffer &tx, const Buffer &rx) {
+    if (_enabled) {
+        return -1;
+    }
+    _action = ACTION_SPI;
+    _spi = &spi;
+    _tx = tx;
+    _rx = rx;
+    return 0;
+}
+#endif
+
+#if DEVICE_ANALOGIN
+int TriggerLink::to(AnalogIn &in, uint16_t *sample) {
+    if (_enabled) {
+        return -1;
+    }
+    _action = ACTION_ADC;
+    _adc = &in;
+    _sample = sample;
+    return 0;
+}
+#endif
+
+#if DEVICE_PWMOUT
+int TriggerLink::to(PwmOut &out, float value) {
+    if (_enabled) {
+        return -1;
+    }
+    _action = ACTION_PWM;
+    _pwm = &out;
+    _value = value;
+    return 0;
+}
+#endif
+
+int TriggerLink::enable(const done_callback_t &done) {
+    if (_enabled || _source == SOURCE_NONE || _action == ACTION_NONE) {
+        return -1;
+    }
+    _done = done;
+#if DEVICE_TRIGGER_LINK
+    if (route() == 0) {
+        _hardware = true;
+        _enabled = true;
+        return 0;
+    }
+#endif
+    switch (_source) {
+#if DEVICE_INTERRUPTIN
+        case SOURCE_PIN:
+            if (_edge == IRQ_FALL) {
+                _handler = _in->add_fall(this, &TriggerLink::fire);
+            } else {
+                _handler = _in->add_rise(this, &TriggerLink::fire);
+            }
+            if (_handler == NULL) {
+                return -1;
+            }
+            break;
+#endif
+        case SOURCE_TICKER:
+            _ticker->attach_us(&TriggerLink::fire_context, this, _period_us);
+            break;
+        default:
+            return -1;
+    }
+    _enabled = true;
+    return 0;
+}
+
+void TriggerLink::disable() {
+    if (!_enabled) {
+        return;
+    }
+    _enabled = false;
+#if DEVICE_TRIGGER_LINK
+    if (_hardware) {
+        _hardware = false;
+        trigger_link_disable(&_link);
+        trigger_link_free(&_link);
+        return;
+    }
+#endif
+    switch (_source) {
+#if DEVICE_INTERRUPTIN
+        case SOURCE_PIN:
+            if (_edge == IRQ_FALL) {
+                _in->remove_fall(_handler);
+            } else {
+                _in->remove_rise(_handler);
+            }
+            _handler = NULL;
+            break;
+#endif
+        case SOURCE_TICKER:
+            _ticker->detach();
+            break;
+        default:
+            break;
+    }
+}
+
+#if DEVICE_TRIGGER_LINK
+int TriggerLink::route() {
+    if (trigger_link_init(&_link) != 0) {
+        // every routing channel is in use
+        return -1;
+    }
+    int rc = -1;
+    switch (_source) {
+#if DEVICE_INTERRUPTIN
+        case SOURCE_PIN:
+            rc = trigger_link_source_gpio(&_link, &_in->gpio_irq, _edge);
+            break;
+#endif
+        case SOURCE_TICKER:
+            rc = trigger_link_source_period(&_link, _period_us);
+            break;
+        default:
+            break;
+    }
+    if (rc == 0) {
+        switch (_action) {
+#if DEVICE_SPI_ASYNCH
+            case ACTION_SPI:
+                rc = trigger_link_action_spi(&_link, &_spi->_spi, _tx.buf, _tx.length, _rx.buf, _rx.length);
+                break;
+#endif
+#if DEVICE_ANALOGIN
+            case ACTION_ADC:
+                rc = trigger_link_action_adc(&_link, &_adc->_adc, _sample);
+                break;
+#endif
+#if DEVICE_PWMOUT
+            case ACTION_PWM:
+                rc = trigger_link_action_pwm(&_link, &_pwm->_pwm, _value);
+                break;
+#endif
+            default:
+                rc = -1;
+                break;
+        }
+    }
+    if (rc == 0) {
+        rc = trigger_link_enable(&_link, &TriggerLink::hw_done, (uint32_t)this);
+    }
+    if (rc != 0) {
+        trigger_link_free(&_link);
+    }
+    return rc;
+}
+
+void TriggerLink::hw_done(uint32_t id) {
+    ((TriggerLink *)id)->signal();
+}
+#endif
+
+void TriggerLink::fire_context(void *context) {
+    ((TriggerLink *)context)->fire();
+}
+
+void TriggerLink::fire() {
+    switch (_action) {
+#if DEVICE_SPI_ASYNCH
+        case ACTION_SPI:
+            segments(_spi->transfer().callback(SPI::event_callback_t(this, &TriggerLink::spi_done), SPI_EVENT_ALL),
+                     _tx, _rx).apply();
+            break;
+#endif
+#if DEVICE_ANALOGIN
+        case ACTION_ADC:
+            *_sample = _adc->read_u16();
+            signal();
+            break;
+#endif
+#if DEVICE_PWMOUT
+        case ACTION_PWM:
+            _pwm->write(_value);
+            signal();
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+void TriggerLink::signal() {
+    if (_done) {
+        CompletionQueue::post(_done_signal);
+    }
+}
+
+void TriggerLink::deliver() {
+    if (_done) {
+        _done.call();
+    }
+}
+
+#if DEVICE_SPI_ASYNCH
+void TriggerLink::spi_done(Buffer tx, Buffer rx, int event) {
+    (void)tx;
+    (void)rx;
+    (void)event;
+    // SPI completions already run from the scheduler
+    deliver();
+}
+#endif
+
+} // namespace mbed
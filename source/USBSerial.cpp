@@ -0,0 +1,134 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/USBSerial.h"
+
+#if DEVICE_USB_CDC
+
+#include "mbed-drivers/mbed_critical.h"
+#include "cmsis.h"
+
+namespace mbed {
+
+USBSerial::USBSerial(const char *name) :
+        Stream(name),
+        _usb(),
+        _tx_busy(false) {
+    usb_cdc_init(&_usb, (&USBSerial::_irq_handler), (uint32_t)this);
+}
+
+USBSerial::~USBSerial() {
+    usb_cdc_free(&_usb);
+}
+
+bool USBSerial::connected() {
+    return usb_cdc_connected(&_usb) != 0;
+}
+
+int USBSerial::readable() {
+    return _rx_buffer.size();
+}
+
+int USBSerial::writeable() {
+    return USBSERIAL_TX_BUFFER_SIZE - _tx_buffer.size();
+}
+
+int USBSerial::_putc(int c) {
+    char ch = c;
+    _write(&ch, 1);
+    return c;
+}
+
+int USBSerial::_getc() {
+    char ch;
+    _read(&ch, 1);
+    return (unsigned char)ch;
+}
+
+ssize_t USBSerial::_write(const void *buffer, size_t length) {
+    const char *data = (const char *)buffer;
+    size_t n = 0;
+    while (true) {
+        if (!connected()) {
+            // nobody is listening: drop the rest
+            return length;
+        }
+        n += _tx_buffer.push_n(data + n, length - n);
+        tx_start();
+        if (n == length) {
+            return length;
+        }
+        // the ring is full: wait for the interrupt to make room, unless we
+        // are blocking it, in which case the rest is dropped
+        if (__get_IPSR() != 0 || __get_PRIMASK() != 0) {
+            return length;
+        }
+        while (_tx_buffer.full() && connected()) {
+        }
+    }
+}
+
+ssize_t USBSerial::_read(void *buffer, size_t length) {
+    if (length == 0) {
+        return 0;
+    }
+    while (_rx_buffer.empty()) {
+    }
+    ssize_t n = _rx_buffer.pop_n((char *)buffer, length);
+    // there may be room for a packet the host was held off with
+    rx_poll();
+    return n;
+}
+
+void USBSerial::tx_start() {
+    CriticalSection lock;
+    if (_tx_busy) {
+        return;
+    }
+    uint32_t n = _tx_buffer.pop_n(_tx_packet, USB_CDC_MAX_PACKET);
+    if (n == 0) {
+        return;
+    }
+    _tx_busy = true;
+    usb_cdc_write(&_usb, _tx_packet, n);
+}
+
+void USBSerial::rx_poll() {
+    CriticalSection lock;
+    while (USBSERIAL_RX_BUFFER_SIZE - _rx_buffer.size() >= USB_CDC_MAX_PACKET) {
+        int n = usb_cdc_read(&_usb, _rx_packet, USB_CDC_MAX_PACKET);
+        if (n <= 0) {
+            return;
+        }
+        _rx_buffer.push_n(_rx_packet, n);
+    }
+}
+
+void USBSerial::_irq_handler(uint32_t id, usb_cdc_event_t event) {
+    USBSerial *handler = (USBSerial*)id;
+    if (event & USB_CDC_EVENT_TX_READY) {
+        handler->_tx_busy = false;
+    }
+    if (event & USB_CDC_EVENT_RX_READY) {
+        handler->rx_poll();
+    }
+    // on any event, including a terminal opening the port, send what is
+    // queued
+    handler->tx_start();
+}
+
+} // namespace mbed
+
+#endif
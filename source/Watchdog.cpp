@@ -0,0 +1,137 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/Watchdog.h"
+
+#if DEVICE_WATCHDOG
+
+#include "watchdog_api.h"
+#include "mbed-drivers/TimerEvent.h"
+#include "mbed-drivers/mbed_sleep.h"
+#include "mbed-drivers/mbed_critical.h"
+#if DEVICE_LOWPOWERTIMER
+#include "lp_ticker_api.h"
+#define WATCHDOG_TICKER get_lp_ticker_data()
+#else
+#include "us_ticker_api.h"
+#define WATCHDOG_TICKER get_us_ticker_data()
+#endif
+
+namespace mbed {
+
+namespace {
+
+volatile uint32_t flags_taken = 0;
+volatile uint32_t flags_set = 0;
+volatile uint32_t miss_count = 0;
+
+// the one timer event that services the watchdog when the idle loop does not
+class WatchdogEvent : public TimerEvent {
+public:
+    WatchdogEvent() : TimerEvent(WATCHDOG_TICKER), _period_us(0) {
+    }
+
+    void start(timestamp_t period_us) {
+        _period_us = period_us;
+        queue();
+    }
+
+protected:
+    void queue() {
+        insert(ticker_read(_ticker_data) + _period_us, _period_us / 2);
+    }
+
+    virtual void handler() {
+        // the idle loop services far more often, so only count misses here
+        if (!Watchdog::service()) {
+            miss_count++;
+        }
+        queue();
+    }
+
+    timestamp_t _period_us;
+};
+
+WatchdogEvent event;
+
+void idle_service() {
+    Watchdog::service();
+}
+
+} // namespace
+
+int Watchdog::start(uint32_t timeout_ms) {
+    if (timeout_ms < 4 || watchdog_init(timeout_ms) != 0) {
+        return -1;
+    }
+    watchdog_kick();
+    sleep_manager_set_idle_hook(&idle_service);
+    event.start(timeout_ms * 500);
+    return 0;
+}
+
+int Watchdog::add() {
+    uint32_t state = mbed_critical_enter();
+    for (int flag = 0; flag < MAX_FLAGS; flag++) {
+        if (!(flags_taken & (1UL << flag))) {
+            flags_taken |= 1UL << flag;
+            flags_set |= 1UL << flag;
+            mbed_critical_exit(state);
+            return flag;
+        }
+    }
+    mbed_critical_exit(state);
+    return -1;
+}
+
+void Watchdog::remove(int flag) {
+    if (flag < 0 || flag >= MAX_FLAGS) {
+        return;
+    }
+    uint32_t state = mbed_critical_enter();
+    flags_taken &= ~(1UL << flag);
+    flags_set &= ~(1UL << flag);
+    mbed_critical_exit(state);
+}
+
+void Watchdog::alive(int flag) {
+    if (flag < 0 || flag >= MAX_FLAGS) {
+        return;
+    }
+    uint32_t state = mbed_critical_enter();
+    flags_set |= 1UL << flag;
+    mbed_critical_exit(state);
+}
+
+bool Watchdog::service() {
+    uint32_t state = mbed_critical_enter();
+    bool kick = (flags_set & flags_taken) == flags_taken;
+    if (kick) {
+        flags_set = 0;
+    }
+    mbed_critical_exit(state);
+    if (kick) {
+        watchdog_kick();
+    }
+    return kick;
+}
+
+uint32_t Watchdog::misses() {
+    return miss_count;
+}
+
+} // namespace mbed
+
+#endif
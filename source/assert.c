@@ -22,10 +22,13 @@
 
 #include <stdlib.h>
 #include "mbed-drivers/mbed_interface.h"
+#include "mbed-drivers/mbed_printf.h"
 
 void mbed_assert_internal(const char *expr, const char *file, int line)
 {
-#if DEVICE_STDIO_MESSAGES
+#if DEVICE_STDIO_MESSAGES && MBED_MINIMAL_STDIO
+    mbed_dprintf(2, "mbed assertation failed: %s, file: %s, line %d \n", expr, file, line);
+#elif DEVICE_STDIO_MESSAGES
     fprintf(stderr, "mbed assertation failed: %s, file: %s, line %d \n", expr, file, line);
 #endif
     mbed_die();
@@ -18,15 +18,27 @@
 #include "device.h"
 #include "compiler-polyfill/attributes.h"
 #include "mbed-drivers/mbed_error.h"
+#include "mbed-drivers/mbed_debug.h"
+#include "mbed-drivers/mbed_fault.h"
+#include "mbed-drivers/mbed_printf.h"
 #if DEVICE_STDIO_MESSAGES
 #include <stdio.h>
 #endif
 
 __weak void error(const char* format, ...) {
-#if DEVICE_STDIO_MESSAGES
+#if MBED_COMPACT_ERRORS
+    (void)format;
+    MBED_ERROR_COMPACT(MBED_FAULT_CODE_ERROR);
+#elif DEVICE_STDIO_MESSAGES
     va_list arg;
     va_start(arg, format);
+#if MBED_TRACE_TOKENIZED
+    mbed_trace_vtokenized(format, arg);
+#elif MBED_MINIMAL_STDIO
+    mbed_vdprintf(2, format, arg);
+#else
     vfprintf(stderr, format, arg);
+#endif
     va_end(arg);
 #endif
     exit(1);
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 #include "mbed-drivers/mbed_interface.h"
+#include "mbed-drivers/mbed_fault.h"
+#include "mbed-drivers/mbed_printf.h"
 #if DEVICE_STDIO_MESSAGES
 #include <stdio.h>
 #endif
@@ -25,12 +27,16 @@ void mbed_exit(int return_code) {
 void exit(int return_code) {
 #endif
 
-#if DEVICE_STDIO_MESSAGES
+/* With MBED_MINIMAL_STDIO, the drivers' output is never held in a FILE */
+#if DEVICE_STDIO_MESSAGES && !MBED_MINIMAL_STDIO
     fflush(stdout);
     fflush(stderr);
 #endif
 
     if (return_code) {
+#if MBED_CRASH_DUMP
+        mbed_crash_dump_exit(return_code, MBED_FAULT_CURRENT_LR());
+#endif
         mbed_die();
     }
 
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 #include "gpio_api.h"
+#include "cmsis.h"
+#include "compiler-polyfill/attributes.h"
 
 static inline void _gpio_init_in(gpio_t* gpio, PinName pin, PinMode mode)
 {
@@ -59,3 +61,14 @@ void gpio_init_inout(gpio_t* gpio, PinName pin, PinDirection direction, PinMode
         _gpio_init_out(gpio, pin, mode, value);
     }
 }
+
+/* Ports with a toggle register should replace this with a single write */
+__weak void gpio_toggle(gpio_t *obj) {
+    // the read and the write must not be split by an interrupt writing the pin
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    gpio_write(obj, !gpio_read(obj));
+    if (!primask) {
+        __enable_irq();
+    }
+}
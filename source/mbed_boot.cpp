@@ -0,0 +1,61 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed_interface.h"
+#include "mbed-drivers/CycleTimer.h"
+
+#if MBED_BOOT_TIMING
+
+namespace {
+
+// boot_times[i] is valid if bit i of boot_marked is set; this is in .bss,
+// so it may be marked before static constructors have run
+uint32_t boot_times[MBED_BOOT_PHASES];
+uint32_t boot_marked;
+uint32_t boot_first;
+
+} // namespace
+
+extern "C" void mbed_boot_mark(mbed_boot_phase_t phase) {
+    if (phase >= MBED_BOOT_PHASES || (boot_marked & (1u << phase))) {
+        return;
+    }
+    if (!boot_marked) {
+        mbed::CycleTimer::enable();
+        boot_first = phase;
+    }
+    boot_times[phase] = mbed::CycleTimer::now();
+    boot_marked |= 1u << phase;
+}
+
+extern "C" int mbed_boot_time_us(mbed_boot_phase_t phase) {
+    if (phase >= MBED_BOOT_PHASES || !(boot_marked & (1u << phase))) {
+        return -1;
+    }
+    return mbed::CycleTimer::to_us(boot_times[phase] - boot_times[boot_first]);
+}
+
+#else
+
+extern "C" void mbed_boot_mark(mbed_boot_phase_t phase) {
+    (void)phase;
+}
+
+extern "C" int mbed_boot_time_us(mbed_boot_phase_t phase) {
+    (void)phase;
+    return -1;
+}
+
+#endif
@@ -0,0 +1,162 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stddef.h>
+#include "device.h"
+#include "cmsis.h"
+#include "mbed-drivers/mbed_fault.h"
+#include "mbed-drivers/mbed_interface.h"
+#include "mbed-drivers/mbed_debug.h"
+#if DEVICE_SERIAL
+#include "serial_api.h"
+#endif
+
+MBED_NOINIT(static mbed_fault_record_t fault_record);
+
+#if DEVICE_SERIAL
+extern int stdio_uart_inited;
+extern serial_t stdio_uart;
+
+static void fault_put_hex(uint32_t value) {
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        serial_putc(&stdio_uart, "0123456789ABCDEF"[(value >> shift) & 0xF]);
+    }
+}
+#endif
+
+void mbed_error_compact_internal(uint32_t code, uint32_t pc, uint32_t lr, uint32_t file_id, uint32_t line) {
+    fault_record.code = code;
+    fault_record.pc = pc;
+    fault_record.lr = lr;
+    fault_record.file_id = file_id;
+    fault_record.line = line;
+    fault_record.magic = MBED_FAULT_RECORD_MAGIC;
+
+#if DEVICE_SERIAL
+    if (!stdio_uart_inited) {
+        serial_init(&stdio_uart, STDIO_UART_TX, STDIO_UART_RX);
+    }
+    serial_putc(&stdio_uart, '\r');
+    serial_putc(&stdio_uart, '\n');
+    serial_putc(&stdio_uart, '!');
+    serial_putc(&stdio_uart, 'E');
+    const uint32_t *words = &fault_record.code;
+    for (int i = 0; i < 5; i++) {
+        if (i) {
+            serial_putc(&stdio_uart, ':');
+        }
+        fault_put_hex(words[i]);
+    }
+    serial_putc(&stdio_uart, '\r');
+    serial_putc(&stdio_uart, '\n');
+#endif
+    mbed_die();
+}
+
+const mbed_fault_record_t *mbed_fault_record(void) {
+    return fault_record.magic == MBED_FAULT_RECORD_MAGIC ? &fault_record : NULL;
+}
+
+void mbed_fault_record_clear(void) {
+    fault_record.magic = 0;
+}
+
+MBED_NOINIT(static mbed_crash_dump_t crash_dump);
+
+static uint32_t crash_stack_top(void) {
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3)
+    // the initial MSP in the vector table
+    return *(const uint32_t *)SCB->VTOR;
+#else
+    return *(const uint32_t *)0;
+#endif
+}
+
+static void crash_dump_save(uint32_t sp) {
+    uint32_t top = crash_stack_top();
+    uint32_t n = 0;
+    // a stack outside the main stack (a thread's) has no known top
+    if (sp < top && ((sp & 3) == 0)) {
+        n = (top - sp) / 4;
+    }
+    if (n > MBED_CRASH_DUMP_STACK_WORDS) {
+        n = MBED_CRASH_DUMP_STACK_WORDS;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        crash_dump.stack[i] = ((const uint32_t *)sp)[i];
+    }
+    crash_dump.stack_words = n;
+    crash_dump.sp = sp;
+    crash_dump.trace_words = mbed_log_snapshot(crash_dump.trace, MBED_CRASH_DUMP_TRACE_WORDS);
+    crash_dump.magic = MBED_CRASH_DUMP_MAGIC;
+    __DSB();
+    NVIC_SystemReset();
+    while (1);
+}
+
+void mbed_crash_dump_fault(const uint32_t *frame) {
+    __disable_irq();
+    crash_dump.reason = MBED_CRASH_REASON_FAULT;
+    crash_dump.status = __get_IPSR();
+    crash_dump.r0 = frame[0];
+    crash_dump.r1 = frame[1];
+    crash_dump.r2 = frame[2];
+    crash_dump.r3 = frame[3];
+    crash_dump.r12 = frame[4];
+    crash_dump.lr = frame[5];
+    crash_dump.pc = frame[6];
+    crash_dump.xpsr = frame[7];
+    // the frame is 8 words, plus one of padding if bit 9 of the xPSR is set
+    crash_dump_save((uint32_t)(frame + 8 + ((frame[7] >> 9) & 1)));
+}
+
+void mbed_crash_dump_exit(int status, uint32_t lr) {
+    __disable_irq();
+    crash_dump.reason = MBED_CRASH_REASON_EXIT;
+    crash_dump.status = (uint32_t)status;
+    crash_dump.r0 = crash_dump.r1 = crash_dump.r2 = crash_dump.r3 = crash_dump.r12 = 0;
+    crash_dump.lr = lr;
+    crash_dump.pc = 0;
+    crash_dump.xpsr = 0;
+    crash_dump_save(__get_MSP());
+}
+
+const mbed_crash_dump_t *mbed_crash_dump(void) {
+    return crash_dump.magic == MBED_CRASH_DUMP_MAGIC ? &crash_dump : NULL;
+}
+
+void mbed_crash_dump_clear(void) {
+    crash_dump.magic = 0;
+}
+
+#if MBED_CRASH_DUMP && defined(__GNUC__) && !defined(__ARMCC_VERSION)
+/* Pass the stacked frame (on the MSP or PSP, as bit 2 of EXC_RETURN says)
+ * to mbed_crash_dump_fault(). Thumb-1 only, so it also runs on Cortex-M0. */
+__attribute__((naked)) void HardFault_Handler(void) {
+    __asm volatile (
+        "movs r0, #4            \n"
+        "mov r1, lr             \n"
+        "tst r0, r1             \n"
+        "beq 1f                 \n"
+        "mrs r0, psp            \n"
+        "b 2f                   \n"
+        "1:                     \n"
+        "mrs r0, msp            \n"
+        "2:                     \n"
+        "ldr r1, =mbed_crash_dump_fault \n"
+        "bx r1                  \n"
+    );
+}
+#endif
@@ -0,0 +1,138 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed_debug.h"
+#include "minar/minar.h"
+#include "cmsis.h"
+#include <cstdio>
+#include <cstdarg>
+#include "mbed-drivers/mbed_printf.h"
+
+#if DEVICE_STDIO_MESSAGES
+
+typedef char mbed_log_queue_size_must_be_a_power_of_two[
+        ((MBED_LOG_QUEUE_SIZE & (MBED_LOG_QUEUE_SIZE - 1)) == 0 && MBED_LOG_QUEUE_SIZE > 0) ? 1 : -1];
+
+namespace {
+
+struct log_entry_t {
+    const char *format;
+    uint32_t args[MBED_LOG_MAX_ARGS];
+    uint8_t count;
+    volatile bool ready;    // set once the entry is filled in
+};
+
+log_entry_t log_queue[MBED_LOG_QUEUE_SIZE];
+volatile uint32_t log_head = 0;     // the next entry to reserve
+volatile uint32_t log_tail = 0;     // the next entry to print
+volatile bool log_posted = false;
+volatile uint32_t log_dropped = 0;
+
+void log_drain(void) {
+    log_posted = false;
+    __DMB();
+    while (log_tail != log_head) {
+        log_entry_t &e = log_queue[log_tail & (MBED_LOG_QUEUE_SIZE - 1)];
+        if (!e.ready) {
+            // still being filled in by an interrupted writer
+            break;
+        }
+        __DMB();
+        const uint32_t *a = e.args;
+#if MBED_TRACE_TOKENIZED
+        mbed_trace_frame(e.format, a, e.count);
+#elif MBED_MINIMAL_STDIO
+        mbed_dprintf(2, e.format, a[0], a[1], a[2], a[3], a[4], a[5]);
+#else
+        std::fprintf(stderr, e.format, a[0], a[1], a[2], a[3], a[4], a[5]);
+#endif
+        e.ready = false;
+        __DMB();
+        log_tail++;
+    }
+}
+
+} // namespace
+
+typedef char mbed_log_print_takes_six_args[MBED_LOG_MAX_ARGS <= 6 ? 1 : -1];
+
+extern "C" void mbed_log_deferred(int level, const char *format, ...) {
+    (void)level;
+    // reserve an entry; only the index update needs interrupts off
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t head = log_head;
+    bool full = head - log_tail >= MBED_LOG_QUEUE_SIZE;
+    if (!full) {
+        log_head = head + 1;
+    } else {
+        log_dropped++;
+    }
+    if (!primask) {
+        __enable_irq();
+    }
+    if (full) {
+        return;
+    }
+
+    log_entry_t &e = log_queue[head & (MBED_LOG_QUEUE_SIZE - 1)];
+    e.format = format;
+    int count = mbed_format_arg_words(format);
+    if (count > MBED_LOG_MAX_ARGS) {
+        count = MBED_LOG_MAX_ARGS;
+    }
+    e.count = count;
+    va_list args;
+    va_start(args, format);
+    for (int i = 0; i < MBED_LOG_MAX_ARGS; i++) {
+        e.args[i] = i < count ? va_arg(args, uint32_t) : 0;
+    }
+    va_end(args);
+    __DMB();
+    e.ready = true;
+
+    if (!log_posted) {
+        log_posted = true;
+        minar::Scheduler::postCallback(&log_drain);
+    }
+}
+
+extern "C" void mbed_log_flush(void) {
+    log_drain();
+}
+
+extern "C" uint32_t mbed_log_dropped(void) {
+    return log_dropped;
+}
+
+extern "C" uint32_t mbed_log_snapshot(uint32_t *buffer, uint32_t words) {
+    uint32_t n = 0;
+    for (uint32_t i = log_tail; i != log_head; i++) {
+        const log_entry_t &e = log_queue[i & (MBED_LOG_QUEUE_SIZE - 1)];
+        if (!e.ready) {
+            continue;
+        }
+        if (words - n < 1 + MBED_LOG_MAX_ARGS) {
+            break;
+        }
+        buffer[n++] = (uint32_t)e.format;
+        for (int j = 0; j < MBED_LOG_MAX_ARGS; j++) {
+            buffer[n++] = e.args[j];
+        }
+    }
+    return n;
+}
+
+#endif
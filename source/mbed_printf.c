@@ -0,0 +1,372 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed_printf.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* How much formatted output is collected before it is sent on */
+#ifndef MBED_PRINTF_CHUNK
+#define MBED_PRINTF_CHUNK 32
+#endif
+
+#define FLAG_LEFT   0x01
+#define FLAG_ZERO   0x02
+#define FLAG_PLUS   0x04
+#define FLAG_SPACE  0x08
+#define FLAG_ALT    0x10
+
+typedef struct {
+    mbed_printf_out_t out;
+    void *context;
+    char chunk[MBED_PRINTF_CHUNK];
+    unsigned int used;
+    int count;
+} printf_state_t;
+
+static void flush(printf_state_t *s) {
+    if (s->used) {
+        s->out(s->context, s->chunk, s->used);
+        s->used = 0;
+    }
+}
+
+static void emit(printf_state_t *s, char c) {
+    s->chunk[s->used++] = c;
+    s->count++;
+    if (s->used == sizeof(s->chunk)) {
+        flush(s);
+    }
+}
+
+static void emit_repeat(printf_state_t *s, char c, int n) {
+    while (n-- > 0) {
+        emit(s, c);
+    }
+}
+
+static void emit_string(printf_state_t *s, const char *str, int length) {
+    while (length-- > 0) {
+        emit(s, *str++);
+    }
+}
+
+/* A field of a prefix, such as a sign or 0x, leading zeros and the body,
+ * padded with spaces to width */
+static void emit_field(printf_state_t *s, int flags, int width, const char *prefix, int zeros,
+                       const char *body, int length) {
+    int prefix_length = strlen(prefix);
+    int pad = width - prefix_length - zeros - length;
+    if (!(flags & FLAG_LEFT)) {
+        emit_repeat(s, ' ', pad);
+    }
+    emit_string(s, prefix, prefix_length);
+    emit_repeat(s, '0', zeros);
+    emit_string(s, body, length);
+    if (flags & FLAG_LEFT) {
+        emit_repeat(s, ' ', pad);
+    }
+}
+
+static void emit_integer(printf_state_t *s, int flags, int width, int precision,
+                         const char *prefix, unsigned long long value, unsigned int base, int upper) {
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char buffer[24];
+    char *end = buffer + sizeof(buffer);
+    char *p = end;
+    // 32-bit division is much cheaper than 64-bit where the value allows it
+    while (value > 0xFFFFFFFFu) {
+        *--p = digits[value % base];
+        value /= base;
+    }
+    uint32_t low = (uint32_t)value;
+    while (low) {
+        *--p = digits[low % base];
+        low /= base;
+    }
+    int length = end - p;
+    int zeros = 0;
+    if (precision >= 0) {
+        zeros = precision - length;
+    } else if (length == 0) {
+        zeros = 1;
+    }
+    if (base == 8 && (flags & FLAG_ALT) && zeros <= 0 && (length == 0 || *p != '0')) {
+        zeros = 1;
+    }
+    if (zeros < 0) {
+        zeros = 0;
+    }
+    if ((flags & FLAG_ZERO) && !(flags & FLAG_LEFT) && precision < 0) {
+        int fill = width - (int)strlen(prefix) - length;
+        if (fill > zeros) {
+            zeros = fill;
+        }
+    }
+    emit_field(s, flags, width, prefix, zeros, p, length);
+}
+
+int mbed_vxprintf(mbed_printf_out_t out, void *context, const char *format, va_list arg) {
+    printf_state_t s;
+    s.out = out;
+    s.context = context;
+    s.used = 0;
+    s.count = 0;
+
+    while (*format) {
+        if (*format != '%') {
+            emit(&s, *format++);
+            continue;
+        }
+        format++;
+
+        int flags = 0;
+        for (;; format++) {
+            if (*format == '-') {
+                flags |= FLAG_LEFT;
+            } else if (*format == '0') {
+                flags |= FLAG_ZERO;
+            } else if (*format == '+') {
+                flags |= FLAG_PLUS;
+            } else if (*format == ' ') {
+                flags |= FLAG_SPACE;
+            } else if (*format == '#') {
+                flags |= FLAG_ALT;
+            } else {
+                break;
+            }
+        }
+
+        int width = 0;
+        if (*format == '*') {
+            format++;
+            width = va_arg(arg, int);
+            if (width < 0) {
+                flags |= FLAG_LEFT;
+                width = -width;
+            }
+        } else {
+            while (*format >= '0' && *format <= '9') {
+                width = width * 10 + (*format++ - '0');
+            }
+        }
+
+        int precision = -1;
+        if (*format == '.') {
+            format++;
+            precision = 0;
+            if (*format == '*') {
+                format++;
+                precision = va_arg(arg, int);
+            } else {
+                while (*format >= '0' && *format <= '9') {
+                    precision = precision * 10 + (*format++ - '0');
+                }
+            }
+        }
+
+        // the number of longs: 0 for int, 1 for long, 2 for long long and
+        // 3 for long double; -1 and -2 are short and char, promoted to int
+        int longs = 0;
+        switch (*format) {
+            case 'h':
+                format++;
+                longs = -1;
+                if (*format == 'h') {
+                    format++;
+                    longs = -2;
+                }
+                break;
+            case 'l':
+                format++;
+                longs = 1;
+                if (*format == 'l') {
+                    format++;
+                    longs = 2;
+                }
+                break;
+            case 'j':
+                format++;
+                longs = sizeof(intmax_t) > sizeof(long) ? 2 : 1;
+                break;
+            case 'z':
+            case 't':
+                format++;
+                longs = sizeof(size_t) > sizeof(int) ? 1 : 0;
+                break;
+            case 'L':
+                format++;
+                longs = 3;
+                break;
+            default:
+                break;
+        }
+
+        char conversion = *format;
+        if (conversion == '\0') {
+            break;
+        }
+        format++;
+
+        switch (conversion) {
+            case 'd':
+            case 'i': {
+                long long value;
+                if (longs >= 2) {
+                    value = va_arg(arg, long long);
+                } else if (longs == 1) {
+                    value = va_arg(arg, long);
+                } else {
+                    value = va_arg(arg, int);
+                    if (longs == -1) {
+                        value = (short)value;
+                    } else if (longs == -2) {
+                        value = (signed char)value;
+                    }
+                }
+                const char *sign = "";
+                unsigned long long magnitude = value;
+                if (value < 0) {
+                    sign = "-";
+                    magnitude = -magnitude;
+                } else if (flags & FLAG_PLUS) {
+                    sign = "+";
+                } else if (flags & FLAG_SPACE) {
+                    sign = " ";
+                }
+                emit_integer(&s, flags, width, precision, sign, magnitude, 10, 0);
+                break;
+            }
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X': {
+                unsigned long long value;
+                if (longs >= 2) {
+                    value = va_arg(arg, unsigned long long);
+                } else if (longs == 1) {
+                    value = va_arg(arg, unsigned long);
+                } else {
+                    value = va_arg(arg, unsigned int);
+                    if (longs == -1) {
+                        value = (unsigned short)value;
+                    } else if (longs == -2) {
+                        value = (unsigned char)value;
+                    }
+                }
+                unsigned int base = conversion == 'u' ? 10 : (conversion == 'o' ? 8 : 16);
+                const char *prefix = "";
+                if (base == 16 && (flags & FLAG_ALT) && value != 0) {
+                    prefix = conversion == 'X' ? "0X" : "0x";
+                }
+                emit_integer(&s, flags, width, precision, prefix, value, base, conversion == 'X');
+                break;
+            }
+            case 'p':
+                emit_integer(&s, flags, width, precision, "0x",
+                             (uintptr_t)va_arg(arg, void *), 16, 0);
+                break;
+            case 'c': {
+                char c = (char)va_arg(arg, int);
+                emit_field(&s, flags, width, "", 0, &c, 1);
+                break;
+            }
+            case 's': {
+                const char *str = va_arg(arg, const char *);
+                if (str == NULL) {
+                    str = "(null)";
+                }
+                int length = 0;
+                while (str[length] && (precision < 0 || length < precision)) {
+                    length++;
+                }
+                emit_field(&s, flags, width, "", 0, str, length);
+                break;
+            }
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (longs == 3) {
+                    (void)va_arg(arg, long double);
+                } else {
+                    (void)va_arg(arg, double);
+                }
+                emit_field(&s, flags, width, "", 0, "?", 1);
+                break;
+            case 'n':
+                *va_arg(arg, int *) = s.count;
+                break;
+            default:
+                // %% and conversions it does not know are written as they are
+                emit(&s, conversion);
+                break;
+        }
+    }
+    flush(&s);
+    return s.count;
+}
+
+static void fd_out(void *context, const char *data, size_t length) {
+    mbed_fd_write(*(int *)context, data, length);
+}
+
+int mbed_vdprintf(int fd, const char *format, va_list arg) {
+    return mbed_vxprintf(fd_out, &fd, format, arg);
+}
+
+int mbed_dprintf(int fd, const char *format, ...) {
+    va_list arg;
+    va_start(arg, format);
+    int r = mbed_vdprintf(fd, format, arg);
+    va_end(arg);
+    return r;
+}
+
+#if MBED_MINIMAL_STDIO && defined(__GNUC__) && !defined(__ARMCC_VERSION)
+/* Replace newlib's FILE based versions; GCC also turns printf calls with
+ * simple formats into puts and putchar */
+#undef putchar
+
+int vprintf(const char *format, va_list arg) {
+    return mbed_vdprintf(1, format, arg);
+}
+
+int printf(const char *format, ...) {
+    va_list arg;
+    va_start(arg, format);
+    int r = mbed_vdprintf(1, format, arg);
+    va_end(arg);
+    return r;
+}
+
+int puts(const char *str) {
+    size_t length = strlen(str);
+    if (mbed_fd_write(1, str, length) != (int)length || mbed_fd_write(1, "\n", 1) != 1) {
+        return EOF;
+    }
+    return 0;
+}
+
+int putchar(int c) {
+    unsigned char ch = (unsigned char)c;
+    return mbed_fd_write(1, &ch, 1) == 1 ? ch : EOF;
+}
+#endif
@@ -0,0 +1,65 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed_sleep.h"
+#include "mbed-drivers/mbed_assert.h"
+#include "sleep_api.h"
+#include "cmsis.h"
+
+#include <stddef.h>
+
+static volatile uint16_t deep_sleep_locks = 0;
+static void (*idle_hook)(void) = NULL;
+
+void sleep_manager_lock_deep_sleep(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    MBED_ASSERT(deep_sleep_locks < 0xFFFF);
+    deep_sleep_locks++;
+    if (!primask) {
+        __enable_irq();
+    }
+}
+
+void sleep_manager_unlock_deep_sleep(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    MBED_ASSERT(deep_sleep_locks > 0);
+    deep_sleep_locks--;
+    if (!primask) {
+        __enable_irq();
+    }
+}
+
+int sleep_manager_can_deep_sleep(void) {
+    return deep_sleep_locks == 0;
+}
+
+void sleep_manager_set_idle_hook(void (*hook)(void)) {
+    idle_hook = hook;
+}
+
+void sleep_manager_sleep_auto(void) {
+    if (idle_hook != NULL) {
+        idle_hook();
+    }
+#if DEVICE_SLEEP
+    if (deep_sleep_locks == 0) {
+        deepsleep();
+    } else {
+        sleep();
+    }
+#endif
+}
@@ -0,0 +1,87 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stddef.h>
+#include "cmsis.h"
+#include "mbed-drivers/mbed_interface.h"
+#if defined(TOOLCHAIN_GCC) && !defined(__ARMCC_VERSION)
+#include <malloc.h>
+#endif
+
+#if MBED_STACK_STATS
+
+/* Don't paint the words just below the SP, which the painting function
+ * itself may be using */
+#define STACK_PAINT_MARGIN 64
+
+#if defined(__ARMCC_VERSION)
+extern uint32_t Image$$ARM_LIB_STACK$$ZI$$Base[];
+extern uint32_t Image$$ARM_LIB_STACK$$ZI$$Limit[];
+#define STACK_BOTTOM Image$$ARM_LIB_STACK$$ZI$$Base
+#define STACK_TOP    Image$$ARM_LIB_STACK$$ZI$$Limit
+#elif defined(__ICCARM__)
+#pragma section="CSTACK"
+#define STACK_BOTTOM ((uint32_t *)__section_begin("CSTACK"))
+#define STACK_TOP    ((uint32_t *)__section_end("CSTACK"))
+#else
+extern uint32_t __StackLimit[];
+extern uint32_t __StackTop[];
+#define STACK_BOTTOM __StackLimit
+#define STACK_TOP    __StackTop
+#endif
+
+void mbed_stack_paint(void) {
+    uint32_t *end = (uint32_t *)((__get_MSP() - STACK_PAINT_MARGIN) & ~3u);
+    for (uint32_t *p = STACK_BOTTOM; p < end; p++) {
+        *p = MBED_STACK_PAINT;
+    }
+}
+
+int mbed_stack_stats(mbed_stack_stats_t *stats) {
+    const uint32_t *p = STACK_BOTTOM;
+    while (p < STACK_TOP && *p == MBED_STACK_PAINT) {
+        p++;
+    }
+    stats->size = (uint32_t)((const char *)STACK_TOP - (const char *)STACK_BOTTOM);
+    stats->max_used = (uint32_t)((const char *)STACK_TOP - (const char *)p);
+    return 0;
+}
+
+#else
+
+void mbed_stack_paint(void) {
+}
+
+int mbed_stack_stats(mbed_stack_stats_t *stats) {
+    (void)stats;
+    return -1;
+}
+
+#endif
+
+int mbed_heap_stats(mbed_heap_stats_t *stats) {
+#if defined(TOOLCHAIN_GCC) && !defined(__ARMCC_VERSION)
+    struct mallinfo info = mallinfo();
+    stats->used = info.uordblks;
+    stats->free = info.fordblks;
+    // newlib never gives memory back, so its arena is the peak
+    stats->peak = info.arena;
+    stats->free_blocks = info.ordblks;
+    return 0;
+#else
+    (void)stats;
+    return -1;
+#endif
+}
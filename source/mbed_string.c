@@ -0,0 +1,154 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "cmsis.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Replace the C library's memcpy, memset and strlen, which are byte at a
+ * time in newlib-nano, with versions that move a word at a time, and four
+ * words per loop so the compiler can use LDM and STM. They are linked in
+ * ahead of the library's, so they also serve the library itself. */
+#ifndef MBED_STRING_OVERRIDE
+#define MBED_STRING_OVERRIDE 0
+#endif
+
+#if MBED_STRING_OVERRIDE
+
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__CC_ARM)
+/* Without this, GCC can turn the loops below back into calls to
+ * themselves */
+#define STRING_NO_BUILTIN __attribute__((optimize("no-tree-loop-distribute-patterns")))
+#else
+#define STRING_NO_BUILTIN
+#endif
+
+/* Cortex-M3 and above can load a word from any address, so a source that
+ * can't be word aligned along with the destination is still read a word
+ * at a time */
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3)
+#define STRING_UNALIGNED_LOAD 1
+typedef struct __attribute__((packed, __may_alias__)) {
+    uint32_t v;
+} string_unaligned_t;
+#else
+#define STRING_UNALIGNED_LOAD 0
+#endif
+
+/* Words are accessed through a type that may alias anything */
+typedef uint32_t __attribute__((__may_alias__)) string_word_t;
+
+#define STRING_WORD_MASK (sizeof(string_word_t) - 1)
+
+STRING_NO_BUILTIN void *memcpy(void *dst, const void *src, size_t n) {
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+
+    if (n >= 16 && (STRING_UNALIGNED_LOAD || (((uintptr_t)d ^ (uintptr_t)s) & STRING_WORD_MASK) == 0)) {
+        while ((uintptr_t)d & STRING_WORD_MASK) {
+            *d++ = *s++;
+            n--;
+        }
+        string_word_t *dw = (string_word_t *)d;
+        if (((uintptr_t)s & STRING_WORD_MASK) == 0) {
+            const string_word_t *sw = (const string_word_t *)s;
+            for (; n >= 16; n -= 16) {
+                uint32_t a = sw[0], b = sw[1], c = sw[2], e = sw[3];
+                dw[0] = a;
+                dw[1] = b;
+                dw[2] = c;
+                dw[3] = e;
+                dw += 4;
+                sw += 4;
+            }
+            for (; n >= 4; n -= 4) {
+                *dw++ = *sw++;
+            }
+            s = (const uint8_t *)sw;
+        }
+#if STRING_UNALIGNED_LOAD
+        else {
+            const string_unaligned_t *sw = (const string_unaligned_t *)s;
+            for (; n >= 4; n -= 4) {
+                *dw++ = (sw++)->v;
+            }
+            s = (const uint8_t *)sw;
+        }
+#endif
+        d = (uint8_t *)dw;
+    }
+    while (n--) {
+        *d++ = *s++;
+    }
+    return dst;
+}
+
+STRING_NO_BUILTIN void *memset(void *dst, int c, size_t n) {
+    uint8_t *d = (uint8_t *)dst;
+    uint8_t byte = (uint8_t)c;
+
+    if (n >= 16) {
+        while ((uintptr_t)d & STRING_WORD_MASK) {
+            *d++ = byte;
+            n--;
+        }
+        uint32_t word = byte * 0x01010101UL;
+        string_word_t *dw = (string_word_t *)d;
+        for (; n >= 16; n -= 16) {
+            dw[0] = word;
+            dw[1] = word;
+            dw[2] = word;
+            dw[3] = word;
+            dw += 4;
+        }
+        for (; n >= 4; n -= 4) {
+            *dw++ = word;
+        }
+        d = (uint8_t *)dw;
+    }
+    while (n--) {
+        *d++ = byte;
+    }
+    return dst;
+}
+
+STRING_NO_BUILTIN size_t strlen(const char *str) {
+    const char *p = str;
+
+    while ((uintptr_t)p & STRING_WORD_MASK) {
+        if (*p == '\0') {
+            return p - str;
+        }
+        p++;
+    }
+    /* An aligned word never crosses into another page or region, so the
+     * bytes read past the terminator are always readable */
+    const string_word_t *w = (const string_word_t *)p;
+    for (;;) {
+        uint32_t v = *w;
+        if ((v - 0x01010101UL) & ~v & 0x80808080UL) {
+            break;
+        }
+        w++;
+    }
+    p = (const char *)w;
+    while (*p) {
+        p++;
+    }
+    return p - str;
+}
+
+#endif
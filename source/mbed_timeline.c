@@ -0,0 +1,93 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed_timeline.h"
+
+#if MBED_TIMELINE
+
+#include "cmsis.h"
+#include "us_ticker_api.h"
+#include "mbed-drivers/mbed_critical.h"
+
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3)
+#define TIMELINE_DWT 1
+#else
+#define TIMELINE_DWT 0
+#endif
+
+static mbed_timeline_record_t timeline[MBED_TIMELINE_SIZE];
+static uint32_t timeline_count;     // records written, ever
+static volatile int timeline_on;
+
+static inline uint32_t timeline_now(void) {
+#if TIMELINE_DWT
+    return DWT->CYCCNT;
+#else
+    return us_ticker_read();
+#endif
+}
+
+void mbed_timeline_start(void) {
+#if TIMELINE_DWT
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+#endif
+    uint32_t state = mbed_critical_enter();
+    timeline_count = 0;
+    timeline_on = 1;
+    mbed_critical_exit(state);
+}
+
+void mbed_timeline_stop(void) {
+    timeline_on = 0;
+}
+
+void mbed_timeline_record(uint32_t event, uint32_t arg) {
+    if (!timeline_on) {
+        return;
+    }
+    uint32_t state = mbed_critical_enter();
+    mbed_timeline_record_t *record = &timeline[timeline_count & (MBED_TIMELINE_SIZE - 1)];
+    record->time = timeline_now();
+    record->event = event;
+    record->arg = arg;
+    timeline_count++;
+    mbed_critical_exit(state);
+}
+
+void mbed_timeline_dump(FILE *out) {
+    int on = timeline_on;
+    timeline_on = 0;
+    uint32_t first = 0;
+    if (timeline_count > MBED_TIMELINE_SIZE) {
+        first = timeline_count - MBED_TIMELINE_SIZE;
+    }
+#if TIMELINE_DWT
+    uint32_t ticks_per_second = SystemCoreClock;
+#else
+    uint32_t ticks_per_second = 1000000;
+#endif
+    fprintf(out, "timeline %lu %lu\r\n", (unsigned long)ticks_per_second, (unsigned long)first);
+    for (uint32_t i = first; i != timeline_count; i++) {
+        const mbed_timeline_record_t *record = &timeline[i & (MBED_TIMELINE_SIZE - 1)];
+        fprintf(out, "%08lx %lx %08lx\r\n",
+                (unsigned long)record->time, (unsigned long)record->event, (unsigned long)record->arg);
+    }
+    timeline_on = on;
+}
+
+#endif
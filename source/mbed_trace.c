@@ -0,0 +1,94 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "mbed-drivers/mbed_debug.h"
+#include "mbed-drivers/mbed_printf.h"
+
+#if DEVICE_STDIO_MESSAGES
+
+int mbed_format_arg_words(const char *format) {
+    int count = 0;
+    for (const char *p = format; *p != '\0'; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        p++;
+        if (*p == '%') {
+            continue;
+        }
+        // flags, width, precision and length, then the conversion
+        while (*p != '\0' && strchr("-+ #0123456789.*hljztL", *p) != NULL) {
+            if (*p == '*') {
+                count++;
+            }
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+/* A frame is MBED_TRACE_FRAME_START, the number of argument words, the
+ * format string's address and then the argument words, all little-endian,
+ * and finally the low byte of the sum of the bytes after the start byte.
+ * scripts/mbed_trace_decode.py turns the frames back into text. */
+void mbed_trace_frame(const char *format, const uint32_t *args, int count) {
+    uint8_t frame[2 + 4 * (1 + MBED_LOG_MAX_ARGS) + 1];
+    uint32_t words[1 + MBED_LOG_MAX_ARGS];
+    uint8_t sum = 0;
+    int length = 0;
+
+    if (count > MBED_LOG_MAX_ARGS) {
+        count = MBED_LOG_MAX_ARGS;
+    }
+    words[0] = (uint32_t)format;
+    memcpy(&words[1], args, count * sizeof(uint32_t));
+
+    frame[length++] = MBED_TRACE_FRAME_START;
+    frame[length++] = (uint8_t)count;
+    for (int i = 0; i <= count; i++) {
+        frame[length++] = (uint8_t)words[i];
+        frame[length++] = (uint8_t)(words[i] >> 8);
+        frame[length++] = (uint8_t)(words[i] >> 16);
+        frame[length++] = (uint8_t)(words[i] >> 24);
+    }
+    for (int i = 1; i < length; i++) {
+        sum += frame[i];
+    }
+    frame[length++] = sum;
+#if MBED_MINIMAL_STDIO
+    mbed_fd_write(2, frame, length);
+#else
+    fwrite(frame, 1, length, stderr);
+#endif
+}
+
+void mbed_trace_vtokenized(const char *format, va_list args) {
+    uint32_t words[MBED_LOG_MAX_ARGS];
+    int count = mbed_format_arg_words(format);
+    if (count > MBED_LOG_MAX_ARGS) {
+        count = MBED_LOG_MAX_ARGS;
+    }
+    for (int i = 0; i < count; i++) {
+        words[i] = va_arg(args, uint32_t);
+    }
+    mbed_trace_frame(format, words, count);
+}
+
+#endif
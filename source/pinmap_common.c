@@ -15,21 +15,89 @@
  */
 #include "pinmap.h"
 #include "mbed-drivers/mbed_error.h"
+#include "mbed-drivers/mbed_fault.h"
+#include "cmsis.h"
+#include <stddef.h>
 
-void pinmap_pinout(PinName pin, const PinMap *map) {
-    if (pin == NC)
-        return;
+/* Every lookup scans a PinMap until it finds the pin. With
+ * PINMAP_CACHE_SIZE (a power of two) set, the entries found are kept in a
+ * direct-mapped cache keyed by the map and the pin, so looking the same pin
+ * up again, as drivers that are created and destroyed repeatedly do, takes
+ * constant time. The maps are const tables, so the entries never go stale.
+ */
+/* With compact errors, a bad pin is reported by a fault record rather than a
+ * message, so the messages are not kept in the image */
+#if MBED_COMPACT_ERRORS
+#define PINMAP_ERROR(message) MBED_ERROR_COMPACT(MBED_FAULT_CODE_PINMAP)
+#else
+#define PINMAP_ERROR(message) error(message)
+#endif
 
+#ifndef PINMAP_CACHE_SIZE
+#define PINMAP_CACHE_SIZE 0
+#endif
+
+#if PINMAP_CACHE_SIZE
+typedef char pinmap_cache_size_must_be_a_power_of_two[(PINMAP_CACHE_SIZE & (PINMAP_CACHE_SIZE - 1)) == 0 ? 1 : -1];
+
+static struct {
+    const PinMap *map;
+    const PinMap *entry;
+} pinmap_cache[PINMAP_CACHE_SIZE];
+
+static uint32_t pinmap_cache_index(PinName pin, const PinMap *map) {
+    uint32_t key = (uint32_t)pin ^ ((uint32_t)map >> 2);
+    return (key ^ (key >> 8)) & (PINMAP_CACHE_SIZE - 1);
+}
+#endif
+
+static const PinMap *pinmap_find(PinName pin, const PinMap *map) {
+#if PINMAP_CACHE_SIZE
+    uint32_t index = pinmap_cache_index(pin, map);
+    const PinMap *entry = NULL;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (pinmap_cache[index].map == map && pinmap_cache[index].entry->pin == pin) {
+        entry = pinmap_cache[index].entry;
+    }
+    if (!primask) {
+        __enable_irq();
+    }
+    if (entry != NULL) {
+        return entry;
+    }
+    const PinMap *start = map;
+#endif
     while (map->pin != NC) {
         if (map->pin == pin) {
-            pin_function(pin, map->function);
-
-            pin_mode(pin, PullNone);
-            return;
+#if PINMAP_CACHE_SIZE
+            primask = __get_PRIMASK();
+            __disable_irq();
+            pinmap_cache[index].map = start;
+            pinmap_cache[index].entry = map;
+            if (!primask) {
+                __enable_irq();
+            }
+#endif
+            return map;
         }
         map++;
     }
-    error("could not pinout");
+    return NULL;
+}
+
+void pinmap_pinout(PinName pin, const PinMap *map) {
+    if (pin == NC)
+        return;
+
+    const PinMap *entry = pinmap_find(pin, map);
+    if (entry != NULL) {
+        pin_function(pin, entry->function);
+
+        pin_mode(pin, PullNone);
+        return;
+    }
+    PINMAP_ERROR("could not pinout");
 }
 
 uint32_t pinmap_merge(uint32_t a, uint32_t b) {
@@ -44,17 +112,13 @@ uint32_t pinmap_merge(uint32_t a, uint32_t b) {
         return a;
 
     // mis-match error case
-    error("pinmap mis-match");
+    PINMAP_ERROR("pinmap mis-match");
     return (uint32_t)NC;
 }
 
 uint32_t pinmap_find_peripheral(PinName pin, const PinMap* map) {
-    while (map->pin != NC) {
-        if (map->pin == pin)
-            return map->peripheral;
-        map++;
-    }
-    return (uint32_t)NC;
+    const PinMap *entry = pinmap_find(pin, map);
+    return entry ? (uint32_t)entry->peripheral : (uint32_t)NC;
 }
 
 uint32_t pinmap_peripheral(PinName pin, const PinMap* map) {
@@ -64,17 +128,13 @@ uint32_t pinmap_peripheral(PinName pin, const PinMap* map) {
         return (uint32_t)NC;
     peripheral = pinmap_find_peripheral(pin, map);
     if ((uint32_t)NC == peripheral) // no mapping available
-        error("pinmap not found for peripheral");
+        PINMAP_ERROR("pinmap not found for peripheral");
     return peripheral;
 }
 
 uint32_t pinmap_find_function(PinName pin, const PinMap* map) {
-    while (map->pin != NC) {
-        if (map->pin == pin)
-            return map->function;
-        map++;
-    }
-    return (uint32_t)NC;
+    const PinMap *entry = pinmap_find(pin, map);
+    return entry ? (uint32_t)entry->function : (uint32_t)NC;
 }
 
 uint32_t pinmap_function(PinName pin, const PinMap* map) {
@@ -84,6 +144,6 @@ uint32_t pinmap_function(PinName pin, const PinMap* map) {
         return (uint32_t)NC;
     function = pinmap_find_function(pin, map);
     if ((uint32_t)NC == function) // no mapping available
-        error("pinmap not found for function");
+        PINMAP_ERROR("pinmap not found for function");
     return function;
 }
@@ -0,0 +1,77 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "port_api.h"
+#include "compiler-polyfill/attributes.h"
+#include "cmsis.h"
+
+#if DEVICE_PORTIN || DEVICE_PORTOUT || DEVICE_PORTINOUT
+
+/* The number of ports searched by the default port_pin_lookup */
+#ifndef PORT_LOOKUP_COUNT
+#define PORT_LOOKUP_COUNT 8
+#endif
+
+/* The default searches the pins port_pin() gives for the ports numbered
+ * from 0, which suits the usual arithmetic PinName encodings. Ports whose
+ * PortName values are not numbered that way, or which can work the port
+ * out of the PinName directly, should replace it. */
+__weak int port_pin_lookup(PinName pin, PortName *port, int *bit) {
+    for (int p = 0; p < PORT_LOOKUP_COUNT; p++) {
+        for (int n = 0; n < 32; n++) {
+            if (port_pin((PortName)p, n) == pin) {
+                *port = (PortName)p;
+                *bit = n;
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+#endif
+
+#if DEVICE_PORTOUT || DEVICE_PORTINOUT
+
+/* Ports with set, clear or toggle registers should replace these with a
+ * single write; the defaults read-modify-write with interrupts disabled. */
+static void port_update_bits(port_t *obj, int clear, int toggle) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    port_write(obj, (port_read(obj) & ~clear) ^ toggle);
+    if (!primask) {
+        __enable_irq();
+    }
+}
+
+__weak void port_set_bits(port_t *obj, int bits) {
+    port_update_bits(obj, bits, bits);
+}
+
+__weak void port_clear_bits(port_t *obj, int bits) {
+    port_update_bits(obj, bits, 0);
+}
+
+__weak void port_toggle_bits(port_t *obj, int bits) {
+    port_update_bits(obj, 0, bits);
+}
+
+/* Ports with a BSRR-style register, setting and clearing in one write,
+ * should replace this with that write. */
+__weak void port_set_clear_bits(port_t *obj, int set, int clear) {
+    port_update_bits(obj, set | clear, set);
+}
+
+#endif
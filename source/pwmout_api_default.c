@@ -0,0 +1,32 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2013 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "pwmout_api.h"
+#include "compiler-polyfill/attributes.h"
+
+#if DEVICE_PWMOUT
+
+/* These defaults go through the float API. Ports should replace them with
+ * versions that scale the duty cycle into the compare register with integer
+ * arithmetic, which is the point of using them on parts without an FPU. */
+__weak void pwmout_write_u16(pwmout_t *obj, uint16_t value) {
+    pwmout_write(obj, value / 65535.0f);
+}
+
+__weak uint16_t pwmout_read_u16(pwmout_t *obj) {
+    return (uint16_t)(pwmout_read(obj) * 65535.0f + 0.5f);
+}
+
+#endif
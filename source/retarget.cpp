@@ -17,6 +17,9 @@
 #include "mbed-drivers/FileHandle.h"
 #include "mbed-drivers/FileSystemLike.h"
 #include "mbed-drivers/FilePath.h"
+#include "mbed-drivers/mbed_fault.h"
+#include "mbed-drivers/mbed_interface.h"
+#include "mbed-drivers/mbed_printf.h"
 #include "serial_api.h"
 #include "compiler-polyfill/attributes.h"
 #include "cmsis.h"
@@ -25,6 +28,11 @@
 #include "minar/minar.h"
 #include "mbed-hal/init_api.h"
 #include "core_generic.h"
+#include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/SPSCCircularBuffer.h"
+#include "mbed-drivers/dma_cache.h"
+#include "mbed-drivers/DeferredInit.h"
+#include <stdlib.h>
 
 #if defined(__ARMCC_VERSION)
 #   include <rt_sys.h>
@@ -50,6 +58,30 @@
 #   define PREFIX(x)    x
 #endif
 
+/* The number of files that can be open at once, besides stdin, stdout and
+ * stderr. Each costs two words of RAM, and five more with
+ * RETARGET_STREAM_BUFFER. */
+#ifndef RETARGET_OPEN_MAX
+#define RETARGET_OPEN_MAX OPEN_MAX
+#endif
+
+/* When RETARGET_STREAM_BUFFER is set, each file opened on a file system
+ * that reports a block size in fstat() gets a buffer of that size, up to
+ * RETARGET_STREAM_BUFFER bytes, taken from the heap when it is opened.
+ * Reads fill it a block at a time, and writes collect in it until it is
+ * full or the file is read, seeked, examined or closed. Transfers of a
+ * whole buffer or more go straight to the file. Only newlib has fstat().
+ */
+#ifndef RETARGET_STREAM_BUFFER
+#define RETARGET_STREAM_BUFFER 0
+#endif
+
+#if RETARGET_STREAM_BUFFER && !defined(__ARMCC_VERSION) && !defined(__ICCARM__)
+#define RETARGET_BUFFERED 1
+#else
+#define RETARGET_BUFFERED 0
+#endif
+
 #ifndef pid_t
  typedef int pid_t;
 #endif
@@ -76,22 +108,213 @@ extern const char __stderr_name[] = "/stderr";
  * put it in a filehandles array and return the index into that array
  * (or rather index+3, as filehandles 0-2 are stdin/out/err).
  */
-static FileHandle *filehandles[OPEN_MAX];
+static FileHandle *filehandles[RETARGET_OPEN_MAX];
+
+/* The free slots are a list linked through filehandle_links, and the slots
+ * from filehandle_unused up have never been used, so no initialisation is
+ * needed. The slots of an open FileHandle are listed the same way, starting
+ * from its _fh_slot, so closing and destroying need no search of the table.
+ */
+static int filehandle_links[RETARGET_OPEN_MAX];
+static int filehandle_free = -1;
+static int filehandle_unused = 0;
+
+#if RETARGET_BUFFERED
+typedef struct {
+    unsigned char *data;    // NULL for a descriptor with no buffer
+    unsigned int size;
+    unsigned int start;     // the next byte read ahead to return
+    unsigned int end;       // the end of the bytes read ahead or written behind
+    bool writing;           // whether the bytes are written behind, rather than read ahead
+} filehandle_buffer_t;
+
+static filehandle_buffer_t filehandle_buffers[RETARGET_OPEN_MAX];
+
+static void filehandle_buffer_init(int fh_i, FileHandle *fhc) {
+    filehandle_buffer_t *b = &filehandle_buffers[fh_i];
+    struct stat st;
+    memset(b, 0, sizeof(*b));
+    if (fhc->fstat(&st) != 0 || st.st_blksize <= 0 || S_ISCHR(st.st_mode)) {
+        return;
+    }
+    unsigned int size = (st.st_blksize < RETARGET_STREAM_BUFFER) ? st.st_blksize : RETARGET_STREAM_BUFFER;
+    b->data = (unsigned char *)malloc(size);
+    if (b->data != NULL) {
+        b->size = size;
+    }
+}
+
+/* Write out what was written behind, or drop what was read ahead and move
+ * the file back to where the reader is */
+static int filehandle_buffer_flush(filehandle_buffer_t *b, FileHandle *fhc) {
+    int res = 0;
+    if (b->writing) {
+        unsigned int done = 0;
+        while (done < b->end) {
+            ssize_t n = fhc->write(b->data + done, b->end - done);
+            if (n <= 0) {
+                res = -1;
+                break;
+            }
+            done += n;
+        }
+    } else if (b->start != b->end) {
+        if (fhc->lseek(-(off_t)(b->end - b->start), SEEK_CUR) < 0) {
+            res = -1;
+        }
+    }
+    b->start = b->end = 0;
+    b->writing = false;
+    return res;
+}
+
+static ssize_t filehandle_buffer_read(filehandle_buffer_t *b, FileHandle *fhc, unsigned char *buffer, unsigned int length) {
+    if (b->writing && filehandle_buffer_flush(b, fhc) < 0) {
+        return -1;
+    }
+    if (b->start == b->end) {
+        if (length >= b->size) {
+            return fhc->read(buffer, length);
+        }
+        ssize_t n = fhc->read(b->data, b->size);
+        if (n <= 0) {
+            return n;
+        }
+        b->start = 0;
+        b->end = n;
+    }
+    unsigned int count = b->end - b->start;
+    if (count > length) {
+        count = length;
+    }
+    memcpy(buffer, b->data + b->start, count);
+    b->start += count;
+    return count;
+}
+
+static ssize_t filehandle_buffer_write(filehandle_buffer_t *b, FileHandle *fhc, const unsigned char *buffer, unsigned int length) {
+    if (!b->writing || b->end + length > b->size) {
+        if (filehandle_buffer_flush(b, fhc) < 0) {
+            return -1;
+        }
+    }
+    if (length >= b->size) {
+        return fhc->write(buffer, length);
+    }
+    memcpy(b->data + b->end, buffer, length);
+    b->end += length;
+    b->writing = true;
+    return length;
+}
+
+static off_t filehandle_buffer_lseek(filehandle_buffer_t *b, FileHandle *fhc, off_t offset, int whence) {
+    // ftell() asks for the position without moving, so keep the buffer for it
+    if (whence == SEEK_CUR && offset == 0) {
+        off_t pos = fhc->lseek(0, SEEK_CUR);
+        if (pos < 0) {
+            return pos;
+        }
+        return b->writing ? pos + b->end : pos - (b->end - b->start);
+    }
+    if (filehandle_buffer_flush(b, fhc) < 0) {
+        return -1;
+    }
+    return fhc->lseek(offset, whence);
+}
+#endif
+
+static int filehandle_alloc(FileHandle *fhc) {
+    mbed::util::CriticalSectionLock lock;
+    int fh_i;
+    if (filehandle_free >= 0) {
+        fh_i = filehandle_free;
+        filehandle_free = filehandle_links[fh_i];
+    } else if (filehandle_unused < RETARGET_OPEN_MAX) {
+        fh_i = filehandle_unused++;
+    } else {
+        return -1;
+    }
+    filehandles[fh_i] = fhc;
+    filehandle_links[fh_i] = fhc->_fh_slot;
+    fhc->_fh_slot = fh_i;
+    return fh_i;
+}
+
+static void filehandle_release(int fh_i) {
+#if RETARGET_BUFFERED
+    // whatever was written behind has been flushed, or the file is gone
+    free(filehandle_buffers[fh_i].data);
+    filehandle_buffers[fh_i].data = NULL;
+#endif
+    mbed::util::CriticalSectionLock lock;
+    FileHandle *fhc = filehandles[fh_i];
+    // unlink the slot from the FileHandle's list; it is usually the only one
+    int *link = &fhc->_fh_slot;
+    while (*link != fh_i) {
+        link = &filehandle_links[*link];
+    }
+    *link = filehandle_links[fh_i];
+    filehandles[fh_i] = NULL;
+    filehandle_links[fh_i] = filehandle_free;
+    filehandle_free = fh_i;
+}
+
+static FileHandle *filehandle_get(FILEHANDLE fh) {
+    if (fh < 3 || fh - 3 >= RETARGET_OPEN_MAX) {
+        return NULL;
+    }
+    return filehandles[fh - 3];
+}
 
 FileHandle::~FileHandle() {
     /* Remove all open filehandles for this */
-    for (unsigned int fh_i = 0; fh_i < sizeof(filehandles)/sizeof(*filehandles); fh_i++) {
-        if (filehandles[fh_i] == this) {
-            filehandles[fh_i] = NULL;
-        }
+    while (_fh_slot >= 0) {
+        filehandle_release(_fh_slot);
     }
 }
 
+int FileHandle::write_async(const void *buffer, size_t length, const async_callback_t &callback) {
+    ssize_t n = write(buffer, length);
+    if (callback) {
+        minar::Scheduler::postCallback(async_callback_t(callback).bind(n));
+    }
+    return 0;
+}
+
+int FileHandle::read_async(void *buffer, size_t length, const async_callback_t &callback) {
+    ssize_t n = read(buffer, length);
+    if (callback) {
+        minar::Scheduler::postCallback(async_callback_t(callback).bind(n));
+    }
+    return 0;
+}
+
+int FileHandle::fsync_async(const async_callback_t &callback) {
+    ssize_t n = fsync();
+    if (callback) {
+        minar::Scheduler::postCallback(async_callback_t(callback).bind(n));
+    }
+    return 0;
+}
+
 #if DEVICE_SERIAL
 extern int stdio_uart_inited;
 extern serial_t stdio_uart;
 #endif
 
+/* With STDIO_LAZY_INIT set, opening stdin, stdout and stderr leaves the
+ * UART alone, and it is only initialised by the first read or write. Boots
+ * that never print, such as a quick check after waking from deep sleep by
+ * reset, then don't pay for it. Buffered stdin still starts on open.
+ */
+#ifndef STDIO_LAZY_INIT
+#define STDIO_LAZY_INIT 0
+#endif
+
+/* Set by mbed::set_stdio(), to replace the UART for each of descriptors 0
+ * to 2 */
+static FileHandle *stdio_handles[3];
+
 static void init_serial() {
 #if DEVICE_SERIAL
     if (stdio_uart_inited) return;
@@ -99,6 +322,159 @@ static void init_serial() {
 #endif
 }
 
+/* With STDIO_TX_BUFFER_SIZE set, writes to stdout are queued in a ring of
+ * that many bytes (a power of two) and sent in the background, so printf
+ * does not wait for the wire. The ring is drained with serial_tx_asynch
+ * where the target supports it, and from the TX interrupt otherwise. A
+ * write only waits when the ring is full. stderr stays unbuffered, so error
+ * messages get out even if interrupts are disabled straight after.
+ */
+#ifndef STDIO_TX_BUFFER_SIZE
+#define STDIO_TX_BUFFER_SIZE 0
+#endif
+
+#if DEVICE_SERIAL && STDIO_TX_BUFFER_SIZE
+typedef char stdio_tx_buffer_size_must_be_a_power_of_two[(STDIO_TX_BUFFER_SIZE & (STDIO_TX_BUFFER_SIZE - 1)) == 0 ? 1 : -1];
+
+static char stdio_tx_buffer[STDIO_TX_BUFFER_SIZE];
+static volatile uint32_t stdio_tx_head;     // bytes queued, ever
+static volatile uint32_t stdio_tx_tail;     // bytes sent, ever
+
+#if DEVICE_SERIAL_ASYNCH
+static volatile uint32_t stdio_tx_sending;  // bytes in the transfer in progress
+
+static void stdio_tx_start();
+
+static void stdio_tx_irq(void) {
+    int event = serial_irq_handler_asynch(&stdio_uart);
+    if (event & SERIAL_EVENT_TX_MASK) {
+        stdio_tx_tail += stdio_tx_sending;
+        stdio_tx_sending = 0;
+        stdio_tx_start();
+    }
+}
+
+// called with interrupts disabled
+static void stdio_tx_start() {
+    if (stdio_tx_sending || stdio_tx_head == stdio_tx_tail) {
+        return;
+    }
+    // send up to the end of the ring, the rest follows in the next transfer
+    uint32_t offset = stdio_tx_tail & (STDIO_TX_BUFFER_SIZE - 1);
+    uint32_t length = stdio_tx_head - stdio_tx_tail;
+    if (length > STDIO_TX_BUFFER_SIZE - offset) {
+        length = STDIO_TX_BUFFER_SIZE - offset;
+    }
+    stdio_tx_sending = length;
+    dma_cache_clean(stdio_tx_buffer + offset, length);
+    serial_tx_asynch(&stdio_uart, stdio_tx_buffer + offset, length, 0, (uint32_t)&stdio_tx_irq,
+                     SERIAL_EVENT_TX_COMPLETE, DMA_USAGE_OPPORTUNISTIC);
+}
+#else
+static void stdio_tx_irq(void) {
+    while (stdio_tx_head != stdio_tx_tail && serial_writable(&stdio_uart)) {
+        serial_putc(&stdio_uart, stdio_tx_buffer[stdio_tx_tail & (STDIO_TX_BUFFER_SIZE - 1)]);
+        stdio_tx_tail++;
+    }
+    if (stdio_tx_head == stdio_tx_tail) {
+        serial_irq_set(&stdio_uart, TxIrq, 0);
+    }
+}
+
+// called with interrupts disabled
+static void stdio_tx_start() {
+    if (stdio_tx_head != stdio_tx_tail) {
+        serial_irq_set(&stdio_uart, TxIrq, 1);
+    }
+}
+#endif
+
+static void stdio_irq_init();
+
+static void stdio_tx_write(const unsigned char *buffer, unsigned int length) {
+    stdio_irq_init();
+    unsigned int i = 0;
+    while (true) {
+        {
+            mbed::util::CriticalSectionLock lock;
+            while (i < length && stdio_tx_head - stdio_tx_tail < STDIO_TX_BUFFER_SIZE) {
+                stdio_tx_buffer[stdio_tx_head & (STDIO_TX_BUFFER_SIZE - 1)] = buffer[i++];
+                stdio_tx_head++;
+            }
+            stdio_tx_start();
+        }
+        if (i == length) {
+            return;
+        }
+        // the ring is full: wait for the interrupt to make room, unless we
+        // are blocking it, in which case the rest of the output is dropped
+        if (__get_IPSR() != 0 || __get_PRIMASK() != 0) {
+            return;
+        }
+        while (stdio_tx_head - stdio_tx_tail == STDIO_TX_BUFFER_SIZE) {
+        }
+    }
+}
+#endif
+
+/* With STDIO_RX_BUFFER_SIZE set, bytes received on stdin are moved into a
+ * ring of that many bytes (a power of two) from the RX interrupt, and a
+ * read returns all the bytes already received, up to the length asked for.
+ * It only waits while the ring is empty.
+ */
+#ifndef STDIO_RX_BUFFER_SIZE
+#define STDIO_RX_BUFFER_SIZE 0
+#endif
+
+#if DEVICE_SERIAL && STDIO_RX_BUFFER_SIZE
+static SPSCCircularBuffer<unsigned char, STDIO_RX_BUFFER_SIZE> stdio_rx_buffer;
+
+static void stdio_rx_irq(void) {
+    while (serial_readable(&stdio_uart)) {
+        // bytes received while the ring is full are dropped
+        stdio_rx_buffer.push((unsigned char)serial_getc(&stdio_uart));
+    }
+}
+
+static void stdio_irq_init();
+
+static int stdio_rx_read(unsigned char *buffer, unsigned int length) {
+    stdio_irq_init();
+    while (stdio_rx_buffer.empty()) {
+    }
+    return stdio_rx_buffer.pop_n(buffer, length);
+}
+#endif
+
+#if DEVICE_SERIAL && (STDIO_TX_BUFFER_SIZE || STDIO_RX_BUFFER_SIZE)
+static void stdio_irq_handler(uint32_t id, SerialIrq irq_type) {
+    (void)id;
+#if STDIO_TX_BUFFER_SIZE && !DEVICE_SERIAL_ASYNCH
+    if (irq_type == TxIrq) {
+        stdio_tx_irq();
+    }
+#endif
+#if STDIO_RX_BUFFER_SIZE
+    if (irq_type == RxIrq) {
+        stdio_rx_irq();
+    }
+#endif
+}
+
+static void stdio_irq_init() {
+    static bool inited = false;
+    mbed::util::CriticalSectionLock lock;
+    if (inited) {
+        return;
+    }
+    serial_irq_handler(&stdio_uart, stdio_irq_handler, 0);
+#if STDIO_RX_BUFFER_SIZE
+    serial_irq_set(&stdio_uart, RxIrq, 1);
+#endif
+    inited = true;
+}
+#endif
+
 static inline int openmode_to_posix(int openmode) {
     int posix = openmode;
 #ifdef __ARMCC_VERSION
@@ -143,23 +519,30 @@ extern "C" FILEHANDLE PREFIX(_open)(const char* name, int openmode) {
     /* Use the posix convention that stdin,out,err are filehandles 0,1,2.
      */
     if (std::strcmp(name, __stdin_name) == 0) {
-        init_serial();
+        if (stdio_handles[0] == NULL) {
+#if DEVICE_SERIAL && STDIO_RX_BUFFER_SIZE
+            init_serial();
+            // start buffering before the first read
+            stdio_irq_init();
+#elif !STDIO_LAZY_INIT
+            init_serial();
+#endif
+        }
         return 0;
     } else if (std::strcmp(name, __stdout_name) == 0) {
-        init_serial();
+#if !STDIO_LAZY_INIT
+        if (stdio_handles[1] == NULL) init_serial();
+#endif
         return 1;
     } else if (std::strcmp(name, __stderr_name) == 0) {
-        init_serial();
+#if !STDIO_LAZY_INIT
+        if (stdio_handles[2] == NULL) init_serial();
+#endif
         return 2;
     }
     #endif
 
-    // find the first empty slot in filehandles
-    unsigned int fh_i;
-    for (fh_i = 0; fh_i < sizeof(filehandles)/sizeof(*filehandles); fh_i++) {
-        if (filehandles[fh_i] == NULL) break;
-    }
-    if (fh_i >= sizeof(filehandles)/sizeof(*filehandles)) {
+    if (filehandle_free < 0 && filehandle_unused >= RETARGET_OPEN_MAX) {
         return -1;
     }
 
@@ -167,9 +550,7 @@ extern "C" FILEHANDLE PREFIX(_open)(const char* name, int openmode) {
 
     /* FILENAME: ":0x12345678" describes a FileLike* */
     if (name[0] == ':') {
-        void *p;
-        sscanf(name, ":%p", &p);
-        res = (FileHandle*)p;
+        res = (FileHandle*)std::strtoul(name + 1, NULL, 16);
 
     /* FILENAME: "/file_system/file_name" */
     } else {
@@ -188,19 +569,80 @@ extern "C" FILEHANDLE PREFIX(_open)(const char* name, int openmode) {
     }
 
     if (res == NULL) return -1;
-    filehandles[fh_i] = res;
+    int fh_i = filehandle_alloc(res);
+    if (fh_i < 0) return -1;
+#if RETARGET_BUFFERED
+    filehandle_buffer_init(fh_i, res);
+#endif
 
     return fh_i + 3; // +3 as filehandles 0-2 are stdin/out/err
 }
 
+namespace mbed {
+
+std::FILE *fdopen(FileHandle *fh, const char *mode) {
+#if defined(__ARMCC_VERSION) || defined(__ICCARM__)
+    /* These libraries can only open a stream by name */
+    char buf[12]; /* :0x12345678 + null byte */
+    std::sprintf(buf, ":%p", fh);
+    return std::fopen(buf, mode);
+#else
+    int fh_i = filehandle_alloc(fh);
+    if (fh_i < 0) return NULL;
+#if RETARGET_BUFFERED
+    filehandle_buffer_init(fh_i, fh);
+#endif
+    std::FILE *stream = ::fdopen(fh_i + 3, mode);
+    if (stream == NULL) {
+        filehandle_release(fh_i);
+    }
+    return stream;
+#endif
+}
+
+void set_stdio(FileHandle *fh) {
+    stdio_handles[0] = stdio_handles[1] = stdio_handles[2] = fh;
+}
+
+int set_stdio(int fd, FileHandle *fh) {
+    if (fd < 0 || fd > 2) {
+        return -1;
+    }
+    stdio_handles[fd] = fh;
+    return 0;
+}
+
+ssize_t writev(FILEHANDLE fd, const struct iovec *iov, int iovcnt) {
+    FileHandle* fhc = filehandle_get(fd);
+    if (fhc == NULL) return -1;
+
+    return fhc->writev(iov, iovcnt);
+}
+
+ssize_t readv(FILEHANDLE fd, const struct iovec *iov, int iovcnt) {
+    FileHandle* fhc = filehandle_get(fd);
+    if (fhc == NULL) return -1;
+
+    return fhc->readv(iov, iovcnt);
+}
+
+} // namespace mbed
+
 extern "C" int PREFIX(_close)(FILEHANDLE fh) {
     if (fh < 3) return 0;
 
-    FileHandle* fhc = filehandles[fh-3];
-    filehandles[fh-3] = NULL;
+    FileHandle* fhc = filehandle_get(fh);
     if (fhc == NULL) return -1;
+#if RETARGET_BUFFERED
+    int flushed = filehandle_buffer_flush(&filehandle_buffers[fh - 3], fhc);
+    filehandle_release(fh-3);
+    int res = fhc->close();
+    return (flushed < 0) ? -1 : res;
+#else
+    filehandle_release(fh-3);
 
     return fhc->close();
+#endif
 }
 
 #if defined(__ICCARM__)
@@ -210,18 +652,30 @@ extern "C" int PREFIX(_write)(FILEHANDLE fh, const unsigned char *buffer, unsign
 #endif
     (void) mode;
     int n; // n is the number of bytes written
-    if (fh < 3) {
+    if (fh < 3 && stdio_handles[fh] != NULL) {
+        n = stdio_handles[fh]->write(buffer, length);
+    } else if (fh < 3) {
 #if DEVICE_SERIAL
         if (!stdio_uart_inited) init_serial();
+#if STDIO_TX_BUFFER_SIZE
+        if (fh == 1) {
+            stdio_tx_write(buffer, length);
+        } else
+#endif
         for (unsigned int i = 0; i < length; i++) {
             serial_putc(&stdio_uart, buffer[i]);
         }
 #endif
         n = length;
     } else {
-        FileHandle* fhc = filehandles[fh-3];
+        FileHandle* fhc = filehandle_get(fh);
         if (fhc == NULL) return -1;
 
+#if RETARGET_BUFFERED
+        if (filehandle_buffers[fh - 3].data != NULL) {
+            n = filehandle_buffer_write(&filehandle_buffers[fh - 3], fhc, buffer, length);
+        } else
+#endif
         n = fhc->write(buffer, length);
     }
 #ifdef __ARMCC_VERSION
@@ -231,6 +685,19 @@ extern "C" int PREFIX(_write)(FILEHANDLE fh, const unsigned char *buffer, unsign
 #endif
 }
 
+extern "C" int mbed_fd_write(int fd, const void *buffer, size_t length) {
+#if defined(__ICCARM__)
+    return __write(fd, (const unsigned char *)buffer, length);
+#else
+    int r = PREFIX(_write)(fd, (const unsigned char *)buffer, length, 0);
+#ifdef __ARMCC_VERSION
+    return (r < 0) ? r : (int)length - r;
+#else
+    return r;
+#endif
+#endif
+}
+
 #if defined(__ICCARM__)
 extern "C" size_t    __read (int        fh, unsigned char *buffer, size_t       length) {
 #else
@@ -238,17 +705,30 @@ extern "C" int PREFIX(_read)(FILEHANDLE fh, unsigned char *buffer, unsigned int
 #endif
     (void) mode;
     int n; // n is the number of bytes read
-    if (fh < 3) {
-        // only read a character at a time from stdin
+    if (fh < 3 && stdio_handles[fh] != NULL) {
+        n = stdio_handles[fh]->read(buffer, length);
+    } else if (fh < 3) {
 #if DEVICE_SERIAL
         if (!stdio_uart_inited) init_serial();
+#if STDIO_RX_BUFFER_SIZE
+        n = stdio_rx_read(buffer, length);
+#else
+        // only read a character at a time from stdin
         *buffer = serial_getc(&stdio_uart);
+        n = 1;
 #endif
+#else
         n = 1;
+#endif
     } else {
-        FileHandle* fhc = filehandles[fh-3];
+        FileHandle* fhc = filehandle_get(fh);
         if (fhc == NULL) return -1;
 
+#if RETARGET_BUFFERED
+        if (filehandle_buffers[fh - 3].data != NULL) {
+            n = filehandle_buffer_read(&filehandle_buffers[fh - 3], fhc, buffer, length);
+        } else
+#endif
         n = fhc->read(buffer, length);
     }
 #ifdef __ARMCC_VERSION
@@ -267,7 +747,7 @@ extern "C" int _isatty(FILEHANDLE fh)
     /* stdin, stdout and stderr should be tty */
     if (fh < 3) return 1;
 
-    FileHandle* fhc = filehandles[fh-3];
+    FileHandle* fhc = filehandle_get(fh);
     if (fhc == NULL) return -1;
 
     return fhc->isatty();
@@ -284,21 +764,26 @@ int _lseek(FILEHANDLE fh, int offset, int whence)
 {
     if (fh < 3) return 0;
 
-    FileHandle* fhc = filehandles[fh-3];
+    FileHandle* fhc = filehandle_get(fh);
     if (fhc == NULL) return -1;
 
 #if defined(__ARMCC_VERSION)
     return fhc->lseek(position, SEEK_SET);
 #else
+#if RETARGET_BUFFERED
+    if (filehandle_buffers[fh - 3].data != NULL) {
+        return filehandle_buffer_lseek(&filehandle_buffers[fh - 3], fhc, offset, whence);
+    }
+#endif
     return fhc->lseek(offset, whence);
 #endif
 }
 
 #ifdef __ARMCC_VERSION
 extern "C" int PREFIX(_ensure)(FILEHANDLE fh) {
-    if (fh < 3) return 0;
+    if (fh < 3) return stdio_handles[fh] ? stdio_handles[fh]->fsync() : 0;
 
-    FileHandle* fhc = filehandles[fh-3];
+    FileHandle* fhc = filehandle_get(fh);
     if (fhc == NULL) return -1;
 
     return fhc->fsync();
@@ -307,7 +792,7 @@ extern "C" int PREFIX(_ensure)(FILEHANDLE fh) {
 extern "C" long PREFIX(_flen)(FILEHANDLE fh) {
     if (fh < 3) return 0;
 
-    FileHandle* fhc = filehandles[fh-3];
+    FileHandle* fhc = filehandle_get(fh);
     if (fhc == NULL) return -1;
 
     return fhc->flen();
@@ -322,6 +807,17 @@ extern "C" int _fstat(int fd, struct stat *st) {
         return  0;
     }
 
+    FileHandle* fhc = filehandle_get(fd);
+    if (fhc != NULL) {
+#if RETARGET_BUFFERED
+        // the size must include what was written behind
+        if (filehandle_buffers[fd - 3].writing && filehandle_buffer_flush(&filehandle_buffers[fd - 3], fhc) < 0) {
+            return -1;
+        }
+#endif
+        return fhc->fstat(st);
+    }
+
     errno = EBADF;
     return -1;
 }
@@ -381,6 +877,10 @@ extern "C" struct dirent *readdir(DIR *dir) {
     return dir->readdir();
 }
 
+extern "C" int readdir_r(DIR *dir, struct dirent *entry, struct dirent **result) {
+    return dir->readdir_r(entry, result);
+}
+
 extern "C" int closedir(DIR *dir) {
     return dir->closedir();
 }
@@ -429,14 +929,32 @@ extern "C" __weak void __cxa_pure_virtual(void) {
 extern "C" int $Super$$main(void);
 
 extern "C" int $Sub$$main(void) {
+#if MBED_BOOT_TIMING
+    mbed_boot_mark(MBED_BOOT_PHASE_MAIN);
+#endif
+#if MBED_STACK_STATS
+    mbed_stack_paint();
+#endif
     mbed_hal_init();
+#if MBED_BOOT_TIMING
+    mbed_boot_mark(MBED_BOOT_PHASE_HAL_INIT);
+#endif
     return $Super$$main();
 }
 #elif defined(TOOLCHAIN_GCC)  || defined(TARGET_LIKE_CLANG)
 extern "C" int __real_main(void);
 
 extern "C" int __wrap_main(void) {
+#if MBED_BOOT_TIMING
+    mbed_boot_mark(MBED_BOOT_PHASE_MAIN);
+#endif
+#if MBED_STACK_STATS
+    mbed_stack_paint();
+#endif
     mbed_hal_init();
+#if MBED_BOOT_TIMING
+    mbed_boot_mark(MBED_BOOT_PHASE_HAL_INIT);
+#endif
     return __real_main();
 }
 #elif defined(TOOLCHAIN_IAR)
@@ -446,14 +964,40 @@ extern "C" int __wrap_main(void) {
 // code will call a function to setup argc and argv (__iar_argc_argv) if it is defined.
 // Since mbed doesn't use argc/argv, we use this function to call mbed_hal_init.
 extern "C" void __iar_argc_argv() {
+#if MBED_BOOT_TIMING
+    mbed_boot_mark(MBED_BOOT_PHASE_MAIN);
+#endif
+#if MBED_STACK_STATS
+    mbed_stack_paint();
+#endif
     mbed_hal_init();
+#if MBED_BOOT_TIMING
+    mbed_boot_mark(MBED_BOOT_PHASE_HAL_INIT);
+#endif
+}
+#endif
+
+#if MBED_BOOT_TIMING
+static void boot_app_start(int argc, char *argv[]) {
+    mbed_boot_mark(MBED_BOOT_PHASE_APP_START);
+    app_start(argc, argv);
 }
+#define APP_START boot_app_start
+#else
+#define APP_START app_start
 #endif
 
 // the user should set up their application in app_start
 extern "C" int main(void) {
+#if MBED_BOOT_TIMING
+    mbed_boot_mark(MBED_BOOT_PHASE_SCHEDULER);
+#endif
     minar::Scheduler::postCallback(
-        mbed::util::FunctionPointer2<void, int, char**>(&app_start).bind(0, NULL)
+        mbed::util::FunctionPointer2<void, int, char**>(&APP_START).bind(0, NULL)
+    );
+    // the bring-up deferred by drivers and app_start() overlaps from here
+    minar::Scheduler::postCallback(
+        mbed::util::FunctionPointer0<void>(&mbed::DeferredInit::run).bind()
     );
     return minar::Scheduler::start();
 }
@@ -462,6 +1006,9 @@ extern "C" int main(void) {
 
 extern "C" void _exit(int status)
 {
+#if MBED_CRASH_DUMP
+    mbed_crash_dump_exit(status, MBED_FAULT_CURRENT_LR());
+#endif
     (void) status;
     while(1) {
         __BKPT(0);
@@ -18,6 +18,15 @@
 #include <time.h>
 #include "mbed-drivers/rtc_time.h"
 #include "us_ticker_api.h"
+#include "mbed-drivers/ticker_api_ext.h"
+#include "cmsis.h"
+
+/* time_us() anchors the RTC seconds to a us ticker timestamp. The anchor is
+ * dropped by set_time(), so the next call reads the RTC again.
+ */
+static uint64_t anchor_time_us;
+static us_timestamp_t anchor_ticks;
+static uint8_t anchor_valid;
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,11 +59,61 @@ void set_time(time_t t) {
     rtc_init();
     rtc_write(t);
 #endif
+    anchor_valid = 0;
+}
+
+uint64_t time_us(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    us_timestamp_t now = ticker_read_us(get_us_ticker_data());
+    uint64_t t = anchor_time_us + (now - anchor_ticks);
+    if (!anchor_valid || now - anchor_ticks >= (us_timestamp_t)RTC_TIME_RESYNC_S * 1000000) {
+#if DEVICE_RTC
+        // keep the sub-second part while it agrees with the RTC, as
+        // rereading the RTC only tells which second it is
+        uint64_t rtc_us = (uint64_t)time(NULL) * 1000000;
+        if (!anchor_valid || t < rtc_us || t >= rtc_us + 1000000) {
+            t = rtc_us;
+        }
+#else
+        if (!anchor_valid) {
+            t = 0;
+        }
+#endif
+        anchor_time_us = t;
+        anchor_ticks = now;
+        anchor_valid = 1;
+    }
+    if (!primask) {
+        __enable_irq();
+    }
+    return t;
+}
+
+uint64_t monotonic_us(void) {
+    return ticker_read_us(get_us_ticker_data());
+}
+
+int mbed_clock_gettime(mbed_clockid_t clock_id, mbed_timespec_t *tp) {
+    uint64_t t;
+    switch (clock_id) {
+        case MBED_CLOCK_MONOTONIC:
+            t = monotonic_us();
+            break;
+        case MBED_CLOCK_REALTIME:
+            t = time_us();
+            break;
+        default:
+            return -1;
+    }
+    tp->tv_sec = t / 1000000;
+    tp->tv_nsec = (t % 1000000) * 1000;
+    return 0;
 }
 
 clock_t clock() {
-    clock_t t = us_ticker_read();
-    t /= 1000000 / CLOCKS_PER_SEC; // convert to processor time
+    // the 64-bit ticker, so clock() wraps with clock_t rather than the counter
+    clock_t t = monotonic_us() / (1000000 / CLOCKS_PER_SEC); // convert to processor time
     return t;
 }
 
@@ -0,0 +1,78 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/sim_ticker.h"
+
+static uint32_t sim_now;
+static uint32_t sim_compare;
+static int sim_armed;
+static uint32_t sim_interrupts;
+
+static void sim_init(void) {
+}
+
+static void sim_disable_interrupt(void) {
+    sim_armed = 0;
+}
+
+static void sim_clear_interrupt(void) {
+}
+
+static void sim_set_interrupt(timestamp_t timestamp) {
+    sim_compare = timestamp;
+    sim_armed = 1;
+}
+
+static ticker_event_queue_t events;
+
+static const ticker_interface_t sim_interface = {
+    .init = sim_init,
+    .read = sim_ticker_read,
+    .disable_interrupt = sim_disable_interrupt,
+    .clear_interrupt = sim_clear_interrupt,
+    .set_interrupt = sim_set_interrupt,
+};
+
+static const ticker_data_t sim_data = {
+    .interface = &sim_interface,
+    .queue = &events,
+};
+
+const ticker_data_t *get_sim_ticker_data(void) {
+    return &sim_data;
+}
+
+uint32_t sim_ticker_read(void) {
+    return sim_now;
+}
+
+void sim_ticker_advance(uint32_t us) {
+    uint32_t end = sim_now + us;
+    while (sim_armed && (int)(sim_compare - end) <= 0) {
+        // a compare already passed fires at once, without going back
+        if ((int)(sim_compare - sim_now) > 0) {
+            sim_now = sim_compare;
+        }
+        // one shot, as on the hardware: the handler sets the next one
+        sim_armed = 0;
+        sim_interrupts++;
+        ticker_irq_handler(&sim_data);
+    }
+    sim_now = end;
+}
+
+uint32_t sim_ticker_interrupts(void) {
+    return sim_interrupts;
+}
@@ -15,6 +15,7 @@
  */
 
 #include "mbed-drivers/test_env.h"
+#include <stdlib.h>
 
 // Const strings used in test_end
 const char* TEST_ENV_START = "start";
@@ -22,6 +23,8 @@ const char* TEST_ENV_SUCCESS = "success";
 const char* TEST_ENV_FAILURE = "failure";
 const char* TEST_ENV_MEASURE = "measure";
 const char* TEST_ENV_END = "end";
+const char* TEST_ENV_BENCH = "bench";
+const char* TEST_ENV_HISTOGRAM = "histogram";
 
 
 static void led_blink(PinName led, float delay)
@@ -29,7 +32,7 @@ static void led_blink(PinName led, float delay)
     if (led != NC) {
         DigitalOut myled(led);
         while (1) {
-            myled = !myled;
+            myled.toggle();
             wait(delay);
         }
     }
@@ -73,6 +76,23 @@ bool notify_completion_str(bool success, char* buffer)
 }
 
 // Host test auto-detection API
+void notify_footprint()
+{
+    // constructors run between reset and main()
+    if (mbed_boot_time_us(MBED_BOOT_PHASE_RESET) >= 0) {
+        notify_performance_coefficient("footprint_static_init_us", mbed_boot_time_us(MBED_BOOT_PHASE_MAIN));
+    }
+    int boot_us = mbed_boot_time_us(MBED_BOOT_PHASE_APP_START);
+    if (boot_us >= 0) {
+        notify_performance_coefficient("footprint_boot_us", boot_us);
+    }
+    mbed_heap_stats_t heap;
+    if (mbed_heap_stats(&heap) == 0) {
+        notify_performance_coefficient("footprint_heap_used", (unsigned int)heap.used);
+        notify_performance_coefficient("footprint_heap_peak", (unsigned int)heap.peak);
+    }
+}
+
 void notify_host_test_name(const char *host_test) {
     if (host_test) {
         printf("{{host_test_name;%s}}" NL, host_test);
@@ -95,6 +115,50 @@ void notify_test_description(const char *description) {
     }
 }
 
+static int compare_samples(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// The nearest-rank percentile of the sorted samples
+uint32_t BenchmarkReporter::percentile(uint32_t percent) const
+{
+    uint32_t rank = (percent * _count + 99) / 100;
+    return _samples[rank ? rank - 1 : 0];
+}
+
+void BenchmarkReporter::report()
+{
+    uint32_t n = _count;
+    if (n == 0) {
+        printf("{{%s;%s;%s;0;0;0;0;0;%lu}}" RCNL, TEST_ENV_BENCH, _name, _unit, (unsigned long)_dropped);
+        return;
+    }
+    qsort(_samples, n, sizeof(_samples[0]), compare_samples);
+    printf("{{%s;%s;%s;%lu;%lu;%lu;%lu;%lu;%lu}}" RCNL, TEST_ENV_BENCH, _name, _unit,
+           (unsigned long)n, (unsigned long)_samples[0], (unsigned long)percentile(50),
+           (unsigned long)percentile(99), (unsigned long)_samples[n - 1], (unsigned long)_dropped);
+}
+
+void BenchmarkReporter::report_histogram(const uint32_t *edges, uint32_t edge_count) const
+{
+    printf("{{%s;%s;%s", TEST_ENV_HISTOGRAM, _name, _unit);
+    uint32_t n = _count;
+    uint32_t below = 0;     // samples in the bins so far
+    for (uint32_t bin = 0; bin < edge_count; bin++) {
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            if (_samples[i] <= edges[bin]) {
+                count++;
+            }
+        }
+        printf(";%lu:%lu", (unsigned long)edges[bin], (unsigned long)(count - below));
+        below = count;
+    }
+    printf(";+:%lu}}" RCNL, (unsigned long)(n - below));
+}
 
 // -DMBED_BUILD_TIMESTAMP=1406208182.13
 unsigned int testenv_randseed()
@@ -15,59 +15,197 @@
  */
 #include <stddef.h>
 #include "ticker_api.h"
+#include "mbed-drivers/ticker_api_ext.h"
 #include "cmsis.h"
+#include "mbed-drivers/mbed_critical.h"
+#include "mbed-drivers/mbed_error.h"
+#include "mbed-drivers/mbed_timeline.h"
 
-void ticker_set_handler(const ticker_data_t *const data, ticker_event_handler handler) {
-    data->interface->init();
+/* Pending events are kept either in a sorted linked list (the default) or,
+ * when TICKER_QUEUE_PAIRING_HEAP is set, in a pairing heap. In both cases
+ * data->queue->head is the event that expires first.
+ *
+ * The ticker_event_t of mbed-hal 1.0 only has timestamp, id and next. Ports
+ * whose ticker_api.h adds the prev, child and handler fields set
+ * DEVICE_TICKER_EVENT_EXTENDED; events must then start out zeroed. Without
+ * it, the queue is the plain sorted list, removal walks it, and every event
+ * is dispatched to the queue's event_handler.
+ *
+ * With it, ticker_event_t::prev links each queued event, other than the
+ * head, back to its predecessor in the list (or, in the heap, to its left
+ * sibling or its parent). An event that is neither the head nor has a prev
+ * link isn't queued, so removal is O(1) and removing an idle event returns
+ * straight away. The heap also reuses ticker_event_t::next as the sibling
+ * link and ticker_event_t::child for the leftmost child.
+ *
+ * An event whose ticker_event_t::handler is set is dispatched to that
+ * handler; any other is dispatched to the queue's event_handler, as set by
+ * ticker_set_handler.
+ *
+ * Insertion into the list is O(n). The heap inserts in O(1) and removes in
+ * O(log n) amortized, so the time spent with interrupts disabled no longer
+ * grows linearly with the number of pending events.
+ */
+#ifndef TICKER_QUEUE_PAIRING_HEAP
+#define TICKER_QUEUE_PAIRING_HEAP 0
+#endif
 
-    data->queue->event_handler = handler;
+#if TICKER_QUEUE_PAIRING_HEAP && !DEVICE_TICKER_EVENT_EXTENDED
+#error "TICKER_QUEUE_PAIRING_HEAP needs the prev and child links of DEVICE_TICKER_EVENT_EXTENDED"
+#endif
+
+/* With TICKER_BATCHED_DISPATCH set, ticker_irq_handler reads the counter once
+ * per pass over the expired events rather than once per event, and programs
+ * the compare register once, after the last handler has returned. Events
+ * inserted or removed by those handlers don't touch the hardware.
+ */
+#ifndef TICKER_BATCHED_DISPATCH
+#define TICKER_BATCHED_DISPATCH 0
+#endif
+
+/* true if a expires before b */
+static inline int ticker_before(const ticker_event_t *a, const ticker_event_t *b) {
+    return (int)(a->timestamp - b->timestamp) < 0;
 }
 
-void ticker_irq_handler(const ticker_data_t *const data) {
-    data->interface->clear_interrupt();
+#if TICKER_QUEUE_PAIRING_HEAP
 
-    /* Go through all the pending TimerEvents */
-    while (1) {
-        if (data->queue->head == NULL) {
-            // There are no more TimerEvents left, so disable matches.
-            data->interface->disable_interrupt();
-            return;
-        }
+/* Join two heaps, returning the new root. Both arguments must be roots. */
+static ticker_event_t *heap_meld(ticker_event_t *a, ticker_event_t *b) {
+    if (a == NULL) {
+        return b;
+    }
+    if (b == NULL) {
+        return a;
+    }
+    /* events with the same timestamp keep their insertion order */
+    if (ticker_before(b, a)) {
+        ticker_event_t *t = a;
+        a = b;
+        b = t;
+    }
+    /* b becomes the leftmost child of a */
+    b->prev = a;
+    b->next = a->child;
+    if (a->child != NULL) {
+        a->child->prev = b;
+    }
+    a->child = b;
+    return a;
+}
 
-        if ((int)(data->queue->head->timestamp - data->interface->read()) <= 0) {
-            // This event was in the past:
-            //      point to the following one and execute its handler
-            ticker_event_t *p = data->queue->head;
-            data->queue->head = data->queue->head->next;
-            if (data->queue->event_handler != NULL) {
-                (*data->queue->event_handler)(p->id); // NOTE: the handler can set new events
-            }
-            /* Note: We continue back to examining the head because calling the
-             * event handler may have altered the chain of pending events. */
-        } else {
-            // This event and the following ones in the list are in the future:
-            //      set it as next interrupt and return
-            data->interface->set_interrupt(data->queue->head->timestamp);
-            return;
+/* Two-pass pairing of a sibling list, returning the new root */
+static ticker_event_t *heap_merge_pairs(ticker_event_t *first) {
+    ticker_event_t *pairs = NULL;
+
+    if (first == NULL) {
+        return NULL;
+    }
+    /* first pass: meld siblings in pairs from left to right, keeping the
+     * results in a stack linked through next */
+    while (first != NULL) {
+        ticker_event_t *a = first;
+        ticker_event_t *b = a->next;
+        first = (b != NULL) ? b->next : NULL;
+        a->next = a->prev = NULL;
+        if (b != NULL) {
+            b->next = b->prev = NULL;
+            a = heap_meld(a, b);
         }
+        a->next = pairs;
+        pairs = a;
     }
+    /* second pass: meld the pairs from right to left */
+    ticker_event_t *root = pairs;
+    pairs = pairs->next;
+    root->next = NULL;
+    while (pairs != NULL) {
+        ticker_event_t *p = pairs;
+        pairs = pairs->next;
+        p->next = NULL;
+        root = heap_meld(root, p);
+    }
+    return root;
 }
 
-void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, timestamp_t timestamp, uint32_t id) {
-    /* disable interrupts for the duration of the function */
-    __disable_irq();
+static void queue_insert(ticker_event_queue_t *queue, ticker_event_t *obj) {
+    obj->next = obj->prev = obj->child = NULL;
+    queue->head = heap_meld(queue->head, obj);
+}
 
-    // initialise our data
-    obj->timestamp = timestamp;
-    obj->id = id;
+static ticker_event_t *queue_pop(ticker_event_queue_t *queue) {
+    ticker_event_t *p = queue->head;
+    queue->head = heap_merge_pairs(p->child);
+    p->child = NULL;
+    return p;
+}
 
+static void queue_remove(ticker_event_queue_t *queue, ticker_event_t *obj) {
+    if (queue->head == obj) {
+        queue_pop(queue);
+        return;
+    }
+    if (obj->prev == NULL) {
+        // not in the queue
+        return;
+    }
+    /* unlink obj from its parent or left sibling */
+    if (obj->prev->child == obj) {
+        obj->prev->child = obj->next;
+    } else {
+        obj->prev->next = obj->next;
+    }
+    if (obj->next != NULL) {
+        obj->next->prev = obj->prev;
+    }
+    obj->next = obj->prev = NULL;
+    /* and put its children back */
+    queue->head = heap_meld(queue->head, heap_merge_pairs(obj->child));
+    obj->child = NULL;
+}
+
+/* The parent of p, or NULL if p is the root */
+static ticker_event_t *heap_parent(ticker_event_t *p) {
+    while (p->prev != NULL && p->prev->child != p) {
+        p = p->prev;
+    }
+    return p->prev;
+}
+
+/* Find an event due no earlier than from and no more than slack after it.
+ * Children expire after their parents, so subtrees rooted past the window
+ * are skipped. */
+static ticker_event_t *queue_find(ticker_event_queue_t *queue, timestamp_t from, timestamp_t slack) {
+    ticker_event_t *p = queue->head;
+    while (p != NULL) {
+        timestamp_t offset = p->timestamp - from;
+        if ((int)offset >= 0 && offset <= slack) {
+            return p;
+        }
+        if ((int)offset < 0 && p->child != NULL) {
+            p = p->child;
+            continue;
+        }
+        while (p != NULL && p->next == NULL) {
+            p = heap_parent(p);
+        }
+        if (p != NULL) {
+            p = p->next;
+        }
+    }
+    return NULL;
+}
+
+#else
+
+static void queue_insert(ticker_event_queue_t *queue, ticker_event_t *obj) {
     /* Go through the list until we either reach the end, or find
        an element this should come before (which is possibly the
        head). */
-    ticker_event_t *prev = NULL, *p = data->queue->head;
+    ticker_event_t *prev = NULL, *p = queue->head;
     while (p != NULL) {
         /* check if we come before p */
-        if ((int)(timestamp - p->timestamp) < 0) {
+        if (ticker_before(obj, p)) {
             break;
         }
         /* go to the next element */
@@ -76,45 +214,323 @@ void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, t
     }
     /* if prev is NULL we're at the head */
     if (prev == NULL) {
-        data->queue->head = obj;
-        data->interface->set_interrupt(timestamp);
+        queue->head = obj;
     } else {
         prev->next = obj;
     }
     /* if we're at the end p will be NULL, which is correct */
     obj->next = p;
+#if DEVICE_TICKER_EVENT_EXTENDED
+    obj->prev = prev;
+    if (p != NULL) {
+        p->prev = obj;
+    }
+#endif
+}
+
+static ticker_event_t *queue_pop(ticker_event_queue_t *queue) {
+    ticker_event_t *p = queue->head;
+    queue->head = p->next;
+#if DEVICE_TICKER_EVENT_EXTENDED
+    if (queue->head != NULL) {
+        queue->head->prev = NULL;
+    }
+#endif
+    p->next = NULL;
+    return p;
+}
+
+static void queue_remove(ticker_event_queue_t *queue, ticker_event_t *obj) {
+    if (queue->head == obj) {
+        // first in the list, so just drop me
+        queue_pop(queue);
+        return;
+    }
+#if DEVICE_TICKER_EVENT_EXTENDED
+    if (obj->prev == NULL) {
+        // not in the queue
+        return;
+    }
+    obj->prev->next = obj->next;
+    if (obj->next != NULL) {
+        obj->next->prev = obj->prev;
+    }
+    obj->next = obj->prev = NULL;
+#else
+    // find the object before me, then drop me
+    ticker_event_t *p;
+    for (p = queue->head; p != NULL; p = p->next) {
+        if (p->next == obj) {
+            p->next = obj->next;
+            obj->next = NULL;
+            return;
+        }
+    }
+#endif
+}
+
+/* Find an event due no earlier than from and no more than slack after it */
+static ticker_event_t *queue_find(ticker_event_queue_t *queue, timestamp_t from, timestamp_t slack) {
+    ticker_event_t *p;
+    for (p = queue->head; p != NULL; p = p->next) {
+        timestamp_t offset = p->timestamp - from;
+        if ((int)offset >= 0) {
+            return (offset <= slack) ? p : NULL;
+        }
+    }
+    return NULL;
+}
+
+#endif
+
+#if TICKER_BATCHED_DISPATCH
+/* The ticker whose expired events are being dispatched, if any */
+static const ticker_data_t *dispatching = NULL;
+
+static inline int ticker_rearm_deferred(const ticker_data_t *const data) {
+    return dispatching == data;
+}
+#else
+static inline int ticker_rearm_deferred(const ticker_data_t *const data) {
+    (void)data;
+    return 0;
+}
+#endif
+
+/* true if p has expired. With batched dispatch the counter is only read
+ * again once the events due at the last reading have run. */
+static inline int ticker_due(const ticker_data_t *const data, const ticker_event_t *p, timestamp_t *now) {
+#if TICKER_BATCHED_DISPATCH
+    if ((int)(p->timestamp - *now) <= 0) {
+        return 1;
+    }
+    // Running the handlers took time, so look again
+#endif
+    *now = data->interface->read();
+    return (int)(p->timestamp - *now) <= 0;
+}
+
+/* The number of tickers the drivers keep state for */
+#ifndef TICKER_MAX_TICKERS
+#define TICKER_MAX_TICKERS 4
+#endif
+
+/* The id of the wrap events, which no TimerEvent can have */
+#define TICKER_WRAP_ID 0xFFFFFFFFu
+
+/* The drivers' own state for each ticker in use, which the mbed-hal
+ * ticker_event_queue_t has no room for: the 64-bit time of ticker_read_us
+ * and the ticker's wrap event.
+ *
+ * ticker_read_us extends the 32-bit counter by the time since it last read
+ * it, so it must read it at least once per counter period. Each ticker keeps
+ * its wrap event queued, due every quarter period, which does: well inside
+ * the half period that events can be compared across. */
+typedef struct {
+    const ticker_data_t *data;
+    us_timestamp_t present_time;
+    ticker_event_t wrap;
+} ticker_state_t;
+
+static ticker_state_t tickers[TICKER_MAX_TICKERS];
 
-    __enable_irq();
+/* The state of a ticker, or NULL if it has none yet */
+static ticker_state_t *ticker_state(const ticker_data_t *const data) {
+    int i;
+    for (i = 0; i < TICKER_MAX_TICKERS; i++) {
+        if (tickers[i].data == data) {
+            return &tickers[i];
+        }
+    }
+    return NULL;
+}
+
+/* Bring the 64-bit time up to the counter. Called with interrupts masked. */
+static us_timestamp_t ticker_extend(ticker_state_t *ts) {
+    timestamp_t now = ts->data->interface->read();
+    ts->present_time += (timestamp_t)(now - (timestamp_t)ts->present_time);
+    return ts->present_time;
+}
+
+/* Queue the wrap event a quarter of a counter period from now. Called with
+ * interrupts masked. */
+static void ticker_wrap_insert(ticker_state_t *ts) {
+    ts->wrap.timestamp = (timestamp_t)ticker_extend(ts) + 0x40000000u;
+    ts->wrap.id = TICKER_WRAP_ID;
+    queue_insert(ts->data->queue, &ts->wrap);
+}
+
+/* The ticker peripheral is initialised the first time it's used, when it
+ * is given its state and its wrap event. That's done with interrupts masked,
+ * so an interrupt that uses the ticker at the same time can't initialise it
+ * a second time. */
+static ticker_state_t *ticker_init(const ticker_data_t *const data) {
+    uint32_t state = mbed_critical_enter();
+    ticker_state_t *ts = ticker_state(data);
+    if (ts == NULL) {
+        ts = ticker_state(NULL);
+        if (ts == NULL) {
+            mbed_critical_exit(state);
+            error("ticker state pool of %d exhausted\r\n", TICKER_MAX_TICKERS);
+            return NULL;
+        }
+        ts->data = data;
+        data->interface->init();
+        ticker_wrap_insert(ts);
+        if (data->queue->head == &ts->wrap) {
+            data->interface->set_interrupt(ts->wrap.timestamp);
+        }
+    }
+    mbed_critical_exit(state);
+    return ts;
+}
+
+/* Events with their own handler are dispatched to it, and all others to the
+ * queue's handler */
+static inline void ticker_dispatch(const ticker_data_t *const data, ticker_event_t *p) {
+    if (p->id == TICKER_WRAP_ID) {
+        ticker_state_t *ts = ticker_state(data);
+        if (ts != NULL && p == &ts->wrap) {
+            uint32_t state = mbed_critical_enter();
+            ticker_wrap_insert(ts);
+            mbed_critical_exit(state);
+            return;
+        }
+    }
+#if DEVICE_TICKER_EVENT_EXTENDED
+    ticker_event_handler handler = (p->handler != NULL) ? p->handler : data->queue->event_handler;
+#else
+    ticker_event_handler handler = data->queue->event_handler;
+#endif
+    MBED_TIMELINE_EVENT(MBED_TIMELINE_TICKER_EVENT, p->id);
+    if (handler != NULL) {
+        (*handler)(p->id); // NOTE: the handler can set new events
+    }
+}
+
+void ticker_set_handler(const ticker_data_t *const data, ticker_event_handler handler) {
+    ticker_init(data);
+
+    data->queue->event_handler = handler;
+}
+
+void ticker_irq_handler(const ticker_data_t *const data) {
+    data->interface->clear_interrupt();
+    MBED_TIMELINE_EVENT(MBED_TIMELINE_TICKER_IRQ, data);
+
+#if TICKER_BATCHED_DISPATCH
+    const ticker_data_t *outer = dispatching;
+    dispatching = data;
+    timestamp_t now = data->interface->read();
+#else
+    timestamp_t now = 0;
+#endif
+
+    /* Go through all the pending TimerEvents */
+    while (1) {
+        ticker_event_t *p = data->queue->head;
+        if (p == NULL || !ticker_due(data, p, &now)) {
+            break;
+        }
+        // This event was in the past: take it out of the queue, and
+        // execute its handler
+        queue_pop(data->queue);
+        ticker_dispatch(data, p);
+        /* Note: We continue back to examining the head because calling the
+         * event handler may have altered the chain of pending events. */
+    }
+
+    uint32_t state = mbed_critical_enter();
+#if TICKER_BATCHED_DISPATCH
+    dispatching = outer;
+#endif
+    if (data->queue->head == NULL) {
+        // There are no more TimerEvents left, so disable matches.
+        data->interface->disable_interrupt();
+    } else {
+        // This event and the following ones in the list are in the future:
+        //      set it as next interrupt
+        data->interface->set_interrupt(data->queue->head->timestamp);
+    }
+    mbed_critical_exit(state);
+}
+
+void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, timestamp_t timestamp, uint32_t id) {
+    ticker_insert_event_slack(data, obj, timestamp, 0, id);
+}
+
+void ticker_insert_event_slack(const ticker_data_t *const data, ticker_event_t *obj, timestamp_t timestamp, timestamp_t slack, uint32_t id) {
+    ticker_init(data);
+
+    /* mask interrupts for the duration of the function */
+    uint32_t state = mbed_critical_enter();
+
+    /* If another event is due within our window, expire together with it
+     * rather than taking an interrupt of our own. */
+    if (slack != 0) {
+        ticker_event_t *p = queue_find(data->queue, timestamp, slack);
+        if (p != NULL) {
+            timestamp = p->timestamp;
+        }
+    }
+
+    // initialise our data
+    obj->timestamp = timestamp;
+    obj->id = id;
+
+    queue_insert(data->queue, obj);
+    if (data->queue->head == obj && !ticker_rearm_deferred(data)) {
+        data->interface->set_interrupt(timestamp);
+    }
+
+    mbed_critical_exit(state);
 }
 
 void ticker_remove_event(const ticker_data_t *const data, ticker_event_t *obj) {
-    __disable_irq();
+    uint32_t state = mbed_critical_enter();
 
-    // remove this object from the list
-    if (data->queue->head == obj) {
-        // first in the list, so just drop me
-        data->queue->head = obj->next;
+    ticker_event_t *head = data->queue->head;
+    queue_remove(data->queue, obj);
+    if (head != data->queue->head && !ticker_rearm_deferred(data)) {
         if (data->queue->head == NULL) {
             data->interface->disable_interrupt();
         } else {
             data->interface->set_interrupt(data->queue->head->timestamp);
         }
-    } else {
-        // find the object before me, then drop me
-        ticker_event_t* p = data->queue->head;
-        while (p != NULL) {
-            if (p->next == obj) {
-                p->next = obj->next;
-                break;
-            }
-            p = p->next;
-        }
     }
 
-    __enable_irq();
+    mbed_critical_exit(state);
+}
+
+int ticker_next_deadline(const ticker_data_t *const data, timestamp_t *deadline) {
+    int pending = 0;
+
+    uint32_t state = mbed_critical_enter();
+    if (data->queue->head != NULL) {
+        *deadline = data->queue->head->timestamp;
+        pending = 1;
+    }
+    mbed_critical_exit(state);
+
+    return pending;
 }
 
 timestamp_t ticker_read(const ticker_data_t *const data)
 {
+    ticker_init(data);
     return data->interface->read();
 }
+
+/* The 32-bit counter is extended by adding the time since the last call. The
+ * ticker's wrap event does so every quarter counter period, so the count
+ * stays right however rarely anything else reads it. */
+us_timestamp_t ticker_read_us(const ticker_data_t *const data)
+{
+    ticker_state_t *ts = ticker_init(data);
+
+    uint32_t state = mbed_critical_enter();
+    us_timestamp_t present_time = ticker_extend(ts);
+    mbed_critical_exit(state);
+
+    return present_time;
+}
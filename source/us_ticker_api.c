@@ -14,11 +14,25 @@
  * limitations under the License.
  */
 #include "us_ticker_api.h"
+#include "mbed-drivers/mbed_critical.h"
 
 static ticker_event_queue_t events;
 
+/* The ticker queue calls this once, the first time the ticker is used */
+static void us_init(void)
+{
+    us_ticker_init();
+#if INTERRUPT_PRIORITY_CLASSES
+    uint32_t priority = IRQ_PRIORITY_TICKER;
+    if (priority >= (1UL << __NVIC_PRIO_BITS)) {
+        priority = (1UL << __NVIC_PRIO_BITS) - 1;
+    }
+    NVIC_SetPriority(us_ticker_irq_number(), priority);
+#endif
+}
+
 static const ticker_interface_t us_interface = {
-    .init = us_ticker_init,
+    .init = us_init,
     .read = us_ticker_read,
     .disable_interrupt = us_ticker_disable_interrupt,
     .clear_interrupt = us_ticker_clear_interrupt,
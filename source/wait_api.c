@@ -15,6 +15,27 @@
  */
 #include "mbed-drivers/wait_api.h"
 #include "us_ticker_api.h"
+#include "mbed-drivers/mbed_hal_inline.h"
+#include "ticker_api.h"
+#include "sleep_api.h"
+#include "cmsis.h"
+
+/* Waits of at least WAIT_SLEEP_THRESHOLD_US microseconds sleep between
+ * ticker interrupts instead of spinning on the counter. 0 disables this.
+ */
+#ifndef WAIT_SLEEP_THRESHOLD_US
+#define WAIT_SLEEP_THRESHOLD_US 0
+#endif
+
+/* Whether wait_cycles() uses the DWT cycle counter (Cortex-M3 and above)
+ * rather than a calibrated loop */
+#ifndef WAIT_CYCLES_DWT
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3)
+#define WAIT_CYCLES_DWT 1
+#else
+#define WAIT_CYCLES_DWT 0
+#endif
+#endif
 
 void wait(float s) {
     wait_us(s * 1000000.0f);
@@ -24,7 +45,87 @@ void wait_ms(int ms) {
     wait_us(ms * 1000);
 }
 
+#if WAIT_SLEEP_THRESHOLD_US > 0
+static void wait_us_sleep(uint32_t start, int us) {
+    const ticker_data_t *data = get_us_ticker_data();
+    /* An event with no handler of its own and an id of 0 only wakes us up */
+    ticker_event_t wakeup = {0};
+
+    ticker_insert_event(data, &wakeup, start + us, 0);
+    /* Check the time with interrupts masked, so the wakeup can't arrive
+     * between the check and the sleep. A pending interrupt still ends the
+     * sleep, and is serviced when interrupts are unmasked again. */
+    __disable_irq();
+    while ((mbed_us_ticker_read() - start) < (uint32_t)us) {
+        sleep();
+        __enable_irq();
+        __disable_irq();
+    }
+    __enable_irq();
+    ticker_remove_event(data, &wakeup);
+}
+#endif
+
 void wait_us(int us) {
-    uint32_t start = us_ticker_read();
-    while ((us_ticker_read() - start) < (uint32_t)us);
+    uint32_t start = mbed_us_ticker_read();
+#if WAIT_SLEEP_THRESHOLD_US > 0
+    /* Only sleep in thread mode: from a handler, the ticker interrupt may
+     * not be able to preempt us to end the sleep. */
+    if (us >= WAIT_SLEEP_THRESHOLD_US && __get_IPSR() == 0) {
+        wait_us_sleep(start, us);
+        return;
+    }
+#endif
+    while ((mbed_us_ticker_read() - start) < (uint32_t)us);
+}
+
+#if !WAIT_CYCLES_DWT
+/* Cycles per iteration of wait_loop(), in 1/256 cycles, or 0 until
+ * measured */
+static uint32_t loop_cycles_q8;
+
+/* Keep the loop out of line so its cost does not depend on the caller */
+static __attribute__((noinline)) void wait_loop(uint32_t iterations) {
+    while (iterations--) {
+        __NOP();
+    }
+}
+
+static void wait_loop_calibrate(void) {
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
+    /* Aim for about 1 ms, guessing 4 cycles per iteration */
+    uint32_t iterations = (cycles_per_us * 1000) / 4;
+    if (iterations == 0) {
+        iterations = 1;
+    }
+    uint32_t start = mbed_us_ticker_read();
+    wait_loop(iterations);
+    uint32_t elapsed = mbed_us_ticker_read() - start;
+    loop_cycles_q8 = (uint32_t)(((uint64_t)elapsed * cycles_per_us * 256) / iterations);
+    if (loop_cycles_q8 == 0) {
+        loop_cycles_q8 = 1;
+    }
+}
+#endif
+
+void wait_cycles(uint32_t cycles) {
+#if WAIT_CYCLES_DWT
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    uint32_t start = DWT->CYCCNT;
+    while ((DWT->CYCCNT - start) < cycles);
+#else
+    if (loop_cycles_q8 == 0) {
+        wait_loop_calibrate();
+    }
+    wait_loop((uint32_t)(((uint64_t)cycles << 8) / loop_cycles_q8));
+#endif
+}
+
+void wait_ns(uint32_t ns) {
+    /* 64-bit, as ns * SystemCoreClock overflows for waits over a few ns */
+    uint32_t cycles = (uint32_t)(((uint64_t)ns * SystemCoreClock + 999999999) / 1000000000);
+    wait_cycles(cycles);
 }
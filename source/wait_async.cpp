@@ -0,0 +1,29 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/wait_api.h"
+#include "minar/minar.h"
+
+namespace mbed {
+
+void delay_async(uint32_t ms, const mbed::util::FunctionPointerBind<void> &callback) {
+    if (ms == 0) {
+        minar::Scheduler::postCallback(callback);
+    } else {
+        minar::Scheduler::postCallback(callback).delay(minar::milliseconds(ms));
+    }
+}
+
+} // namespace mbed
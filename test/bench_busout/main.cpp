@@ -0,0 +1,51 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+
+// Measures BusOut::write() on the LEDs, and a single DigitalOut write for
+// comparison.
+
+namespace {
+    const int ROUNDS = 1000;
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(20);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(BusOut write benchmark);
+    MBED_HOSTTEST_START("MBED_BENCH_BUSOUT");
+
+    BusOut bus(LED1, LED2, LED3, LED4);
+    ProfileStats bus_write;
+    for (int round = 0; round < ROUNDS; round++) {
+        ProfileScope scope(bus_write);
+        bus.write(round & 0xF);
+    }
+    bus_write.report("busout_write");
+
+    DigitalOut led(LED1);
+    ProfileStats pin_write;
+    for (int round = 0; round < ROUNDS; round++) {
+        ProfileScope scope(pin_write);
+        led.write(round & 1);
+    }
+    pin_write.report("digitalout_write");
+
+    notify_performance_coefficient("ticks_per_second", (unsigned int)CycleTimer::ticks_per_second());
+    MBED_HOSTTEST_RESULT(true);
+}
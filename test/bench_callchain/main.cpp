@@ -0,0 +1,92 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+#include "mbed-drivers/StaticCallChain.h"
+#include "mbed-drivers/InlineCallChain.h"
+
+// Measures CallChain::call(), StaticCallChain::call() and
+// InlineCallChain::call() with an increasing number of empty handlers,
+// against calling the handler directly.
+
+namespace {
+    const int ROUNDS = 100;
+    const int MAX_HANDLERS = 8;
+    const int SIZES[] = {1, 4, MAX_HANDLERS};
+    volatile int calls;
+}
+
+void handler() {
+    calls++;
+}
+
+void handler_context(void *) {
+    calls++;
+}
+
+void (* volatile direct)(void) = handler;
+
+template<typename Chain>
+void add_handler(Chain &chain) {
+    chain.add(handler);
+}
+
+void add_handler(InlineCallChain<MAX_HANDLERS> &chain) {
+    chain.add(handler_context);
+}
+
+template<typename Chain>
+void bench_chain(Chain &chain, const char *prefix) {
+    for (unsigned s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); s++) {
+        chain.clear();
+        for (int i = 0; i < SIZES[s]; i++) {
+            add_handler(chain);
+        }
+        ProfileStats stats;
+        for (int round = 0; round < ROUNDS; round++) {
+            ProfileScope scope(stats);
+            chain.call();
+        }
+        char name[24];
+        snprintf(name, sizeof(name), "%s_%d", prefix, SIZES[s]);
+        stats.report(name);
+    }
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(20);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(CallChain call benchmark);
+    MBED_HOSTTEST_START("MBED_BENCH_CALLCHAIN");
+
+    ProfileStats baseline;
+    for (int round = 0; round < ROUNDS; round++) {
+        ProfileScope scope(baseline);
+        direct();
+    }
+    baseline.report("direct");
+
+    CallChain chain;
+    bench_chain(chain, "callchain");
+    StaticCallChain<MAX_HANDLERS> static_chain;
+    bench_chain(static_chain, "static");
+    InlineCallChain<MAX_HANDLERS> inline_chain;
+    bench_chain(inline_chain, "inline");
+
+    notify_performance_coefficient("ticks_per_second", (unsigned int)CycleTimer::ticks_per_second());
+    MBED_HOSTTEST_RESULT(true);
+}
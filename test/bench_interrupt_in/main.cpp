@@ -0,0 +1,77 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+
+// Times from driving BENCH_LOOPBACK_OUT high to the InterruptIn rise handler
+// running. Connect BENCH_LOOPBACK_OUT to BENCH_LOOPBACK_IN with a jumper.
+
+#ifndef BENCH_LOOPBACK_OUT
+#define BENCH_LOOPBACK_OUT D2
+#endif
+
+#ifndef BENCH_LOOPBACK_IN
+#define BENCH_LOOPBACK_IN D3
+#endif
+
+namespace {
+    const int ROUNDS = 100;
+    // how long to wait for an edge before giving up
+    const uint32_t EDGE_TIMEOUT_US = 1000;
+    volatile uint32_t edge_time;
+    volatile bool edge_seen;
+    uint32_t samples[ROUNDS];
+}
+
+void on_rise() {
+    edge_time = CycleTimer::now();
+    edge_seen = true;
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(20);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(InterruptIn latency benchmark);
+    MBED_HOSTTEST_START("MBED_BENCH_INTERRUPTIN");
+
+    DigitalOut out(BENCH_LOOPBACK_OUT, 0);
+    InterruptIn in(BENCH_LOOPBACK_IN);
+    in.rise(on_rise);
+
+    BenchmarkReporter latency("edge_to_callback", "ticks", samples, ROUNDS);
+    for (int round = 0; round < ROUNDS; round++) {
+        out = 0;
+        wait_us(100);
+        edge_seen = false;
+        uint32_t start = CycleTimer::now();
+        out = 1;
+        Timer timeout;
+        timeout.start();
+        while (!edge_seen) {
+            if (timeout.read_us() > (int)EDGE_TIMEOUT_US) {
+                printf("no edge seen: is BENCH_LOOPBACK_OUT connected to BENCH_LOOPBACK_IN?\r\n");
+                MBED_HOSTTEST_RESULT(false);
+            }
+        }
+        latency.add(edge_time - start);
+    }
+    in.rise(NULL);
+
+    latency.report();
+    notify_performance_coefficient("ticks_per_second", (unsigned int)CycleTimer::ticks_per_second());
+    MBED_HOSTTEST_RESULT(true);
+}
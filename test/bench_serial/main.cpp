@@ -0,0 +1,46 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+
+// Measures how many bytes per second printf() gets through to the stdio
+// serial port, including formatting.
+
+namespace {
+    const int LINES = 100;
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(20);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(Serial printf benchmark);
+    MBED_HOSTTEST_START("MBED_BENCH_SERIAL");
+
+    int bytes = 0;
+    Timer timer;
+    timer.start();
+    for (int i = 0; i < LINES; i++) {
+        bytes += printf("line %3d: 0123456789abcdefghijklmnopqrstuvwxyz\r\n", i);
+    }
+    fflush(stdout);
+    int us = timer.read_us();
+
+    notify_performance_coefficient("printf_bytes", bytes);
+    notify_performance_coefficient("printf_us", us);
+    notify_performance_coefficient("printf_bytes_per_second", (int)((int64_t)bytes * 1000000 / us));
+    MBED_HOSTTEST_RESULT(true);
+}
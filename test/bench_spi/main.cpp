@@ -0,0 +1,121 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+#include "minar/minar.h"
+
+// Measures SPI::write() per frame and the throughput of blocking and
+// asynchronous block transfers. No slave is needed.
+
+#ifndef BENCH_SPI_HZ
+#define BENCH_SPI_HZ 8000000
+#endif
+
+namespace {
+    const int ROUNDS = 50;
+    const int BLOCK_SIZE = 256;
+    char tx_buffer[BLOCK_SIZE];
+    char rx_buffer[BLOCK_SIZE];
+    SPI *spi;
+}
+
+static unsigned int bytes_per_second(uint32_t ticks) {
+    if (ticks == 0) {
+        return 0;
+    }
+    return (unsigned int)((uint64_t)BLOCK_SIZE * CycleTimer::ticks_per_second() / ticks);
+}
+
+#if DEVICE_SPI_ASYNCH
+namespace {
+    ProfileStats async_stats;
+    uint32_t async_start;
+    int async_rounds = 0;
+}
+
+void start_async();
+
+void report_async() {
+    async_stats.report("async_block");
+    notify_performance_coefficient("async_bytes_per_second", bytes_per_second(async_stats.avg()));
+    notify_performance_coefficient("ticks_per_second", (unsigned int)CycleTimer::ticks_per_second());
+    MBED_HOSTTEST_RESULT(true);
+}
+
+void async_done(Buffer tx, Buffer rx, int event) {
+    (void)tx;
+    (void)rx;
+    // called from the interrupt handler, so the scheduler isn't timed
+    async_stats.add(CycleTimer::now() - async_start);
+    if (!(event & SPI_EVENT_COMPLETE)) {
+        MBED_HOSTTEST_RESULT(false);
+    }
+    if (++async_rounds < ROUNDS) {
+        start_async();
+    } else {
+        minar::Scheduler::postCallback(&report_async);
+    }
+}
+
+void start_async() {
+    async_start = CycleTimer::now();
+    int rc = spi->transfer()
+        .tx(tx_buffer, BLOCK_SIZE)
+        .rx(rx_buffer, BLOCK_SIZE)
+        .callback(SPI::event_callback_t(async_done), SPI_EVENT_COMPLETE | SPI_EVENT_ERROR | SPI_EVENT_FLAG_IRQ_CONTEXT)
+        .apply();
+    if (rc != 0) {
+        MBED_HOSTTEST_RESULT(false);
+    }
+}
+#endif
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(20);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(SPI throughput benchmark);
+    MBED_HOSTTEST_START("MBED_BENCH_SPI");
+
+    static SPI bench_spi(SPI_MOSI, SPI_MISO, SPI_SCK);
+    spi = &bench_spi;
+    spi->frequency(BENCH_SPI_HZ);
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        tx_buffer[i] = i;
+    }
+
+    ProfileStats frame;
+    for (int round = 0; round < ROUNDS; round++) {
+        ProfileScope scope(frame);
+        spi->write(0x55);
+    }
+    frame.report("write_frame");
+
+    ProfileStats block;
+    for (int round = 0; round < ROUNDS; round++) {
+        ProfileScope scope(block);
+        spi->write(tx_buffer, BLOCK_SIZE, rx_buffer, BLOCK_SIZE);
+    }
+    block.report("write_block");
+    notify_performance_coefficient("block_bytes_per_second", bytes_per_second(block.avg()));
+
+#if DEVICE_SPI_ASYNCH
+    start_async();
+#else
+    notify_performance_coefficient("ticks_per_second", (unsigned int)CycleTimer::ticks_per_second());
+    MBED_HOSTTEST_RESULT(true);
+#endif
+}
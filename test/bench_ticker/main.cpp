@@ -0,0 +1,75 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+
+// Times inserting and removing a timeout with the us ticker queue holding
+// DEPTHS[i] - 1 other events. The new event is always the latest, so each
+// insertion walks the whole queue.
+
+namespace {
+    const int ROUNDS = 100;
+    const int MAX_DEPTH = 32;
+    const int DEPTHS[] = {1, 8, 16, MAX_DEPTH};
+    // far enough ahead that nothing fires during the test
+    const timestamp_t FAR_US = 10000000;
+    Timeout timeouts[MAX_DEPTH];
+}
+
+void never() {
+}
+
+void bench_depth(int depth) {
+    ProfileStats insert;
+    ProfileStats remove;
+
+    for (int i = 0; i < depth - 1; i++) {
+        timeouts[i].attach_us(never, FAR_US + i * 100);
+    }
+    Timeout &last = timeouts[depth - 1];
+    for (int round = 0; round < ROUNDS; round++) {
+        uint32_t start = CycleTimer::now();
+        last.attach_us(never, FAR_US + depth * 100);
+        insert.add(CycleTimer::now() - start);
+
+        start = CycleTimer::now();
+        last.detach();
+        remove.add(CycleTimer::now() - start);
+    }
+    for (int i = 0; i < depth - 1; i++) {
+        timeouts[i].detach();
+    }
+
+    char name[24];
+    snprintf(name, sizeof(name), "insert_depth_%d", depth);
+    insert.report(name);
+    snprintf(name, sizeof(name), "remove_depth_%d", depth);
+    remove.report(name);
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(20);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(Ticker insert and remove benchmark);
+    MBED_HOSTTEST_START("MBED_BENCH_TICKER");
+
+    for (unsigned i = 0; i < sizeof(DEPTHS) / sizeof(DEPTHS[0]); i++) {
+        bench_depth(DEPTHS[i]);
+    }
+    notify_performance_coefficient("ticks_per_second", (unsigned int)CycleTimer::ticks_per_second());
+    MBED_HOSTTEST_RESULT(true);
+}
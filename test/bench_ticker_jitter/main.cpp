@@ -0,0 +1,185 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+#include "minar/minar.h"
+
+// Records how late periodic Tickers are called, first with nothing else
+// running, then with asynchronous SPI transfers, serial interrupts in both
+// directions and a scheduler that always has work queued. Each phase
+// reports the distribution and a histogram of the lateness in micro-seconds.
+// Connect BENCH_LOOPBACK_SERIAL_TX to BENCH_LOOPBACK_SERIAL_RX with a jumper
+// for the serial load; no SPI slave is needed.
+
+#ifndef BENCH_LOOPBACK_SERIAL_TX
+#define BENCH_LOOPBACK_SERIAL_TX D1
+#endif
+
+#ifndef BENCH_LOOPBACK_SERIAL_RX
+#define BENCH_LOOPBACK_SERIAL_RX D0
+#endif
+
+#ifndef BENCH_SPI_HZ
+#define BENCH_SPI_HZ 8000000
+#endif
+
+namespace {
+    const int PHASE_MS = 300;
+    const int SAMPLES = 1024;
+    const timestamp_t PERIODS_US[] = {1000, 1300, 1700};
+    const int TICKERS = sizeof(PERIODS_US) / sizeof(PERIODS_US[0]);
+    const uint32_t EDGES_US[] = {0, 1, 2, 5, 10, 20, 50, 100, 200, 500};
+    // how long each scheduler callback keeps the processor busy
+    const int SPIN_US = 50;
+    const int SPINNERS = 4;
+    const int BLOCK_SIZE = 64;
+
+    // exposes when the call was due, as the Ticker itself reckoned it
+    class JitterTicker : public Ticker {
+    public:
+        timestamp_t due() const {
+            // handler() has already stepped _deadline on to the next call
+            return _deadline - _delay;
+        }
+    };
+
+    JitterTicker tickers[TICKERS];
+    uint32_t idle_samples[SAMPLES];
+    uint32_t loaded_samples[SAMPLES];
+    BenchmarkReporter idle("ticker_lateness_idle", "us", idle_samples, SAMPLES);
+    BenchmarkReporter loaded("ticker_lateness_loaded", "us", loaded_samples, SAMPLES);
+    BenchmarkReporter *volatile current = &idle;
+
+    volatile bool loading;
+    volatile uint32_t spins;
+    volatile uint32_t serial_rx;
+    volatile uint32_t serial_tx;
+    volatile uint32_t spi_transfers;
+    RawSerial *serial;
+    SPI *spi;
+    char tx_buffer[BLOCK_SIZE];
+    char rx_buffer[BLOCK_SIZE];
+}
+
+void ticked(void *context) {
+    JitterTicker &ticker = *(JitterTicker *)context;
+    current->add(us_ticker_read() - ticker.due());
+}
+
+void spin() {
+    spins++;
+    wait_us(SPIN_US);
+    if (loading) {
+        minar::Scheduler::postCallback(&spin);
+    }
+}
+
+void serial_rx_irq() {
+    while (serial->readable()) {
+        serial->getc();
+        serial_rx++;
+    }
+}
+
+void serial_tx_irq() {
+    if (serial->writeable()) {
+        serial->putc(0x55);
+        serial_tx++;
+    }
+}
+
+#if DEVICE_SPI_ASYNCH
+void start_spi();
+
+void spi_done(Buffer tx, Buffer rx, int event) {
+    (void)tx;
+    (void)rx;
+    (void)event;
+    spi_transfers++;
+    if (loading) {
+        start_spi();
+    }
+}
+
+void start_spi() {
+    spi->transfer()
+        .tx(tx_buffer, BLOCK_SIZE)
+        .rx(rx_buffer, BLOCK_SIZE)
+        .callback(SPI::event_callback_t(spi_done), SPI_EVENT_COMPLETE | SPI_EVENT_ERROR | SPI_EVENT_FLAG_IRQ_CONTEXT)
+        .apply();
+}
+#endif
+
+void finish() {
+    loading = false;
+    serial->attach(NULL, RawSerial::TxIrq);
+    serial->attach(NULL, RawSerial::RxIrq);
+    for (int i = 0; i < TICKERS; i++) {
+        tickers[i].detach();
+    }
+
+    idle.report_histogram(EDGES_US, sizeof(EDGES_US) / sizeof(EDGES_US[0]));
+    loaded.report_histogram(EDGES_US, sizeof(EDGES_US) / sizeof(EDGES_US[0]));
+    idle.report();
+    loaded.report();
+    notify_performance_coefficient("scheduler_spins", (unsigned int)spins);
+    notify_performance_coefficient("serial_tx_bytes", (unsigned int)serial_tx);
+    notify_performance_coefficient("serial_rx_bytes", (unsigned int)serial_rx);
+    notify_performance_coefficient("spi_transfers", (unsigned int)spi_transfers);
+    if (serial_rx == 0) {
+        printf("no serial bytes received: is BENCH_LOOPBACK_SERIAL_TX connected to BENCH_LOOPBACK_SERIAL_RX?\r\n");
+    }
+    MBED_HOSTTEST_RESULT(idle.count() > 0 && loaded.count() > 0);
+}
+
+void start_load() {
+    current = &loaded;
+    loading = true;
+    serial->attach(&serial_rx_irq, RawSerial::RxIrq);
+    serial->attach(&serial_tx_irq, RawSerial::TxIrq);
+#if DEVICE_SPI_ASYNCH
+    start_spi();
+#endif
+    for (int i = 0; i < SPINNERS; i++) {
+        minar::Scheduler::postCallback(&spin);
+    }
+    minar::Scheduler::postCallback(&finish).delay(minar::milliseconds(PHASE_MS));
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(20);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(Ticker jitter under load benchmark);
+    MBED_HOSTTEST_START("MBED_BENCH_TICKER_JITTER");
+
+    static RawSerial bench_serial(BENCH_LOOPBACK_SERIAL_TX, BENCH_LOOPBACK_SERIAL_RX);
+    serial = &bench_serial;
+    static SPI bench_spi(SPI_MOSI, SPI_MISO, SPI_SCK);
+    spi = &bench_spi;
+    spi->frequency(BENCH_SPI_HZ);
+#if DEVICE_SPI_ASYNCH
+    spi->set_dma_usage(DMA_USAGE_ALWAYS);
+#endif
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        tx_buffer[i] = i;
+    }
+
+    for (int i = 0; i < TICKERS; i++) {
+        tickers[i].attach_us(ticked, &tickers[i], PERIODS_US[i]);
+    }
+    minar::Scheduler::postCallback(&start_load).delay(minar::milliseconds(PHASE_MS));
+}
@@ -0,0 +1,92 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+#include "mbed-drivers/CRC.h"
+#include <string.h>
+
+// Checks both CRCs against their check values, the CRC of "123456789",
+// and that adding the data in pieces, from any alignment, gives the same
+// result as adding it at once.
+
+namespace {
+    const char check[] = "123456789";
+    const size_t check_length = sizeof(check) - 1;
+    const uint32_t check_crc32 = 0xCBF43926;
+    const uint32_t check_crc16 = 0x29B1;
+
+    // long enough to cover the word at a time loops of the table code
+    uint8_t data[67];
+    // room to copy data to each offset in a word
+    uint32_t unaligned[sizeof(data) / 4 + 2];
+}
+
+static bool check_value(CRC::Type type, uint32_t expected) {
+    bool ok = CRC::compute(type, check, check_length) == expected;
+    CRC crc(type);
+    crc.update(check, check_length);
+    ok = ok && crc.result() == expected;
+    printf("%s check value: %s\r\n", type == CRC::CRC32 ? "CRC-32" : "CRC-16", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_pieces(CRC::Type type) {
+    uint32_t whole = CRC::compute(type, data, sizeof(data));
+    CRC crc(type);
+    bool ok = true;
+    // every split into a first piece of n bytes and the rest
+    for (size_t n = 0; n <= sizeof(data); n++) {
+        crc.reset();
+        crc.update(data, n);
+        crc.update(data + n, sizeof(data) - n);
+        ok = ok && crc.result() == whole;
+    }
+    // a byte at a time
+    crc.reset();
+    for (size_t i = 0; i < sizeof(data); i++) {
+        crc.update(data + i, 1);
+    }
+    ok = ok && crc.result() == whole;
+    // from each offset in a word, in pieces of 1, 2, 3 and so on
+    for (size_t offset = 0; offset < 4; offset++) {
+        uint8_t *copy = (uint8_t *)unaligned + offset;
+        memcpy(copy, data, sizeof(data));
+        ok = ok && CRC::compute(type, copy, sizeof(data)) == whole;
+        crc.reset();
+        for (size_t i = 0, n = 1; i < sizeof(data); i += n, n++) {
+            crc.update(copy + i, (n < sizeof(data) - i) ? n : sizeof(data) - i);
+        }
+        ok = ok && crc.result() == whole;
+    }
+    printf("%s in pieces: %s\r\n", type == CRC::CRC32 ? "CRC-32" : "CRC-16", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(10);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(CRC check values and incremental updates);
+    MBED_HOSTTEST_START("MBED_CRC");
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 37 + 11);
+    }
+    bool result = check_value(CRC::CRC32, check_crc32);
+    result = check_value(CRC::CRC16_CCITT, check_crc16) && result;
+    result = check_pieces(CRC::CRC32) && result;
+    result = check_pieces(CRC::CRC16_CCITT) && result;
+    MBED_HOSTTEST_RESULT(result);
+}
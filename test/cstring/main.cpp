@@ -24,6 +24,53 @@
 #define POSITIVE_INTEGERS 32768,3214,999,100,1,0,1,4231,999,4123,32760,99999
 #define FLOATS  0.002,0.92430,15.91320,791.77368,6208.2,25719.4952,426815.982588,6429271.046,42468024.93,212006462.910
 
+// The block size of the memcpy, memset and strlen benchmarks
+#define BENCH_SIZE 1024
+#define BENCH_ROUNDS 16
+
+static char bench_src[BENCH_SIZE + 4];
+static char bench_dst[BENCH_SIZE + 4];
+
+// Report the throughput of one routine, at one alignment, in bytes per tick
+static void report_throughput(const char *name, uint32_t ticks)
+{
+    double rate = ticks ? (double)BENCH_SIZE * BENCH_ROUNDS / ticks : 0.0;
+    notify_performance_coefficient(name, rate);
+}
+
+static void run_benchmarks()
+{
+    // offset 0 is word aligned, offset 1 shows the cost of misalignment
+    for (int offset = 0; offset < 2; offset++) {
+        char *src = bench_src + offset;
+        char *dst = bench_dst;
+        uint32_t start;
+
+        memset(bench_src, 'x', sizeof(bench_src));
+        src[BENCH_SIZE - 1] = '\0';
+
+        start = CycleTimer::now();
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            memcpy(dst, src, BENCH_SIZE);
+        }
+        report_throughput(offset ? "memcpy_unaligned_bytes_per_tick" : "memcpy_bytes_per_tick", CycleTimer::now() - start);
+
+        start = CycleTimer::now();
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            memset(dst + offset, round, BENCH_SIZE);
+        }
+        report_throughput(offset ? "memset_unaligned_bytes_per_tick" : "memset_bytes_per_tick", CycleTimer::now() - start);
+
+        volatile size_t length = 0;
+        start = CycleTimer::now();
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            length += strlen(src);
+        }
+        report_throughput(offset ? "strlen_unaligned_bytes_per_tick" : "strlen_bytes_per_tick", CycleTimer::now() - start);
+    }
+    notify_performance_coefficient("ticks_per_second", (unsigned int)CycleTimer::ticks_per_second());
+}
+
 
 void runTest()
 {
@@ -114,6 +161,25 @@ void runTest()
         result = result && cmp_result;
     }
 
+    {
+        // every head, body and tail split of the word-at-a-time routines
+        bool ok = true;
+        for (int offset = 0; offset < 4; offset++) {
+            for (int length = 0; length < 40; length++) {
+                CLEAN_BUFFER(buffer);
+                memset(buffer + offset, 'a' + length % 26, length);
+                ok = ok && strlen(buffer + offset) == (size_t)length;
+                memcpy(buffer + 128 + (3 - offset), buffer + offset, length + 1);
+                ok = ok && memcmp(buffer + 128 + (3 - offset), buffer + offset, length + 1) == 0;
+                ok = ok && buffer[128 + (3 - offset) + length + 1] == 0;
+            }
+        }
+        printf("[%s] memcpy, memset and strlen at every alignment\r\n", ok ? "OK" : "FAIL");
+        result = result && ok;
+    }
+
+    run_benchmarks();
+
     MBED_HOSTTEST_RESULT(result);
     return;
 }
@@ -0,0 +1,95 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+#include "mbed-drivers/FlashKVStore.h"
+#include <string.h>
+
+// Writes a FlashKVStore value through a file after seeking past its end,
+// and checks the gap reads back as zeros and seeks past FLASH_KV_FILE_MAX
+// fail. The store's sectors must be left free by the linker: set
+// FLASH_KV_TEST_START to the address of the first.
+
+#ifndef FLASH_KV_TEST_SECTORS
+#define FLASH_KV_TEST_SECTORS 2
+#endif
+
+#if DEVICE_FLASH && defined(FLASH_KV_TEST_START)
+
+namespace {
+    const char expected[] = {'a', 'b', 0, 0, 0, 'c', 'd'};
+}
+
+static bool seek_and_write(FlashKVStore &store) {
+    FileHandle *f = store.open("seek", O_WRONLY | O_CREAT | O_TRUNC);
+    if (f == NULL) {
+        return false;
+    }
+    bool ok = f->write("ab", 2) == 2;
+    ok = ok && f->lseek(5, SEEK_SET) == 5;
+    ok = ok && f->write("cd", 2) == 2;
+    // nothing can be written at or past the end of the buffer
+    ok = ok && f->lseek(FLASH_KV_FILE_MAX + 10, SEEK_SET) == -1;
+    ok = ok && f->lseek(FLASH_KV_FILE_MAX, SEEK_SET) == FLASH_KV_FILE_MAX;
+    ok = ok && f->write("x", 1) == -1;
+    return (f->close() == 0) && ok;
+}
+
+static bool read_back(FlashKVStore &store) {
+    char value[16];
+    if (store.get("seek", value, sizeof(value)) != sizeof(expected) ||
+            memcmp(value, expected, sizeof(expected)) != 0) {
+        return false;
+    }
+    FileHandle *f = store.open("seek", O_RDONLY);
+    if (f == NULL) {
+        return false;
+    }
+    memset(value, 0xFF, sizeof(value));
+    bool ok = f->read(value, sizeof(value)) == sizeof(expected);
+    ok = ok && memcmp(value, expected, sizeof(expected)) == 0;
+    ok = ok && f->read(value, sizeof(value)) == 0;
+    f->close();
+    return ok;
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(20);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(FlashKVStore file seek and write);
+    MBED_HOSTTEST_START("MBED_FLASH_KV");
+
+    static FlashKVStore store("kv", FLASH_KV_TEST_START, FLASH_KV_TEST_SECTORS);
+    bool result = store.init() == 0;
+    result = result && seek_and_write(store);
+    result = result && read_back(store);
+    store.remove("seek");
+    MBED_HOSTTEST_RESULT(result);
+}
+
+#else
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(5);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(FlashKVStore file seek and write);
+    MBED_HOSTTEST_START("MBED_FLASH_KV");
+
+    printf("No flash sectors are set aside for the test (FLASH_KV_TEST_START), skipped\r\n");
+    MBED_HOSTTEST_RESULT(true);
+}
+
+#endif
@@ -0,0 +1,92 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2013-2014 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+#include <string.h>
+
+#define TXPIN     USBTX
+#define RXPIN     USBRX
+
+#if DEVICE_SERIAL_ASYNCH
+
+// Echoes every line with asynchronous reads and writes. Each line is written
+// back while the next one is already being received into the other buffer,
+// so TX and RX transfers run at the same time.
+
+namespace {
+    const int BUFFER_SIZE = 48;
+    char buffers[2][BUFFER_SIZE];
+    int current = 0;
+    Serial *pc;
+}
+
+void start_read();
+
+void write_done(Buffer buffer, int event) {
+    (void)buffer;
+    if (!(event & SERIAL_EVENT_TX_COMPLETE)) {
+        MBED_HOSTTEST_RESULT(false);
+    }
+}
+
+void read_done(Buffer buffer, int event) {
+    if (!(event & (SERIAL_EVENT_RX_CHARACTER_MATCH | SERIAL_EVENT_RX_COMPLETE))) {
+        MBED_HOSTTEST_RESULT(false);
+    }
+    char *line = (char *)buffer.buf;
+    char *end = (char *)memchr(line, '\n', buffer.length);
+    int length = end ? end - line + 1 : buffer.length;
+
+    // receive the next line while this one is sent back
+    current = !current;
+    start_read();
+    if (pc->write(line, length, write_done) != 0) {
+        MBED_HOSTTEST_RESULT(false);
+    }
+}
+
+void start_read() {
+    memset(buffers[current], 0, BUFFER_SIZE);
+    if (pc->read(buffers[current], BUFFER_SIZE, read_done, SERIAL_EVENT_RX_ALL, '\n') != 0) {
+        MBED_HOSTTEST_RESULT(false);
+    }
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(20);
+    MBED_HOSTTEST_SELECT(echo);
+    MBED_HOSTTEST_DESCRIPTION(Serial asynchronous full duplex echo at 115200);
+    MBED_HOSTTEST_START("SERIAL_ASYNCH_ECHO");
+
+    static Serial serial(TXPIN, RXPIN);
+    pc = &serial;
+    pc->baud(115200);
+    start_read();
+}
+
+#else
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(5);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(Serial asynchronous full duplex echo at 115200);
+    MBED_HOSTTEST_START("SERIAL_ASYNCH_ECHO");
+
+    printf("Asynchronous serial is not supported on this target, skipped\r\n");
+    MBED_HOSTTEST_RESULT(true);
+}
+
+#endif
@@ -0,0 +1,54 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+
+// The footprint of an asynchronous SPI transfer, including the transaction
+// queue. On targets without DEVICE_SPI_ASYNCH this is the baseline.
+
+#if DEVICE_SPI_ASYNCH
+namespace {
+    SPI spi(SPI_MOSI, SPI_MISO, SPI_SCK);
+    uint8_t tx_buffer[4];
+    uint8_t rx_buffer[4];
+}
+
+static void done(Buffer, Buffer, int event) {
+    notify_footprint();
+    MBED_HOSTTEST_RESULT((event & SPI_EVENT_COMPLETE) != 0);
+}
+#endif
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(10);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(SPI asynch footprint);
+    MBED_HOSTTEST_START("MBED_SIZE_SPI_ASYNCH");
+
+#if DEVICE_SPI_ASYNCH
+    int rc = spi.transfer()
+        .tx(tx_buffer, sizeof(tx_buffer))
+        .rx(rx_buffer, sizeof(rx_buffer))
+        .callback(SPI::event_callback_t(done), SPI_EVENT_COMPLETE | SPI_EVENT_ERROR)
+        .apply();
+    if (rc != 0) {
+        MBED_HOSTTEST_RESULT(false);
+    }
+#else
+    notify_footprint();
+    MBED_HOSTTEST_RESULT(true);
+#endif
+}
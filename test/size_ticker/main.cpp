@@ -0,0 +1,40 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+
+// The footprint of a Ticker, constructed statically so that its
+// constructor counts towards the static initialisation time.
+
+namespace {
+    Ticker ticker;
+    volatile int ticks;
+}
+
+static void tick() {
+    ticks++;
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(10);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(Ticker footprint);
+    MBED_HOSTTEST_START("MBED_SIZE_TICKER");
+
+    ticker.attach_us(tick, 1000);
+    notify_footprint();
+    MBED_HOSTTEST_RESULT(true);
+}
@@ -0,0 +1,228 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+#include "mbed-drivers/sim_ticker.h"
+
+// Drives the ticker queue with randomized attaches and detaches of
+// Timeouts and Tickers, some of them made from the handlers while the
+// queue is being dispatched. The first part runs on the simulated ticker,
+// where every call must land exactly on its due time, and checks the
+// order of the queue after every step; it also times each insertion
+// against the depth of the queue. The second part measures how late real
+// us ticker expiries are, against the number of events due together.
+
+namespace {
+    const int SLOTS = 64;
+    const int OPERATIONS = 5000;
+    const int BUCKETS = 4;                  // of SLOTS / BUCKETS depths each
+    const int LATENESS_DEPTHS[] = {1, 16, SLOTS};
+    const timestamp_t LATENESS_START_US = 2000;
+
+    struct Slot {
+        Slot() : timeout(get_sim_ticker_data()), ticker(get_sim_ticker_data()), armed(false) {
+        }
+        Timeout timeout;
+        Ticker ticker;
+        timestamp_t due;
+        timestamp_t period;     // 0 for the Timeout
+        bool armed;
+    };
+
+    Slot slots[SLOTS];
+    int armed_count;
+    uint32_t seed = 1;
+    timestamp_t last_call;
+    uint32_t calls;
+    uint32_t mistimed;          // calls not made at their due time
+    uint32_t misordered;        // calls made before an earlier call's time
+    uint32_t queue_errors;      // queue entries out of order
+    uint32_t missed;            // Timeouts never called
+    ProfileStats insert_stats[BUCKETS];
+}
+
+uint32_t random_below(uint32_t n) {
+    seed = seed * 1664525 + 1013904223;
+    return (seed >> 8) % n;
+}
+
+void fired(void *context);
+
+void arm(Slot &slot) {
+    bool periodic = random_below(4) == 0;
+    timestamp_t t = 1 + random_below(2000);
+    if (!slot.armed) {
+        armed_count++;
+    }
+    int bucket = (armed_count - 1) * BUCKETS / SLOTS;
+    uint32_t start = CycleTimer::now();
+    if (periodic) {
+        slot.timeout.detach();
+        slot.ticker.attach_us(fired, &slot, t);
+    } else {
+        slot.ticker.detach();
+        slot.timeout.attach_us(fired, &slot, t);
+    }
+    insert_stats[bucket].add(CycleTimer::now() - start);
+    slot.due = sim_ticker_read() + t;
+    slot.period = periodic ? t : 0;
+    slot.armed = true;
+}
+
+void disarm(Slot &slot) {
+    slot.timeout.detach();
+    slot.ticker.detach();
+    if (slot.armed) {
+        armed_count--;
+    }
+    slot.armed = false;
+}
+
+void fired(void *context) {
+    Slot &slot = *(Slot *)context;
+    timestamp_t now = sim_ticker_read();
+    calls++;
+    if (!slot.armed || now != slot.due) {
+        mistimed++;
+    }
+    if (calls > 1 && (int)(now - last_call) < 0) {
+        misordered++;
+    }
+    last_call = now;
+    if (slot.period) {
+        slot.due += slot.period;
+    } else {
+        slot.armed = false;
+        armed_count--;
+    }
+    // change the queue while it is being dispatched
+    switch (random_below(8)) {
+        case 0:
+            arm(slot);
+            break;
+        case 1:
+            arm(slots[random_below(SLOTS)]);
+            break;
+        case 2:
+            disarm(slots[random_below(SLOTS)]);
+            break;
+        default:
+            break;
+    }
+}
+
+void check_queue() {
+    const ticker_event_t *p = get_sim_ticker_data()->queue->head;
+    timestamp_t now = sim_ticker_read();
+    while (p != NULL && p->next != NULL) {
+        if ((int)(p->next->timestamp - now) < (int)(p->timestamp - now)) {
+            queue_errors++;
+        }
+        p = p->next;
+    }
+}
+
+void stress_sim() {
+    for (int i = 0; i < OPERATIONS; i++) {
+        Slot &slot = slots[random_below(SLOTS)];
+        switch (random_below(4)) {
+            case 0:
+            case 1:
+                arm(slot);
+                break;
+            case 2:
+                disarm(slot);
+                break;
+            default:
+                sim_ticker_advance(random_below(500));
+                break;
+        }
+        check_queue();
+    }
+    // run out every Timeout, then stop the Tickers
+    sim_ticker_advance(4000);
+    for (int i = 0; i < SLOTS; i++) {
+        if (slots[i].armed && slots[i].period == 0) {
+            missed++;
+        }
+        disarm(slots[i]);
+    }
+
+    printf("calls %lu, mistimed %lu, misordered %lu, queue errors %lu, missed %lu\r\n",
+            (unsigned long)calls, (unsigned long)mistimed, (unsigned long)misordered,
+            (unsigned long)queue_errors, (unsigned long)missed);
+    for (int i = 0; i < BUCKETS; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "insert_depth_%d_to_%d", i * SLOTS / BUCKETS, (i + 1) * SLOTS / BUCKETS - 1);
+        insert_stats[i].report(name);
+    }
+}
+
+namespace {
+    // exposes when the call was due, as the Ticker itself reckoned it
+    class ProbeTimeout : public Timeout {
+    public:
+        timestamp_t deadline() const {
+            return _deadline;
+        }
+    };
+
+    ProbeTimeout probes[SLOTS];
+    volatile int probes_fired;
+    uint32_t worst_lateness;
+}
+
+void probe_fired(void *context) {
+    ProbeTimeout &probe = *(ProbeTimeout *)context;
+    uint32_t late = us_ticker_read() - probe.deadline();
+    if (late > worst_lateness) {
+        worst_lateness = late;
+    }
+    probes_fired++;
+}
+
+void measure_lateness(int depth) {
+    worst_lateness = 0;
+    probes_fired = 0;
+    for (int i = 0; i < depth; i++) {
+        probes[i].attach_us(probe_fired, &probes[i], LATENESS_START_US + random_below(depth * 50));
+    }
+    Timer timer;
+    timer.start();
+    while (probes_fired < depth && timer.read_ms() < 1000) {
+    }
+    if (probes_fired < depth) {
+        missed += depth - probes_fired;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "lateness_us_depth_%d", depth);
+    notify_performance_coefficient(name, (unsigned int)worst_lateness);
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(30);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(Ticker queue stress);
+    MBED_HOSTTEST_START("MBED_STRESS_TICKER");
+
+    stress_sim();
+    for (unsigned i = 0; i < sizeof(LATENESS_DEPTHS) / sizeof(LATENESS_DEPTHS[0]); i++) {
+        measure_lateness(LATENESS_DEPTHS[i]);
+    }
+    notify_performance_coefficient("ticks_per_second", (unsigned int)CycleTimer::ticks_per_second());
+    MBED_HOSTTEST_RESULT(calls > 0 && mistimed == 0 && misordered == 0 && queue_errors == 0 && missed == 0);
+}
@@ -0,0 +1,107 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/test_env.h"
+#include "mbed-drivers/sim_ticker.h"
+
+// Runs a TickerGroup on the simulated ticker, and checks that each function
+// is called on every divisor-th base period, in its phase, at the end of
+// that base period, and that the automatic phases leave functions of equal
+// divisors on different base periods.
+
+namespace {
+    const timestamp_t BASE_US = 1000;
+    const uint32_t PERIODS = 600;
+    const uint32_t DIVISORS[] = {1, 2, 2, 5, 10, 10, 10, 50};
+    const int FUNCTIONS = sizeof(DIVISORS) / sizeof(DIVISORS[0]);
+
+    struct Probe {
+        int id;
+        uint32_t divisor;
+        uint32_t calls;
+        uint32_t errors;
+    };
+
+    TickerGroup group(get_sim_ticker_data());
+    Probe probes[FUNCTIONS];
+    timestamp_t started;
+    uint32_t load[PERIODS];
+}
+
+void probe(void *context) {
+    Probe &p = *(Probe *)context;
+    timestamp_t now = sim_ticker_read() - started;
+    uint32_t period = now / BASE_US - 1;
+    if (now % BASE_US != 0 || period % p.divisor != group.phase(p.id)) {
+        p.errors++;
+    }
+    if (period < PERIODS) {
+        load[period]++;
+    }
+    p.calls++;
+}
+
+void app_start(int, char*[]) {
+    MBED_HOSTTEST_TIMEOUT(10);
+    MBED_HOSTTEST_SELECT(default_auto);
+    MBED_HOSTTEST_DESCRIPTION(Ticker group);
+    MBED_HOSTTEST_START("MBED_TICKER_GROUP");
+
+    bool result = true;
+    for (int i = 0; i < FUNCTIONS; i++) {
+        probes[i].divisor = DIVISORS[i];
+        probes[i].id = group.attach(probe, &probes[i], DIVISORS[i]);
+        result = result && probes[i].id >= 0;
+    }
+    started = sim_ticker_read();
+    group.start(BASE_US);
+    uint32_t interrupts = sim_ticker_interrupts();
+    sim_ticker_advance(PERIODS * BASE_US);
+    interrupts = sim_ticker_interrupts() - interrupts;
+    group.stop();
+
+    for (int i = 0; i < FUNCTIONS; i++) {
+        printf("divisor %lu phase %lu calls %lu errors %lu\r\n", (unsigned long)probes[i].divisor,
+                (unsigned long)group.phase(probes[i].id), (unsigned long)probes[i].calls,
+                (unsigned long)probes[i].errors);
+        result = result && probes[i].calls == PERIODS / probes[i].divisor && probes[i].errors == 0;
+    }
+    // the two halves and the three tenths have base periods of their own
+    result = result && group.phase(probes[1].id) != group.phase(probes[2].id);
+    result = result && group.phase(probes[4].id) != group.phase(probes[5].id) &&
+            group.phase(probes[5].id) != group.phase(probes[6].id) &&
+            group.phase(probes[4].id) != group.phase(probes[6].id);
+    uint32_t worst = 0;
+    for (uint32_t i = 0; i < PERIODS; i++) {
+        if (load[i] > worst) {
+            worst = load[i];
+        }
+    }
+    printf("interrupts %lu, most functions in one base period %lu\r\n",
+            (unsigned long)interrupts, (unsigned long)worst);
+    result = result && interrupts == PERIODS;
+
+    // a detached function is not called again
+    group.detach(probes[0].id);
+    uint32_t calls = probes[0].calls;
+    group.start(BASE_US);
+    sim_ticker_advance(10 * BASE_US);
+    group.stop();
+    result = result && probes[0].calls == calls;
+
+    MBED_HOSTTEST_RESULT(result);
+}